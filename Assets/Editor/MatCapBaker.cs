@@ -5,6 +5,8 @@ using System.IO;
 // Editor window to bake a PBR MatCap using the Hidden/MatCapGenerator/PBR shader
 // Produces an 8-bit PNG file.
 // Note: Alpha is thresholded to 1-bit (0 or 255) as requested.
+// "Add to CPU Bake Library" records the current settings in GeneratedData/matcap_library.json instead, for
+// Assets/Ziz/matcap_bake_tool to bake the whole library headless (no GPU needed).
 
 public class MatCapBaker : EditorWindow {
     private Material mat;
@@ -25,6 +27,9 @@ public class MatCapBaker : EditorWindow {
     private Color pointLightColor = Color.white;
     private float pointIntensity = 0.5f;
     private bool useACES = true;
+    private string libraryFormat = "RGBA8888";
+    private int libraryMips = 1;
+    private bool libraryDither = false;
 
     private const int SIZE = 32;
     // Preview RT size (larger for window preview)
@@ -116,6 +121,15 @@ public class MatCapBaker : EditorWindow {
                 BakeAndSave();
             }
         }
+
+        EditorGUILayout.Space();
+        GUILayout.Label("CPU Bake Library", EditorStyles.boldLabel);
+        libraryFormat = EditorGUILayout.TextField("Texel format", libraryFormat);
+        libraryMips = EditorGUILayout.IntSlider("Mip levels (0 = all)", libraryMips, 0, 6);
+        libraryDither = EditorGUILayout.Toggle("Ordered dither", libraryDither);
+        if (GUILayout.Button("Add to CPU Bake Library")) {
+            AddToLibrary();
+        }
     }
 
     void OnEnable() {
@@ -244,4 +258,84 @@ public class MatCapBaker : EditorWindow {
 
         EditorUtility.DisplayDialog("MatCap Baker", "Baked and saved:\n" + pngPath + "\n\nAlso saved to:\n" + generatedDataPngPath, "OK");
     }
+
+    void AddToLibrary() {
+        string generatedDataFolder = Path.Combine(Application.dataPath, "..", "GeneratedData");
+        if (!Directory.Exists(generatedDataFolder)) {
+            Directory.CreateDirectory(generatedDataFolder);
+        }
+        string libraryPath = Path.Combine(generatedDataFolder, "matcap_library.json");
+
+        MatCapLibrary library = null;
+        if (File.Exists(libraryPath)) {
+            library = JsonUtility.FromJson<MatCapLibrary>(File.ReadAllText(libraryPath));
+        }
+        if (library == null) {
+            library = new MatCapLibrary();
+        }
+
+        MatCapLibraryEntry entry = new MatCapLibraryEntry {
+            name = outputName,
+            size = SIZE,
+            baseColor = baseColor,
+            metallic = metallic,
+            roughness = roughness,
+            emissive = emissive,
+            transparency = transparency,
+            ior = ior,
+            skyColorTop = skyColorTop,
+            skyColorHorizon = skyColorHorizon,
+            lightDir = lightDir,
+            lightColor = lightColor,
+            directionalIntensity = directionalIntensity,
+            pointLightPos = pointLightPos,
+            pointLightColor = pointLightColor,
+            pointIntensity = pointIntensity,
+            useACES = useACES,
+            format = libraryFormat,
+            mips = libraryMips,
+            dither = libraryDither
+        };
+
+        // Same name replaces the earlier entry, so re-adding after a tweak doesn't bake twice
+        int index = library.matcaps.FindIndex(e => e.name == outputName);
+        if (index >= 0) {
+            library.matcaps[index] = entry;
+        } else {
+            library.matcaps.Add(entry);
+        }
+
+        File.WriteAllText(libraryPath, JsonUtility.ToJson(library, true));
+        EditorUtility.DisplayDialog("MatCap Baker", (index >= 0 ? "Updated " : "Added ") + outputName + " in\n" + libraryPath + "\n\n" + library.matcaps.Count + " matcaps in the library.", "OK");
+    }
+}
+
+// The JSON matcap_bake_tool reads; field names are the window's
+[System.Serializable]
+public class MatCapLibraryEntry {
+    public string name;
+    public int size;
+    public Color baseColor;
+    public float metallic;
+    public float roughness;
+    public Color emissive;
+    public float transparency;
+    public float ior;
+    public Color skyColorTop;
+    public Color skyColorHorizon;
+    public Vector3 lightDir;
+    public Color lightColor;
+    public float directionalIntensity;
+    public Vector3 pointLightPos;
+    public Color pointLightColor;
+    public float pointIntensity;
+    public bool useACES;
+    public string format;      // a texel.h format name, e.g. "RGB565"
+    public int mips;           // 0 for the whole chain
+    public bool dither;
+}
+
+[System.Serializable]
+public class MatCapLibrary {
+    public System.Collections.Generic.List<MatCapLibraryEntry> matcaps = new System.Collections.Generic.List<MatCapLibraryEntry>();
 }
@@ -88,12 +88,8 @@ public static class RatSplitTests
                 Rat.Core.DecompressToFrame(ctx2, composite, fIdx);
                 for (int v = 0; v < composite.num_vertices; ++v)
                 {
-                    var q = ctx2.current_positions[v];
-                    float x = composite.min_x + (q.x / 255f) * (composite.max_x - composite.min_x);
-                    float y = composite.min_y + (q.y / 255f) * (composite.max_y - composite.min_y);
-                    float z = composite.min_z + (q.z / 255f) * (composite.max_z - composite.min_z);
                     var exp = frames[(int)fIdx][v];
-                    float err = Vector3.Distance(new Vector3(x, y, z), exp);
+                    float err = Vector3.Distance(Rat.Core.DequantizeVertex(composite, v, ctx2.current_positions[v]), exp);
                     if (err > maxErr) maxErr = err;
                 }
             }
@@ -102,5 +98,148 @@ public static class RatSplitTests
 
         Debug.Log("RAT Split Test - done");
     }
+
+    [MenuItem("Ziz/Tests/Run RAT Parallel Encode Test")]
+    public static void RunParallelEncodeTest()
+    {
+        Debug.Log("RAT Parallel Encode Test - start");
+
+        // Enough frames and an odd vertex count so encoder blocks start mid-word
+        const int vertexCount = 7;
+        const int frameCount = 600;
+        var random = new System.Random(1234);
+        var frames = new List<Vector3[]>();
+        var basePositions = new Vector3[vertexCount];
+        for (int v = 0; v < vertexCount; v++) basePositions[v] = new Vector3(v, v * 0.5f, -v);
+        for (int f = 0; f < frameCount; f++)
+        {
+            var frame = new Vector3[vertexCount];
+            for (int v = 0; v < vertexCount; v++)
+            {
+                float wobble = (float)random.NextDouble() * 0.2f;
+                frame[v] = basePositions[v] + new Vector3(Mathf.Sin(f * 0.05f + v) * 2f, wobble, Mathf.Cos(f * 0.03f) * 3f);
+            }
+            frames.Add(frame);
+        }
+
+        var mesh = new Mesh();
+        mesh.vertices = frames[0];
+        mesh.triangles = new int[] { 0, 1, 2, 2, 3, 4, 4, 5, 6 };
+
+        var compressed = Rat.Tool.CompressFromFrames(frames, mesh, null, null, preserveFirstFrame: false, maxBitsX: 8, maxBitsY: 8, maxBitsZ: 8);
+
+        // Reference: pack every delta serially, MSB first, exactly as the single-threaded encoder did
+        var reference = new List<uint>();
+        uint word = 0;
+        int used = 0;
+        for (int f = 1; f < frameCount; f++)
+        {
+            for (int v = 0; v < vertexCount; v++)
+            {
+                var cur = compressed.quantized_frames[f][v];
+                var prev = compressed.quantized_frames[f - 1][v];
+                int[] deltas = { cur.x - prev.x, cur.y - prev.y, cur.z - prev.z };
+                byte[] widths = { compressed.bit_widths_x[v], compressed.bit_widths_y[v], compressed.bit_widths_z[v] };
+                for (int axis = 0; axis < 3; axis++)
+                {
+                    for (int bit = widths[axis] - 1; bit >= 0; bit--)
+                    {
+                        word |= (uint)((deltas[axis] >> bit) & 1) << (31 - used);
+                        if (++used == 32) { reference.Add(word); word = 0; used = 0; }
+                    }
+                }
+            }
+        }
+        if (used > 0) reference.Add(word);
+
+        bool streamMatches = reference.Count == compressed.delta_stream.Length;
+        for (int i = 0; streamMatches && i < reference.Count; i++) streamMatches = reference[i] == compressed.delta_stream[i];
+        if (streamMatches) Debug.Log($"RAT Parallel Encode Test: delta stream matches serial reference ({reference.Count} words)");
+        else Debug.LogError($"RAT Parallel Encode Test: delta stream differs from serial reference ({compressed.delta_stream.Length} vs {reference.Count} words)");
+
+        // Every frame must decode back to the quantized input
+        var ctx = Rat.Core.CreateDecompressionContext(compressed);
+        int mismatchedFrames = 0;
+        for (uint f = 0; f < frameCount; f++)
+        {
+            Rat.Core.DecompressToFrame(ctx, compressed, f);
+            for (int v = 0; v < vertexCount; v++)
+            {
+                var a = ctx.current_positions[v];
+                var b = compressed.quantized_frames[f][v];
+                if (a.x != b.x || a.y != b.y || a.z != b.z) { mismatchedFrames++; break; }
+            }
+        }
+        if (mismatchedFrames == 0) Debug.Log($"RAT Parallel Encode Test: all {frameCount} frames decode exactly");
+        else Debug.LogError($"RAT Parallel Encode Test: {mismatchedFrames} frames decode incorrectly");
+
+        Debug.Log("RAT Parallel Encode Test - done");
+    }
+
+    [MenuItem("Ziz/Tests/Run RAT Adaptive Bounds Test")]
+    public static void RunAdaptiveBoundsTest()
+    {
+        Debug.Log("RAT Adaptive Bounds Test - start");
+
+        // Two small wobbling groups that are far apart: one global box wastes most of its 8-bit range
+        const int vertexCount = 8;
+        const int frameCount = 300;
+        var frames = new List<Vector3[]>();
+        for (int f = 0; f < frameCount; f++)
+        {
+            var frame = new Vector3[vertexCount];
+            for (int v = 0; v < vertexCount; v++)
+            {
+                var origin = (v < 4) ? Vector3.zero : new Vector3(100f, 50f, -80f);
+                frame[v] = origin + new Vector3(v % 2, v / 2 % 2, 0) + new Vector3(Mathf.Sin(f * 0.1f + v), Mathf.Cos(f * 0.07f), Mathf.Sin(f * 0.05f)) * 0.5f;
+            }
+            frames.Add(frame);
+        }
+
+        var mesh = new Mesh();
+        mesh.vertices = frames[0];
+        mesh.triangles = new int[] { 0, 1, 2, 2, 1, 3, 4, 5, 6, 6, 5, 7 };
+
+        var global = Rat.Tool.CompressFromFrames(frames, mesh, null, null);
+        var segments = Rat.Tool.CompressFromFramesAdaptive(frames, mesh, null, null, clusterCount: 2, segmentFrames: 100);
+
+        string baseName = Path.Combine(Application.dataPath.Replace("Assets", "GeneratedData"), "rat_adaptive_test");
+        if (!Directory.Exists(Path.GetDirectoryName(baseName))) Directory.CreateDirectory(Path.GetDirectoryName(baseName));
+        var files = Rat.Tool.WriteRatSegmentsWithSizeSplitting(baseName, segments, maxFileSizeKB: 1, processedFrames: frames);
+
+        // The first file stores the total frame count, later files their local count; derive the first file's local length
+        var anims = files.ConvertAll(f => Rat.Core.ReadRatFile(f));
+        uint firstLocalFrames = anims[0].num_frames;
+        for (int i = 1; i < anims.Count; i++) firstLocalFrames -= anims[i].num_frames - 1;
+        anims[0].num_frames = firstLocalFrames;
+
+        // Decode every file in order, each seeded by its own first frame, and compare against the source frames
+        float maxErr = 0f;
+        int frameBase = 0;
+        foreach (var anim in anims)
+        {
+            if (anim.cluster_ids == null) Debug.LogError("RAT Adaptive Bounds Test: chunk was not written as RAT4");
+            var ctx = Rat.Core.CreateDecompressionContext(anim);
+            for (uint f = 0; f < anim.num_frames; f++)
+            {
+                Rat.Core.DecompressToFrame(ctx, anim, f);
+                for (int v = 0; v < vertexCount; v++)
+                {
+                    maxErr = Mathf.Max(maxErr, Vector3.Distance(Rat.Core.DequantizeVertex(anim, v, ctx.current_positions[v]), frames[frameBase + (int)f][v]));
+                }
+            }
+            frameBase += (int)anim.num_frames - 1;
+        }
+
+        float globalStep = Rat.Core.MaxQuantizationStep(global).magnitude;
+        long adaptiveBits = 0;
+        foreach (var segment in segments) adaptiveBits += Rat.Core.BitsPerDeltaFrame(segment) * (segment.num_frames - 1);
+        Debug.Log($"RAT Adaptive Bounds Test: {segments.Count} segments, {files.Count} files, max error {maxErr:F4} (global step {globalStep:F4}), " +
+                  $"delta bits adaptive={adaptiveBits} global={Rat.Core.BitsPerDeltaFrame(global) * (frameCount - 1)}");
+        if (frameBase != frameCount - 1) Debug.LogError($"RAT Adaptive Bounds Test: decoded {frameBase + 1} of {frameCount} frames");
+        if (maxErr > globalStep * 0.5f) Debug.LogError("RAT Adaptive Bounds Test: adaptive error is not below the global quantization step");
+
+        Debug.Log("RAT Adaptive Bounds Test - done");
+    }
 }
 #endif
@@ -26,6 +26,8 @@ public class SDFParticleRecorderEditor : Editor
     private SerializedProperty onlyRecordWhenVisibleProp;
     private SerializedProperty baseFilenameProp;
     private SerializedProperty maxFileSizeKBProp;
+    private SerializedProperty exportInstanceStreamProp;
+    private SerializedProperty streamKeyIntervalProp;
     private SerializedProperty autoExportOnPlayModeExitProp;
 
     private bool showShapePreview = false;
@@ -51,6 +53,8 @@ public class SDFParticleRecorderEditor : Editor
         onlyRecordWhenVisibleProp = serializedObject.FindProperty("onlyRecordWhenVisible");
         baseFilenameProp = serializedObject.FindProperty("baseFilename");
         maxFileSizeKBProp = serializedObject.FindProperty("maxFileSizeKB");
+        exportInstanceStreamProp = serializedObject.FindProperty("exportInstanceStream");
+        streamKeyIntervalProp = serializedObject.FindProperty("streamKeyInterval");
         autoExportOnPlayModeExitProp = serializedObject.FindProperty("autoExportOnPlayModeExit");
     }
 
@@ -64,7 +68,7 @@ public class SDFParticleRecorderEditor : Editor
         EditorGUILayout.Space();
         EditorGUILayout.LabelField("SDF Particle System Recorder", EditorStyles.boldLabel);
         EditorGUILayout.HelpBox(
-            "Records Unity ParticleSystem animations and exports them as SDF shape-based .act/.rat files for retro hardware.",
+            "Records Unity ParticleSystem animations and exports them as SDF shape-based .ptc instance streams (or baked .act/.rat files) for retro hardware.",
             MessageType.Info
         );
 
@@ -163,7 +167,15 @@ public class SDFParticleRecorderEditor : Editor
         // Export Settings
         EditorGUILayout.LabelField("Export Settings", EditorStyles.boldLabel);
         EditorGUILayout.PropertyField(baseFilenameProp);
-        EditorGUILayout.PropertyField(maxFileSizeKBProp);
+        EditorGUILayout.PropertyField(exportInstanceStreamProp);
+        if (exportInstanceStreamProp.boolValue)
+        {
+            EditorGUILayout.PropertyField(streamKeyIntervalProp);
+        }
+        else
+        {
+            EditorGUILayout.PropertyField(maxFileSizeKBProp);
+        }
         EditorGUILayout.PropertyField(autoExportOnPlayModeExitProp, new GUIContent("Auto-Export on Exit Play Mode"));
 
         if (autoExportOnPlayModeExitProp.boolValue)
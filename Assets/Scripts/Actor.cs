@@ -95,6 +95,9 @@ public class Actor : MonoBehaviour
     [Range(1, 4)]
     public int frameCaptureInterval = 1;  // 1 = capture every frame, 2 = skip every other frame
 
+    [Tooltip("Reorder the ACT's triangles for vertex cache reuse. Changes draw order, so leave off for alpha-blended meshes.")]
+    public bool optimizeVertexCache = false;
+
     [Header("Material & Rendering Settings")]
     [Tooltip("Choose the material and lighting mode for this actor")]
     public Rat.ActorRenderingMode renderingMode = Rat.ActorRenderingMode.TextureWithDirectionalLight;
@@ -1402,7 +1405,7 @@ public class Actor : MonoBehaviour
             }
 
             // Save Actor data with mesh information only (no transforms)
-            SaveActorData(actorFilePath, AnimationData, renderingMode);
+            SaveActorData(actorFilePath, AnimationData, renderingMode, optimizeVertexCache: optimizeVertexCache);
             
             Debug.Log($"Actor {name} - actor file saved:");
             Debug.Log($"  - file: {actorFilePath}");
@@ -1421,8 +1424,10 @@ public class Actor : MonoBehaviour
     /// <summary>
     /// Saves actor animation data to a binary file (Version 6 - mesh data only)
     /// All vertex animation and transforms are baked into RAT files
+    /// With optimizeVertexCache, triangles are reordered for post-transform vertex cache reuse; vertex order is
+    /// untouched so the indices still match the RAT streams. Off by default: reordering changes blend order.
     /// </summary>
-    public static void SaveActorData(string filePath, ActorAnimationData data, Rat.ActorRenderingMode renderingMode = Rat.ActorRenderingMode.TextureWithDirectionalLight, bool embedMeshData = true)
+    public static void SaveActorData(string filePath, ActorAnimationData data, Rat.ActorRenderingMode renderingMode = Rat.ActorRenderingMode.TextureWithDirectionalLight, bool embedMeshData = true, bool optimizeVertexCache = false)
     {
         if (!embedMeshData || data.meshUVs == null || data.meshIndices == null)
         {
@@ -1430,6 +1435,16 @@ public class Actor : MonoBehaviour
             return;
         }
         
+        int[] meshIndices = data.meshIndices;
+        if (optimizeVertexCache && meshIndices.Length >= 6)
+        {
+            int vertexCount = Math.Max(data.meshUVs.Length, meshIndices.Max() + 1);
+            float acmrBefore = VertexCacheOptimizer.ComputeACMR(meshIndices);
+            meshIndices = VertexCacheOptimizer.OptimizeTriangleOrder(meshIndices, vertexCount);
+            float acmrAfter = VertexCacheOptimizer.ComputeACMR(meshIndices);
+            Debug.Log($"ACT export: vertex cache ACMR {acmrBefore:F3} -> {acmrAfter:F3} ({meshIndices.Length / 3} triangles, FIFO {VertexCacheOptimizer.DefaultCacheSize})");
+        }
+        
         // Convert all RAT filenames to UTF-8 bytes with null terminators
         var ratFileNameBytes = new List<byte>();
         
@@ -1522,7 +1537,7 @@ public class Actor : MonoBehaviour
             Debug.Log($"ACT export: wrote {data.meshColors.Length} colors at offset {meshColorsOffset}");
             
             // Write mesh indices
-            foreach (var index in data.meshIndices)
+            foreach (var index in meshIndices)
             {
                 writer.Write((ushort)index);
             }
@@ -24,6 +24,9 @@ public class AnimationPlayer : MonoBehaviour
     [Tooltip("Playback speed multiplier")]
     public float playbackSpeed = 1f;
 
+    [Tooltip("Decode through the shared DecodeScheduler so all players' frames are decoded together across cores")]
+    public bool useDecodeScheduler = true;
+
     [Header("Debug Options")]
     [Tooltip("Show detailed vertex position logs")]
     public bool debugVertexPositions = false;
@@ -45,6 +48,12 @@ public class AnimationPlayer : MonoBehaviour
     private bool _isPlaying = false;
     private float _currentTime = 0f;
     private int _currentKeyframe = 0;
+
+    // Scheduled decode: SoA output buffers and the keyframe waiting for this frame's dispatch
+    private float[] _decodedX, _decodedY, _decodedZ;
+    private Vector3[] _scheduledVertices;
+    private int _scheduledKeyframe = -1;
+    private static readonly Matrix4x4 RightToLeftHanded = Matrix4x4.Scale(new Vector3(1f, 1f, -1f));
     
     void Start()
     {
@@ -90,11 +99,54 @@ public class AnimationPlayer : MonoBehaviour
                     }
                 }
                 
-                ApplyKeyframe(newKeyframe);
+                if (useDecodeScheduler) ScheduleKeyframe(newKeyframe);
+                else ApplyKeyframe(newKeyframe);
                 _currentKeyframe = newKeyframe;
             }
         }
     }
+
+    void LateUpdate()
+    {
+        if (_scheduledKeyframe < 0) return;
+
+        // The first player to get here decodes every queued player's frame; the rest just pick up their buffers
+        DecodeScheduler.Shared.DispatchFrame(Time.frameCount);
+
+        for (int i = 0; i < _scheduledVertices.Length; i++)
+        {
+            _scheduledVertices[i] = new Vector3(_decodedX[i], _decodedY[i], _decodedZ[i]);
+        }
+        if (_mesh != null && _scheduledVertices.Length <= _mesh.vertexCount)
+        {
+            _mesh.vertices = _scheduledVertices;
+            _mesh.RecalculateBounds();
+        }
+        _scheduledKeyframe = -1;
+    }
+
+    /// <summary>
+    /// Queue a keyframe on the shared decode scheduler; the mesh is updated in LateUpdate once the frame is published
+    /// </summary>
+    public void ScheduleKeyframe(int keyframeIndex)
+    {
+        if (_ratAnimations.Count == 0 || keyframeIndex >= _ratAnimations[0].num_frames)
+            return;
+
+        var ratAnim = _ratAnimations[0];
+        int n = (int)ratAnim.num_vertices;
+        if (_decodedX == null || _decodedX.Length != n)
+        {
+            _decodedX = new float[n];
+            _decodedY = new float[n];
+            _decodedZ = new float[n];
+            _scheduledVertices = new Vector3[n];
+        }
+
+        // The Z flip (right-handed to left-handed) is folded into the decode
+        DecodeScheduler.Shared.Enqueue(ratAnim, _decompContexts[0], (uint)keyframeIndex, _decodedX, _decodedY, _decodedZ, RightToLeftHanded);
+        _scheduledKeyframe = keyframeIndex;
+    }
     
     /// <summary>
     /// Load .act and referenced .rat files
@@ -208,10 +260,8 @@ public class AnimationPlayer : MonoBehaviour
                 Core.DecompressToFrame(_decompContexts[0], ratAnim, 0);
                 for (int i = 0; i < ratAnim.num_vertices; i++)
                 {
-                    float x = ratAnim.min_x + (_decompContexts[0].current_positions[i].x / 255f) * (ratAnim.max_x - ratAnim.min_x);
-                    float y = ratAnim.min_y + (_decompContexts[0].current_positions[i].y / 255f) * (ratAnim.max_y - ratAnim.min_y);
-                    float z = ratAnim.min_z + (_decompContexts[0].current_positions[i].z / 255f) * (ratAnim.max_z - ratAnim.min_z);
-                    vertices[i] = new Vector3(x, y, -z);
+                    var p = Core.DequantizeVertex(ratAnim, i, _decompContexts[0].current_positions[i]);
+                    vertices[i] = new Vector3(p.x, p.y, -p.z);
                 }
                 
                 _mesh.vertices = vertices;
@@ -322,13 +372,11 @@ public class AnimationPlayer : MonoBehaviour
         var vertices = new Vector3[ratAnim.num_vertices];
         for (int i = 0; i < ratAnim.num_vertices; i++)
         {
-            // Convert from 8-bit quantized back to float using RAT bounds
-            float x = ratAnim.min_x + (context.current_positions[i].x / 255f) * (ratAnim.max_x - ratAnim.min_x);
-            float y = ratAnim.min_y + (context.current_positions[i].y / 255f) * (ratAnim.max_y - ratAnim.min_y);
-            float z = ratAnim.min_z + (context.current_positions[i].z / 255f) * (ratAnim.max_z - ratAnim.min_z);
+            // Convert from 8-bit quantized back to float using RAT bounds (per-cluster for RAT4)
+            var p = Core.DequantizeVertex(ratAnim, i, context.current_positions[i]);
             
             // Convert from right-handed to left-handed coordinates
-            vertices[i] = new Vector3(x, y, -z);
+            vertices[i] = new Vector3(p.x, p.y, -p.z);
         }
         
         // Debug logging
@@ -101,22 +101,13 @@ public static class AutoExporter
                         for (int v = 0; v < ratAnim.num_vertices; v++)
                         {
                             // Dequantize: map from 0-255 back to float using stored bounds
-                            float x = ratAnim.min_x + (context.current_positions[v].x / 255f) * (ratAnim.max_x - ratAnim.min_x);
-                            float y = ratAnim.min_y + (context.current_positions[v].y / 255f) * (ratAnim.max_y - ratAnim.min_y);
-                            float z = ratAnim.min_z + (context.current_positions[v].z / 255f) * (ratAnim.max_z - ratAnim.min_z);
-                            decompressedVertices[v] = new Vector3(x, y, z);
+                            decompressedVertices[v] = Rat.Core.DequantizeVertex(ratAnim, v, context.current_positions[v]);
                         }
                         
                         // Calculate quantization error (max error from 8-bit precision)
-                        float rangeX = ratAnim.max_x - ratAnim.min_x;
-                        float rangeY = ratAnim.max_y - ratAnim.min_y;
-                        float rangeZ = ratAnim.max_z - ratAnim.min_z;
+                        var quantStep = Rat.Core.MaxQuantizationStep(ratAnim);
                         
-                        float quantErrorX = rangeX > 0 ? rangeX / 255f : 0f;
-                        float quantErrorY = rangeY > 0 ? rangeY / 255f : 0f;
-                        float quantErrorZ = rangeZ > 0 ? rangeZ / 255f : 0f;
-                        
-                        float frameMaxError = Mathf.Max(quantErrorX, quantErrorY, quantErrorZ);
+                        float frameMaxError = Mathf.Max(quantStep.x, quantStep.y, quantStep.z);
                         maxVertexError = Mathf.Max(maxVertexError, frameMaxError);
                         avgVertexError += frameMaxError;
                         framesValidated++;
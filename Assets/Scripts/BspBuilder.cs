@@ -0,0 +1,287 @@
+using System;
+using System.Collections.Generic;
+using System.Diagnostics;
+using System.Threading.Tasks;
+using UnityEngine;
+
+/// <summary>
+/// Headless BSP builder for <see cref="Level"/>. Each node scores a bounded, evenly strided sample of face planes
+/// (instead of every face against every face), classifies faces against a plane with a tight dot-product loop over
+/// SoA vertex positions, and builds large front/back subtrees as parallel tasks.
+/// Output is deterministic: candidates depend only on face order, ties keep the earliest candidate, and leaf indices
+/// are assigned afterwards by a front-first walk, so the result does not depend on task scheduling.
+/// </summary>
+public sealed class BspBuilder
+{
+    public struct Stats
+    {
+        public int nodeCount;
+        public int leafCount;
+        public int maxDepth;
+        public float averageLeafDepth;
+        public int minLeafFaces;
+        public int maxLeafFaces;
+        public float averageLeafFaces;
+        public float faceDuplication; // leaf face references / input faces (straddling faces land in both children)
+        public float averageImbalance; // |front - back| / (front + back) over interior nodes, 0 = perfectly balanced
+        public long buildMs;
+
+        public override string ToString()
+        {
+            return $"{nodeCount} nodes, {leafCount} leaves, depth max {maxDepth} avg {averageLeafDepth:F1}, " +
+                   $"faces/leaf {minLeafFaces}-{maxLeafFaces} avg {averageLeafFaces:F1}, duplication {faceDuplication:F2}x, " +
+                   $"imbalance {averageImbalance:F2}, {buildMs}ms";
+        }
+    }
+
+    public int maxDepth = 12;
+    public int minFacesPerLeaf = 8;
+    public float epsilon = 0.001f;
+    public int splitCandidates = 32;     // planes scored per node
+    public int parallelThreshold = 2048; // nodes with at least this many faces build their children concurrently
+
+    private readonly IList<Level.Face> faces;
+    private readonly Vector3[] vertices;
+
+    // Face vertex positions in SoA, CSR by face: face f owns [faceStart[f], faceStart[f + 1])
+    private readonly int[] faceStart;
+    private readonly float[] px, py, pz;
+
+    public Stats LastStats { get; private set; }
+
+    public BspBuilder(IList<Vector3> worldVertices, IList<Level.Face> faces)
+    {
+        this.faces = faces;
+        vertices = new Vector3[worldVertices.Count];
+        worldVertices.CopyTo(vertices, 0);
+
+        faceStart = new int[faces.Count + 1];
+        int total = 0;
+        for (int f = 0; f < faces.Count; f++)
+        {
+            faceStart[f] = total;
+            total += ValidIndexCount(faces[f]);
+        }
+        faceStart[faces.Count] = total;
+
+        px = new float[total];
+        py = new float[total];
+        pz = new float[total];
+        int k = 0;
+        for (int f = 0; f < faces.Count; f++)
+        {
+            foreach (int vi in faces[f].vertexIndices)
+            {
+                if (vi < 0 || vi >= vertices.Length) continue;
+                px[k] = vertices[vi].x;
+                py[k] = vertices[vi].y;
+                pz[k] = vertices[vi].z;
+                k++;
+            }
+        }
+    }
+
+    /// <summary>
+    /// Builds the tree over every face and appends its leaves to <paramref name="leafNodes"/> in front-first order.
+    /// </summary>
+    public Level.BSPNode Build(List<Level.BSPNode> leafNodes)
+    {
+        var timer = Stopwatch.StartNew();
+        var all = new int[faces.Count];
+        for (int f = 0; f < all.Length; f++) all[f] = f;
+
+        Level.BSPNode root = BuildNode(all, 0);
+
+        var stats = new Stats { minLeafFaces = int.MaxValue };
+        float imbalanceSum = 0f;
+        long depthSum = 0, faceRefs = 0;
+        AssignLeaves(root, 0, leafNodes, ref stats, ref imbalanceSum, ref depthSum, ref faceRefs);
+
+        timer.Stop();
+        int interior = stats.nodeCount - stats.leafCount;
+        stats.averageLeafDepth = stats.leafCount > 0 ? depthSum / (float)stats.leafCount : 0f;
+        stats.averageLeafFaces = stats.leafCount > 0 ? faceRefs / (float)stats.leafCount : 0f;
+        stats.faceDuplication = faces.Count > 0 ? faceRefs / (float)faces.Count : 0f;
+        stats.averageImbalance = interior > 0 ? imbalanceSum / interior : 0f;
+        if (stats.leafCount == 0) stats.minLeafFaces = 0;
+        stats.buildMs = timer.ElapsedMilliseconds;
+        LastStats = stats;
+        return root;
+    }
+
+    private Level.BSPNode BuildNode(int[] nodeFaces, int depth)
+    {
+        if (depth >= maxDepth || nodeFaces.Length <= minFacesPerLeaf)
+        {
+            return MakeLeaf(nodeFaces);
+        }
+
+        int splitter = FindBestSplittingFace(nodeFaces);
+        if (splitter < 0) return MakeLeaf(nodeFaces);
+
+        Level.Face plane = faces[splitter];
+        var side = new sbyte[nodeFaces.Length];
+        int frontCount = 0, backCount = 0;
+        for (int i = 0; i < nodeFaces.Length; i++)
+        {
+            side[i] = Classify(nodeFaces[i], plane.normal, plane.d);
+            if (side[i] >= 0) frontCount++; // straddling faces go to both children
+            if (side[i] <= 0) backCount++;
+        }
+
+        // A plane that leaves every face on one side makes no progress
+        if (frontCount == nodeFaces.Length || backCount == nodeFaces.Length) return MakeLeaf(nodeFaces);
+
+        var frontFaces = new int[frontCount];
+        var backFaces = new int[backCount];
+        for (int i = 0, fi = 0, bi = 0; i < nodeFaces.Length; i++)
+        {
+            if (side[i] >= 0) frontFaces[fi++] = nodeFaces[i];
+            if (side[i] <= 0) backFaces[bi++] = nodeFaces[i];
+        }
+
+        var node = new Level.BSPNode
+        {
+            planeNormal = plane.normal,
+            planeDistance = plane.d
+        };
+
+        if (nodeFaces.Length >= parallelThreshold)
+        {
+            Parallel.Invoke(
+                () => node.front = BuildNode(frontFaces, depth + 1),
+                () => node.back = BuildNode(backFaces, depth + 1));
+        }
+        else
+        {
+            node.front = BuildNode(frontFaces, depth + 1);
+            node.back = BuildNode(backFaces, depth + 1);
+        }
+        return node;
+    }
+
+    /// <summary>
+    /// Scores up to <see cref="splitCandidates"/> evenly strided faces; lower is better. Same score as before:
+    /// front/back imbalance plus a heavy penalty per split face.
+    /// </summary>
+    private int FindBestSplittingFace(int[] nodeFaces)
+    {
+        int n = nodeFaces.Length;
+        int candidates = Math.Min(n, Math.Max(1, splitCandidates));
+        int bestFace = -1;
+        float bestScore = float.MaxValue;
+
+        for (int c = 0; c < candidates; c++)
+        {
+            int candidate = nodeFaces[(int)((long)c * n / candidates)];
+            Level.Face plane = faces[candidate];
+            if (plane.normal.sqrMagnitude < 0.5f) continue; // degenerate face
+
+            int frontCount = 0, backCount = 0, splitCount = 0;
+            for (int i = 0; i < n; i++)
+            {
+                int f = nodeFaces[i];
+                if (f == candidate) continue;
+                int result = Classify(f, plane.normal, plane.d);
+                if (result > 0) frontCount++;
+                else if (result < 0) backCount++;
+                else splitCount++;
+            }
+
+            float score = Math.Abs(frontCount - backCount) + splitCount * 8;
+            if (score < bestScore)
+            {
+                bestScore = score;
+                bestFace = candidate;
+            }
+        }
+        return bestFace;
+    }
+
+    /// <summary>
+    /// 1 = in front, -1 = behind or on the plane, 0 = straddling. Planes follow Face: dot(normal, p) + d = 0.
+    /// </summary>
+    private sbyte Classify(int face, Vector3 normal, float d)
+    {
+        float nx = normal.x, ny = normal.y, nz = normal.z;
+        float eps = epsilon;
+        bool positive = false, negative = false;
+        for (int k = faceStart[face], end = faceStart[face + 1]; k < end; k++)
+        {
+            float distance = nx * px[k] + ny * py[k] + nz * pz[k] + d;
+            positive |= distance > eps;
+            negative |= distance < -eps;
+        }
+        if (positive && negative) return 0;
+        return positive ? (sbyte)1 : (sbyte)-1;
+    }
+
+    private Level.BSPNode MakeLeaf(int[] nodeFaces)
+    {
+        var node = new Level.BSPNode(true);
+        node.faces = new List<Level.Face>(nodeFaces.Length);
+        Vector3 min = new Vector3(float.MaxValue, float.MaxValue, float.MaxValue);
+        Vector3 max = new Vector3(float.MinValue, float.MinValue, float.MinValue);
+        foreach (int f in nodeFaces)
+        {
+            node.faces.Add(faces[f]);
+            for (int k = faceStart[f], end = faceStart[f + 1]; k < end; k++)
+            {
+                min = Vector3.Min(min, new Vector3(px[k], py[k], pz[k]));
+                max = Vector3.Max(max, new Vector3(px[k], py[k], pz[k]));
+            }
+        }
+
+        if (min.x <= max.x)
+        {
+            node.bounds = new Bounds((min + max) * 0.5f, max - min);
+            node.center = node.bounds.center;
+        }
+        else
+        {
+            // Empty leaf - create minimal bounds at origin
+            node.bounds = new Bounds(Vector3.zero, Vector3.one * 0.001f);
+            node.center = Vector3.zero;
+        }
+        return node;
+    }
+
+    /// <summary>
+    /// Front-first walk that numbers leaves and gathers statistics. Returns the subtree's leaf face references.
+    /// </summary>
+    private static long AssignLeaves(Level.BSPNode node, int depth, List<Level.BSPNode> leafNodes, ref Stats stats,
+                                     ref float imbalanceSum, ref long depthSum, ref long faceRefs)
+    {
+        if (node == null) return 0;
+        stats.nodeCount++;
+        stats.maxDepth = Math.Max(stats.maxDepth, depth);
+
+        if (node.isLeaf)
+        {
+            node.leafIndex = leafNodes.Count;
+            leafNodes.Add(node);
+            int count = node.faces.Count;
+            stats.leafCount++;
+            stats.minLeafFaces = Math.Min(stats.minLeafFaces, count);
+            stats.maxLeafFaces = Math.Max(stats.maxLeafFaces, count);
+            depthSum += depth;
+            faceRefs += count;
+            return count;
+        }
+
+        long front = AssignLeaves(node.front, depth + 1, leafNodes, ref stats, ref imbalanceSum, ref depthSum, ref faceRefs);
+        long back = AssignLeaves(node.back, depth + 1, leafNodes, ref stats, ref imbalanceSum, ref depthSum, ref faceRefs);
+        if (front + back > 0) imbalanceSum += Math.Abs(front - back) / (float)(front + back);
+        return front + back;
+    }
+
+    private int ValidIndexCount(Level.Face face)
+    {
+        int count = 0;
+        foreach (int vi in face.vertexIndices)
+        {
+            if (vi >= 0 && vi < vertices.Length) count++;
+        }
+        return count;
+    }
+}
@@ -0,0 +1,660 @@
+using System;
+using System.Collections.Generic;
+using System.Diagnostics;
+using System.Threading;
+using UnityEngine;
+
+/// <summary>
+/// Cell/portal visibility for <see cref="Level"/>, an alternative to leaf-to-leaf PVS rays.
+/// 1. Portals: every interior BSP plane is clipped to its node's region and pushed down both subtrees, leaving one
+///    convex polygon per pair of touching leaves. A portal is closed when faces lying on its plane cover it.
+/// 2. Cells: leaves joined by open portals are merged (largest openings first) while the cell stays within
+///    <see cref="cellMaxExtent"/>; open portals between different cells become cell portals.
+/// 3. Flow: from every portal leaving a cell, a depth-first walk through the cell graph clips each next portal to the
+///    anti-penumbra of the source and the portal passed through (separating planes through their edges).
+///    Walks that exceed <see cref="flowBudget"/> steps fall back to plain reachability, so the result stays conservative.
+/// The cell PVS is quadratic in cells rather than leaves, and the cell portals let the runtime narrow the view frustum
+/// portal by portal (Ziz/emu_cull.h). Touches no Unity objects, so it can run off the main thread.
+/// Rows use the EMU PVS bit order: cell j is bit (j % 8) of byte (j / 8).
+/// </summary>
+public sealed class CellPortalSolver
+{
+    public struct Stats
+    {
+        public int leafCount;
+        public int leafPortalCount;
+        public int openLeafPortalCount;
+        public int cellCount;
+        public int cellPortalCount;
+        public long visibleCellPairs; // ordered pairs, self included
+        public long flowSteps;
+        public int budgetFallbacks;   // source cells that hit flowBudget and used reachability instead
+        public long portalMs;
+        public long flowMs;
+
+        public override string ToString()
+        {
+            return $"{leafCount} leaves, {leafPortalCount} leaf portals ({openLeafPortalCount} open), {cellCount} cells, " +
+                   $"{cellPortalCount} cell portals, {visibleCellPairs} visible cell pairs, {flowSteps} flow steps " +
+                   $"({budgetFallbacks} over budget), portals {portalMs}ms, flow {flowMs}ms";
+        }
+    }
+
+    /// <summary>
+    /// Convex polygon between two cells. The plane's front side (dot(normal, p) + d >= 0) faces <see cref="frontCell"/>.
+    /// </summary>
+    public sealed class Portal
+    {
+        public int frontCell;
+        public int backCell;
+        public Vector3 normal;
+        public float d;
+        public Vector3[] points;
+    }
+
+    public float epsilon = 0.01f;      // clipping tolerance, world units
+    public float cellMaxExtent = 32f;  // largest side of a merged cell's box
+    public int flowBudget = 200000;    // flow steps per source cell
+    public int coverageSamples = 4;    // per-triangle sample grid used to decide whether faces close a portal
+
+    public int CellCount { get; private set; }
+    public int[] LeafCells { get; private set; }
+    public List<Portal> CellPortals { get; private set; }
+    public byte[][] CellRows { get; private set; }
+    public Stats LastStats { get; private set; }
+
+    private sealed class LeafPortal
+    {
+        public Level.BSPNode front;
+        public Level.BSPNode back;
+        public Vector3 normal;
+        public float d;
+        public Vector3[] points;
+        public float area;
+        public bool open;
+    }
+
+    // Directed cell portal: leaving 'from' into 'to', normal pointing into 'to'
+    private struct FlowPortal
+    {
+        public int to;
+        public Vector3 normal;
+        public float d;
+        public Vector3[] points;
+    }
+
+    private readonly Vector3[] vertices;
+    private List<LeafPortal> leafPortals;
+    private FlowPortal[][] cellExits;
+
+    public CellPortalSolver(IList<Vector3> worldVertices)
+    {
+        vertices = new Vector3[worldVertices.Count];
+        worldVertices.CopyTo(vertices, 0);
+    }
+
+    /// <summary>
+    /// Builds portals and cells for the tree and solves the cell PVS. <paramref name="worldBounds"/> closes the
+    /// outermost leaves; it should contain every face.
+    /// </summary>
+    public void Solve(Level.BSPNode root, List<Level.BSPNode> leafNodes, Bounds worldBounds)
+    {
+        var timer = Stopwatch.StartNew();
+        var stats = new Stats { leafCount = leafNodes.Count };
+
+        leafPortals = new List<LeafPortal>();
+        if (root != null && !root.isLeaf)
+        {
+            worldBounds.Expand(epsilon * 8f + 1f);
+            var region = new List<Vector4>();
+            AddBoxPlanes(worldBounds, region);
+            MakePortals(root, region, Math.Max(worldBounds.size.magnitude, 1f));
+        }
+        foreach (LeafPortal portal in leafPortals)
+        {
+            portal.area = WindingArea(portal.points);
+            portal.open = !IsCovered(portal);
+            if (portal.open) stats.openLeafPortalCount++;
+        }
+        stats.leafPortalCount = leafPortals.Count;
+
+        BuildCells(leafNodes);
+        stats.cellCount = CellCount;
+        stats.cellPortalCount = CellPortals.Count;
+        stats.portalMs = timer.ElapsedMilliseconds;
+
+        long steps = 0, visiblePairs = 0;
+        int fallbacks = 0;
+        int rowBytes = (CellCount + 7) / 8;
+        var rows = new byte[CellCount][];
+        Rat.Tool.RunParallel(CellCount, cell =>
+        {
+            var row = new byte[rowBytes];
+            long cellSteps;
+            if (!FlowFromCell(cell, row, out cellSteps))
+            {
+                Array.Clear(row, 0, row.Length);
+                MarkReachable(cell, row);
+                Interlocked.Increment(ref fallbacks);
+            }
+            rows[cell] = row;
+            long count = 0;
+            foreach (byte b in row) count += BitCount(b);
+            Interlocked.Add(ref steps, cellSteps);
+            Interlocked.Add(ref visiblePairs, count);
+        });
+        CellRows = rows;
+
+        timer.Stop();
+        stats.flowSteps = steps;
+        stats.visibleCellPairs = visiblePairs;
+        stats.budgetFallbacks = fallbacks;
+        stats.flowMs = timer.ElapsedMilliseconds - stats.portalMs;
+        LastStats = stats;
+        leafPortals = null;
+    }
+
+    /// <summary>
+    /// Per-leaf rows for formats that only know leaf PVS: leaf j is visible from leaf i when their cells are.
+    /// </summary>
+    public byte[][] ExpandLeafRows()
+    {
+        int leafCount = LeafCells.Length;
+        int rowBytes = (leafCount + 7) / 8;
+        var cellRows = new byte[CellCount][];
+        for (int c = 0; c < CellCount; c++)
+        {
+            byte[] row = new byte[rowBytes];
+            for (int j = 0; j < leafCount; j++)
+            {
+                int cj = LeafCells[j];
+                if ((CellRows[c][cj >> 3] & (1 << (cj & 7))) != 0) row[j >> 3] |= (byte)(1 << (j & 7));
+            }
+            cellRows[c] = row;
+        }
+
+        var rows = new byte[leafCount][];
+        for (int i = 0; i < leafCount; i++) rows[i] = (byte[])cellRows[LeafCells[i]].Clone();
+        return rows;
+    }
+
+    // ---- Portal generation ----
+
+    /// <summary>
+    /// Creates the portal on this node's plane (clipped to the node's region) and recurses with the region narrowed
+    /// to each side. Planes in <paramref name="region"/> are (nx, ny, nz, d), inside where dot + d >= 0.
+    /// </summary>
+    private void MakePortals(Level.BSPNode node, List<Vector4> region, float size)
+    {
+        if (node == null || node.isLeaf) return;
+
+        Vector3 n = node.planeNormal;
+        float d = node.planeDistance;
+        Vector3[] winding = BaseWinding(n, d, size);
+        foreach (Vector4 plane in region)
+        {
+            winding = ClipWinding(winding, new Vector3(plane.x, plane.y, plane.z), plane.w, epsilon);
+            if (winding == null) break;
+        }
+        if (winding != null) FilterPortal(winding, n, d, node.front, node.back);
+
+        region.Add(new Vector4(n.x, n.y, n.z, d));
+        MakePortals(node.front, region, size);
+        region[region.Count - 1] = new Vector4(-n.x, -n.y, -n.z, -d);
+        MakePortals(node.back, region, size);
+        region.RemoveAt(region.Count - 1);
+    }
+
+    /// <summary>
+    /// Splits a portal on plane (n, d) down the subtrees on its front and back sides until both sides are leaves.
+    /// </summary>
+    private void FilterPortal(Vector3[] winding, Vector3 n, float d, Level.BSPNode front, Level.BSPNode back)
+    {
+        if (front == null || back == null) return;
+
+        Level.BSPNode splitNode = !front.isLeaf ? front : !back.isLeaf ? back : null;
+        if (splitNode == null)
+        {
+            if (WindingArea(winding) > epsilon * epsilon)
+            {
+                leafPortals.Add(new LeafPortal { front = front, back = back, normal = n, d = d, points = winding });
+            }
+            return;
+        }
+
+        Vector3 sn = splitNode.planeNormal;
+        float sd = splitNode.planeDistance;
+        Vector3[] onFront, onBack;
+        if (!SplitWinding(winding, sn, sd, epsilon, out onFront, out onBack))
+        {
+            // Portal lies on the child's plane: its region is on one side of it, decided by the normals' agreement
+            bool sameFacing = Vector3.Dot(n, sn) > 0f;
+            bool regionInFront = splitNode == front ? sameFacing : !sameFacing;
+            onFront = regionInFront ? winding : null;
+            onBack = regionInFront ? null : winding;
+        }
+
+        if (splitNode == front)
+        {
+            if (onFront != null) FilterPortal(onFront, n, d, front.front, back);
+            if (onBack != null) FilterPortal(onBack, n, d, front.back, back);
+        }
+        else
+        {
+            if (onFront != null) FilterPortal(onFront, n, d, front, back.front);
+            if (onBack != null) FilterPortal(onBack, n, d, front, back.back);
+        }
+    }
+
+    /// <summary>
+    /// True when faces lying on the portal's plane cover every sample point of the portal.
+    /// </summary>
+    private bool IsCovered(LeafPortal portal)
+    {
+        var blockers = new List<Level.Face>();
+        CollectCoplanarFaces(portal.front, portal, blockers);
+        CollectCoplanarFaces(portal.back, portal, blockers);
+        if (blockers.Count == 0) return false;
+
+        Vector3[] w = portal.points;
+        int k = Math.Max(1, coverageSamples);
+        for (int t = 1; t + 1 < w.Length; t++)
+        {
+            for (int a = 0; a <= k; a++)
+            {
+                for (int b = 0; a + b <= k; b++)
+                {
+                    // Sample slightly inside the triangle so shared portal edges don't decide coverage
+                    float u = (a + 0.25f) / (k + 1f), v = (b + 0.25f) / (k + 1f);
+                    Vector3 p = w[0] + (w[t] - w[0]) * u + (w[t + 1] - w[0]) * v;
+                    if (!PointOnFaces(p, portal.normal, blockers)) return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    private void CollectCoplanarFaces(Level.BSPNode leaf, LeafPortal portal, List<Level.Face> output)
+    {
+        float tolerance = epsilon * 2f;
+        foreach (Level.Face face in leaf.faces)
+        {
+            if (output.Contains(face)) continue;
+            bool coplanar = face.vertexIndices.Length >= 3;
+            foreach (int vi in face.vertexIndices)
+            {
+                if (vi < 0 || vi >= vertices.Length || Math.Abs(Vector3.Dot(portal.normal, vertices[vi]) + portal.d) > tolerance)
+                {
+                    coplanar = false;
+                    break;
+                }
+            }
+            if (coplanar) output.Add(face);
+        }
+    }
+
+    private bool PointOnFaces(Vector3 p, Vector3 normal, List<Level.Face> faces)
+    {
+        foreach (Level.Face face in faces)
+        {
+            int[] idx = face.vertexIndices;
+            for (int t = 1; t + 1 < idx.Length; t++)
+            {
+                if (PointInTriangle(p, vertices[idx[0]], vertices[idx[t]], vertices[idx[t + 1]], normal)) return true;
+            }
+        }
+        return false;
+    }
+
+    private static bool PointInTriangle(Vector3 p, Vector3 a, Vector3 b, Vector3 c, Vector3 normal)
+    {
+        // Edge tests against the portal normal work for either triangle winding
+        float ab = Vector3.Dot(Vector3.Cross(b - a, p - a), normal);
+        float bc = Vector3.Dot(Vector3.Cross(c - b, p - b), normal);
+        float ca = Vector3.Dot(Vector3.Cross(a - c, p - c), normal);
+        return (ab >= 0f && bc >= 0f && ca >= 0f) || (ab <= 0f && bc <= 0f && ca <= 0f);
+    }
+
+    // ---- Cells ----
+
+    private void BuildCells(List<Level.BSPNode> leafNodes)
+    {
+        int leafCount = leafNodes.Count;
+        var parent = new int[leafCount];
+        var hasBounds = new bool[leafCount];
+        var cellBounds = new Bounds[leafCount];
+        for (int i = 0; i < leafCount; i++)
+        {
+            parent[i] = i;
+            hasBounds[i] = leafNodes[i].faces.Count > 0;
+            cellBounds[i] = leafNodes[i].bounds;
+        }
+
+        Func<int, int> find = x =>
+        {
+            while (parent[x] != x)
+            {
+                parent[x] = parent[parent[x]];
+                x = parent[x];
+            }
+            return x;
+        };
+
+        // Largest openings first; ties keep portal order so the result is deterministic
+        var order = new List<int>();
+        for (int i = 0; i < leafPortals.Count; i++)
+        {
+            if (leafPortals[i].open) order.Add(i);
+        }
+        order.Sort((x, y) =>
+        {
+            int byArea = leafPortals[y].area.CompareTo(leafPortals[x].area);
+            return byArea != 0 ? byArea : x.CompareTo(y);
+        });
+
+        foreach (int i in order)
+        {
+            int a = find(leafPortals[i].front.leafIndex), b = find(leafPortals[i].back.leafIndex);
+            if (a == b) continue;
+
+            Bounds merged = cellBounds[a];
+            if (hasBounds[a] && hasBounds[b]) merged.Encapsulate(cellBounds[b]);
+            else if (hasBounds[b]) merged = cellBounds[b];
+            Vector3 size = merged.size;
+            if ((hasBounds[a] || hasBounds[b]) && Math.Max(size.x, Math.Max(size.y, size.z)) > cellMaxExtent) continue;
+
+            int root = Math.Min(a, b), child = Math.Max(a, b);
+            parent[child] = root;
+            cellBounds[root] = merged;
+            hasBounds[root] = hasBounds[a] || hasBounds[b];
+        }
+
+        // Number cells by their lowest leaf
+        var cellOfRoot = new int[leafCount];
+        for (int i = 0; i < leafCount; i++) cellOfRoot[i] = -1;
+        LeafCells = new int[leafCount];
+        CellCount = 0;
+        for (int i = 0; i < leafCount; i++)
+        {
+            int r = find(i);
+            if (cellOfRoot[r] < 0) cellOfRoot[r] = CellCount++;
+            LeafCells[i] = cellOfRoot[r];
+        }
+
+        CellPortals = new List<Portal>();
+        var exits = new List<FlowPortal>[CellCount];
+        for (int c = 0; c < CellCount; c++) exits[c] = new List<FlowPortal>();
+        foreach (LeafPortal lp in leafPortals)
+        {
+            if (!lp.open) continue;
+            int front = LeafCells[lp.front.leafIndex], back = LeafCells[lp.back.leafIndex];
+            if (front == back) continue;
+
+            CellPortals.Add(new Portal { frontCell = front, backCell = back, normal = lp.normal, d = lp.d, points = lp.points });
+            var reversed = (Vector3[])lp.points.Clone();
+            Array.Reverse(reversed);
+            exits[back].Add(new FlowPortal { to = front, normal = lp.normal, d = lp.d, points = lp.points });
+            exits[front].Add(new FlowPortal { to = back, normal = -lp.normal, d = -lp.d, points = reversed });
+        }
+        cellExits = new FlowPortal[CellCount][];
+        for (int c = 0; c < CellCount; c++) cellExits[c] = exits[c].ToArray();
+    }
+
+    // ---- Portal flow ----
+
+    private sealed class FlowState
+    {
+        public byte[] row;
+        public bool[] onPath;
+        public long steps;
+        public int budget;
+    }
+
+    /// <summary>
+    /// Marks every cell seen from <paramref name="cell"/> in row. Returns false if the walk ran out of budget.
+    /// </summary>
+    private bool FlowFromCell(int cell, byte[] row, out long steps)
+    {
+        var state = new FlowState { row = row, onPath = new bool[CellCount], budget = Math.Max(1, flowBudget) };
+        SetBit(row, cell);
+        state.onPath[cell] = true;
+        bool complete = true;
+        foreach (FlowPortal source in cellExits[cell])
+        {
+            SetBit(row, source.to);
+            if (state.onPath[source.to]) continue;
+            state.onPath[source.to] = true;
+            complete = Flow(state, source.to, source, source.points, null);
+            state.onPath[source.to] = false;
+            if (!complete) break;
+        }
+        steps = state.steps;
+        return complete;
+    }
+
+    private bool Flow(FlowState state, int cell, FlowPortal sourcePortal, Vector3[] source, Vector3[] pass)
+    {
+        if (++state.steps > state.budget) return false;
+
+        foreach (FlowPortal target in cellExits[cell])
+        {
+            if (state.onPath[target.to]) continue;
+
+            // The target must be beyond the source portal and the source behind the target
+            Vector3[] w = ClipWinding(target.points, sourcePortal.normal, sourcePortal.d, epsilon);
+            if (w == null) continue;
+            Vector3[] src = ClipWinding(source, -target.normal, -target.d, epsilon);
+            if (src == null) continue;
+
+            if (pass != null)
+            {
+                w = ClipToSeparators(src, pass, w, false);
+                if (w == null) continue;
+                w = ClipToSeparators(pass, src, w, true);
+                if (w == null) continue;
+                src = ClipToSeparators(w, pass, src, false);
+                if (src == null) continue;
+                src = ClipToSeparators(pass, w, src, true);
+                if (src == null) continue;
+            }
+
+            SetBit(state.row, target.to);
+            state.onPath[target.to] = true;
+            bool complete = Flow(state, target.to, sourcePortal, src, w);
+            state.onPath[target.to] = false;
+            if (!complete) return false;
+        }
+        return true;
+    }
+
+    /// <summary>
+    /// Clips target to the anti-penumbra of source and pass: planes through an edge of source and a point of pass
+    /// that have the two polygons on opposite sides. With flip the roles of the polygons' sides are swapped.
+    /// </summary>
+    private Vector3[] ClipToSeparators(Vector3[] source, Vector3[] pass, Vector3[] target, bool flip)
+    {
+        for (int i = 0; i < source.Length; i++)
+        {
+            int l = (i + 1) % source.Length;
+            Vector3 edge = source[l] - source[i];
+            for (int j = 0; j < pass.Length; j++)
+            {
+                Vector3 normal = Vector3.Cross(edge, pass[j] - source[i]);
+                float length = normal.magnitude;
+                if (length < epsilon) continue;
+                normal /= length;
+                float d = -Vector3.Dot(normal, pass[j]);
+
+                // Put source on the back side; skip planes the source lies in
+                int k;
+                bool flipPlane = false;
+                for (k = 0; k < source.Length; k++)
+                {
+                    if (k == i || k == l) continue;
+                    float distance = Vector3.Dot(normal, source[k]) + d;
+                    if (distance < -epsilon) break;
+                    if (distance > epsilon)
+                    {
+                        flipPlane = true;
+                        break;
+                    }
+                }
+                if (k == source.Length) continue;
+                if (flipPlane)
+                {
+                    normal = -normal;
+                    d = -d;
+                }
+
+                // A separator has all of pass on the front side
+                int inFront = 0;
+                for (k = 0; k < pass.Length; k++)
+                {
+                    if (k == j) continue;
+                    float distance = Vector3.Dot(normal, pass[k]) + d;
+                    if (distance < -epsilon) break;
+                    if (distance > epsilon) inFront++;
+                }
+                if (k != pass.Length || inFront == 0) continue;
+
+                if (flip)
+                {
+                    normal = -normal;
+                    d = -d;
+                }
+                target = ClipWinding(target, normal, d, epsilon);
+                if (target == null) return null;
+            }
+        }
+        return target;
+    }
+
+    /// <summary>
+    /// Conservative fallback: every cell connected to <paramref name="cell"/> through open portals.
+    /// </summary>
+    private void MarkReachable(int cell, byte[] row)
+    {
+        var queue = new Queue<int>();
+        SetBit(row, cell);
+        queue.Enqueue(cell);
+        while (queue.Count > 0)
+        {
+            foreach (FlowPortal exit in cellExits[queue.Dequeue()])
+            {
+                if ((row[exit.to >> 3] & (1 << (exit.to & 7))) != 0) continue;
+                SetBit(row, exit.to);
+                queue.Enqueue(exit.to);
+            }
+        }
+    }
+
+    // ---- Winding helpers ----
+
+    private static void AddBoxPlanes(Bounds box, List<Vector4> planes)
+    {
+        Vector3 min = box.min, max = box.max;
+        planes.Add(new Vector4(1, 0, 0, -min.x));
+        planes.Add(new Vector4(-1, 0, 0, max.x));
+        planes.Add(new Vector4(0, 1, 0, -min.y));
+        planes.Add(new Vector4(0, -1, 0, max.y));
+        planes.Add(new Vector4(0, 0, 1, -min.z));
+        planes.Add(new Vector4(0, 0, -1, max.z));
+    }
+
+    /// <summary>
+    /// A square of half-size <paramref name="size"/> on the plane, centered on the point closest to the origin.
+    /// </summary>
+    private static Vector3[] BaseWinding(Vector3 n, float d, float size)
+    {
+        Vector3 up = Math.Abs(n.y) < 0.9f ? Vector3.up : Vector3.right;
+        Vector3 right = Vector3.Cross(up, n).normalized;
+        up = Vector3.Cross(n, right);
+        Vector3 origin = -n * d;
+        right *= size;
+        up *= size;
+        return new[] { origin - right + up, origin + right + up, origin + right - up, origin - right - up };
+    }
+
+    /// <summary>
+    /// Keeps the part of the winding with dot(n, p) + d >= -eps. Returns the input when nothing is cut, null when
+    /// nothing is left.
+    /// </summary>
+    private static Vector3[] ClipWinding(Vector3[] points, Vector3 n, float d, float eps)
+    {
+        Vector3[] front, back;
+        if (!SplitWinding(points, n, d, eps, out front, out back)) return points; // on the plane: keep
+        return front;
+    }
+
+    /// <summary>
+    /// Splits a winding by a plane. Returns false if every point lies on the plane (both outputs null).
+    /// A side with nothing on it gets null; a winding entirely on one side is returned as is.
+    /// </summary>
+    private static bool SplitWinding(Vector3[] points, Vector3 n, float d, float eps, out Vector3[] front, out Vector3[] back)
+    {
+        int count = points.Length;
+        var dists = new float[count];
+        int frontCount = 0, backCount = 0;
+        for (int i = 0; i < count; i++)
+        {
+            dists[i] = Vector3.Dot(n, points[i]) + d;
+            if (dists[i] > eps) frontCount++;
+            else if (dists[i] < -eps) backCount++;
+        }
+
+        front = null;
+        back = null;
+        if (frontCount == 0 && backCount == 0) return false;
+        if (backCount == 0)
+        {
+            front = points;
+            return true;
+        }
+        if (frontCount == 0)
+        {
+            back = points;
+            return true;
+        }
+
+        var f = new List<Vector3>(count + 2);
+        var b = new List<Vector3>(count + 2);
+        for (int i = 0; i < count; i++)
+        {
+            Vector3 p = points[i];
+            float dp = dists[i];
+            if (dp >= -eps) f.Add(p);
+            if (dp <= eps) b.Add(p);
+
+            int j = (i + 1) % count;
+            float dq = dists[j];
+            if ((dp > eps && dq < -eps) || (dp < -eps && dq > eps))
+            {
+                Vector3 mid = p + (points[j] - p) * (dp / (dp - dq));
+                f.Add(mid);
+                b.Add(mid);
+            }
+        }
+        front = f.Count >= 3 ? f.ToArray() : null;
+        back = b.Count >= 3 ? b.ToArray() : null;
+        return true;
+    }
+
+    private static float WindingArea(Vector3[] points)
+    {
+        Vector3 sum = Vector3.zero;
+        for (int i = 1; i + 1 < points.Length; i++) sum += Vector3.Cross(points[i] - points[0], points[i + 1] - points[0]);
+        return sum.magnitude * 0.5f;
+    }
+
+    private static void SetBit(byte[] row, int index)
+    {
+        row[index >> 3] |= (byte)(1 << (index & 7));
+    }
+
+    private static int BitCount(byte b)
+    {
+        int count = 0;
+        for (int v = b; v != 0; v &= v - 1) count++;
+        return count;
+    }
+}
@@ -20,6 +20,10 @@ public class Level : MonoBehaviour
     public string textureFileName = ""; // Leave empty to auto-detect from material
     public bool includeChildren = true;
     public bool useNearestFiltering = false; // False = bilinear, True = nearest neighbor
+    public uint emuFormatVersion = 4; // 4 = streamed (emudraw.c load_emu), 5 = mmap-able blob (Ziz/emu5.h)
+    public bool weldVertices = true; // Merge duplicate vertices (same position within weldTolerance and same attributes)
+    public float weldTolerance = 0.0001f;
+    public bool optimizeVertexCache = true; // Reorder each mesh's triangles for post-transform cache reuse
     
     [Header("Texture Processing")]
     public bool generateOptimizedTextures = true;
@@ -40,6 +44,7 @@ public class Level : MonoBehaviour
     public int maxBSPDepth = 12;
     public int minFacesPerLeaf = 8;
     public float epsilon = 0.001f;
+    public int bspSplitCandidates = 32; // Planes scored per node; higher is slower but can split better
     
     [Header("PVS Settings")]
     public bool enablePVSComputation = true;
@@ -47,6 +52,12 @@ public class Level : MonoBehaviour
     public int pvsComputationBatchSize = 10;
     public float maxVisibilityDistance = 100f;
     public int maxSamplePointsPerLeaf = 16;
+    public bool useRayTracedPVS = true; // Multi-threaded BVH ray caster; replaces the Camera/Physics paths below
+    public int pvsRaysPerLeafPair = 64;  // Upper bound; a pair stops after the first packet of four with an unoccluded ray
+    public bool compressPVS = false;     // Zero-run coded PVS rows (Ziz/emu_pvs.h); needs an RLE-aware loader
+    public bool useCellPortalVisibility = false; // Cells + portal flow instead of leaf PVS; v5 stores cell PVS and portals
+    public float cellMaxExtent = 32f;            // Largest side of a merged cell's box
+    public int portalFlowBudget = 200000;        // Flow steps per cell before falling back to plain reachability
     
     [Header("Unity API Integration")]
     public bool useUnityRenderTextures = true;
@@ -75,6 +86,7 @@ public class Level : MonoBehaviour
     private List<BSPNode> leafNodes = new List<BSPNode>();
     private BSPNode rootBSPNode;
     private Dictionary<int, byte[]> leafPVSData = new Dictionary<int, byte[]>();
+    private CellPortalSolver cellVisibility; // set when the PVS came from cells and portals
     
     // Unity API components
     private Camera pvsCamera;
@@ -83,6 +95,8 @@ public class Level : MonoBehaviour
     
     // Performance monitoring
     private System.Diagnostics.Stopwatch performanceTimer = new System.Diagnostics.Stopwatch();
+    private System.Diagnostics.Stopwatch exportPhaseTimer = new System.Diagnostics.Stopwatch();
+    private List<KeyValuePair<string, long>> exportTimings = new List<KeyValuePair<string, long>>();
     private long lastComputationTime;
     private int totalLeafCount;
     private int processedLeafCount;
@@ -95,6 +109,7 @@ public class Level : MonoBehaviour
         public float d; // plane distance
         public Material material;
         public int materialIndex;
+        public int id = -1; // index into Level.faces, assigned once after extraction/welding
         
         public Face(int[] indices, Vector3 norm, Material mat = null)
         {
@@ -239,9 +254,11 @@ public class Level : MonoBehaviour
     public void ExportLevel()
     {
         performanceTimer.Restart();
+        BeginExportTimings();
     Debug.Log("Starting level export...");
         
         PrepareData();
+        MarkExportPhase("extract");
         
         if (worldVertices.Count == 0)
         {
@@ -255,8 +272,16 @@ public class Level : MonoBehaviour
         if (worldNormals.Count != worldVertices.Count)
         {
             GenerateVertexNormals();
+            MarkExportPhase("normals");
         }
         
+        if (weldVertices)
+        {
+            WeldVertices();
+            MarkExportPhase("weld");
+        }
+        AssignFaceIds();
+        
         // Validate data consistency before BSP tree construction
         Debug.Log($"Data validation: {worldVertices.Count} vertices, {worldNormals.Count} normals, {textureCoords.Count} UVs, {vertexColors.Count} colors, {faces.Count} faces");
         
@@ -268,7 +293,8 @@ public class Level : MonoBehaviour
         
         // Build BSP tree
         Debug.Log("Building BSP tree...");
-        rootBSPNode = BuildBSPTree(faces, 0);
+        rootBSPNode = BuildBSPTree(faces);
+        MarkExportPhase("bsp");
         
         // Compute PVS with Unity API
         if (enablePVSComputation)
@@ -284,10 +310,13 @@ public class Level : MonoBehaviour
                 // Run synchronously if async is disabled or cannot start coroutine
                 ComputePVSData();
             }
+            MarkExportPhase("pvs");
         }
         
         // Export to EMU format
         WriteEMUFile();
+        MarkExportPhase("write");
+        LogExportTimings();
         
         if (showDebugInfo)
         {
@@ -297,7 +326,6 @@ public class Level : MonoBehaviour
         
         Debug.Log($"Level exported: {worldVertices.Count} vertices, {faces.Count} faces");
         performanceTimer.Stop();
-        Debug.Log($"Total export time: {performanceTimer.ElapsedMilliseconds}ms");
     }
     
     /// <summary>
@@ -313,6 +341,7 @@ public class Level : MonoBehaviour
         faces.Clear();
         leafNodes.Clear();
         rootBSPNode = null;
+        cellVisibility = null;
         
         if (includeChildren)
         {
@@ -358,31 +387,46 @@ public class Level : MonoBehaviour
         Vector2[] uvs = mesh.uv;
         Color[] colors = mesh.colors;
         
+        var positions = new Vector3[vertices.Length];
+        var worldSpaceNormals = new Vector3[vertices.Length];
         for (int i = 0; i < vertices.Length; i++)
         {
-            worldVertices.Add(worldMatrix.MultiplyPoint3x4(vertices[i]));
-            
-            if (normals.Length > i)
-                worldNormals.Add(worldMatrix.MultiplyVector(normals[i]).normalized);
-            else
-                worldNormals.Add(Vector3.up);
-                
-            if (uvs.Length > i)
-                textureCoords.Add(uvs[i]);
-            else
-                textureCoords.Add(Vector2.zero);
-                
-            if (colors.Length > i)
-                vertexColors.Add(colors[i]);
-            else
-                vertexColors.Add(Color.white);
+            positions[i] = worldMatrix.MultiplyPoint3x4(vertices[i]);
+            worldSpaceNormals[i] = normals.Length > i ? worldMatrix.MultiplyVector(normals[i]).normalized : Vector3.up;
         }
+        worldVertices.AddRange(positions);
+        worldNormals.AddRange(worldSpaceNormals);
+        
+        if (uvs.Length >= vertices.Length)
+            textureCoords.AddRange(uvs.Length == vertices.Length ? uvs : uvs.Take(vertices.Length));
+        else
+            textureCoords.AddRange(uvs.Concat(Enumerable.Repeat(Vector2.zero, vertices.Length - uvs.Length)));
+            
+        if (colors.Length >= vertices.Length)
+            vertexColors.AddRange(colors.Length == vertices.Length ? colors : colors.Take(vertices.Length));
+        else
+            vertexColors.AddRange(colors.Concat(Enumerable.Repeat(Color.white, vertices.Length - colors.Length)));
+        
+        // One copy of the material array per mesh (Renderer.materials would also instantiate materials)
+        Material[] sharedMaterials = meshRenderer != null ? meshRenderer.sharedMaterials : null;
+        long indexCount = 0;
+        for (int submesh = 0; submesh < mesh.subMeshCount; submesh++) indexCount += mesh.GetIndexCount(submesh);
+        faces.Capacity = Math.Max(faces.Capacity, faces.Count + (int)(indexCount / 3));
         
         // Process triangles
         for (int submesh = 0; submesh < mesh.subMeshCount; submesh++)
         {
             int[] triangles = mesh.GetTriangles(submesh);
-            Material material = meshRenderer?.materials?.Length > submesh ? meshRenderer.materials[submesh] : null;
+            if (optimizeVertexCache && triangles.Length >= 6)
+            {
+                float acmrBefore = VertexCacheOptimizer.ComputeACMR(triangles);
+                triangles = VertexCacheOptimizer.OptimizeTriangleOrder(triangles, vertices.Length);
+                if (showDebugInfo)
+                {
+                    Debug.Log($"Level: {obj.name} submesh {submesh} ACMR {acmrBefore:F3} -> {VertexCacheOptimizer.ComputeACMR(triangles):F3}");
+                }
+            }
+            Material material = sharedMaterials != null && sharedMaterials.Length > submesh ? sharedMaterials[submesh] : null;
             
             for (int i = 0; i < triangles.Length; i += 3)
             {
@@ -392,9 +436,9 @@ public class Level : MonoBehaviour
                     triangles[i + 2] + vertexOffset
                 };
                 
-                Vector3 v0 = worldVertices[faceIndices[0]];
-                Vector3 v1 = worldVertices[faceIndices[1]];
-                Vector3 v2 = worldVertices[faceIndices[2]];
+                Vector3 v0 = positions[triangles[i]];
+                Vector3 v1 = positions[triangles[i + 1]];
+                Vector3 v2 = positions[triangles[i + 2]];
                 
                 Vector3 normal = Vector3.Cross(v1 - v0, v2 - v0).normalized;
                 Face face = new Face(faceIndices, normal, material);
@@ -412,189 +456,175 @@ public class Level : MonoBehaviour
     /// </summary>
     private void GenerateVertexNormals()
     {
-        worldNormals.Clear();
-        worldNormals.AddRange(new Vector3[worldVertices.Count]);
+        var accumulated = new Vector3[worldVertices.Count];
         
         foreach (Face face in faces)
         {
             foreach (int vertexIndex in face.vertexIndices)
             {
-                worldNormals[vertexIndex] += face.normal;
+                accumulated[vertexIndex] += face.normal;
             }
         }
         
-        for (int i = 0; i < worldNormals.Count; i++)
+        for (int i = 0; i < accumulated.Length; i++)
         {
-            worldNormals[i] = worldNormals[i].normalized;
+            accumulated[i] = accumulated[i].normalized;
         }
-    }
-    
-    /// <summary>
-    /// Build BSP tree with improved splitting
-    /// </summary>
-    private BSPNode BuildBSPTree(List<Face> nodeFaces, int depth)
-    {
-        BSPNode node = new BSPNode();
         
-        if (depth >= maxBSPDepth || nodeFaces.Count <= minFacesPerLeaf)
-        {
-            node.isLeaf = true;
-            node.faces = new List<Face>(nodeFaces);
-            node.leafIndex = leafNodes.Count;
-            leafNodes.Add(node);
-            
-            // Calculate leaf bounds
-            CalculateNodeBounds(node);
-            return node;
-        }
-        
-        // Find best splitting plane
-        Face splittingFace = FindBestSplittingPlane(nodeFaces);
-        if (splittingFace == null)
-        {
-            node.isLeaf = true;
-            node.faces = new List<Face>(nodeFaces);
-            node.leafIndex = leafNodes.Count;
-            leafNodes.Add(node);
-            CalculateNodeBounds(node);
-            return node;
-        }
-        
-        node.planeNormal = splittingFace.normal;
-        node.planeDistance = splittingFace.d;
-        
-        // Split faces
-        List<Face> frontFaces = new List<Face>();
-        List<Face> backFaces = new List<Face>();
-        
-        foreach (Face face in nodeFaces)
-        {
-            ClassifyFaceAgainstPlane(face, node, frontFaces, backFaces);
-        }
-        
-        // Build child nodes
-        if (frontFaces.Count > 0)
-            node.front = BuildBSPTree(frontFaces, depth + 1);
-        if (backFaces.Count > 0)
-            node.back = BuildBSPTree(backFaces, depth + 1);
-            
-        CalculateNodeBounds(node);
-        return node;
+        worldNormals.Clear();
+        worldNormals.AddRange(accumulated);
     }
     
     /// <summary>
-    /// Calculate bounds for BSP node
+    /// Merge vertices whose position (within weldTolerance) and attributes match, using a spatial hash of
+    /// tolerance-sized cells so each vertex only compares against neighbours in the surrounding 27 cells.
+    /// Faces are remapped and any that collapse to a degenerate triangle are dropped.
     /// </summary>
-    private void CalculateNodeBounds(BSPNode node)
+    private void WeldVertices()
     {
-        if (node.isLeaf)
+        int count = worldVertices.Count;
+        float tolerance = Mathf.Max(weldTolerance, 1e-6f);
+        float toleranceSq = tolerance * tolerance;
+        float inverseCell = 1f / tolerance;
+        
+        var cellHead = new Dictionary<long, int>(count);
+        var nextInCell = new int[count];
+        var remap = new int[count];
+        var keptVertices = new List<Vector3>(count);
+        var keptNormals = new List<Vector3>(count);
+        var keptUVs = new List<Vector2>(count);
+        var keptColors = new List<Color>(count);
+        
+        for (int i = 0; i < count; i++)
         {
-            if (node.faces.Count > 0)
+            Vector3 p = worldVertices[i];
+            int cx = Mathf.FloorToInt(p.x * inverseCell);
+            int cy = Mathf.FloorToInt(p.y * inverseCell);
+            int cz = Mathf.FloorToInt(p.z * inverseCell);
+            
+            int match = -1;
+            for (int dz = -1; dz <= 1 && match < 0; dz++)
+            for (int dy = -1; dy <= 1 && match < 0; dy++)
+            for (int dx = -1; dx <= 1 && match < 0; dx++)
             {
-                Vector3 min = new Vector3(float.MaxValue, float.MaxValue, float.MaxValue);
-                Vector3 max = new Vector3(float.MinValue, float.MinValue, float.MinValue);
-                
-                foreach (Face face in node.faces)
+                if (!cellHead.TryGetValue(WeldCellKey(cx + dx, cy + dy, cz + dz), out int k)) continue;
+                for (; k >= 0; k = nextInCell[k])
                 {
-                    foreach (int vertexIndex in face.vertexIndices)
+                    if ((keptVertices[k] - p).sqrMagnitude <= toleranceSq &&
+                        Vector3.Dot(keptNormals[k], worldNormals[i]) >= 0.999f &&
+                        (keptUVs[k] - textureCoords[i]).sqrMagnitude <= 1e-6f &&
+                        ColorsMatch(keptColors[k], vertexColors[i]))
                     {
-                        if (vertexIndex >= 0 && vertexIndex < worldVertices.Count)
-                        {
-                            Vector3 vertex = worldVertices[vertexIndex];
-                            min = Vector3.Min(min, vertex);
-                            max = Vector3.Max(max, vertex);
-                        }
+                        match = k;
+                        break;
                     }
                 }
-                
-                node.bounds = new Bounds((min + max) * 0.5f, max - min);
-                node.center = node.bounds.center;
             }
-            else
+            
+            if (match < 0)
             {
-                // Empty leaf - create minimal bounds at origin
-                node.bounds = new Bounds(Vector3.zero, Vector3.one * 0.001f);
-                node.center = Vector3.zero;
+                match = keptVertices.Count;
+                keptVertices.Add(p);
+                keptNormals.Add(worldNormals[i]);
+                keptUVs.Add(textureCoords[i]);
+                keptColors.Add(vertexColors[i]);
+                
+                long key = WeldCellKey(cx, cy, cz);
+                nextInCell[match] = cellHead.TryGetValue(key, out int head) ? head : -1;
+                cellHead[key] = match;
             }
+            remap[i] = match;
         }
-    }
-    
-    /// <summary>
-    /// Find the best plane for splitting faces
-    /// </summary>
-    private Face FindBestSplittingPlane(List<Face> faces)
-    {
-        Face bestFace = null;
-        float bestScore = float.MaxValue;
         
-        foreach (Face candidateFace in faces)
+        int removedFaces = 0;
+        int writeIndex = 0;
+        for (int f = 0; f < faces.Count; f++)
         {
-            int frontCount = 0;
-            int backCount = 0;
-            int splitCount = 0;
-            
-            foreach (Face testFace in faces)
+            Face face = faces[f];
+            int[] indices = face.vertexIndices;
+            for (int k = 0; k < indices.Length; k++)
             {
-                if (testFace == candidateFace) continue;
-                
-                int result = ClassifyFace(testFace, candidateFace);
-                if (result > 0) frontCount++;
-                else if (result < 0) backCount++;
-                else splitCount++;
+                indices[k] = remap[indices[k]];
             }
-            
-            float score = Math.Abs(frontCount - backCount) + splitCount * 8;
-            if (score < bestScore)
+            if (indices.Length >= 3 && (indices[0] == indices[1] || indices[1] == indices[2] || indices[0] == indices[2]))
             {
-                bestScore = score;
-                bestFace = candidateFace;
+                removedFaces++;
+                continue;
             }
+            faces[writeIndex++] = face;
         }
+        faces.RemoveRange(writeIndex, faces.Count - writeIndex);
         
-        return bestFace;
+        worldVertices = keptVertices;
+        worldNormals = keptNormals;
+        textureCoords = keptUVs;
+        vertexColors = keptColors;
+        
+        Debug.Log($"Vertex welding: {count} -> {worldVertices.Count} vertices, {removedFaces} degenerate faces removed");
+    }
+    
+    private static long WeldCellKey(int x, int y, int z)
+    {
+        return ((long)(x & 0x1FFFFF) << 42) | ((long)(y & 0x1FFFFF) << 21) | (long)(z & 0x1FFFFF);
+    }
+    
+    private static bool ColorsMatch(Color a, Color b)
+    {
+        const float tolerance = 1f / 512f;
+        return Mathf.Abs(a.r - b.r) <= tolerance && Mathf.Abs(a.g - b.g) <= tolerance &&
+               Mathf.Abs(a.b - b.b) <= tolerance && Mathf.Abs(a.a - b.a) <= tolerance;
     }
     
     /// <summary>
-    /// Classify face relative to splitting plane
+    /// Number faces once so leaves can reference them by id instead of searching the face list
     /// </summary>
-    private int ClassifyFace(Face face, Face plane)
+    private void AssignFaceIds()
     {
-        int positive = 0;
-        int negative = 0;
-        
-        foreach (int vertexIndex in face.vertexIndices)
+        for (int i = 0; i < faces.Count; i++)
         {
-            Vector3 vertex = worldVertices[vertexIndex];
-            float distance = Vector3.Dot(plane.normal, vertex) - plane.d;
-            
-            if (distance > epsilon) positive++;
-            else if (distance < -epsilon) negative++;
+            faces[i].id = i;
         }
-        
-        if (positive > 0 && negative > 0) return 0; // straddling
-        if (positive > 0) return 1; // front
-        return -1; // back
+    }
+    
+    private void BeginExportTimings()
+    {
+        exportTimings.Clear();
+        exportPhaseTimer.Restart();
+    }
+    
+    private void MarkExportPhase(string phase)
+    {
+        exportTimings.Add(new KeyValuePair<string, long>(phase, exportPhaseTimer.ElapsedMilliseconds));
+        exportPhaseTimer.Restart();
+    }
+    
+    private void LogExportTimings()
+    {
+        long total = 0;
+        var breakdown = new StringBuilder();
+        foreach (var phase in exportTimings)
+        {
+            total += phase.Value;
+            breakdown.Append($" {phase.Key}={phase.Value}ms");
+        }
+        Debug.Log($"<color=teal>Export timing:</color> total={total}ms{breakdown}");
     }
     
     /// <summary>
-    /// Classify and split face against BSP plane
+    /// Build BSP tree over all faces (sampled split candidates, parallel subtrees, deterministic leaf order)
     /// </summary>
-    private void ClassifyFaceAgainstPlane(Face face, BSPNode node, List<Face> frontFaces, List<Face> backFaces)
+    private BSPNode BuildBSPTree(List<Face> nodeFaces)
     {
-        // Create a temporary plane face for classification
-        Face planeFace = new Face(new int[] { 0 }, node.planeNormal) { d = node.planeDistance };
-        int classification = ClassifyFace(face, planeFace);
-        
-        if (classification > 0)
-            frontFaces.Add(face);
-        else if (classification < 0)
-            backFaces.Add(face);
-        else
+        var builder = new BspBuilder(worldVertices, nodeFaces)
         {
-            // Face straddles plane - add to both sides for simplicity
-            frontFaces.Add(face);
-            backFaces.Add(face);
-        }
+            maxDepth = maxBSPDepth,
+            minFacesPerLeaf = minFacesPerLeaf,
+            epsilon = epsilon,
+            splitCandidates = bspSplitCandidates
+        };
+        BSPNode root = builder.Build(leafNodes);
+        Debug.Log($"BSP build: {builder.LastStats}");
+        return root;
     }
     
     /// <summary>
@@ -604,6 +634,24 @@ public class Level : MonoBehaviour
     {
         if (leafNodes.Count == 0) return;
         
+        if (useCellPortalVisibility)
+        {
+            performanceTimer.Restart();
+            CellPortalSolver cellSolver = CreateCellPortalSolver(out Bounds worldBounds);
+            cellSolver.Solve(rootBSPNode, leafNodes, worldBounds);
+            FinishCellPortalVisibility(cellSolver);
+            return;
+        }
+        
+        if (useRayTracedPVS)
+        {
+            performanceTimer.Restart();
+            PvsSolver solver = CreatePVSSolver(out Bounds[] leafBounds);
+            byte[][] rows = solver.Solve(leafBounds, maxSamplePointsPerLeaf, pvsRaysPerLeafPair, maxVisibilityDistance);
+            FinishRayTracedPVS(solver, rows);
+            return;
+        }
+        
         performanceTimer.Restart();
         leafPVSData.Clear();
         totalLeafCount = leafNodes.Count;
@@ -643,6 +691,53 @@ public class Level : MonoBehaviour
     {
         if (leafNodes.Count == 0) yield break;
         
+        if (useCellPortalVisibility)
+        {
+            // Like the ray-traced solver, portal flow touches no Unity objects and runs on the thread pool
+            performanceTimer.Restart();
+            CellPortalSolver cellSolver = CreateCellPortalSolver(out Bounds worldBounds);
+            BSPNode root = rootBSPNode;
+            var cellTask = System.Threading.Tasks.Task.Run(() => cellSolver.Solve(root, leafNodes, worldBounds));
+            while (!cellTask.IsCompleted)
+            {
+                yield return null;
+            }
+            
+            if (cellTask.IsFaulted)
+            {
+                Debug.LogError($"Cell/portal visibility failed: {cellTask.Exception.GetBaseException()}");
+                yield break;
+            }
+            
+            FinishCellPortalVisibility(cellSolver);
+            WriteEMUFile();
+            yield break;
+        }
+        
+        if (useRayTracedPVS)
+        {
+            // The solver never touches Unity objects, so run the whole solve off the main thread and poll it
+            performanceTimer.Restart();
+            PvsSolver solver = CreatePVSSolver(out Bounds[] leafBounds);
+            int samples = maxSamplePointsPerLeaf, rays = pvsRaysPerLeafPair;
+            float distance = maxVisibilityDistance;
+            var solveTask = System.Threading.Tasks.Task.Run(() => solver.Solve(leafBounds, samples, rays, distance));
+            while (!solveTask.IsCompleted)
+            {
+                yield return null;
+            }
+            
+            if (solveTask.IsFaulted)
+            {
+                Debug.LogError($"Ray-traced PVS failed: {solveTask.Exception.GetBaseException()}");
+                yield break;
+            }
+            
+            FinishRayTracedPVS(solver, solveTask.Result);
+            WriteEMUFile();
+            yield break;
+        }
+        
         performanceTimer.Restart();
         leafPVSData.Clear();
         totalLeafCount = leafNodes.Count;
@@ -686,6 +781,103 @@ public class Level : MonoBehaviour
         
     }
     
+    /// <summary>
+    /// Snapshot the level triangles into a PvsSolver and collect leaf bounds in leaf index order
+    /// </summary>
+    private PvsSolver CreatePVSSolver(out Bounds[] leafBounds)
+    {
+        var triangles = new List<int>(faces.Count * 3);
+        foreach (Face face in faces)
+        {
+            // Fan-triangulate, skipping anything that would index outside the vertex list
+            int[] indices = face.vertexIndices;
+            if (indices == null || indices.Length < 3) continue;
+            for (int k = 1; k + 1 < indices.Length; k++)
+            {
+                int a = indices[0], b = indices[k], c = indices[k + 1];
+                if (a < 0 || b < 0 || c < 0 || a >= worldVertices.Count || b >= worldVertices.Count || c >= worldVertices.Count) continue;
+                triangles.Add(a);
+                triangles.Add(b);
+                triangles.Add(c);
+            }
+        }
+        
+        leafBounds = new Bounds[leafNodes.Count];
+        for (int i = 0; i < leafNodes.Count; i++)
+        {
+            leafBounds[i] = leafNodes[i].bounds;
+        }
+        
+        Debug.Log($"Computing PVS for {leafNodes.Count} leaves with BVH ray caster ({triangles.Count / 3} triangles)...");
+        return new PvsSolver(worldVertices.ToArray(), triangles.ToArray());
+    }
+    
+    /// <summary>
+    /// Store solver rows as leaf PVS data and report timings
+    /// </summary>
+    private void FinishRayTracedPVS(PvsSolver solver, byte[][] rows)
+    {
+        leafPVSData.Clear();
+        for (int i = 0; i < rows.Length; i++)
+        {
+            leafPVSData[i] = rows[i];
+        }
+        totalLeafCount = leafNodes.Count;
+        processedLeafCount = rows.Length;
+        
+        performanceTimer.Stop();
+        lastComputationTime = performanceTimer.ElapsedMilliseconds;
+        
+        if (enablePerformanceMonitoring)
+        {
+            MonitorPVSPerformance();
+        }
+        
+        Debug.Log($"PVS computation completed in {lastComputationTime}ms: {solver.LastStats}");
+    }
+    
+    /// <summary>
+    /// Configure a CellPortalSolver over the level vertices; world bounds close off the outermost BSP regions
+    /// </summary>
+    private CellPortalSolver CreateCellPortalSolver(out Bounds worldBounds)
+    {
+        worldBounds = new Bounds(worldVertices[0], Vector3.zero);
+        foreach (Vector3 vertex in worldVertices) worldBounds.Encapsulate(vertex);
+        
+        Debug.Log($"Computing cell/portal visibility for {leafNodes.Count} leaves...");
+        return new CellPortalSolver(worldVertices)
+        {
+            cellMaxExtent = cellMaxExtent,
+            flowBudget = portalFlowBudget
+        };
+    }
+    
+    /// <summary>
+    /// Keep the cell solution for the v5 writer and expand it to leaf rows for v4 and the PVS statistics
+    /// </summary>
+    private void FinishCellPortalVisibility(CellPortalSolver solver)
+    {
+        cellVisibility = solver;
+        byte[][] rows = solver.ExpandLeafRows();
+        leafPVSData.Clear();
+        for (int i = 0; i < rows.Length; i++)
+        {
+            leafPVSData[i] = rows[i];
+        }
+        totalLeafCount = leafNodes.Count;
+        processedLeafCount = rows.Length;
+        
+        performanceTimer.Stop();
+        lastComputationTime = performanceTimer.ElapsedMilliseconds;
+        
+        if (enablePerformanceMonitoring)
+        {
+            MonitorPVSPerformance();
+        }
+        
+        Debug.Log($"Cell/portal visibility completed in {lastComputationTime}ms: {solver.LastStats}");
+    }
+    
     /// <summary>
     /// Compute PVS for a single leaf using Unity APIs
     /// </summary>
@@ -945,6 +1137,12 @@ public class Level : MonoBehaviour
         
         string fullPath = Path.Combine(generatedDataPath, outputFileName);
         
+        if (emuFormatVersion >= 5)
+        {
+            WriteEMUFileV5(fullPath);
+            return;
+        }
+        
         using (FileStream fs = new FileStream(fullPath, FileMode.Create))
         using (BinaryWriter writer = new BinaryWriter(fs))
         {
@@ -961,26 +1159,7 @@ public class Level : MonoBehaviour
             writer.Write((uint)leafNodes.Count);      // lcount (leaf count)
             
             // Write texture filename with length prefix (uint32 length + string data)
-            string textureFilename = textureFileName;
-            
-            // If no user-specified filename, try to auto-detect from material
-            if (string.IsNullOrEmpty(textureFilename))
-            {
-                if (gameObject.GetComponent<Renderer>() != null)
-                {
-                    var renderer = gameObject.GetComponent<Renderer>();
-                    if (renderer.material != null && renderer.material.mainTexture != null)
-                    {
-                        textureFilename = renderer.material.mainTexture.name + ".png";
-                    }
-                }
-            }
-            
-            // If still no texture found, use default
-            if (string.IsNullOrEmpty(textureFilename))
-            {
-                textureFilename = "default.png";
-            }
+            string textureFilename = ResolveTextureFileName();
             
             // Write texture filename as length-prefixed string (matching C's expectations)
             byte[] textureFilenameBytes = System.Text.Encoding.UTF8.GetBytes(textureFilename);
@@ -996,139 +1175,139 @@ public class Level : MonoBehaviour
             Debug.Log($"<color=green>OK</color> EMU Texture: '{textureFilename}' ({textureFilenameBytes.Length} bytes), filter={filterMode}");
             
             // Vertex data (vcount × 3 floats) - NO COUNT PREFIX!
-            foreach (Vector3 vertex in worldVertices) 
+            PadVertexAttributes();
+            int vcount = worldVertices.Count;
+            var floatBuffer = new float[vcount * 3];
+            for (int i = 0; i < vcount; i++)
             {
                 // Flip Z for right-handed coordinate system (OpenGL)
-                writer.Write(vertex.x);
-                writer.Write(vertex.y);
-                writer.Write(-vertex.z);
+                Vector3 vertex = worldVertices[i];
+                floatBuffer[i * 3] = vertex.x;
+                floatBuffer[i * 3 + 1] = vertex.y;
+                floatBuffer[i * 3 + 2] = -vertex.z;
             }
-            Debug.Log($"<color=green>OK</color> Vertices: {worldVertices.Count} × 3 floats (Z-flipped)");
+            WriteFloatArray(writer, floatBuffer, floatBuffer.Length);
+            Debug.Log($"<color=green>OK</color> Vertices: {vcount} × 3 floats (Z-flipped)");
             
             // Normal data (vcount × 3 floats) - NO COUNT PREFIX!
-            while (worldNormals.Count < worldVertices.Count)
-            {
-                worldNormals.Add(Vector3.up);
-            }
-            
-            foreach (Vector3 normal in worldNormals)
+            for (int i = 0; i < vcount; i++)
             {
-                writer.Write(normal.x);
-                writer.Write(normal.y);
-                writer.Write(-normal.z);
+                Vector3 normal = worldNormals[i];
+                floatBuffer[i * 3] = normal.x;
+                floatBuffer[i * 3 + 1] = normal.y;
+                floatBuffer[i * 3 + 2] = -normal.z;
             }
-            Debug.Log($"<color=green>OK</color> Normals: {worldNormals.Count} × 3 floats (Z-flipped)");
+            WriteFloatArray(writer, floatBuffer, floatBuffer.Length);
+            Debug.Log($"<color=green>OK</color> Normals: {vcount} × 3 floats (Z-flipped)");
             
             // UV data (vcount × 2 bytes) - NO COUNT PREFIX!
             // emudraw.c expects uint8_t u, v format
-            while (textureCoords.Count < worldVertices.Count)
+            var byteBuffer = new byte[vcount * 3];
+            for (int i = 0; i < vcount; i++)
             {
-                textureCoords.Add(Vector2.zero);
+                Vector2 uv = textureCoords[i];
+                byteBuffer[i * 2] = (byte)(Mathf.Clamp01(uv.x) * 255);            // U as byte
+                byteBuffer[i * 2 + 1] = (byte)(Mathf.Clamp01(1.0f - uv.y) * 255); // V as byte (flipped)
             }
-            
-            foreach (Vector2 uv in textureCoords)
-            {
-                writer.Write((byte)(Mathf.Clamp01(uv.x) * 255)); // U as byte
-                writer.Write((byte)(Mathf.Clamp01(1.0f - uv.y) * 255)); // V as byte (flipped)
-            }
-            Debug.Log($"<color=green>OK</color> UVs: {textureCoords.Count} × 2 bytes (V-flipped)");
+            writer.Write(byteBuffer, 0, vcount * 2);
+            Debug.Log($"<color=green>OK</color> UVs: {vcount} × 2 bytes (V-flipped)");
             
             // Color data (vcount × 3 bytes) - NO COUNT PREFIX!
             // emudraw.c expects RGB bytes (no alpha)
-            while (vertexColors.Count < worldVertices.Count)
-            {
-                vertexColors.Add(Color.white);
-            }
-            
-            foreach (Color color in vertexColors)
+            for (int i = 0; i < vcount; i++)
             {
-                writer.Write((byte)(Mathf.Clamp01(color.r) * 255)); // Red
-                writer.Write((byte)(Mathf.Clamp01(color.g) * 255)); // Green
-                writer.Write((byte)(Mathf.Clamp01(color.b) * 255)); // Blue
+                Color color = vertexColors[i];
+                byteBuffer[i * 3] = (byte)(Mathf.Clamp01(color.r) * 255);
+                byteBuffer[i * 3 + 1] = (byte)(Mathf.Clamp01(color.g) * 255);
+                byteBuffer[i * 3 + 2] = (byte)(Mathf.Clamp01(color.b) * 255);
             }
-            Debug.Log($"<color=green>OK</color> Colors: {vertexColors.Count} × 3 bytes (RGB)");
+            writer.Write(byteBuffer, 0, vcount * 3);
+            Debug.Log($"<color=green>OK</color> Colors: {vcount} × 3 bytes (RGB)");
             
             // Face data (fcount × 3 uint32) - NO COUNT PREFIX!
-            foreach (Face face in faces)
+            var indexBuffer = new uint[faces.Count * 3];
+            for (int f = 0; f < faces.Count; f++)
             {
-                if (face.vertexIndices.Length < 3)
+                int[] indices = faces[f].vertexIndices;
+                if (indices.Length < 3)
                 {
-                    Debug.LogError($"Face has only {face.vertexIndices.Length} vertices!");
-                    continue;
+                    Debug.LogError($"Face has only {indices.Length} vertices!");
+                    continue; // written as a degenerate 0,0,0 triangle
                 }
                 
-                // Validate and clamp indices
-                for (int i = 0; i < 3; i++)
-                {
-                    if (face.vertexIndices[i] >= worldVertices.Count)
-                    {
-                        face.vertexIndices[i] = 0;
-                    }
-                }
-                
-                // Flip winding for OpenGL (indices written as v0, v2, v1 instead of v0, v1, v2)
-                writer.Write((uint)face.vertexIndices[0]);
-                writer.Write((uint)face.vertexIndices[2]);
-                writer.Write((uint)face.vertexIndices[1]);
+                // Flip winding for OpenGL (indices written as v0, v2, v1 instead of v0, v1, v2); out-of-range indices become 0
+                indexBuffer[f * 3] = indices[0] < vcount ? (uint)indices[0] : 0;
+                indexBuffer[f * 3 + 1] = indices[2] < vcount ? (uint)indices[2] : 0;
+                indexBuffer[f * 3 + 2] = indices[1] < vcount ? (uint)indices[1] : 0;
             }
+            WriteUIntArray(writer, indexBuffer, indexBuffer.Length);
             Debug.Log($"<color=green>OK</color> Faces: {faces.Count} × 3 uint32 indices (winding flipped)");
             
             // Leaf data (lcount leaves) - NO COUNT PREFIX!
+            // Each leaf: face count, face ids, then bounding box (Vec3 min, Vec3 max = 6 floats)
+            var leafBuffer = new uint[0];
+            var boundsBuffer = new float[6];
             for (int i = 0; i < leafNodes.Count; i++)
             {
                 BSPNode leaf = leafNodes[i];
+                int count = leaf.faces.Count;
+                if (leafBuffer.Length < count + 1) leafBuffer = new uint[Math.Max(count + 1, leafBuffer.Length * 2)];
                 
-                // Write face count for this leaf
-                writer.Write((uint)leaf.faces.Count);
-                
-                // Write face indices for this leaf
-                foreach (Face face in leaf.faces)
+                leafBuffer[0] = (uint)count;
+                for (int k = 0; k < count; k++)
                 {
-                    int faceIndex = faces.IndexOf(face);
-                    if (faceIndex == -1) faceIndex = 0;
-                    writer.Write((uint)faceIndex);
+                    int faceIndex = leaf.faces[k].id;
+                    leafBuffer[k + 1] = faceIndex >= 0 && faceIndex < faces.Count ? (uint)faceIndex : 0;
                 }
+                WriteUIntArray(writer, leafBuffer, count + 1);
                 
-                // Write leaf bounding box (Vec3 min, Vec3 max = 6 floats)
-                writer.Write(leaf.bounds.min.x);
-                writer.Write(leaf.bounds.min.y);
-                writer.Write(leaf.bounds.min.z);
-                writer.Write(leaf.bounds.max.x);
-                writer.Write(leaf.bounds.max.y);
-                writer.Write(leaf.bounds.max.z);
+                boundsBuffer[0] = leaf.bounds.min.x;
+                boundsBuffer[1] = leaf.bounds.min.y;
+                boundsBuffer[2] = leaf.bounds.min.z;
+                boundsBuffer[3] = leaf.bounds.max.x;
+                boundsBuffer[4] = leaf.bounds.max.y;
+                boundsBuffer[5] = leaf.bounds.max.z;
+                WriteFloatArray(writer, boundsBuffer, 6);
             }
             Debug.Log($"<color=green>OK</color> Leaves: {leafNodes.Count} leaves with face indices and bboxes");
             
             // PVS data
             int pvsBytes = (leafNodes.Count + 7) / 8;
-            writer.Write((uint)pvsBytes); // pvs_bytes
-            
-            // Write PVS data for each leaf
-            for (int i = 0; i < leafNodes.Count; i++)
+            List<byte[]> pvsRows = BuildPVSRows(pvsBytes);
+            if (compressPVS)
             {
-                byte[] pvsData;
-                if (leafPVSData.ContainsKey(i))
+                // pvs_bytes | RLE flag, (lcount + 1) uint32 row offsets, then the zero-run coded rows
+                var encodedRows = new List<byte[]>(pvsRows.Count);
+                foreach (byte[] row in pvsRows)
                 {
-                    pvsData = leafPVSData[i];
-                    if (pvsData.Length < pvsBytes)
-                    {
-                        byte[] paddedData = new byte[pvsBytes];
-                        System.Array.Copy(pvsData, paddedData, pvsData.Length);
-                        pvsData = paddedData;
-                    }
+                    encodedRows.Add(PvsRle.Encode(row));
                 }
-                else
+                
+                writer.Write((uint)pvsBytes | PvsRle.RleFlag);
+                uint rowOffset = 0;
+                writer.Write(rowOffset);
+                foreach (byte[] encoded in encodedRows)
                 {
-                    pvsData = new byte[pvsBytes];
-                    for (int j = 0; j < pvsBytes; j++)
-                    {
-                        pvsData[j] = 0xFF;
-                    }
+                    rowOffset += (uint)encoded.Length;
+                    writer.Write(rowOffset);
+                }
+                foreach (byte[] encoded in encodedRows)
+                {
+                    writer.Write(encoded);
                 }
                 
-                writer.Write(pvsData);
+                long rawSize = (long)pvsBytes * leafNodes.Count;
+                Debug.Log($"<color=green>OK</color> PVS: {leafNodes.Count} RLE rows, {rowOffset} bytes + {(leafNodes.Count + 1) * 4} offset bytes (raw {rawSize} bytes)");
+            }
+            else
+            {
+                writer.Write((uint)pvsBytes); // pvs_bytes
+                foreach (byte[] row in pvsRows)
+                {
+                    writer.Write(row);
+                }
+                Debug.Log($"<color=green>OK</color> PVS: {pvsBytes} bytes × {leafNodes.Count} leaves");
             }
-            Debug.Log($"<color=green>OK</color> PVS: {pvsBytes} bytes × {leafNodes.Count} leaves");
         }
         
         long fileSize = new FileInfo(fullPath).Length;
@@ -1142,6 +1321,416 @@ public class Level : MonoBehaviour
         ValidateEMUFile(fullPath);
     }
 
+    /// <summary>
+    /// Texture filename for the EMU header: the user setting, else the renderer's main texture, else default.png
+    /// </summary>
+    private string ResolveTextureFileName()
+    {
+        string textureFilename = textureFileName;
+        
+        // If no user-specified filename, try to auto-detect from material
+        if (string.IsNullOrEmpty(textureFilename))
+        {
+            if (gameObject.GetComponent<Renderer>() != null)
+            {
+                var renderer = gameObject.GetComponent<Renderer>();
+                if (renderer.material != null && renderer.material.mainTexture != null)
+                {
+                    textureFilename = renderer.material.mainTexture.name + ".png";
+                }
+            }
+        }
+        
+        // If still no texture found, use default
+        if (string.IsNullOrEmpty(textureFilename))
+        {
+            textureFilename = "default.png";
+        }
+        return textureFilename;
+    }
+    
+    // EMU v5 section ids, in file order (must match EMU5_SEC_* in Ziz/emu5.h)
+    private enum Emu5Section
+    {
+        TextureName,
+        PosX, PosY, PosZ,
+        NormalX, NormalY, NormalZ,
+        U, V,
+        ColorR, ColorG, ColorB,
+        Faces,
+        LeafRanges,
+        LeafFaces,
+        LeafMinX, LeafMinY, LeafMinZ, LeafMaxX, LeafMaxY, LeafMaxZ,
+        PvsOffsets,
+        PvsData,
+        BspNodes,
+        CellOfLeaf,
+        CellPvsOffsets,
+        CellPvsData,
+        Portals,
+        PortalPoints,
+        Count
+    }
+    
+    private const int Emu5FixedHeaderSize = 48;
+    private const int Emu5SectionAlignment = 16;
+    private const uint Emu5FlagNearestFiltering = 1u;
+    private const uint Emu5FlagPvsRle = 2u;
+    private const uint Emu5FlagCells = 4u;
+    
+    /// <summary>
+    /// Write EMU version 5: one relocatable blob that Ziz/emu5.h maps and uses in place.
+    /// Fixed header, then a table of (offset, size) per section; every section starts 16-byte aligned.
+    /// Per-vertex and per-leaf-bounds data is SoA, faces stay as uint32 triples (the index buffer),
+    /// and each leaf is a (first, count) range into one face index array sorted within each leaf.
+    /// Same coordinate conventions as v4 (Z, V and winding flipped), applied to leaf bounds as well.
+    /// With cell/portal visibility the leaf PVS rows are left empty and the cell sections carry the visibility.
+    /// </summary>
+    private void WriteEMUFileV5(string fullPath)
+    {
+        int vcount = worldVertices.Count;
+        int fcount = faces.Count;
+        int lcount = leafNodes.Count;
+        int sectionCount = (int)Emu5Section.Count;
+        int headerSize = Align(Emu5FixedHeaderSize + sectionCount * 8, Emu5SectionAlignment);
+        var sectionOffsets = new uint[sectionCount];
+        var sectionSizes = new uint[sectionCount];
+        
+        PadVertexAttributes();
+        
+        string textureFilename = ResolveTextureFileName();
+        int pvsBytes = (lcount + 7) / 8;
+        CellPortalSolver cells = cellVisibility != null && cellVisibility.LeafCells.Length == lcount ? cellVisibility : null;
+        List<byte[]> pvsRows = cells == null ? BuildPVSRows(pvsBytes) : null;
+        int leafFaceCount = 0;
+        
+        using (var blob = new MemoryStream())
+        using (var writer = new BinaryWriter(blob))
+        {
+            writer.Write(new byte[headerSize]); // patched once offsets are known
+            
+            Action<Emu5Section, Action> section = (id, body) =>
+            {
+                while (blob.Position % Emu5SectionAlignment != 0) writer.Write((byte)0);
+                long start = blob.Position;
+                body();
+                sectionOffsets[(int)id] = (uint)start;
+                sectionSizes[(int)id] = (uint)(blob.Position - start);
+            };
+            
+            section(Emu5Section.TextureName, () =>
+            {
+                writer.Write(Encoding.UTF8.GetBytes(textureFilename));
+                writer.Write((byte)0);
+            });
+            
+            var floats = new float[Math.Max(vcount, lcount)];
+            var bytes = new byte[Math.Max(vcount, lcount)];
+            Action<Emu5Section, int, Func<int, float>> floatSection = (id, count, get) =>
+                section(id, () =>
+                {
+                    for (int i = 0; i < count; i++) floats[i] = get(i);
+                    WriteFloatArray(writer, floats, count);
+                });
+            Action<Emu5Section, Func<int, float>> unormSection = (id, get) =>
+                section(id, () =>
+                {
+                    for (int i = 0; i < vcount; i++) bytes[i] = (byte)(Mathf.Clamp01(get(i)) * 255);
+                    writer.Write(bytes, 0, vcount);
+                });
+            
+            floatSection(Emu5Section.PosX, vcount, i => worldVertices[i].x);
+            floatSection(Emu5Section.PosY, vcount, i => worldVertices[i].y);
+            floatSection(Emu5Section.PosZ, vcount, i => -worldVertices[i].z);
+            floatSection(Emu5Section.NormalX, vcount, i => worldNormals[i].x);
+            floatSection(Emu5Section.NormalY, vcount, i => worldNormals[i].y);
+            floatSection(Emu5Section.NormalZ, vcount, i => -worldNormals[i].z);
+            unormSection(Emu5Section.U, i => textureCoords[i].x);
+            unormSection(Emu5Section.V, i => 1.0f - textureCoords[i].y);
+            unormSection(Emu5Section.ColorR, i => vertexColors[i].r);
+            unormSection(Emu5Section.ColorG, i => vertexColors[i].g);
+            unormSection(Emu5Section.ColorB, i => vertexColors[i].b);
+            
+            section(Emu5Section.Faces, () =>
+            {
+                foreach (Face face in faces)
+                {
+                    int[] idx = face.vertexIndices;
+                    uint i0 = idx.Length > 0 && idx[0] < vcount ? (uint)idx[0] : 0;
+                    uint i1 = idx.Length > 1 && idx[1] < vcount ? (uint)idx[1] : 0;
+                    uint i2 = idx.Length > 2 && idx[2] < vcount ? (uint)idx[2] : 0;
+                    writer.Write(i0);
+                    writer.Write(i2); // winding flipped as in v4
+                    writer.Write(i1);
+                }
+            });
+            
+            var leafFaces = new List<int>[lcount];
+            for (int i = 0; i < lcount; i++)
+            {
+                leafFaces[i] = new List<int>(leafNodes[i].faces.Count);
+                foreach (Face face in leafNodes[i].faces)
+                {
+                    if (face.id >= 0 && face.id < fcount) leafFaces[i].Add(face.id);
+                }
+                leafFaces[i].Sort();
+            }
+            
+            section(Emu5Section.LeafRanges, () =>
+            {
+                uint first = 0;
+                foreach (List<int> ids in leafFaces)
+                {
+                    writer.Write(first);
+                    writer.Write((uint)ids.Count);
+                    first += (uint)ids.Count;
+                }
+                leafFaceCount = (int)first;
+            });
+            section(Emu5Section.LeafFaces, () =>
+            {
+                foreach (List<int> ids in leafFaces)
+                {
+                    foreach (int id in ids) writer.Write((uint)id);
+                }
+            });
+            
+            floatSection(Emu5Section.LeafMinX, lcount, i => leafNodes[i].bounds.min.x);
+            floatSection(Emu5Section.LeafMinY, lcount, i => leafNodes[i].bounds.min.y);
+            floatSection(Emu5Section.LeafMinZ, lcount, i => -leafNodes[i].bounds.max.z);
+            floatSection(Emu5Section.LeafMaxX, lcount, i => leafNodes[i].bounds.max.x);
+            floatSection(Emu5Section.LeafMaxY, lcount, i => leafNodes[i].bounds.max.y);
+            floatSection(Emu5Section.LeafMaxZ, lcount, i => -leafNodes[i].bounds.min.z);
+            
+            // PVS rows are always zero-run coded in v5 (see Ziz/emu_pvs.h)
+            var encodedRows = cells == null
+                ? pvsRows.ConvertAll(row => PvsRle.Encode(row))
+                : Enumerable.Repeat(new byte[0], lcount).ToList();
+            section(Emu5Section.PvsOffsets, () =>
+            {
+                uint rowOffset = 0;
+                writer.Write(rowOffset);
+                foreach (byte[] encoded in encodedRows)
+                {
+                    rowOffset += (uint)encoded.Length;
+                    writer.Write(rowOffset);
+                }
+            });
+            section(Emu5Section.PvsData, () =>
+            {
+                foreach (byte[] encoded in encodedRows) writer.Write(encoded);
+            });
+            
+            // BSP nodes in preorder, root first: plane (nx, ny, nz, d) then front/back child references
+            section(Emu5Section.BspNodes, () =>
+            {
+                if (rootBSPNode != null && !rootBSPNode.isLeaf) WriteEmu5BspNodes(writer, rootBSPNode);
+            });
+            
+            WriteEmu5Cells(writer, section, cells);
+            
+            while (blob.Position % Emu5SectionAlignment != 0) writer.Write((byte)0);
+            uint fileSize = (uint)blob.Position;
+            
+            blob.Position = 0;
+            writer.Write(0x454D5520);  // "EMU "
+            writer.Write(5U);
+            writer.Write(0x01020304U);
+            writer.Write((uint)headerSize);
+            writer.Write(fileSize);
+            writer.Write((uint)vcount);
+            writer.Write((uint)fcount);
+            writer.Write((uint)lcount);
+            writer.Write((uint)leafFaceCount);
+            writer.Write((uint)pvsBytes);
+            writer.Write((useNearestFiltering ? Emu5FlagNearestFiltering : 0u) | Emu5FlagPvsRle | (cells != null ? Emu5FlagCells : 0u));
+            writer.Write((uint)sectionCount);
+            for (int i = 0; i < sectionCount; i++)
+            {
+                writer.Write(sectionOffsets[i]);
+                writer.Write(sectionSizes[i]);
+            }
+            writer.Flush();
+            
+            File.WriteAllBytes(fullPath, blob.ToArray());
+            Debug.Log($"<color=green>OK</color> EMU v5: {fileSize} bytes, {sectionCount} sections, {vcount} vertices, {fcount} faces, {lcount} leaves ({leafFaceCount} leaf faces), texture '{textureFilename}'");
+        }
+        
+        ValidateEMUFile(fullPath);
+    }
+    
+    // Child reference for a v5 BSP node: node index >= 0, leaf as -(leafIndex + 1), or int.MinValue for no child
+    private const int Emu5NoChild = int.MinValue;
+    
+    /// <summary>
+    /// Write interior nodes in preorder (24 bytes each). Plane is dot(n, p) + d, front when >= 0.
+    /// The Z flip applies to both n and p, so d is unchanged.
+    /// </summary>
+    private void WriteEmu5BspNodes(BinaryWriter writer, BSPNode root)
+    {
+        var order = new List<BSPNode>();
+        var indexOf = new Dictionary<BSPNode, int>();
+        var stack = new Stack<BSPNode>();
+        stack.Push(root);
+        while (stack.Count > 0)
+        {
+            BSPNode node = stack.Pop();
+            indexOf[node] = order.Count;
+            order.Add(node);
+            if (node.back != null && !node.back.isLeaf) stack.Push(node.back);
+            if (node.front != null && !node.front.isLeaf) stack.Push(node.front);
+        }
+        
+        Func<BSPNode, int> childReference = child =>
+        {
+            if (child == null || (child.isLeaf && child.leafIndex < 0)) return Emu5NoChild;
+            return child.isLeaf ? -(child.leafIndex + 1) : indexOf[child];
+        };
+        
+        foreach (BSPNode node in order)
+        {
+            writer.Write(node.planeNormal.x);
+            writer.Write(node.planeNormal.y);
+            writer.Write(-node.planeNormal.z);
+            writer.Write(node.planeDistance);
+            writer.Write(childReference(node.front));
+            writer.Write(childReference(node.back));
+        }
+    }
+    
+    /// <summary>
+    /// Cell sections: cell per leaf, zero-run coded cell PVS rows behind an offset table, then portals
+    /// (plane nx, ny, nz, d, front cell, back cell, first point, point count; 32 bytes) and their points.
+    /// Without cells every section is present but empty.
+    /// </summary>
+    private static void WriteEmu5Cells(BinaryWriter writer, Action<Emu5Section, Action> section, CellPortalSolver cells)
+    {
+        if (cells == null)
+        {
+            for (var id = Emu5Section.CellOfLeaf; id <= Emu5Section.PortalPoints; id++) section(id, () => { });
+            return;
+        }
+        
+        section(Emu5Section.CellOfLeaf, () =>
+        {
+            foreach (int cell in cells.LeafCells) writer.Write((uint)cell);
+        });
+        
+        var encodedRows = new List<byte[]>(cells.CellCount);
+        foreach (byte[] row in cells.CellRows) encodedRows.Add(PvsRle.Encode(row));
+        section(Emu5Section.CellPvsOffsets, () =>
+        {
+            uint rowOffset = 0;
+            writer.Write(rowOffset);
+            foreach (byte[] encoded in encodedRows)
+            {
+                rowOffset += (uint)encoded.Length;
+                writer.Write(rowOffset);
+            }
+        });
+        section(Emu5Section.CellPvsData, () =>
+        {
+            foreach (byte[] encoded in encodedRows) writer.Write(encoded);
+        });
+        
+        section(Emu5Section.Portals, () =>
+        {
+            uint firstPoint = 0;
+            foreach (CellPortalSolver.Portal portal in cells.CellPortals)
+            {
+                writer.Write(portal.normal.x);
+                writer.Write(portal.normal.y);
+                writer.Write(-portal.normal.z);
+                writer.Write(portal.d);
+                writer.Write((uint)portal.frontCell);
+                writer.Write((uint)portal.backCell);
+                writer.Write(firstPoint);
+                writer.Write((uint)portal.points.Length);
+                firstPoint += (uint)portal.points.Length;
+            }
+        });
+        section(Emu5Section.PortalPoints, () =>
+        {
+            foreach (CellPortalSolver.Portal portal in cells.CellPortals)
+            {
+                foreach (Vector3 point in portal.points)
+                {
+                    writer.Write(point.x);
+                    writer.Write(point.y);
+                    writer.Write(-point.z);
+                }
+            }
+        });
+    }
+    
+    private static int Align(int value, int alignment)
+    {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+    
+    /// <summary>
+    /// Bulk-write the first count floats (little-endian hosts; the endian marker tells readers otherwise)
+    /// </summary>
+    private static void WriteFloatArray(BinaryWriter writer, float[] values, int count)
+    {
+        var buffer = new byte[count * sizeof(float)];
+        Buffer.BlockCopy(values, 0, buffer, 0, buffer.Length);
+        writer.Write(buffer);
+    }
+    
+    /// <summary>
+    /// Bulk-write the first count uint32 values (little-endian hosts)
+    /// </summary>
+    private static void WriteUIntArray(BinaryWriter writer, uint[] values, int count)
+    {
+        var buffer = new byte[count * sizeof(uint)];
+        Buffer.BlockCopy(values, 0, buffer, 0, buffer.Length);
+        writer.Write(buffer);
+    }
+    
+    /// <summary>
+    /// Bring normals, UVs and colors up to the vertex count in one append each
+    /// </summary>
+    private void PadVertexAttributes()
+    {
+        int vcount = worldVertices.Count;
+        if (worldNormals.Count < vcount) worldNormals.AddRange(Enumerable.Repeat(Vector3.up, vcount - worldNormals.Count));
+        if (textureCoords.Count < vcount) textureCoords.AddRange(Enumerable.Repeat(Vector2.zero, vcount - textureCoords.Count));
+        if (vertexColors.Count < vcount) vertexColors.AddRange(Enumerable.Repeat(Color.white, vcount - vertexColors.Count));
+    }
+    
+    /// <summary>
+    /// One PVS row per leaf, padded to pvsBytes. Leaves without computed PVS see everything.
+    /// </summary>
+    private List<byte[]> BuildPVSRows(int pvsBytes)
+    {
+        var rows = new List<byte[]>(leafNodes.Count);
+        for (int i = 0; i < leafNodes.Count; i++)
+        {
+            byte[] pvsData;
+            if (leafPVSData.ContainsKey(i))
+            {
+                pvsData = leafPVSData[i];
+                if (pvsData.Length < pvsBytes)
+                {
+                    byte[] paddedData = new byte[pvsBytes];
+                    System.Array.Copy(pvsData, paddedData, pvsData.Length);
+                    pvsData = paddedData;
+                }
+            }
+            else
+            {
+                pvsData = new byte[pvsBytes];
+                for (int j = 0; j < pvsBytes; j++)
+                {
+                    pvsData[j] = 0xFF;
+                }
+            }
+            rows.Add(pvsData);
+        }
+        return rows;
+    }
+    
     /// <summary>
     /// Write Vector3 with endian safety
     /// </summary>
@@ -1198,6 +1787,12 @@ public class Level : MonoBehaviour
                 uint version = reader.ReadUInt32();
                 uint endian = reader.ReadUInt32();
                 
+                if (magic == 0x454D5520 && version == 5)
+                {
+                    ValidateEMUFileV5(reader, endian);
+                    return;
+                }
+                
                 Debug.Log($"EMU Validation - Magic: 0x{magic:X8} (expected: 0x454D5520)");
                 Debug.Log($"EMU Validation - Version: {version} (expected: 4)");
                 Debug.Log($"EMU Validation - Endian: 0x{endian:X8} (expected: 0x01020304)");
@@ -1252,8 +1847,22 @@ public class Level : MonoBehaviour
                         
                         // Add PVS data
                         int pvsBytes = (leafNodes.Count + 7) / 8;
+                        List<byte[]> pvsRows = BuildPVSRows(pvsBytes);
+                        long pvsSectionStart = expectedSize;
                         expectedSize += 4; // pvs_bytes
-                        expectedSize += leafNodes.Count * pvsBytes; // PVS data
+                        if (compressPVS)
+                        {
+                            expectedSize += (leafNodes.Count + 1) * 4; // row offsets
+                            foreach (byte[] row in pvsRows)
+                            {
+                                expectedSize += PvsRle.Encode(row).Length;
+                            }
+                            ValidateCompressedPVS(reader, pvsSectionStart, pvsBytes, pvsRows);
+                        }
+                        else
+                        {
+                            expectedSize += leafNodes.Count * pvsBytes; // PVS data
+                        }
                         
                         long actualSize = fs.Length;
                         Debug.Log($"File size - Expected: {expectedSize}, Actual: {actualSize}");
@@ -1285,6 +1894,163 @@ public class Level : MonoBehaviour
         }
     }
     
+    /// <summary>
+    /// Validate an EMU v5 header and section table (reader positioned after magic and version)
+    /// </summary>
+    private void ValidateEMUFileV5(BinaryReader reader, uint endian)
+    {
+        long length = reader.BaseStream.Length;
+        uint headerSize = reader.ReadUInt32();
+        uint fileSize = reader.ReadUInt32();
+        uint vcount = reader.ReadUInt32();
+        uint fcount = reader.ReadUInt32();
+        uint lcount = reader.ReadUInt32();
+        uint leafFaceCount = reader.ReadUInt32();
+        uint pvsBytes = reader.ReadUInt32();
+        uint flags = reader.ReadUInt32();
+        uint sectionCount = reader.ReadUInt32();
+        
+        var errors = new List<string>();
+        if (endian != 0x01020304) errors.Add($"endian marker 0x{endian:X8}");
+        if (fileSize != length) errors.Add($"file_size {fileSize} but file is {length} bytes");
+        if (vcount != worldVertices.Count || fcount != faces.Count || lcount != leafNodes.Count)
+        {
+            errors.Add($"counts v{vcount} f{fcount} l{lcount}, expected v{worldVertices.Count} f{faces.Count} l{leafNodes.Count}");
+        }
+        if (pvsBytes != (lcount + 7) / 8) errors.Add($"pvs_row_bytes {pvsBytes}");
+        if ((flags & Emu5FlagPvsRle) == 0) errors.Add("PVS RLE flag not set");
+        if (sectionCount < (uint)Emu5Section.Count || headerSize < Emu5FixedHeaderSize + sectionCount * 8)
+        {
+            errors.Add($"section table: {sectionCount} sections in a {headerSize} byte header");
+            sectionCount = 0;
+        }
+        
+        var offsets = new uint[sectionCount];
+        var sizes = new uint[sectionCount];
+        for (int i = 0; i < sectionCount; i++)
+        {
+            offsets[i] = reader.ReadUInt32();
+            sizes[i] = reader.ReadUInt32();
+            if (offsets[i] % Emu5SectionAlignment != 0) errors.Add($"section {(Emu5Section)i} misaligned at {offsets[i]}");
+            if (offsets[i] < headerSize || (long)offsets[i] + sizes[i] > fileSize) errors.Add($"section {(Emu5Section)i} out of range");
+        }
+        
+        if (sectionCount > 0)
+        {
+            Action<Emu5Section, long> expectSize = (id, expected) =>
+            {
+                if (sizes[(int)id] != expected) errors.Add($"section {id} is {sizes[(int)id]} bytes, expected {expected}");
+            };
+            foreach (var id in new[] { Emu5Section.PosX, Emu5Section.PosY, Emu5Section.PosZ, Emu5Section.NormalX, Emu5Section.NormalY, Emu5Section.NormalZ })
+            {
+                expectSize(id, vcount * 4L);
+            }
+            foreach (var id in new[] { Emu5Section.U, Emu5Section.V, Emu5Section.ColorR, Emu5Section.ColorG, Emu5Section.ColorB })
+            {
+                expectSize(id, vcount);
+            }
+            foreach (var id in new[] { Emu5Section.LeafMinX, Emu5Section.LeafMinY, Emu5Section.LeafMinZ, Emu5Section.LeafMaxX, Emu5Section.LeafMaxY, Emu5Section.LeafMaxZ })
+            {
+                expectSize(id, lcount * 4L);
+            }
+            expectSize(Emu5Section.Faces, fcount * 12L);
+            expectSize(Emu5Section.LeafRanges, lcount * 8L);
+            expectSize(Emu5Section.LeafFaces, leafFaceCount * 4L);
+            expectSize(Emu5Section.PvsOffsets, (lcount + 1) * 4L);
+            if (sizes[(int)Emu5Section.BspNodes] % 24 != 0) errors.Add($"section BspNodes is {sizes[(int)Emu5Section.BspNodes]} bytes, not a multiple of 24");
+            if ((flags & Emu5FlagCells) != 0)
+            {
+                expectSize(Emu5Section.CellOfLeaf, lcount * 4L);
+                uint cellOffsetsSize = sizes[(int)Emu5Section.CellPvsOffsets];
+                if (cellOffsetsSize < 4 || cellOffsetsSize % 4 != 0) errors.Add($"section CellPvsOffsets is {cellOffsetsSize} bytes");
+                if (sizes[(int)Emu5Section.Portals] % 32 != 0) errors.Add($"section Portals is {sizes[(int)Emu5Section.Portals]} bytes, not a multiple of 32");
+                if (sizes[(int)Emu5Section.PortalPoints] % 12 != 0) errors.Add($"section PortalPoints is {sizes[(int)Emu5Section.PortalPoints]} bytes, not a multiple of 12");
+            }
+            
+            if (errors.Count == 0)
+            {
+                reader.BaseStream.Seek(offsets[(int)Emu5Section.PvsOffsets] + lcount * 4L, SeekOrigin.Begin);
+                uint pvsDataSize = reader.ReadUInt32();
+                expectSize(Emu5Section.PvsData, pvsDataSize);
+                if ((flags & Emu5FlagCells) != 0)
+                {
+                    reader.BaseStream.Seek(offsets[(int)Emu5Section.CellPvsOffsets] + sizes[(int)Emu5Section.CellPvsOffsets] - 4L, SeekOrigin.Begin);
+                    expectSize(Emu5Section.CellPvsData, reader.ReadUInt32());
+                }
+            }
+        }
+        
+        if (errors.Count == 0)
+        {
+            Debug.Log($"<color=green>PASS</color> EMU v5 validation: {fileSize} bytes, {sectionCount} aligned sections, v{vcount} f{fcount} l{lcount}");
+        }
+        else
+        {
+            foreach (string error in errors)
+            {
+                Debug.LogError($"<color=red>ERROR</color> EMU v5: {error}");
+            }
+        }
+    }
+    
+    /// <summary>
+    /// Decode every RLE PVS row back from the file and compare it with the rows that were written
+    /// </summary>
+    private void ValidateCompressedPVS(BinaryReader reader, long sectionStart, int pvsBytes, List<byte[]> expectedRows)
+    {
+        if (sectionStart + 4 > reader.BaseStream.Length)
+        {
+            Debug.LogError("<color=red>ERROR</color> PVS section missing");
+            return;
+        }
+        
+        reader.BaseStream.Seek(sectionStart, SeekOrigin.Begin);
+        uint header = reader.ReadUInt32();
+        if (header != ((uint)pvsBytes | PvsRle.RleFlag))
+        {
+            Debug.LogError($"<color=red>ERROR</color> PVS header 0x{header:X8}, expected RLE rows of {pvsBytes} bytes");
+            return;
+        }
+        
+        var offsets = new uint[expectedRows.Count + 1];
+        for (int i = 0; i < offsets.Length; i++)
+        {
+            offsets[i] = reader.ReadUInt32();
+        }
+        byte[] blob = reader.ReadBytes((int)offsets[expectedRows.Count]);
+        
+        int mismatches = 0;
+        var visible = new List<int>();
+        for (int i = 0; i < expectedRows.Count; i++)
+        {
+            int start = (int)offsets[i];
+            int count = (int)(offsets[i + 1] - offsets[i]);
+            byte[] decoded = PvsRle.Decode(blob, start, count, pvsBytes);
+            
+            int expectedVisible = 0;
+            for (int leaf = 0; leaf < expectedRows.Count; leaf++)
+            {
+                if ((expectedRows[i][leaf >> 3] & (1 << (leaf & 7))) != 0) expectedVisible++;
+            }
+            visible.Clear();
+            PvsRle.DecodeVisibleLeaves(blob, start, count, expectedRows.Count, visible);
+            
+            if (!decoded.SequenceEqual(expectedRows[i]) || visible.Count != expectedVisible)
+            {
+                mismatches++;
+            }
+        }
+        
+        if (mismatches == 0)
+        {
+            Debug.Log($"<color=green>PASS</color> PVS RLE round trip ({expectedRows.Count} rows, {blob.Length} bytes)");
+        }
+        else
+        {
+            Debug.LogError($"<color=red>ERROR</color> PVS RLE round trip failed for {mismatches} rows");
+        }
+    }
+    
     /// <summary>
     /// Dump EMU file structure for debugging
     /// </summary>
@@ -0,0 +1,552 @@
+using System;
+using System.Diagnostics;
+using UnityEngine;
+
+/// <summary>
+/// Palette quantizer for CI8/CI4 texture export. Colors are handled in Oklab, where Euclidean distance follows
+/// perceived difference, plus alpha:
+///   1. histogram of the distinct RGBA colors, sorted by value, so the palette does not depend on pixel order
+///   2. median cut that splits the box with the largest error at the point minimizing the two halves' error
+///   3. a few weighted k-means passes over the distinct colors
+///   4. pixel mapping through a k-d tree over the palette, optionally ordered (Bayer 4x4) or Floyd-Steinberg dithered
+/// Touches no Unity objects (Color32 is a plain struct), so it can run on any thread.
+/// </summary>
+public static class PaletteQuantizer
+{
+    public enum Dither
+    {
+        None,
+        Ordered,
+        FloydSteinberg
+    }
+
+    public struct Result
+    {
+        public Color32[] palette;
+        public byte[] indices;        // one palette index per pixel
+        public Color32[] pixels;      // palette color per pixel
+        public int distinctColors;
+        public float meanDeltaE;      // Oklab distance x 100, roughly the scale of CIE delta E
+        public float maxDeltaE;
+        public long milliseconds;
+
+        public override string ToString()
+        {
+            return $"{palette.Length} colors from {distinctColors} distinct, ΔE mean {meanDeltaE:F2} max {maxDeltaE:F2}, {milliseconds}ms";
+        }
+    }
+
+    private const float AlphaWeight = 1f;       // alpha 0..1 weighs like Oklab L 0..1
+    private const float DeltaEScale = 100f;
+    private const float OrderedStrength = 0.75f; // fraction of the mean palette spacing spanned by the Bayer offsets
+
+    private static readonly float[] SrgbToLinearLut = BuildSrgbToLinearLut();
+
+    private static readonly float[] Bayer4 =
+    {
+        0, 8, 2, 10,
+        12, 4, 14, 6,
+        3, 11, 1, 9,
+        15, 7, 13, 5
+    };
+
+    /// <summary>
+    /// Quantizes <paramref name="pixels"/> (row-major, width x height) to at most <paramref name="maxColors"/> colors.
+    /// Fully transparent texels are treated as one color whatever their RGB.
+    /// </summary>
+    public static Result Quantize(Color32[] pixels, int width, int height, int maxColors, Dither dither = Dither.None, int kMeansIterations = 4)
+    {
+        if (pixels == null || pixels.Length != width * height) throw new ArgumentException("pixel count does not match width x height");
+        if (maxColors < 1 || maxColors > 256) throw new ArgumentOutOfRangeException(nameof(maxColors));
+        var timer = Stopwatch.StartNew();
+
+        int count = pixels.Length;
+        uint[] uniqueKeys;
+        float[] weights;
+        BuildHistogram(pixels, out uniqueKeys, out weights);
+        int distinct = uniqueKeys.Length;
+
+        float[] uniqueLab = new float[distinct * 4];
+        for (int u = 0; u < distinct; u++) ToOklab(Unpack(uniqueKeys[u]), uniqueLab, u * 4);
+
+        // Few enough colors: the palette is the colors themselves, in sorted order
+        float[] centers;
+        if (distinct <= maxColors)
+        {
+            centers = uniqueLab;
+        }
+        else
+        {
+            centers = MedianCut(uniqueLab, weights, maxColors);
+            RefineKMeans(uniqueLab, weights, centers, kMeansIterations);
+        }
+
+        int paletteSize = centers.Length / 4;
+        var palette = new Color32[paletteSize];
+        var paletteLab = new float[paletteSize * 4];
+        for (int i = 0; i < paletteSize; i++)
+        {
+            palette[i] = distinct <= maxColors ? Unpack(uniqueKeys[i]) : FromOklab(centers, i * 4);
+            ToOklab(palette[i], paletteLab, i * 4);
+        }
+        var tree = new KdTree(paletteLab, paletteSize);
+
+        var indices = new byte[count];
+        double deltaSum;
+        float deltaMax;
+        switch (dither)
+        {
+            case Dither.FloydSteinberg:
+                MapFloydSteinberg(pixels, width, height, tree, paletteLab, indices, out deltaSum, out deltaMax);
+                break;
+            case Dither.Ordered:
+                MapOrdered(pixels, width, height, tree, paletteLab, indices, out deltaSum, out deltaMax);
+                break;
+            default:
+                MapNearest(pixels, uniqueKeys, uniqueLab, weights, tree, paletteLab, indices, out deltaSum, out deltaMax);
+                break;
+        }
+
+        var mapped = new Color32[count];
+        for (int i = 0; i < count; i++) mapped[i] = palette[indices[i]];
+
+        return new Result
+        {
+            palette = palette,
+            indices = indices,
+            pixels = mapped,
+            distinctColors = distinct,
+            meanDeltaE = count > 0 ? (float)(deltaSum / count) : 0f,
+            maxDeltaE = deltaMax,
+            milliseconds = timer.ElapsedMilliseconds
+        };
+    }
+
+    // ---- Histogram ----
+
+    private static uint Pack(Color32 c)
+    {
+        if (c.a == 0) return 0;
+        return (uint)c.r | ((uint)c.g << 8) | ((uint)c.b << 16) | ((uint)c.a << 24);
+    }
+
+    private static Color32 Unpack(uint key)
+    {
+        return new Color32((byte)key, (byte)(key >> 8), (byte)(key >> 16), (byte)(key >> 24));
+    }
+
+    private static void BuildHistogram(Color32[] pixels, out uint[] uniqueKeys, out float[] weights)
+    {
+        var keys = new uint[pixels.Length];
+        for (int i = 0; i < pixels.Length; i++) keys[i] = Pack(pixels[i]);
+        Array.Sort(keys);
+
+        int distinct = 0;
+        for (int i = 0; i < keys.Length; i++)
+            if (i == 0 || keys[i] != keys[i - 1]) distinct++;
+
+        uniqueKeys = new uint[distinct];
+        weights = new float[distinct];
+        int u = -1;
+        for (int i = 0; i < keys.Length; i++)
+        {
+            if (i == 0 || keys[i] != keys[i - 1]) uniqueKeys[++u] = keys[i];
+            weights[u] += 1f;
+        }
+    }
+
+    // ---- Color space ----
+
+    private static float[] BuildSrgbToLinearLut()
+    {
+        var lut = new float[256];
+        for (int i = 0; i < 256; i++)
+        {
+            double c = i / 255.0;
+            lut[i] = (float)(c <= 0.04045 ? c / 12.92 : Math.Pow((c + 0.055) / 1.055, 2.4));
+        }
+        return lut;
+    }
+
+    private static byte LinearToSrgb(float linear)
+    {
+        if (!(linear > 0f)) return 0;
+        if (linear >= 1f) return 255;
+        double c = linear <= 0.0031308f ? linear * 12.92 : 1.055 * Math.Pow(linear, 1.0 / 2.4) - 0.055;
+        return (byte)Math.Min(255, Math.Max(0, (int)Math.Round(c * 255.0)));
+    }
+
+    private static void ToOklab(Color32 c, float[] lab, int offset)
+    {
+        float r = SrgbToLinearLut[c.r], g = SrgbToLinearLut[c.g], b = SrgbToLinearLut[c.b];
+        float l = (float)Math.Pow(0.4122214708f * r + 0.5363325363f * g + 0.0514459929f * b, 1.0 / 3.0);
+        float m = (float)Math.Pow(0.2119034982f * r + 0.6806995451f * g + 0.1073969566f * b, 1.0 / 3.0);
+        float s = (float)Math.Pow(0.0883024619f * r + 0.2817188376f * g + 0.6299787005f * b, 1.0 / 3.0);
+        lab[offset] = 0.2104542553f * l + 0.7936177850f * m - 0.0040720468f * s;
+        lab[offset + 1] = 1.9779984951f * l - 2.4285922050f * m + 0.4505937099f * s;
+        lab[offset + 2] = 0.0259040371f * l + 0.7827717662f * m - 0.8086757660f * s;
+        lab[offset + 3] = c.a / 255f * AlphaWeight;
+    }
+
+    private static Color32 FromOklab(float[] lab, int offset)
+    {
+        float L = lab[offset], A = lab[offset + 1], B = lab[offset + 2];
+        float l = L + 0.3963377774f * A + 0.2158037573f * B;
+        float m = L - 0.1055613458f * A - 0.0638541728f * B;
+        float s = L - 0.0894841775f * A - 1.2914855480f * B;
+        l = l * l * l;
+        m = m * m * m;
+        s = s * s * s;
+        float r = 4.0767416621f * l - 3.3077115913f * m + 0.2309699292f * s;
+        float g = -1.2684380046f * l + 2.6097574011f * m - 0.3413193965f * s;
+        float b = -0.0041960863f * l - 0.7034186147f * m + 1.7076147010f * s;
+        int a = (int)Math.Round(lab[offset + 3] / AlphaWeight * 255f);
+        return new Color32(LinearToSrgb(r), LinearToSrgb(g), LinearToSrgb(b), (byte)Math.Min(255, Math.Max(0, a)));
+    }
+
+    private static float DeltaE(float[] a, int ia, float[] b, int ib)
+    {
+        float dl = a[ia] - b[ib], da = a[ia + 1] - b[ib + 1], db = a[ia + 2] - b[ib + 2];
+        return (float)Math.Sqrt(dl * dl + da * da + db * db) * DeltaEScale;
+    }
+
+    // ---- Palette construction ----
+
+    private sealed class Box
+    {
+        public int start, end;          // range in the order array
+        public double weight;
+        public readonly double[] sum = new double[4];
+        public readonly double[] sumSq = new double[4];
+        public double error;            // weighted squared distance to the mean, all axes
+    }
+
+    private static Box MakeBox(int start, int end, int[] order, float[] lab, float[] weights)
+    {
+        var box = new Box { start = start, end = end };
+        for (int i = start; i < end; i++)
+        {
+            int u = order[i];
+            double w = weights[u];
+            box.weight += w;
+            for (int a = 0; a < 4; a++)
+            {
+                double v = lab[u * 4 + a];
+                box.sum[a] += w * v;
+                box.sumSq[a] += w * v * v;
+            }
+        }
+        for (int a = 0; a < 4; a++) box.error += box.sumSq[a] - box.sum[a] * box.sum[a] / box.weight;
+        return box;
+    }
+
+    private static float[] MedianCut(float[] lab, float[] weights, int maxColors)
+    {
+        int distinct = weights.Length;
+        var order = new int[distinct];
+        for (int i = 0; i < distinct; i++) order[i] = i;
+        var axisKeys = new float[distinct];
+
+        var boxes = new System.Collections.Generic.List<Box> { MakeBox(0, distinct, order, lab, weights) };
+        while (boxes.Count < maxColors)
+        {
+            Box worst = null;
+            foreach (var box in boxes)
+                if (box.end - box.start >= 2 && (worst == null || box.error > worst.error)) worst = box;
+            if (worst == null || worst.error <= 0.0) break;
+
+            int axis = 0;
+            double bestVariance = -1.0;
+            for (int a = 0; a < 4; a++)
+            {
+                double variance = worst.sumSq[a] - worst.sum[a] * worst.sum[a] / worst.weight;
+                if (variance > bestVariance) { bestVariance = variance; axis = a; }
+            }
+
+            for (int i = worst.start; i < worst.end; i++) axisKeys[i] = lab[order[i] * 4 + axis];
+            Array.Sort(axisKeys, order, worst.start, worst.end - worst.start);
+
+            // Split where the two halves' error along the axis is smallest
+            double wl = 0, sl = 0, ql = 0;
+            double bestCost = double.MaxValue;
+            int split = worst.start + 1;
+            for (int i = worst.start; i < worst.end - 1; i++)
+            {
+                double w = weights[order[i]], v = axisKeys[i];
+                wl += w;
+                sl += w * v;
+                ql += w * v * v;
+                if (axisKeys[i + 1] == axisKeys[i]) continue;
+                double wr = worst.weight - wl, sr = worst.sum[axis] - sl, qr = worst.sumSq[axis] - ql;
+                double cost = (ql - sl * sl / wl) + (qr - sr * sr / wr);
+                if (cost < bestCost) { bestCost = cost; split = i + 1; }
+            }
+            if (bestCost == double.MaxValue) split = worst.start + (worst.end - worst.start) / 2;
+
+            boxes.Remove(worst);
+            boxes.Add(MakeBox(worst.start, split, order, lab, weights));
+            boxes.Add(MakeBox(split, worst.end, order, lab, weights));
+        }
+
+        var centers = new float[boxes.Count * 4];
+        for (int i = 0; i < boxes.Count; i++)
+            for (int a = 0; a < 4; a++)
+                centers[i * 4 + a] = (float)(boxes[i].sum[a] / boxes[i].weight);
+        return centers;
+    }
+
+    private static void RefineKMeans(float[] lab, float[] weights, float[] centers, int iterations)
+    {
+        int distinct = weights.Length, k = centers.Length / 4;
+        var nearest = new int[distinct];
+        for (int i = 0; i < distinct; i++) nearest[i] = -1;
+        int blocks = Math.Max(1, Math.Min(Environment.ProcessorCount * 4, distinct / 1024));
+
+        for (int iteration = 0; iteration < iterations; iteration++)
+        {
+            var tree = new KdTree(centers, k);
+            int changed = 0;
+            Rat.Tool.RunParallel(blocks, block =>
+            {
+                int start = (int)((long)distinct * block / blocks), end = (int)((long)distinct * (block + 1) / blocks);
+                int local = 0;
+                for (int u = start; u < end; u++)
+                {
+                    int n = tree.Nearest(lab, u * 4);
+                    if (n != nearest[u]) { nearest[u] = n; local++; }
+                }
+                System.Threading.Interlocked.Add(ref changed, local);
+            });
+            if (changed == 0) break;
+
+            var sums = new double[k * 4];
+            var totals = new double[k];
+            for (int u = 0; u < distinct; u++)
+            {
+                int c = nearest[u];
+                totals[c] += weights[u];
+                for (int a = 0; a < 4; a++) sums[c * 4 + a] += weights[u] * lab[u * 4 + a];
+            }
+            // Empty clusters keep their previous center
+            for (int c = 0; c < k; c++)
+                if (totals[c] > 0)
+                    for (int a = 0; a < 4; a++) centers[c * 4 + a] = (float)(sums[c * 4 + a] / totals[c]);
+        }
+    }
+
+    // ---- Pixel mapping ----
+
+    private static void MapNearest(Color32[] pixels, uint[] uniqueKeys, float[] uniqueLab, float[] weights, KdTree tree,
+                                   float[] paletteLab, byte[] indices, out double deltaSum, out float deltaMax)
+    {
+        // Each distinct color is looked up once; pixels find theirs by binary search in the sorted keys
+        int distinct = uniqueKeys.Length;
+        var uniqueIndex = new byte[distinct];
+        deltaSum = 0.0;
+        deltaMax = 0f;
+        for (int u = 0; u < distinct; u++)
+        {
+            int n = tree.Nearest(uniqueLab, u * 4);
+            uniqueIndex[u] = (byte)n;
+            float delta = DeltaE(uniqueLab, u * 4, paletteLab, n * 4);
+            deltaSum += delta * weights[u];
+            if (delta > deltaMax) deltaMax = delta;
+        }
+
+        int blocks = Math.Max(1, Math.Min(Environment.ProcessorCount * 4, pixels.Length / 4096));
+        Rat.Tool.RunParallel(blocks, block =>
+        {
+            int start = (int)((long)pixels.Length * block / blocks), end = (int)((long)pixels.Length * (block + 1) / blocks);
+            for (int i = start; i < end; i++) indices[i] = uniqueIndex[Array.BinarySearch(uniqueKeys, Pack(pixels[i]))];
+        });
+    }
+
+    private static float MeanPaletteSpacing(KdTree tree, float[] paletteLab, int paletteSize)
+    {
+        if (paletteSize < 2) return 0f;
+        double total = 0.0;
+        for (int i = 0; i < paletteSize; i++) total += Math.Sqrt(tree.NearestOtherDistanceSq(paletteLab, i));
+        return (float)(total / paletteSize);
+    }
+
+    private static void MapOrdered(Color32[] pixels, int width, int height, KdTree tree, float[] paletteLab, byte[] indices,
+                                   out double deltaSum, out float deltaMax)
+    {
+        // Bayer offsets on lightness only, spanning a fraction of the typical distance between palette entries
+        float spread = MeanPaletteSpacing(tree, paletteLab, paletteLab.Length / 4) * OrderedStrength;
+        var rowSum = new double[height];
+        var rowMax = new float[height];
+        Rat.Tool.RunParallel(height, y =>
+        {
+            var source = new float[4];
+            var query = new float[4];
+            for (int x = 0; x < width; x++)
+            {
+                int i = y * width + x;
+                ToOklab(pixels[i].a == 0 ? new Color32(0, 0, 0, 0) : pixels[i], source, 0);
+                Array.Copy(source, query, 4);
+                query[0] += ((Bayer4[(y & 3) * 4 + (x & 3)] + 0.5f) / 16f - 0.5f) * spread;
+                int n = tree.Nearest(query, 0);
+                indices[i] = (byte)n;
+                float delta = DeltaE(source, 0, paletteLab, n * 4);
+                rowSum[y] += delta;
+                if (delta > rowMax[y]) rowMax[y] = delta;
+            }
+        });
+        deltaSum = 0.0;
+        deltaMax = 0f;
+        for (int y = 0; y < height; y++)
+        {
+            deltaSum += rowSum[y];
+            deltaMax = Math.Max(deltaMax, rowMax[y]);
+        }
+    }
+
+    private static void MapFloydSteinberg(Color32[] pixels, int width, int height, KdTree tree, float[] paletteLab, byte[] indices,
+                                          out double deltaSum, out float deltaMax)
+    {
+        // Serpentine scan; error is diffused in Oklab + alpha, two rows of it at a time (padded by one texel per side)
+        int stride = (width + 2) * 4;
+        var current = new float[stride];
+        var next = new float[stride];
+        var source = new float[4];
+        var query = new float[4];
+        deltaSum = 0.0;
+        deltaMax = 0f;
+
+        for (int y = 0; y < height; y++)
+        {
+            bool reverse = (y & 1) != 0;
+            int dir = reverse ? -1 : 1;
+            for (int step = 0; step < width; step++)
+            {
+                int x = reverse ? width - 1 - step : step;
+                int i = y * width + x;
+                ToOklab(pixels[i].a == 0 ? new Color32(0, 0, 0, 0) : pixels[i], source, 0);
+                int e = (x + 1) * 4;
+                for (int a = 0; a < 4; a++) query[a] = source[a] + current[e + a];
+                // Keep accumulated error inside the color space so it cannot run away on colors the palette lacks
+                query[0] = Mathf.Clamp(query[0], 0f, 1f);
+                query[1] = Mathf.Clamp(query[1], -0.5f, 0.5f);
+                query[2] = Mathf.Clamp(query[2], -0.5f, 0.5f);
+                query[3] = Mathf.Clamp(query[3], 0f, AlphaWeight);
+
+                int n = tree.Nearest(query, 0);
+                indices[i] = (byte)n;
+                float delta = DeltaE(source, 0, paletteLab, n * 4);
+                deltaSum += delta;
+                if (delta > deltaMax) deltaMax = delta;
+
+                for (int a = 0; a < 4; a++)
+                {
+                    float err = query[a] - paletteLab[n * 4 + a];
+                    current[e + dir * 4 + a] += err * (7f / 16f);
+                    next[e - dir * 4 + a] += err * (3f / 16f);
+                    next[e + a] += err * (5f / 16f);
+                    next[e + dir * 4 + a] += err * (1f / 16f);
+                }
+            }
+            var swap = current;
+            current = next;
+            next = swap;
+            Array.Clear(next, 0, stride);
+        }
+    }
+
+    /// <summary>
+    /// k-d tree over up to 256 points of 4 floats (Oklab + alpha). Read-only after construction, so searches may run
+    /// concurrently.
+    /// </summary>
+    private sealed class KdTree
+    {
+        private readonly float[] points;    // copy, 4 floats per point
+        private readonly int[] point;       // node -> point index
+        private readonly int[] axis;
+        private readonly int[] left, right; // -1 for none
+        private readonly int root;
+
+        public KdTree(float[] source, int count)
+        {
+            points = new float[count * 4];
+            Array.Copy(source, points, count * 4);
+            point = new int[count];
+            axis = new int[count];
+            left = new int[count];
+            right = new int[count];
+            var ids = new int[count];
+            for (int i = 0; i < count; i++) ids[i] = i;
+            int nodeCount = 0;
+            root = Build(ids, 0, count, new float[count], ref nodeCount);
+        }
+
+        private int Build(int[] ids, int start, int end, float[] keys, ref int nodeCount)
+        {
+            if (start >= end) return -1;
+
+            // Split on the widest axis at the median
+            int bestAxis = 0;
+            float bestSpread = -1f;
+            for (int a = 0; a < 4; a++)
+            {
+                float lo = float.MaxValue, hi = float.MinValue;
+                for (int i = start; i < end; i++)
+                {
+                    float v = points[ids[i] * 4 + a];
+                    if (v < lo) lo = v;
+                    if (v > hi) hi = v;
+                }
+                if (hi - lo > bestSpread) { bestSpread = hi - lo; bestAxis = a; }
+            }
+            for (int i = start; i < end; i++) keys[i] = points[ids[i] * 4 + bestAxis];
+            Array.Sort(keys, ids, start, end - start);
+
+            int mid = (start + end) / 2;
+            int node = nodeCount++;
+            point[node] = ids[mid];
+            axis[node] = bestAxis;
+            left[node] = Build(ids, start, mid, keys, ref nodeCount);
+            right[node] = Build(ids, mid + 1, end, keys, ref nodeCount);
+            return node;
+        }
+
+        private float DistanceSq(float[] q, int qo, int p)
+        {
+            float d0 = q[qo] - points[p * 4], d1 = q[qo + 1] - points[p * 4 + 1];
+            float d2 = q[qo + 2] - points[p * 4 + 2], d3 = q[qo + 3] - points[p * 4 + 3];
+            return d0 * d0 + d1 * d1 + d2 * d2 + d3 * d3;
+        }
+
+        private void Search(int node, float[] q, int qo, int skip, ref int best, ref float bestDistance)
+        {
+            if (node < 0) return;
+            int p = point[node];
+            if (p != skip)
+            {
+                // Ties go to the lower index, so the result does not depend on the tree shape
+                float d = DistanceSq(q, qo, p);
+                if (d < bestDistance || (d == bestDistance && p < best)) { bestDistance = d; best = p; }
+            }
+            float diff = q[qo + axis[node]] - points[p * 4 + axis[node]];
+            Search(diff < 0f ? left[node] : right[node], q, qo, skip, ref best, ref bestDistance);
+            if (diff * diff <= bestDistance) Search(diff < 0f ? right[node] : left[node], q, qo, skip, ref best, ref bestDistance);
+        }
+
+        /// <summary>Index of the point closest to q[qo..qo+3].</summary>
+        public int Nearest(float[] q, int qo)
+        {
+            int best = 0;
+            float bestDistance = float.MaxValue;
+            Search(root, q, qo, -1, ref best, ref bestDistance);
+            return best;
+        }
+
+        /// <summary>Squared distance from point i to its closest other point.</summary>
+        public float NearestOtherDistanceSq(float[] source, int i)
+        {
+            int best = -1;
+            float bestDistance = float.MaxValue;
+            Search(root, source, i * 4, i, ref best, ref bestDistance);
+            return bestDistance;
+        }
+    }
+}
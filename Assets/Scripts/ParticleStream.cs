@@ -0,0 +1,231 @@
+using System;
+using System.Collections.Generic;
+using System.IO;
+using UnityEngine;
+
+/// <summary>
+/// Writes PTC0 particle instance streams (read by Assets/Ziz/ptc0.c).
+/// A frame stores only its live particles, keyed by a stable ID: survivors keep their place in the list, particles
+/// that died are removed by index, new ones are appended. Every channel is quantized to 16 bits and stored as a
+/// zigzag varint residual from the particle's own linear prediction (last + (last - before)), so particles in steady
+/// motion cost about a byte per channel per frame and capacity that isn't alive costs nothing.
+/// Every keyInterval-th frame is a key frame that restarts the list and the predictions, for seeking.
+/// </summary>
+public static class ParticleStream
+{
+    public const uint MAGIC = 0x50544330; // "PTC0"
+    public const uint VERSION = 1;
+    public const uint FLAG_BILLBOARD = 1u << 0;
+
+    private const byte FRAME_KEY = 1 << 0;
+    private const byte FRAME_CAMERA = 1 << 1;
+    private const int HEADER_SIZE = 60;
+    private const int CHANNELS = 11; // x, y, z, size, rotation x, y, z, r, g, b, a
+
+    /// <summary>
+    /// One live particle, in exported space (Z mirrored). Rotation is Euler degrees, applied after the billboard.
+    /// </summary>
+    public struct Instance
+    {
+        public uint id;
+        public Vector3 position;
+        public float size;
+        public Vector3 rotation;
+        public Color32 color;
+    }
+
+    public class Frame
+    {
+        public List<Instance> particles = new List<Instance>();
+        public bool hasCamera;
+        public Vector3 cameraPosition; // exported space
+    }
+
+    private class Track
+    {
+        public uint id;
+        public ushort[] last = new ushort[CHANNELS];
+        public ushort[] before = new ushort[CHANNELS];
+    }
+
+    /// <summary>
+    /// Writes frames to path and returns the file size in bytes.
+    /// </summary>
+    public static long Write(string path, IList<Frame> frames, float fps, string textureFilename, int keyInterval, bool billboard)
+    {
+        keyInterval = Math.Max(1, keyInterval);
+
+        // Quantization ranges over every live particle of the recording
+        Vector3 min = new Vector3(float.MaxValue, float.MaxValue, float.MaxValue);
+        Vector3 max = new Vector3(float.MinValue, float.MinValue, float.MinValue);
+        float sizeMax = 0f;
+        int maxLive = 0;
+        foreach (var frame in frames)
+        {
+            maxLive = Math.Max(maxLive, frame.particles.Count);
+            foreach (var p in frame.particles)
+            {
+                min = Vector3.Min(min, p.position);
+                max = Vector3.Max(max, p.position);
+                sizeMax = Mathf.Max(sizeMax, p.size);
+            }
+        }
+        if (maxLive == 0) min = max = Vector3.zero;
+        if (sizeMax <= 0f) sizeMax = 1f;
+
+        byte[] texture = System.Text.Encoding.ASCII.GetBytes(textureFilename ?? "");
+        if (texture.Length > 255) throw new ArgumentException($"texture name too long for PTC0: {textureFilename}");
+
+        using (FileStream fs = new FileStream(path, FileMode.Create))
+        using (BinaryWriter writer = new BinaryWriter(fs))
+        {
+            writer.Write(MAGIC);
+            writer.Write(VERSION);
+            writer.Write((uint)frames.Count);
+            writer.Write(fps);
+            writer.Write(billboard ? FLAG_BILLBOARD : 0u);
+            writer.Write((uint)maxLive);
+            writer.Write((uint)keyInterval);
+            writer.Write(min.x); writer.Write(min.y); writer.Write(min.z);
+            writer.Write(max.x); writer.Write(max.y); writer.Write(max.z);
+            writer.Write(sizeMax);
+            writer.Write((uint)texture.Length);
+            writer.Write(texture);
+
+            // Frame offsets are patched in once the frames are written
+            long table = fs.Position;
+            var offsets = new uint[frames.Count + 1];
+            writer.Write(new byte[offsets.Length * 4]);
+
+            var tracks = new List<Track>();
+            var quantized = new Dictionary<uint, ushort[]>();
+            var spawnOrder = new List<uint>();
+            var kills = new List<int>();
+            int duplicates = 0;
+
+            for (int f = 0; f < frames.Count; f++)
+            {
+                offsets[f] = (uint)fs.Position;
+                Frame frame = frames[f];
+                bool key = f % keyInterval == 0;
+
+                quantized.Clear();
+                spawnOrder.Clear();
+                foreach (var p in frame.particles)
+                {
+                    if (quantized.ContainsKey(p.id)) { duplicates++; continue; }
+                    quantized.Add(p.id, Quantize(p, min, max, sizeMax));
+                    spawnOrder.Add(p.id);
+                }
+
+                // Survivors keep their order, the dead leave by index
+                kills.Clear();
+                var next = new List<Track>(quantized.Count);
+                var known = new HashSet<uint>();
+                for (int i = 0; i < tracks.Count; i++)
+                {
+                    if (quantized.ContainsKey(tracks[i].id))
+                    {
+                        next.Add(tracks[i]);
+                        known.Add(tracks[i].id);
+                    }
+                    else
+                    {
+                        kills.Add(i);
+                    }
+                }
+                int survivors = key ? 0 : next.Count;
+                if (key)
+                {
+                    // A key frame forgets the history; everything alive is written as if just spawned
+                    for (int i = 0; i < next.Count; i++) next[i] = new Track { id = next[i].id };
+                }
+                foreach (uint id in spawnOrder)
+                {
+                    if (!known.Contains(id)) next.Add(new Track { id = id });
+                }
+
+                writer.Write((byte)((key ? FRAME_KEY : 0) | (frame.hasCamera ? FRAME_CAMERA : 0)));
+                if (frame.hasCamera)
+                {
+                    writer.Write(frame.cameraPosition.x);
+                    writer.Write(frame.cameraPosition.y);
+                    writer.Write(frame.cameraPosition.z);
+                }
+                if (!key)
+                {
+                    WriteVarint(writer, (uint)kills.Count);
+                    int previous = 0;
+                    foreach (int index in kills)
+                    {
+                        WriteVarint(writer, (uint)(index - previous));
+                        previous = index + 1;
+                    }
+                }
+                WriteVarint(writer, (uint)(next.Count - survivors));
+
+                for (int c = 0; c < CHANNELS; c++)
+                {
+                    for (int i = 0; i < next.Count; i++)
+                    {
+                        Track track = next[i];
+                        ushort value = quantized[track.id][c];
+                        int residual;
+                        if (i < survivors)
+                        {
+                            int predicted = 2 * track.last[c] - track.before[c];
+                            residual = (short)(ushort)(value - predicted);
+                            track.before[c] = track.last[c];
+                        }
+                        else
+                        {
+                            residual = (short)value;
+                            track.before[c] = value;
+                        }
+                        track.last[c] = value;
+                        WriteVarint(writer, (uint)((residual << 1) ^ (residual >> 31)));
+                    }
+                }
+
+                tracks = next;
+            }
+            offsets[frames.Count] = (uint)fs.Position;
+
+            fs.Position = table;
+            foreach (uint offset in offsets) writer.Write(offset);
+
+            if (duplicates > 0)
+                Debug.LogWarning($"ParticleStream - {duplicates} particle(s) shared an ID with another live particle and were dropped");
+
+            return fs.Length;
+        }
+    }
+
+    private static ushort[] Quantize(Instance p, Vector3 min, Vector3 max, float sizeMax)
+    {
+        var q = new ushort[CHANNELS];
+        for (int axis = 0; axis < 3; axis++)
+        {
+            float range = max[axis] - min[axis];
+            q[axis] = range > 0f ? (ushort)Mathf.Clamp(Mathf.RoundToInt((p.position[axis] - min[axis]) / range * 65535f), 0, 65535) : (ushort)0;
+            // Angles wrap, so a full turn is 65536 and lands back on 0
+            q[4 + axis] = (ushort)(Mathf.RoundToInt(Mathf.Repeat(p.rotation[axis], 360f) / 360f * 65536f) & 0xFFFF);
+        }
+        q[3] = (ushort)Mathf.Clamp(Mathf.RoundToInt(p.size / sizeMax * 65535f), 0, 65535);
+        q[7] = p.color.r;
+        q[8] = p.color.g;
+        q[9] = p.color.b;
+        q[10] = p.color.a;
+        return q;
+    }
+
+    private static void WriteVarint(BinaryWriter writer, uint value)
+    {
+        while (value >= 0x80)
+        {
+            writer.Write((byte)(value | 0x80));
+            value >>= 7;
+        }
+        writer.Write((byte)value);
+    }
+}
@@ -0,0 +1,94 @@
+using System.Collections.Generic;
+using System.IO;
+
+/// <summary>
+/// Quake-style zero-run coding for PVS rows (see Assets/Ziz/emu_pvs.h for the runtime side).
+/// A nonzero byte is 8 literal leaf bits; a zero byte is followed by how many zero bytes it stands for (1..255).
+/// Trailing zeros are dropped because each row is addressed through an offset table.
+/// </summary>
+public static class PvsRle
+{
+    /// <summary>
+    /// Set on the EMU pvs_bytes field when rows are RLE-coded and preceded by a row offset table.
+    /// </summary>
+    public const uint RleFlag = 0x80000000u;
+
+    public static byte[] Encode(byte[] row)
+    {
+        int length = row.Length;
+        while (length > 0 && row[length - 1] == 0) length--;
+
+        var output = new MemoryStream(length + 2);
+        for (int i = 0; i < length; )
+        {
+            if (row[i] != 0)
+            {
+                output.WriteByte(row[i++]);
+                continue;
+            }
+            int run = 1;
+            while (i + run < length && row[i + run] == 0 && run < 255) run++;
+            output.WriteByte(0);
+            output.WriteByte((byte)run);
+            i += run;
+        }
+        return output.ToArray();
+    }
+
+    /// <summary>
+    /// Expands an encoded row back into <paramref name="rowBytes"/> bytes.
+    /// </summary>
+    public static byte[] Decode(byte[] data, int offset, int count, int rowBytes)
+    {
+        var row = new byte[rowBytes];
+        int end = offset + count;
+        int pos = 0;
+        for (int i = offset; i < end && pos < rowBytes; )
+        {
+            byte b = data[i++];
+            if (b == 0)
+            {
+                pos += i < end ? data[i++] : 0;
+                continue;
+            }
+            row[pos++] = b;
+        }
+        return row;
+    }
+
+    /// <summary>
+    /// Appends the leaf indices set in an encoded row, in ascending order, skipping zero runs without expanding them.
+    /// </summary>
+    public static void DecodeVisibleLeaves(byte[] data, int offset, int count, int leafCount, List<int> visible)
+    {
+        int end = offset + count;
+        int baseLeaf = 0;
+        for (int i = offset; i < end; )
+        {
+            int bits = data[i++];
+            if (bits == 0)
+            {
+                baseLeaf += 8 * (i < end ? data[i++] : 0);
+                continue;
+            }
+            while (bits != 0)
+            {
+                int low = bits & -bits;
+                int index = baseLeaf + TrailingZeroTable[low];
+                if (index < leafCount) visible.Add(index);
+                bits ^= low;
+            }
+            baseLeaf += 8;
+        }
+    }
+
+    // Bit position of a single set bit in a byte (only powers of two are looked up)
+    private static readonly byte[] TrailingZeroTable = BuildTrailingZeroTable();
+
+    private static byte[] BuildTrailingZeroTable()
+    {
+        var table = new byte[256];
+        for (int bit = 0; bit < 8; bit++) table[1 << bit] = (byte)bit;
+        return table;
+    }
+}
@@ -0,0 +1,462 @@
+using System;
+using System.Diagnostics;
+using System.Threading;
+using UnityEngine;
+using Vec4 = System.Numerics.Vector4;
+
+/// <summary>
+/// Headless leaf-to-leaf PVS solver. Builds a binned-SAH BVH over the level triangles once, then tests every leaf pair
+/// with stratified segment rays between sample points in the two leaf boxes, stopping after the first packet with an
+/// unoccluded ray. The rays of a pair run as packets of four: one traversal of the BVH serves all four, a node is
+/// skipped only when every live ray misses it, and the slab and triangle tests work on System.Numerics.Vector4 lanes.
+/// Touches no Unity objects (Vector3/Bounds are plain structs), so rows of the visibility matrix run on the thread pool
+/// and the whole solve can run off the main thread.
+/// Output rows use the EMU PVS bit order: leaf j is bit (j % 8) of byte (j / 8).
+/// </summary>
+public sealed class PvsSolver
+{
+    public struct Stats
+    {
+        public int leafCount;
+        public int triangleCount;
+        public int bvhNodeCount;
+        public long pairsTested;   // pairs within range that needed rays
+        public long visiblePairs;  // unordered pairs, self excluded
+        public long raysCast;
+        public long buildMs;
+        public long solveMs;
+
+        public override string ToString()
+        {
+            return $"{leafCount} leaves, {triangleCount} tris, {bvhNodeCount} BVH nodes (build {buildMs}ms), " +
+                   $"{pairsTested} pairs ray-tested, {visiblePairs} visible, {raysCast} rays, solve {solveMs}ms";
+        }
+    }
+
+    private struct Node
+    {
+        public float minX, minY, minZ, maxX, maxY, maxZ;
+        public int first;   // leaf: first triangle; interior: left child (right child is first + 1)
+        public int count;   // triangles in a leaf, 0 for interior nodes
+    }
+
+    private const int MaxLeafTriangles = 4;
+    private const int SahBins = 12;
+    private const int MaxDepth = 60;
+    private const int TraversalStackSize = MaxDepth + 4;
+    private const float SegmentEpsilon = 1e-4f; // parametric; keeps rays from hitting the faces their endpoints sit on
+    private const float TMin = SegmentEpsilon, TMax = 1f - SegmentEpsilon;
+    private const int PacketSize = 4;
+
+    private readonly Node[] nodes;
+    private int nodeCount;
+
+    // Triangles in BVH leaf order, SoA: v0 and the two edges
+    private readonly float[] v0x, v0y, v0z, e1x, e1y, e1z, e2x, e2y, e2z;
+
+    public Stats LastStats { get; private set; }
+
+    // Four segments, one per lane: origin, direction (end - origin) and its inverse
+    private struct RayPacket
+    {
+        public Vec4 ox, oy, oz, dx, dy, dz, idx, idy, idz;
+    }
+
+    /// <summary>
+    /// Builds the BVH over a triangle list. Degenerate triangles are kept; they simply never report a hit.
+    /// </summary>
+    public PvsSolver(Vector3[] vertices, int[] triangles)
+    {
+        var timer = Stopwatch.StartNew();
+        int triCount = triangles.Length / 3;
+
+        var triMin = new Vector3[triCount];
+        var triMax = new Vector3[triCount];
+        var centroid = new Vector3[triCount];
+        var order = new int[triCount];
+        for (int t = 0; t < triCount; t++)
+        {
+            Vector3 a = vertices[triangles[t * 3]], b = vertices[triangles[t * 3 + 1]], c = vertices[triangles[t * 3 + 2]];
+            triMin[t] = Vector3.Min(a, Vector3.Min(b, c));
+            triMax[t] = Vector3.Max(a, Vector3.Max(b, c));
+            centroid[t] = (a + b + c) * (1f / 3f);
+            order[t] = t;
+        }
+
+        nodes = new Node[Math.Max(1, 2 * triCount - 1)];
+        nodeCount = 1;
+        if (triCount > 0) BuildNode(0, 0, triCount, 0, order, triMin, triMax, centroid);
+
+        v0x = new float[triCount]; v0y = new float[triCount]; v0z = new float[triCount];
+        e1x = new float[triCount]; e1y = new float[triCount]; e1z = new float[triCount];
+        e2x = new float[triCount]; e2y = new float[triCount]; e2z = new float[triCount];
+        for (int i = 0; i < triCount; i++)
+        {
+            int t = order[i];
+            Vector3 a = vertices[triangles[t * 3]], b = vertices[triangles[t * 3 + 1]], c = vertices[triangles[t * 3 + 2]];
+            v0x[i] = a.x; v0y[i] = a.y; v0z[i] = a.z;
+            e1x[i] = b.x - a.x; e1y[i] = b.y - a.y; e1z[i] = b.z - a.z;
+            e2x[i] = c.x - a.x; e2y[i] = c.y - a.y; e2z[i] = c.z - a.z;
+        }
+
+        timer.Stop();
+        LastStats = new Stats { triangleCount = triCount, bvhNodeCount = nodeCount, buildMs = timer.ElapsedMilliseconds };
+    }
+
+    /// <summary>
+    /// Computes symmetric leaf visibility. Pairs whose boxes are further apart than <paramref name="maxDistance"/>
+    /// are invisible; overlapping boxes are visible. Everything else gets up to <paramref name="raysPerPair"/> rays
+    /// (center to center first) between <paramref name="samplesPerLeaf"/> stratified points per leaf.
+    /// Deterministic: sample points depend only on the leaf index.
+    /// </summary>
+    public byte[][] Solve(Bounds[] leafBounds, int samplesPerLeaf, int raysPerPair, float maxDistance)
+    {
+        var timer = Stopwatch.StartNew();
+        int leafCount = leafBounds.Length;
+        int rowBytes = (leafCount + 7) / 8;
+        samplesPerLeaf = Math.Max(1, samplesPerLeaf);
+        raysPerPair = Math.Max(1, raysPerPair);
+
+        var samples = new Vector3[leafCount][];
+        for (int i = 0; i < leafCount; i++) samples[i] = StratifiedSamples(leafBounds[i], samplesPerLeaf, i);
+
+        var rows = new byte[leafCount][];
+        for (int i = 0; i < leafCount; i++)
+        {
+            rows[i] = new byte[rowBytes];
+            rows[i][i >> 3] |= (byte)(1 << (i & 7));
+        }
+
+        long pairsTested = 0, visiblePairs = 0, raysCast = 0;
+        float maxDistanceSq = maxDistance * maxDistance;
+
+        // Each worker writes only the upper triangle of its own row; the mirror pass below fills the rest
+        Rat.Tool.RunParallel(leafCount, i =>
+        {
+            var stack = new int[TraversalStackSize];
+            var from = new Vector3[PacketSize];
+            var to = new Vector3[PacketSize];
+            long localPairs = 0, localVisible = 0, localRays = 0;
+            Bounds a = leafBounds[i];
+            for (int j = i + 1; j < leafCount; j++)
+            {
+                Bounds b = leafBounds[j];
+                if (BoxDistanceSq(a, b) > maxDistanceSq) continue;
+
+                bool visible = a.Intersects(b);
+                if (!visible)
+                {
+                    localPairs++;
+                    Vector3[] sa = samples[i], sb = samples[j];
+                    int n = sa.Length;
+                    for (int r = 0; r < raysPerPair && !visible; r += PacketSize)
+                    {
+                        // Walk the n x n endpoint grid diagonally so early rays spread over both boxes; ray 0 is center
+                        // to center. The last packet repeats its last ray in the lanes past raysPerPair.
+                        int lanes = Math.Min(PacketSize, raysPerPair - r);
+                        for (int k = 0; k < PacketSize; k++)
+                        {
+                            int ray = r + Math.Min(k, lanes - 1);
+                            from[k] = sa[ray % n];
+                            to[k] = sb[(ray + ray / n) % n];
+                        }
+                        localRays += lanes;
+                        visible = UnblockedLanes(MakePacket(from, to), (1 << lanes) - 1, stack) != 0;
+                    }
+                }
+
+                if (visible)
+                {
+                    rows[i][j >> 3] |= (byte)(1 << (j & 7));
+                    localVisible++;
+                }
+            }
+            Interlocked.Add(ref pairsTested, localPairs);
+            Interlocked.Add(ref visiblePairs, localVisible);
+            Interlocked.Add(ref raysCast, localRays);
+        });
+
+        for (int i = 0; i < leafCount; i++)
+        {
+            for (int j = i + 1; j < leafCount; j++)
+            {
+                if ((rows[i][j >> 3] & (1 << (j & 7))) != 0) rows[j][i >> 3] |= (byte)(1 << (i & 7));
+            }
+        }
+
+        timer.Stop();
+        var stats = LastStats;
+        stats.leafCount = leafCount;
+        stats.pairsTested = pairsTested;
+        stats.visiblePairs = visiblePairs;
+        stats.raysCast = raysCast;
+        stats.solveMs = timer.ElapsedMilliseconds;
+        LastStats = stats;
+        return rows;
+    }
+
+    private static RayPacket MakePacket(Vector3[] from, Vector3[] to)
+    {
+        var packet = new RayPacket
+        {
+            ox = new Vec4(from[0].x, from[1].x, from[2].x, from[3].x),
+            oy = new Vec4(from[0].y, from[1].y, from[2].y, from[3].y),
+            oz = new Vec4(from[0].z, from[1].z, from[2].z, from[3].z)
+        };
+        packet.dx = new Vec4(to[0].x, to[1].x, to[2].x, to[3].x) - packet.ox;
+        packet.dy = new Vec4(to[0].y, to[1].y, to[2].y, to[3].y) - packet.oy;
+        packet.dz = new Vec4(to[0].z, to[1].z, to[2].z, to[3].z) - packet.oz;
+        packet.idx = SafeInverse(packet.dx);
+        packet.idy = SafeInverse(packet.dy);
+        packet.idz = SafeInverse(packet.dz);
+        return packet;
+    }
+
+    // A finite stand-in for 1/0, so a segment parallel to a slab never gives 0 * infinity = NaN, which Vector4.Min and
+    // Max don't propagate the way Math.Min and Max do. The slab is then (min - o) * 1e30 .. (max - o) * 1e30: far
+    // outside 0..1 when the segment runs inside it, and entirely below or above when it runs outside. Node boxes are
+    // padded, so a segment in the plane of a face is inside rather than at a bound of 0.
+    private static Vec4 SafeInverse(Vec4 d)
+    {
+        return new Vec4(SafeInverse(d.X), SafeInverse(d.Y), SafeInverse(d.Z), SafeInverse(d.W));
+    }
+
+    private static float SafeInverse(float d)
+    {
+        return Math.Abs(d) < 1e-30f ? 1e30f : 1f / d;
+    }
+
+    /// <summary>
+    /// Traces the live lanes of a packet (bit k of <paramref name="lanes"/> for lane k) and returns those no triangle
+    /// blocks. Any-hit traversal: a lane drops out at its first blocker, and the walk ends when none is left.
+    /// <paramref name="stack"/> must hold TraversalStackSize entries.
+    /// </summary>
+    private int UnblockedLanes(RayPacket ray, int lanes, int[] stack)
+    {
+        if (v0x.Length == 0) return lanes;
+
+        int sp = 0;
+        stack[sp++] = 0;
+        while (sp > 0)
+        {
+            ref Node node = ref nodes[stack[--sp]];
+
+            // Slab test against each segment's parametric range
+            Vec4 t0 = (new Vec4(node.minX) - ray.ox) * ray.idx, t1 = (new Vec4(node.maxX) - ray.ox) * ray.idx;
+            Vec4 near = Vec4.Min(t0, t1), far = Vec4.Max(t0, t1);
+            t0 = (new Vec4(node.minY) - ray.oy) * ray.idy; t1 = (new Vec4(node.maxY) - ray.oy) * ray.idy;
+            near = Vec4.Max(near, Vec4.Min(t0, t1)); far = Vec4.Min(far, Vec4.Max(t0, t1));
+            t0 = (new Vec4(node.minZ) - ray.oz) * ray.idz; t1 = (new Vec4(node.maxZ) - ray.oz) * ray.idz;
+            near = Vec4.Max(near, Vec4.Min(t0, t1)); far = Vec4.Min(far, Vec4.Max(t0, t1));
+            if ((SlabLanes(near, far) & lanes) == 0) continue;
+
+            if (node.count == 0)
+            {
+                stack[sp++] = node.first;
+                stack[sp++] = node.first + 1;
+                continue;
+            }
+
+            int end = node.first + node.count;
+            for (int t = node.first; t < end; t++)
+            {
+                // Moller-Trumbore, the triangle broadcast to every lane
+                Vec4 ax = new Vec4(e1x[t]), ay = new Vec4(e1y[t]), az = new Vec4(e1z[t]);
+                Vec4 bx = new Vec4(e2x[t]), by = new Vec4(e2y[t]), bz = new Vec4(e2z[t]);
+                Vec4 px = ray.dy * bz - ray.dz * by;
+                Vec4 py = ray.dz * bx - ray.dx * bz;
+                Vec4 pz = ray.dx * by - ray.dy * bx;
+                Vec4 det = ax * px + ay * py + az * pz;
+                Vec4 inv = Vec4.One / det;
+
+                Vec4 sx = ray.ox - new Vec4(v0x[t]), sy = ray.oy - new Vec4(v0y[t]), sz = ray.oz - new Vec4(v0z[t]);
+                Vec4 u = (sx * px + sy * py + sz * pz) * inv;
+                Vec4 qx = sy * az - sz * ay;
+                Vec4 qy = sz * ax - sx * az;
+                Vec4 qz = sx * ay - sy * ax;
+                Vec4 v = (ray.dx * qx + ray.dy * qy + ray.dz * qz) * inv;
+                Vec4 hit = (bx * qx + by * qy + bz * qz) * inv;
+
+                lanes &= ~HitLanes(det, u, v, hit);
+                if (lanes == 0) return 0;
+            }
+        }
+        return lanes;
+    }
+
+    private static int SlabLanes(Vec4 near, Vec4 far)
+    {
+        return (SlabHit(near.X, far.X) ? 1 : 0) | (SlabHit(near.Y, far.Y) ? 2 : 0) |
+               (SlabHit(near.Z, far.Z) ? 4 : 0) | (SlabHit(near.W, far.W) ? 8 : 0);
+    }
+
+    private static bool SlabHit(float near, float far)
+    {
+        return near <= far && far >= TMin && near <= TMax;
+    }
+
+    private static int HitLanes(Vec4 det, Vec4 u, Vec4 v, Vec4 hit)
+    {
+        return (TriangleHit(det.X, u.X, v.X, hit.X) ? 1 : 0) | (TriangleHit(det.Y, u.Y, v.Y, hit.Y) ? 2 : 0) |
+               (TriangleHit(det.Z, u.Z, v.Z, hit.Z) ? 4 : 0) | (TriangleHit(det.W, u.W, v.W, hit.W) ? 8 : 0);
+    }
+
+    // Near-zero det is a segment parallel to the triangle, including degenerate triangles
+    private static bool TriangleHit(float det, float u, float v, float hit)
+    {
+        return (det <= -1e-12f || det >= 1e-12f) && u >= 0f && u <= 1f && v >= 0f && u + v <= 1f && hit > TMin && hit < TMax;
+    }
+
+    private void BuildNode(int index, int start, int count, int depth, int[] order, Vector3[] triMin, Vector3[] triMax, Vector3[] centroid)
+    {
+        Vector3 bMin = new Vector3(float.MaxValue, float.MaxValue, float.MaxValue), bMax = -bMin;
+        Vector3 cMin = bMin, cMax = bMax;
+        for (int i = start; i < start + count; i++)
+        {
+            int t = order[i];
+            bMin = Vector3.Min(bMin, triMin[t]); bMax = Vector3.Max(bMax, triMax[t]);
+            cMin = Vector3.Min(cMin, centroid[t]); cMax = Vector3.Max(cMax, centroid[t]);
+        }
+
+        // Padded a little so a segment lying in a face of the box still enters it (see SafeInverse)
+        nodes[index] = new Node
+        {
+            minX = PadDown(bMin.x), minY = PadDown(bMin.y), minZ = PadDown(bMin.z),
+            maxX = PadUp(bMax.x), maxY = PadUp(bMax.y), maxZ = PadUp(bMax.z),
+            first = start, count = count
+        };
+        if (count <= MaxLeafTriangles || depth >= MaxDepth) return;
+
+        Vector3 extent = cMax - cMin;
+        int axis = extent.x >= extent.y && extent.x >= extent.z ? 0 : (extent.y >= extent.z ? 1 : 2);
+        float axisMin = cMin[axis], axisExtent = extent[axis];
+        if (axisExtent <= 1e-9f) return; // all centroids coincide; nothing to split on
+
+        // Binned SAH along the widest centroid axis
+        var binCount = new int[SahBins];
+        var binMin = new Vector3[SahBins];
+        var binMax = new Vector3[SahBins];
+        for (int b = 0; b < SahBins; b++) { binMin[b] = new Vector3(float.MaxValue, float.MaxValue, float.MaxValue); binMax[b] = -binMin[b]; }
+        float binScale = SahBins / axisExtent;
+        for (int i = start; i < start + count; i++)
+        {
+            int t = order[i];
+            int b = Math.Min(SahBins - 1, (int)((centroid[t][axis] - axisMin) * binScale));
+            binCount[b]++;
+            binMin[b] = Vector3.Min(binMin[b], triMin[t]);
+            binMax[b] = Vector3.Max(binMax[b], triMax[t]);
+        }
+
+        var rightArea = new float[SahBins];
+        var rightCount = new int[SahBins];
+        Vector3 accMin = new Vector3(float.MaxValue, float.MaxValue, float.MaxValue), accMax = -accMin;
+        int acc = 0;
+        for (int b = SahBins - 1; b > 0; b--)
+        {
+            acc += binCount[b];
+            if (binCount[b] > 0) { accMin = Vector3.Min(accMin, binMin[b]); accMax = Vector3.Max(accMax, binMax[b]); }
+            rightCount[b] = acc;
+            rightArea[b] = acc > 0 ? HalfArea(accMin, accMax) : 0f;
+        }
+
+        int bestSplit = -1;
+        float bestCost = float.MaxValue;
+        accMin = new Vector3(float.MaxValue, float.MaxValue, float.MaxValue); accMax = -accMin;
+        acc = 0;
+        for (int b = 0; b < SahBins - 1; b++)
+        {
+            acc += binCount[b];
+            if (binCount[b] > 0) { accMin = Vector3.Min(accMin, binMin[b]); accMax = Vector3.Max(accMax, binMax[b]); }
+            if (acc == 0 || rightCount[b + 1] == 0) continue;
+            float cost = HalfArea(accMin, accMax) * acc + rightArea[b + 1] * rightCount[b + 1];
+            if (cost < bestCost) { bestCost = cost; bestSplit = b; }
+        }
+
+        // Splitting must beat intersecting everything here (traversal cost ~1 triangle test)
+        float parentArea = HalfArea(bMin, bMax);
+        if (bestSplit < 0 || (parentArea > 0f && 1f + bestCost / parentArea >= count)) return;
+
+        int mid = start;
+        for (int i = start; i < start + count; i++)
+        {
+            int t = order[i];
+            int b = Math.Min(SahBins - 1, (int)((centroid[t][axis] - axisMin) * binScale));
+            if (b <= bestSplit) { order[i] = order[mid]; order[mid] = t; mid++; }
+        }
+
+        int left = nodeCount;
+        nodeCount += 2;
+        nodes[index].first = left;
+        nodes[index].count = 0;
+        BuildNode(left, start, mid - start, depth + 1, order, triMin, triMax, centroid);
+        BuildNode(left + 1, mid, start + count - mid, depth + 1, order, triMin, triMax, centroid);
+    }
+
+    /// <summary>
+    /// Latin-hypercube samples inside a box: each axis is cut into <paramref name="count"/> strata and every stratum
+    /// is used once, so even a handful of points covers thin or elongated leaves. The first sample is the center.
+    /// </summary>
+    private static Vector3[] StratifiedSamples(Bounds bounds, int count, int seed)
+    {
+        var points = new Vector3[count];
+        uint state = (uint)seed * 2654435761u + 0x9E3779B9u;
+        if (state == 0) state = 1;
+        var perm = new int[3][];
+        for (int axis = 0; axis < 3; axis++)
+        {
+            perm[axis] = new int[count];
+            for (int k = 0; k < count; k++) perm[axis][k] = k;
+            for (int k = count - 1; k > 0; k--)
+            {
+                int r = (int)(NextRandom(ref state) % (uint)(k + 1));
+                int tmp = perm[axis][k]; perm[axis][k] = perm[axis][r]; perm[axis][r] = tmp;
+            }
+        }
+
+        Vector3 min = bounds.min, size = bounds.size;
+        for (int k = 0; k < count; k++)
+        {
+            float fx = (perm[0][k] + NextUnit(ref state)) / count;
+            float fy = (perm[1][k] + NextUnit(ref state)) / count;
+            float fz = (perm[2][k] + NextUnit(ref state)) / count;
+            points[k] = new Vector3(min.x + fx * size.x, min.y + fy * size.y, min.z + fz * size.z);
+        }
+        points[0] = bounds.center;
+        return points;
+    }
+
+    private static uint NextRandom(ref uint state)
+    {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+
+    private static float NextUnit(ref uint state)
+    {
+        return (NextRandom(ref state) >> 8) * (1f / 16777216f);
+    }
+
+    private static float PadDown(float v)
+    {
+        return v - (Math.Abs(v) + 1f) * 1e-6f;
+    }
+
+    private static float PadUp(float v)
+    {
+        return v + (Math.Abs(v) + 1f) * 1e-6f;
+    }
+
+    private static float HalfArea(Vector3 min, Vector3 max)
+    {
+        Vector3 d = max - min;
+        return d.x * d.y + d.y * d.z + d.z * d.x;
+    }
+
+    private static float BoxDistanceSq(Bounds a, Bounds b)
+    {
+        Vector3 gap = Vector3.Max(Vector3.zero, Vector3.Max(a.min - b.max, b.min - a.max));
+        return gap.sqrMagnitude;
+    }
+}
@@ -3,6 +3,8 @@ using System.IO;
 using System.Runtime.InteropServices;
 using System.Collections.Generic;
 using System.Linq; 
+using System.Runtime.ExceptionServices;
+using System.Threading.Tasks;
 
 namespace Rat
 {
@@ -28,7 +30,7 @@ namespace Rat
     [StructLayout(LayoutKind.Sequential, Pack = 1)]
     public struct RatHeader
     {
-        public uint magic;              // "RAT3" = 0x33544152
+        public uint magic;              // "RAT3" = 0x33544152, "RAT4" = 0x34544152 (clustered bounds, see RatClusterHeader)
         public uint num_vertices;
         public uint num_frames;
         public uint num_indices;
@@ -44,6 +46,22 @@ namespace Rat
         public uint raw_first_frame_offset; // Offset to raw first frame data
     }
 
+    /// <summary>
+    /// RAT4 only: follows the 64-byte RatHeader. Each vertex belongs to one cluster, and each cluster has its own
+    /// quantization box (6 floats: min xyz, max xyz). The header min/max holds the union of all cluster boxes.
+    /// Layout: [RatHeader][RatClusterHeader][cluster bounds][cluster ids, 1 byte per vertex][bit widths]...
+    /// and the rest is as in RAT3. Decoding stays branch-free:
+    ///   c = cluster_ids[v]; pos.x = bounds[c*6+0] + q.x * (bounds[c*6+3] - bounds[c*6+0]) / 255.0f
+    /// </summary>
+    [StructLayout(LayoutKind.Sequential, Pack = 1)]
+    public struct RatClusterHeader
+    {
+        public uint num_clusters;
+        public uint cluster_bounds_offset; // Offset to num_clusters * 6 floats
+        public uint cluster_ids_offset;    // Offset to num_vertices cluster indices (bytes)
+        public uint reserved;
+    }
+
     [StructLayout(LayoutKind.Sequential, Pack = 1)]
     public struct RatMeshHeader
     {
@@ -97,6 +115,9 @@ namespace Rat
         public byte[] bit_widths_z;
         public string texture_filename = ""; // V2: Texture filename for this animation
         public string mesh_data_filename = ""; // V3: Filename for the .ratmesh file
+        // RAT4: per-vertex cluster index and per-cluster bounds (min xyz, max xyz); null for single-box RAT3
+        public byte[] cluster_ids;
+        public float[] cluster_bounds;
     }
 
     public class DecompressionContext
@@ -159,6 +180,18 @@ namespace Rat
             }
             return result;
         }
+
+        /// <summary>
+        /// Advances the read position by <paramref name="bits"/> without decoding, so seeking to a frame is O(1).
+        /// </summary>
+        public void Skip(long bits)
+        {
+            if (bits <= 0) return;
+            long target = (long)_position * 32 + _bitsReadFromWord + bits;
+            _position = (int)(target / 32);
+            _bitsReadFromWord = (int)(target % 32);
+            _currentWord = (_stream != null && _position < _stream.Length) ? _stream[_position] : 0;
+        }
     }
 
     // --- Bitstream Handling ---
@@ -168,6 +201,18 @@ namespace Rat
         private uint _currentWord = 0;
         private int _bitsUsed = 0;
 
+        public BitstreamWriter() { }
+
+        /// <summary>
+        /// Starts writing <paramref name="startBit"/> bits into the first word. Used by the parallel packer so a
+        /// block of frames lands at the same bit phase it would have in a serially written stream.
+        /// </summary>
+        public BitstreamWriter(int startBit)
+        {
+            if (startBit < 0 || startBit > 31) throw new ArgumentException("Start bit must be between 0 and 31.");
+            _bitsUsed = startBit;
+        }
+
         public void Write(uint value, int bits)
         {
             if (bits <= 0 || bits > 32) throw new ArgumentException("Bits must be between 1 and 32.");
@@ -207,6 +252,9 @@ namespace Rat
     // --- Core Logic ---
     public static class Core
     {
+        internal const uint MagicRat3 = 0x33544152; // "RAT3"
+        internal const uint MagicRat4 = 0x34544152; // "RAT4"
+
         private static int SignExtend(uint value, int bits)
         {
             if (bits == 0) return 0;
@@ -215,7 +263,7 @@ namespace Rat
         }
 
         /// <summary>
-        /// Reads a RAT3 format file from disk. Only RAT3 format is supported.
+        /// Reads a RAT3 or RAT4 (clustered bounds) format file from disk.
         /// </summary>
         public static CompressedAnimation ReadRatFile(string filepath)
         {
@@ -226,7 +274,7 @@ namespace Rat
         }
 
         /// <summary>
-        /// Reads a RAT3 format file from a stream. Only RAT3 format is supported.
+        /// Reads a RAT3 or RAT4 (clustered bounds) format file from a stream.
         /// </summary>
         public static CompressedAnimation ReadRatFile(Stream stream, string filepath = null)
         {
@@ -255,6 +303,29 @@ namespace Rat
 
                 // Note: mesh_data_filename support removed — mesh data is now handled by .act files
 
+                if (header.magic == MagicRat4)
+                {
+                    byte[] clusterHeaderBytes = reader.ReadBytes(Marshal.SizeOf(typeof(RatClusterHeader)));
+                    ptr = Marshal.AllocHGlobal(clusterHeaderBytes.Length);
+                    Marshal.Copy(clusterHeaderBytes, 0, ptr, clusterHeaderBytes.Length);
+                    var clusterHeader = (RatClusterHeader)Marshal.PtrToStructure(ptr, typeof(RatClusterHeader));
+                    Marshal.FreeHGlobal(ptr);
+
+                    anim.cluster_bounds = new float[clusterHeader.num_clusters * 6];
+                    reader.BaseStream.Seek(clusterHeader.cluster_bounds_offset, SeekOrigin.Begin);
+                    for (int i = 0; i < anim.cluster_bounds.Length; i++)
+                    {
+                        anim.cluster_bounds[i] = reader.ReadSingle();
+                    }
+                    anim.cluster_ids = new byte[header.num_vertices];
+                    reader.BaseStream.Seek(clusterHeader.cluster_ids_offset, SeekOrigin.Begin);
+                    reader.Read(anim.cluster_ids, 0, anim.cluster_ids.Length);
+                }
+                else if (header.magic != MagicRat3)
+                {
+                    throw new InvalidDataException($"Not a RAT3/RAT4 file (magic 0x{header.magic:X8}){(filepath != null ? ": " + filepath : "")}");
+                }
+
                 reader.BaseStream.Seek(header.bit_widths_offset, SeekOrigin.Begin);
                 reader.Read(anim.bit_widths_x, 0, anim.bit_widths_x.Length);
                 reader.Read(anim.bit_widths_y, 0, anim.bit_widths_y.Length);
@@ -293,6 +364,44 @@ namespace Rat
             }
         }
 
+        /// <summary>
+        /// Converts a quantized vertex back to world space using its cluster box (RAT4) or the header box (RAT3).
+        /// </summary>
+        public static UnityEngine.Vector3 DequantizeVertex(CompressedAnimation anim, int vertexIndex, VertexU8 q)
+        {
+            float minX = anim.min_x, minY = anim.min_y, minZ = anim.min_z;
+            float maxX = anim.max_x, maxY = anim.max_y, maxZ = anim.max_z;
+            if (anim.cluster_ids != null)
+            {
+                int b = anim.cluster_ids[vertexIndex] * 6;
+                var cb = anim.cluster_bounds;
+                minX = cb[b + 0]; minY = cb[b + 1]; minZ = cb[b + 2];
+                maxX = cb[b + 3]; maxY = cb[b + 4]; maxZ = cb[b + 5];
+            }
+            return new UnityEngine.Vector3(
+                minX + (q.x / 255f) * (maxX - minX),
+                minY + (q.y / 255f) * (maxY - minY),
+                minZ + (q.z / 255f) * (maxZ - minZ));
+        }
+
+        /// <summary>
+        /// Largest quantization step per axis over all boxes in the file; used for validation tolerances.
+        /// </summary>
+        public static UnityEngine.Vector3 MaxQuantizationStep(CompressedAnimation anim)
+        {
+            if (anim.cluster_ids == null)
+            {
+                return new UnityEngine.Vector3(anim.max_x - anim.min_x, anim.max_y - anim.min_y, anim.max_z - anim.min_z) / 255f;
+            }
+            var step = UnityEngine.Vector3.zero;
+            for (int b = 0; b + 5 < anim.cluster_bounds.Length; b += 6)
+            {
+                var cb = anim.cluster_bounds;
+                step = UnityEngine.Vector3.Max(step, new UnityEngine.Vector3(cb[b + 3] - cb[b + 0], cb[b + 4] - cb[b + 1], cb[b + 5] - cb[b + 2]) / 255f);
+            }
+            return step;
+        }
+
         public static DecompressionContext CreateDecompressionContext(CompressedAnimation anim)
         {
             var ctx = new DecompressionContext
@@ -316,42 +425,173 @@ namespace Rat
             }
 
             var reader = new BitstreamReader(anim.delta_stream);
-            
-            long totalBitsToSkip = 0;
-            for (uint f = 1; f <= ctx.current_frame; f++)
+
+            // Every delta frame has the same size, so the frames already applied are skipped in one step
+            reader.Skip(BitsPerDeltaFrame(anim) * ctx.current_frame);
+
+            for (uint f = ctx.current_frame + 1; f <= targetFrame; f++)
             {
-                for (uint v = 0; v < anim.num_vertices; v++)
+                ApplyDeltaFrame(reader, anim, ctx.current_positions);
+            }
+            ctx.current_frame = targetFrame;
+        }
+
+        /// <summary>
+        /// Decodes <paramref name="targetFrame"/> straight into caller-owned SoA float arrays. Dequantization and the
+        /// optional model matrix are folded into one affine map per cluster, and the final delta frame is applied in the
+        /// same vertex loop that writes the output, so vertex memory is walked once instead of three times.
+        /// </summary>
+        public static void DecompressToFrameSoA(DecompressionContext ctx, CompressedAnimation anim, uint targetFrame,
+            float[] x, float[] y, float[] z, UnityEngine.Matrix4x4? model = null)
+        {
+            DecompressToFrameSoA(ctx, anim, targetFrame, BuildDequantTable(anim, model ?? UnityEngine.Matrix4x4.identity), x, y, z, null, null, null, 0f);
+        }
+
+        /// <summary>
+        /// Fixed-point variant of <see cref="DecompressToFrameSoA(DecompressionContext, CompressedAnimation, uint, float[], float[], float[], UnityEngine.Matrix4x4?)"/>:
+        /// writes signed Q-format values with <paramref name="fracBits"/> fractional bits (16 = Q16.16, 12 = PSP/N64-style Q12).
+        /// </summary>
+        public static void DecompressToFrameSoA(DecompressionContext ctx, CompressedAnimation anim, uint targetFrame,
+            int[] x, int[] y, int[] z, int fracBits, UnityEngine.Matrix4x4? model = null)
+        {
+            if (fracBits < 0 || fracBits > 30) throw new ArgumentException("fracBits must be between 0 and 30.");
+            DecompressToFrameSoA(ctx, anim, targetFrame, BuildDequantTable(anim, model ?? UnityEngine.Matrix4x4.identity), null, null, null, x, y, z, 1 << fracBits);
+        }
+
+        /// <summary>
+        /// Per-cluster affine map (12 floats: origin xyz, then the x/y/z axis vectors) so that
+        /// out = origin + axisX * q.x + axisY * q.y + axisZ * q.z already includes bounds, 1/255 and the model matrix.
+        /// RAT3 files have a single entry built from the header box.
+        /// </summary>
+        private static float[] BuildDequantTable(CompressedAnimation anim, UnityEngine.Matrix4x4 model)
+        {
+            var table = new float[DequantTableLength(anim)];
+            FillDequantTable(anim, model, table);
+            return table;
+        }
+
+        internal static int DequantTableLength(CompressedAnimation anim)
+        {
+            return ((anim.cluster_ids != null) ? anim.cluster_bounds.Length / 6 : 1) * 12;
+        }
+
+        /// <summary>
+        /// Fills a caller-owned table (at least <see cref="DequantTableLength"/> floats) so schedulers can reuse scratch memory.
+        /// </summary>
+        internal static void FillDequantTable(CompressedAnimation anim, UnityEngine.Matrix4x4 model, float[] table)
+        {
+            int clusters = DequantTableLength(anim) / 12;
+            for (int c = 0; c < clusters; c++)
+            {
+                UnityEngine.Vector3 min, max;
+                if (anim.cluster_ids != null)
                 {
-                    totalBitsToSkip += anim.bit_widths_x[v] + anim.bit_widths_y[v] + anim.bit_widths_z[v];
+                    var cb = anim.cluster_bounds;
+                    min = new UnityEngine.Vector3(cb[c * 6 + 0], cb[c * 6 + 1], cb[c * 6 + 2]);
+                    max = new UnityEngine.Vector3(cb[c * 6 + 3], cb[c * 6 + 4], cb[c * 6 + 5]);
                 }
+                else
+                {
+                    min = new UnityEngine.Vector3(anim.min_x, anim.min_y, anim.min_z);
+                    max = new UnityEngine.Vector3(anim.max_x, anim.max_y, anim.max_z);
+                }
+                var step = (max - min) / 255f;
+                var origin = model.MultiplyPoint3x4(min);
+                var ax = model.MultiplyVector(new UnityEngine.Vector3(step.x, 0, 0));
+                var ay = model.MultiplyVector(new UnityEngine.Vector3(0, step.y, 0));
+                var az = model.MultiplyVector(new UnityEngine.Vector3(0, 0, step.z));
+                int t = c * 12;
+                table[t + 0] = origin.x; table[t + 1] = origin.y; table[t + 2] = origin.z;
+                table[t + 3] = ax.x; table[t + 4] = ax.y; table[t + 5] = ax.z;
+                table[t + 6] = ay.x; table[t + 7] = ay.y; table[t + 8] = ay.z;
+                table[t + 9] = az.x; table[t + 10] = az.y; table[t + 11] = az.z;
             }
-            
-            long wordsToSkip = totalBitsToSkip / 32;
-            int bitsToSkipInWord = (int)(totalBitsToSkip % 32);
-            for(int i=0; i<wordsToSkip*32 + bitsToSkipInWord; i++) reader.Read(1);
+        }
 
-            for (uint f = ctx.current_frame + 1; f <= targetFrame; f++)
+        internal static void DecompressToFrameSoA(DecompressionContext ctx, CompressedAnimation anim, uint targetFrame, float[] table,
+            float[] fx, float[] fy, float[] fz, int[] ix, int[] iy, int[] iz, float fixedScale)
+        {
+            if (targetFrame >= anim.num_frames) targetFrame = anim.num_frames - 1;
+
+            // Bring the context up to the frame before the target; the last delta frame is fused with the output pass
+            BitstreamReader reader = null;
+            if (targetFrame > 0 && targetFrame != ctx.current_frame)
             {
-                for (uint v = 0; v < anim.num_vertices; v++)
+                DecompressToFrame(ctx, anim, targetFrame - 1);
+                reader = new BitstreamReader(anim.delta_stream);
+                reader.Skip(BitsPerDeltaFrame(anim) * (targetFrame - 1));
+            }
+            else
+            {
+                DecompressToFrame(ctx, anim, targetFrame);
+            }
+
+            var positions = ctx.current_positions;
+            var ids = anim.cluster_ids;
+            for (int v = 0; v < anim.num_vertices; v++)
+            {
+                if (reader != null)
                 {
-                    int dx = SignExtend(reader.Read(anim.bit_widths_x[v]), anim.bit_widths_x[v]);
-                    int dy = SignExtend(reader.Read(anim.bit_widths_y[v]), anim.bit_widths_y[v]);
-                    int dz = SignExtend(reader.Read(anim.bit_widths_z[v]), anim.bit_widths_z[v]);
-                    
-                    ctx.current_positions[v].x = (byte)(ctx.current_positions[v].x + dx);
-                    ctx.current_positions[v].y = (byte)(ctx.current_positions[v].y + dy);
-                    ctx.current_positions[v].z = (byte)(ctx.current_positions[v].z + dz);
+                    positions[v].x = (byte)(positions[v].x + SignExtend(reader.Read(anim.bit_widths_x[v]), anim.bit_widths_x[v]));
+                    positions[v].y = (byte)(positions[v].y + SignExtend(reader.Read(anim.bit_widths_y[v]), anim.bit_widths_y[v]));
+                    positions[v].z = (byte)(positions[v].z + SignExtend(reader.Read(anim.bit_widths_z[v]), anim.bit_widths_z[v]));
+                }
+
+                var q = positions[v];
+                int t = (ids != null) ? ids[v] * 12 : 0;
+                float px = table[t + 0] + table[t + 3] * q.x + table[t + 6] * q.y + table[t + 9] * q.z;
+                float py = table[t + 1] + table[t + 4] * q.x + table[t + 7] * q.y + table[t + 10] * q.z;
+                float pz = table[t + 2] + table[t + 5] * q.x + table[t + 8] * q.y + table[t + 11] * q.z;
+
+                if (fx != null)
+                {
+                    fx[v] = px; fy[v] = py; fz[v] = pz;
+                }
+                else
+                {
+                    ix[v] = (int)Math.Round(px * fixedScale);
+                    iy[v] = (int)Math.Round(py * fixedScale);
+                    iz[v] = (int)Math.Round(pz * fixedScale);
                 }
             }
             ctx.current_frame = targetFrame;
         }
+
+        /// <summary>
+        /// Number of bits one delta frame occupies in the stream (sum of all per-vertex bit widths).
+        /// </summary>
+        public static long BitsPerDeltaFrame(CompressedAnimation anim)
+        {
+            long bits = 0;
+            for (int v = 0; v < anim.num_vertices; v++)
+            {
+                bits += anim.bit_widths_x[v] + anim.bit_widths_y[v] + anim.bit_widths_z[v];
+            }
+            return bits;
+        }
+
+        /// <summary>
+        /// Reads one delta frame from <paramref name="reader"/> and applies it to <paramref name="positions"/> in place.
+        /// </summary>
+        internal static void ApplyDeltaFrame(BitstreamReader reader, CompressedAnimation anim, VertexU8[] positions)
+        {
+            for (uint v = 0; v < anim.num_vertices; v++)
+            {
+                int dx = SignExtend(reader.Read(anim.bit_widths_x[v]), anim.bit_widths_x[v]);
+                int dy = SignExtend(reader.Read(anim.bit_widths_y[v]), anim.bit_widths_y[v]);
+                int dz = SignExtend(reader.Read(anim.bit_widths_z[v]), anim.bit_widths_z[v]);
+
+                positions[v].x = (byte)(positions[v].x + dx);
+                positions[v].y = (byte)(positions[v].y + dy);
+                positions[v].z = (byte)(positions[v].z + dz);
+            }
+        }
     }
 
     public static class Tool
     {
         /// <summary>
-        /// Computes the per-chunk metadata (list of chunk start frame and word counts) without writing files.
-        /// Internal helper used by chunked writer.
+        /// Per-chunk metadata (chunk start frame and word counts) computed by <see cref="PlanChunks"/> before any file is written.
         /// </summary>
         private class ChunkSpec
         {
@@ -363,219 +603,386 @@ namespace Rat
             public CompressedAnimation chunkAnim;
         }
 
-        public static void WriteRatFileWithSizeSplittingChunked(
-            string baseFilename,
-            CompressedAnimation anim,
-            int maxFileSizeKB = 64,
-            List<UnityEngine.Vector3[]> processedFrames = null,
-            System.Action<int,int> perChunkProgress = null,
-            System.Action<List<string>> onComplete = null,
-            bool skipValidation = false)
+        /// <summary>
+        /// Outcome of validating one written chunk. Produced on worker threads, logged on the caller's thread.
+        /// </summary>
+        private class ChunkValidationResult
         {
-#if UNITY_EDITOR
-            // We'll compute chunk specs similarly to the synchronous method, but queue writes per chunk
-            const int KB = 1024;
-            int maxFileSize = maxFileSizeKB * KB;
-            var createdFiles = new List<string>();
-
-            // Calculate static data sizes for the .rat file (V3 format)
-            uint headerSize = (uint)Marshal.SizeOf(typeof(RatHeader));
-            uint bitWidthsSize = anim.num_vertices * 3;
-            uint firstFrameSize = anim.num_vertices * (uint)Marshal.SizeOf(typeof(VertexU8));
-            string meshDataFilename = !string.IsNullOrEmpty(anim.mesh_data_filename) ? anim.mesh_data_filename : $"{baseFilename}.ratmesh";
-            byte[] meshDataFilenameBytes = System.Text.Encoding.UTF8.GetBytes(Path.GetFileName(meshDataFilename));
-            uint rawFirstFrameSize = anim.isFirstFrameRaw ? anim.num_vertices * (uint)Marshal.SizeOf(typeof(UnityEngine.Vector3)) : 0;
-            uint staticOverheadSize = headerSize + bitWidthsSize + firstFrameSize + (uint)meshDataFilenameBytes.Length + rawFirstFrameSize;
+            public float maxError;
+            public float tolerance;
+            public float stepX, stepY, stepZ;
+            public int maxErrorVertexIndex = -1;
+            public UnityEngine.Vector3 maxExpected;
+            public UnityEngine.Vector3 maxActual;
+            public VertexU8 seedSample;
+            public VertexU8 globalSample;
+            public bool hasSeedSample;
+            public string exceptionMessage;
+        }
 
-            if (staticOverheadSize > maxFileSize)
+        /// <summary>
+        /// Runs <paramref name="body"/> for every index in [0, count) on the thread pool.
+        /// The first worker exception is rethrown as-is so callers keep seeing the original error message.
+        /// </summary>
+        internal static void RunParallel(int count, System.Action<int> body)
+        {
+            if (count <= 0) return;
+            if (count == 1) { body(0); return; }
+            try
             {
-                throw new System.InvalidOperationException($"ERROR: Static RAT data ({staticOverheadSize} bytes) exceeds maximum file size ({maxFileSize} bytes)!");
+                Parallel.For(0, count, body);
             }
-
-            // if single frame or no deltas, just write synchronously
-            if (anim.num_frames <= 1 || anim.delta_stream == null || anim.delta_stream.Length == 0)
+            catch (AggregateException ae)
             {
-                string filename = $"{baseFilename}.rat";
-                using (var stream = new FileStream(filename, FileMode.Create)) WriteRatFileV3(stream, anim, Path.GetFileName(meshDataFilename));
-                createdFiles.Add(filename);
-                onComplete?.Invoke(createdFiles);
-                return;
+                ExceptionDispatchInfo.Capture(ae.Flatten().InnerExceptions[0]).Throw();
             }
+        }
 
-            // compute words per frame and prefixWords
-            uint bitsPerFrame = 0;
-            for (int i = 0; i < anim.num_vertices; i++) bitsPerFrame += (uint)(anim.bit_widths_x[i] + anim.bit_widths_y[i] + anim.bit_widths_z[i]);
-            uint totalDeltaFramesToCompute = (anim.num_frames > 0) ? (anim.num_frames - 1) : 0;
-            var wordsPerDeltaFrame = new uint[totalDeltaFramesToCompute > 0 ? totalDeltaFramesToCompute : 1];
-            for (uint f = 0; f < totalDeltaFramesToCompute; ++f)
+        /// <summary>
+        /// Splits [0, count) into contiguous blocks, roughly a few per core, for work that wants cache-friendly ranges.
+        /// </summary>
+        private static int BlockCount(int count, int minPerBlock = 1)
+        {
+            if (count <= 0) return 0;
+            int blocks = Environment.ProcessorCount * 4;
+            blocks = Math.Min(blocks, Math.Max(1, count / Math.Max(1, minPerBlock)));
+            return Math.Max(1, blocks);
+        }
+
+        private static void BlockRange(int block, int blocks, int count, out int start, out int end)
+        {
+            start = (int)((long)count * block / blocks);
+            end = (int)((long)count * (block + 1) / blocks);
+        }
+
+        /// <summary>
+        /// Plans the chunk layout for a size-limited export. Only prefix sums of per-frame word counts are needed,
+        /// so the whole plan exists before any chunk is sliced, seeded or written.
+        /// </summary>
+        private static List<ChunkSpec> PlanChunks(CompressedAnimation anim, int maxFileSize, uint staticOverheadFirst, uint staticOverheadAppend)
+        {
+            const uint deltaStreamWordSize = sizeof(uint);
+            ulong bitsPerFrame = (ulong)Core.BitsPerDeltaFrame(anim);
+            uint totalDeltaFrames = (anim.num_frames > 0) ? (anim.num_frames - 1) : 0;
+
+            // prefixWords[f] = words used by delta frames [0 .. f-1]; frames share a word when bitsPerFrame is not a multiple of 32
+            var prefixWords = new uint[totalDeltaFrames + 1];
+            for (uint f = 0; f <= totalDeltaFrames; ++f)
             {
-                uint wordsUpToFPlus1 = (bitsPerFrame * (f + 1) + 31) / 32;
-                uint wordsUpToF = (bitsPerFrame * f + 31) / 32;
-                uint wordsThisFrame = wordsUpToFPlus1 - wordsUpToF;
-                wordsPerDeltaFrame[f] = wordsThisFrame;
+                prefixWords[f] = (uint)((bitsPerFrame * f + 31) / 32);
             }
-            uint wordsPerFrame = (bitsPerFrame + 31) / 32;
-            if (wordsPerFrame == 0) wordsPerFrame = 1;
 
-            uint availableSpaceForDeltasFirst = (uint)(maxFileSize - staticOverheadSize);
-            uint staticOverheadAppend = headerSize + bitWidthsSize + firstFrameSize + (uint)meshDataFilenameBytes.Length;
-            uint availableSpaceForDeltasAppend = (uint)(maxFileSize - staticOverheadAppend);
-            uint deltaStreamWordSize = sizeof(uint);
-            uint totalDeltaWords = (uint)anim.delta_stream.Length;
-            uint totalDeltaFrames = (anim.num_frames > 0) ? (anim.num_frames - 1) : 0;
-            uint maxDeltaWordsPerChunk = availableSpaceForDeltasAppend / deltaStreamWordSize;
-            if (maxDeltaWordsPerChunk == 0) maxDeltaWordsPerChunk = 1;
+            uint maxDeltaWordsFirst = (uint)(maxFileSize - staticOverheadFirst) / deltaStreamWordSize;
+            uint maxDeltaWordsPerChunk = (uint)(maxFileSize - staticOverheadAppend) / deltaStreamWordSize;
+            if (maxDeltaWordsPerChunk == 0)
+            {
+                throw new System.InvalidOperationException(
+                    $"ERROR: Cannot fit any delta data within {maxFileSize / 1024}KB limit! Static overhead is {staticOverheadFirst} bytes, " +
+                    $"leaving only {maxFileSize - staticOverheadAppend} bytes for deltas (append-case), but need at least {deltaStreamWordSize} bytes per delta word.");
+            }
 
-            uint deltaFramesPerAppendChunk = 0;
-            if (totalDeltaFrames > 0)
+            // Appended chunks all carry the same frame count: the first count whose words reach the per-chunk budget
+            uint deltaFramesPerAppendChunk = totalDeltaFrames;
+            for (uint f = 0; f < totalDeltaFrames; ++f)
             {
-                uint acc = 0;
-                for (uint i = 0; i < totalDeltaFrames; ++i)
+                if (prefixWords[f + 1] >= maxDeltaWordsPerChunk)
                 {
-                    acc += wordsPerDeltaFrame[i];
-                    if (acc >= maxDeltaWordsPerChunk)
-                    {
-                        deltaFramesPerAppendChunk = i + 1;
-                        break;
-                    }
+                    deltaFramesPerAppendChunk = f + 1;
+                    break;
                 }
-                if (deltaFramesPerAppendChunk == 0) deltaFramesPerAppendChunk = totalDeltaFrames;
             }
-            else deltaFramesPerAppendChunk = 1;
             if (deltaFramesPerAppendChunk == 0) deltaFramesPerAppendChunk = 1;
-            int numberOfChunks = UnityEngine.Mathf.CeilToInt((float)totalDeltaFrames / (float)deltaFramesPerAppendChunk);
-
-            // Build prefix sums
-            uint[] prefixWords = new uint[totalDeltaFrames + 1];
-            prefixWords[0] = 0; uint running = 0;
-            for (uint f = 0; f < totalDeltaFrames; ++f) { running += wordsPerDeltaFrame[f]; prefixWords[f + 1] = running; }
 
-            var chunkSpecs = new List<ChunkSpec>();
-            uint nextStartDfIndex = 0;
-            for (int chunkIndex = 0; chunkIndex < numberOfChunks; chunkIndex++)
+            var specs = new List<ChunkSpec>();
+            uint nextStart = 0;
+            while (nextStart < totalDeltaFrames)
             {
-                uint startDeltaFrame = nextStartDfIndex;
-                uint remainingDeltaFrames = totalDeltaFrames - startDeltaFrame;
-                uint chunkDeltaFrames = 0;
-                if (chunkIndex == 0)
+                uint remaining = totalDeltaFrames - nextStart;
+                uint chunkDeltaFrames;
+                if (specs.Count == 0)
                 {
-                    uint deltaWordsFirst = availableSpaceForDeltasFirst / deltaStreamWordSize;
-                    uint accWords = 0; uint framesFits = 0;
-                    for (uint ff = startDeltaFrame; ff < startDeltaFrame + remainingDeltaFrames; ++ff)
+                    // The first chunk also carries the raw first frame, so only take the frames that fit
+                    uint framesFit = 0;
+                    while (framesFit < remaining && prefixWords[nextStart + framesFit + 1] - prefixWords[nextStart] <= maxDeltaWordsFirst)
                     {
-                        if (ff >= totalDeltaFrames) break;
-                        accWords += wordsPerDeltaFrame[ff];
-                        if (accWords >= deltaWordsFirst) { framesFits = ff - startDeltaFrame + 1; break; }
+                        framesFit++;
                     }
-                    if (framesFits == 0) framesFits = 1;
-                    chunkDeltaFrames = System.Math.Min(remainingDeltaFrames, framesFits);
+                    chunkDeltaFrames = Math.Max(1u, framesFit);
                 }
                 else
                 {
-                    chunkDeltaFrames = System.Math.Min(remainingDeltaFrames, deltaFramesPerAppendChunk);
+                    chunkDeltaFrames = Math.Min(remaining, deltaFramesPerAppendChunk);
                 }
 
-                uint startDeltaWord = prefixWords[startDeltaFrame];
-                uint chunkDeltaWords = 0;
-                for (uint f = startDeltaFrame; f < startDeltaFrame + chunkDeltaFrames; ++f)
+                specs.Add(new ChunkSpec
                 {
-                    if (f < totalDeltaFrames) chunkDeltaWords += wordsPerDeltaFrame[f];
-                }
+                    startDeltaFrame = nextStart,
+                    chunkDeltaFrames = chunkDeltaFrames,
+                    startDeltaWord = prefixWords[nextStart],
+                    chunkDeltaWords = prefixWords[nextStart + chunkDeltaFrames] - prefixWords[nextStart]
+                });
+                nextStart += chunkDeltaFrames;
+            }
+            return specs;
+        }
 
-                var spec = new ChunkSpec() { startDeltaFrame = startDeltaFrame, chunkDeltaFrames = chunkDeltaFrames, startDeltaWord = startDeltaWord, chunkDeltaWords = chunkDeltaWords };
-                chunkSpecs.Add(spec);
-                nextStartDfIndex += chunkDeltaFrames;
+        /// <summary>
+        /// Returns the quantized frame each chunk starts from. Uses the encoder's quantized frames when present;
+        /// otherwise the delta stream is decoded once and every chunk start is snapshotted on the way, so the shared
+        /// prefix is replayed a single time instead of once per chunk.
+        /// </summary>
+        private static VertexU8[][] ResolveChunkSeeds(CompressedAnimation anim, List<ChunkSpec> specs)
+        {
+            var seeds = new VertexU8[specs.Count][];
+            bool needsReplay = false;
+            for (int ci = 0; ci < specs.Count; ++ci)
+            {
+                uint start = specs[ci].startDeltaFrame;
+                if (ci == 0) seeds[ci] = anim.first_frame;
+                else if (anim.quantized_frames != null && anim.quantized_frames.Length > start) seeds[ci] = anim.quantized_frames[start];
+                else needsReplay = true;
             }
+            if (!needsReplay) return seeds;
 
-            // Build chunk objects and filenames
-            for (int ci = 0; ci < chunkSpecs.Count; ++ci)
+            var current = new VertexU8[anim.num_vertices];
+            Array.Copy(anim.first_frame, current, (int)anim.num_vertices);
+            var reader = new BitstreamReader(anim.delta_stream);
+            uint decodedFrames = 0;
+            for (int ci = 1; ci < specs.Count; ++ci)
             {
-                var spec = chunkSpecs[ci];
-                var chunkAnim = new CompressedAnimation
+                if (seeds[ci] != null) continue;
+                for (; decodedFrames < specs[ci].startDeltaFrame; ++decodedFrames)
                 {
-                    num_vertices = anim.num_vertices,
-                    num_indices = anim.num_indices,
-                    num_frames = (ci == 0) ? anim.num_frames : (spec.chunkDeltaFrames + 1),
-                    min_x = anim.min_x, max_x = anim.max_x,
-                    min_y = anim.min_y, max_y = anim.max_y,
-                    min_z = anim.min_z, max_z = anim.max_z,
-                    first_frame = anim.first_frame,
-                    first_frame_raw = anim.first_frame_raw,
-                    isFirstFrameRaw = anim.isFirstFrameRaw,
-                    bit_widths_x = anim.bit_widths_x,
-                    bit_widths_y = anim.bit_widths_y,
-                    bit_widths_z = anim.bit_widths_z,
-                    mesh_data_filename = Path.GetFileName(meshDataFilename)
-                };
+                    Core.ApplyDeltaFrame(reader, anim, current);
+                }
+                seeds[ci] = (VertexU8[])current.Clone();
+            }
+            return seeds;
+        }
 
-                long startLong = Math.Min((long)spec.startDeltaWord, (long)totalDeltaWords);
-                int totalDeltaWordsInt = (int)totalDeltaWords;
-                if (spec.chunkDeltaWords > 0 && anim.delta_stream != null && anim.delta_stream.Length > 0)
+        /// <summary>
+        /// Slices the delta stream for one planned chunk and fills in its header fields. Pure, so chunks build in parallel.
+        /// </summary>
+        private static CompressedAnimation BuildChunkAnimation(CompressedAnimation anim, ChunkSpec spec, int chunkIndex, VertexU8[] seed, string meshDataFilename)
+        {
+            var chunkAnim = new CompressedAnimation
+            {
+                num_vertices = anim.num_vertices,
+                num_indices = anim.num_indices,
+                // num_frames: for first chunk we write global animation frame count; for appended chunks write local chunk length
+                num_frames = (chunkIndex == 0) ? anim.num_frames : (spec.chunkDeltaFrames + 1),
+                min_x = anim.min_x, max_x = anim.max_x,
+                min_y = anim.min_y, max_y = anim.max_y,
+                min_z = anim.min_z, max_z = anim.max_z,
+                first_frame = seed,
+                first_frame_raw = anim.first_frame_raw,
+                isFirstFrameRaw = anim.isFirstFrameRaw,
+                bit_widths_x = anim.bit_widths_x,
+                bit_widths_y = anim.bit_widths_y,
+                bit_widths_z = anim.bit_widths_z,
+                cluster_ids = anim.cluster_ids,
+                cluster_bounds = anim.cluster_bounds,
+                mesh_data_filename = meshDataFilename
+            };
+
+            int totalDeltaWords = anim.delta_stream.Length;
+            if (spec.chunkDeltaWords > 0 && spec.startDeltaWord < totalDeltaWords)
+            {
+                int copyWords = (int)Math.Min((long)spec.chunkDeltaWords, (long)totalDeltaWords - spec.startDeltaWord);
+                if (copyWords < spec.chunkDeltaWords)
                 {
-                    if (startLong >= totalDeltaWordsInt)
-                    {
-                        chunkAnim.delta_stream = new uint[0];
-                    }
-                    else
-                    {
-                        int available = totalDeltaWordsInt - (int)startLong;
-                        int copyWords = (int)Math.Min((long)spec.chunkDeltaWords, (long)available);
-                        chunkAnim.delta_stream = new uint[copyWords];
-                        System.Array.Copy(anim.delta_stream, (int)startLong, chunkAnim.delta_stream, 0, copyWords);
-                    }
+                    UnityEngine.Debug.LogWarning($"RAT: chunk copy length clamped from {spec.chunkDeltaWords} to {copyWords} due to available source words ({totalDeltaWords - spec.startDeltaWord}).");
                 }
-                else
+                chunkAnim.delta_stream = new uint[copyWords];
+                Array.Copy(anim.delta_stream, (int)spec.startDeltaWord, chunkAnim.delta_stream, 0, copyWords);
+            }
+            else
+            {
+                if (spec.chunkDeltaWords > 0)
                 {
-                    chunkAnim.delta_stream = new uint[0];
+                    UnityEngine.Debug.LogWarning($"RAT: computed startDeltaWord {spec.startDeltaWord} >= totalDeltaWords {totalDeltaWords}, writing empty delta stream for chunk.");
                 }
+                chunkAnim.delta_stream = new uint[0];
+            }
+
+            if (chunkIndex != 0)
+            {
+                // Do not include raw_first_frame or mesh filename on appended chunks to save space
+                chunkAnim.isFirstFrameRaw = false;
+                chunkAnim.first_frame_raw = null;
+                chunkAnim.mesh_data_filename = string.Empty;
+            }
+            return chunkAnim;
+        }
+
+        private static string ChunkFilename(string baseFilename, int chunkIndex, int chunkCount)
+        {
+            return (chunkCount == 1) ? $"{baseFilename}.rat" : $"{baseFilename}_part{chunkIndex + 1:D2}of{chunkCount:D2}.rat";
+        }
+
+        /// <summary>
+        /// Plans, seeds and slices every chunk. Slicing is independent per chunk and runs on the thread pool.
+        /// </summary>
+        private static List<ChunkSpec> PrepareChunks(string baseFilename, CompressedAnimation anim, int maxFileSize, uint staticOverheadFirst, uint staticOverheadAppend, string meshDataFilename)
+        {
+            var specs = PlanChunks(anim, maxFileSize, staticOverheadFirst, staticOverheadAppend);
+            var seeds = ResolveChunkSeeds(anim, specs);
+            RunParallel(specs.Count, ci =>
+            {
+                specs[ci].chunkAnim = BuildChunkAnimation(anim, specs[ci], ci, seeds[ci], meshDataFilename);
+                specs[ci].filename = ChunkFilename(baseFilename, ci, specs.Count);
+            });
+            return specs;
+        }
 
-                if (ci == 0)
+        /// <summary>
+        /// Decodes a written chunk against the expected world-space frames. Thread-safe; does not log.
+        /// </summary>
+        private static ChunkValidationResult ValidateChunk(CompressedAnimation anim, ChunkSpec spec, List<UnityEngine.Vector3[]> processedFrames)
+        {
+            var result = new ChunkValidationResult();
+            try
+            {
+                var chunkAnim = spec.chunkAnim;
+                // To validate the chunk, create a temporary anim seeded with the quantized frame at startDeltaFrame
+                var validationAnim = new CompressedAnimation
+                {
+                    num_vertices = chunkAnim.num_vertices,
+                    num_frames = spec.chunkDeltaFrames + 1,
+                    num_indices = chunkAnim.num_indices,
+                    min_x = chunkAnim.min_x, max_x = chunkAnim.max_x,
+                    min_y = chunkAnim.min_y, max_y = chunkAnim.max_y,
+                    min_z = chunkAnim.min_z, max_z = chunkAnim.max_z,
+                    bit_widths_x = chunkAnim.bit_widths_x,
+                    bit_widths_y = chunkAnim.bit_widths_y,
+                    bit_widths_z = chunkAnim.bit_widths_z,
+                    cluster_ids = chunkAnim.cluster_ids,
+                    cluster_bounds = chunkAnim.cluster_bounds,
+                    delta_stream = chunkAnim.delta_stream,
+                    first_frame = new VertexU8[chunkAnim.num_vertices]
+                };
+                if (chunkAnim.first_frame != null && chunkAnim.first_frame.Length > 0)
                 {
-                    // Keep first frame intact
+                    int copyLen = Math.Min((int)chunkAnim.num_vertices, chunkAnim.first_frame.Length);
+                    Array.Copy(chunkAnim.first_frame, validationAnim.first_frame, copyLen);
                 }
-                else
+
+                var ctxChunk = Core.CreateDecompressionContext(validationAnim);
+                // Check only the first frame (decompressing all frames can block the editor on large animations)
+                uint maxValidateFrames = (enableHeavyValidation ? validationAnim.num_frames : 1u);
+                for (uint local = 0; local < maxValidateFrames; ++local)
                 {
-                    if (anim.quantized_frames != null && anim.quantized_frames.Length > spec.startDeltaFrame)
-                    {
-                        chunkAnim.first_frame = anim.quantized_frames[spec.startDeltaFrame];
-                    }
-                    else
+                    Core.DecompressToFrame(ctxChunk, validationAnim, local);
+                    int compareFrameIndex = (int)(spec.startDeltaFrame + local);
+                    if (compareFrameIndex >= processedFrames.Count) break; // outside of provided frames
+                    var expectedFrame = processedFrames[compareFrameIndex];
+                    for (int v = 0; v < validationAnim.num_vertices; ++v)
                     {
-                        var temp = new VertexU8[chunkAnim.num_vertices];
-                        Array.Copy(anim.first_frame, temp, (int)anim.num_vertices);
-                        if (spec.startDeltaFrame > 0 && anim.delta_stream != null && anim.delta_stream.Length > 0)
+                        var actual = Core.DequantizeVertex(validationAnim, v, ctxChunk.current_positions[v]);
+                        float err = UnityEngine.Vector3.Distance(actual, expectedFrame[v]);
+                        if (err > result.maxError)
                         {
-                            var reader = new BitstreamReader(anim.delta_stream);
-                            for (uint f = 0; f < spec.startDeltaFrame; ++f)
-                            {
-                                for (int v = 0; v < temp.Length; ++v)
-                                {
-                                    int bx = anim.bit_widths_x[v];
-                                    int by = anim.bit_widths_y[v];
-                                    int bz = anim.bit_widths_z[v];
-                                    int rawx = (int)reader.Read(bx);
-                                    int dx = SignExtendLocal((uint)rawx, bx);
-                                    int rawy = (int)reader.Read(by);
-                                    int dy = SignExtendLocal((uint)rawy, by);
-                                    int rawz = (int)reader.Read(bz);
-                                    int dz = SignExtendLocal((uint)rawz, bz);
-                                    temp[v].x = (byte)(temp[v].x + dx);
-                                    temp[v].y = (byte)(temp[v].y + dy);
-                                    temp[v].z = (byte)(temp[v].z + dz);
-                                }
-                            }
+                            result.maxError = err;
+                            result.maxErrorVertexIndex = v;
+                            result.maxExpected = expectedFrame[v];
+                            result.maxActual = actual;
                         }
-                        chunkAnim.first_frame = temp;
                     }
-                    chunkAnim.isFirstFrameRaw = false;
-                    chunkAnim.first_frame_raw = null;
-                    chunkAnim.mesh_data_filename = string.Empty;
                 }
 
-                string filename = (chunkSpecs.Count == 1) ? $"{baseFilename}.rat" : $"{baseFilename}_part{ci + 1:D2}of{chunkSpecs.Count:D2}.rat";
-                spec.filename = filename;
-                spec.chunkAnim = chunkAnim;
+                // Compute a dynamic validation tolerance based on the quantization step size
+                var step = Core.MaxQuantizationStep(validationAnim);
+                result.stepX = step.x;
+                result.stepY = step.y;
+                result.stepZ = step.z;
+                // Worst-case Euclidean error for a single-axis rounding is sqrt((step/2)^2*3).
+                float quantizationTolerance = (float)Math.Sqrt((result.stepX * 0.5f) * (result.stepX * 0.5f) + (result.stepY * 0.5f) * (result.stepY * 0.5f) + (result.stepZ * 0.5f) * (result.stepZ * 0.5f));
+                // Add a small safety margin and a conservative minimum tolerance
+                result.tolerance = Math.Max(quantizationTolerance * 1.2f, 0.01f);
+
+                if (validationAnim.first_frame.Length > 0)
+                {
+                    result.hasSeedSample = true;
+                    result.seedSample = validationAnim.first_frame[0];
+                    result.globalSample = (anim.quantized_frames != null && anim.quantized_frames.Length > spec.startDeltaFrame) ? anim.quantized_frames[spec.startDeltaFrame][0] : result.seedSample;
+                }
+            }
+            catch (System.Exception e)
+            {
+                result.exceptionMessage = e.Message;
+            }
+            return result;
+        }
+
+        private static void LogChunkValidation(ChunkValidationResult result, int chunkIndex, ChunkSpec spec)
+        {
+            if (result.exceptionMessage != null)
+            {
+                UnityEngine.Debug.LogWarning($"ExportValidation: Failed to validate chunk {chunkIndex + 1}: {result.exceptionMessage}");
+                return;
+            }
+            UnityEngine.Debug.Log($"RAT Validation: tolerance={result.tolerance:F6} (stepX={result.stepX:F6} stepY={result.stepY:F6} stepZ={result.stepZ:F6})");
+            if (result.maxError > result.tolerance)
+            {
+                UnityEngine.Debug.LogError($"RAT Validation FAILED for chunk {chunkIndex + 1}: max error {result.maxError:F6} exceeds tolerance {result.tolerance:F6}. startDeltaFrame={spec.startDeltaFrame}, chunkFrames={spec.chunkDeltaFrames}");
+                if (result.maxErrorVertexIndex >= 0)
+                {
+                    UnityEngine.Debug.LogError($"Validation fail: vertexIndex={result.maxErrorVertexIndex}, expected={result.maxExpected}, actual={result.maxActual}, diff={(result.maxActual - result.maxExpected)}");
+                }
+                if (result.hasSeedSample)
+                {
+                    var qf = result.seedSample;
+                    var globalF = result.globalSample;
+                    UnityEngine.Debug.LogError($"Chunk seed sample: chunk.first_frame[0] = ({qf.x},{qf.y},{qf.z}), global.first_frame_at_start = ({globalF.x},{globalF.y},{globalF.z})");
+                }
             }
+            else
+            {
+                UnityEngine.Debug.Log($"RAT Validation OK for chunk {chunkIndex + 1}: max error {result.maxError:F6} (tolerance {result.tolerance:F6}). startDeltaFrame={spec.startDeltaFrame}, chunkFrames={spec.chunkDeltaFrames}");
+            }
+        }
+
+        public static void WriteRatFileWithSizeSplittingChunked(
+            string baseFilename,
+            CompressedAnimation anim,
+            int maxFileSizeKB = 64,
+            List<UnityEngine.Vector3[]> processedFrames = null,
+            System.Action<int,int> perChunkProgress = null,
+            System.Action<List<string>> onComplete = null,
+            bool skipValidation = false)
+        {
+#if UNITY_EDITOR
+            // Chunks are planned and built up front (in parallel), then written one per editor update
+            const int KB = 1024;
+            int maxFileSize = maxFileSizeKB * KB;
+            var createdFiles = new List<string>();
+
+            // Calculate static data sizes for the .rat file (V3 format)
+            uint headerSize = (uint)Marshal.SizeOf(typeof(RatHeader));
+            uint bitWidthsSize = anim.num_vertices * 3;
+            uint firstFrameSize = anim.num_vertices * (uint)Marshal.SizeOf(typeof(VertexU8));
+            string meshDataFilename = !string.IsNullOrEmpty(anim.mesh_data_filename) ? anim.mesh_data_filename : $"{baseFilename}.ratmesh";
+            byte[] meshDataFilenameBytes = System.Text.Encoding.UTF8.GetBytes(Path.GetFileName(meshDataFilename));
+            uint rawFirstFrameSize = anim.isFirstFrameRaw ? anim.num_vertices * (uint)Marshal.SizeOf(typeof(UnityEngine.Vector3)) : 0;
+            uint staticOverheadSize = headerSize + ClusterTableSize(anim) + bitWidthsSize + firstFrameSize + (uint)meshDataFilenameBytes.Length + rawFirstFrameSize;
+
+            if (staticOverheadSize > maxFileSize)
+            {
+                throw new System.InvalidOperationException($"ERROR: Static RAT data ({staticOverheadSize} bytes) exceeds maximum file size ({maxFileSize} bytes)!");
+            }
+
+            // if single frame or no deltas, just write synchronously
+            if (anim.num_frames <= 1 || anim.delta_stream == null || anim.delta_stream.Length == 0)
+            {
+                string filename = $"{baseFilename}.rat";
+                using (var stream = new FileStream(filename, FileMode.Create)) WriteRatFileV3(stream, anim, Path.GetFileName(meshDataFilename));
+                createdFiles.Add(filename);
+                onComplete?.Invoke(createdFiles);
+                return;
+            }
+
+            uint staticOverheadAppend = headerSize + ClusterTableSize(anim) + bitWidthsSize + firstFrameSize + (uint)meshDataFilenameBytes.Length;
+            var chunkSpecs = PrepareChunks(baseFilename, anim, maxFileSize, staticOverheadSize, staticOverheadAppend, Path.GetFileName(meshDataFilename));
 
             // Now write per chunk via EditorApplication.update
             var created = new List<string>();
@@ -629,16 +1036,218 @@ namespace Rat
             return (byte)bits;
         }
 
-        // Sign extend helper for Tool to reuse the same logic as Core.SignExtend
-        private static int SignExtendLocal(uint value, int bits)
+        /// <summary>
+        /// Axis-aligned bounds over every vertex of every frame. Blocks of frames are reduced in parallel.
+        /// </summary>
+        private static void ComputeFrameBounds(List<UnityEngine.Vector3[]> frames, out UnityEngine.Vector3 minBounds, out UnityEngine.Vector3 maxBounds)
         {
-            if (bits == 0) return 0;
-            int shift = 32 - bits;
-            return (int)((value << shift) >> shift);
+            int blocks = BlockCount(frames.Count, 8);
+            var blockMin = new UnityEngine.Vector3[blocks];
+            var blockMax = new UnityEngine.Vector3[blocks];
+            var seed = frames[0][0];
+            RunParallel(blocks, b =>
+            {
+                BlockRange(b, blocks, frames.Count, out int start, out int end);
+                UnityEngine.Vector3 mn = seed, mx = seed;
+                for (int f = start; f < end; f++)
+                {
+                    var frame = frames[f];
+                    for (int i = 0; i < frame.Length; i++)
+                    {
+                        var v = frame[i];
+                        if (v.x < mn.x) mn.x = v.x;
+                        if (v.y < mn.y) mn.y = v.y;
+                        if (v.z < mn.z) mn.z = v.z;
+                        if (v.x > mx.x) mx.x = v.x;
+                        if (v.y > mx.y) mx.y = v.y;
+                        if (v.z > mx.z) mx.z = v.z;
+                    }
+                }
+                blockMin[b] = mn;
+                blockMax[b] = mx;
+            });
+
+            minBounds = blockMin[0];
+            maxBounds = blockMax[0];
+            for (int b = 1; b < blocks; b++)
+            {
+                minBounds = UnityEngine.Vector3.Min(minBounds, blockMin[b]);
+                maxBounds = UnityEngine.Vector3.Max(maxBounds, blockMax[b]);
+            }
+        }
+
+        /// <summary>
+        /// Quantizes every frame to 8 bits per axis against one bounding box. Frames are independent and run in parallel.
+        /// </summary>
+        private static VertexU8[][] QuantizeFrames(List<UnityEngine.Vector3[]> rawFrames, uint numVertices, UnityEngine.Vector3 minBounds, UnityEngine.Vector3 range, bool clampToBounds)
+        {
+            var quantizedFrames = new VertexU8[rawFrames.Count][];
+            RunParallel(rawFrames.Count, f =>
+            {
+                var src = rawFrames[f];
+                var dst = new VertexU8[numVertices];
+                for (int v = 0; v < numVertices; v++)
+                {
+                    float nx = (src[v].x - minBounds.x) / range.x;
+                    float ny = (src[v].y - minBounds.y) / range.y;
+                    float nz = (src[v].z - minBounds.z) / range.z;
+                    if (clampToBounds)
+                    {
+                        nx = UnityEngine.Mathf.Clamp01(nx);
+                        ny = UnityEngine.Mathf.Clamp01(ny);
+                        nz = UnityEngine.Mathf.Clamp01(nz);
+                    }
+                    // Map vertex from world space into 0-255 quantized space using bounds
+                    dst[v].x = (byte)UnityEngine.Mathf.RoundToInt(255 * nx);
+                    dst[v].y = (byte)UnityEngine.Mathf.RoundToInt(255 * ny);
+                    dst[v].z = (byte)UnityEngine.Mathf.RoundToInt(255 * nz);
+                }
+                quantizedFrames[f] = dst;
+            });
+            return quantizedFrames;
         }
 
         /// <summary>
-        /// Writes a RAT3 format file to a stream. Only RAT3 format is supported.
+        /// Picks per-vertex delta bit widths from the largest frame-to-frame step on each axis.
+        /// Each block of frames keeps its own maxima; the blocks are merged once at the end.
+        /// </summary>
+        private static void SelectBitWidths(VertexU8[][] quantizedFrames, uint numVertices, byte[] bitWidthsX, byte[] bitWidthsY, byte[] bitWidthsZ)
+        {
+            int deltaFrames = quantizedFrames.Length - 1;
+            if (deltaFrames <= 0) return;
+
+            int n = (int)numVertices;
+            int blocks = BlockCount(deltaFrames, 16);
+            var blockMaxima = new byte[blocks][];
+            RunParallel(blocks, b =>
+            {
+                BlockRange(b, blocks, deltaFrames, out int start, out int end);
+                var maxAbs = new byte[n * 3];
+                for (int d = start; d < end; d++)
+                {
+                    var prev = quantizedFrames[d];
+                    var cur = quantizedFrames[d + 1];
+                    for (int v = 0; v < n; v++)
+                    {
+                        int dx = Math.Abs(cur[v].x - prev[v].x);
+                        int dy = Math.Abs(cur[v].y - prev[v].y);
+                        int dz = Math.Abs(cur[v].z - prev[v].z);
+                        if (dx > maxAbs[v * 3 + 0]) maxAbs[v * 3 + 0] = (byte)dx;
+                        if (dy > maxAbs[v * 3 + 1]) maxAbs[v * 3 + 1] = (byte)dy;
+                        if (dz > maxAbs[v * 3 + 2]) maxAbs[v * 3 + 2] = (byte)dz;
+                    }
+                }
+                blockMaxima[b] = maxAbs;
+            });
+
+            for (int v = 0; v < n; v++)
+            {
+                int maxDx = 0, maxDy = 0, maxDz = 0;
+                for (int b = 0; b < blocks; b++)
+                {
+                    var maxAbs = blockMaxima[b];
+                    if (maxAbs[v * 3 + 0] > maxDx) maxDx = maxAbs[v * 3 + 0];
+                    if (maxAbs[v * 3 + 1] > maxDy) maxDy = maxAbs[v * 3 + 1];
+                    if (maxAbs[v * 3 + 2] > maxDz) maxDz = maxAbs[v * 3 + 2];
+                }
+                bitWidthsX[v] = BitsForDelta(maxDx);
+                bitWidthsY[v] = BitsForDelta(maxDy);
+                bitWidthsZ[v] = BitsForDelta(maxDz);
+            }
+        }
+
+        /// <summary>
+        /// Packs the frame-to-frame deltas into the RAT bitstream. Every delta frame has the same bit size, so each
+        /// block of frames knows its start bit up front and is packed on its own thread; the blocks are then OR-merged.
+        /// The result is identical to packing all frames with a single <see cref="BitstreamWriter"/>.
+        /// </summary>
+        private static uint[] PackDeltaStream(VertexU8[][] quantizedFrames, uint numVertices, byte[] bitWidthsX, byte[] bitWidthsY, byte[] bitWidthsZ)
+        {
+            int deltaFrames = quantizedFrames.Length - 1;
+            if (deltaFrames <= 0) return Array.Empty<uint>();
+
+            int n = (int)numVertices;
+            long bitsPerFrame = 0;
+            for (int v = 0; v < n; v++) bitsPerFrame += bitWidthsX[v] + bitWidthsY[v] + bitWidthsZ[v];
+
+            var stream = new uint[(bitsPerFrame * deltaFrames + 31) / 32];
+            int blocks = BlockCount(deltaFrames, 16);
+            var blockWords = new uint[blocks][];
+            RunParallel(blocks, b =>
+            {
+                BlockRange(b, blocks, deltaFrames, out int start, out int end);
+                var writer = new BitstreamWriter((int)((bitsPerFrame * start) % 32));
+                for (int d = start; d < end; d++)
+                {
+                    var prev = quantizedFrames[d];
+                    var cur = quantizedFrames[d + 1];
+                    for (int v = 0; v < n; v++)
+                    {
+                        writer.Write((uint)(cur[v].x - prev[v].x), bitWidthsX[v]);
+                        writer.Write((uint)(cur[v].y - prev[v].y), bitWidthsY[v]);
+                        writer.Write((uint)(cur[v].z - prev[v].z), bitWidthsZ[v]);
+                    }
+                }
+                writer.Flush();
+                blockWords[b] = writer.ToArray();
+            });
+
+            // Neighbouring blocks may share their boundary word; their bits never overlap, so OR merges them exactly
+            for (int b = 0; b < blocks; b++)
+            {
+                BlockRange(b, blocks, deltaFrames, out int start, out int end);
+                long startWord = (bitsPerFrame * start) / 32;
+                var words = blockWords[b];
+                for (int i = 0; i < words.Length; i++) stream[startWord + i] |= words[i];
+            }
+            return stream;
+        }
+
+        /// <summary>
+        /// Applies one matrix per frame to every vertex of that frame. Frames are transformed in parallel.
+        /// </summary>
+        private static List<UnityEngine.Vector3[]> BakeFrameMatrices(List<UnityEngine.Vector3[]> frames, UnityEngine.Matrix4x4[] matrices)
+        {
+            var baked = new UnityEngine.Vector3[frames.Count][];
+            RunParallel(frames.Count, f =>
+            {
+                var src = frames[f];
+                var matrix = matrices[f];
+                var dst = new UnityEngine.Vector3[src.Length];
+                for (int i = 0; i < src.Length; i++) dst[i] = matrix.MultiplyPoint3x4(src[i]);
+                baked[f] = dst;
+            });
+            return new List<UnityEngine.Vector3[]>(baked);
+        }
+
+        /// <summary>
+        /// Builds the per-frame TRS matrices on the calling thread (Quaternion.Euler/Matrix4x4.TRS are engine calls).
+        /// </summary>
+        private static UnityEngine.Matrix4x4[] BuildTransformMatrices(List<ActorTransformFloat> transforms)
+        {
+            var matrices = new UnityEngine.Matrix4x4[transforms.Count];
+            for (int i = 0; i < transforms.Count; i++)
+            {
+                var t = transforms[i];
+                matrices[i] = UnityEngine.Matrix4x4.TRS(t.position, UnityEngine.Quaternion.Euler(t.rotation), t.scale);
+            }
+            return matrices;
+        }
+
+        /// <summary>
+        /// Negates Z of every vertex in place (Unity left-handed to OpenGL right-handed).
+        /// </summary>
+        private static void FlipFramesZ(List<UnityEngine.Vector3[]> frames)
+        {
+            RunParallel(frames.Count, f =>
+            {
+                var frame = frames[f];
+                for (int i = 0; i < frame.Length; i++) frame[i].z = -frame[i].z;
+            });
+        }
+
+        /// <summary>
+        /// Writes a RAT3 format file to a stream, or RAT4 when the animation carries per-cluster bounds.
         /// Mesh data (UVs, colors, indices) is embedded in .act files, not in .ratmodel files.
         /// </summary>
         public static void WriteRatFile(Stream stream, CompressedAnimation anim, string meshDataFilename = null)
@@ -651,13 +1260,23 @@ namespace Rat
         }
         
         /// <summary>
-        /// Internal method to write RAT3 format. Use WriteRatFile() instead.
+        /// Bytes the RAT4 cluster header, bounds and per-vertex ids add after the RatHeader (0 for RAT3).
+        /// </summary>
+        private static uint ClusterTableSize(CompressedAnimation anim)
+        {
+            if (anim.cluster_ids == null) return 0;
+            return (uint)Marshal.SizeOf(typeof(RatClusterHeader)) + (uint)anim.cluster_bounds.Length * sizeof(float) + anim.num_vertices;
+        }
+
+        /// <summary>
+        /// Internal method to write RAT3 format (RAT4 when clustered). Use WriteRatFile() instead.
         /// </summary>
         private static void WriteRatFileV3(Stream stream, CompressedAnimation anim, string meshDataFilename)
         {
             using (var writer = new BinaryWriter(stream))
             {
-                uint headerSize = (uint)Marshal.SizeOf(typeof(RatHeader));
+                // The cluster table sits between the header and the bit widths, so every RAT3 offset just shifts by its size
+                uint headerSize = (uint)Marshal.SizeOf(typeof(RatHeader)) + ClusterTableSize(anim);
                 uint bitWidthsSize = anim.num_vertices * 3;
                 uint firstFrameSize = anim.num_vertices * (uint)Marshal.SizeOf(typeof(VertexU8));
                 byte[] meshDataFilenameBytes = System.Text.Encoding.UTF8.GetBytes(meshDataFilename);
@@ -665,7 +1284,7 @@ namespace Rat
 
                 var header = new RatHeader
                 {
-                    magic = 0x33544152, // "RAT3"
+                    magic = anim.cluster_ids != null ? Core.MagicRat4 : Core.MagicRat3,
                     num_vertices = anim.num_vertices,
                     num_frames = anim.num_frames,
                     num_indices = anim.num_indices,
@@ -681,13 +1300,35 @@ namespace Rat
                     reserved = new byte[3]
                 };
 
-                byte[] headerBytes = new byte[headerSize];
-                IntPtr ptr = Marshal.AllocHGlobal((int)headerSize);
+                int ratHeaderSize = Marshal.SizeOf(typeof(RatHeader));
+                byte[] headerBytes = new byte[ratHeaderSize];
+                IntPtr ptr = Marshal.AllocHGlobal(ratHeaderSize);
                 Marshal.StructureToPtr(header, ptr, false);
-                Marshal.Copy(ptr, headerBytes, 0, (int)headerSize);
+                Marshal.Copy(ptr, headerBytes, 0, ratHeaderSize);
                 Marshal.FreeHGlobal(ptr);
                 writer.Write(headerBytes);
 
+                if (anim.cluster_ids != null)
+                {
+                    int clusterHeaderSize = Marshal.SizeOf(typeof(RatClusterHeader));
+                    uint boundsOffset = (uint)(ratHeaderSize + clusterHeaderSize);
+                    var clusterHeader = new RatClusterHeader
+                    {
+                        num_clusters = (uint)anim.cluster_bounds.Length / 6,
+                        cluster_bounds_offset = boundsOffset,
+                        cluster_ids_offset = boundsOffset + (uint)anim.cluster_bounds.Length * sizeof(float)
+                    };
+                    byte[] clusterHeaderBytes = new byte[clusterHeaderSize];
+                    ptr = Marshal.AllocHGlobal(clusterHeaderSize);
+                    Marshal.StructureToPtr(clusterHeader, ptr, false);
+                    Marshal.Copy(ptr, clusterHeaderBytes, 0, clusterHeaderSize);
+                    Marshal.FreeHGlobal(ptr);
+                    writer.Write(clusterHeaderBytes);
+
+                    foreach (var f in anim.cluster_bounds) writer.Write(f);
+                    writer.Write(anim.cluster_ids);
+                }
+
                 writer.Write(anim.bit_widths_x);
                 writer.Write(anim.bit_widths_y);
                 writer.Write(anim.bit_widths_z);
@@ -708,6 +1349,7 @@ namespace Rat
         /// <summary>
         /// Writes RAT files with automatic size-based splitting at 64KB boundaries.
         /// Throws an exception if the first frame data exceeds 64KB.
+        /// Chunks are planned first, then sliced, written and validated in parallel; logging and progress stay on the caller's thread.
         /// </summary>
         /// <param name="baseFilename">Base filename without extension</param>
         /// <param name="anim">Compressed animation data to split and save</param>
@@ -732,14 +1374,14 @@ namespace Rat
             uint rawFirstFrameSize = anim.isFirstFrameRaw ? anim.num_vertices * (uint)Marshal.SizeOf(typeof(UnityEngine.Vector3)) : 0;
             
             // Calculate static overhead (everything except delta stream)
-            uint staticOverheadSize = headerSize + bitWidthsSize + firstFrameSize + (uint)meshDataFilenameBytes.Length + rawFirstFrameSize;
+            uint staticOverheadSize = headerSize + ClusterTableSize(anim) + bitWidthsSize + firstFrameSize + (uint)meshDataFilenameBytes.Length + rawFirstFrameSize;
             
             // Check if the static data alone exceeds the size limit
             if (staticOverheadSize > maxFileSize)
             {
                 throw new System.InvalidOperationException(
                     $"ERROR: Static RAT data ({staticOverheadSize} bytes) exceeds maximum file size ({maxFileSize} bytes)!\n" +
-                    $"Breakdown: Header({headerSize}) + BitWidths({bitWidthsSize}) + FirstFrame({firstFrameSize}) + Filename({meshDataFilenameBytes.Length}) + RawFirstFrame({rawFirstFrameSize})\n" +
+                    $"Breakdown: Header({headerSize}) + Clusters({ClusterTableSize(anim)}) + BitWidths({bitWidthsSize}) + FirstFrame({firstFrameSize}) + Filename({meshDataFilenameBytes.Length}) + RawFirstFrame({rawFirstFrameSize})\n" +
                     $"Consider reducing mesh complexity or increasing maxFileSizeKB parameter.");
             }
             
@@ -755,363 +1397,132 @@ namespace Rat
                 UnityEngine.Debug.Log($"Created single RAT file: {filename} ({new FileInfo(filename).Length} bytes)");
                 return createdFiles;
             }
-            
-            // Calculate bits per frame and words per frame (per-frame words may vary due to bit packing)
-            uint bitsPerFrame = 0;
-            for (int i = 0; i < anim.num_vertices; i++) bitsPerFrame += (uint)(anim.bit_widths_x[i] + anim.bit_widths_y[i] + anim.bit_widths_z[i]);
-            // Precompute words used per delta-frame to account for bit packing across frames
-            uint totalDeltaFramesToCompute = (anim.num_frames > 0) ? (anim.num_frames - 1) : 0;
-            var wordsPerDeltaFrame = new uint[totalDeltaFramesToCompute > 0 ? totalDeltaFramesToCompute : 1];
-            uint cumulativeWordsBefore = 0;
-            for (uint f = 0; f < totalDeltaFramesToCompute; ++f)
-            {
-                // Words used up to and including this frame
-                uint wordsUpToFPlus1 = (bitsPerFrame * (f + 1) + 31) / 32;
-                uint wordsUpToF = (bitsPerFrame * f + 31) / 32;
-                uint wordsThisFrame = wordsUpToFPlus1 - wordsUpToF;
-                wordsPerDeltaFrame[f] = wordsThisFrame;
-                cumulativeWordsBefore += wordsThisFrame;
-            }
-            // total words per frame average fallback
-            uint wordsPerFrame = (bitsPerFrame + 31) / 32;
-
-            // Calculate available space for delta data per chunk (first chunk may include raw first frame)
-            uint availableSpaceForDeltasFirst = (uint)(maxFileSize - staticOverheadSize);
-            // For subsequent chunks: omit raw_first_frame (if present) and mesh filename to maximize delta space if desired
-            uint staticOverheadAppend = headerSize + bitWidthsSize + firstFrameSize + (uint)meshDataFilenameBytes.Length; // exclude rawFirstFrame if present
-            uint availableSpaceForDeltasAppend = (uint)(maxFileSize - staticOverheadAppend);
-            uint deltaStreamWordSize = sizeof(uint);
-            
-            // Calculate how to split the delta stream
-            uint totalDeltaWords = (uint)anim.delta_stream.Length;
-            uint totalDeltaFrames = (anim.num_frames > 0) ? (anim.num_frames - 1) : 0;
-            if (wordsPerFrame == 0) wordsPerFrame = 1; // avoid div by zero for degenerate cases
-            // Use append available space as baseline for frames-per-chunk (since most chunks will be append-like)
-            uint maxDeltaWordsPerChunk = availableSpaceForDeltasAppend / deltaStreamWordSize;
-            
-            if (maxDeltaWordsPerChunk == 0)
+
+            // For subsequent chunks: omit raw_first_frame (if present) to maximize delta space
+            uint staticOverheadAppend = headerSize + ClusterTableSize(anim) + bitWidthsSize + firstFrameSize + (uint)meshDataFilenameBytes.Length;
+            var chunkSpecs = PrepareChunks(baseFilename, anim, maxFileSize, staticOverheadSize, staticOverheadAppend, Path.GetFileName(meshDataFilename));
+
+            UnityEngine.Debug.Log($"Splitting RAT animation into {chunkSpecs.Count} chunks (max {maxFileSizeKB}KB each):");
+
+            // Each chunk goes to its own file, so the writes do not contend
+            RunParallel(chunkSpecs.Count, ci =>
             {
-                throw new System.InvalidOperationException(
-                    $"ERROR: Cannot fit any delta data within {maxFileSizeKB}KB limit! Static overhead is {staticOverheadSize} bytes, " +
-                    $"leaving only {availableSpaceForDeltasAppend} bytes for deltas (append-case), but need at least {deltaStreamWordSize} bytes per delta word.");
-            }
-            
-            // If maxDeltaWordsPerChunk is zero, ensure at least one word per chunk
-            if (maxDeltaWordsPerChunk == 0) maxDeltaWordsPerChunk = 1;
-            // Use the precomputed per-frame word counts to figure the best frame count that fits in a chunk
-            // We'll derive chunking by summing wordsPerDeltaFrame per-frame values until we reach maxDeltaWordsPerChunk
-            uint deltaFramesPerAppendChunk = 0;
-            if (totalDeltaFrames > 0)
-            {
-                uint acc = 0;
-                for (uint i = 0; i < totalDeltaFrames; ++i)
-                {
-                    acc += wordsPerDeltaFrame[i];
-                    if (acc >= maxDeltaWordsPerChunk)
-                    {
-                        deltaFramesPerAppendChunk = i + 1;
-                        break;
-                    }
-                }
-                if (deltaFramesPerAppendChunk == 0)
+                var spec = chunkSpecs[ci];
+                using (var stream = new FileStream(spec.filename, FileMode.Create))
                 {
-                    // If we didn't reach the threshold, use all remaining frames
-                    deltaFramesPerAppendChunk = totalDeltaFrames;
+                    WriteRatFileV3(stream, spec.chunkAnim, spec.chunkAnim.mesh_data_filename);
                 }
-            }
-            else
-            {
-                deltaFramesPerAppendChunk = 1;
-            }
-            if (deltaFramesPerAppendChunk == 0) deltaFramesPerAppendChunk = 1; // ensure at least one delta frame per chunk
-            int numberOfChunks = UnityEngine.Mathf.CeilToInt((float)totalDeltaFrames / (float)deltaFramesPerAppendChunk);
-            
-            UnityEngine.Debug.Log($"Splitting RAT animation into {numberOfChunks} chunks (max {maxFileSizeKB}KB each):");
-            
-            uint nextStartDfIndex = 0;
-            // Precompute prefix word sums for fast start offsets
-            uint[] prefixWords = new uint[totalDeltaFrames + 1]; // prefixWords[frame] = words used by frames [0 .. frame-1]
-            uint running = 0;
-            prefixWords[0] = 0;
-            for (uint f = 0; f < totalDeltaFrames; ++f)
+            });
+
+            for (int chunkIndex = 0; chunkIndex < chunkSpecs.Count; chunkIndex++)
             {
-                running += wordsPerDeltaFrame[f];
-                prefixWords[f + 1] = running;
+                perChunkProgress?.Invoke(chunkIndex + 1, chunkSpecs.Count);
+                string filename = chunkSpecs[chunkIndex].filename;
+                createdFiles.Add(filename);
+                UnityEngine.Debug.Log($"  Chunk {chunkIndex + 1}: {filename} ({new FileInfo(filename).Length} bytes)");
             }
-            for (int chunkIndex = 0; chunkIndex < numberOfChunks; chunkIndex++)
+
+            // Optional: Validate written chunks by decompressing them and comparing against the expected frames
+            if (processedFrames != null && anim.quantized_frames != null)
             {
-                perChunkProgress?.Invoke(chunkIndex + 1, numberOfChunks);
-                uint startDeltaFrame = nextStartDfIndex; // zero-based delta frame index
-                uint remainingDeltaFrames = totalDeltaFrames - startDeltaFrame;
-                uint chunkDeltaFrames = 0;
-                if (chunkIndex == 0)
-                {
-                    uint deltaWordsFirst = availableSpaceForDeltasFirst / deltaStreamWordSize;
-                    // Determine how many frames fit by summing per-frame words
-                    uint accWords = 0;
-                    uint framesFits = 0;
-                    for (uint ff = startDeltaFrame; ff < startDeltaFrame + remainingDeltaFrames; ++ff)
-                    {
-                        if (ff >= totalDeltaFrames) break;
-                        accWords += wordsPerDeltaFrame[ff];
-                        if (accWords > deltaWordsFirst) break;
-                        framesFits++;
-                    }
-                    if (framesFits == 0) framesFits = 1;
-                    chunkDeltaFrames = (uint)System.Math.Min(remainingDeltaFrames, framesFits);
-                }
-                else
-                {
-                    chunkDeltaFrames = (uint)System.Math.Min(remainingDeltaFrames, deltaFramesPerAppendChunk);
-                }
-                // chunk covers frames: base frame index = startDeltaFrame, dest frames = startDeltaFrame+1 .. startDeltaFrame + chunkDeltaFrames
-                // start and lengths in words using exact per-frame word counts
-                uint startDeltaWord = prefixWords[startDeltaFrame];
-                // Sum per-frame words for this chunk
-                uint chunkDeltaWords = 0;
-                for (uint f = startDeltaFrame; f < startDeltaFrame + chunkDeltaFrames; ++f)
-                {
-                    if (f < totalDeltaFrames) chunkDeltaWords += wordsPerDeltaFrame[f];
-                }
-                
-                    var chunkAnim = new CompressedAnimation
-                {
-                    num_vertices = anim.num_vertices,
-                    num_indices = anim.num_indices,
-                        // num_frames: for first chunk we write global animation frame count; for appended chunks write local chunk length
-                            num_frames = (chunkIndex == 0) ? anim.num_frames : (chunkDeltaFrames + 1),
-                    min_x = anim.min_x, max_x = anim.max_x,
-                    min_y = anim.min_y, max_y = anim.max_y,
-                    min_z = anim.min_z, max_z = anim.max_z,
-                    first_frame = anim.first_frame,
-                    first_frame_raw = anim.first_frame_raw,
-                    isFirstFrameRaw = anim.isFirstFrameRaw,
-                    bit_widths_x = anim.bit_widths_x,
-                    bit_widths_y = anim.bit_widths_y,
-                    bit_widths_z = anim.bit_widths_z,
-                    mesh_data_filename = Path.GetFileName(meshDataFilename)
-                };
-                
-                if (chunkDeltaWords > 0 && anim.delta_stream != null && anim.delta_stream.Length > 0)
-                {
-                    int totalDeltaWordsInt = anim.delta_stream.Length;
-                    long startLong = Math.Min((long)startDeltaWord, (long)totalDeltaWordsInt);
-                    if (startLong >= totalDeltaWordsInt)
-                    {
-                        UnityEngine.Debug.LogWarning($"RAT: computed startDeltaWord {startDeltaWord} >= totalDeltaWords {totalDeltaWordsInt}, writing empty delta stream for chunk.");
-                        chunkAnim.delta_stream = new uint[0];
-                    }
-                    else
-                    {
-                        int available = totalDeltaWordsInt - (int)startLong;
-                        int copyWords = (int)Math.Min((long)chunkDeltaWords, (long)available);
-                        if (copyWords < chunkDeltaWords)
-                        {
-                            UnityEngine.Debug.LogWarning($"RAT: chunk copy length clamped from {chunkDeltaWords} to {copyWords} due to available source words ({available}).");
-                        }
-                        chunkAnim.delta_stream = new uint[copyWords];
-                        System.Array.Copy(anim.delta_stream, (int)startLong, chunkAnim.delta_stream, 0, copyWords);
-                        // Update chunkDeltaWords to reflect actual copied words
-                        chunkDeltaWords = (uint)copyWords;
-                        // Recompute actual chunkDeltaFrames in case the copied words were less than expected
-                        uint actualChunkDeltaFrames = 0;
-                        uint wordsConsumedCheck = 0;
-                        for (uint ff = startDeltaFrame; ff < startDeltaFrame + chunkDeltaFrames && ff < totalDeltaFrames; ++ff)
-                        {
-                            uint w = wordsPerDeltaFrame[ff];
-                            if (wordsConsumedCheck + w > chunkDeltaWords) break;
-                            wordsConsumedCheck += w;
-                            actualChunkDeltaFrames++;
-                        }
-                        chunkDeltaFrames = actualChunkDeltaFrames;
-                    }
-                }
-                else
+                var results = new ChunkValidationResult[chunkSpecs.Count];
+                RunParallel(chunkSpecs.Count, ci => results[ci] = ValidateChunk(anim, chunkSpecs[ci], processedFrames));
+                for (int chunkIndex = 0; chunkIndex < chunkSpecs.Count; chunkIndex++)
                 {
-                    chunkAnim.delta_stream = new uint[0];
+                    LogChunkValidation(results[chunkIndex], chunkIndex, chunkSpecs[chunkIndex]);
                 }
-                
-                string filename = (numberOfChunks == 1)
-                    ? $"{baseFilename}.rat"
-                    : $"{baseFilename}_part{chunkIndex + 1:D2}of{numberOfChunks:D2}.rat";
-                
-                // Prepare chunk-specific metadata
-                // For non-first chunks, set the chunk header first_frame to the quantized frame at chunk start
-                if (chunkIndex == 0)
+            }
+            
+            return createdFiles;
+        }
+        
+        /// <summary>
+        /// Writes adaptive segments from <see cref="CompressFromFramesAdaptive"/> as one run of RAT4 chunk files.
+        /// Each segment is split like a normal animation. Chunks are numbered across all segments, so the engine
+        /// streams them exactly like RAT3 parts. Each chunk carries its own cluster table.
+        /// The first file stores the total frame count and every later file its local count.
+        /// Each segment's first chunk is seeded with that segment's own first frame, quantized against its own cluster
+        /// bounds. Segments overlap by one frame, so that is the same source frame the previous segment ends on.
+        /// </summary>
+        public static List<string> WriteRatSegmentsWithSizeSplitting(string baseFilename, List<CompressedAnimation> segments, int maxFileSizeKB = 64, List<UnityEngine.Vector3[]> processedFrames = null, System.Action<int,int> perChunkProgress = null)
+        {
+            if (segments.Count == 1 && segments[0].num_frames <= 1)
+            {
+                return WriteRatFileWithSizeSplitting(baseFilename, segments[0], maxFileSizeKB, processedFrames, perChunkProgress);
+            }
+
+            int maxFileSize = maxFileSizeKB * 1024;
+            uint totalFrames = 1;
+            foreach (var segment in segments) totalFrames += segment.num_frames - 1;
+
+            var allSpecs = new List<ChunkSpec>();
+            var specSegment = new List<int>();
+            var segmentStart = new int[segments.Count];
+            int frameCursor = 0;
+            for (int si = 0; si < segments.Count; si++)
+            {
+                var anim = segments[si];
+                string meshDataFilename = Path.GetFileName(!string.IsNullOrEmpty(anim.mesh_data_filename) ? anim.mesh_data_filename : $"{baseFilename}.ratmesh");
+                uint staticOverhead = (uint)Marshal.SizeOf(typeof(RatHeader)) + ClusterTableSize(anim) + anim.num_vertices * 6 + (uint)System.Text.Encoding.UTF8.GetByteCount(meshDataFilename);
+                if (staticOverhead > maxFileSize)
                 {
-                    // First chunk keeps anim.first_frame and optionally raw_first_frame and mesh filename
+                    throw new System.InvalidOperationException($"ERROR: Static RAT data ({staticOverhead} bytes) exceeds maximum file size ({maxFileSize} bytes)!");
                 }
-                else
+
+                var specs = PrepareChunks(baseFilename, anim, maxFileSize, staticOverhead, staticOverhead, meshDataFilename);
+                foreach (var spec in specs)
                 {
-                    // Try to seed from precomputed quantized frames if available (most accurate)
-                    if (anim.quantized_frames != null && anim.quantized_frames.Length > startDeltaFrame)
-                    {
-                        chunkAnim.first_frame = anim.quantized_frames[startDeltaFrame];
-                    }
-                    else
-                    {
-                        // Fallback: reconstruct by applying deltas from global first frame up to startDeltaFrame
-                        var temp = new VertexU8[chunkAnim.num_vertices];
-                        Array.Copy(anim.first_frame, temp, (int)anim.num_vertices);
-                        if (startDeltaFrame > 0 && anim.delta_stream != null && anim.delta_stream.Length > 0)
-                        {
-                            // Read deltas from the global stream up to startDeltaFrame
-                            var reader = new BitstreamReader(anim.delta_stream);
-                            for (uint f = 0; f < startDeltaFrame; ++f)
-                            {
-                                for (int v = 0; v < temp.Length; ++v)
-                                {
-                                    int bx = anim.bit_widths_x[v];
-                                    int by = anim.bit_widths_y[v];
-                                    int bz = anim.bit_widths_z[v];
-                                    int rawx = (int)reader.Read(bx);
-                                    int dx = SignExtendLocal((uint)rawx, bx);
-                                    int rawy = (int)reader.Read(by);
-                                    int dy = SignExtendLocal((uint)rawy, by);
-                                    int rawz = (int)reader.Read(bz);
-                                    int dz = SignExtendLocal((uint)rawz, bz);
-                                    temp[v].x = (byte)(temp[v].x + dx);
-                                    temp[v].y = (byte)(temp[v].y + dy);
-                                    temp[v].z = (byte)(temp[v].z + dz);
-                                }
-                            }
-                        }
-                        chunkAnim.first_frame = temp;
-                    }
-                    // Do not include raw_first_frame or mesh filename on appended chunks to save space
-                    chunkAnim.isFirstFrameRaw = false;
-                    chunkAnim.first_frame_raw = null;
-                    chunkAnim.mesh_data_filename = string.Empty;
+                    spec.chunkAnim.num_frames = spec.chunkDeltaFrames + 1;
+                    allSpecs.Add(spec);
+                    specSegment.Add(si);
                 }
+                segmentStart[si] = frameCursor;
+                frameCursor += (int)anim.num_frames - 1;
+            }
+            allSpecs[0].chunkAnim.num_frames = totalFrames;
+
+            for (int ci = 0; ci < allSpecs.Count; ci++)
+            {
+                allSpecs[ci].filename = ChunkFilename(baseFilename, ci, allSpecs.Count);
+            }
 
-                // Ensure num_frames header reflects actual copied chunk frames
-                if (chunkIndex != 0)
+            UnityEngine.Debug.Log($"Splitting adaptive RAT animation ({segments.Count} segments) into {allSpecs.Count} chunks (max {maxFileSizeKB}KB each):");
+
+            RunParallel(allSpecs.Count, ci =>
+            {
+                var spec = allSpecs[ci];
+                using (var stream = new FileStream(spec.filename, FileMode.Create))
                 {
-                    chunkAnim.num_frames = (chunkDeltaFrames + 1);
+                    WriteRatFileV3(stream, spec.chunkAnim, spec.chunkAnim.mesh_data_filename);
                 }
-                using (var stream = new FileStream(filename, FileMode.Create))
+            });
+
+            var createdFiles = new List<string>();
+            for (int ci = 0; ci < allSpecs.Count; ci++)
+            {
+                perChunkProgress?.Invoke(ci + 1, allSpecs.Count);
+                createdFiles.Add(allSpecs[ci].filename);
+                UnityEngine.Debug.Log($"  Chunk {ci + 1}: {allSpecs[ci].filename} ({new FileInfo(allSpecs[ci].filename).Length} bytes)");
+            }
+
+            if (processedFrames != null)
+            {
+                var results = new ChunkValidationResult[allSpecs.Count];
+                RunParallel(allSpecs.Count, ci =>
                 {
-                    WriteRatFileV3(stream, chunkAnim, chunkAnim.mesh_data_filename);
-                }
-                
-                createdFiles.Add(filename);
-                UnityEngine.Debug.Log($"  Chunk {chunkIndex + 1}: {filename} ({new FileInfo(filename).Length} bytes)");
-                
-                // Optional: Validate written chunk by reading it back and comparing decompressed frames
-                if (processedFrames != null && anim.quantized_frames != null)
+                    int si = specSegment[ci];
+                    int count = Math.Min((int)segments[si].num_frames, processedFrames.Count - segmentStart[si]);
+                    results[ci] = ValidateChunk(segments[si], allSpecs[ci], processedFrames.GetRange(segmentStart[si], count));
+                });
+                for (int ci = 0; ci < allSpecs.Count; ci++)
                 {
-                    try
-                    {
-                        // To validate the chunk, create a temporary anim seeded with the quantized frame at startDeltaFrame
-                        var validationAnim = new CompressedAnimation
-                        {
-                            num_vertices = chunkAnim.num_vertices,
-                            num_frames = chunkAnim.num_frames,
-                            num_indices = chunkAnim.num_indices,
-                            min_x = chunkAnim.min_x, max_x = chunkAnim.max_x,
-                            min_y = chunkAnim.min_y, max_y = chunkAnim.max_y,
-                            min_z = chunkAnim.min_z, max_z = chunkAnim.max_z,
-                            bit_widths_x = chunkAnim.bit_widths_x,
-                            bit_widths_y = chunkAnim.bit_widths_y,
-                            bit_widths_z = chunkAnim.bit_widths_z,
-                            delta_stream = chunkAnim.delta_stream,
-                            first_frame = new VertexU8[chunkAnim.num_vertices]
-                        };
-                        // Seed validationAnim.first_frame from global quantized frames at the chunk start
-                        if (chunkAnim.first_frame != null && chunkAnim.first_frame.Length > 0)
-                        {
-                            var src = chunkAnim.first_frame;
-                            int srcLen = src.Length;
-                            int dstLen = validationAnim.first_frame.Length;
-                            int copyLen = Math.Min((int)chunkAnim.num_vertices, Math.Min(srcLen, dstLen));
-                            Array.Copy(src, validationAnim.first_frame, copyLen);
-                        }
-                        else if (anim.quantized_frames != null && anim.quantized_frames.Length > startDeltaFrame)
-                        {
-                            var src = anim.quantized_frames[startDeltaFrame];
-                            int srcLen = src.Length;
-                            int dstLen = validationAnim.first_frame.Length;
-                            int copyLen = Math.Min((int)chunkAnim.num_vertices, Math.Min(srcLen, dstLen));
-                            Array.Copy(src, validationAnim.first_frame, copyLen);
-                        }
-                        var ctxChunk = Core.CreateDecompressionContext(validationAnim);
-                        uint baseFrameIndex = startDeltaFrame; // base frame index in global processedFrames
-                        float chunkMaxError = 0f;
-                        int chunkMaxErrorVertexIndex = -1;
-                        UnityEngine.Vector3 chunkMaxExpected = UnityEngine.Vector3.zero;
-                        UnityEngine.Vector3 chunkMaxActual = UnityEngine.Vector3.zero;
-                        // Check only the first frame (decompressing all frames can block the editor on large animations)
-                        uint maxValidateFrames = (enableHeavyValidation? validationAnim.num_frames : 1u);
-                        for (uint local = 0; local < maxValidateFrames && local < validationAnim.num_frames; ++local)
-                        {
-                            Core.DecompressToFrame(ctxChunk, validationAnim, local);
-                            // Compare each vertex
-                            int compareFrameIndex = (int)(baseFrameIndex + local);
-                            if (compareFrameIndex >= processedFrames.Count) break; // outside of provided frames
-                            var expectedFrame = processedFrames[compareFrameIndex];
-                            for (int v = 0; v < validationAnim.num_vertices; ++v)
-                            {
-                                var q = ctxChunk.current_positions[v];
-                                float x = validationAnim.min_x + (q.x / 255f) * (validationAnim.max_x - validationAnim.min_x);
-                                float y = validationAnim.min_y + (q.y / 255f) * (validationAnim.max_y - validationAnim.min_y);
-                                float z = validationAnim.min_z + (q.z / 255f) * (validationAnim.max_z - validationAnim.min_z);
-                                var epos = expectedFrame[v];
-                                float err = UnityEngine.Vector3.Distance(new UnityEngine.Vector3(x, y, z), epos);
-                                if (err > chunkMaxError) {
-                                    chunkMaxError = err;
-                                    chunkMaxErrorVertexIndex = v;
-                                    chunkMaxExpected = epos;
-                                    chunkMaxActual = new UnityEngine.Vector3(x, y, z);
-                                }
-                            }
-                        }
-                        // Compute a dynamic validation tolerance based on the quantization step size
-                        float stepX = (validationAnim.max_x - validationAnim.min_x) / 255f;
-                        float stepY = (validationAnim.max_y - validationAnim.min_y) / 255f;
-                        float stepZ = (validationAnim.max_z - validationAnim.min_z) / 255f;
-                        // Worst-case Euclidean error for a single-axis rounding is sqrt((step/2)^2*3).
-                        float quantizationTolerance = UnityEngine.Mathf.Sqrt((stepX * 0.5f) * (stepX * 0.5f) + (stepY * 0.5f) * (stepY * 0.5f) + (stepZ * 0.5f) * (stepZ * 0.5f));
-                        // Add a small safety margin and a conservative minimum tolerance
-                        float validationTolerance = UnityEngine.Mathf.Max(quantizationTolerance * 1.2f, 0.01f);
-                        UnityEngine.Debug.Log($"RAT Validation: tolerance={validationTolerance:F6} (stepX={stepX:F6} stepY={stepY:F6} stepZ={stepZ:F6})");
-                        if (chunkMaxError > validationTolerance)
-                        {
-                            UnityEngine.Debug.LogError($"RAT Validation FAILED for chunk {chunkIndex + 1}: max error {chunkMaxError:F6} exceeds tolerance {validationTolerance:F6}. startDeltaFrame={startDeltaFrame}, chunkFrames={chunkDeltaFrames}");
-                            if (chunkMaxErrorVertexIndex >= 0)
-                            {
-                                UnityEngine.Debug.LogError($"Validation fail: vertexIndex={chunkMaxErrorVertexIndex}, expected={chunkMaxExpected}, actual={chunkMaxActual}, diff={(chunkMaxActual - chunkMaxExpected)}");
-                            }
-                            try
-                            {
-                                if (validationAnim.first_frame != null && validationAnim.first_frame.Length > 0)
-                                {
-                                    var qf = validationAnim.first_frame[0];
-                                    var globalF = (anim.quantized_frames != null && anim.quantized_frames.Length > startDeltaFrame) ? anim.quantized_frames[startDeltaFrame][0] : validationAnim.first_frame[0];
-                                    UnityEngine.Debug.LogError($"Chunk seed sample: chunk.first_frame[0] = ({qf.x},{qf.y},{qf.z}), global.first_frame_at_start = ({globalF.x},{globalF.y},{globalF.z})");
-                                }
-                            }
-                            catch (System.Exception ex)
-                            {
-                                UnityEngine.Debug.LogWarning($"Validation debug: failed to print first_frame sample: {ex.Message}");
-                            }
-                        }
-                        else
-                        {
-                            UnityEngine.Debug.Log($"RAT Validation OK for chunk {chunkIndex + 1}: max error {chunkMaxError:F6} (tolerance {validationTolerance:F6}). startDeltaFrame={startDeltaFrame}, chunkFrames={chunkDeltaFrames}");
-                        }
-                    }
-                    catch (System.Exception e)
-                    {
-                        UnityEngine.Debug.LogWarning($"ExportValidation: Failed to validate chunk {chunkIndex + 1}: {e.Message}");
-                    }
+                    LogChunkValidation(results[ci], ci, allSpecs[ci]);
                 }
-                // Advance the start index for the next chunk
-                nextStartDfIndex += chunkDeltaFrames;
             }
-            
+
             return createdFiles;
         }
-        
+
         /// <summary>
         /// Validates that a mesh is compatible with the RAT format constraints.
         /// </summary>
@@ -1208,43 +1619,18 @@ namespace Rat
 
             // 1. Calculate animation bounds from ALL frames (including transforms)
             // These bounds will be stored in the RAT header and used for dequantization
-            UnityEngine.Vector3 minBounds = rawFrames[0][0];
-            UnityEngine.Vector3 maxBounds = rawFrames[0][0];
-            
-            foreach (var frame in rawFrames)
-            {
-                foreach (var v in frame)
-                {
-                    if (v.x < minBounds.x) minBounds.x = v.x;
-                    if (v.y < minBounds.y) minBounds.y = v.y;
-                    if (v.z < minBounds.z) minBounds.z = v.z;
-                    if (v.x > maxBounds.x) maxBounds.x = v.x;
-                    if (v.y > maxBounds.y) maxBounds.y = v.y;
-                    if (v.z > maxBounds.z) maxBounds.z = v.z;
-                }
-            }
+            ComputeFrameBounds(rawFrames, out UnityEngine.Vector3 minBounds, out UnityEngine.Vector3 maxBounds);
             
             UnityEngine.Debug.Log($"Compression bounds (from transformed frames): Min({minBounds.x:F3}, {minBounds.y:F3}, {minBounds.z:F3}) Max({maxBounds.x:F3}, {maxBounds.y:F3}, {maxBounds.z:F3})");
 
             // 2. Quantize ALL frames to 8-bit using the calculated bounds
             // This maps the bounding box to 0-255 for each axis independently
-            var quantizedFrames = new VertexU8[numFrames][];
             var range = maxBounds - minBounds;
             if (range.x == 0) range.x = 1;
             if (range.y == 0) range.y = 1;
             if (range.z == 0) range.z = 1;
 
-            for (int f = 0; f < numFrames; f++)
-            {
-                quantizedFrames[f] = new VertexU8[numVertices];
-                for (int v = 0; v < numVertices; v++)
-                {
-                    // Map vertex from world space into 0-255 quantized space using bounds
-                    quantizedFrames[f][v].x = (byte)UnityEngine.Mathf.RoundToInt(255 * ((rawFrames[f][v].x - minBounds.x) / range.x));
-                    quantizedFrames[f][v].y = (byte)UnityEngine.Mathf.RoundToInt(255 * ((rawFrames[f][v].y - minBounds.y) / range.y));
-                    quantizedFrames[f][v].z = (byte)UnityEngine.Mathf.RoundToInt(255 * ((rawFrames[f][v].z - minBounds.z) / range.z));
-                }
-            }
+            var quantizedFrames = QuantizeFrames(rawFrames, numVertices, minBounds, range, clampToBounds: false);
 
             // 3. Handle UVs, Colors, and Indices from source mesh
             var uvs = new VertexUV[numVertices];
@@ -1302,54 +1688,15 @@ namespace Rat
             // Keep quantized frames around for writer chunking and validation
             anim.quantized_frames = quantizedFrames;
 
-            // Keep quantized frames around for writer chunking and validation
-            anim.quantized_frames = quantizedFrames;
-
             if (preserveFirstFrame)
             {
                 anim.first_frame_raw = new UnityEngine.Vector3[numVertices];
                 Array.Copy(rawFrames[0], anim.first_frame_raw, (int)numVertices);
             }
 
-            if (numFrames > 1)
-            {
-                for (int v = 0; v < numVertices; v++)
-                {
-                    int maxDx = 0, maxDy = 0, maxDz = 0;
-                    for (int f = 1; f < numFrames; f++)
-                    {
-                        int dx = quantizedFrames[f][v].x - quantizedFrames[f - 1][v].x;
-                        if (Math.Abs(dx) > maxDx) maxDx = Math.Abs(dx);
-                        int dy = quantizedFrames[f][v].y - quantizedFrames[f - 1][v].y;
-                        if (Math.Abs(dy) > maxDy) maxDy = Math.Abs(dy);
-                        int dz = quantizedFrames[f][v].z - quantizedFrames[f - 1][v].z;
-                        if (Math.Abs(dz) > maxDz) maxDz = Math.Abs(dz);
-                    }
-                    anim.bit_widths_x[v] = BitsForDelta(maxDx);
-                    anim.bit_widths_y[v] = BitsForDelta(maxDy);
-                    anim.bit_widths_z[v] = BitsForDelta(maxDz);
-                }
-
-                var writer = new BitstreamWriter();
-                for (uint f = 1; f < numFrames; f++)
-                {
-                    for (uint v = 0; v < numVertices; v++)
-                    {
-                        int dx = quantizedFrames[f][v].x - quantizedFrames[f - 1][v].x;
-                        writer.Write((uint)dx, anim.bit_widths_x[v]);
-                        int dy = quantizedFrames[f][v].y - quantizedFrames[f - 1][v].y;
-                        writer.Write((uint)dy, anim.bit_widths_y[v]);
-                        int dz = quantizedFrames[f][v].z - quantizedFrames[f - 1][v].z;
-                        writer.Write((uint)dz, anim.bit_widths_z[v]);
-                    }
-                }
-                writer.Flush();
-                anim.delta_stream = writer.ToArray();
-            }
-            else
-            {
-                anim.delta_stream = Array.Empty<uint>();
-            }
+            // 4./5. Bit widths and delta packing (both return early for single-frame clips)
+            SelectBitWidths(quantizedFrames, numVertices, anim.bit_widths_x, anim.bit_widths_y, anim.bit_widths_z);
+            anim.delta_stream = PackDeltaStream(quantizedFrames, numVertices, anim.bit_widths_x, anim.bit_widths_y, anim.bit_widths_z);
             
             UnityEngine.Debug.Log($"Final RAT bounds: Min({anim.min_x:F3}, {anim.min_y:F3}, {anim.min_z:F3}) Max({anim.max_x:F3}, {anim.max_y:F3}, {anim.max_z:F3})");
             UnityEngine.Debug.Log($"Quantization range: X({range.x:F3}) Y({range.y:F3}) Z({range.z:F3})");
@@ -1383,23 +1730,12 @@ namespace Rat
             UnityEngine.Debug.Log($"Compression using explicit bounds: Min({minBounds.x:F3}, {minBounds.y:F3}, {minBounds.z:F3}) Max({maxBounds.x:F3}, {maxBounds.y:F3}, {maxBounds.z:F3})");
 
             // Quantize ALL frames to 8-bit using the provided bounds
-            var quantizedFrames = new VertexU8[numFrames][];
             var range = maxBounds - minBounds;
             if (range.x == 0) range.x = 1;
             if (range.y == 0) range.y = 1;
             if (range.z == 0) range.z = 1;
 
-            for (int f = 0; f < numFrames; f++)
-            {
-                quantizedFrames[f] = new VertexU8[numVertices];
-                for (int v = 0; v < numVertices; v++)
-                {
-                    // Map vertex from world space into 0-255 quantized space using bounds
-                    quantizedFrames[f][v].x = (byte)UnityEngine.Mathf.RoundToInt(255 * UnityEngine.Mathf.Clamp01((rawFrames[f][v].x - minBounds.x) / range.x));
-                    quantizedFrames[f][v].y = (byte)UnityEngine.Mathf.RoundToInt(255 * UnityEngine.Mathf.Clamp01((rawFrames[f][v].y - minBounds.y) / range.y));
-                    quantizedFrames[f][v].z = (byte)UnityEngine.Mathf.RoundToInt(255 * UnityEngine.Mathf.Clamp01((rawFrames[f][v].z - minBounds.z) / range.z));
-                }
-            }
+            var quantizedFrames = QuantizeFrames(rawFrames, numVertices, minBounds, range, clampToBounds: true);
 
             // Handle UVs, Colors, and Indices
             var uvs = new VertexUV[numVertices];
@@ -1474,29 +1810,8 @@ namespace Rat
             var bitWidthsY = new byte[numVertices];
             var bitWidthsZ = new byte[numVertices];
 
-            for (int v = 0; v < numVertices; v++)
-            {
-                byte calculatedBitsX = 0, calculatedBitsY = 0, calculatedBitsZ = 0;
-                for (int f = 1; f < numFrames; f++)
-                {
-                    int dx = quantizedFrames[f][v].x - quantizedFrames[f - 1][v].x;
-                    int dy = quantizedFrames[f][v].y - quantizedFrames[f - 1][v].y;
-                    int dz = quantizedFrames[f][v].z - quantizedFrames[f - 1][v].z;
-
-                    byte bitsX = BitsForDelta(dx);
-                    byte bitsY = BitsForDelta(dy);
-                    byte bitsZ = BitsForDelta(dz);
-
-                    if (bitsX > calculatedBitsX) calculatedBitsX = bitsX;
-                    if (bitsY > calculatedBitsY) calculatedBitsY = bitsY;
-                    if (bitsZ > calculatedBitsZ) calculatedBitsZ = bitsZ;
-                }
-                
-                // No max bits constraints in this overload - use calculated values directly
-                bitWidthsX[v] = calculatedBitsX;
-                bitWidthsY[v] = calculatedBitsY;
-                bitWidthsZ[v] = calculatedBitsZ;
-            }
+            // No max bits constraints applied - use calculated values directly
+            SelectBitWidths(quantizedFrames, numVertices, bitWidthsX, bitWidthsY, bitWidthsZ);
 
             // Create compressed animation
             var anim = new CompressedAnimation
@@ -1526,33 +1841,7 @@ namespace Rat
                 anim.first_frame_raw = rawFrames[0];
             }
 
-            if (numFrames > 1)
-            {
-                var bitstream = new BitstreamWriter();
-                for (int f = 1; f < numFrames; f++)
-                {
-                    for (int v = 0; v < numVertices; v++)
-                    {
-                        int dx = quantizedFrames[f][v].x - quantizedFrames[f - 1][v].x;
-                        int dy = quantizedFrames[f][v].y - quantizedFrames[f - 1][v].y;
-                        int dz = quantizedFrames[f][v].z - quantizedFrames[f - 1][v].z;
-
-                        uint ux = (uint)dx;
-                        uint uy = (uint)dy;
-                        uint uz = (uint)dz;
-
-                        bitstream.Write(ux, bitWidthsX[v]);
-                        bitstream.Write(uy, bitWidthsY[v]);
-                        bitstream.Write(uz, bitWidthsZ[v]);
-                    }
-                }
-                bitstream.Flush();
-                anim.delta_stream = bitstream.ToArray();
-            }
-            else
-            {
-                anim.delta_stream = Array.Empty<uint>();
-            }
+            anim.delta_stream = PackDeltaStream(quantizedFrames, numVertices, bitWidthsX, bitWidthsY, bitWidthsZ);
             
             UnityEngine.Debug.Log($"Compressed with explicit bounds: range X({range.x:F3}) Y({range.y:F3}) Z({range.z:F3})");
             
@@ -1591,42 +1880,18 @@ namespace Rat
             var sourceIndices = sourceMesh.triangles;
 
             // 1. Find animation bounds - Manual calculation to avoid Unity Bounds quirks
-            UnityEngine.Vector3 minBounds = rawFrames[0][0];
-            UnityEngine.Vector3 maxBounds = rawFrames[0][0];
-            
-            foreach (var frame in rawFrames)
-            {
-                foreach (var v in frame)
-                {
-                    if (v.x < minBounds.x) minBounds.x = v.x;
-                    if (v.y < minBounds.y) minBounds.y = v.y;
-                    if (v.z < minBounds.z) minBounds.z = v.z;
-                    if (v.x > maxBounds.x) maxBounds.x = v.x;
-                    if (v.y > maxBounds.y) maxBounds.y = v.y;
-                    if (v.z > maxBounds.z) maxBounds.z = v.z;
-                }
-            }
+            ComputeFrameBounds(rawFrames, out UnityEngine.Vector3 minBounds, out UnityEngine.Vector3 maxBounds);
             
             // Debug: Log the calculated bounds
             UnityEngine.Debug.Log($"Compression bounds: Min({minBounds.x:F3}, {minBounds.y:F3}, {minBounds.z:F3}) Max({maxBounds.x:F3}, {maxBounds.y:F3}, {maxBounds.z:F3})");
 
             // 2. Quantize frames to 8-bit
-            var quantizedFrames = new VertexU8[numFrames][];
             var range = maxBounds - minBounds;
             if (range.x == 0) range.x = 1;
             if (range.y == 0) range.y = 1;
             if (range.z == 0) range.z = 1;
 
-            for (int f = 0; f < numFrames; f++)
-            {
-                quantizedFrames[f] = new VertexU8[numVertices];
-                for (int v = 0; v < numVertices; v++)
-                {
-                    quantizedFrames[f][v].x = (byte)UnityEngine.Mathf.RoundToInt(255 * ((rawFrames[f][v].x - minBounds.x) / range.x));
-                    quantizedFrames[f][v].y = (byte)UnityEngine.Mathf.RoundToInt(255 * ((rawFrames[f][v].y - minBounds.y) / range.y));
-                    quantizedFrames[f][v].z = (byte)UnityEngine.Mathf.RoundToInt(255 * ((rawFrames[f][v].z - minBounds.z) / range.z));
-                }
-            }
+            var quantizedFrames = QuantizeFrames(rawFrames, numVertices, minBounds, range, clampToBounds: false);
 
             // 3. Handle UVs, Colors, and Indices from source mesh
             var uvs = new VertexUV[numVertices];
@@ -1701,29 +1966,8 @@ namespace Rat
             var bitWidthsY = new byte[numVertices];
             var bitWidthsZ = new byte[numVertices];
 
-            for (int v = 0; v < numVertices; v++)
-            {
-                byte calculatedBitsX = 0, calculatedBitsY = 0, calculatedBitsZ = 0;
-                for (int f = 1; f < numFrames; f++)
-                {
-                    int dx = quantizedFrames[f][v].x - quantizedFrames[f - 1][v].x;
-                    int dy = quantizedFrames[f][v].y - quantizedFrames[f - 1][v].y;
-                    int dz = quantizedFrames[f][v].z - quantizedFrames[f - 1][v].z;
-
-                    byte bitsX = BitsForDelta(dx);
-                    byte bitsY = BitsForDelta(dy);
-                    byte bitsZ = BitsForDelta(dz);
-
-                    if (bitsX > calculatedBitsX) calculatedBitsX = bitsX;
-                    if (bitsY > calculatedBitsY) calculatedBitsY = bitsY;
-                    if (bitsZ > calculatedBitsZ) calculatedBitsZ = bitsZ;
-                }
-                
-                // No max bits constraints in this overload - use calculated values directly
-                bitWidthsX[v] = calculatedBitsX;
-                bitWidthsY[v] = calculatedBitsY;
-                bitWidthsZ[v] = calculatedBitsZ;
-            }
+            // No max bits constraints applied - use calculated values directly
+            SelectBitWidths(quantizedFrames, numVertices, bitWidthsX, bitWidthsY, bitWidthsZ);
 
             // Create compressed animation
             var anim = new CompressedAnimation
@@ -1753,37 +1997,241 @@ namespace Rat
                 anim.first_frame_raw = rawFrames[0];
             }
 
-            if (numFrames > 1)
+            anim.delta_stream = PackDeltaStream(quantizedFrames, numVertices, bitWidthsX, bitWidthsY, bitWidthsZ);
+            
+            UnityEngine.Debug.Log($"Final stored bounds: Min({anim.min_x:F3}, {anim.min_y:F3}, {anim.min_z:F3}) Max({anim.max_x:F3}, {anim.max_y:F3}, {anim.max_z:F3})");
+            
+            return anim;
+        }
+
+        /// <summary>
+        /// Compress with locally adaptive quantization bounds (RAT4). The clip is cut into segments of
+        /// <paramref name="segmentFrames"/> frames that overlap by one frame, the same way chunks do. In each segment the
+        /// vertices are grouped into at most <paramref name="clusterCount"/> clusters with similar motion boxes, and each
+        /// cluster is quantized against its own box. Small clusters get a finer 8-bit step, and their deltas stay
+        /// smaller, so bit widths shrink.
+        /// Every segment is re-quantized from the raw frames, so error does not carry across segment boundaries.
+        /// Write the result with <see cref="WriteRatSegmentsWithSizeSplitting"/>.
+        /// </summary>
+        public static List<CompressedAnimation> CompressFromFramesAdaptive(
+            List<UnityEngine.Vector3[]> rawFrames,
+            UnityEngine.Mesh sourceMesh,
+            UnityEngine.Vector2[] staticUVs,
+            UnityEngine.Color[] staticColors,
+            int clusterCount = 16,
+            int segmentFrames = 120)
+        {
+            if (rawFrames == null || rawFrames.Count == 0) return null;
+            if (!ValidateMeshForRAT(sourceMesh)) return null;
+
+            uint numVertices = (uint)sourceMesh.vertexCount;
+            uint numIndices = (uint)sourceMesh.triangles.Length;
+            clusterCount = Math.Max(1, Math.Min(Math.Min(clusterCount, 256), (int)numVertices));
+            segmentFrames = Math.Max(1, segmentFrames);
+
+            // Mesh attributes are shared by every segment
+            var sourceIndices = sourceMesh.triangles;
+            var sourceUVs = (staticUVs != null && staticUVs.Length == numVertices) ? staticUVs : sourceMesh.uv;
+            var sourceColors = (staticColors != null && staticColors.Length == numVertices) ? staticColors : sourceMesh.colors;
+            var uvs = new VertexUV[numVertices];
+            var colors = new VertexColor[numVertices];
+            for (int i = 0; i < numVertices; i++)
+            {
+                if (i < sourceUVs.Length) uvs[i] = new VertexUV { u = sourceUVs[i].x, v = sourceUVs[i].y };
+                colors[i] = (i < sourceColors.Length)
+                    ? new VertexColor { r = sourceColors[i].r, g = sourceColors[i].g, b = sourceColors[i].b, a = sourceColors[i].a }
+                    : new VertexColor { r = 1, g = 1, b = 1, a = 1 };
+            }
+            var indices = new ushort[numIndices];
+            for (int i = 0; i < numIndices; i++) indices[i] = (ushort)sourceIndices[i];
+
+            ComputeFrameBounds(rawFrames, out UnityEngine.Vector3 globalMin, out UnityEngine.Vector3 globalMax);
+            var globalStep = (globalMax - globalMin) / 255f;
+
+            var segments = new List<CompressedAnimation>();
+            int lastFrame = rawFrames.Count - 1;
+            int segStart = 0;
+            do
+            {
+                int segEnd = Math.Min(segStart + segmentFrames, lastFrame);
+                int segCount = segEnd - segStart + 1;
+
+                ClusterVertexBoxes(rawFrames, segStart, segCount, (int)numVertices, clusterCount, out byte[] clusterIds, out float[] clusterBounds);
+                var quantizedFrames = QuantizeFramesClustered(rawFrames, segStart, segCount, numVertices, clusterIds, clusterBounds);
+
+                var anim = new CompressedAnimation
+                {
+                    num_vertices = numVertices,
+                    num_frames = (uint)segCount,
+                    num_indices = numIndices,
+                    uvs = uvs,
+                    colors = colors,
+                    indices = indices,
+                    first_frame = quantizedFrames[0],
+                    quantized_frames = quantizedFrames,
+                    bit_widths_x = new byte[numVertices],
+                    bit_widths_y = new byte[numVertices],
+                    bit_widths_z = new byte[numVertices],
+                    cluster_ids = clusterIds,
+                    cluster_bounds = clusterBounds
+                };
+
+                // Header box is the union of the cluster boxes so RAT3-style tools still see the full extent
+                anim.min_x = anim.min_y = anim.min_z = float.MaxValue;
+                anim.max_x = anim.max_y = anim.max_z = float.MinValue;
+                var meanStep = UnityEngine.Vector3.zero;
+                int clusters = clusterBounds.Length / 6;
+                for (int b = 0; b < clusterBounds.Length; b += 6)
+                {
+                    anim.min_x = Math.Min(anim.min_x, clusterBounds[b + 0]); anim.max_x = Math.Max(anim.max_x, clusterBounds[b + 3]);
+                    anim.min_y = Math.Min(anim.min_y, clusterBounds[b + 1]); anim.max_y = Math.Max(anim.max_y, clusterBounds[b + 4]);
+                    anim.min_z = Math.Min(anim.min_z, clusterBounds[b + 2]); anim.max_z = Math.Max(anim.max_z, clusterBounds[b + 5]);
+                    meanStep += new UnityEngine.Vector3(clusterBounds[b + 3] - clusterBounds[b + 0], clusterBounds[b + 4] - clusterBounds[b + 1], clusterBounds[b + 5] - clusterBounds[b + 2]) / (255f * clusters);
+                }
+
+                SelectBitWidths(quantizedFrames, numVertices, anim.bit_widths_x, anim.bit_widths_y, anim.bit_widths_z);
+                anim.delta_stream = PackDeltaStream(quantizedFrames, numVertices, anim.bit_widths_x, anim.bit_widths_y, anim.bit_widths_z);
+                segments.Add(anim);
+
+                UnityEngine.Debug.Log($"Adaptive segment {segments.Count}: frames {segStart}-{segEnd}, {clusters} clusters, mean step ({meanStep.x:F4}, {meanStep.y:F4}, {meanStep.z:F4}) vs global ({globalStep.x:F4}, {globalStep.y:F4}, {globalStep.z:F4}), {Core.BitsPerDeltaFrame(anim)} bits/frame");
+                segStart = segEnd;
+            } while (segStart < lastFrame);
+
+            return segments;
+        }
+
+        /// <summary>
+        /// Groups vertices by their motion box over a frame range with k-means on the 6D (min, max) corners, using
+        /// deterministic farthest-point seeding. Returns per-vertex cluster ids and the union box of each cluster.
+        /// Clusters that end up empty are dropped.
+        /// </summary>
+        private static void ClusterVertexBoxes(List<UnityEngine.Vector3[]> frames, int start, int count, int numVertices, int clusterCount, out byte[] clusterIds, out float[] clusterBounds)
+        {
+            // Per-vertex motion box as a 6D feature
+            var boxes = new float[numVertices * 6];
+            int vertexBlocks = BlockCount(numVertices, 256);
+            RunParallel(vertexBlocks, blk =>
             {
-                var bitstream = new BitstreamWriter();
-                for (int f = 1; f < numFrames; f++)
+                BlockRange(blk, vertexBlocks, numVertices, out int vs, out int ve);
+                for (int v = vs; v < ve; v++)
                 {
-                    for (int v = 0; v < numVertices; v++)
+                    var mn = frames[start][v];
+                    var mx = mn;
+                    for (int f = start + 1; f < start + count; f++)
                     {
-                        int dx = quantizedFrames[f][v].x - quantizedFrames[f - 1][v].x;
-                        int dy = quantizedFrames[f][v].y - quantizedFrames[f - 1][v].y;
-                        int dz = quantizedFrames[f][v].z - quantizedFrames[f - 1][v].z;
+                        mn = UnityEngine.Vector3.Min(mn, frames[f][v]);
+                        mx = UnityEngine.Vector3.Max(mx, frames[f][v]);
+                    }
+                    boxes[v * 6 + 0] = mn.x; boxes[v * 6 + 1] = mn.y; boxes[v * 6 + 2] = mn.z;
+                    boxes[v * 6 + 3] = mx.x; boxes[v * 6 + 4] = mx.y; boxes[v * 6 + 5] = mx.z;
+                }
+            });
+
+            float Distance2(float[] a, int ai, float[] b, int bi)
+            {
+                float d = 0;
+                for (int k = 0; k < 6; k++) { float t = a[ai + k] - b[bi + k]; d += t * t; }
+                return d;
+            }
 
-                        uint ux = (uint)dx;
-                        uint uy = (uint)dy;
-                        uint uz = (uint)dz;
+            // Farthest-point seeding from vertex 0
+            var centers = new float[clusterCount * 6];
+            var nearest = new float[numVertices];
+            Array.Copy(boxes, 0, centers, 0, 6);
+            for (int v = 0; v < numVertices; v++) nearest[v] = Distance2(boxes, v * 6, centers, 0);
+            int seeded = 1;
+            for (; seeded < clusterCount; seeded++)
+            {
+                int far = 0;
+                for (int v = 1; v < numVertices; v++) if (nearest[v] > nearest[far]) far = v;
+                if (nearest[far] <= 0) break; // fewer distinct boxes than clusters
+                Array.Copy(boxes, far * 6, centers, seeded * 6, 6);
+                for (int v = 0; v < numVertices; v++) nearest[v] = Math.Min(nearest[v], Distance2(boxes, v * 6, centers, seeded * 6));
+            }
+            clusterCount = seeded;
 
-                        bitstream.Write(ux, bitWidthsX[v]);
-                        bitstream.Write(uy, bitWidthsY[v]);
-                        bitstream.Write(uz, bitWidthsZ[v]);
+            var assignment = new int[numVertices];
+            const int iterations = 10;
+            for (int it = 0; it < iterations; it++)
+            {
+                RunParallel(vertexBlocks, blk =>
+                {
+                    BlockRange(blk, vertexBlocks, numVertices, out int vs, out int ve);
+                    for (int v = vs; v < ve; v++)
+                    {
+                        int best = 0;
+                        float bestD = float.MaxValue;
+                        for (int c = 0; c < clusterCount; c++)
+                        {
+                            float d = Distance2(boxes, v * 6, centers, c * 6);
+                            if (d < bestD) { bestD = d; best = c; }
+                        }
+                        assignment[v] = best;
                     }
+                });
+
+                var sums = new double[clusterCount * 6];
+                var counts = new int[clusterCount];
+                for (int v = 0; v < numVertices; v++)
+                {
+                    int c = assignment[v];
+                    counts[c]++;
+                    for (int k = 0; k < 6; k++) sums[c * 6 + k] += boxes[v * 6 + k];
+                }
+                for (int c = 0; c < clusterCount; c++)
+                {
+                    if (counts[c] == 0) continue;
+                    for (int k = 0; k < 6; k++) centers[c * 6 + k] = (float)(sums[c * 6 + k] / counts[c]);
                 }
-                bitstream.Flush();
-                anim.delta_stream = bitstream.ToArray();
             }
-            else
+
+            // Compact to the non-empty clusters and take the union of the member boxes
+            var remap = new int[clusterCount];
+            for (int c = 0; c < clusterCount; c++) remap[c] = -1;
+            var bounds = new List<float>();
+            clusterIds = new byte[numVertices];
+            for (int v = 0; v < numVertices; v++)
             {
-                anim.delta_stream = Array.Empty<uint>();
+                int c = assignment[v];
+                if (remap[c] < 0)
+                {
+                    remap[c] = bounds.Count / 6;
+                    for (int k = 0; k < 6; k++) bounds.Add(boxes[v * 6 + k]);
+                }
+                int b = remap[c] * 6;
+                for (int k = 0; k < 3; k++) bounds[b + k] = Math.Min(bounds[b + k], boxes[v * 6 + k]);
+                for (int k = 3; k < 6; k++) bounds[b + k] = Math.Max(bounds[b + k], boxes[v * 6 + k]);
+                clusterIds[v] = (byte)remap[c];
             }
-            
-            UnityEngine.Debug.Log($"Final stored bounds: Min({anim.min_x:F3}, {anim.min_y:F3}, {anim.min_z:F3}) Max({anim.max_x:F3}, {anim.max_y:F3}, {anim.max_z:F3})");
-            
-            return anim;
+            clusterBounds = bounds.ToArray();
+        }
+
+        /// <summary>
+        /// Quantizes a frame range against each vertex's cluster box. Frames are independent and run in parallel.
+        /// </summary>
+        private static VertexU8[][] QuantizeFramesClustered(List<UnityEngine.Vector3[]> rawFrames, int start, int count, uint numVertices, byte[] clusterIds, float[] clusterBounds)
+        {
+            var quantizedFrames = new VertexU8[count][];
+            RunParallel(count, f =>
+            {
+                var src = rawFrames[start + f];
+                var dst = new VertexU8[numVertices];
+                for (int v = 0; v < numVertices; v++)
+                {
+                    int b = clusterIds[v] * 6;
+                    float rx = clusterBounds[b + 3] - clusterBounds[b + 0];
+                    float ry = clusterBounds[b + 4] - clusterBounds[b + 1];
+                    float rz = clusterBounds[b + 5] - clusterBounds[b + 2];
+                    if (rx == 0) rx = 1;
+                    if (ry == 0) ry = 1;
+                    if (rz == 0) rz = 1;
+                    dst[v].x = (byte)UnityEngine.Mathf.RoundToInt(255 * UnityEngine.Mathf.Clamp01((src[v].x - clusterBounds[b + 0]) / rx));
+                    dst[v].y = (byte)UnityEngine.Mathf.RoundToInt(255 * UnityEngine.Mathf.Clamp01((src[v].y - clusterBounds[b + 1]) / ry));
+                    dst[v].z = (byte)UnityEngine.Mathf.RoundToInt(255 * UnityEngine.Mathf.Clamp01((src[v].z - clusterBounds[b + 2]) / rz));
+                }
+                quantizedFrames[f] = dst;
+            });
+            return quantizedFrames;
         }
 
         /// <summary>
@@ -1794,6 +2242,8 @@ namespace Rat
     /// - Compression uses computed bounds and 8-bit quantization per axis
     /// - RAT files contain bounds, quantized vertices, and delta streams
     /// - ACT files contain mesh data and RAT references (no per-frame transforms)
+    /// - adaptiveClusters > 0 switches to per-cluster, per-segment bounds (RAT4, see CompressFromFramesAdaptive); always written synchronously
+    /// - optimizeVertexOrder renumbers vertices in cache-optimized first-use order (frames, UVs, colors and indices together)
         /// </summary>
         public static void ExportAnimation(
             string baseFilename,
@@ -1809,7 +2259,10 @@ namespace Rat
             bool flipZ = true,
             bool skipValidation = false,
             bool yieldPerChunk = false,
-            System.Action<List<string>> onComplete = null)
+            System.Action<List<string>> onComplete = null,
+            int adaptiveClusters = 0,
+            int adaptiveSegmentFrames = 120,
+            bool optimizeVertexOrder = false)
         {
             if (vertexFrames == null || vertexFrames.Count == 0)
             {
@@ -1826,29 +2279,8 @@ namespace Rat
             if (customTransforms != null && customTransforms.Count == vertexFrames.Count)
             {
                 UnityEngine.Debug.Log($"ExportAnimation: Baking {customTransforms.Count} transform frames into vertex animation...");
-                processedFrames = new List<UnityEngine.Vector3[]>();
-                
-                for (int frameIndex = 0; frameIndex < vertexFrames.Count; frameIndex++)
-                {
-                    var transformData = customTransforms[frameIndex];
-                    
-                    // Build transform matrix: position, rotation, scale
-                    UnityEngine.Matrix4x4 transformMatrix = UnityEngine.Matrix4x4.TRS(
-                        transformData.position,
-                        UnityEngine.Quaternion.Euler(transformData.rotation),
-                        transformData.scale
-                    );
-                    
-                    // Apply to all vertices in this frame
-                    var transformedVertices = new UnityEngine.Vector3[vertexFrames[frameIndex].Length];
-                    for (int vertexIndex = 0; vertexIndex < vertexFrames[frameIndex].Length; vertexIndex++)
-                    {
-                        var v = transformMatrix.MultiplyPoint3x4(vertexFrames[frameIndex][vertexIndex]);
-                        transformedVertices[vertexIndex] = v;
-                    }
-                    
-                    processedFrames.Add(transformedVertices);
-                }
+                // Build transform matrices (position, rotation, scale) and apply them to all vertices of each frame
+                processedFrames = BakeFrameMatrices(vertexFrames, BuildTransformMatrices(customTransforms));
                 UnityEngine.Debug.Log($"ExportAnimation: Transform baking complete - vertices now in world space{(flipZ ? " (Z-flipped)" : "")}");
             }
             else if (customTransforms == null)
@@ -1886,19 +2318,41 @@ namespace Rat
             // If we requested a Z-flip but frames are already in world space (no transforms), flip vertex coordinates here
             if (flipZ)
             {
-                for (int f = 0; f < processedFrames.Count; f++)
-                {
-                    var frame = processedFrames[f];
-                    for (int i = 0; i < frame.Length; i++)
-                    {
-                        var p = frame[i];
-                        p.z = -p.z;
-                        frame[i] = p;
-                    }
-                }
+                FlipFramesZ(processedFrames);
+            }
+
+            if (optimizeVertexOrder && meshToUse != null)
+            {
+                // Vertices fetched together end up adjacent in the RAT stream, which also keeps neighbouring deltas similar
+                int vertexCount = meshToUse.vertexCount;
+                float acmrBefore = VertexCacheOptimizer.ComputeACMR(meshToUse.triangles);
+                var optimizedTris = VertexCacheOptimizer.OptimizeTriangleOrder(meshToUse.triangles, vertexCount);
+                var newToOld = VertexCacheOptimizer.BuildFirstUseVertexOrder(optimizedTris, vertexCount, out int[] oldToNew);
+                processedFrames = processedFrames.ConvertAll(frame => VertexCacheOptimizer.PermuteVertices(frame, newToOld));
+                capturedUVs = VertexCacheOptimizer.PermuteVertices(capturedUVs, newToOld);
+                capturedColors = VertexCacheOptimizer.PermuteVertices(capturedColors, newToOld);
+
+                var reorderedMesh = new UnityEngine.Mesh();
+                reorderedMesh.vertices = VertexCacheOptimizer.PermuteVertices(meshToUse.vertices, newToOld);
+                reorderedMesh.uv = VertexCacheOptimizer.PermuteVertices(meshToUse.uv, newToOld);
+                reorderedMesh.colors = VertexCacheOptimizer.PermuteVertices(meshToUse.colors, newToOld);
+                reorderedMesh.triangles = VertexCacheOptimizer.RemapIndices(optimizedTris, oldToNew);
+                reorderedMesh.RecalculateBounds();
+                meshToUse = reorderedMesh;
+                UnityEngine.Debug.Log($"ExportAnimation: vertex cache ACMR {acmrBefore:F3} -> {VertexCacheOptimizer.ComputeACMR(meshToUse.triangles):F3}, vertices renumbered in first-use order");
             }
 
-            var compressed = CompressFromFrames(processedFrames, meshToUse, capturedUVs, capturedColors);
+            List<CompressedAnimation> segments = null;
+            CompressedAnimation compressed;
+            if (adaptiveClusters > 0)
+            {
+                segments = CompressFromFramesAdaptive(processedFrames, meshToUse, capturedUVs, capturedColors, adaptiveClusters, adaptiveSegmentFrames);
+                compressed = segments?[0];
+            }
+            else
+            {
+                compressed = CompressFromFrames(processedFrames, meshToUse, capturedUVs, capturedColors);
+            }
             if (compressed == null)
             {
 #if UNITY_EDITOR
@@ -1915,8 +2369,11 @@ namespace Rat
                 cleanTextureFilename = cleanTextureFilename.Substring("assets/".Length);
             }
 
-            compressed.texture_filename = cleanTextureFilename;
-            compressed.mesh_data_filename = $"{baseFilename}.ratmesh";
+            foreach (var anim in segments ?? new List<CompressedAnimation> { compressed })
+            {
+                anim.texture_filename = cleanTextureFilename;
+                anim.mesh_data_filename = $"{baseFilename}.ratmesh";
+            }
 
             // Create GeneratedData directory
             string generatedDataPath = System.IO.Path.Combine(UnityEngine.Application.dataPath.Replace("Assets", ""), "GeneratedData");
@@ -1949,11 +2406,7 @@ namespace Rat
                         var decompressed = new UnityEngine.Vector3[ratAnim.num_vertices];
                         for (int i = 0; i < ratAnim.num_vertices; i++)
                         {
-                            var v = ratAnim.first_frame[i];
-                            float x = ratAnim.min_x + (v.x / 255f) * (ratAnim.max_x - ratAnim.min_x);
-                            float y = ratAnim.min_y + (v.y / 255f) * (ratAnim.max_y - ratAnim.min_y);
-                            float z = ratAnim.min_z + (v.z / 255f) * (ratAnim.max_z - ratAnim.min_z);
-                            decompressed[i] = new UnityEngine.Vector3(x, y, z);
+                            decompressed[i] = Core.DequantizeVertex(ratAnim, i, ratAnim.first_frame[i]);
                         }
                         // Compare to expected from processedFramesInner[0]
                         float maxError = 0f;
@@ -1987,10 +2440,11 @@ namespace Rat
                 actorDataInner.meshIndices = (meshToUse != null ? meshToUse.triangles : sourceMesh.triangles);
                 actorDataInner.textureFilename = cleanTextureFilename;
                 string actFilePathInner = System.IO.Path.Combine(generatedDataPath, $"{baseFilename}.act");
-                Actor.SaveActorData(actFilePathInner, actorDataInner, renderingMode, embedMeshData: true);
+                // Triangle order was already optimized above when optimizeVertexOrder is on
+                Actor.SaveActorData(actFilePathInner, actorDataInner, renderingMode, embedMeshData: true, optimizeVertexCache: false);
             }
 
-            if (yieldPerChunk)
+            if (yieldPerChunk && segments == null)
             {
                 // Use the chunked writer; perform validation/act creation in the completion callback
                 WriteRatFileWithSizeSplittingChunked(baseFilePath, compressed, maxFileSizeKB, skipValidation ? null : processedFrames,
@@ -2020,15 +2474,16 @@ namespace Rat
                     });
                 return;
             }
+            System.Action<int,int> writeProgress = null;
 #if UNITY_EDITOR
-            var ratFiles = WriteRatFileWithSizeSplitting(baseFilePath, compressed, maxFileSizeKB, skipValidation ? null : processedFrames,
-                (done, total) => {
-                    float progress = 0.5f + 0.4f * (done / (float)System.Math.Max(1, total));
-                    UnityEditor.EditorUtility.DisplayProgressBar("Exporting", $"Writing RAT files... ({done}/{total})", progress);
-                });
-#else
-            var ratFiles = WriteRatFileWithSizeSplitting(baseFilePath, compressed, maxFileSizeKB, skipValidation ? null : processedFrames);
+            writeProgress = (done, total) => {
+                float progress = 0.5f + 0.4f * (done / (float)System.Math.Max(1, total));
+                UnityEditor.EditorUtility.DisplayProgressBar("Exporting", $"Writing RAT files... ({done}/{total})", progress);
+            };
 #endif
+            var ratFiles = (segments != null)
+                ? WriteRatSegmentsWithSizeSplitting(baseFilePath, segments, maxFileSizeKB, skipValidation ? null : processedFrames, writeProgress)
+                : WriteRatFileWithSizeSplitting(baseFilePath, compressed, maxFileSizeKB, skipValidation ? null : processedFrames, writeProgress);
 
             // Validation step (editor/debug): read back the RAT and compare decompressed vertices to expected world-space positions
             try
@@ -2043,11 +2498,7 @@ namespace Rat
                     var decompressed = new UnityEngine.Vector3[ratAnim.num_vertices];
                     for (int i = 0; i < ratAnim.num_vertices; i++)
                     {
-                        var v = ratAnim.first_frame[i];
-                        float x = ratAnim.min_x + (v.x / 255f) * (ratAnim.max_x - ratAnim.min_x);
-                        float y = ratAnim.min_y + (v.y / 255f) * (ratAnim.max_y - ratAnim.min_y);
-                        float z = ratAnim.min_z + (v.z / 255f) * (ratAnim.max_z - ratAnim.min_z);
-                        decompressed[i] = new UnityEngine.Vector3(x, y, z);
+                        decompressed[i] = Core.DequantizeVertex(ratAnim, i, ratAnim.first_frame[i]);
                     }
                     // Compare to expected from processedFrames[0]
                     float maxError = 0f;
@@ -2087,11 +2538,11 @@ namespace Rat
             actorData.textureFilename = cleanTextureFilename;
 
             string actFilePath = System.IO.Path.Combine(generatedDataPath, $"{baseFilename}.act");
-            Actor.SaveActorData(actFilePath, actorData, renderingMode, embedMeshData: true);
+            Actor.SaveActorData(actFilePath, actorData, renderingMode, embedMeshData: true, optimizeVertexCache: false);
             
             UnityEngine.Debug.Log($"ExportAnimation: Complete");
             UnityEngine.Debug.Log($"  RAT files ({ratFiles.Count}): Bounds={compressed.min_x:F2}-{compressed.max_x:F2}, {compressed.min_y:F2}-{compressed.max_y:F2}, {compressed.min_z:F2}-{compressed.max_z:F2}");
-            UnityEngine.Debug.Log($"  Vertices: {compressed.num_vertices}, Frames: {compressed.num_frames}");
+            UnityEngine.Debug.Log($"  Vertices: {compressed.num_vertices}, Frames: {processedFrames.Count}{(segments != null ? $", adaptive segments: {segments.Count}" : "")}");
             UnityEngine.Debug.Log($"  Texture: {cleanTextureFilename}");
             UnityEngine.Debug.Log($"  ACT file: Mesh data + RAT references (all transforms baked into RAT vertex data)");
         }
@@ -2133,18 +2584,7 @@ namespace Rat
                 if (customMatrices.Count == vertexFrames.Count)
                 {
                     UnityEngine.Debug.Log($"ExportAnimationWithMaxBits: Baking {customMatrices.Count} matrix transforms into vertex animation...");
-                    processedFrames = new List<UnityEngine.Vector3[]>(vertexFrames.Count);
-
-                    for (int frameIndex = 0; frameIndex < vertexFrames.Count; frameIndex++)
-                    {
-                        var matrix = customMatrices[frameIndex];
-                        var transformedVertices = new UnityEngine.Vector3[vertexFrames[frameIndex].Length];
-                        for (int vertexIndex = 0; vertexIndex < vertexFrames[frameIndex].Length; vertexIndex++)
-                        {
-                            transformedVertices[vertexIndex] = matrix.MultiplyPoint3x4(vertexFrames[frameIndex][vertexIndex]);
-                        }
-                        processedFrames.Add(transformedVertices);
-                    }
+                    processedFrames = BakeFrameMatrices(vertexFrames, customMatrices.ToArray());
 
                     appliedMatrixTransforms = true;
                 }
@@ -2157,29 +2597,8 @@ namespace Rat
             if (!appliedMatrixTransforms && customTransforms != null && customTransforms.Count == vertexFrames.Count)
             {
                 UnityEngine.Debug.Log($"ExportAnimationWithMaxBits: Baking {customTransforms.Count} transform frames into vertex animation...");
-                processedFrames = new List<UnityEngine.Vector3[]>();
-                
-                for (int frameIndex = 0; frameIndex < vertexFrames.Count; frameIndex++)
-                {
-                    var transformData = customTransforms[frameIndex];
-                    
-                    // Build transform matrix: position, rotation, scale
-                    UnityEngine.Matrix4x4 transformMatrix = UnityEngine.Matrix4x4.TRS(
-                        transformData.position,
-                        UnityEngine.Quaternion.Euler(transformData.rotation),
-                        transformData.scale
-                    );
-                    
-                    // Apply to all vertices in this frame
-                    var transformedVertices = new UnityEngine.Vector3[vertexFrames[frameIndex].Length];
-                    for (int vertexIndex = 0; vertexIndex < vertexFrames[frameIndex].Length; vertexIndex++)
-                    {
-                        var v = transformMatrix.MultiplyPoint3x4(vertexFrames[frameIndex][vertexIndex]);
-                        transformedVertices[vertexIndex] = v;
-                    }
-                    
-                    processedFrames.Add(transformedVertices);
-                }
+                // Build transform matrices (position, rotation, scale) and apply them to all vertices of each frame
+                processedFrames = BakeFrameMatrices(vertexFrames, BuildTransformMatrices(customTransforms));
             }
             else if (!appliedMatrixTransforms && customTransforms != null && customTransforms.Count != vertexFrames.Count)
             {
@@ -2220,16 +2639,7 @@ namespace Rat
                     }
                 }
 
-                for (int f = 0; f < processedFrames.Count; f++)
-                {
-                    var frame = processedFrames[f];
-                    for (int i = 0; i < frame.Length; i++)
-                    {
-                        var p = frame[i];
-                        p.z = -p.z;
-                        frame[i] = p;
-                    }
-                }
+                FlipFramesZ(processedFrames);
             }
 
             // Compress with bit width constraints
@@ -281,10 +281,7 @@ public class RatActPreviewGizmo : MonoBehaviour
             var worldVertices = new Vector3[_currentRatAnim.num_vertices];
             for (int i = 0; i < _currentRatAnim.num_vertices; i++)
             {
-                float x = _currentRatAnim.min_x + (_decompContexts[0].current_positions[i].x / 255f) * (_currentRatAnim.max_x - _currentRatAnim.min_x);
-                float y = _currentRatAnim.min_y + (_decompContexts[0].current_positions[i].y / 255f) * (_currentRatAnim.max_y - _currentRatAnim.min_y);
-                float z = _currentRatAnim.min_z + (_decompContexts[0].current_positions[i].z / 255f) * (_currentRatAnim.max_z - _currentRatAnim.min_z);
-                worldVertices[i] = transform.TransformPoint(new Vector3(x, y, z));
+                worldVertices[i] = transform.TransformPoint(Core.DequantizeVertex(_currentRatAnim, i, _decompContexts[0].current_positions[i]));
             }
             
             // Draw bounds
@@ -0,0 +1,170 @@
+using System;
+using System.Collections.Generic;
+using System.Runtime.CompilerServices;
+using System.Threading;
+
+namespace Rat
+{
+    /// <summary>
+    /// Batches every actor's RAT decode for one frame and runs them together on the thread pool.
+    /// Drivers (AnimationPlayer, timeline playback) <see cref="Enqueue"/> a request per visible actor. The first caller of
+    /// <see cref="DispatchFrame"/> for a frame sorts the requests so ones sharing a chunk and bit-width layout run
+    /// back to back, decodes them in parallel into the requesters' SoA buffers, and then publishes the frame once.
+    /// Consumers read their buffers only after <see cref="PublishedFrame"/> reaches the frame they asked for.
+    /// </summary>
+    public sealed class DecodeScheduler
+    {
+        /// <summary>
+        /// Shared scheduler for everything driven from the Unity player loop.
+        /// </summary>
+        public static readonly DecodeScheduler Shared = new DecodeScheduler();
+
+        private struct Request
+        {
+            public CompressedAnimation anim;
+            public DecompressionContext ctx;
+            public uint frame;
+            public float[] x, y, z;
+            public UnityEngine.Matrix4x4 model;
+            public long sortKey;
+        }
+
+        private readonly List<Request> _pending = new List<Request>();
+        private readonly Dictionary<DecompressionContext, int> _pendingByContext = new Dictionary<DecompressionContext, int>();
+        private Request[] _batch = new Request[0];
+        private long _publishedFrame = -1;
+
+        // Sort key per chunk, computed from its contents on first use
+        private readonly ConditionalWeakTable<CompressedAnimation, object> _sortKeys = new ConditionalWeakTable<CompressedAnimation, object>();
+
+        // Per-thread scratch for dequantization tables, grown on demand and reused across frames
+        private readonly ThreadLocal<float[]> _tableScratch = new ThreadLocal<float[]>(() => new float[12]);
+
+        /// <summary>
+        /// Last frame whose decodes have all completed. Read with acquire semantics.
+        /// </summary>
+        public long PublishedFrame => Volatile.Read(ref _publishedFrame);
+
+        /// <summary>
+        /// Queues a decode of <paramref name="frame"/> into <paramref name="x"/>/<paramref name="y"/>/<paramref name="z"/>.
+        /// A context can only be decoded once per dispatch; a second request for the same context replaces the first.
+        /// Must be called from the thread that dispatches (the main thread for <see cref="Shared"/>).
+        /// </summary>
+        public void Enqueue(CompressedAnimation anim, DecompressionContext ctx, uint frame, float[] x, float[] y, float[] z, UnityEngine.Matrix4x4? model = null)
+        {
+            if (anim == null || ctx == null) throw new ArgumentNullException(anim == null ? nameof(anim) : nameof(ctx));
+            if (x.Length < anim.num_vertices || y.Length < anim.num_vertices || z.Length < anim.num_vertices)
+            {
+                throw new ArgumentException("Output arrays must hold num_vertices entries.");
+            }
+
+            var request = new Request
+            {
+                anim = anim, ctx = ctx, frame = frame, x = x, y = y, z = z,
+                model = model ?? UnityEngine.Matrix4x4.identity,
+                sortKey = (long)_sortKeys.GetValue(anim, SortKey)
+            };
+
+            if (_pendingByContext.TryGetValue(ctx, out int existing))
+            {
+                _pending[existing] = request;
+            }
+            else
+            {
+                _pendingByContext[ctx] = _pending.Count;
+                _pending.Add(request);
+            }
+        }
+
+        /// <summary>
+        /// Decodes everything queued for <paramref name="frameIndex"/> and publishes it. Calls for a frame that is
+        /// already published return immediately, so every consumer can call this and only the first pays for it.
+        /// </summary>
+        public void DispatchFrame(long frameIndex)
+        {
+            if (PublishedFrame >= frameIndex) return;
+
+            int count = _pending.Count;
+            if (_batch.Length < count) _batch = new Request[count];
+            _pending.CopyTo(_batch);
+            _pending.Clear();
+            _pendingByContext.Clear();
+            Array.Sort(_batch, 0, count, RequestComparer.Instance);
+
+            var batch = _batch;
+            int blocks = Math.Min(count, Environment.ProcessorCount * 2);
+            if (blocks <= 1)
+            {
+                for (int i = 0; i < count; i++) Decode(ref batch[i]);
+            }
+            else
+            {
+                // Contiguous ranges keep requests that share a chunk on the same worker
+                Tool.RunParallel(blocks, b =>
+                {
+                    int start = (int)((long)count * b / blocks);
+                    int end = (int)((long)count * (b + 1) / blocks);
+                    for (int i = start; i < end; i++) Decode(ref batch[i]);
+                });
+            }
+            Array.Clear(_batch, 0, count);
+
+            // Single fence: Parallel.For has joined, so every buffer write happens-before this release
+            Volatile.Write(ref _publishedFrame, frameIndex);
+        }
+
+        /// <summary>
+        /// Groups by bit-width layout first (identical layouts share stream stride and table shape), then by chunk.
+        /// Both halves hash the data rather than object identity, so chunks loaded separately from the same file
+        /// group together and the dispatch order is the same on every run.
+        /// </summary>
+        private static object SortKey(CompressedAnimation anim)
+        {
+            uint layout = Fnv1a(2166136261u, (uint)Core.BitsPerDeltaFrame(anim));
+            layout = Fnv1a(layout, anim.bit_widths_x);
+            layout = Fnv1a(layout, anim.bit_widths_y);
+            layout = Fnv1a(layout, anim.bit_widths_z);
+
+            // Chunks carry no index of their own; their frame count and delta stream identify them
+            uint chunk = Fnv1a(2166136261u, anim.num_frames);
+            if (anim.delta_stream != null)
+            {
+                foreach (uint word in anim.delta_stream) chunk = Fnv1a(chunk, word);
+            }
+            return ((long)(layout & 0x7FFFFFFF) << 32) | chunk;
+        }
+
+        private static uint Fnv1a(uint hash, uint value)
+        {
+            for (int i = 0; i < 4; i++, value >>= 8) hash = (hash ^ (value & 0xFF)) * 16777619u;
+            return hash;
+        }
+
+        private static uint Fnv1a(uint hash, byte[] data)
+        {
+            if (data == null) return Fnv1a(hash, 0xFFFFFFFFu);
+            hash = Fnv1a(hash, (uint)data.Length);
+            foreach (byte b in data) hash = (hash ^ b) * 16777619u;
+            return hash;
+        }
+
+        private void Decode(ref Request r)
+        {
+            int length = Core.DequantTableLength(r.anim);
+            var table = _tableScratch.Value;
+            if (table.Length < length)
+            {
+                table = new float[length];
+                _tableScratch.Value = table;
+            }
+            Core.FillDequantTable(r.anim, r.model, table);
+            Core.DecompressToFrameSoA(r.ctx, r.anim, r.frame, table, r.x, r.y, r.z, null, null, null, 0f);
+        }
+
+        private sealed class RequestComparer : IComparer<Request>
+        {
+            public static readonly RequestComparer Instance = new RequestComparer();
+            public int Compare(Request a, Request b) => a.sortKey.CompareTo(b.sortKey);
+        }
+    }
+}
@@ -56,6 +56,22 @@ public class RatRecorder : MonoBehaviour
     [Range(1, 8)]
     public int maxBitsZ = 8;
 
+    [Tooltip("Quantize vertex groups against their own bounds (RAT4) instead of one box for the whole clip.\n" +
+             "Improves precision and shrinks deltas for clips with large overall motion.")]
+    public bool adaptiveQuantization = false;
+
+    [Tooltip("Maximum number of vertex clusters per segment, each with its own quantization bounds.")]
+    [Range(1, 256)]
+    public int quantizationClusters = 16;
+
+    [Tooltip("Frames per segment. Cluster bounds are recomputed and vertices re-quantized at every segment boundary.")]
+    [Range(2, 1024)]
+    public int quantizationSegmentFrames = 120;
+
+    [Tooltip("Renumber vertices and reorder triangles for post-transform vertex cache reuse.\n" +
+             "Exported vertex order then differs from the Unity mesh.")]
+    public bool optimizeVertexOrder = false;
+
     [Header("File Output")]
     [Tooltip("The base filename for the saved .rat animation files.")]
     public string baseFilename = "recorded_animation";
@@ -439,7 +455,10 @@ public class RatRecorder : MonoBehaviour
                 maxFileSizeKB,
                 Rat.ActorRenderingMode.TextureWithDirectionalLight,
                 frameTransforms,  // Pass transforms
-                skipValidation
+                skipValidation,
+                adaptiveClusters: adaptiveQuantization ? quantizationClusters : 0,
+                adaptiveSegmentFrames: quantizationSegmentFrames,
+                optimizeVertexOrder: optimizeVertexOrder
             );
             Debug.Log("RatRecorder: Export finished");
             
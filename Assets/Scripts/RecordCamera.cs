@@ -510,6 +510,9 @@ public class RecordCamera : MonoBehaviour
     /// Field of View:
     ///   float fov_degrees = (float)fov_byte
     /// 
+    /// Assets/Ziz/cam0.h is the reference reader: it decodes a track once and samples interpolated poses and view
+    /// matrices at any time. The example below shows the raw layout.
+    /// 
     /// C LOADING EXAMPLE:
     /// ```c
     /// typedef struct {
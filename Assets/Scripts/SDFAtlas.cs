@@ -0,0 +1,299 @@
+using System;
+using System.Collections.Generic;
+using UnityEngine;
+
+/// <summary>
+/// Packs SDF shape textures into shared power-of-two pages, so a scene full of shape variants binds a few textures
+/// instead of one per actor.
+/// Textures are keyed by their parameter-hashed file name (SDFShape.BuildOutputFilename), so identical bakes are stored
+/// once. Placement is skyline bottom-left, tallest first. Bilinear filtering reaches one texel past a texture's border,
+/// so an edge gets a gutter of repeated edge texels followed by one clear texel, except where it needs none: at the
+/// page border, which clamps, and along a fully transparent edge. Every gutter ends clear and the page starts clear, so
+/// a transparent edge only ever meets transparent texels and just the color of fully transparent samples can change.
+/// Shape textures with transparent margins therefore pack edge to edge.
+/// A texture that would be alone on a page (or is larger than one) is left out and keeps its own file. At the full
+/// platform size (256x256, 64x64 on N64) every shape texture fills a page, so only smaller bakes are atlased.
+/// </summary>
+public class SDFAtlas
+{
+    public struct Placement
+    {
+        public int page;
+        public RectInt texels;   // without the gutters, y up like Texture2D
+        public Rect uv;          // the same rectangle in page UVs
+    }
+
+    private class Entry
+    {
+        public string key;
+        public int width, height;
+        public Color32[] pixels;
+        public Placement placement;
+        public bool placed;
+        public int gutterLeft, gutterRight, gutterBottom, gutterTop;    // repeated edge texels, 0 along a transparent edge
+    }
+
+    private struct Segment
+    {
+        public int x, y, width;
+    }
+
+    private class Page
+    {
+        public List<Segment> skyline = new List<Segment>();
+        public int usedWidth, usedHeight;
+        public int width, height;
+        public List<Entry> entries = new List<Entry>();
+    }
+
+    public readonly int maxSize;
+    public readonly int gutter;
+
+    private readonly Dictionary<string, Entry> entries = new Dictionary<string, Entry>();
+    private readonly List<Page> pages = new List<Page>();
+
+    public SDFAtlas(int maxSize, int gutter = 2)
+    {
+        this.maxSize = maxSize;
+        this.gutter = gutter;
+    }
+
+    public int PageCount => pages.Count;
+    public int TextureCount => entries.Count;
+
+    /// <summary>
+    /// Adds a texture (pixels bottom-up as from GetPixels32). Returns false if the key is already in the atlas.
+    /// </summary>
+    public bool Add(string key, int width, int height, Color32[] pixels)
+    {
+        if (entries.ContainsKey(key)) return false;
+        if (pixels.Length != width * height) throw new ArgumentException($"{key}: expected {width * height} pixels, got {pixels.Length}");
+        entries.Add(key, new Entry { key = key, width = width, height = height, pixels = pixels });
+        return true;
+    }
+
+    /// <summary>
+    /// False for a key that isn't in the atlas or was left out of every page by Pack.
+    /// </summary>
+    public bool TryGetPlacement(string key, out Placement placement)
+    {
+        bool found = entries.TryGetValue(key, out Entry entry) && entry.placed;
+        placement = found ? entry.placement : default(Placement);
+        return found;
+    }
+
+    /// <summary>
+    /// Places every texture added so far. Deterministic for a given set of keys, whatever order they were added in.
+    /// </summary>
+    public void Pack()
+    {
+        pages.Clear();
+
+        var sorted = new List<Entry>(entries.Values);
+        sorted.Sort((a, b) =>
+        {
+            int c = b.height.CompareTo(a.height);
+            if (c == 0) c = b.width.CompareTo(a.width);
+            return c != 0 ? c : string.CompareOrdinal(a.key, b.key);
+        });
+
+        // The skyline starts one full margin outside the page on every side; each texture may hang over the border by
+        // its own margins only
+        int border = Margin(gutter);
+        foreach (var entry in sorted)
+        {
+            entry.placed = false;
+            if (entry.width > maxSize || entry.height > maxSize) continue;
+
+            int w = entry.width, h = entry.height;
+            entry.gutterLeft = IsTransparentEdge(entry, 0, 0, 0, 1, h) ? 0 : gutter;
+            entry.gutterRight = IsTransparentEdge(entry, w - 1, 0, 0, 1, h) ? 0 : gutter;
+            entry.gutterBottom = IsTransparentEdge(entry, 0, 0, 1, 0, w) ? 0 : gutter;
+            entry.gutterTop = IsTransparentEdge(entry, 0, h - 1, 1, 0, w) ? 0 : gutter;
+            int left = Margin(entry.gutterLeft), right = Margin(entry.gutterRight);
+            int bottom = Margin(entry.gutterBottom), top = Margin(entry.gutterTop);
+            int width = left + w + right, height = bottom + h + top;
+
+            int pageIndex = -1, x = 0, y = 0;
+            for (int p = 0; p < pages.Count && pageIndex < 0; p++)
+            {
+                if (FindPosition(pages[p], width, height, -left, maxSize + right, -bottom, maxSize + top, out x, out y)) pageIndex = p;
+            }
+            if (pageIndex < 0)
+            {
+                var page = new Page();
+                page.skyline.Add(new Segment { x = -border, y = -border, width = maxSize + 2 * border });
+                pages.Add(page);
+                pageIndex = pages.Count - 1;
+                FindPosition(page, width, height, -left, maxSize + right, -bottom, maxSize + top, out x, out y);
+            }
+
+            Place(pages[pageIndex], x, y, width, height);
+            pages[pageIndex].entries.Add(entry);
+            entry.placed = true;
+            entry.placement = new Placement
+            {
+                page = pageIndex,
+                texels = new RectInt(x + left, y + bottom, w, h)
+            };
+        }
+
+        // A page holding one texture saves nothing over the texture's own file
+        var shared = new List<Page>();
+        foreach (var page in pages)
+        {
+            if (page.entries.Count < 2)
+            {
+                foreach (var entry in page.entries) entry.placed = false;
+                continue;
+            }
+            foreach (var entry in page.entries) entry.placement.page = shared.Count;
+            shared.Add(page);
+        }
+        pages.Clear();
+        pages.AddRange(shared);
+
+        // Shrink every page to the smallest power of two around what it holds
+        for (int p = 0; p < pages.Count; p++)
+        {
+            var page = pages[p];
+            page.width = Mathf.NextPowerOfTwo(page.usedWidth);
+            page.height = Mathf.NextPowerOfTwo(page.usedHeight);
+            foreach (var entry in page.entries)
+            {
+                var t = entry.placement.texels;
+                entry.placement.uv = new Rect((float)t.x / page.width, (float)t.y / page.height,
+                                              (float)t.width / page.width, (float)t.height / page.height);
+            }
+        }
+    }
+
+    /// <summary>
+    /// Lowest, then leftmost, spot on the skyline where a width x height rectangle fits with its left edge at or after
+    /// minX, its right edge at or before maxX, and likewise for y.
+    /// </summary>
+    private static bool FindPosition(Page page, int width, int height, int minX, int maxX, int minY, int maxY, out int bestX, out int bestY)
+    {
+        bestX = bestY = 0;
+        bool found = false;
+        var skyline = page.skyline;
+        for (int i = 0; i < skyline.Count; i++)
+        {
+            if (skyline[i].x + skyline[i].width <= minX) continue;
+            int x = Math.Max(skyline[i].x, minX);
+            if (x + width > maxX) break;
+
+            int y = minY;
+            for (int j = i; j < skyline.Count && skyline[j].x < x + width; j++) y = Math.Max(y, skyline[j].y);
+            if (y + height > maxY) continue;
+
+            if (!found || y < bestY)
+            {
+                found = true;
+                bestX = x;
+                bestY = y;
+            }
+        }
+        return found;
+    }
+
+    // Gutter plus the clear texel after it
+    private static int Margin(int gutter) => gutter > 0 ? gutter + 1 : 0;
+
+    private static bool IsTransparentEdge(Entry entry, int x, int y, int dx, int dy, int count)
+    {
+        for (int i = 0; i < count; i++, x += dx, y += dy)
+        {
+            if (entry.pixels[y * entry.width + x].a != 0) return false;
+        }
+        return true;
+    }
+
+    private void Place(Page page, int x, int y, int width, int height)
+    {
+        var skyline = page.skyline;
+        var updated = new List<Segment>(skyline.Count + 2);
+        int right = x + width;
+        bool inserted = false;
+
+        // The new top edge goes in where the first overlapped segment was, after whatever of it lies left of x
+        foreach (var s in skyline)
+        {
+            int end = s.x + s.width;
+            if (end <= x || s.x >= right)
+            {
+                updated.Add(s);
+                continue;
+            }
+            if (s.x < x) updated.Add(new Segment { x = s.x, y = s.y, width = x - s.x });
+            if (!inserted)
+            {
+                updated.Add(new Segment { x = x, y = y + height, width = width });
+                inserted = true;
+            }
+            if (end > right) updated.Add(new Segment { x = right, y = s.y, width = end - right });
+        }
+
+        // Merge neighbours at the same height
+        skyline.Clear();
+        foreach (var s in updated)
+        {
+            if (skyline.Count > 0 && skyline[skyline.Count - 1].y == s.y && skyline[skyline.Count - 1].x + skyline[skyline.Count - 1].width == s.x)
+            {
+                var last = skyline[skyline.Count - 1];
+                last.width += s.width;
+                skyline[skyline.Count - 1] = last;
+            }
+            else
+            {
+                skyline.Add(s);
+            }
+        }
+
+        // Margins hanging over the page border are dropped
+        page.usedWidth = Math.Max(page.usedWidth, Math.Min(right, maxSize));
+        page.usedHeight = Math.Max(page.usedHeight, Math.Min(y + height, maxSize));
+    }
+
+    /// <summary>
+    /// Pixels of one page, bottom-up for SetPixels32, gutters filled with each texture's nearest edge texel and the rest
+    /// clear.
+    /// </summary>
+    public Color32[] BuildPage(int page, out int width, out int height)
+    {
+        var p = pages[page];
+        width = p.width;
+        height = p.height;
+        var pixels = new Color32[width * height];
+
+        foreach (var entry in p.entries)
+        {
+            var t = entry.placement.texels;
+            for (int y = -entry.gutterBottom; y < entry.height + entry.gutterTop; y++)
+            {
+                int py = t.y + y;
+                if (py < 0 || py >= height) continue;
+                int sy = Mathf.Clamp(y, 0, entry.height - 1);
+                for (int x = -entry.gutterLeft; x < entry.width + entry.gutterRight; x++)
+                {
+                    int px = t.x + x;
+                    if (px < 0 || px >= width) continue;
+                    int sx = Mathf.Clamp(x, 0, entry.width - 1);
+                    pixels[py * width + px] = entry.pixels[sy * entry.width + sx];
+                }
+            }
+        }
+        return pixels;
+    }
+
+    /// <summary>
+    /// Maps UVs in 0..1 onto a placement's rectangle.
+    /// </summary>
+    public static Vector2[] RemapUVs(Vector2[] uvs, Rect rect)
+    {
+        var remapped = new Vector2[uvs.Length];
+        for (int i = 0; i < uvs.Length; i++)
+            remapped[i] = new Vector2(rect.x + uvs[i].x * rect.width, rect.y + uvs[i].y * rect.height);
+        return remapped;
+    }
+}
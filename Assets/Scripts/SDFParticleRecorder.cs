@@ -5,7 +5,7 @@ using System.Linq;
 
 /// <summary>
 /// Records Unity ParticleSystem data and converts each particle into an SDF shape instance,
-/// then exports the entire particle system animation as .act and .rat files.
+/// then exports the entire particle system animation as a .ptc instance stream (or as .act and .rat files).
 /// This enables retro hardware to display particle effects using efficient SDF rendering.
 /// 
 /// This component is automatically added to all ParticleSystem objects in the scene.
@@ -82,6 +82,24 @@ public class SDFParticleRecorder : MonoBehaviour
     [Range(16, 1024)]
     public int maxFileSizeKB = 64;
 
+    [Tooltip("Quantize particle groups against their own bounds (RAT4) instead of one box for the whole system.")]
+    public bool adaptiveQuantization = false;
+
+    [Tooltip("Maximum number of particle vertex clusters per segment when adaptive quantization is on.")]
+    [Range(1, 256)]
+    public int quantizationClusters = 32;
+
+    [Tooltip("Frames per segment when adaptive quantization is on.")]
+    [Range(2, 1024)]
+    public int quantizationSegmentFrames = 120;
+
+    [Tooltip("Export a .ptc instance stream of the live particles, expanded to quads at runtime, instead of baking every particle slot's quad into .act/.rat files.")]
+    public bool exportInstanceStream = true;
+
+    [Tooltip("Frames between instance stream key frames. Seeking decodes forward from the nearest one.")]
+    [Range(1, 600)]
+    public int streamKeyInterval = 30;
+
     [Tooltip("Automatically export when exiting play mode.")]
     public bool autoExportOnPlayModeExit = true;
 
@@ -128,11 +146,13 @@ public class SDFParticleRecorder : MonoBehaviour
     }
 
     /// <summary>
-    /// Stores data for a single particle instance
+    /// Stores data for a single live particle instance
     /// </summary>
     [System.Serializable]
     private struct ParticleInstance
     {
+        public uint id;      // ParticleSystem.Particle.randomSeed, stable for the particle's life
+        public int slot;     // stable index below maxParticles, for the baked RAT export
         public Vector3 position;
         public Vector3 rotation;
         public Vector3 scale;
@@ -490,8 +510,8 @@ public class SDFParticleRecorder : MonoBehaviour
         // Track which particle IDs are alive this frame
         HashSet<uint> aliveParticleIds = new HashSet<uint>();
         
-        // Initialize frame with all slots as inactive
-        ParticleFrameData frameData = new ParticleFrameData(maxParticles);
+        // Only live particles are stored; the baked export rebuilds the empty slots from their slot indices
+        ParticleFrameData frameData = new ParticleFrameData(particleCount);
         frameData.timestamp = Time.time - _recordingStartTime;
         
         // Capture camera position for billboarding
@@ -506,24 +526,6 @@ public class SDFParticleRecorder : MonoBehaviour
             frameData.cameraPosition = _mainCamera.transform.position;
             frameData.hasCamera = true;
         }
-        
-        // Get spawn position for inactive particles
-        Vector3 spawnPosition = GetSpawnPosition();
-        
-        // Create inactive particle template
-        ParticleInstance inactiveParticle = new ParticleInstance
-        {
-            position = spawnPosition,
-            rotation = Vector3.zero,
-            scale = new Vector3(0.001f, 0.001f, 0.001f),
-            color = new Color(particleColor.r, particleColor.g, particleColor.b, 0f)
-        };
-        
-        // Fill all slots with inactive particles first
-        for (int i = 0; i < maxParticles; i++)
-        {
-            frameData.particles.Add(inactiveParticle);
-        }
 
         // Process active particles and assign them to stable slots
         for (int i = 0; i < particleCount; i++)
@@ -555,14 +557,15 @@ public class SDFParticleRecorder : MonoBehaviour
             // Create particle instance with actual data
             ParticleInstance instance = new ParticleInstance
             {
+                id = particleId,
+                slot = slotIndex,
                 position = p.position,
                 rotation = p.rotation3D,
                 scale = new Vector3(p.GetCurrentSize(targetParticleSystem), p.GetCurrentSize(targetParticleSystem), 1f),
                 color = useParticleSystemColors ? p.GetCurrentColor(targetParticleSystem) : particleColor
             };
             
-            // Place particle in its stable slot
-            frameData.particles[slotIndex] = instance;
+            frameData.particles.Add(instance);
         }
         
         // Free up slots from dead particles
@@ -585,36 +588,7 @@ public class SDFParticleRecorder : MonoBehaviour
     }
 
     /// <summary>
-    /// Gets the spawn position for inactive particles based on the particle system's shape module
-    /// </summary>
-    private Vector3 GetSpawnPosition()
-    {
-        if (targetParticleSystem == null) return Vector3.zero;
-
-        var shape = targetParticleSystem.shape;
-        var main = targetParticleSystem.main;
-        
-        // Get the spawn position in the appropriate space
-        Vector3 spawnPos = Vector3.zero;
-        
-        if (main.simulationSpace == ParticleSystemSimulationSpace.World)
-        {
-            spawnPos = transform.position;
-        }
-        else if (main.simulationSpace == ParticleSystemSimulationSpace.Local)
-        {
-            spawnPos = Vector3.zero; // Local space origin
-        }
-        else if (main.simulationSpace == ParticleSystemSimulationSpace.Custom && main.customSimulationSpace != null)
-        {
-            spawnPos = main.customSimulationSpace.position;
-        }
-        
-        return spawnPos;
-    }
-
-    /// <summary>
-    /// Stops recording and exports to .act and .rat files
+    /// Stops recording and exports to a .ptc instance stream, or to .act and .rat files
     /// </summary>
     public void StopRecordingAndExport()
     {
@@ -645,7 +619,120 @@ public class SDFParticleRecorder : MonoBehaviour
         }
 
         // Export the recorded data
-        ExportToActAndRat();
+        if (exportInstanceStream)
+        {
+            ExportToInstanceStream();
+        }
+        else
+        {
+            ExportToActAndRat();
+        }
+    }
+
+    /// <summary>
+    /// Exports recorded particle data as a .ptc instance stream: per frame, only the live particles (stable ID,
+    /// position, size, rotation, color), delta-coded by ID. Quads are built at runtime (Assets/Ziz/ptc0.c), so
+    /// file size and decode time follow the live particles instead of maxParticles.
+    /// </summary>
+    private void ExportToInstanceStream()
+    {
+        Debug.Log($"SDFParticleRecorder - starting instance stream export ({_recordedFrames.Count} frames)");
+
+        string textureFilename = ExportShapeTexture();
+
+        string generatedDataPath = Path.Combine(Application.dataPath.Replace("Assets", ""), "GeneratedData");
+        if (!Directory.Exists(generatedDataPath))
+        {
+            Directory.CreateDirectory(generatedDataPath);
+        }
+
+        // World space with Z flipped, as the baked export wrote its vertices
+        var simulationSpace = targetParticleSystem.main.simulationSpace;
+        var frames = new List<ParticleStream.Frame>(_recordedFrames.Count);
+        int peakLive = 0;
+        foreach (var recorded in _recordedFrames)
+        {
+            var frame = new ParticleStream.Frame();
+            Vector3 camera = Vector3.zero;
+            if (recorded.hasCamera)
+            {
+                camera = recorded.cameraPosition;
+                frame.hasCamera = true;
+            }
+            else if (_mainCamera != null)
+            {
+                camera = _mainCamera.transform.position;
+                frame.hasCamera = true;
+            }
+            frame.cameraPosition = new Vector3(camera.x, camera.y, -camera.z);
+
+            foreach (var particle in recorded.particles)
+            {
+                Vector3 worldPos = (simulationSpace == ParticleSystemSimulationSpace.World)
+                    ? particle.position
+                    : transform.TransformPoint(particle.position);
+                frame.particles.Add(new ParticleStream.Instance
+                {
+                    id = particle.id,
+                    position = new Vector3(worldPos.x, worldPos.y, -worldPos.z),
+                    size = particle.scale.x,
+                    rotation = particle.rotation,
+                    color = particle.color
+                });
+            }
+            peakLive = Mathf.Max(peakLive, recorded.particles.Count);
+            frames.Add(frame);
+        }
+
+        string streamPath = Path.Combine(generatedDataPath, baseFilename + ".ptc");
+        try
+        {
+            long bytes = ParticleStream.Write(streamPath, frames, captureFramerate, textureFilename, streamKeyInterval, billboard: true);
+            Debug.Log($"SDFParticleRecorder - exported {baseFilename}.ptc: {frames.Count} frames, peak {peakLive}/{targetParticleSystem.main.maxParticles} particles live, {bytes / 1024f:F1} KB");
+        }
+        catch (System.Exception e)
+        {
+            Debug.LogError($"SDFParticleRecorder - instance stream export failed: {e.Message}\n{e.StackTrace}");
+        }
+    }
+
+    /// <summary>
+    /// Exports the SDF shape texture at the platform-appropriate size and returns its file name
+    /// </summary>
+    private string ExportShapeTexture()
+    {
+        int width, height;
+        switch (shapeResolution)
+        {
+            case SDFEmulatedResolution.Tex512x512:
+                width = height = 512;
+                break;
+            case SDFEmulatedResolution.Tex256x256:
+                width = height = 256;
+                break;
+            case SDFEmulatedResolution.Tex128x64:
+                width = 128;
+                height = 64;
+                break;
+            default:
+                width = height = 256;
+                break;
+        }
+
+        // Apply platform-specific texture size limits
+        SDFShape.GetPlatformTextureSize(width, height, out int actualWidth, out int actualHeight);
+
+        string textureFilename = _sdfShapeTemplate != null
+            ? Path.GetFileName(_sdfShapeTemplate.BuildOutputFilename(actualWidth, actualHeight))
+            : $"sdf_{particleShapeType.ToString().ToLower()}_{actualWidth}x{actualHeight}.png";
+
+        // Ensure the SDF texture PNG is generated at the platform-appropriate size
+        if (_sdfShapeTemplate != null)
+        {
+            _sdfShapeTemplate.EnsureTextureExported();
+        }
+
+        return textureFilename;
     }
 
     /// <summary>
@@ -656,7 +743,7 @@ public class SDFParticleRecorder : MonoBehaviour
     {
         Debug.Log($"SDFParticleRecorder - starting export ({_recordedFrames.Count} frames)");
 
-        // Use the particle system's max particles - all frames should have this count
+        // Every slot up to the particle system's max particles is baked, live or not
         int maxParticles = targetParticleSystem.main.maxParticles;
 
         // Validate max particles for RAT format (ushort index limit)
@@ -719,38 +806,7 @@ public class SDFParticleRecorder : MonoBehaviour
             }
         }
 
-        // Generate texture filename based on SDF shape (before loop)
-        int width, height;
-        switch (shapeResolution)
-        {
-            case SDFEmulatedResolution.Tex512x512:
-                width = height = 512;
-                break;
-            case SDFEmulatedResolution.Tex256x256:
-                width = height = 256;
-                break;
-            case SDFEmulatedResolution.Tex128x64:
-                width = 128;
-                height = 64;
-                break;
-            default:
-                width = height = 256;
-                break;
-        }
-
-        // Apply platform-specific texture size limits
-        SDFShape.GetPlatformTextureSize(width, height, out int actualWidth, out int actualHeight);
-
-        string textureFilename = _sdfShapeTemplate != null 
-            ? Path.GetFileName(_sdfShapeTemplate.BuildOutputFilename(actualWidth, actualHeight))
-            : $"sdf_{particleShapeType.ToString().ToLower()}_{actualWidth}x{actualHeight}.png";
-
-        // Ensure the SDF texture PNG is generated at the platform-appropriate size
-        if (_sdfShapeTemplate != null)
-        {
-            _sdfShapeTemplate.EnsureTextureExported();
-        }
-
+        string textureFilename = ExportShapeTexture();
         Debug.Log($"SDFParticleRecorder - using texture: {textureFilename}");
 
         // Create a dummy mesh with the quad topology (shared across all chunks)
@@ -785,17 +841,21 @@ public class SDFParticleRecorder : MonoBehaviour
             Vector3[] vertices = new Vector3[totalVertices];
             bool[] activeFlags = new bool[maxParticles];
 
+            // Spread the live particles back over their slots; the rest stay inactive
+            ParticleInstance[] slots = new ParticleInstance[maxParticles];
+            foreach (var live in frame.particles)
+            {
+                slots[live.slot] = live;
+                activeFlags[live.slot] = true;
+            }
+
             // Process all particles (maxParticles count)
             for (int i = 0; i < maxParticles; i++)
             {
                 int vertexOffset = i * 4;
                 
-                // Get particle data (always present due to slot-based tracking)
-                ParticleInstance particle = frame.particles[i];
-                
-                // Check if particle is active (scale > threshold indicates active particle)
-                bool isActive = particle.scale.magnitude > 0.01f;
-                activeFlags[i] = isActive;
+                ParticleInstance particle = slots[i];
+                bool isActive = activeFlags[i];
                 
                 if (isActive)
                 {
@@ -925,25 +985,45 @@ public class SDFParticleRecorder : MonoBehaviour
         {
             Debug.Log($"SDFParticleRecorder - starting compression...");
             
-            // Compress the animation data with custom bounds
-            Rat.CompressedAnimation compressedAnim = Rat.Tool.CompressFromFramesWithBounds(
-                frameVertices,
-                quadMesh,
-                staticUVs,
-                staticColors,
-                minBounds,
-                maxBounds,
-                preserveFirstFrame: false
-            );
-            
-            Debug.Log($"SDFParticleRecorder - compression complete, writing file...");
-            
-            // Write RAT file(s) with size splitting
-            List<string> ratFiles = Rat.Tool.WriteRatFileWithSizeSplitting(
-                fullPath,
-                compressedAnim,
-                maxFileSizeKB
-            );
+            List<string> ratFiles;
+            if (adaptiveQuantization)
+            {
+                // Per-cluster bounds, re-quantized every segment
+                var segments = Rat.Tool.CompressFromFramesAdaptive(
+                    frameVertices,
+                    quadMesh,
+                    staticUVs,
+                    staticColors,
+                    quantizationClusters,
+                    quantizationSegmentFrames
+                );
+                
+                Debug.Log($"SDFParticleRecorder - adaptive compression complete ({segments.Count} segments), writing files...");
+                
+                ratFiles = Rat.Tool.WriteRatSegmentsWithSizeSplitting(fullPath, segments, maxFileSizeKB);
+            }
+            else
+            {
+                // Compress the animation data with custom bounds
+                Rat.CompressedAnimation compressedAnim = Rat.Tool.CompressFromFramesWithBounds(
+                    frameVertices,
+                    quadMesh,
+                    staticUVs,
+                    staticColors,
+                    minBounds,
+                    maxBounds,
+                    preserveFirstFrame: false
+                );
+                
+                Debug.Log($"SDFParticleRecorder - compression complete, writing file...");
+                
+                // Write RAT file(s) with size splitting
+                ratFiles = Rat.Tool.WriteRatFileWithSizeSplitting(
+                    fullPath,
+                    compressedAnim,
+                    maxFileSizeKB
+                );
+            }
             
             allCreatedRatFiles.AddRange(ratFiles);
             
@@ -1057,12 +1137,7 @@ public class SDFParticleRecorder : MonoBehaviour
                     for (int v = 0; v < anim.num_vertices; v++)
                     {
                         // Dequantize: map 0-255 back to min-max
-                        var q = ctx.current_positions[v];
-                        Vector3 reconstructed = new Vector3(
-                            anim.min_x + (q.x / 255f) * (anim.max_x - anim.min_x),
-                            anim.min_y + (q.y / 255f) * (anim.max_y - anim.min_y),
-                            anim.min_z + (q.z / 255f) * (anim.max_z - anim.min_z)
-                        );
+                        Vector3 reconstructed = Rat.Core.DequantizeVertex(anim, v, ctx.current_positions[v]);
                         
                         float dist = Vector3.Distance(reconstructed, original[v]);
                         if (dist > maxFrameError) 
@@ -56,6 +56,9 @@ public class SDFShape : MonoBehaviour
     public static string targetPlatform = "Wii";
     public static SDFEmulatedResolution targetResolution = SDFEmulatedResolution.Tex512x512;
 
+    // Pack exported shape textures into shared atlas pages (SDFAtlas) and remap each actor's UVs onto its rectangle
+    public static bool exportTextureAtlas = true;
+
     private MeshRenderer _renderer;
     private MeshFilter _filter;
     private Material _unlitMaterial;    // Main mesh material (unlit texture)
@@ -219,7 +222,7 @@ public class SDFShape : MonoBehaviour
     /// It uses MD5 over the provided input string and returns the first 8 hex characters
     /// (derived from the first 4 bytes of the MD5 digest) to keep filenames concise.
     /// </summary>
-    private string ComputeParamHash(string input)
+    private static string ComputeParamHash(string input)
     {
         using (var md5 = System.Security.Cryptography.MD5.Create())
         {
@@ -242,7 +245,7 @@ public class SDFShape : MonoBehaviour
         // N64 has strict 64x64 limit
         if (targetPlatform == "N64")
         {
-            int maxN64Size = 64;
+            int maxN64Size = GetPlatformMaxTextureSize();
             if (requestedWidth > maxN64Size || requestedHeight > maxN64Size)
             {
                 Debug.LogWarning($"[N64] Texture size {requestedWidth}x{requestedHeight} exceeds N64 limit. Clamping to {maxN64Size}x{maxN64Size}.");
@@ -253,7 +256,7 @@ public class SDFShape : MonoBehaviour
         else
         {
             // All other platforms: 256x256 max
-            int maxStandardSize = 256;
+            int maxStandardSize = GetPlatformMaxTextureSize();
             if (requestedWidth > maxStandardSize || requestedHeight > maxStandardSize)
             {
                 Debug.LogWarning($"[{targetPlatform}] Texture size {requestedWidth}x{requestedHeight} exceeds platform limit. Clamping to {maxStandardSize}x{maxStandardSize}.");
@@ -263,6 +266,14 @@ public class SDFShape : MonoBehaviour
         }
     }
 
+    /// <summary>
+    /// Largest texture side the target platform takes (also the atlas page limit).
+    /// </summary>
+    public static int GetPlatformMaxTextureSize()
+    {
+        return targetPlatform == "N64" ? 64 : 256;
+    }
+
     /// <summary>
     /// Ensures the texture is exported at the platform-appropriate size.
     /// Call this before exporting RAT files to guarantee the texture exists.
@@ -275,6 +286,17 @@ public class SDFShape : MonoBehaviour
         }
         
         // Export at the appropriate resolution for the current platform
+        GetExportTextureSize(out int actualWidth, out int actualHeight);
+        
+        // Save the texture at the clamped size
+        SaveRenderTextureToPNG(actualWidth, actualHeight, recyclePreviousShapes);
+    }
+
+    /// <summary>
+    /// Texture size EnsureTextureExported bakes at: the emulated resolution (256x256 for None), clamped to the platform limit.
+    /// </summary>
+    public void GetExportTextureSize(out int actualWidth, out int actualHeight)
+    {
         int width, height;
         switch (emulatedResolution)
         {
@@ -294,10 +316,7 @@ public class SDFShape : MonoBehaviour
         }
         
         // Apply platform-specific size limits
-        GetPlatformTextureSize(width, height, out int actualWidth, out int actualHeight);
-        
-        // Save the texture at the clamped size
-        SaveRenderTextureToPNG(actualWidth, actualHeight, recyclePreviousShapes);
+        GetPlatformTextureSize(width, height, out actualWidth, out actualHeight);
     }
 
     private void RenderToPNG() {
@@ -697,6 +716,38 @@ public class SDFShape : MonoBehaviour
         return generatedDataPath;
     }
 
+    /// <summary>
+    /// Writes GeneratedData/sdf_bake_manifest.txt for Assets/Ziz/sdf_bake_tool, which bakes the same PNGs as
+    /// SaveRenderTextureToPNG on the CPU. Needs neither play mode nor a GPU, so CI can run it in batch mode.
+    /// </summary>
+    [MenuItem("Tools/SDF Shapes/Write CPU Bake Manifest")]
+    public static void WriteBakeManifest()
+    {
+        var culture = System.Globalization.CultureInfo.InvariantCulture;
+        string manifestPath = System.IO.Path.Combine(GetGeneratedDataPath(), "sdf_bake_manifest.txt");
+        var written = new HashSet<string>();
+
+        using (var writer = new System.IO.StreamWriter(manifestPath))
+        {
+            writer.WriteLine("# type width height parameters... file (see Assets/Ziz/sdf_bake_tool.c)");
+            foreach (var shape in FindObjectsOfType<SDFShape>())
+            {
+                if (shape.emulatedResolution == SDFEmulatedResolution.None) continue;
+
+                shape.GetExportTextureSize(out int width, out int height);
+                string fileName = System.IO.Path.GetFileName(shape.BuildOutputFilename(width, height));
+                if (!written.Add(fileName)) continue;
+
+                writer.WriteLine(string.Format(culture,
+                    "{0} {1} {2} radius={3:R} roundness={4:R} smooth={5:R} thickness={6:R} head_size={7:R} shaft_thickness={8:R} star_inner={9:R} star_outer={10:R} star_points={11:R} alpha={12:R} {13}",
+                    shape.shapeType, width, height, shape.radius, shape.roundness, shape.smooth, shape.thickness,
+                    shape.headSize, shape.shaftThickness, shape.starInner, shape.starOuter, shape.starPoints, shape.color.a, fileName));
+            }
+        }
+
+        Debug.Log($"Wrote {written.Count} SDF shape(s) to {manifestPath}");
+    }
+
     private static void ExportAllShapesToRATs()
     {
         if (!EditorApplication.isPlaying)
@@ -729,26 +780,38 @@ public class SDFShape : MonoBehaviour
 
         Debug.Log($"Found {shapesByName.Count()} unique shape GameObjects to process.");
 
+        // Ensure every texture is actually exported first (texture filenames are detailed/deterministic), so they can be atlased
+        var detailedTextureFilenames = new Dictionary<string, string>();
+        foreach (var group in shapesByName)
+        {
+            SDFShape representative = group.First();
+            representative.EnsureTextureExported();
+            representative.GetExportTextureSize(out int actualWidth, out int actualHeight);
+            detailedTextureFilenames[group.Key] = System.IO.Path.GetFileName(representative.BuildOutputFilename(actualWidth, actualHeight));
+        }
+
+        SDFAtlas atlas = null;
+        string[] atlasPageFilenames = null;
+        if (exportTextureAtlas)
+        {
+            atlas = BuildShapeAtlas(outputDir, detailedTextureFilenames.Values, out atlasPageFilenames);
+        }
+
         foreach (var group in shapesByName)
         {
             string gameObjectName = group.Key;
             SDFShape representative = group.First();
             Mesh quadMesh = representative.GetComponent<MeshFilter>().sharedMesh;
+            string detailedTextureFilename = detailedTextureFilenames[gameObjectName];
 
-            // Ensure the texture is actually exported (texture filename is detailed/deterministic)
-            representative.EnsureTextureExported();
-
-            // Get the detailed texture filename
-            int w = 0, h = 0;
-            switch (representative.emulatedResolution)
+            // With an atlas the actor samples its rectangle of a shared page instead of its own texture
+            string textureFilename = detailedTextureFilename;
+            Vector2[] atlasUVs = null;
+            if (atlas != null && atlas.TryGetPlacement(detailedTextureFilename, out SDFAtlas.Placement placement))
             {
-                case SDFEmulatedResolution.Tex512x512: w = h = 512; break;
-                case SDFEmulatedResolution.Tex256x256: w = h = 256; break;
-                case SDFEmulatedResolution.Tex128x64: w = 128; h = 64; break;
+                textureFilename = atlasPageFilenames[placement.page];
+                atlasUVs = SDFAtlas.RemapUVs(quadMesh.uv, placement.uv);
             }
-            GetPlatformTextureSize(w, h, out int actualWidth, out int actualHeight);
-            string detailedTexturePath = representative.BuildOutputFilename(actualWidth, actualHeight);
-            string detailedTextureFilename = System.IO.Path.GetFileName(detailedTexturePath);
 
             Debug.Log($"Processing shape '{gameObjectName}' using detailed texture: {detailedTextureFilename} ({group.Count()} instance(s))");
 
@@ -825,10 +888,10 @@ public class SDFShape : MonoBehaviour
                         baseRatFilename,
                         allFramesVertices,
                         quadMesh,
-                        null,
+                        atlasUVs,
                         null,
                         exportFrameRate,
-                        detailedTextureFilename,  // Just the filename, no "assets/" prefix
+                        textureFilename,  // Just the filename, no "assets/" prefix
                         64, // maxFileSizeKB
                         Rat.ActorRenderingMode.TextureWithDirectionalLight,
                         allFramesTransforms  // Pass transforms
@@ -846,5 +909,56 @@ public class SDFShape : MonoBehaviour
         Debug.Log("=== SDF Shape RAT Export Complete ===");
     }
 
+    /// <summary>
+    /// Loads the exported shape PNGs, deduplicated by filename (which carries the parameter hash), and packs them into
+    /// SDFAtlas pages saved next to them as SDFAtlas_{hash}_{page}.png. Textures the atlas leaves out keep their own
+    /// file. Returns null if nothing could be loaded.
+    /// </summary>
+    private static SDFAtlas BuildShapeAtlas(string outputDir, IEnumerable<string> textureFilenames, out string[] pageFilenames)
+    {
+        pageFilenames = null;
+        var atlas = new SDFAtlas(GetPlatformMaxTextureSize());
+        var keys = new List<string>();
+
+        foreach (string filename in textureFilenames.Distinct())
+        {
+            string path = System.IO.Path.Combine(outputDir, filename);
+            if (!System.IO.File.Exists(path))
+            {
+                Debug.LogWarning($"[SDF Atlas] Missing shape texture {filename}, it keeps its own texture");
+                continue;
+            }
+            var texture = new Texture2D(2, 2, TextureFormat.RGBA32, false);
+            if (texture.LoadImage(System.IO.File.ReadAllBytes(path)))
+            {
+                atlas.Add(filename, texture.width, texture.height, texture.GetPixels32());
+                keys.Add(filename);
+            }
+            DestroyImmediate(texture);
+        }
+        if (keys.Count == 0) return null;
+
+        atlas.Pack();
+
+        // Page names depend only on the set of textures, so re-exporting an unchanged scene rewrites the same files
+        keys.Sort(string.CompareOrdinal);
+        string hash = ComputeParamHash(string.Join("|", keys));
+        pageFilenames = new string[atlas.PageCount];
+        for (int page = 0; page < atlas.PageCount; page++)
+        {
+            Color32[] pixels = atlas.BuildPage(page, out int width, out int height);
+            var texture = new Texture2D(width, height, TextureFormat.RGBA32, false);
+            texture.SetPixels32(pixels);
+            texture.Apply(false, false);
+            pageFilenames[page] = $"SDFAtlas_{hash}_{page}.png";
+            System.IO.File.WriteAllBytes(System.IO.Path.Combine(outputDir, pageFilenames[page]), texture.EncodeToPNG());
+            DestroyImmediate(texture);
+        }
+
+        int packed = keys.Count(key => atlas.TryGetPlacement(key, out _));
+        Debug.Log($"[SDF Atlas] {packed} of {keys.Count} unique shape texture(s) packed into {atlas.PageCount} page(s); the rest keep their own file");
+        return atlas;
+    }
+
 #endif
 }
@@ -12,37 +12,74 @@ using UnityEditor.SceneManagement;
 
 /// <summary>
 /// Binary file header for Scene data files (.scn)
-/// Compatible with C-based engines
+/// Compatible with C-based engines (Assets/Ziz/scne.h)
 /// </summary>
 [StructLayout(LayoutKind.Sequential, Pack = 1)]
 public struct SceneHeader
 {
     public uint magic;              // 'SCNE' = 0x454E4353
-    public uint version;            // File format version (1)
+    public uint version;            // File format version (2)
     public uint num_components;     // Total number of tracked components
     public uint num_keyframes;      // Number of state keyframes
     public float framerate;         // Recording framerate
-    public uint keyframes_offset;   // Offset to keyframe data array
-    
-    [MarshalAs(UnmanagedType.ByValArray, SizeConst = 32)]
-    public byte[] reserved;         // Reserved for future use (matching C struct)
+    public uint keyframes_offset;   // Offset to keyframe data array (4-byte aligned)
+    public uint mask_words;         // uint32 words per component bitset: (num_components + 31) / 32
+    public uint num_events;         // Activation/deactivation events over all keyframes
+    public uint num_snapshots;      // Full bitsets stored for seeking
+    public uint snapshot_interval;  // Writer setting: max events replayed after a snapshot
+    public uint events_offset;      // Offset to uint32 events
+    public uint snapshots_offset;   // Offset to snapshots: keyframe index, then mask_words words
+    public float duration;          // Seconds from recording start to stop
+
+    [MarshalAs(UnmanagedType.ByValArray, SizeConst = 12)]
+    public byte[] reserved;         // Pads the header to 64 bytes (matching C struct)
 }
 
 /// <summary>
-/// Keyframe state data for scene timeline
+/// Packed component bitset of any width: component i is bit (i % 32) of word (i / 32)
+/// </summary>
+[System.Serializable]
+public struct SceneComponentMask
+{
+    public uint[] words;
+
+    public SceneComponentMask(int componentCount)
+    {
+        words = new uint[WordCount(componentCount)];
+    }
+
+    public static int WordCount(int componentCount) => (componentCount + 31) / 32;
+
+    public bool Get(int index) => (words[index >> 5] & (1u << (index & 31))) != 0;
+
+    public void Set(int index, bool active)
+    {
+        if (active) words[index >> 5] |= 1u << (index & 31);
+        else words[index >> 5] &= ~(1u << (index & 31));
+    }
+
+    public SceneComponentMask Clone() => new SceneComponentMask { words = (uint[])words.Clone() };
+}
+
+/// <summary>
+/// Keyframe state data for scene timeline: the components that changed at this time, plus the full bitset when
+/// a snapshot is stored here
 /// </summary>
 [System.Serializable]
-[StructLayout(LayoutKind.Sequential, Pack = 1)]
 public struct SceneKeyframeData
 {
-    public float timestamp;                           // Time in seconds from start of recording
-    [MarshalAs(UnmanagedType.ByValArray, SizeConst = 32)]
-    public bool[] activeComponentIndices;             // Bit-packed as bools in C# for clarity
-    
-    public SceneKeyframeData(float time, int componentCount)
+    public const uint EventActivate = 1u << 31;     // Event = component index | EventActivate when it turned on
+    public const uint EventIndexMask = EventActivate - 1;
+
+    public float timestamp;                         // Time in seconds from start of recording
+    public uint[] events;                           // Changes since the previous keyframe
+    public SceneComponentMask? snapshot;            // State after this keyframe's events, for seeking
+
+    public SceneKeyframeData(float time, uint[] events)
     {
         timestamp = time;
-        activeComponentIndices = new bool[componentCount];
+        this.events = events;
+        snapshot = null;
     }
 }
 
@@ -61,31 +98,13 @@ public struct SceneComponentData
 }
 
 /// <summary>
-/// Keyframe state for scene timeline (binary format - must be struct for marshaling)
+/// Keyframe entry for scene timeline (binary format - must be struct for marshaling)
 /// </summary>
 [StructLayout(LayoutKind.Sequential, Pack = 1)]
 public struct SceneKeyframeHeaderData
 {
     public float timestamp;         // Time in seconds from recording start
-    public uint active_mask_count;  // Number of uint32 masks that follow
-    // Followed by variable number of uint32 activation masks
-    // Each bit represents one component's active state
-}
-
-/// <summary>
-/// Floating-point keyframe data used during recording (before compression)
-/// </summary>
-[System.Serializable]
-public struct SceneKeyframeFloat
-{
-    public float timestamp;
-    public List<bool> componentStates;
-    
-    public SceneKeyframeFloat(float time, int componentCount)
-    {
-        timestamp = time;
-        componentStates = new List<bool>(new bool[componentCount]);
-    }
+    public uint first_event;        // Events run to the next keyframe's first_event (num_events for the last)
 }
 
 /// <summary>
@@ -149,6 +168,8 @@ public class SceneController : MonoBehaviour
     public float recordingFPS = 30f;
     public bool logStateChanges = false; // If true, only records when a component's state changes
     public bool exportBinaries = true; // If true, exports .scn, .act, .rat, .cam files. If false, only records in memory (or not at all).
+    [Tooltip("Store a full component bitset once this many activation/deactivation events have accumulated, bounding how many events a seek replays")]
+    public int snapshotEventInterval = 64;
 
     [Header("Debug Info")]
     [SerializeField] private bool isRecording = false;
@@ -156,11 +177,14 @@ public class SceneController : MonoBehaviour
     [SerializeField] private int keyframeCount = 0;
 
     private List<TrackedComponent> trackedComponents = new List<TrackedComponent>();
-    private List<SceneKeyframeFloat> keyframes = new List<SceneKeyframeFloat>();
+    private List<SceneKeyframeData> keyframes = new List<SceneKeyframeData>();
+    private SceneComponentMask activeMask;
+    private int eventsSinceSnapshot;
+    private float recordingDuration;
     private float lastRecordTime = 0f;
 
     private const uint SCENE_FILE_MAGIC = 0x454E4353;  // "SCNE"
-    private const uint SCENE_FILE_VERSION = 1;
+    private const uint SCENE_FILE_VERSION = 2;
     private const int MAX_COMPONENT_NAME_LENGTH = 64;
     private const int MAX_COMPONENT_PATH_LENGTH = 256;
 
@@ -276,8 +300,10 @@ public class SceneController : MonoBehaviour
         keyframes.Clear();
         
         InitializeTrackedComponents();
+        activeMask = new SceneComponentMask(trackedComponents.Count);
+        eventsSinceSnapshot = 0;
         
-        // Record the initial state
+        // Record the initial state (activation events from an empty set, plus the first snapshot)
         RecordCurrentFrame();
     }
 
@@ -294,6 +320,7 @@ public class SceneController : MonoBehaviour
         
         // One final record to capture the end state
         RecordCurrentFrame();
+        recordingDuration = Time.time - recordingStartTime;
 
         if (keyframes.Count > 0 && exportBinaries)
         {
@@ -305,31 +332,35 @@ public class SceneController : MonoBehaviour
     }
     
     /// <summary>
-    /// Records the current state of all tracked components
+    /// Records the components whose state changed since the previous keyframe
     /// </summary>
     private void RecordCurrentFrame()
     {
         float currentTime = Time.time - recordingStartTime;
         
-        bool stateChanged = false;
+        List<uint> events = null;
         for (int i = 0; i < trackedComponents.Count; i++)
         {
-            if (trackedComponents[i].IsActive() != trackedComponents[i].wasActive)
+            var comp = trackedComponents[i];
+            bool active = comp.IsActive();
+            if (active != activeMask.Get(i))
             {
-                stateChanged = true;
-                break;
+                events ??= new List<uint>();
+                events.Add((uint)i | (active ? SceneKeyframeData.EventActivate : 0u));
+                activeMask.Set(i, active);
             }
+            comp.UpdateWasActive();
         }
 
         // Only add keyframe if there was a state change or if we're not just logging changes
-        if (stateChanged || !logStateChanges)
+        if (events != null || !logStateChanges || keyframes.Count == 0)
         {
-            SceneKeyframeFloat keyframe = new SceneKeyframeFloat(currentTime, trackedComponents.Count);
-            for (int i = 0; i < trackedComponents.Count; i++)
+            SceneKeyframeData keyframe = new SceneKeyframeData(currentTime, events != null ? events.ToArray() : Array.Empty<uint>());
+            eventsSinceSnapshot += keyframe.events.Length;
+            if (keyframes.Count == 0 || eventsSinceSnapshot >= Mathf.Max(1, snapshotEventInterval))
             {
-                var comp = trackedComponents[i];
-                keyframe.componentStates[i] = comp.IsActive();
-                comp.UpdateWasActive();
+                keyframe.snapshot = activeMask.Clone();
+                eventsSinceSnapshot = 0;
             }
             keyframes.Add(keyframe);
             keyframeCount = keyframes.Count;
@@ -412,8 +443,8 @@ public class SceneController : MonoBehaviour
         foreach (var recorder in particleRecorders)
         {
             recorder.exportBinary = exportBinaries;
-            // Particle systems reference their base filename .act files
-            string actPath = $"{recorder.baseFilename}.act";
+            // Particle systems reference their base filename .ptc stream, or .act files when baked
+            string actPath = recorder.exportInstanceStream ? $"{recorder.baseFilename}.ptc" : $"{recorder.baseFilename}.act";
             trackedComponents.Add(new TrackedComponent(recorder, recorder.gameObject.name, actPath, ComponentType.Actor, currentId++));
             
             Debug.Log($"Scene will reference particle system {recorder.gameObject.name}: {actPath}");
@@ -438,20 +469,40 @@ public class SceneController : MonoBehaviour
             using (FileStream fs = new FileStream(path, FileMode.Create))
             using (BinaryWriter writer = new BinaryWriter(fs))
             {
+                // --- Layout ---
+                int maskWords = SceneComponentMask.WordCount(trackedComponents.Count);
+                uint eventCount = 0;
+                uint snapshotCount = 0;
+                foreach (var keyframe in keyframes)
+                {
+                    eventCount += (uint)keyframe.events.Length;
+                    if (keyframe.snapshot.HasValue) snapshotCount++;
+                }
+
+                // Component entries are 323 bytes; pad so the uint32 tables after them can be used in place
+                uint componentDataSize = (uint)(Marshal.SizeOf(typeof(SceneComponentData)) * trackedComponents.Count);
+                uint keyframesOffset = ((uint)Marshal.SizeOf(typeof(SceneHeader)) + componentDataSize + 3u) & ~3u;
+                uint eventsOffset = keyframesOffset + (uint)keyframes.Count * (uint)Marshal.SizeOf(typeof(SceneKeyframeHeaderData));
+                uint snapshotsOffset = eventsOffset + eventCount * 4;
+
                 // --- Write Header ---
                 SceneHeader header = new SceneHeader
                 {
                     magic = SCENE_FILE_MAGIC,      // 'SCNE'
-                    version = SCENE_FILE_VERSION,    // Version 1
+                    version = SCENE_FILE_VERSION,    // Version 2
                     num_components = (uint)trackedComponents.Count,
                     num_keyframes = (uint)keyframes.Count,
                     framerate = recordingFPS,
-                    reserved = new byte[32]
+                    keyframes_offset = keyframesOffset,
+                    mask_words = (uint)maskWords,
+                    num_events = eventCount,
+                    num_snapshots = snapshotCount,
+                    snapshot_interval = (uint)Mathf.Max(1, snapshotEventInterval),
+                    events_offset = eventsOffset,
+                    snapshots_offset = snapshotsOffset,
+                    duration = recordingDuration,
+                    reserved = new byte[12]
                 };
-                
-                // Calculate offsets after header and component data
-                uint componentDataSize = (uint)(Marshal.SizeOf(typeof(SceneComponentData)) * trackedComponents.Count);
-                header.keyframes_offset = (uint)Marshal.SizeOf(typeof(SceneHeader)) + componentDataSize;
 
                 WriteStructure(writer, header);
 
@@ -467,30 +518,33 @@ public class SceneController : MonoBehaviour
                     };
                     WriteStructure(writer, sc);
                 }
+                while (fs.Position < keyframesOffset) writer.Write((byte)0);
 
                 // --- Write Keyframes ---
+                uint firstEvent = 0;
                 foreach (var keyframe in keyframes)
                 {
-                    int numMasks = (trackedComponents.Count + 31) / 32;
-                    uint[] activeMasks = new uint[numMasks];
-                    for (int i = 0; i < trackedComponents.Count; i++)
+                    WriteStructure(writer, new SceneKeyframeHeaderData { timestamp = keyframe.timestamp, first_event = firstEvent });
+                    firstEvent += (uint)keyframe.events.Length;
+                }
+
+                // --- Write Events ---
+                foreach (var keyframe in keyframes)
+                {
+                    foreach (uint e in keyframe.events)
                     {
-                        if (keyframe.componentStates[i])
-                        {
-                            activeMasks[i / 32] |= (1u << (i % 32));
-                        }
+                        writer.Write(e);
                     }
+                }
 
-                    SceneKeyframeHeaderData sk = new SceneKeyframeHeaderData
-                    {
-                        timestamp = keyframe.timestamp,
-                        active_mask_count = (uint)numMasks
-                    };
-                    WriteStructure(writer, sk);
-                    
-                    foreach(uint mask in activeMasks)
+                // --- Write Snapshots ---
+                for (int k = 0; k < keyframes.Count; k++)
+                {
+                    if (!keyframes[k].snapshot.HasValue) continue;
+                    writer.Write((uint)k);
+                    foreach (uint word in keyframes[k].snapshot.Value.words)
                     {
-                        writer.Write(mask);
+                        writer.Write(word);
                     }
                 }
             }
@@ -515,7 +569,9 @@ public class SceneController : MonoBehaviour
         FileLogger.LogSection("SCENE FILE EXPORT COMPLETE - DETAILED SUMMARY");
         
         FileInfo fileInfo = new FileInfo(filePath);
-        float recordingDuration = keyframes.Count > 0 ? keyframes[keyframes.Count - 1].timestamp : 0f;
+        int numMasks = SceneComponentMask.WordCount(trackedComponents.Count);
+        long eventCount = keyframes.Sum(k => (long)k.events.Length);
+        int snapshotCount = keyframes.Count(k => k.snapshot.HasValue);
 
         // File Information
         FileLogger.LogSection("FILE INFORMATION");
@@ -526,11 +582,12 @@ public class SceneController : MonoBehaviour
         // Header Information
         FileLogger.LogSection("HEADER STRUCTURE (64 bytes)");
         FileLogger.Log($"  Magic Number:           0x454E4353 (\"SCNE\")");
-        FileLogger.Log($"  Version:                1");
+        FileLogger.Log($"  Version:                {SCENE_FILE_VERSION}");
         FileLogger.Log($"  Total Components:       {trackedComponents.Count}");
         FileLogger.Log($"  Total Keyframes:        {keyframes.Count}");
         FileLogger.Log($"  Recording Framerate:    {recordingFPS} FPS");
-        FileLogger.Log($"  Keyframes Offset:       {Marshal.SizeOf(typeof(SceneHeader)) + (uint)(Marshal.SizeOf(typeof(SceneComponentData)) * trackedComponents.Count)} bytes");
+        FileLogger.Log($"  Mask Words:             {numMasks} uint32(s) per bitset");
+        FileLogger.Log($"  Events / Snapshots:     {eventCount:N0} / {snapshotCount} (snapshot every {Mathf.Max(1, snapshotEventInterval)} events)");
         
         // Component Information
         FileLogger.LogSection($"TRACKED COMPONENTS ({trackedComponents.Count} components)");
@@ -558,13 +615,14 @@ public class SceneController : MonoBehaviour
         // Keyframe Information
         FileLogger.LogSection($"KEYFRAME DATA ({keyframes.Count} keyframes)");
         
-        int numMasks = (trackedComponents.Count + 31) / 32;
-        uint keyframeDataSize = (uint)keyframes.Count * (8 + (uint)numMasks * 4);
+        long keyframeTableSize = (long)keyframes.Count * Marshal.SizeOf(typeof(SceneKeyframeHeaderData));
+        long eventsSize = eventCount * 4;
+        long snapshotsSize = (long)snapshotCount * (4 + numMasks * 4);
         
-        FileLogger.Log($"  Activation Mask Count:  {numMasks} uint32(s) per keyframe");
-        FileLogger.Log($"  Keyframe Struct Size:   8 bytes (timestamp + mask_count)");
-        FileLogger.Log($"  Mask Data Size:         {numMasks * 4} bytes per keyframe");
-        FileLogger.Log($"  Total Keyframe Data:    {keyframeDataSize:N0} bytes");
+        FileLogger.Log($"  Keyframe Struct Size:   8 bytes (timestamp + first_event)");
+        FileLogger.Log($"  Event Size:             4 bytes (component index | 0x80000000 on activation)");
+        FileLogger.Log($"  Snapshot Size:          {4 + numMasks * 4} bytes (keyframe index + bitset)");
+        FileLogger.Log($"  Total Keyframe Data:    {keyframeTableSize + eventsSize + snapshotsSize:N0} bytes");
         FileLogger.Log($"  Recording Duration:     {recordingDuration:F3} seconds");
         FileLogger.Log($"  Time Per Frame:         {(recordingDuration / keyframes.Count):F4} seconds");
         
@@ -575,44 +633,38 @@ public class SceneController : MonoBehaviour
         {
             var kf = keyframes[i];
             
-            string activeComponents = "";
-            for (int c = 0; c < trackedComponents.Count; c++)
-            {
-                if (kf.componentStates[c])
-                {
-                    activeComponents += $"{c} ";
-                }
-            }
-            
-            FileLogger.Log($"    [{i}] Time: {kf.timestamp:F3}s | Active Components: [{activeComponents.Trim()}]");
+            string changes = string.Join(" ", kf.events.Select(e => $"{((e & SceneKeyframeData.EventActivate) != 0 ? "+" : "-")}{e & SceneKeyframeData.EventIndexMask}"));
+            FileLogger.Log($"    [{i}] Time: {kf.timestamp:F3}s | Changes: [{changes}]{(kf.snapshot.HasValue ? " | snapshot" : "")}");
         }
         
-        if (keyframes.Count > 10)
+        if (keyframes.Count > 5)
         {
-            FileLogger.Log($"    ... ({keyframes.Count - 10} more keyframes) ...");
+            FileLogger.Log($"    ... ({keyframes.Count - 5} more keyframes) ...");
         }
         
         // File Structure Layout
         FileLogger.LogSection("BINARY FILE LAYOUT");
         long headerSize = Marshal.SizeOf(typeof(SceneHeader));
         long componentSize = trackedComponents.Count * Marshal.SizeOf(typeof(SceneComponentData));
-        long keyframesSize = keyframeDataSize;
-        long totalCalculated = headerSize + componentSize + keyframesSize;
+        long keyframesOffset = (headerSize + componentSize + 3) & ~3L;
+        long totalCalculated = keyframesOffset + keyframeTableSize + eventsSize + snapshotsSize;
         
         FileLogger.Log($"  Offset 0x00:            Header ({headerSize} bytes)");
         FileLogger.Log($"  Offset 0x{headerSize:X2}:            Components ({componentSize:N0} bytes, {trackedComponents.Count} entries × {Marshal.SizeOf(typeof(SceneComponentData))} bytes each)");
-        FileLogger.Log($"  Offset 0x{headerSize + componentSize:X2}:            Keyframes ({keyframesSize:N0} bytes, {keyframes.Count} entries)");
+        FileLogger.Log($"  Offset 0x{keyframesOffset:X2}:            Keyframes ({keyframeTableSize:N0} bytes, {keyframes.Count} entries)");
+        FileLogger.Log($"  Offset 0x{keyframesOffset + keyframeTableSize:X2}:            Events ({eventsSize:N0} bytes, {eventCount:N0} entries)");
+        FileLogger.Log($"  Offset 0x{keyframesOffset + keyframeTableSize + eventsSize:X2}:            Snapshots ({snapshotsSize:N0} bytes, {snapshotCount} entries)");
         FileLogger.Log($"  Total Calculated:       {totalCalculated:N0} bytes");
         FileLogger.Log($"  Actual File Size:       {fileInfo.Length:N0} bytes");
     FileLogger.Log($"  Match:                  {(totalCalculated == fileInfo.Length ? "<color=green>OK</color>" : "<color=red>NO</color>")}");
         
         // Memory Efficiency
         FileLogger.LogSection("COMPRESSION & EFFICIENCY");
-        float bitsPerComponent = (keyframes.Count * numMasks * 32) / (float)trackedComponents.Count;
-        float compressionRatio = 1.0f - (fileInfo.Length / (float)(keyframes.Count * trackedComponents.Count * 4));
+        long fullMaskSize = (long)keyframes.Count * (8 + numMasks * 4);
         
-        FileLogger.Log($"  Bits per Component per Frame: {bitsPerComponent:F1}");
-        FileLogger.Log($"  Compression Ratio:      {(1.0f - compressionRatio) * 100:F1}% reduction from uncompressed");
+        FileLogger.Log($"  Events per Keyframe:    {eventCount / (float)Mathf.Max(1, keyframes.Count):F2}");
+        FileLogger.Log($"  Full Bitset per Keyframe (v1): {fullMaskSize:N0} bytes");
+        FileLogger.Log($"  Events + Snapshots (v2): {keyframeTableSize + eventsSize + snapshotsSize:N0} bytes");
         FileLogger.Log($"  Bytes per Keyframe:     {fileInfo.Length / (float)keyframes.Count:F1}");
         
         // Component References
@@ -42,13 +42,15 @@ public static class TextureProcessor
     /// <param name="targetFormat">Target format (or Auto for automatic selection)</param>
     /// <param name="maxSize">Maximum texture size override (0 = use format default)</param>
     /// <param name="enablePalettes">Allow palette-based formats (CI4/CI8)</param>
+    /// <param name="dither">Dithering for CI4/CI8 palette mapping; RGBA16 uses ordered dithering for anything but None</param>
     /// <returns>Information about the processed texture format</returns>
     public static TextureFormatInfo ProcessAndOptimizeTexture(
         Texture2D sourceTexture, 
         string outputPath, 
         OptimizedTextureFormat targetFormat = OptimizedTextureFormat.Auto,
         int maxSize = 0,
-        bool enablePalettes = true)
+        bool enablePalettes = true,
+        PaletteQuantizer.Dither dither = PaletteQuantizer.Dither.None)
     {
         if (sourceTexture == null)
         {
@@ -64,10 +66,10 @@ public static class TextureProcessor
             var formatInfo = DetermineOptimalFormat(sourceTexture, targetFormat, maxSize, enablePalettes);
 
             // Create optimized texture
-            Texture2D optimizedTexture = CreateOptimizedTexture(sourceTexture, formatInfo);
+            Texture2D optimizedTexture = CreateOptimizedTexture(sourceTexture, formatInfo, dither, out Color32[] palette);
 
             // Save optimized texture
-            SaveOptimizedTexture(optimizedTexture, outputPath, formatInfo);
+            SaveOptimizedTexture(optimizedTexture, outputPath, formatInfo, palette);
 
             // Cleanup
             if (Application.isPlaying)
@@ -193,8 +195,10 @@ public static class TextureProcessor
     /// <summary>
     /// Create optimized texture with specified format and size
     /// </summary>
-    private static Texture2D CreateOptimizedTexture(Texture2D sourceTexture, TextureFormatInfo formatInfo)
+    private static Texture2D CreateOptimizedTexture(Texture2D sourceTexture, TextureFormatInfo formatInfo, PaletteQuantizer.Dither dither, out Color32[] palette)
     {
+        palette = null;
+
         // Make source texture readable
         Texture2D readableTexture = MakeTextureReadable(sourceTexture);
 
@@ -206,16 +210,16 @@ public static class TextureProcessor
         switch (formatInfo.format)
         {
             case OptimizedTextureFormat.RGBA16:
-                optimizedTexture = ConvertToRGBA16(resizedTexture);
+                optimizedTexture = ConvertToRGBA16(resizedTexture, dither != PaletteQuantizer.Dither.None);
                 break;
             case OptimizedTextureFormat.RGBA32:
                 optimizedTexture = ConvertToRGBA32(resizedTexture);
                 break;
             case OptimizedTextureFormat.CI8:
-                optimizedTexture = ConvertToCI8(resizedTexture);
+                optimizedTexture = ConvertToPalette(resizedTexture, 256, dither, out palette);
                 break;
             case OptimizedTextureFormat.CI4:
-                optimizedTexture = ConvertToCI4(resizedTexture);
+                optimizedTexture = ConvertToPalette(resizedTexture, 16, dither, out palette);
                 break;
             default:
                 optimizedTexture = resizedTexture;
@@ -316,165 +320,79 @@ public static class TextureProcessor
     /// <summary>
     /// Convert texture to RGBA16 format (5551)
     /// </summary>
-    private static Texture2D ConvertToRGBA16(Texture2D sourceTexture)
+    private static Texture2D ConvertToRGBA16(Texture2D sourceTexture, bool dither)
     {
-        Color[] pixels = sourceTexture.GetPixels();
+        Color32[] pixels = sourceTexture.GetPixels32();
+        int width = sourceTexture.width;
 
-        // Convert to 5551 format (5 bits R, 5 bits G, 5 bits B, 1 bit A)
+        // Convert to 5551 format (5 bits R, 5 bits G, 5 bits B, 1 bit A) and back with the same rounding, Bayer
+        // thresholds and bit replication as texel_encode/texel_decode (Assets/Ziz/texel.c), so the saved PNG shows
+        // what the runtime samples
         for (int i = 0; i < pixels.Length; i++)
         {
-            Color pixel = pixels[i];
-            
-            // Quantize to 5 bits (0-31) for RGB and 1 bit for Alpha
-            float r = Mathf.RoundToInt(pixel.r * 31f) / 31f;
-            float g = Mathf.RoundToInt(pixel.g * 31f) / 31f;
-            float b = Mathf.RoundToInt(pixel.b * 31f) / 31f;
-            float a = pixel.a > 0.5f ? 1f : 0f;
-            
-            // Convert back to float
-            pixels[i] = new Color(r, g, b, a);
+            Color32 pixel = pixels[i];
+            int threshold = dither ? 2 * BayerMatrix[(i / width) & 3, (i % width) & 3] + 1 : 16;
+
+            pixels[i] = new Color32(
+                Expand5(Reduce(pixel.r, 31, threshold)),
+                Expand5(Reduce(pixel.g, 31, threshold)),
+                Expand5(Reduce(pixel.b, 31, threshold)),
+                pixel.a >= 128 ? (byte)255 : (byte)0);
         }
 
         Texture2D convertedTexture = new Texture2D(sourceTexture.width, sourceTexture.height, TextureFormat.RGBA32, false);
-        convertedTexture.SetPixels(pixels);
+        convertedTexture.SetPixels32(pixels);
         convertedTexture.Apply();
 
         return convertedTexture;
     }
 
+    private static readonly int[,] BayerMatrix =
+    {
+        { 0, 8, 2, 10 },
+        { 12, 4, 14, 6 },
+        { 3, 11, 1, 9 },
+        { 15, 7, 13, 5 }
+    };
+
     /// <summary>
-    /// Convert texture to RGBA32 format (full quality)
+    /// floor(value * levels / 255 + threshold / 32); threshold 16 rounds to the nearest level
     /// </summary>
-    private static Texture2D ConvertToRGBA32(Texture2D sourceTexture)
+    private static int Reduce(int value, int levels, int threshold)
     {
-        // RGBA32 is already full quality, just ensure format
-        Texture2D convertedTexture = new Texture2D(sourceTexture.width, sourceTexture.height, TextureFormat.RGBA32, false);
-        convertedTexture.SetPixels(sourceTexture.GetPixels());
-        convertedTexture.Apply();
+        return (value * levels * 32 + threshold * 255) / 8160;
+    }
 
-        return convertedTexture;
+    private static byte Expand5(int level)
+    {
+        return (byte)((level << 3) | (level >> 2));
     }
 
     /// <summary>
-    /// Convert texture to CI8 format (256 color palette)
+    /// Convert texture to RGBA32 format (full quality)
     /// </summary>
-    private static Texture2D ConvertToCI8(Texture2D sourceTexture)
+    private static Texture2D ConvertToRGBA32(Texture2D sourceTexture)
     {
-        // Simple color quantization to 256 colors
-        Color[] pixels = sourceTexture.GetPixels();
-        Dictionary<Color, int> colorPalette = new Dictionary<Color, int>();
-        List<Color> paletteColors = new List<Color>();
-
-        // Build palette (simplified - just quantize each channel to reduce colors)
-        foreach (Color pixel in pixels)
-        {
-            // Quantize to reduce color space
-            Color quantized = new Color(
-                Mathf.Round(pixel.r * 15) / 15f,
-                Mathf.Round(pixel.g * 15) / 15f,
-                Mathf.Round(pixel.b * 15) / 15f,
-                Mathf.Round(pixel.a * 3) / 3f
-            );
-
-            if (!colorPalette.ContainsKey(quantized) && paletteColors.Count < 256)
-            {
-                colorPalette[quantized] = paletteColors.Count;
-                paletteColors.Add(quantized);
-            }
-        }
-
-        Debug.Log($"CI8 palette has {paletteColors.Count} colors");
-
-        // Map pixels to palette
-        for (int i = 0; i < pixels.Length; i++)
-        {
-            Color quantized = new Color(
-                Mathf.Round(pixels[i].r * 15) / 15f,
-                Mathf.Round(pixels[i].g * 15) / 15f,
-                Mathf.Round(pixels[i].b * 15) / 15f,
-                Mathf.Round(pixels[i].a * 3) / 3f
-            );
-
-            if (colorPalette.ContainsKey(quantized))
-            {
-                pixels[i] = paletteColors[colorPalette[quantized]];
-            }
-            else
-            {
-                // Find closest color in palette
-                float minDistance = float.MaxValue;
-                Color closestColor = paletteColors[0];
-
-                foreach (Color paletteColor in paletteColors)
-                {
-                    float distance = Vector4.Distance(
-                        new Vector4(quantized.r, quantized.g, quantized.b, quantized.a),
-                        new Vector4(paletteColor.r, paletteColor.g, paletteColor.b, paletteColor.a)
-                    );
-
-                    if (distance < minDistance)
-                    {
-                        minDistance = distance;
-                        closestColor = paletteColor;
-                    }
-                }
-
-                pixels[i] = closestColor;
-            }
-        }
-
+        // RGBA32 is already full quality, just ensure format
         Texture2D convertedTexture = new Texture2D(sourceTexture.width, sourceTexture.height, TextureFormat.RGBA32, false);
-        convertedTexture.SetPixels(pixels);
+        convertedTexture.SetPixels32(sourceTexture.GetPixels32());
         convertedTexture.Apply();
 
         return convertedTexture;
     }
 
     /// <summary>
-    /// Convert texture to CI4 format (16 color palette)
+    /// Convert texture to a CI8 (256 colors) or CI4 (16 colors) palette, see <see cref="PaletteQuantizer"/>
     /// </summary>
-    private static Texture2D ConvertToCI4(Texture2D sourceTexture)
+    private static Texture2D ConvertToPalette(Texture2D sourceTexture, int maxColors, PaletteQuantizer.Dither dither, out Color32[] palette)
     {
-        // Simple color quantization to 16 colors
-        Color[] pixels = sourceTexture.GetPixels();
-
-        // Pre-defined 16-color palette (can be customized)
-        Color[] palette = new Color[16]
-        {
-            Color.black, Color.white, Color.red, Color.green,
-            Color.blue, Color.yellow, Color.cyan, Color.magenta,
-            new Color(0.5f, 0.5f, 0.5f), new Color(0.25f, 0.25f, 0.25f),
-            new Color(0.75f, 0.75f, 0.75f), new Color(1f, 0.5f, 0f),
-            new Color(0.5f, 0f, 0.5f), new Color(0f, 0.5f, 0.5f),
-            new Color(0.5f, 0.5f, 0f), new Color(0.75f, 0.25f, 0.25f)
-        };
-
-        // Map each pixel to closest palette color
-        for (int i = 0; i < pixels.Length; i++)
-        {
-            Color pixel = pixels[i];
-            float minDistance = float.MaxValue;
-            Color closestColor = palette[0];
-
-            foreach (Color paletteColor in palette)
-            {
-                float distance = Vector4.Distance(
-                    new Vector4(pixel.r, pixel.g, pixel.b, pixel.a),
-                    new Vector4(paletteColor.r, paletteColor.g, paletteColor.b, paletteColor.a)
-                );
+        var result = PaletteQuantizer.Quantize(sourceTexture.GetPixels32(), sourceTexture.width, sourceTexture.height, maxColors, dither);
+        palette = result.palette;
 
-                if (distance < minDistance)
-                {
-                    minDistance = distance;
-                    closestColor = paletteColor;
-                }
-            }
-
-            pixels[i] = closestColor;
-        }
+        Debug.Log($"{(maxColors <= 16 ? "CI4" : "CI8")} palette: {result}");
 
         Texture2D convertedTexture = new Texture2D(sourceTexture.width, sourceTexture.height, TextureFormat.RGBA32, false);
-        convertedTexture.SetPixels(pixels);
+        convertedTexture.SetPixels32(result.pixels);
         convertedTexture.Apply();
 
         return convertedTexture;
@@ -483,7 +401,7 @@ public static class TextureProcessor
     /// <summary>
     /// Save optimized texture to file
     /// </summary>
-    private static void SaveOptimizedTexture(Texture2D texture, string filePath, TextureFormatInfo formatInfo)
+    private static void SaveOptimizedTexture(Texture2D texture, string filePath, TextureFormatInfo formatInfo, Color32[] palette)
     {
         byte[] pngData = texture.EncodeToPNG();
         File.WriteAllBytes(filePath, pngData);
@@ -491,47 +409,35 @@ public static class TextureProcessor
     Debug.Log($"<color=blue>Saved</color> optimized texture: {Path.GetFileName(filePath)} ({pngData.Length} bytes)");
 
         // Also save palette information for CI formats
-        if (formatInfo.supportsPalette)
+        if (formatInfo.supportsPalette && palette != null)
         {
-            SavePaletteInfo(filePath, texture, formatInfo);
+            SavePaletteInfo(filePath, palette, formatInfo);
         }
     }
 
     /// <summary>
     /// Save palette information for CI formats
     /// </summary>
-    private static void SavePaletteInfo(string texturePath, Texture2D texture, TextureFormatInfo formatInfo)
+    private static void SavePaletteInfo(string texturePath, Color32[] palette, TextureFormatInfo formatInfo)
     {
         string paletteFilename = Path.ChangeExtension(texturePath, ".pal");
 
-        // Extract unique colors as palette
-        HashSet<Color> uniqueColors = new HashSet<Color>();
-        Color[] pixels = texture.GetPixels();
-
-        foreach (Color pixel in pixels)
-        {
-            uniqueColors.Add(pixel);
-            if (uniqueColors.Count >= (formatInfo.format == OptimizedTextureFormat.CI4 ? 16 : 256))
-                break;
-        }
-
-        // Save palette as simple text file
+        // Save palette as simple text file, in the quantizer's index order
         using (StreamWriter writer = new StreamWriter(paletteFilename))
         {
             writer.WriteLine($"# Palette for {Path.GetFileName(texturePath)}");
             writer.WriteLine($"# Format: {formatInfo.format}");
-            writer.WriteLine($"# Colors: {uniqueColors.Count}");
+            writer.WriteLine($"# Colors: {palette.Length}");
             writer.WriteLine("# Format: R G B A (0-255)");
 
-            int index = 0;
-            foreach (Color color in uniqueColors)
+            for (int index = 0; index < palette.Length; index++)
             {
-                writer.WriteLine($"{index:D3}: {(int)(color.r * 255):D3} {(int)(color.g * 255):D3} {(int)(color.b * 255):D3} {(int)(color.a * 255):D3}");
-                index++;
+                Color32 color = palette[index];
+                writer.WriteLine($"{index:D3}: {color.r:D3} {color.g:D3} {color.b:D3} {color.a:D3}");
             }
         }
 
-        Debug.Log($"📋 Saved palette: {Path.GetFileName(paletteFilename)} ({uniqueColors.Count} colors)");
+        Debug.Log($"📋 Saved palette: {Path.GetFileName(paletteFilename)} ({palette.Length} colors)");
     }
 
     /// <summary>
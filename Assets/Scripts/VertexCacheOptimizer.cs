@@ -0,0 +1,215 @@
+using System;
+using System.Collections.Generic;
+
+/// <summary>
+/// Export-time triangle and vertex reordering for post-transform vertex cache reuse
+/// (Tom Forsyth's linear-speed vertex cache optimisation), plus ACMR reporting.
+/// ACMR = vertices transformed per triangle with a FIFO cache; 0.5 is the ideal for a regular grid, 3.0 the worst case.
+/// </summary>
+public static class VertexCacheOptimizer
+{
+    /// <summary>
+    /// Cache size used for ACMR reports. Small on purpose: the N64 RSP vertex buffer holds 32 entries but
+    /// microcode loads it in batches, and software renderers rarely keep more than a handful of transformed vertices.
+    /// </summary>
+    public const int DefaultCacheSize = 16;
+
+    // Forsyth scoring constants
+    private const int ScoringCacheSize = 32;
+    private const float CacheDecayPower = 1.5f;
+    private const float LastTriScore = 0.75f;
+    private const float ValenceBoostScale = 2.0f;
+    private const float ValenceBoostPower = 0.5f;
+
+    /// <summary>
+    /// Average cache miss ratio (vertices transformed per triangle) for a triangle list with a FIFO cache.
+    /// </summary>
+    public static float ComputeACMR(int[] indices, int cacheSize = DefaultCacheSize)
+    {
+        if (indices == null || indices.Length < 3) return 0f;
+        var fifo = new Queue<int>(cacheSize);
+        var inCache = new HashSet<int>();
+        int misses = 0;
+        foreach (int index in indices)
+        {
+            if (inCache.Contains(index)) continue;
+            misses++;
+            fifo.Enqueue(index);
+            inCache.Add(index);
+            if (fifo.Count > cacheSize) inCache.Remove(fifo.Dequeue());
+        }
+        return misses / (float)(indices.Length / 3);
+    }
+
+    /// <summary>
+    /// Returns a new triangle list with the same triangles reordered for vertex cache reuse.
+    /// Vertex indices are unchanged, so the result can replace the original in any file that shares vertex order
+    /// with its animation data. Winding within each triangle is preserved.
+    /// </summary>
+    public static int[] OptimizeTriangleOrder(int[] indices, int vertexCount)
+    {
+        int triCount = indices.Length / 3;
+        if (triCount <= 1) return (int[])indices.Clone();
+
+        // Vertex -> triangle adjacency (CSR layout)
+        var valence = new int[vertexCount];
+        foreach (int index in indices) valence[index]++;
+        var adjStart = new int[vertexCount + 1];
+        for (int v = 0; v < vertexCount; v++) adjStart[v + 1] = adjStart[v] + valence[v];
+        var adjacency = new int[adjStart[vertexCount]];
+        var fill = new int[vertexCount];
+        for (int t = 0; t < triCount; t++)
+        {
+            for (int k = 0; k < 3; k++)
+            {
+                int v = indices[t * 3 + k];
+                adjacency[adjStart[v] + fill[v]++] = t;
+            }
+        }
+
+        var remaining = (int[])valence.Clone();   // triangles not yet emitted, per vertex
+        var cachePos = new int[vertexCount];
+        for (int v = 0; v < vertexCount; v++) cachePos[v] = -1;
+        var vertexScore = new float[vertexCount];
+        for (int v = 0; v < vertexCount; v++) vertexScore[v] = VertexScore(cachePos[v], remaining[v]);
+
+        var triScore = new float[triCount];
+        var emitted = new bool[triCount];
+        for (int t = 0; t < triCount; t++)
+        {
+            triScore[t] = vertexScore[indices[t * 3]] + vertexScore[indices[t * 3 + 1]] + vertexScore[indices[t * 3 + 2]];
+        }
+
+        var cache = new List<int>(ScoringCacheSize + 3);
+        var result = new int[triCount * 3];
+        int scanCursor = 0;
+        int bestTri = 0;
+        for (int t = 1; t < triCount; t++) if (triScore[t] > triScore[bestTri]) bestTri = t;
+
+        for (int outTri = 0; outTri < triCount; outTri++)
+        {
+            if (bestTri < 0)
+            {
+                // Nothing adjacent to the cache is left; take the best remaining triangle
+                float best = -1f;
+                for (int t = scanCursor; t < triCount; t++)
+                {
+                    if (emitted[t]) { if (t == scanCursor) scanCursor++; continue; }
+                    if (triScore[t] > best) { best = triScore[t]; bestTri = t; }
+                }
+            }
+
+            emitted[bestTri] = true;
+            for (int k = 0; k < 3; k++)
+            {
+                int v = indices[bestTri * 3 + k];
+                result[outTri * 3 + k] = v;
+                remaining[v]--;
+
+                // Remove the emitted triangle from this vertex's live adjacency so scoring only sees pending ones
+                int end = adjStart[v] + remaining[v];
+                for (int a = adjStart[v]; a <= end; a++)
+                {
+                    if (adjacency[a] == bestTri) { adjacency[a] = adjacency[end]; adjacency[end] = bestTri; break; }
+                }
+
+                // Move to the front of the LRU cache
+                cache.Remove(v);
+                cache.Insert(0, v);
+            }
+
+            // Rescore every vertex in (or just evicted from) the cache and collect the triangles they touch
+            for (int i = 0; i < cache.Count; i++)
+            {
+                int v = cache[i];
+                cachePos[v] = (i < ScoringCacheSize) ? i : -1;
+                vertexScore[v] = VertexScore(cachePos[v], remaining[v]);
+            }
+            if (cache.Count > ScoringCacheSize) cache.RemoveRange(ScoringCacheSize, cache.Count - ScoringCacheSize);
+
+            bestTri = -1;
+            float bestScore = -1f;
+            foreach (int v in cache)
+            {
+                for (int a = adjStart[v]; a < adjStart[v] + remaining[v]; a++)
+                {
+                    int t = adjacency[a];
+                    float score = vertexScore[indices[t * 3]] + vertexScore[indices[t * 3 + 1]] + vertexScore[indices[t * 3 + 2]];
+                    triScore[t] = score;
+                    if (score > bestScore) { bestScore = score; bestTri = t; }
+                }
+            }
+        }
+        return result;
+    }
+
+    /// <summary>
+    /// Builds a vertex permutation in first-use order of <paramref name="indices"/>, so vertices fetched together sit
+    /// together in memory (and in RAT delta streams). Unreferenced vertices keep their relative order at the end.
+    /// <paramref name="oldToNew"/> maps source vertex to output slot; the returned array maps output slot to source vertex.
+    /// </summary>
+    public static int[] BuildFirstUseVertexOrder(int[] indices, int vertexCount, out int[] oldToNew)
+    {
+        oldToNew = new int[vertexCount];
+        for (int v = 0; v < vertexCount; v++) oldToNew[v] = -1;
+        var newToOld = new int[vertexCount];
+        int next = 0;
+        foreach (int index in indices)
+        {
+            if (oldToNew[index] >= 0) continue;
+            oldToNew[index] = next;
+            newToOld[next++] = index;
+        }
+        for (int v = 0; v < vertexCount; v++)
+        {
+            if (oldToNew[v] >= 0) continue;
+            oldToNew[v] = next;
+            newToOld[next++] = v;
+        }
+        return newToOld;
+    }
+
+    /// <summary>
+    /// Applies a permutation from <see cref="BuildFirstUseVertexOrder"/> to a per-vertex array.
+    /// </summary>
+    public static T[] PermuteVertices<T>(T[] source, int[] newToOld)
+    {
+        if (source == null || source.Length != newToOld.Length) return source;
+        var result = new T[source.Length];
+        for (int i = 0; i < newToOld.Length; i++) result[i] = source[newToOld[i]];
+        return result;
+    }
+
+    /// <summary>
+    /// Rewrites a triangle list through a vertex permutation (old index -> new index).
+    /// </summary>
+    public static int[] RemapIndices(int[] indices, int[] oldToNew)
+    {
+        var result = new int[indices.Length];
+        for (int i = 0; i < indices.Length; i++) result[i] = oldToNew[indices[i]];
+        return result;
+    }
+
+    private static float VertexScore(int cachePosition, int remainingTriangles)
+    {
+        if (remainingTriangles == 0) return -1f;
+
+        float score = 0f;
+        if (cachePosition >= 0)
+        {
+            if (cachePosition < 3)
+            {
+                // The last triangle's vertices get a fixed score so the next triangle does not just reuse its edge
+                score = LastTriScore;
+            }
+            else
+            {
+                float scaler = 1.0f / (ScoringCacheSize - 3);
+                score = (float)Math.Pow(1.0f - (cachePosition - 3) * scaler, CacheDecayPower);
+            }
+        }
+        // Favour vertices with few triangles left so isolated ones are finished off early
+        score += ValenceBoostScale * (float)Math.Pow(remainingTriangles, -ValenceBoostPower);
+        return score;
+    }
+}
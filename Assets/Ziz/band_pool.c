@@ -0,0 +1,129 @@
+#include "band_pool.h"
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+struct band_pool {
+    const band_pool_work* work;
+    uint32_t* first_band;        // count + 1 prefix sums of bands per job
+    uint32_t next;
+    int result;
+#if defined(_WIN32)
+    CRITICAL_SECTION lock;
+#else
+    pthread_mutex_t lock;
+#endif
+};
+
+#if defined(_WIN32)
+void band_pool_lock(band_pool* pool) { EnterCriticalSection(&pool->lock); }
+void band_pool_unlock(band_pool* pool) { LeaveCriticalSection(&pool->lock); }
+#else
+void band_pool_lock(band_pool* pool) { pthread_mutex_lock(&pool->lock); }
+void band_pool_unlock(band_pool* pool) { pthread_mutex_unlock(&pool->lock); }
+#endif
+
+static void band_pool_fail(band_pool* pool, int result)
+{
+    band_pool_lock(pool);
+    pool->result = result;
+    band_pool_unlock(pool);
+}
+
+static void band_pool_work_bands(band_pool* pool)
+{
+    const band_pool_work* work = pool->work;
+    void* scratch = NULL;
+    if (work->scratch_bytes) {
+        scratch = malloc(work->scratch_bytes);
+        if (!scratch) {
+            band_pool_fail(pool, work->memory_error);
+            return;
+        }
+    }
+
+    uint32_t total = pool->first_band[work->count];
+    for (;;) {
+        band_pool_lock(pool);
+        uint32_t band = pool->next++;
+        band_pool_unlock(pool);
+        if (band >= total) break;
+
+        // The last job starting at or before band; jobs without bands share their first_band with the next one
+        uint32_t lo = 0, hi = work->count;
+        while (hi - lo > 1) {
+            uint32_t mid = lo + (hi - lo) / 2;
+            if (pool->first_band[mid] <= band) lo = mid;
+            else hi = mid;
+        }
+        int result = work->run(pool, work->user, scratch, lo, band - pool->first_band[lo]);
+        if (result) band_pool_fail(pool, result);
+    }
+    free(scratch);
+}
+
+#if defined(_WIN32)
+static DWORD WINAPI band_pool_thread(LPVOID arg) { band_pool_work_bands((band_pool*)arg); return 0; }
+#else
+static void* band_pool_thread(void* arg) { band_pool_work_bands((band_pool*)arg); return NULL; }
+#endif
+
+int band_pool_run(const band_pool_work* work, uint32_t threads)
+{
+    band_pool pool;
+    memset(&pool, 0, sizeof(pool));
+    pool.first_band = (uint32_t*)malloc(((size_t)work->count + 1) * sizeof(uint32_t));
+    if (!pool.first_band) return work->memory_error;
+    pool.first_band[0] = 0;
+    for (uint32_t j = 0; j < work->count; j++) pool.first_band[j + 1] = pool.first_band[j] + work->bands(work->user, j);
+    pool.work = work;
+
+    uint32_t total = pool.first_band[work->count];
+    if (threads > total) threads = total;
+    if (threads < 1) threads = 1;
+
+#if defined(_WIN32)
+    InitializeCriticalSection(&pool.lock);
+    HANDLE* helpers = (HANDLE*)calloc(threads, sizeof(HANDLE));
+#else
+    pthread_mutex_init(&pool.lock, NULL);
+    pthread_t* helpers = (pthread_t*)calloc(threads, sizeof(pthread_t));
+    int* started = (int*)calloc(threads, sizeof(int));
+    if (!started) threads = 1;
+#endif
+    if (!helpers) threads = 1;
+
+    for (uint32_t t = 1; t < threads; t++) {
+#if defined(_WIN32)
+        helpers[t] = CreateThread(NULL, 0, band_pool_thread, &pool, 0, NULL);
+#else
+        started[t] = pthread_create(&helpers[t], NULL, band_pool_thread, &pool) == 0;
+#endif
+    }
+    band_pool_work_bands(&pool);
+    for (uint32_t t = 1; t < threads; t++) {
+#if defined(_WIN32)
+        if (helpers[t]) {
+            WaitForSingleObject(helpers[t], INFINITE);
+            CloseHandle(helpers[t]);
+        }
+#else
+        if (started[t]) pthread_join(helpers[t], NULL);
+#endif
+    }
+
+#if defined(_WIN32)
+    DeleteCriticalSection(&pool.lock);
+#else
+    pthread_mutex_destroy(&pool.lock);
+    free(started);
+#endif
+    free(helpers);
+    free(pool.first_band);
+    return pool.result;
+}
@@ -0,0 +1,43 @@
+#ifndef BAND_POOL_H
+#define BAND_POOL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Short-lived thread pool for the batch bakers (sdf_bake, matcap_bake): every job of a batch is cut into bands of
+// rows, and threads take the next band of the batch until none are left.
+//
+//   band_pool_work work;
+//   memset(&work, 0, sizeof(work));
+//   work.count = count;
+//   work.bands = my_bands;                      // bands of job j
+//   work.run = my_band;                         // bakes band b of job j
+//   work.user = jobs;
+//   work.scratch_bytes = max_width * 4 * TILE;
+//   work.memory_error = MY_ERR_MEMORY;
+//   int result = band_pool_run(&work, threads);
+//
+// Bands are handed out in batch order, so one big job spreads over every thread and a batch of small ones doesn't
+// leave threads idle. The caller's thread works too, and band_pool_run returns once every band is done.
+
+typedef struct band_pool band_pool;
+
+typedef struct band_pool_work {
+    uint32_t count;              // jobs
+    uint32_t (*bands)(void* user, uint32_t job);    // called once per job, before any band runs
+    // Runs one band of one job. A nonzero result is returned by band_pool_run (the last one, if several); the other
+    // bands still run.
+    int (*run)(band_pool* pool, void* user, void* scratch, uint32_t job, uint32_t band);
+    void* user;
+    size_t scratch_bytes;        // per thread, passed to every band it runs; 0 for none
+    int memory_error;            // result if the pool or a thread's scratch can't be allocated
+} band_pool_work;
+
+// Runs every band with up to threads threads, the caller's included. 0 or a nonzero result, as above.
+int band_pool_run(const band_pool_work* work, uint32_t threads);
+
+// One lock per run, for state that bands share
+void band_pool_lock(band_pool* pool);
+void band_pool_unlock(band_pool* pool);
+
+#endif
@@ -0,0 +1,264 @@
+#include "cam0.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define CAM0_SSE 1
+#include <xmmintrin.h>
+#endif
+
+#define CAM0_KEYFRAME_SIZE 13
+#define CAM0_DEFAULT_FOV 60.0f
+#define CAM0_PI 3.14159265358979f
+
+static uint32_t cam0_read_u32(const uint8_t* p) { return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24; }
+static int16_t cam0_read_i16(const uint8_t* p) { return (int16_t)(uint16_t)(p[0] | p[1] << 8); }
+static float cam0_read_f32(const uint8_t* p) { uint32_t u = cam0_read_u32(p); float f; memcpy(&f, &u, 4); return f; }
+
+// out = a * b
+static void cam0_quat_mul(float out[4], const float a[4], const float b[4])
+{
+    out[0] = a[3] * b[0] + a[0] * b[3] + a[1] * b[2] - a[2] * b[1];
+    out[1] = a[3] * b[1] - a[0] * b[2] + a[1] * b[3] + a[2] * b[0];
+    out[2] = a[3] * b[2] + a[0] * b[1] - a[1] * b[0] + a[2] * b[3];
+    out[3] = a[3] * b[3] - a[0] * b[0] - a[1] * b[1] - a[2] * b[2];
+}
+
+// Dequantizes four keyframes per step: value = raw * scale + offset on each of the six 16-bit channels, then turns the
+// half angles into quaternions. Unity's Euler order is Z, X, Y (R = Ry * Rx * Rz); mirroring Z turns that into
+// Ry(-y) * Rx(-x) * Rz(z), and the signs are folded into the per-channel scales.
+static void cam0_decode(cam0_track* track, const uint8_t* keys, const float pos_min[3], const float pos_max[3],
+                        float* pos[3], float* rot[4], float* fov)
+{
+    float scale[6], offset[6];
+    for (int i = 0; i < 3; i++) {
+        // min >= max means the writer stored 0 for a constant axis; the formula then gives min
+        scale[i] = (pos_max[i] - pos_min[i]) / 65535.0f;
+        offset[i] = pos_min[i] + 32768.0f * scale[i];
+    }
+    // Raw angles are 0..360 degrees over 0..65535; keep half angles in radians
+    int unity_rot = (track->flags & CAM0_FLAG_FLIP_Z) && (track->flags & CAM0_FLAG_FLIP_ROT_WITH_Z);
+    float half = CAM0_PI / 65535.0f;
+    scale[3] = unity_rot ? half : -half;    // yaw: exported -y, stored -y when rotations were flipped
+    scale[4] = -half;                       // pitch: exported -x
+    scale[5] = unity_rot ? -half : half;    // roll: exported z, stored -z when rotations were flipped
+    for (int i = 3; i < 6; i++) offset[i] = 32768.0f * scale[i];
+    if (!(track->flags & CAM0_FLAG_FLIP_Z)) { scale[2] = -scale[2]; offset[2] = -offset[2]; }
+
+    for (uint32_t base = 0; base < track->keyframe_count; base += 4) {
+        // Gather: the 13-byte stride rules out vector loads
+        float raw[6][4] = { { 0 } };
+        uint32_t lanes = track->keyframe_count - base < 4 ? track->keyframe_count - base : 4;
+        for (uint32_t l = 0; l < lanes; l++) {
+            const uint8_t* key = keys + (size_t)(base + l) * CAM0_KEYFRAME_SIZE;
+            for (int c = 0; c < 6; c++) raw[c][l] = (float)cam0_read_i16(key + c * 2);
+            fov[base + l] = key[12] ? (float)key[12] : CAM0_DEFAULT_FOV;
+        }
+
+        float angle[3][4];
+        for (int c = 0; c < 6; c++) {
+            float* out = c < 3 ? pos[c] + base : angle[c - 3];
+#if CAM0_SSE
+            _mm_storeu_ps(out, _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(raw[c]), _mm_set1_ps(scale[c])), _mm_set1_ps(offset[c])));
+#else
+            for (int l = 0; l < 4; l++) out[l] = raw[c][l] * scale[c] + offset[c];
+#endif
+        }
+
+        for (uint32_t l = 0; l < lanes; l++) {
+            float qy[4] = { 0.0f, sinf(angle[0][l]), 0.0f, cosf(angle[0][l]) };
+            float qx[4] = { sinf(angle[1][l]), 0.0f, 0.0f, cosf(angle[1][l]) };
+            float qz[4] = { 0.0f, 0.0f, sinf(angle[2][l]), cosf(angle[2][l]) };
+            float t[4], q[4];
+            cam0_quat_mul(t, qy, qx);
+            cam0_quat_mul(q, t, qz);
+            for (int i = 0; i < 4; i++) rot[i][base + l] = q[i];
+        }
+    }
+}
+
+int cam0_bind(cam0_track* track, const void* data, size_t size)
+{
+    const uint8_t* p = (const uint8_t*)data;
+    memset(track, 0, sizeof(*track));
+
+    if (size < 40 || cam0_read_u32(p) != CAM0_MAGIC) return CAM0_ERR_HEADER;
+    track->version = cam0_read_u32(p + 4);
+    if (track->version < 1) return CAM0_ERR_HEADER;
+    track->keyframe_count = cam0_read_u32(p + 8);
+    track->fps = cam0_read_u32(p + 12);
+
+    // v2 inserted the flags word before the bounds
+    size_t bounds = 16;
+    if (track->version >= 2) {
+        if (size < 44) return CAM0_ERR_HEADER;
+        track->flags = cam0_read_u32(p + 16);
+        bounds = 20;
+    }
+    size_t header_size = bounds + 24;
+    if ((uint64_t)track->keyframe_count * CAM0_KEYFRAME_SIZE > size - header_size) return CAM0_ERR_HEADER;
+
+    float pos_min[3], pos_max[3];
+    for (int i = 0; i < 3; i++) {
+        pos_min[i] = cam0_read_f32(p + bounds + i * 4);
+        pos_max[i] = cam0_read_f32(p + bounds + 12 + i * 4);
+    }
+
+    // Ten arrays padded to whole SIMD blocks
+    size_t stride = ((size_t)track->keyframe_count + 3) & ~(size_t)3;
+    float* storage = (float*)malloc(sizeof(float) * (stride ? stride : 4) * 10);
+    if (!storage) return CAM0_ERR_MEMORY;
+    float* pos[3] = { storage, storage + stride, storage + stride * 2 };
+    float* rot[4] = { storage + stride * 3, storage + stride * 4, storage + stride * 5, storage + stride * 6 };
+    float* fov = storage + stride * 7;
+
+    cam0_decode(track, p + header_size, pos_min, pos_max, pos, rot, fov);
+
+    track->storage = storage;
+    track->pos_x = pos[0];
+    track->pos_y = pos[1];
+    track->pos_z = pos[2];
+    track->rot_x = rot[0];
+    track->rot_y = rot[1];
+    track->rot_z = rot[2];
+    track->rot_w = rot[3];
+    track->fov = fov;
+    track->duration = track->fps && track->keyframe_count > 1 ? (float)(track->keyframe_count - 1) / (float)track->fps : 0.0f;
+    return CAM0_OK;
+}
+
+int cam0_load(cam0_track* track, const char* path)
+{
+    memset(track, 0, sizeof(*track));
+#if defined(_WIN32)
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) return CAM0_ERR_IO;
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size)) { CloseHandle(file); return CAM0_ERR_IO; }
+    HANDLE section = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(file);
+    if (!section) return CAM0_ERR_IO;
+    void* data = MapViewOfFile(section, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(section);
+    if (!data) return CAM0_ERR_IO;
+    int result = cam0_bind(track, data, (size_t)size.QuadPart);
+    UnmapViewOfFile(data);
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return CAM0_ERR_IO;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) { close(fd); return CAM0_ERR_IO; }
+    void* data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) return CAM0_ERR_IO;
+    int result = cam0_bind(track, data, (size_t)st.st_size);
+    munmap(data, (size_t)st.st_size);
+#endif
+    return result;
+}
+
+void cam0_free(cam0_track* track)
+{
+    free(track->storage);
+    memset(track, 0, sizeof(*track));
+}
+
+void cam0_sample_frame(const cam0_track* track, double frame, cam0_pose* pose)
+{
+    memset(pose, 0, sizeof(*pose));
+    pose->rot[3] = 1.0f;
+    pose->fov = CAM0_DEFAULT_FOV;
+    if (track->keyframe_count == 0) return;
+
+    // Clamp (NaN lands on the first keyframe), then split into a keyframe and a fraction
+    uint32_t last = track->keyframe_count - 1;
+    uint32_t a = 0;
+    float t = 0.0f;
+    if (frame >= (double)last) {
+        a = last;
+    } else if (frame > 0.0) {
+        a = (uint32_t)frame;
+        t = (float)(frame - (double)a);
+    }
+    uint32_t b = a < last ? a + 1 : a;
+
+    pose->pos[0] = track->pos_x[a] + (track->pos_x[b] - track->pos_x[a]) * t;
+    pose->pos[1] = track->pos_y[a] + (track->pos_y[b] - track->pos_y[a]) * t;
+    pose->pos[2] = track->pos_z[a] + (track->pos_z[b] - track->pos_z[a]) * t;
+    pose->fov = track->fov[a] + (track->fov[b] - track->fov[a]) * t;
+
+    // Slerp on the shortest arc: q and -q are the same rotation, take the one within 90 degrees of the first
+    float qa[4] = { track->rot_x[a], track->rot_y[a], track->rot_z[a], track->rot_w[a] };
+    float qb[4] = { track->rot_x[b], track->rot_y[b], track->rot_z[b], track->rot_w[b] };
+    float dot = qa[0] * qb[0] + qa[1] * qb[1] + qa[2] * qb[2] + qa[3] * qb[3];
+    float sign = 1.0f;
+    if (dot < 0.0f) { dot = -dot; sign = -1.0f; }
+    float wa = 1.0f - t, wb = t;
+    if (dot < 0.9995f) {
+        // Nearly parallel quaternions fall through to normalized lerp, where sin(theta) would lose precision
+        float theta = acosf(dot);
+        float inv = 1.0f / sinf(theta);
+        wa = sinf((1.0f - t) * theta) * inv;
+        wb = sinf(t * theta) * inv;
+    }
+    wb *= sign;
+    float q[4], len = 0.0f;
+    for (int i = 0; i < 4; i++) {
+        q[i] = qa[i] * wa + qb[i] * wb;
+        len += q[i] * q[i];
+    }
+    len = len > 0.0f ? 1.0f / sqrtf(len) : 0.0f;
+    for (int i = 0; i < 4; i++) pose->rot[i] = q[i] * len;
+}
+
+void cam0_sample(const cam0_track* track, double seconds, cam0_pose* pose)
+{
+    cam0_sample_frame(track, seconds * (double)track->fps, pose);
+}
+
+void cam0_view_matrix(const cam0_pose* pose, float view[16])
+{
+    float x = pose->rot[0], y = pose->rot[1], z = pose->rot[2], w = pose->rot[3];
+    // Camera rotation R, row-major
+    float r[9] = {
+        1.0f - 2.0f * (y * y + z * z), 2.0f * (x * y - z * w), 2.0f * (x * z + y * w),
+        2.0f * (x * y + z * w), 1.0f - 2.0f * (x * x + z * z), 2.0f * (y * z - x * w),
+        2.0f * (x * z - y * w), 2.0f * (y * z + x * w), 1.0f - 2.0f * (x * x + y * y),
+    };
+
+    // Inverse of the camera transform: R^T and -R^T * pos
+    memset(view, 0, sizeof(float) * 16);
+    for (int row = 0; row < 3; row++) {
+        for (int col = 0; col < 3; col++) view[col * 4 + row] = r[col * 3 + row];
+        view[12 + row] = -(r[0 * 3 + row] * pose->pos[0] + r[1 * 3 + row] * pose->pos[1] + r[2 * 3 + row] * pose->pos[2]);
+    }
+    view[15] = 1.0f;
+}
+
+void cam0_view_proj(const cam0_pose* pose, float aspect, float near_z, float far_z, float view_proj[16])
+{
+    float v[16];
+    cam0_view_matrix(pose, v);
+
+    // Unity's fieldOfView is vertical. The projection is sparse, so P * V is written out per row.
+    float f = 1.0f / tanf(pose->fov * (CAM0_PI / 180.0f) * 0.5f);
+    float sx = f / aspect, sy = f;
+    float a = (far_z + near_z) / (near_z - far_z);
+    float b = 2.0f * far_z * near_z / (near_z - far_z);
+    for (int c = 0; c < 4; c++) {
+        view_proj[c * 4 + 0] = sx * v[c * 4 + 0];
+        view_proj[c * 4 + 1] = sy * v[c * 4 + 1];
+        view_proj[c * 4 + 2] = a * v[c * 4 + 2] + b * v[c * 4 + 3];
+        view_proj[c * 4 + 3] = -v[c * 4 + 2];
+    }
+}
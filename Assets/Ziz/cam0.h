@@ -0,0 +1,67 @@
+#ifndef CAM0_H
+#define CAM0_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Reader for CAM0 camera tracks written by RecordCamera (v1 and v2).
+//
+//   cam0_track track;
+//   cam0_load(&track, "intro.cam");
+//   cam0_pose pose;
+//   cam0_sample(&track, seconds, &pose);
+//   cam0_view_proj(&pose, 16.0f / 9.0f, 0.1f, 1000.0f, view_proj);
+//
+// Loading maps the file, dequantizes every keyframe once into SoA floats and quaternions, and drops the mapping.
+// Keyframes are evenly spaced at fps, so sampling is O(1) at any time: no cursor, no search, a jump costs the same as
+// the next frame. Positions are lerped, rotations slerped along the shortest arc, so low-rate tracks play smoothly.
+//
+// Poses are in exported space (Z mirrored, like EMU levels) whatever the track's flip flags were, with the camera
+// looking down -Z.
+
+#define CAM0_MAGIC 0x43414D30u
+
+#define CAM0_FLAG_FLIP_Z          1u
+#define CAM0_FLAG_FLIP_ROT_WITH_Z 2u
+
+typedef struct cam0_pose {
+    float pos[3];
+    float rot[4];    // x, y, z, w; camera to world
+    float fov;       // vertical, degrees
+} cam0_pose;
+
+typedef struct cam0_track {
+    uint32_t version;
+    uint32_t flags;
+    uint32_t fps;
+    uint32_t keyframe_count;
+    float duration;            // seconds from the first keyframe to the last
+    const float *pos_x, *pos_y, *pos_z;
+    const float *rot_x, *rot_y, *rot_z, *rot_w;
+    const float* fov;
+    void* storage;             // one allocation behind every array above
+} cam0_track;
+
+enum {
+    CAM0_OK = 0,
+    CAM0_ERR_IO = -1,
+    CAM0_ERR_HEADER = -2,
+    CAM0_ERR_MEMORY = -3
+};
+
+// Decodes a CAM0 image in memory. data is not referenced afterwards.
+int cam0_bind(cam0_track* track, const void* data, size_t size);
+
+// Maps path read-only and decodes it.
+int cam0_load(cam0_track* track, const char* path);
+void cam0_free(cam0_track* track);
+
+// frame is a fractional keyframe index; both clamp to the ends of the track. An empty track gives the identity pose.
+void cam0_sample_frame(const cam0_track* track, double frame, cam0_pose* pose);
+void cam0_sample(const cam0_track* track, double seconds, cam0_pose* pose);
+
+// Column-major, OpenGL clip conventions (same as emu_frustum_from_matrix expects)
+void cam0_view_matrix(const cam0_pose* pose, float view[16]);
+void cam0_view_proj(const cam0_pose* pose, float aspect, float near_z, float far_z, float view_proj[16]);
+
+#endif
@@ -0,0 +1,157 @@
+#include "emu5.h"
+#include <string.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static int emu5_section_ok(const emu5_header* h, int id, uint64_t expected_size)
+{
+    const emu5_section* s = &h->sections[id];
+    if (s->offset % 16 != 0 || s->offset < h->header_size) return 0;
+    if ((uint64_t)s->offset + s->size > h->file_size) return 0;
+    return expected_size == UINT64_MAX || s->size == expected_size;
+}
+
+#define EMU5_PTR(type, id) ((const type*)(base + h->sections[id].offset))
+
+int emu5_bind(emu5_level* level, const void* data, size_t size)
+{
+    const uint8_t* base = (const uint8_t*)data;
+    const emu5_header* h = (const emu5_header*)data;
+
+    memset(level, 0, sizeof(*level));
+
+    if (size < sizeof(emu5_header) || ((uintptr_t)data & 15) != 0) return EMU5_ERR_HEADER;
+    if (h->magic != EMU5_MAGIC || h->version != EMU5_VERSION || h->endian != EMU5_ENDIAN) return EMU5_ERR_HEADER;
+    if (h->file_size > size || h->section_count < EMU5_SECTION_COUNT) return EMU5_ERR_HEADER;
+    if (h->header_size < 48u + 8u * h->section_count) return EMU5_ERR_HEADER;
+    if (h->pvs_row_bytes != (h->leaf_count + 7) / 8 || !(h->flags & EMU5_FLAG_PVS_RLE)) return EMU5_ERR_HEADER;
+
+    uint64_t v4 = (uint64_t)h->vertex_count * 4, v1 = h->vertex_count, l4 = (uint64_t)h->leaf_count * 4;
+    if (!emu5_section_ok(h, EMU5_SEC_TEXTURE_NAME, UINT64_MAX) || h->sections[EMU5_SEC_TEXTURE_NAME].size == 0) return EMU5_ERR_SECTION;
+    for (int id = EMU5_SEC_POS_X; id <= EMU5_SEC_NRM_Z; id++) if (!emu5_section_ok(h, id, v4)) return EMU5_ERR_SECTION;
+    for (int id = EMU5_SEC_U; id <= EMU5_SEC_COLOR_B; id++) if (!emu5_section_ok(h, id, v1)) return EMU5_ERR_SECTION;
+    for (int id = EMU5_SEC_LEAF_MIN_X; id <= EMU5_SEC_LEAF_MAX_Z; id++) if (!emu5_section_ok(h, id, l4)) return EMU5_ERR_SECTION;
+    if (!emu5_section_ok(h, EMU5_SEC_FACES, (uint64_t)h->face_count * 12) ||
+        !emu5_section_ok(h, EMU5_SEC_LEAF_RANGES, (uint64_t)h->leaf_count * 8) ||
+        !emu5_section_ok(h, EMU5_SEC_LEAF_FACES, (uint64_t)h->leaf_face_count * 4) ||
+        !emu5_section_ok(h, EMU5_SEC_PVS_OFFSETS, l4 + 4) ||
+        !emu5_section_ok(h, EMU5_SEC_PVS_DATA, UINT64_MAX) ||
+        !emu5_section_ok(h, EMU5_SEC_BSP_NODES, UINT64_MAX) ||
+        h->sections[EMU5_SEC_BSP_NODES].size % sizeof(emu5_bsp_node) != 0) return EMU5_ERR_SECTION;
+    for (int id = EMU5_SEC_CELL_OF_LEAF; id <= EMU5_SEC_PORTAL_POINTS; id++) if (!emu5_section_ok(h, id, UINT64_MAX)) return EMU5_ERR_SECTION;
+
+    uint32_t cell_offsets_size = h->sections[EMU5_SEC_CELL_PVS_OFFSETS].size;
+    if (h->flags & EMU5_FLAG_CELLS) {
+        if (h->sections[EMU5_SEC_CELL_OF_LEAF].size != l4 || cell_offsets_size < 4 || cell_offsets_size % 4 != 0 ||
+            h->sections[EMU5_SEC_PORTALS].size % sizeof(emu5_portal) != 0 ||
+            h->sections[EMU5_SEC_PORTAL_POINTS].size % 12 != 0) return EMU5_ERR_SECTION;
+        const uint32_t* cell_offsets = EMU5_PTR(uint32_t, EMU5_SEC_CELL_PVS_OFFSETS);
+        uint32_t cell_count = cell_offsets_size / 4 - 1;
+        if (!emu_pvs_offsets_ok(cell_offsets, cell_count, h->sections[EMU5_SEC_CELL_PVS_DATA].size) ||
+            cell_offsets[cell_count] != h->sections[EMU5_SEC_CELL_PVS_DATA].size) return EMU5_ERR_SECTION;
+    }
+
+    const char* name = EMU5_PTR(char, EMU5_SEC_TEXTURE_NAME);
+    if (name[h->sections[EMU5_SEC_TEXTURE_NAME].size - 1] != '\0') return EMU5_ERR_SECTION;
+    const uint32_t* pvs_offsets = EMU5_PTR(uint32_t, EMU5_SEC_PVS_OFFSETS);
+    if (!emu_pvs_offsets_ok(pvs_offsets, h->leaf_count, h->sections[EMU5_SEC_PVS_DATA].size) ||
+        pvs_offsets[h->leaf_count] != h->sections[EMU5_SEC_PVS_DATA].size) return EMU5_ERR_SECTION;
+
+    level->header = h;
+    level->texture_name = name;
+    level->pos_x = EMU5_PTR(float, EMU5_SEC_POS_X);
+    level->pos_y = EMU5_PTR(float, EMU5_SEC_POS_Y);
+    level->pos_z = EMU5_PTR(float, EMU5_SEC_POS_Z);
+    level->nrm_x = EMU5_PTR(float, EMU5_SEC_NRM_X);
+    level->nrm_y = EMU5_PTR(float, EMU5_SEC_NRM_Y);
+    level->nrm_z = EMU5_PTR(float, EMU5_SEC_NRM_Z);
+    level->u = EMU5_PTR(uint8_t, EMU5_SEC_U);
+    level->v = EMU5_PTR(uint8_t, EMU5_SEC_V);
+    level->color_r = EMU5_PTR(uint8_t, EMU5_SEC_COLOR_R);
+    level->color_g = EMU5_PTR(uint8_t, EMU5_SEC_COLOR_G);
+    level->color_b = EMU5_PTR(uint8_t, EMU5_SEC_COLOR_B);
+    level->faces = EMU5_PTR(uint32_t, EMU5_SEC_FACES);
+    level->leaf_ranges = EMU5_PTR(uint32_t, EMU5_SEC_LEAF_RANGES);
+    level->leaf_faces = EMU5_PTR(uint32_t, EMU5_SEC_LEAF_FACES);
+    level->leaf_min_x = EMU5_PTR(float, EMU5_SEC_LEAF_MIN_X);
+    level->leaf_min_y = EMU5_PTR(float, EMU5_SEC_LEAF_MIN_Y);
+    level->leaf_min_z = EMU5_PTR(float, EMU5_SEC_LEAF_MIN_Z);
+    level->leaf_max_x = EMU5_PTR(float, EMU5_SEC_LEAF_MAX_X);
+    level->leaf_max_y = EMU5_PTR(float, EMU5_SEC_LEAF_MAX_Y);
+    level->leaf_max_z = EMU5_PTR(float, EMU5_SEC_LEAF_MAX_Z);
+
+    level->pvs.leaf_count = h->leaf_count;
+    level->pvs.row_bytes = h->pvs_row_bytes;
+    level->pvs.row_offsets = (const uint8_t*)pvs_offsets;
+    level->pvs.rows = EMU5_PTR(uint8_t, EMU5_SEC_PVS_DATA);
+    level->bsp_nodes = EMU5_PTR(emu5_bsp_node, EMU5_SEC_BSP_NODES);
+    level->bsp_node_count = h->sections[EMU5_SEC_BSP_NODES].size / (uint32_t)sizeof(emu5_bsp_node);
+
+    if (h->flags & EMU5_FLAG_CELLS) {
+        level->cell_count = cell_offsets_size / 4 - 1;
+        level->cell_of_leaf = EMU5_PTR(uint32_t, EMU5_SEC_CELL_OF_LEAF);
+        level->cell_pvs.leaf_count = level->cell_count;
+        level->cell_pvs.row_bytes = (level->cell_count + 7) / 8;
+        level->cell_pvs.row_offsets = EMU5_PTR(uint8_t, EMU5_SEC_CELL_PVS_OFFSETS);
+        level->cell_pvs.rows = EMU5_PTR(uint8_t, EMU5_SEC_CELL_PVS_DATA);
+        level->portals = EMU5_PTR(emu5_portal, EMU5_SEC_PORTALS);
+        level->portal_count = h->sections[EMU5_SEC_PORTALS].size / (uint32_t)sizeof(emu5_portal);
+        level->portal_points = EMU5_PTR(float, EMU5_SEC_PORTAL_POINTS);
+        level->portal_point_count = h->sections[EMU5_SEC_PORTAL_POINTS].size / 12;
+    }
+    return EMU5_OK;
+}
+
+#undef EMU5_PTR
+
+int emu5_map(emu5_level* level, const char* path)
+{
+    memset(level, 0, sizeof(*level));
+#if defined(_WIN32)
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) return EMU5_ERR_IO;
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size)) { CloseHandle(file); return EMU5_ERR_IO; }
+    HANDLE section = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(file);
+    if (!section) return EMU5_ERR_IO;
+    void* data = MapViewOfFile(section, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(section);
+    if (!data) return EMU5_ERR_IO;
+    size_t length = (size_t)size.QuadPart;
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return EMU5_ERR_IO;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) { close(fd); return EMU5_ERR_IO; }
+    void* data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) return EMU5_ERR_IO;
+    size_t length = (size_t)st.st_size;
+#endif
+
+    int result = emu5_bind(level, data, length);
+    level->mapping = data;
+    level->mapping_size = length;
+    if (result != EMU5_OK) emu5_unmap(level);
+    return result;
+}
+
+void emu5_unmap(emu5_level* level)
+{
+    if (level->mapping) {
+#if defined(_WIN32)
+        UnmapViewOfFile(level->mapping);
+#else
+        munmap(level->mapping, level->mapping_size);
+#endif
+    }
+    memset(level, 0, sizeof(*level));
+}
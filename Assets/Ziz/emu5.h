@@ -0,0 +1,126 @@
+#ifndef EMU5_H
+#define EMU5_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "emu_pvs.h"
+
+// EMU v5: one offset-relocatable blob written by Level.WriteEMUFileV5 (emuFormatVersion = 5).
+//
+// [emu5_header][section table][pad to header_size][sections...]
+// Every section starts on a 16-byte boundary, so a mapped file can be used in place: no parsing, no copies.
+// Coordinates follow v4 (Z and V flipped, winding flipped). Leaf bounds are flipped too, unlike v4.
+
+#define EMU5_MAGIC    0x454D5520u
+#define EMU5_VERSION  5u
+#define EMU5_ENDIAN   0x01020304u
+
+#define EMU5_FLAG_NEAREST_FILTER 1u
+#define EMU5_FLAG_PVS_RLE        2u
+#define EMU5_FLAG_CELLS          4u  // cell/portal visibility: leaf PVS rows are empty, the CELL_* sections are used
+
+enum {
+    EMU5_SEC_TEXTURE_NAME,                                  // UTF-8, NUL terminated
+    EMU5_SEC_POS_X, EMU5_SEC_POS_Y, EMU5_SEC_POS_Z,         // float[vertex_count]
+    EMU5_SEC_NRM_X, EMU5_SEC_NRM_Y, EMU5_SEC_NRM_Z,         // float[vertex_count]
+    EMU5_SEC_U, EMU5_SEC_V,                                 // uint8_t[vertex_count]
+    EMU5_SEC_COLOR_R, EMU5_SEC_COLOR_G, EMU5_SEC_COLOR_B,   // uint8_t[vertex_count]
+    EMU5_SEC_FACES,                                         // uint32_t[face_count][3]
+    EMU5_SEC_LEAF_RANGES,                                   // uint32_t[leaf_count][2]: first, count into LEAF_FACES
+    EMU5_SEC_LEAF_FACES,                                    // uint32_t[leaf_face_count], ascending within a leaf
+    EMU5_SEC_LEAF_MIN_X, EMU5_SEC_LEAF_MIN_Y, EMU5_SEC_LEAF_MIN_Z,
+    EMU5_SEC_LEAF_MAX_X, EMU5_SEC_LEAF_MAX_Y, EMU5_SEC_LEAF_MAX_Z, // float[leaf_count]
+    EMU5_SEC_PVS_OFFSETS,                                   // uint32_t[leaf_count + 1]
+    EMU5_SEC_PVS_DATA,                                      // zero-run coded rows (emu_pvs.h)
+    EMU5_SEC_BSP_NODES,                                     // emu5_bsp_node[], preorder, root first; empty for one leaf
+    EMU5_SEC_CELL_OF_LEAF,                                  // uint32_t[leaf_count], empty without EMU5_FLAG_CELLS
+    EMU5_SEC_CELL_PVS_OFFSETS,                              // uint32_t[cell_count + 1]
+    EMU5_SEC_CELL_PVS_DATA,                                 // zero-run coded cell rows, same coding as PVS_DATA
+    EMU5_SEC_PORTALS,                                       // emu5_portal[]
+    EMU5_SEC_PORTAL_POINTS,                                 // float[][3], convex polygons referenced by emu5_portal
+    EMU5_SECTION_COUNT
+};
+
+typedef struct emu5_section {
+    uint32_t offset;
+    uint32_t size;
+} emu5_section;
+
+// Child references: >= 0 is a node index, < 0 is leaf -(ref + 1), EMU5_NO_CHILD means nothing on that side
+#define EMU5_NO_CHILD INT32_MIN
+
+typedef struct emu5_bsp_node {
+    float nx, ny, nz, d;      // front side is nx*x + ny*y + nz*z + d >= 0
+    int32_t front;
+    int32_t back;
+} emu5_bsp_node;
+
+typedef struct emu5_portal {
+    float nx, ny, nz, d;      // front side (nx*x + ny*y + nz*z + d >= 0) faces front_cell
+    uint32_t front_cell;
+    uint32_t back_cell;
+    uint32_t first_point;
+    uint32_t point_count;
+} emu5_portal;
+
+typedef struct emu5_header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t endian;
+    uint32_t header_size;     // bytes before the first section, multiple of 16
+    uint32_t file_size;
+    uint32_t vertex_count;
+    uint32_t face_count;
+    uint32_t leaf_count;
+    uint32_t leaf_face_count;
+    uint32_t pvs_row_bytes;
+    uint32_t flags;
+    uint32_t section_count;   // >= EMU5_SECTION_COUNT; newer writers may append sections
+    emu5_section sections[EMU5_SECTION_COUNT];
+} emu5_header;
+
+typedef struct emu5_level {
+    const emu5_header* header;
+    const char* texture_name;
+    const float *pos_x, *pos_y, *pos_z;
+    const float *nrm_x, *nrm_y, *nrm_z;
+    const uint8_t *u, *v;
+    const uint8_t *color_r, *color_g, *color_b;
+    const uint32_t* faces;
+    const uint32_t* leaf_ranges;
+    const uint32_t* leaf_faces;
+    const float *leaf_min_x, *leaf_min_y, *leaf_min_z;
+    const float *leaf_max_x, *leaf_max_y, *leaf_max_z;
+    emu_pvs pvs;
+    const emu5_bsp_node* bsp_nodes;
+    uint32_t bsp_node_count;
+
+    // Cell/portal visibility, all zero without EMU5_FLAG_CELLS. cell_pvs rows are indexed and sized by cell.
+    uint32_t cell_count;
+    const uint32_t* cell_of_leaf;
+    emu_pvs cell_pvs;
+    const emu5_portal* portals;
+    uint32_t portal_count;
+    const float* portal_points;
+    uint32_t portal_point_count;
+
+    void* mapping;            // set by emu5_map, NULL for emu5_bind
+    size_t mapping_size;
+} emu5_level;
+
+enum {
+    EMU5_OK = 0,
+    EMU5_ERR_IO = -1,
+    EMU5_ERR_HEADER = -2,
+    EMU5_ERR_SECTION = -3
+};
+
+// Points level at an EMU v5 image already in memory (16-byte aligned) that the caller keeps alive.
+// Validates the header and section bounds only; nothing is copied.
+int emu5_bind(emu5_level* level, const void* data, size_t size);
+
+// Maps path read-only and shared, then binds it. Processes loading the same level share its pages.
+int emu5_map(emu5_level* level, const char* path);
+void emu5_unmap(emu5_level* level);
+
+#endif
@@ -0,0 +1,479 @@
+#include "emu_cull.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define EMU_CULL_SSE 1
+#include <xmmintrin.h>
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+static inline uint32_t emu_ctz64(uint64_t x) { unsigned long i; _BitScanForward64(&i, x); return (uint32_t)i; }
+#else
+static inline uint32_t emu_ctz64(uint64_t x) { return (uint32_t)__builtin_ctzll(x); }
+#endif
+
+#define EMU_CULL_MAX_POINTS 64        // clipped portal polygon
+#define EMU_CULL_MAX_PORTAL_POINTS 32 // larger portals are passed without narrowing
+#define EMU_CULL_PORTAL_EPSILON 1e-3f
+#define EMU_CULL_MAX_PORTAL_DEPTH 64  // deeper paths end the walk early (stack use is ~1 KB per level)
+
+// A frustum with a variable number of planes, same SoA layout and sign as emu_frustum
+typedef struct emu_cull_planes {
+    uint32_t count;
+    float nx[EMU_CULL_MAX_PLANES], ny[EMU_CULL_MAX_PLANES], nz[EMU_CULL_MAX_PLANES], d[EMU_CULL_MAX_PLANES];
+} emu_cull_planes;
+
+void emu_frustum_from_matrix(emu_frustum* f, const float m[16])
+{
+    // Gribb/Hartmann: rows of the matrix combined with row 3
+#define EMU_ROW(r, i) m[(i) * 4 + (r)]
+    for (int p = 0; p < 6; p++) {
+        int row = p >> 1;
+        float sign = (p & 1) ? -1.0f : 1.0f;
+        float a = EMU_ROW(3, 0) + sign * EMU_ROW(row, 0);
+        float b = EMU_ROW(3, 1) + sign * EMU_ROW(row, 1);
+        float c = EMU_ROW(3, 2) + sign * EMU_ROW(row, 2);
+        float d = EMU_ROW(3, 3) + sign * EMU_ROW(row, 3);
+        f->nx[p] = a;
+        f->ny[p] = b;
+        f->nz[p] = c;
+        f->d[p] = d;
+    }
+#undef EMU_ROW
+}
+
+int32_t emu_locate_leaf(const emu5_level* level, float x, float y, float z)
+{
+    uint32_t leaf_count = level->header->leaf_count;
+    if (leaf_count == 0) return -1;
+    if (level->bsp_node_count == 0) return 0;
+
+    int32_t ref = 0;
+    for (uint32_t steps = 0; steps <= level->bsp_node_count; steps++) {
+        const emu5_bsp_node* node = &level->bsp_nodes[ref];
+        float dist = node->nx * x + node->ny * y + node->nz * z + node->d;
+        int32_t next = dist >= 0.0f ? node->front : node->back;
+        if (next == EMU5_NO_CHILD) next = dist >= 0.0f ? node->back : node->front;
+        if (next == EMU5_NO_CHILD) return -1;
+        if (next < 0) {
+            uint32_t leaf = (uint32_t)(-(next + 1));
+            return leaf < leaf_count ? (int32_t)leaf : -1;
+        }
+        if ((uint32_t)next >= level->bsp_node_count) return -1;
+        ref = next;
+    }
+    return -1; // cycle: corrupt file
+}
+
+static int emu_cull_portal_usable(const emu5_level* level, const emu5_portal* portal)
+{
+    uint32_t cells = level->cell_count;
+    if (portal->front_cell >= cells || portal->back_cell >= cells || portal->front_cell == portal->back_cell) return 0;
+    return portal->point_count >= 3 && portal->first_point <= level->portal_point_count &&
+           portal->point_count <= level->portal_point_count - portal->first_point;
+}
+
+// Cell mode tables: leaves and usable portals per cell, both as ranges into flat arrays
+static int emu_cull_init_cells(emu_cull_context* cull, const emu5_level* level)
+{
+    uint32_t cells = level->cell_count, leaves = level->header->leaf_count;
+    cull->cell_leaf_start = (uint32_t*)calloc(cells + 1, sizeof(uint32_t));
+    cull->cell_leaves = (uint32_t*)malloc(sizeof(uint32_t) * (leaves ? leaves : 1));
+    cull->cell_portal_start = (uint32_t*)calloc(cells + 1, sizeof(uint32_t));
+    cull->cell_portals = (uint32_t*)malloc(sizeof(uint32_t) * (level->portal_count * 2 + 1));
+    cull->cell_row = (uint8_t*)malloc(level->cell_pvs.row_bytes + 1);
+    cull->on_path = (uint8_t*)calloc(cells + 1, 1);
+    cull->leaf_stamp = (uint32_t*)calloc(leaves + 1, sizeof(uint32_t));
+    if (!cull->cell_leaf_start || !cull->cell_leaves || !cull->cell_portal_start || !cull->cell_portals ||
+        !cull->cell_row || !cull->on_path || !cull->leaf_stamp) return -1;
+
+    // Counting sort; leaves with an out-of-range cell are left out (a camera in one falls back to the frustum)
+    for (uint32_t i = 0; i < leaves; i++)
+        if (level->cell_of_leaf[i] < cells) cull->cell_leaf_start[level->cell_of_leaf[i] + 1]++;
+    for (uint32_t c = 0; c < cells; c++) cull->cell_leaf_start[c + 1] += cull->cell_leaf_start[c];
+    for (uint32_t i = 0; i < leaves; i++) {
+        uint32_t c = level->cell_of_leaf[i];
+        if (c < cells) cull->cell_leaves[cull->cell_leaf_start[c]++] = i;
+    }
+    for (uint32_t c = cells; c > 0; c--) cull->cell_leaf_start[c] = cull->cell_leaf_start[c - 1];
+    cull->cell_leaf_start[0] = 0;
+
+    // Same for portals, each listed under both of its cells
+    for (uint32_t p = 0; p < level->portal_count; p++) {
+        const emu5_portal* portal = &level->portals[p];
+        if (!emu_cull_portal_usable(level, portal)) continue;
+        cull->cell_portal_start[portal->front_cell + 1]++;
+        cull->cell_portal_start[portal->back_cell + 1]++;
+    }
+    for (uint32_t c = 0; c < cells; c++) cull->cell_portal_start[c + 1] += cull->cell_portal_start[c];
+    for (uint32_t p = 0; p < level->portal_count; p++) {
+        const emu5_portal* portal = &level->portals[p];
+        if (!emu_cull_portal_usable(level, portal)) continue;
+        cull->cell_portals[cull->cell_portal_start[portal->front_cell]++] = p;
+        cull->cell_portals[cull->cell_portal_start[portal->back_cell]++] = p;
+    }
+    for (uint32_t c = cells; c > 0; c--) cull->cell_portal_start[c] = cull->cell_portal_start[c - 1];
+    cull->cell_portal_start[0] = 0;
+    return 0;
+}
+
+int emu_cull_init(emu_cull_context* cull, const emu5_level* level)
+{
+    memset(cull, 0, sizeof(*cull));
+    cull->level = level;
+    uint32_t leaves = level->header->leaf_count;
+    uint32_t faces = level->header->face_count;
+    cull->visible_leaves = (uint32_t*)malloc(sizeof(uint32_t) * (leaves ? leaves : 1));
+    cull->face_bits = (uint64_t*)calloc((faces + 63) / 64 + 1, sizeof(uint64_t));
+    cull->ranges = (emu_face_range*)malloc(sizeof(emu_face_range) * ((faces + 1) / 2 + 1));
+    if (!cull->visible_leaves || !cull->face_bits || !cull->ranges ||
+        (level->cell_count > 0 && emu_cull_init_cells(cull, level) != 0)) {
+        emu_cull_free(cull);
+        return -1;
+    }
+    return 0;
+}
+
+void emu_cull_free(emu_cull_context* cull)
+{
+    free(cull->visible_leaves);
+    free(cull->face_bits);
+    free(cull->ranges);
+    free(cull->cell_leaf_start);
+    free(cull->cell_leaves);
+    free(cull->cell_portal_start);
+    free(cull->cell_portals);
+    free(cull->cell_row);
+    free(cull->on_path);
+    free(cull->leaf_stamp);
+    memset(cull, 0, sizeof(*cull));
+}
+
+// Tests up to four leaves against plane_count planes; returns a 4-bit mask of the ones that are not fully outside.
+static uint32_t emu_cull_boxes4(const emu5_level* level, const uint32_t* leaves, uint32_t n,
+                                const float* nx, const float* ny, const float* nz, const float* nd, uint32_t plane_count)
+{
+#if EMU_CULL_SSE
+    float mn[3][4], mx[3][4];
+    for (uint32_t i = 0; i < 4; i++) {
+        uint32_t l = leaves[i < n ? i : 0];
+        mn[0][i] = level->leaf_min_x[l]; mn[1][i] = level->leaf_min_y[l]; mn[2][i] = level->leaf_min_z[l];
+        mx[0][i] = level->leaf_max_x[l]; mx[1][i] = level->leaf_max_y[l]; mx[2][i] = level->leaf_max_z[l];
+    }
+    __m128 min_x = _mm_loadu_ps(mn[0]), min_y = _mm_loadu_ps(mn[1]), min_z = _mm_loadu_ps(mn[2]);
+    __m128 max_x = _mm_loadu_ps(mx[0]), max_y = _mm_loadu_ps(mx[1]), max_z = _mm_loadu_ps(mx[2]);
+    __m128 zero = _mm_setzero_ps();
+    __m128 inside = _mm_cmpeq_ps(zero, zero);
+    for (uint32_t p = 0; p < plane_count; p++) {
+        // Positive vertex: the box corner furthest along the plane normal
+        __m128 px = nx[p] >= 0.0f ? max_x : min_x;
+        __m128 py = ny[p] >= 0.0f ? max_y : min_y;
+        __m128 pz = nz[p] >= 0.0f ? max_z : min_z;
+        __m128 dist = _mm_add_ps(_mm_add_ps(_mm_mul_ps(px, _mm_set1_ps(nx[p])), _mm_mul_ps(py, _mm_set1_ps(ny[p]))),
+                                 _mm_add_ps(_mm_mul_ps(pz, _mm_set1_ps(nz[p])), _mm_set1_ps(nd[p])));
+        inside = _mm_and_ps(inside, _mm_cmpge_ps(dist, zero));
+    }
+    return (uint32_t)_mm_movemask_ps(inside) & ((1u << n) - 1u);
+#else
+    uint32_t mask = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        uint32_t l = leaves[i];
+        int visible = 1;
+        for (uint32_t p = 0; p < plane_count && visible; p++) {
+            float px = nx[p] >= 0.0f ? level->leaf_max_x[l] : level->leaf_min_x[l];
+            float py = ny[p] >= 0.0f ? level->leaf_max_y[l] : level->leaf_min_y[l];
+            float pz = nz[p] >= 0.0f ? level->leaf_max_z[l] : level->leaf_min_z[l];
+            visible = nx[p] * px + ny[p] * py + nz[p] * pz + nd[p] >= 0.0f;
+        }
+        mask |= (uint32_t)visible << i;
+    }
+    return mask;
+#endif
+}
+
+// Sets the leaf's face bits and widens [lo_word, hi_word] to cover them
+static void emu_cull_mark_faces(emu_cull_context* cull, uint32_t leaf, uint32_t* lo_word, uint32_t* hi_word)
+{
+    const emu5_level* level = cull->level;
+    uint32_t face_count = level->header->face_count;
+    uint32_t first = level->leaf_ranges[leaf * 2];
+    uint32_t count = level->leaf_ranges[leaf * 2 + 1];
+    if (first > level->header->leaf_face_count || count > level->header->leaf_face_count - first) return;
+
+    const uint32_t* ids = level->leaf_faces + first;
+    for (uint32_t k = 0; k < count; k++) {
+        uint32_t face = ids[k];
+        if (face >= face_count) continue;
+        cull->face_bits[face >> 6] |= 1ull << (face & 63);
+    }
+    if (count && face_count) {
+        // Leaf face ids are ascending, so the ends bound the words touched
+        uint32_t first_id = ids[0] < face_count ? ids[0] : face_count - 1;
+        if ((first_id >> 6) < *lo_word) *lo_word = first_id >> 6;
+        uint32_t last = ids[count - 1] < face_count ? ids[count - 1] : face_count - 1;
+        if ((last >> 6) > *hi_word) *hi_word = last >> 6;
+    }
+}
+
+// Turns set face bits into ascending [first, first + count) ranges, clearing them as it goes
+static uint32_t emu_cull_emit_ranges(emu_cull_context* cull, uint32_t lo_word, uint32_t hi_word)
+{
+    emu_face_range* ranges = cull->ranges;
+    uint32_t range_count = 0, drawn = 0;
+    for (uint32_t w = lo_word; w <= hi_word; w++) {
+        uint64_t bits = cull->face_bits[w];
+        cull->face_bits[w] = 0;
+        uint32_t base = w << 6;
+        while (bits) {
+            uint32_t start = emu_ctz64(bits);
+            uint64_t run = ~(bits >> start);
+            uint32_t len = run ? emu_ctz64(run) : 64 - start; // ones from start
+            if (len > 64 - start) len = 64 - start;
+            uint32_t first = base + start;
+            if (range_count && ranges[range_count - 1].first + ranges[range_count - 1].count == first) {
+                ranges[range_count - 1].count += len;
+            } else {
+                ranges[range_count].first = first;
+                ranges[range_count].count = len;
+                range_count++;
+            }
+            drawn += len;
+            bits = (start + len >= 64) ? 0 : bits & (~0ull << (start + len));
+        }
+    }
+    cull->range_count = range_count;
+    cull->stats.faces_drawn = drawn;
+    return range_count;
+}
+
+// ---- Cell/portal mode ----
+
+typedef struct emu_cull_walk {
+    emu_cull_context* cull;
+    const float* eye;
+    const emu_frustum* frustum;
+    uint32_t visits_left;
+    uint32_t visible_count;
+} emu_cull_walk;
+
+static int emu_cull_cell_in_row(const emu_cull_context* cull, uint32_t cell)
+{
+    return (cull->cell_row[cell >> 3] >> (cell & 7)) & 1;
+}
+
+// Tests the cell's leaves that are not visible yet against planes; survivors join the visible list
+static void emu_cull_cell_leaves(emu_cull_walk* walk, uint32_t cell, const emu_cull_planes* planes)
+{
+    emu_cull_context* cull = walk->cull;
+    uint32_t batch[4], n = 0;
+    for (uint32_t i = cull->cell_leaf_start[cell], end = cull->cell_leaf_start[cell + 1]; i <= end; i++) {
+        if (i < end) {
+            uint32_t leaf = cull->cell_leaves[i];
+            if (cull->leaf_stamp[leaf] == cull->stamp) continue;
+            batch[n++] = leaf;
+            if (n < 4) continue;
+        }
+        if (n == 0) break;
+        uint32_t mask = emu_cull_boxes4(cull->level, batch, n, planes->nx, planes->ny, planes->nz, planes->d, planes->count);
+        while (mask) {
+            uint32_t leaf = batch[emu_ctz64(mask)];
+            mask &= mask - 1;
+            cull->leaf_stamp[leaf] = cull->stamp;
+            cull->visible_leaves[walk->visible_count++] = leaf;
+        }
+        n = 0;
+    }
+}
+
+static void emu_cull_add_plane(emu_cull_planes* planes, float nx, float ny, float nz, float d)
+{
+    if (planes->count >= EMU_CULL_MAX_PLANES) return;
+    planes->nx[planes->count] = nx;
+    planes->ny[planes->count] = ny;
+    planes->nz[planes->count] = nz;
+    planes->d[planes->count] = d;
+    planes->count++;
+}
+
+// Sutherland-Hodgman against every plane; returns the remaining point count (0 when clipped away)
+static uint32_t emu_cull_clip_polygon(float (*points)[3], uint32_t count, const emu_cull_planes* planes)
+{
+    float scratch[EMU_CULL_MAX_POINTS][3];
+    for (uint32_t p = 0; p < planes->count && count >= 3; p++) {
+        uint32_t out = 0;
+        for (uint32_t i = 0; i < count; i++) {
+            const float* a = points[i];
+            const float* b = points[(i + 1) % count];
+            float da = planes->nx[p] * a[0] + planes->ny[p] * a[1] + planes->nz[p] * a[2] + planes->d[p];
+            float db = planes->nx[p] * b[0] + planes->ny[p] * b[1] + planes->nz[p] * b[2] + planes->d[p];
+            if (da >= 0.0f && out < EMU_CULL_MAX_POINTS) memcpy(scratch[out++], a, sizeof(float) * 3);
+            if ((da >= 0.0f) != (db >= 0.0f) && out < EMU_CULL_MAX_POINTS) {
+                float t = da / (da - db);
+                scratch[out][0] = a[0] + (b[0] - a[0]) * t;
+                scratch[out][1] = a[1] + (b[1] - a[1]) * t;
+                scratch[out][2] = a[2] + (b[2] - a[2]) * t;
+                out++;
+            }
+        }
+        memcpy(points, scratch, sizeof(float) * 3 * out);
+        count = out;
+    }
+    return count >= 3 ? count : 0;
+}
+
+// Planes through the eye and each polygon edge (facing the polygon's centroid), the portal plane, and the far plane
+static void emu_cull_narrow(emu_cull_planes* out, float (*points)[3], uint32_t count, const float eye[3],
+                            const float portal_plane[4], const emu_frustum* frustum)
+{
+    float cx = 0.0f, cy = 0.0f, cz = 0.0f;
+    for (uint32_t i = 0; i < count; i++) { cx += points[i][0]; cy += points[i][1]; cz += points[i][2]; }
+    cx /= (float)count; cy /= (float)count; cz /= (float)count;
+
+    out->count = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        const float* a = points[i];
+        const float* b = points[(i + 1) % count];
+        float ax = a[0] - eye[0], ay = a[1] - eye[1], az = a[2] - eye[2];
+        float bx = b[0] - eye[0], by = b[1] - eye[1], bz = b[2] - eye[2];
+        float nx = ay * bz - az * by, ny = az * bx - ax * bz, nz = ax * by - ay * bx;
+        float length = sqrtf(nx * nx + ny * ny + nz * nz);
+        if (length < 1e-6f) continue;
+        nx /= length; ny /= length; nz /= length;
+        float d = -(nx * eye[0] + ny * eye[1] + nz * eye[2]);
+        if (nx * cx + ny * cy + nz * cz + d < 0.0f) { nx = -nx; ny = -ny; nz = -nz; d = -d; }
+        emu_cull_add_plane(out, nx, ny, nz, d);
+    }
+    // Anything seen through the portal lies beyond it
+    emu_cull_add_plane(out, portal_plane[0], portal_plane[1], portal_plane[2], portal_plane[3]);
+    emu_cull_add_plane(out, frustum->nx[5], frustum->ny[5], frustum->nz[5], frustum->d[5]);
+}
+
+static void emu_cull_walk_cell(emu_cull_walk* walk, uint32_t cell, const emu_cull_planes* planes, uint32_t depth)
+{
+    emu_cull_context* cull = walk->cull;
+    const emu5_level* level = cull->level;
+    cull->stats.cells_visited++;
+    emu_cull_cell_leaves(walk, cell, planes);
+    if (depth >= EMU_CULL_MAX_PORTAL_DEPTH) {
+        walk->visits_left = 0; // incomplete: the caller falls back to the view frustum
+        return;
+    }
+
+    for (uint32_t i = cull->cell_portal_start[cell], end = cull->cell_portal_start[cell + 1]; i < end; i++) {
+        const emu5_portal* portal = &level->portals[cull->cell_portals[i]];
+        uint32_t next = portal->front_cell == cell ? portal->back_cell : portal->front_cell;
+        if (cull->on_path[next] || !emu_cull_cell_in_row(cull, next)) continue;
+        if (walk->visits_left == 0) return;
+        walk->visits_left--;
+
+        // Orient the portal plane so its front side is the next cell; the eye must not already be past it
+        float s = next == portal->front_cell ? 1.0f : -1.0f;
+        float plane[4] = { s * portal->nx, s * portal->ny, s * portal->nz, s * portal->d };
+        float eye_dist = plane[0] * walk->eye[0] + plane[1] * walk->eye[1] + plane[2] * walk->eye[2] + plane[3];
+        if (eye_dist > EMU_CULL_PORTAL_EPSILON) continue;
+
+        emu_cull_planes narrowed;
+        if (eye_dist > -EMU_CULL_PORTAL_EPSILON || portal->point_count > EMU_CULL_MAX_PORTAL_POINTS) {
+            narrowed = *planes; // eye on the portal, or too many points to narrow: pass the frustum through
+        } else {
+            float points[EMU_CULL_MAX_POINTS][3];
+            memcpy(points, level->portal_points + (size_t)portal->first_point * 3, sizeof(float) * 3 * portal->point_count);
+            uint32_t count = emu_cull_clip_polygon(points, portal->point_count, planes);
+            if (count == 0) continue;
+            if (count + 2 > EMU_CULL_MAX_PLANES) {
+                narrowed = *planes;
+                emu_cull_add_plane(&narrowed, plane[0], plane[1], plane[2], plane[3]);
+            } else {
+                emu_cull_narrow(&narrowed, points, count, walk->eye, plane, walk->frustum);
+            }
+        }
+
+        cull->stats.portals_passed++;
+        cull->on_path[next] = 1;
+        emu_cull_walk_cell(walk, next, &narrowed, depth + 1);
+        cull->on_path[next] = 0;
+    }
+}
+
+// Returns the number of visible leaves written to cull->visible_leaves
+static uint32_t emu_cull_cells(emu_cull_context* cull, uint32_t camera_cell, const float eye[3], const emu_frustum* frustum)
+{
+    const emu5_level* level = cull->level;
+    emu_pvs_expand_row(&level->cell_pvs, camera_cell, cull->cell_row);
+    cull->cell_row[camera_cell >> 3] |= (uint8_t)(1u << (camera_cell & 7));
+    if (++cull->stamp == 0) {
+        memset(cull->leaf_stamp, 0, sizeof(uint32_t) * level->header->leaf_count);
+        cull->stamp = 1;
+    }
+
+    emu_cull_walk walk = { cull, eye, frustum, EMU_CULL_MAX_PORTAL_VISITS, 0 };
+    emu_cull_planes planes;
+    planes.count = 6;
+    memcpy(planes.nx, frustum->nx, sizeof(frustum->nx));
+    memcpy(planes.ny, frustum->ny, sizeof(frustum->ny));
+    memcpy(planes.nz, frustum->nz, sizeof(frustum->nz));
+    memcpy(planes.d, frustum->d, sizeof(frustum->d));
+
+    cull->on_path[camera_cell] = 1;
+    emu_cull_walk_cell(&walk, camera_cell, &planes, 0);
+    cull->on_path[camera_cell] = 0;
+
+    // Out of budget: the walk is incomplete, so every cell in the row gets the plain view frustum
+    if (walk.visits_left == 0) {
+        for (uint32_t c = 0; c < level->cell_count; c++)
+            if (emu_cull_cell_in_row(cull, c)) emu_cull_cell_leaves(&walk, c, &planes);
+    }
+
+    for (uint32_t c = 0; c < level->cell_count; c++)
+        if (emu_cull_cell_in_row(cull, c)) cull->stats.pvs_leaves += cull->cell_leaf_start[c + 1] - cull->cell_leaf_start[c];
+    return walk.visible_count;
+}
+
+uint32_t emu_cull(emu_cull_context* cull, const float eye[3], const emu_frustum* frustum)
+{
+    const emu5_level* level = cull->level;
+    uint32_t leaf_count = level->header->leaf_count;
+    memset(&cull->stats, 0, sizeof(cull->stats));
+    cull->range_count = 0;
+
+    int32_t camera_leaf = emu_locate_leaf(level, eye[0], eye[1], eye[2]);
+    cull->stats.camera_leaf = camera_leaf;
+    uint32_t lo_word = UINT32_MAX, hi_word = 0;
+
+    if (level->cell_count > 0 && camera_leaf >= 0 && level->cell_of_leaf[camera_leaf] < level->cell_count) {
+        // Cell mode: the portal walk has already frustum-tested every leaf it returns
+        uint32_t visible = emu_cull_cells(cull, level->cell_of_leaf[camera_leaf], eye, frustum);
+        cull->stats.frustum_leaves = visible;
+        for (uint32_t i = 0; i < visible; i++) emu_cull_mark_faces(cull, cull->visible_leaves[i], &lo_word, &hi_word);
+    } else {
+        // 1. Camera leaf and its PVS row (every leaf if the camera is outside the tree or the level uses cells)
+        uint32_t candidates;
+        if (camera_leaf >= 0 && level->cell_count == 0) {
+            candidates = emu_pvs_visible_leaves(&level->pvs, (uint32_t)camera_leaf, cull->visible_leaves, leaf_count);
+            if (candidates > leaf_count) candidates = leaf_count;
+        } else {
+            for (uint32_t i = 0; i < leaf_count; i++) cull->visible_leaves[i] = i;
+            candidates = leaf_count;
+        }
+        cull->stats.pvs_leaves = candidates;
+
+        // 2. Frustum test four boxes at a time; mark surviving leaves' faces in the face bitset
+        for (uint32_t i = 0; i < candidates; i += 4) {
+            uint32_t n = candidates - i < 4 ? candidates - i : 4;
+            uint32_t mask = emu_cull_boxes4(level, cull->visible_leaves + i, n, frustum->nx, frustum->ny, frustum->nz, frustum->d, 6);
+            while (mask) {
+                uint32_t leaf = cull->visible_leaves[i + emu_ctz64(mask)];
+                mask &= mask - 1;
+                cull->stats.frustum_leaves++;
+                emu_cull_mark_faces(cull, leaf, &lo_word, &hi_word);
+            }
+        }
+    }
+    if (lo_word == UINT32_MAX || lo_word > hi_word) return 0;
+
+    // 3. Ascending, deduplicated face ranges
+    return emu_cull_emit_ranges(cull, lo_word, hi_word);
+}
@@ -0,0 +1,74 @@
+#ifndef EMU_CULL_H
+#define EMU_CULL_H
+
+#include <stdint.h>
+#include "emu5.h"
+
+// Runtime visibility for EMU v5 levels: BSP leaf lookup -> PVS row -> leaf AABB vs frustum -> face ranges.
+//
+//   emu_cull_context cull;
+//   emu_cull_init(&cull, &level);
+//   emu_frustum_from_matrix(&frustum, view_proj);
+//   uint32_t n = emu_cull(&cull, eye, &frustum);
+//   for (i < n) draw faces [cull.ranges[i].first, first + count) from level.faces
+//
+// Face ranges are deduplicated (a face shared by several visible leaves is drawn once) and ascending.
+//
+// Levels exported with cell/portal visibility (EMU5_FLAG_CELLS) replace the PVS row with the camera cell's row and a
+// portal walk: each portal seen through narrows the frustum to planes through the eye and the portal's visible edges,
+// and a cell's leaves are tested against the frustum of the path that reached it.
+
+#define EMU_CULL_MAX_PLANES 16          // planes in a narrowed frustum
+#define EMU_CULL_MAX_PORTAL_VISITS 4096 // per cull; past this the remaining PVS cells use the view frustum
+
+typedef struct emu_frustum {
+    // Six planes in SoA, inside is nx*x + ny*y + nz*z + d >= 0: left, right, bottom, top, near, far
+    float nx[6], ny[6], nz[6], d[6];
+} emu_frustum;
+
+typedef struct emu_face_range {
+    uint32_t first;
+    uint32_t count;
+} emu_face_range;
+
+typedef struct emu_cull_stats {
+    int32_t camera_leaf;      // -1 when the camera is outside every leaf (PVS is then skipped)
+    uint32_t pvs_leaves;      // leaves in the camera's PVS row
+    uint32_t frustum_leaves;  // of those, leaves whose box touches the frustum
+    uint32_t faces_drawn;
+    uint32_t cells_visited;   // cell mode: cells reached through portals (camera cell included)
+    uint32_t portals_passed;
+} emu_cull_stats;
+
+typedef struct emu_cull_context {
+    const emu5_level* level;
+    uint32_t* visible_leaves;  // leaf_count scratch
+    uint64_t* face_bits;       // one bit per face, cleared after every cull
+    emu_face_range* ranges;    // output, at most (face_count + 1) / 2 entries
+    uint32_t range_count;
+    emu_cull_stats stats;
+
+    // Cell mode only (NULL otherwise)
+    uint32_t* cell_leaf_start;    // cell_count + 1, ranges into cell_leaves
+    uint32_t* cell_leaves;
+    uint32_t* cell_portal_start;  // cell_count + 1, ranges into cell_portals
+    uint32_t* cell_portals;       // each usable portal is listed under both of its cells
+    uint8_t* cell_row;            // expanded PVS row of the camera cell
+    uint8_t* on_path;             // cells on the current portal path
+    uint32_t* leaf_stamp;         // leaf_stamp[leaf] == stamp once the leaf is visible this cull
+    uint32_t stamp;
+} emu_cull_context;
+
+// Builds the six planes from a column-major OpenGL-style view-projection matrix (clip = M * world).
+void emu_frustum_from_matrix(emu_frustum* frustum, const float m[16]);
+
+// Walks the BSP to the leaf containing (x, y, z). Returns -1 if the level has no leaves.
+int32_t emu_locate_leaf(const emu5_level* level, float x, float y, float z);
+
+int emu_cull_init(emu_cull_context* cull, const emu5_level* level);
+void emu_cull_free(emu_cull_context* cull);
+
+// Culls for one view and fills cull->ranges. Returns the number of ranges.
+uint32_t emu_cull(emu_cull_context* cull, const float eye[3], const emu_frustum* frustum);
+
+#endif
@@ -0,0 +1,101 @@
+// Replays a recorded camera path (.cam from RecordCamera) over an EMU v5 level and times emu_cull per frame.
+//
+//   cc -O2 -I. emu_cull_bench.c emu_cull.c emu5.c emu_pvs.c cam0.c ztime.c -lm -o emu_cull_bench
+//   ./emu_cull_bench level.emu path.cam [repeat]
+
+#include "cam0.h"
+#include "emu_cull.h"
+#include "ztime.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct bench_view {
+    float eye[3];
+    float view_proj[16];
+} bench_view;
+
+int main(int argc, char** argv)
+{
+    if (argc < 3) {
+        fprintf(stderr, "usage: %s level.emu path.cam [repeat]\n", argv[0]);
+        return 1;
+    }
+    int repeat = argc > 3 ? atoi(argv[3]) : 1;
+    if (repeat < 1) repeat = 1;
+
+    emu5_level level;
+    int result = emu5_map(&level, argv[1]);
+    if (result != EMU5_OK) {
+        fprintf(stderr, "%s: not an EMU v5 level (error %d)\n", argv[1], result);
+        return 1;
+    }
+
+    cam0_track track;
+    result = cam0_load(&track, argv[2]);
+    if (result != CAM0_OK) {
+        fprintf(stderr, "%s: not a CAM0 track (error %d)\n", argv[2], result);
+        emu5_unmap(&level);
+        return 1;
+    }
+    uint32_t frames = track.keyframe_count;
+
+    // Build every view up front so the timed loop measures culling only
+    bench_view* views = (bench_view*)malloc(sizeof(bench_view) * (frames ? frames : 1));
+    for (uint32_t i = 0; i < frames; i++) {
+        cam0_pose pose;
+        cam0_sample_frame(&track, (double)i, &pose);
+        cam0_view_proj(&pose, 16.0f / 9.0f, 0.1f, 1000.0f, views[i].view_proj);
+        memcpy(views[i].eye, pose.pos, sizeof(pose.pos));
+    }
+    cam0_free(&track);
+
+    emu_cull_context cull;
+    if (emu_cull_init(&cull, &level) != 0) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+
+    uint32_t face_count = level.header->face_count;
+    double total_us = 0.0, worst_us = 0.0;
+    uint64_t faces_drawn = 0, pvs_leaves = 0, frustum_leaves = 0, ranges = 0, outside = 0, cells = 0, portals = 0;
+    for (int pass = 0; pass < repeat; pass++) {
+        for (uint32_t i = 0; i < frames; i++) {
+            emu_frustum frustum;
+            double start = ztime_now_us();
+            emu_frustum_from_matrix(&frustum, views[i].view_proj);
+            ranges += emu_cull(&cull, views[i].eye, &frustum);
+            double elapsed = ztime_now_us() - start;
+            total_us += elapsed;
+            if (elapsed > worst_us) worst_us = elapsed;
+            faces_drawn += cull.stats.faces_drawn;
+            pvs_leaves += cull.stats.pvs_leaves;
+            frustum_leaves += cull.stats.frustum_leaves;
+            outside += cull.stats.camera_leaf < 0;
+            cells += cull.stats.cells_visited;
+            portals += cull.stats.portals_passed;
+        }
+    }
+
+    uint64_t samples = (uint64_t)frames * (uint64_t)repeat;
+    if (samples == 0) {
+        printf("%s: no keyframes\n", argv[2]);
+    } else {
+        double n = (double)samples;
+        double drawn = (double)faces_drawn / n;
+        printf("level: %u faces, %u leaves, %u BSP nodes\n", face_count, level.header->leaf_count, level.bsp_node_count);
+        printf("path:  %u frames x %d, camera outside the tree in %llu\n", frames, repeat, (unsigned long long)outside);
+        printf("leaves/frame: %.1f in PVS, %.1f after frustum\n", (double)pvs_leaves / n, (double)frustum_leaves / n);
+        if (level.cell_count > 0)
+            printf("cells/frame: %.1f visited of %u through %.1f portals (%u portals total)\n", (double)cells / n,
+                   level.cell_count, (double)portals / n, level.portal_count);
+        printf("triangles/frame: %.1f drawn of %u (%.1f%% culled) in %.1f ranges\n", drawn, face_count,
+               face_count ? 100.0 * (1.0 - drawn / face_count) : 0.0, (double)ranges / n);
+        printf("cull time: %.2f us/frame average, %.2f us worst\n", total_us / n, worst_us);
+    }
+
+    emu_cull_free(&cull);
+    free(views);
+    emu5_unmap(&level);
+    return 0;
+}
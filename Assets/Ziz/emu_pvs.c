@@ -0,0 +1,125 @@
+#include "emu_pvs.h"
+#include <string.h>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+static inline uint32_t emu_ctz32(uint32_t x) { unsigned long i; _BitScanForward(&i, x); return (uint32_t)i; }
+#else
+static inline uint32_t emu_ctz32(uint32_t x) { return (uint32_t)__builtin_ctz(x); }
+#endif
+
+// Offsets sit wherever the section does; EMU v4 puts a variable-length header before it, so read without alignment
+static inline uint32_t emu_pvs_read_u32(const uint8_t* p)
+{
+    uint32_t v;
+    memcpy(&v, p, 4);
+    return v;
+}
+
+size_t emu_pvs_bind(emu_pvs* pvs, const void* data, size_t size, uint32_t leaf_count)
+{
+    const uint8_t* p = (const uint8_t*)data;
+    uint32_t header;
+    if (size < 4) return 0;
+    memcpy(&header, p, 4);
+
+    pvs->leaf_count = leaf_count;
+    pvs->row_bytes = header & ~EMU_PVS_RLE;
+    if (pvs->row_bytes != (leaf_count + 7) / 8) return 0;
+
+    if (!(header & EMU_PVS_RLE)) {
+        size_t total = 4 + (size_t)leaf_count * pvs->row_bytes;
+        if (total > size) return 0;
+        pvs->row_offsets = NULL;
+        pvs->rows = p + 4;
+        return total;
+    }
+
+    size_t table = ((size_t)leaf_count + 1) * 4;
+    if (4 + table > size) return 0;
+    pvs->row_offsets = p + 4;
+    pvs->rows = p + 4 + table;
+    if (!emu_pvs_offsets_ok(pvs->row_offsets, leaf_count, size - 4 - table)) return 0;
+    return 4 + table + emu_pvs_read_u32(pvs->row_offsets + (size_t)leaf_count * 4);
+}
+
+int emu_pvs_offsets_ok(const void* offsets, uint32_t count, size_t data_size)
+{
+    const uint8_t* p = (const uint8_t*)offsets;
+    uint32_t previous = emu_pvs_read_u32(p);
+    for (uint32_t i = 1; i <= count; i++) {
+        uint32_t offset = emu_pvs_read_u32(p + (size_t)i * 4);
+        if (offset < previous) return 0;
+        previous = offset;
+    }
+    return previous <= data_size;
+}
+
+uint32_t emu_pvs_visible_leaves(const emu_pvs* pvs, uint32_t leaf, uint32_t* visible, uint32_t max_visible)
+{
+    uint32_t count = 0;
+    if (leaf >= pvs->leaf_count) return 0;
+
+    if (!pvs->row_offsets) {
+        // Raw row: walk 32 leaves at a time and peel set bits with ctz
+        const uint8_t* row = pvs->rows + (size_t)leaf * pvs->row_bytes;
+        for (uint32_t byte = 0; byte < pvs->row_bytes; byte += 4) {
+            uint32_t word = 0;
+            uint32_t n = pvs->row_bytes - byte < 4 ? pvs->row_bytes - byte : 4;
+            memcpy(&word, row + byte, n); // little-endian: byte k holds leaves 8k..8k+7
+            while (word) {
+                uint32_t index = byte * 8 + emu_ctz32(word);
+                if (index >= pvs->leaf_count) break;
+                if (count < max_visible) visible[count] = index;
+                count++;
+                word &= word - 1;
+            }
+        }
+        return count;
+    }
+
+    const uint8_t* src = pvs->rows + emu_pvs_read_u32(pvs->row_offsets + (size_t)leaf * 4);
+    const uint8_t* end = pvs->rows + emu_pvs_read_u32(pvs->row_offsets + (size_t)leaf * 4 + 4);
+    uint32_t base = 0;
+    while (src < end) {
+        uint32_t bits = *src++;
+        if (bits == 0) {
+            // Zero run: skip whole bytes of invisible leaves without touching them
+            base += 8u * (src < end ? *src++ : 0u);
+            continue;
+        }
+        do {
+            uint32_t index = base + emu_ctz32(bits);
+            if (index < pvs->leaf_count) {
+                if (count < max_visible) visible[count] = index;
+                count++;
+            }
+            bits &= bits - 1;
+        } while (bits);
+        base += 8;
+    }
+    return count;
+}
+
+void emu_pvs_expand_row(const emu_pvs* pvs, uint32_t leaf, uint8_t* out)
+{
+    memset(out, 0, pvs->row_bytes);
+    if (leaf >= pvs->leaf_count) return;
+
+    if (!pvs->row_offsets) {
+        memcpy(out, pvs->rows + (size_t)leaf * pvs->row_bytes, pvs->row_bytes);
+        return;
+    }
+
+    const uint8_t* src = pvs->rows + emu_pvs_read_u32(pvs->row_offsets + (size_t)leaf * 4);
+    const uint8_t* end = pvs->rows + emu_pvs_read_u32(pvs->row_offsets + (size_t)leaf * 4 + 4);
+    uint32_t pos = 0;
+    while (src < end && pos < pvs->row_bytes) {
+        uint8_t b = *src++;
+        if (b == 0) {
+            pos += src < end ? *src++ : 0u;
+            continue;
+        }
+        out[pos++] = b;
+    }
+}
@@ -0,0 +1,38 @@
+#ifndef EMU_PVS_H
+#define EMU_PVS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// PVS rows as written by Level.WriteEMUFile.
+//
+// Raw rows (EMU v4 default): pvs_bytes, then leaf_count rows of pvs_bytes bytes. Leaf j is bit (j & 7) of byte j >> 3.
+//
+// RLE rows (pvs_bytes has EMU_PVS_RLE set): pvs_bytes, then leaf_count + 1 uint32 row offsets into the blob that
+// follows them. Each row is Quake-style zero-run coded: a nonzero byte is 8 literal leaf bits, a zero byte is followed
+// by the number of zero bytes it stands for (1..255). Trailing zeros are dropped, so a row ends at the next offset.
+
+#define EMU_PVS_RLE 0x80000000u
+
+typedef struct emu_pvs {
+    uint32_t leaf_count;
+    uint32_t row_bytes;            // bytes in an expanded row, (leaf_count + 7) / 8
+    const uint8_t* row_offsets;    // leaf_count + 1 uint32 offsets into rows, any alignment; NULL for raw rows
+    const uint8_t* rows;
+} emu_pvs;
+
+// Points pvs at the PVS section starting at data (the pvs_bytes field). Nothing is copied; data must outlive pvs.
+// Returns the number of bytes the section occupies, or 0 if it does not fit in size.
+size_t emu_pvs_bind(emu_pvs* pvs, const void* data, size_t size, uint32_t leaf_count);
+
+// Nonzero if offsets[0..count] never decrease and the last is at most data_size, so every row lies inside the data
+int emu_pvs_offsets_ok(const void* offsets, uint32_t count, size_t data_size);
+
+// Writes the indices of every leaf visible from leaf into visible (at most max_visible, in ascending order).
+// Returns the number of visible leaves, which may exceed max_visible; only the first max_visible are written.
+uint32_t emu_pvs_visible_leaves(const emu_pvs* pvs, uint32_t leaf, uint32_t* visible, uint32_t max_visible);
+
+// Expands leaf's row into out (row_bytes bytes).
+void emu_pvs_expand_row(const emu_pvs* pvs, uint32_t leaf, uint8_t* out);
+
+#endif
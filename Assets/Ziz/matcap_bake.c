@@ -0,0 +1,514 @@
+#include "matcap_bake.h"
+#include "band_pool.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define MATCAP_SSE 1
+#include <xmmintrin.h>
+#endif
+
+#define MATCAP_TILE 8
+#define MATCAP_SAMPLES 64
+#define MATCAP_PI 3.14159265359f
+#define MATCAP_UV_SCALE 0.47f    // Actor/MatCap: uv = normal.xy * 0.47 + 0.5
+
+// The shading is written once over matcap_v: four texels per value with SSE, one without. Both evaluate the same
+// operations in the same order, so they give the same bits.
+#if MATCAP_SSE
+#define MATCAP_LANES 4
+typedef __m128 matcap_v;
+#define MATCAP_SET(s) _mm_set1_ps(s)
+#define MATCAP_LOAD(p) _mm_loadu_ps(p)
+#define MATCAP_STORE(p, v) _mm_storeu_ps(p, v)
+#define MATCAP_ADD(a, b) _mm_add_ps(a, b)
+#define MATCAP_SUB(a, b) _mm_sub_ps(a, b)
+#define MATCAP_MUL(a, b) _mm_mul_ps(a, b)
+#define MATCAP_DIV(a, b) _mm_div_ps(a, b)
+#define MATCAP_MIN(a, b) _mm_min_ps(a, b)
+#define MATCAP_MAX(a, b) _mm_max_ps(a, b)
+#define MATCAP_SQRT(a) _mm_sqrt_ps(a)
+#else
+#define MATCAP_LANES 1
+typedef float matcap_v;
+#define MATCAP_SET(s) (s)
+#define MATCAP_LOAD(p) (*(p))
+#define MATCAP_STORE(p, v) (*(p) = (v))
+#define MATCAP_ADD(a, b) ((a) + (b))
+#define MATCAP_SUB(a, b) ((a) - (b))
+#define MATCAP_MUL(a, b) ((a) * (b))
+#define MATCAP_DIV(a, b) ((a) / (b))
+// Same semantics as _mm_min_ps/_mm_max_ps: the second operand on ties and NaN
+#define MATCAP_MIN(a, b) ((a) < (b) ? (a) : (b))
+#define MATCAP_MAX(a, b) ((a) > (b) ? (a) : (b))
+#define MATCAP_SQRT(a) sqrtf(a)
+#endif
+
+// Bounce directions, a Hammersley set mapped the way the shader maps its random numbers
+typedef struct matcap_samples {
+    float cosine[3][MATCAP_SAMPLES];     // cosWeightedRandomHemisphereDirection in the normal's frame
+    float sphere[3][MATCAP_SAMPLES];     // randomSphereDirection
+} matcap_samples;
+
+static void matcap_samples_init(matcap_samples* s)
+{
+    for (uint32_t k = 0; k < MATCAP_SAMPLES; k++) {
+        uint32_t bits = k;
+        bits = (bits << 16) | (bits >> 16);
+        bits = ((bits & 0x55555555u) << 1) | ((bits & 0xAAAAAAAAu) >> 1);
+        bits = ((bits & 0x33333333u) << 2) | ((bits & 0xCCCCCCCCu) >> 2);
+        bits = ((bits & 0x0F0F0F0Fu) << 4) | ((bits & 0xF0F0F0F0u) >> 4);
+        bits = ((bits & 0x00FF00FFu) << 8) | ((bits & 0xFF00FF00u) >> 8);
+        float u = ((float)k + 0.5f) / (float)MATCAP_SAMPLES;
+        float v = (float)bits * (1.0f / 4294967296.0f) + 0.5f / (float)MATCAP_SAMPLES;
+
+        float ra = sqrtf(v), angle = 2.0f * MATCAP_PI * u;
+        s->cosine[0][k] = ra * cosf(angle);
+        s->cosine[1][k] = ra * sinf(angle);
+        s->cosine[2][k] = sqrtf(1.0f - v);
+
+        float z = 2.0f * v - 1.0f, r = sqrtf(1.0f - z * z);
+        s->sphere[0][k] = r * sinf(angle);
+        s->sphere[1][k] = r * cosf(angle);
+        s->sphere[2][k] = z;
+    }
+}
+
+void matcap_material_defaults(matcap_material* material)
+{
+    memset(material, 0, sizeof(*material));
+    for (int c = 0; c < 3; c++) {
+        material->base_color[c] = 0.5f;
+        material->light_color[c] = 1.0f;
+        material->point_color[c] = 1.0f;
+        material->light_dir[c] = 0.577f;
+        material->point_position[c] = 2.0f;
+    }
+    material->roughness = 0.25f;
+    material->ior = 1.5f;
+    material->sky_top[0] = 0.7f;
+    material->sky_top[1] = 0.8f;
+    material->sky_top[2] = 1.0f;
+    material->sky_horizon[0] = 0.35f;
+    material->sky_horizon[1] = 0.4f;
+    material->sky_horizon[2] = 0.5f;
+    material->light_intensity = 1.0f;
+    material->point_intensity = 0.5f;
+    material->aces = 1;
+}
+
+uint32_t matcap_mip_levels(uint32_t size, uint32_t mip_count)
+{
+    uint32_t levels = 1;
+    for (uint32_t s = size; s > 1; s >>= 1) levels++;
+    return mip_count == 0 || mip_count > levels ? levels : mip_count;
+}
+
+static uint32_t matcap_level_size(uint32_t size, uint32_t level)
+{
+    uint32_t s = size >> level;
+    return s ? s : 1;
+}
+
+size_t matcap_bake_size(texel_format format, uint32_t size, uint32_t mip_count)
+{
+    size_t total = 0;
+    uint32_t levels = matcap_mip_levels(size, mip_count);
+    for (uint32_t l = 0; l < levels; l++) {
+        uint32_t s = matcap_level_size(size, l);
+        total += texel_image_size(format, s, s);
+    }
+    return total;
+}
+
+static float matcap_max3(const float c[3]) { return c[0] > c[1] ? (c[0] > c[2] ? c[0] : c[2]) : (c[1] > c[2] ? c[1] : c[2]); }
+
+// Directional or point light at the first hit, as traceEyePath evaluates it; the sphere never shadows a point that
+// faces the light, so the shadow ray is left out. The view direction is +z.
+static void matcap_light(const matcap_material* m, const matcap_v n[3], const matcap_v l[3], const matcap_v scale[3],
+                         matcap_v rgb[3])
+{
+    matcap_v zero = MATCAP_SET(0.0f), one = MATCAP_SET(1.0f);
+    matcap_v hx = l[0], hy = l[1], hz = MATCAP_ADD(l[2], one);
+    matcap_v hlen = MATCAP_SQRT(MATCAP_MAX(MATCAP_ADD(MATCAP_ADD(MATCAP_MUL(hx, hx), MATCAP_MUL(hy, hy)), MATCAP_MUL(hz, hz)), MATCAP_SET(1e-12f)));
+    hx = MATCAP_DIV(hx, hlen);
+    hy = MATCAP_DIV(hy, hlen);
+    hz = MATCAP_DIV(hz, hlen);
+
+    matcap_v n_dot_l = MATCAP_ADD(MATCAP_ADD(MATCAP_MUL(n[0], l[0]), MATCAP_MUL(n[1], l[1])), MATCAP_MUL(n[2], l[2]));
+    n_dot_l = MATCAP_MIN(MATCAP_MAX(n_dot_l, zero), one);
+    matcap_v n_dot_h = MATCAP_ADD(MATCAP_ADD(MATCAP_MUL(n[0], hx), MATCAP_MUL(n[1], hy)), MATCAP_MUL(n[2], hz));
+    n_dot_h = MATCAP_MIN(MATCAP_MAX(n_dot_h, zero), one);
+    matcap_v n_dot_v = MATCAP_MIN(MATCAP_MAX(n[2], zero), one);
+    matcap_v h_dot_l = MATCAP_ADD(MATCAP_ADD(MATCAP_MUL(hx, l[0]), MATCAP_MUL(hy, l[1])), MATCAP_MUL(hz, l[2]));
+    h_dot_l = MATCAP_MIN(MATCAP_MAX(h_dot_l, zero), one);
+
+    // D_GGX(NdotH, roughness^2) and GeometryTerm(NdotL, NdotV, roughness^2)
+    float r = m->roughness * m->roughness;
+    float a2 = r * r * r * r;
+    a2 = a2 > 1e-10f ? a2 : 1e-10f;
+    matcap_v denom = MATCAP_ADD(MATCAP_MUL(MATCAP_MUL(n_dot_h, n_dot_h), MATCAP_SET(a2 - 1.0f)), one);
+    matcap_v d = MATCAP_DIV(MATCAP_SET(a2), MATCAP_MUL(MATCAP_SET(MATCAP_PI), MATCAP_MUL(denom, denom)));
+    matcap_v g2 = MATCAP_SET(r * r);
+    matcap_v lambda_v = MATCAP_MUL(n_dot_v, MATCAP_SQRT(MATCAP_ADD(MATCAP_MUL(MATCAP_SUB(n_dot_v, MATCAP_MUL(n_dot_v, g2)), n_dot_v), g2)));
+    matcap_v lambda_l = MATCAP_MUL(n_dot_l, MATCAP_SQRT(MATCAP_ADD(MATCAP_MUL(MATCAP_SUB(n_dot_l, MATCAP_MUL(n_dot_l, g2)), n_dot_l), g2)));
+    matcap_v g = MATCAP_DIV(MATCAP_SET(0.5f), MATCAP_ADD(MATCAP_ADD(lambda_v, lambda_l), MATCAP_SET(1e-6f)));
+    matcap_v dg = MATCAP_DIV(MATCAP_MUL(d, g), MATCAP_MAX(MATCAP_MUL(MATCAP_MUL(MATCAP_SET(4.0f), n_dot_l), n_dot_v), MATCAP_SET(0.001f)));
+
+    // pow(1 - HdotL, 5) for Schlick, pow(NdotL, 1.7) for the shader's soft falloff
+    matcap_v m1 = MATCAP_SUB(one, h_dot_l);
+    matcap_v m2 = MATCAP_MUL(m1, m1);
+    matcap_v schlick = MATCAP_MUL(MATCAP_MUL(m2, m2), m1);
+    float lanes[MATCAP_LANES];
+    MATCAP_STORE(lanes, n_dot_l);
+    for (int i = 0; i < MATCAP_LANES; i++) lanes[i] = powf(lanes[i], 1.7f);
+    matcap_v falloff = MATCAP_LOAD(lanes);
+
+    for (int c = 0; c < 3; c++) {
+        float f0 = 0.04f + (m->base_color[c] - 0.04f) * m->metallic;
+        matcap_v f = MATCAP_ADD(MATCAP_SET(f0), MATCAP_MUL(MATCAP_SET(1.0f - f0), schlick));
+        matcap_v diffuse = MATCAP_SET((1.0f - m->metallic) * m->base_color[c] / MATCAP_PI);
+        matcap_v brdf = MATCAP_ADD(diffuse, MATCAP_MUL(dg, f));
+        rgb[c] = MATCAP_ADD(rgb[c], MATCAP_MUL(MATCAP_MUL(brdf, falloff), scale[c]));
+    }
+}
+
+static matcap_v matcap_saturate(matcap_v x) { return MATCAP_MIN(MATCAP_MAX(x, MATCAP_SET(0.0f)), MATCAP_SET(1.0f)); }
+
+// Mean of saturate(dir.y) over the blurred reflections normalize(lerp(bounce, mirror, 1 - roughness))
+static matcap_v matcap_glossy(const matcap_samples* s, const matcap_v n[3], const matcap_v t[3], const matcap_v b[3],
+                              const matcap_v mirror[3], float roughness)
+{
+    matcap_v sum = MATCAP_SET(0.0f), w = MATCAP_SET(1.0f - roughness);
+    for (int k = 0; k < MATCAP_SAMPLES; k++) {
+        matcap_v c0 = MATCAP_SET(s->cosine[0][k]), c1 = MATCAP_SET(s->cosine[1][k]), c2 = MATCAP_SET(s->cosine[2][k]);
+        matcap_v d[3];
+        for (int i = 0; i < 3; i++) {
+            matcap_v bounce = MATCAP_ADD(MATCAP_ADD(MATCAP_MUL(c0, t[i]), MATCAP_MUL(c1, b[i])), MATCAP_MUL(c2, n[i]));
+            d[i] = MATCAP_ADD(bounce, MATCAP_MUL(MATCAP_SUB(mirror[i], bounce), w));
+        }
+        matcap_v len2 = MATCAP_ADD(MATCAP_ADD(MATCAP_MUL(d[0], d[0]), MATCAP_MUL(d[1], d[1])), MATCAP_MUL(d[2], d[2]));
+        matcap_v y = MATCAP_DIV(d[1], MATCAP_SQRT(MATCAP_MAX(len2, MATCAP_SET(1e-12f))));
+        sum = MATCAP_ADD(sum, matcap_saturate(y));
+    }
+    return MATCAP_MUL(sum, MATCAP_SET(1.0f / MATCAP_SAMPLES));
+}
+
+// Shades one block of normals (unit, z >= 0) into tonemapped color before gamma
+static void matcap_shade_block(const matcap_material* m, const matcap_samples* s, const float normal[3][MATCAP_LANES],
+                               float out[3][MATCAP_LANES])
+{
+    matcap_v zero = MATCAP_SET(0.0f), one = MATCAP_SET(1.0f);
+    matcap_v n[3], rgb[3];
+    for (int i = 0; i < 3; i++) {
+        n[i] = MATCAP_LOAD(normal[i]);
+        rgb[i] = MATCAP_SET(m->emissive[i]);
+    }
+
+    // The eye ray is -z, so its mirror reflection is 2 nz n - z
+    matcap_v nz2 = MATCAP_MUL(MATCAP_SET(2.0f), n[2]);
+    matcap_v mirror[3] = { MATCAP_MUL(nz2, n[0]), MATCAP_MUL(nz2, n[1]), MATCAP_SUB(MATCAP_MUL(nz2, n[2]), one) };
+    matcap_v mirror_sky = matcap_saturate(mirror[1]);
+    // 1 - |dot(eye ray, n)|
+    matcap_v grazing = MATCAP_SUB(one, n[2]);
+
+    float albedo_max = matcap_max3(m->base_color);
+    float tint[3], tint2[3];
+    // Each term is weight * sky(E) for a mean E of saturate(dir.y) over its bounce directions
+    matcap_v weight[2], e[2];
+    int terms = 0;
+
+    if (m->transparency <= 0.0f) {
+        if (m->light_intensity > 0.0f) {
+            float lx = -m->light_dir[0], ly = -m->light_dir[1], lz = -m->light_dir[2];
+            float len = sqrtf(lx * lx + ly * ly + lz * lz);
+            if (len > 0.0f) {
+                matcap_v l[3] = { MATCAP_SET(lx / len), MATCAP_SET(ly / len), MATCAP_SET(lz / len) };
+                matcap_v scale[3];
+                for (int c = 0; c < 3; c++) scale[c] = MATCAP_SET(m->light_color[c] * m->light_intensity);
+                matcap_light(m, n, l, scale, rgb);
+            }
+        }
+        const float* p = m->point_position;
+        if (m->point_intensity > 0.0f && sqrtf(p[0] * p[0] + p[1] * p[1] + p[2] * p[2]) > 0.1f) {
+            matcap_v l[3] = { MATCAP_SUB(MATCAP_SET(p[0]), n[0]), MATCAP_SUB(MATCAP_SET(p[1]), n[1]), MATCAP_SUB(MATCAP_SET(p[2]), n[2]) };
+            matcap_v dist2 = MATCAP_ADD(MATCAP_ADD(MATCAP_MUL(l[0], l[0]), MATCAP_MUL(l[1], l[1])), MATCAP_MUL(l[2], l[2]));
+            matcap_v dist = MATCAP_SQRT(MATCAP_MAX(dist2, MATCAP_SET(1e-12f)));
+            for (int i = 0; i < 3; i++) l[i] = MATCAP_DIV(l[i], dist);
+            matcap_v attenuation = MATCAP_DIV(one, MATCAP_ADD(MATCAP_ADD(one, MATCAP_MUL(MATCAP_SET(0.1f), dist)),
+                                                              MATCAP_MUL(MATCAP_SET(0.01f), MATCAP_MUL(dist, dist))));
+            matcap_v scale[3];
+            for (int c = 0; c < 3; c++) scale[c] = MATCAP_MUL(MATCAP_SET(m->point_color[c] * m->point_intensity), attenuation);
+            matcap_light(m, n, l, scale, rgb);
+        }
+
+        // getBRDFRay, then fcol *= albedo where the shader applies it and fcol /= max(fcol)
+        int specular = m->metallic > 0.5f || m->roughness < 0.1f;
+        int tinted = !specular || m->metallic > 0.5f;
+        for (int c = 0; c < 3; c++) tint[c] = !tinted ? 1.0f : albedo_max > 0.0f ? m->base_color[c] / albedo_max : 0.0f;
+
+        // Frisvad's frame about n; with z >= 0 it needs no branch
+        matcap_v a = MATCAP_DIV(MATCAP_SET(-1.0f), MATCAP_ADD(one, n[2]));
+        matcap_v bxy = MATCAP_MUL(MATCAP_MUL(n[0], n[1]), a);
+        matcap_v t[3] = { MATCAP_ADD(one, MATCAP_MUL(MATCAP_MUL(n[0], n[0]), a)), bxy, MATCAP_SUB(zero, n[0]) };
+        matcap_v b[3] = { bxy, MATCAP_ADD(one, MATCAP_MUL(MATCAP_MUL(n[1], n[1]), a)), MATCAP_SUB(zero, n[1]) };
+
+        weight[0] = one;
+        if (!specular) {
+            // Cosine-weighted bounce: only dir.y matters to the sky
+            matcap_v sum = zero;
+            for (int k = 0; k < MATCAP_SAMPLES; k++) {
+                matcap_v y = MATCAP_ADD(MATCAP_ADD(MATCAP_MUL(MATCAP_SET(s->cosine[0][k]), t[1]), MATCAP_MUL(MATCAP_SET(s->cosine[1][k]), b[1])),
+                                        MATCAP_MUL(MATCAP_SET(s->cosine[2][k]), n[1]));
+                sum = MATCAP_ADD(sum, matcap_saturate(y));
+            }
+            e[0] = MATCAP_MUL(sum, MATCAP_SET(1.0f / MATCAP_SAMPLES));
+        } else if (m->metallic > 0.8f) {
+            e[0] = mirror_sky;
+        } else {
+            // Mirror with the Schlick probability of the material's IOR, blurred reflection otherwise
+            float r0 = (1.0f - m->ior) / (1.0f + m->ior);
+            r0 *= r0;
+            matcap_v g2 = MATCAP_MUL(grazing, grazing);
+            matcap_v fresnel = MATCAP_ADD(MATCAP_SET(r0), MATCAP_MUL(MATCAP_SET(1.0f - r0), MATCAP_MUL(MATCAP_MUL(g2, g2), grazing)));
+            matcap_v glossy = matcap_glossy(s, n, t, b, mirror, m->roughness);
+            e[0] = MATCAP_ADD(MATCAP_MUL(fresnel, mirror_sky), MATCAP_MUL(MATCAP_SUB(one, fresnel), glossy));
+        }
+        terms = 1;
+    } else {
+        // Reflected with probability 0.3 * fresnel, untinted; otherwise transmitted through a perturbed normal
+        matcap_v g2 = MATCAP_MUL(grazing, grazing);
+        matcap_v reflect = MATCAP_MUL(MATCAP_SET(0.3f), MATCAP_ADD(MATCAP_MUL(g2, MATCAP_SET(0.5f)), MATCAP_SET(0.5f)));
+        for (int c = 0; c < 3; c++) {
+            tint[c] = 1.0f;
+            tint2[c] = 1.0f + (m->base_color[c] - 1.0f) * m->transparency * 0.3f;
+        }
+        weight[0] = reflect;
+        e[0] = mirror_sky;
+
+        matcap_v bend = MATCAP_SET((1.0f - m->transparency) * 0.15f), sum = zero;
+        for (int k = 0; k < MATCAP_SAMPLES; k++) {
+            matcap_v p[3];
+            for (int i = 0; i < 3; i++) p[i] = MATCAP_ADD(n[i], MATCAP_MUL(MATCAP_SET(s->sphere[i][k]), MATCAP_SET(0.2f)));
+            matcap_v plen2 = MATCAP_ADD(MATCAP_ADD(MATCAP_MUL(p[0], p[0]), MATCAP_MUL(p[1], p[1])), MATCAP_MUL(p[2], p[2]));
+            matcap_v pscale = MATCAP_DIV(bend, MATCAP_SQRT(MATCAP_MAX(plen2, MATCAP_SET(1e-12f))));
+            matcap_v d0 = MATCAP_MUL(p[0], pscale), d1 = MATCAP_MUL(p[1], pscale);
+            matcap_v d2 = MATCAP_SUB(MATCAP_MUL(p[2], pscale), one);
+            matcap_v len2 = MATCAP_ADD(MATCAP_ADD(MATCAP_MUL(d0, d0), MATCAP_MUL(d1, d1)), MATCAP_MUL(d2, d2));
+            sum = MATCAP_ADD(sum, matcap_saturate(MATCAP_DIV(d1, MATCAP_SQRT(MATCAP_MAX(len2, MATCAP_SET(1e-12f))))));
+        }
+        weight[1] = MATCAP_SUB(one, reflect);
+        e[1] = MATCAP_MUL(sum, MATCAP_SET(1.0f / MATCAP_SAMPLES));
+        terms = 2;
+    }
+
+    for (int c = 0; c < 3; c++) {
+        matcap_v horizon = MATCAP_SET(m->sky_horizon[c]), rise = MATCAP_SET(m->sky_top[c] - m->sky_horizon[c]);
+        for (int i = 0; i < terms; i++) {
+            matcap_v sky = MATCAP_ADD(horizon, MATCAP_MUL(rise, e[i]));
+            rgb[c] = MATCAP_ADD(rgb[c], MATCAP_MUL(MATCAP_MUL(weight[i], MATCAP_SET(i ? tint2[c] : tint[c])), sky));
+        }
+        if (m->aces) {
+            // RRTAndODTFit
+            matcap_v v = rgb[c];
+            matcap_v num = MATCAP_SUB(MATCAP_MUL(v, MATCAP_ADD(v, MATCAP_SET(0.0245786f))), MATCAP_SET(0.000090537f));
+            matcap_v den = MATCAP_ADD(MATCAP_MUL(v, MATCAP_ADD(MATCAP_MUL(MATCAP_SET(0.983729f), v), MATCAP_SET(0.4329510f))), MATCAP_SET(0.238081f));
+            rgb[c] = MATCAP_DIV(num, den);
+        }
+        MATCAP_STORE(out[c], matcap_saturate(rgb[c]));
+    }
+}
+
+void matcap_shade(const matcap_material* material, const float normal[3], float rgb[3])
+{
+    matcap_samples samples;
+    matcap_samples_init(&samples);
+    float n[3][MATCAP_LANES], out[3][MATCAP_LANES];
+    for (int i = 0; i < 3; i++)
+        for (int l = 0; l < MATCAP_LANES; l++) n[i][l] = normal[i];
+    matcap_shade_block(material, &samples, (const float(*)[MATCAP_LANES])n, out);
+    for (int i = 0; i < 3; i++) rgb[i] = out[i][0];
+}
+
+// Rows y0..y1 of level 0 as RGBA floats, tightly packed from row y0. Texels outside the silhouette take the normal on
+// the rim and alpha 0.
+static void matcap_shade_rows(const matcap_bake_job* job, const matcap_samples* s, uint32_t y0, uint32_t y1, float* rgba)
+{
+    uint32_t size = job->size;
+    for (uint32_t y = y0; y < y1; y++) {
+        float* row = rgba + (size_t)(y - y0) * size * 4;
+        float ny = (((float)(size - y) - 0.5f) / (float)size - 0.5f) / MATCAP_UV_SCALE;
+        for (uint32_t x0 = 0; x0 < size; x0 += MATCAP_LANES) {
+            float n[3][MATCAP_LANES], alpha[MATCAP_LANES], out[3][MATCAP_LANES];
+            for (int l = 0; l < MATCAP_LANES; l++) {
+                float nx = (((float)(x0 + l) + 0.5f) / (float)size - 0.5f) / MATCAP_UV_SCALE;
+                float r2 = nx * nx + ny * ny;
+                alpha[l] = r2 <= 1.0f ? 1.0f : 0.0f;
+                float scale = r2 > 1.0f ? 1.0f / sqrtf(r2) : 1.0f;
+                n[0][l] = nx * scale;
+                n[1][l] = ny * scale;
+                float z2 = 1.0f - n[0][l] * n[0][l] - n[1][l] * n[1][l];
+                n[2][l] = z2 > 0.0f ? sqrtf(z2) : 0.0f;
+            }
+            matcap_shade_block(&job->material, s, (const float(*)[MATCAP_LANES])n, out);
+            for (uint32_t l = 0; l < MATCAP_LANES && x0 + l < size; l++) {
+                float* texel = row + (size_t)(x0 + l) * 4;
+                texel[0] = out[0][l];
+                texel[1] = out[1][l];
+                texel[2] = out[2][l];
+                texel[3] = alpha[l];
+            }
+        }
+    }
+}
+
+// Gamma 1/2.2 into RGBA8888; alpha stays linear
+static void matcap_to_rgba8(const float* rgba, size_t texels, uint8_t* out)
+{
+    for (size_t i = 0; i < texels * 4; i++) {
+        float v = rgba[i] < 0.0f ? 0.0f : rgba[i] > 1.0f ? 1.0f : rgba[i];
+        if ((i & 3) != 3) v = powf(v, 1.0f / 2.2f);
+        out[i] = (uint8_t)(v * 255.0f + 0.5f);
+    }
+}
+
+// 2x2 box filter; odd sizes repeat their last row or column
+static void matcap_downsample(const float* src, uint32_t src_size, float* dst, uint32_t dst_size)
+{
+    for (uint32_t y = 0; y < dst_size; y++) {
+        uint32_t y0 = y * 2 < src_size ? y * 2 : src_size - 1, y1 = y * 2 + 1 < src_size ? y * 2 + 1 : src_size - 1;
+        for (uint32_t x = 0; x < dst_size; x++) {
+            uint32_t x0 = x * 2 < src_size ? x * 2 : src_size - 1, x1 = x * 2 + 1 < src_size ? x * 2 + 1 : src_size - 1;
+            const float* a = src + ((size_t)y0 * src_size + x0) * 4;
+            const float* b = src + ((size_t)y0 * src_size + x1) * 4;
+            const float* c = src + ((size_t)y1 * src_size + x0) * 4;
+            const float* d = src + ((size_t)y1 * src_size + x1) * 4;
+            float* o = dst + ((size_t)y * dst_size + x) * 4;
+            for (int i = 0; i < 4; i++) o[i] = (a[i] + b[i] + c[i] + d[i]) * 0.25f;
+        }
+    }
+}
+
+typedef struct matcap_chain {
+    float* levels;               // every level as RGBA floats, back to back; only for jobs with mips
+    uint32_t bands_left;
+} matcap_chain;
+
+typedef struct matcap_batch {
+    const matcap_bake_job* jobs;
+    matcap_chain* chains;
+    matcap_samples samples;
+    uint32_t max_size;
+} matcap_batch;
+
+// Filters and encodes levels 1 and up once the last band of level 0 is in
+static int matcap_finish_mips(const matcap_bake_job* job, float* levels)
+{
+    uint32_t count = matcap_mip_levels(job->size, job->mip_count);
+    uint8_t* rgba = (uint8_t*)malloc((size_t)matcap_level_size(job->size, 1) * matcap_level_size(job->size, 1) * 4);
+    if (!rgba) return MATCAP_ERR_MEMORY;
+
+    float* src = levels;
+    uint8_t* out = (uint8_t*)job->out + texel_image_size(job->format, job->size, job->size);
+    for (uint32_t l = 1; l < count; l++) {
+        uint32_t src_size = matcap_level_size(job->size, l - 1), size = matcap_level_size(job->size, l);
+        float* dst = src + (size_t)src_size * src_size * 4;
+        matcap_downsample(src, src_size, dst, size);
+        matcap_to_rgba8(dst, (size_t)size * size, rgba);
+        texel_encode(job->format, rgba, size, size, job->dither, out);
+        out += texel_image_size(job->format, size, size);
+        src = dst;
+    }
+    free(rgba);
+    return MATCAP_OK;
+}
+
+// Bands are one tile row of level 0 and start on multiples of MATCAP_TILE, so ordered dithering in texel_encode keeps
+// its phase
+static uint32_t matcap_bands(void* user, uint32_t j)
+{
+    return ((matcap_batch*)user)->chains[j].bands_left;
+}
+
+// Whoever shades a job's last band builds its mips
+static int matcap_band(band_pool* pool, void* user, void* scratch, uint32_t j, uint32_t band)
+{
+    matcap_batch* batch = (matcap_batch*)user;
+    const matcap_bake_job* job = &batch->jobs[j];
+    matcap_chain* chain = &batch->chains[j];
+    float* linear = (float*)scratch;
+    uint8_t* rgba = (uint8_t*)(linear + (size_t)batch->max_size * MATCAP_TILE * 4);
+    int mips = matcap_mip_levels(job->size, job->mip_count) > 1;
+
+    band_pool_lock(pool);
+    // The chain is allocated by the first band to reach the job, so only jobs in flight hold one
+    if (mips && !chain->levels) {
+        size_t floats = 0;
+        for (uint32_t l = 0, n = matcap_mip_levels(job->size, job->mip_count); l < n; l++)
+            floats += (size_t)matcap_level_size(job->size, l) * matcap_level_size(job->size, l) * 4;
+        chain->levels = (float*)malloc(floats * sizeof(float));
+    }
+    float* levels = chain->levels;
+    band_pool_unlock(pool);
+    if (mips && !levels) return MATCAP_ERR_MEMORY;
+
+    uint32_t y0 = band * MATCAP_TILE;
+    uint32_t y1 = y0 + MATCAP_TILE < job->size ? y0 + MATCAP_TILE : job->size;
+    float* shaded = mips ? levels + (size_t)y0 * job->size * 4 : linear;
+    matcap_shade_rows(job, &batch->samples, y0, y1, shaded);
+    matcap_to_rgba8(shaded, (size_t)(y1 - y0) * job->size, rgba);
+    texel_encode(job->format, rgba, job->size, y1 - y0, job->dither, (uint8_t*)job->out + (size_t)y0 * texel_row_bytes(job->format, job->size));
+
+    if (!mips) return MATCAP_OK;
+    band_pool_lock(pool);
+    int last = --chain->bands_left == 0;
+    band_pool_unlock(pool);
+    if (!last) return MATCAP_OK;
+    int result = matcap_finish_mips(job, levels);
+    free(levels);
+    band_pool_lock(pool);
+    chain->levels = NULL;
+    band_pool_unlock(pool);
+    return result;
+}
+
+int matcap_bake_batch(const matcap_bake_job* jobs, uint32_t count, uint32_t threads)
+{
+    matcap_batch* batch = (matcap_batch*)calloc(1, sizeof(matcap_batch));
+    matcap_chain* chains = (matcap_chain*)calloc(count ? count : 1, sizeof(matcap_chain));
+    if (!batch || !chains) {
+        free(batch);
+        free(chains);
+        return MATCAP_ERR_MEMORY;
+    }
+    for (uint32_t j = 0; j < count; j++) {
+        const matcap_bake_job* job = &jobs[j];
+        if (job->size == 0 || texel_bits(job->format) == 0 || job->format == TEXEL_CI8 || job->format == TEXEL_CI4) {
+            free(batch);
+            free(chains);
+            return MATCAP_ERR_FORMAT;
+        }
+        chains[j].bands_left = (job->size + MATCAP_TILE - 1) / MATCAP_TILE;
+        if (job->size > batch->max_size) batch->max_size = job->size;
+    }
+    batch->jobs = jobs;
+    batch->chains = chains;
+    matcap_samples_init(&batch->samples);
+
+    band_pool_work work;
+    memset(&work, 0, sizeof(work));
+    work.count = count;
+    work.bands = matcap_bands;
+    work.run = matcap_band;
+    work.user = batch;
+    work.scratch_bytes = (size_t)batch->max_size * MATCAP_TILE * 4 * (sizeof(float) + 1);    // linear, then rgba
+    work.memory_error = MATCAP_ERR_MEMORY;
+    int result = band_pool_run(&work, threads);
+
+    // Chains of jobs cut short by an allocation failure
+    for (uint32_t j = 0; j < count; j++) free(chains[j].levels);
+    free(chains);
+    free(batch);
+    return result;
+}
@@ -0,0 +1,81 @@
+#ifndef MATCAP_BAKE_H
+#define MATCAP_BAKE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "texel.h"
+
+// CPU baker for matcaps: the lighting of the MatCapGenerator/PBR shader, evaluated without a GPU.
+//
+//   matcap_bake_job job = { 0 };
+//   matcap_material_defaults(&job.material);
+//   job.material.metallic = 1.0f;
+//   job.size = 64;
+//   job.mip_count = 0;                         // the whole chain, down to 1x1
+//   job.format = TEXEL_RGB565;
+//   job.out = texels;                          // matcap_bake_size(format, size, mip_count) bytes
+//   matcap_bake_batch(&job, 1, 8);
+//
+// Every texel is one view-space normal, inverting the lookup Actor/MatCap does (uv = normal.xy * 0.47 + 0.5), seen
+// by an orthographic eye on +z. The shader path traces a unit sphere, but on a lone convex sphere every path is the
+// same two steps: direct light at the first hit (directional and point light, Lambert plus GGX, the 1.7 power
+// falloff, emissive), then one bounce that leaves the sphere and picks up the sky gradient. The baker evaluates the
+// first exactly and integrates the second over a fixed stratified set of the shader's own bounce directions
+// (cosine-weighted for diffuse, its Fresnel mix of mirror and blurred reflection, its perturbed transmission), so
+// results are free of noise and identical from run to run. Tonemapping (optional ACES fit) and the 1/2.2 gamma are
+// the shader's.
+//
+// Texels whose normal would lie past the silhouette get the rim's shading with alpha 0, like the shader's 1-bit
+// alpha but without sky color bleeding into the mips. Mips are 2x2 box filters of the tonemapped color before gamma.
+// Levels are stored back to back, largest first, rows top-down (row 0 at v = 1) like the PNG the editor baker saved.
+//
+// Work is split into bands of 8 rows across threads and shaded four texels per SSE step where available; the scalar
+// code gives the same bits.
+
+typedef struct matcap_material {
+    float base_color[3];         // as the shader receives them; colors are 0..1
+    float metallic;
+    float roughness;
+    float emissive[3];
+    float transparency;
+    float ior;
+    float sky_top[3];
+    float sky_horizon[3];
+    float light_dir[3];          // direction the light travels, view space (_LightDir)
+    float light_color[3];
+    float light_intensity;
+    float point_position[3];     // view space, sphere at the origin; within 0.1 of it disables the point light
+    float point_color[3];
+    float point_intensity;
+    int aces;                    // ACES filmic fit before gamma
+} matcap_material;
+
+enum {
+    MATCAP_OK = 0,
+    MATCAP_ERR_FORMAT = -1,      // a CI format, an unknown format, or size 0
+    MATCAP_ERR_MEMORY = -2
+};
+
+typedef struct matcap_bake_job {
+    matcap_material material;
+    uint32_t size;               // width and height of level 0
+    uint32_t mip_count;          // 0 for the whole chain; clamped to it
+    texel_format format;
+    int dither;                  // TEXEL_DITHER_*, for formats narrower than RGBA8888
+    void* out;                   // matcap_bake_size(format, size, mip_count) bytes
+} matcap_bake_job;
+
+// MatCapBaker's defaults: grey, dielectric, roughness 0.25, ACES, a white key light and a dim point light
+void matcap_material_defaults(matcap_material* material);
+
+// Levels in a chain of mip_count (0 for all) starting at size, and the bytes they take in format
+uint32_t matcap_mip_levels(uint32_t size, uint32_t mip_count);
+size_t matcap_bake_size(texel_format format, uint32_t size, uint32_t mip_count);
+
+// The shaded color of one view-space normal (z >= 0, unit length), tonemapped but before gamma
+void matcap_shade(const matcap_material* material, const float normal[3], float rgb[3]);
+
+// Bakes count jobs on up to threads threads, the caller's included. Jobs may differ in size, material and format.
+int matcap_bake_batch(const matcap_bake_job* jobs, uint32_t count, uint32_t threads);
+
+#endif
@@ -0,0 +1,383 @@
+// Bakes a library of matcaps without a GPU, from the JSON list MatCapBaker's "Add to CPU Bake Library" writes.
+//
+//   cc -O2 -I. matcap_bake_tool.c matcap_bake.c band_pool.c texel.c png_write.c -lm -lpthread -o matcap_bake_tool
+//   ./matcap_bake_tool GeneratedData/matcap_library.json Assets/Textures [threads]
+//
+// The file is { "matcaps": [ ... ] } or a bare array of objects, each with MatCapBaker's field names: name, size,
+// baseColor, metallic, roughness, emissive, transparency, ior, skyColorTop, skyColorHorizon, lightDir, lightColor,
+// directionalIntensity, pointLightPos, pointLightColor, pointIntensity, useACES. Colors are {"r","g","b","a"} or
+// [r, g, b], vectors {"x","y","z"} or [x, y, z]; missing fields keep MatCapBaker's defaults. Optional format (a
+// texel.h name such as "RGB565"), dither and mips (0 for the whole chain) pick what is stored.
+//
+// Each entry writes <name>.png, level 0 as the target format decodes it. Entries with another format or more than one
+// level also write <name>.texels: the packed levels back to back, largest first, as matcap_bake_batch lays them out.
+// PNGs are uncompressed (stored deflate blocks); Unity re-encodes them on import anyway.
+
+#include "matcap_bake.h"
+#include "png_write.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct tool_entry {
+    matcap_bake_job job;
+    char name[256];
+} tool_entry;
+
+static const char* tool_format_names[TEXEL_FORMAT_COUNT] = {
+    "RGBA8888", "RGBA5551", "RGB565", "IA8", "IA4", "I8", "I4", "CI8", "CI4"
+};
+
+// Just enough JSON for the library: objects, arrays, strings, numbers and booleans. Errors stop the parse at the
+// first bad character.
+typedef struct tool_json {
+    const char* p;
+    const char* end;
+    int error;
+} tool_json;
+
+static void tool_space(tool_json* j)
+{
+    while (j->p < j->end && (*j->p == ' ' || *j->p == '\t' || *j->p == '\r' || *j->p == '\n')) j->p++;
+}
+
+static int tool_take(tool_json* j, char c)
+{
+    tool_space(j);
+    if (j->p < j->end && *j->p == c) {
+        j->p++;
+        return 1;
+    }
+    return 0;
+}
+
+static void tool_expect(tool_json* j, char c)
+{
+    if (!tool_take(j, c)) j->error = 1;
+}
+
+// A string into out (truncated to size - 1); \u escapes outside ASCII become '?'
+static void tool_string(tool_json* j, char* out, size_t size)
+{
+    size_t n = 0;
+    tool_expect(j, '"');
+    while (!j->error) {
+        if (j->p >= j->end) {
+            j->error = 1;
+            break;
+        }
+        char c = *j->p++;
+        if (c == '"') break;
+        if (c == '\\') {
+            if (j->p >= j->end) {
+                j->error = 1;
+                break;
+            }
+            c = *j->p++;
+            if (c == 'n') c = '\n';
+            else if (c == 't') c = '\t';
+            else if (c == 'r') c = '\r';
+            else if (c == 'b') c = '\b';
+            else if (c == 'f') c = '\f';
+            else if (c == 'u') {
+                if (j->end - j->p < 4) {
+                    j->error = 1;
+                    break;
+                }
+                unsigned code = (unsigned)strtoul((char[5]){ j->p[0], j->p[1], j->p[2], j->p[3], 0 }, NULL, 16);
+                j->p += 4;
+                c = code < 128 ? (char)code : '?';
+            }
+        }
+        if (out && n + 1 < size) out[n++] = c;
+    }
+    if (out && size) out[n] = '\0';
+}
+
+static float tool_number(tool_json* j)
+{
+    tool_space(j);
+    if (tool_take(j, 't')) {
+        j->p += j->end - j->p >= 3 ? 3 : 0;    // rue
+        return 1.0f;
+    }
+    if (tool_take(j, 'f')) {
+        j->p += j->end - j->p >= 4 ? 4 : 0;    // alse
+        return 0.0f;
+    }
+    char buffer[64];
+    size_t n = 0;
+    while (j->p < j->end && n + 1 < sizeof(buffer) && strchr("+-0123456789.eE", *j->p)) buffer[n++] = *j->p++;
+    buffer[n] = '\0';
+    char* stop;
+    double value = strtod(buffer, &stop);
+    if (n == 0 || *stop) j->error = 1;
+    return (float)value;
+}
+
+static void tool_skip(tool_json* j)
+{
+    tool_space(j);
+    if (j->p >= j->end) {
+        j->error = 1;
+    } else if (*j->p == '"') {
+        tool_string(j, NULL, 0);
+    } else if (tool_take(j, '{')) {
+        if (tool_take(j, '}')) return;
+        do {
+            tool_string(j, NULL, 0);
+            tool_expect(j, ':');
+            tool_skip(j);
+        } while (!j->error && tool_take(j, ','));
+        tool_expect(j, '}');
+    } else if (tool_take(j, '[')) {
+        if (tool_take(j, ']')) return;
+        do tool_skip(j);
+        while (!j->error && tool_take(j, ','));
+        tool_expect(j, ']');
+    } else if (tool_take(j, 'n')) {
+        j->p += j->end - j->p >= 3 ? 3 : 0;    // ull
+    } else {
+        tool_number(j);
+    }
+}
+
+// [a, b, c] or an object with keys from names ("rgba" or "xyz"), into up to n floats
+static void tool_floats(tool_json* j, const char* names, float* out, int n)
+{
+    if (tool_take(j, '[')) {
+        int i = 0;
+        if (tool_take(j, ']')) return;
+        do {
+            float v = tool_number(j);
+            if (i < n) out[i] = v;
+            i++;
+        } while (!j->error && tool_take(j, ','));
+        tool_expect(j, ']');
+        return;
+    }
+    tool_expect(j, '{');
+    if (j->error || tool_take(j, '}')) return;
+    do {
+        char key[16];
+        tool_string(j, key, sizeof(key));
+        tool_expect(j, ':');
+        const char* at = key[0] && !key[1] ? strchr(names, key[0]) : NULL;
+        if (at && at - names < n) out[at - names] = tool_number(j);
+        else tool_skip(j);
+    } while (!j->error && tool_take(j, ','));
+    tool_expect(j, '}');
+}
+
+static void tool_entry_parse(tool_json* j, tool_entry* entry, const char* path)
+{
+    static const struct { const char* name; size_t offset; int count; } fields[] = {
+        { "baseColor", offsetof(matcap_material, base_color), 3 },
+        { "metallic", offsetof(matcap_material, metallic), 1 },
+        { "roughness", offsetof(matcap_material, roughness), 1 },
+        { "emissive", offsetof(matcap_material, emissive), 3 },
+        { "transparency", offsetof(matcap_material, transparency), 1 },
+        { "ior", offsetof(matcap_material, ior), 1 },
+        { "skyColorTop", offsetof(matcap_material, sky_top), 3 },
+        { "skyColorHorizon", offsetof(matcap_material, sky_horizon), 3 },
+        { "lightDir", offsetof(matcap_material, light_dir), 3 },
+        { "lightColor", offsetof(matcap_material, light_color), 3 },
+        { "directionalIntensity", offsetof(matcap_material, light_intensity), 1 },
+        { "pointLightPos", offsetof(matcap_material, point_position), 3 },
+        { "pointLightColor", offsetof(matcap_material, point_color), 3 },
+        { "pointIntensity", offsetof(matcap_material, point_intensity), 1 },
+    };
+
+    memset(entry, 0, sizeof(*entry));
+    matcap_material_defaults(&entry->job.material);
+    entry->job.size = 32;
+    entry->job.mip_count = 1;
+    entry->job.format = TEXEL_RGBA8888;
+
+    tool_expect(j, '{');
+    if (j->error || tool_take(j, '}')) return;
+    do {
+        char key[64];
+        tool_string(j, key, sizeof(key));
+        tool_expect(j, ':');
+        if (j->error) break;
+
+        size_t f = 0, count = sizeof(fields) / sizeof(fields[0]);
+        while (f < count && strcmp(key, fields[f].name) != 0) f++;
+        if (f < count) {
+            float* out = (float*)((uint8_t*)&entry->job.material + fields[f].offset);
+            if (fields[f].count == 1) *out = tool_number(j);
+            else tool_floats(j, strstr(key, "Color") || strcmp(key, "emissive") == 0 ? "rgba" : "xyz", out, fields[f].count);
+        } else if (strcmp(key, "name") == 0) {
+            tool_string(j, entry->name, sizeof(entry->name));
+        } else if (strcmp(key, "size") == 0) {
+            float size = tool_number(j);
+            entry->job.size = size >= 1.0f && size <= 4096.0f ? (uint32_t)size : 0;
+        } else if (strcmp(key, "mips") == 0) {
+            float mips = tool_number(j);
+            entry->job.mip_count = mips >= 0.0f && mips <= 32.0f ? (uint32_t)mips : 1;
+        } else if (strcmp(key, "useACES") == 0) {
+            entry->job.material.aces = tool_number(j) != 0.0f;
+        } else if (strcmp(key, "dither") == 0) {
+            entry->job.dither = tool_number(j) != 0.0f ? TEXEL_DITHER_ORDERED : TEXEL_DITHER_NONE;
+        } else if (strcmp(key, "format") == 0) {
+            char format[32];
+            tool_string(j, format, sizeof(format));
+            entry->job.format = TEXEL_FORMAT_COUNT;
+            for (int t = 0; t < TEXEL_FORMAT_COUNT; t++)
+                if (strcmp(format, tool_format_names[t]) == 0) entry->job.format = (texel_format)t;
+        } else {
+            fprintf(stderr, "%s: %s: unknown field %s ignored\n", path, entry->name[0] ? entry->name : "(unnamed)", key);
+            tool_skip(j);
+        }
+    } while (!j->error && tool_take(j, ','));
+    tool_expect(j, '}');
+}
+
+// File names come from the editor, but keep them inside the output folder regardless
+static int tool_valid_name(const char* name)
+{
+    if (!name[0] || strcmp(name, ".") == 0 || strcmp(name, "..") == 0) return 0;
+    return strpbrk(name, "/\\:") == NULL;
+}
+
+static char* tool_read_file(const char* path, size_t* size)
+{
+    FILE* f = fopen(path, "rb");
+    if (!f) return NULL;
+    char* data = NULL;
+    if (fseek(f, 0, SEEK_END) == 0) {
+        long length = ftell(f);
+        if (length >= 0 && fseek(f, 0, SEEK_SET) == 0) {
+            data = (char*)malloc((size_t)length + 1);
+            if (data && fread(data, 1, (size_t)length, f) != (size_t)length) {
+                free(data);
+                data = NULL;
+            }
+            *size = (size_t)length;
+        }
+    }
+    fclose(f);
+    return data;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 3) {
+        fprintf(stderr, "usage: %s matcap_library.json out_dir [threads]\n", argv[0]);
+        return 1;
+    }
+    uint32_t threads = argc > 3 ? (uint32_t)atoi(argv[3]) : 8;
+
+    size_t size = 0;
+    char* text = tool_read_file(argv[1], &size);
+    if (!text) {
+        fprintf(stderr, "cannot read %s\n", argv[1]);
+        return 1;
+    }
+    tool_json json = { text, text + size, 0 };
+
+    // Either the top-level array or the "matcaps" array of the object JsonUtility writes
+    if (tool_take(&json, '{')) {
+        int found = 0;
+        if (!tool_take(&json, '}')) {
+            do {
+                char key[64];
+                tool_string(&json, key, sizeof(key));
+                tool_expect(&json, ':');
+                tool_space(&json);
+                if (!json.error && strcmp(key, "matcaps") == 0 && json.p < json.end && *json.p == '[') {
+                    found = 1;
+                    break;
+                }
+                tool_skip(&json);
+            } while (!json.error && tool_take(&json, ','));
+        }
+        if (!found) json.error = 1;
+    }
+
+    tool_entry* entries = NULL;
+    uint32_t count = 0, capacity = 0, index = 0;
+    tool_expect(&json, '[');
+    if (!json.error && !tool_take(&json, ']')) {
+        do {
+            if (count == capacity) {
+                capacity = capacity ? capacity * 2 : 64;
+                tool_entry* grown = (tool_entry*)realloc(entries, capacity * sizeof(tool_entry));
+                if (!grown) {
+                    fprintf(stderr, "out of memory\n");
+                    return 1;
+                }
+                entries = grown;
+            }
+            tool_entry_parse(&json, &entries[count], argv[1]);
+            if (json.error) break;
+            index++;
+            tool_entry* entry = &entries[count];
+            if (!tool_valid_name(entry->name) || entry->job.size == 0 || entry->job.format == TEXEL_FORMAT_COUNT ||
+                entry->job.format == TEXEL_CI8 || entry->job.format == TEXEL_CI4)
+                fprintf(stderr, "%s: entry %u skipped: needs a plain name, a size and a non-palette format\n", argv[1], index);
+            else
+                count++;
+        } while (tool_take(&json, ','));
+        tool_expect(&json, ']');
+    }
+    if (json.error) {
+        fprintf(stderr, "%s: not a matcap list (JSON error at byte %ld)\n", argv[1], (long)(json.p - text));
+        free(entries);
+        free(text);
+        return 1;
+    }
+    free(text);
+
+    // Every matcap in one batch, so small ones fill the threads while big ones finish
+    matcap_bake_job* jobs = (matcap_bake_job*)malloc((count ? count : 1) * sizeof(matcap_bake_job));
+    if (!jobs) return 1;
+    for (uint32_t i = 0; i < count; i++) {
+        jobs[i] = entries[i].job;
+        jobs[i].out = malloc(matcap_bake_size(jobs[i].format, jobs[i].size, jobs[i].mip_count));
+        if (!jobs[i].out) {
+            fprintf(stderr, "out of memory\n");
+            return 1;
+        }
+    }
+
+    int result = matcap_bake_batch(jobs, count, threads);
+    if (result != MATCAP_OK) {
+        fprintf(stderr, "bake failed (%d)\n", result);
+        return 1;
+    }
+
+    int failures = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        const matcap_bake_job* job = &jobs[i];
+        char path[1024];
+        uint8_t* rgba = (uint8_t*)malloc((size_t)job->size * job->size * 4);
+        texel_image image = { job->format, job->size, job->size, (uint32_t)texel_row_bytes(job->format, job->size), job->out, NULL, 0 };
+        snprintf(path, sizeof(path), "%s/%s.png", argv[2], entries[i].name);
+        if (rgba) texel_decode(&image, rgba);
+        if (!rgba || !png_write_rgba(path, rgba, job->size, job->size)) {
+            fprintf(stderr, "cannot write %s\n", path);
+            failures++;
+        }
+        free(rgba);
+
+        if (job->format != TEXEL_RGBA8888 || matcap_mip_levels(job->size, job->mip_count) > 1) {
+            snprintf(path, sizeof(path), "%s/%s.texels", argv[2], entries[i].name);
+            size_t bytes = matcap_bake_size(job->format, job->size, job->mip_count);
+            FILE* f = fopen(path, "wb");
+            int ok = f && fwrite(job->out, 1, bytes, f) == bytes;
+            if (f) ok = fclose(f) == 0 && ok;
+            if (!ok) {
+                fprintf(stderr, "cannot write %s\n", path);
+                failures++;
+            }
+        }
+        free(job->out);
+    }
+    printf("baked %u matcaps\n", count);
+
+    free(jobs);
+    free(entries);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,98 @@
+#include "png_write.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static uint32_t png_crc(const uint32_t* table, uint32_t crc, const uint8_t* data, size_t size)
+{
+    for (size_t i = 0; i < size; i++) crc = table[(crc ^ data[i]) & 255] ^ (crc >> 8);
+    return crc;
+}
+
+static void png_be32(uint8_t* p, uint32_t v)
+{
+    p[0] = (uint8_t)(v >> 24);
+    p[1] = (uint8_t)(v >> 16);
+    p[2] = (uint8_t)(v >> 8);
+    p[3] = (uint8_t)v;
+}
+
+static void png_chunk(FILE* f, const uint32_t* crc_table, const char* type, const uint8_t* data, uint32_t size)
+{
+    uint8_t head[8];
+    png_be32(head, size);
+    memcpy(head + 4, type, 4);
+    uint32_t crc = png_crc(crc_table, png_crc(crc_table, 0xFFFFFFFFu, head + 4, 4), data, size) ^ 0xFFFFFFFFu;
+    uint8_t tail[4];
+    png_be32(tail, crc);
+    fwrite(head, 1, 8, f);
+    if (size) fwrite(data, 1, size, f);
+    fwrite(tail, 1, 4, f);
+}
+
+int png_write_rgba(const char* path, const uint8_t* rgba, uint32_t width, uint32_t height)
+{
+    size_t row = (size_t)width * 4 + 1;
+    size_t raw_size = row * height;
+    size_t blocks = (raw_size + 65534) / 65535;
+    size_t zlib_size = 2 + raw_size + blocks * 5 + 4;
+    uint8_t* raw = (uint8_t*)malloc(raw_size);
+    uint8_t* zlib = (uint8_t*)malloc(zlib_size);
+    FILE* f = raw && zlib ? fopen(path, "wb") : NULL;
+    if (!f) {
+        free(raw);
+        free(zlib);
+        return 0;
+    }
+
+    for (uint32_t y = 0; y < height; y++) {
+        raw[y * row] = 0; // filter: none
+        memcpy(raw + y * row + 1, rgba + (size_t)y * width * 4, (size_t)width * 4);
+    }
+
+    uint32_t a = 1, b = 0;
+    for (size_t i = 0; i < raw_size; i++) {
+        a = (a + raw[i]) % 65521;
+        b = (b + a) % 65521;
+    }
+
+    uint8_t* z = zlib;
+    *z++ = 0x78;
+    *z++ = 0x01;
+    for (size_t offset = 0; offset < raw_size; offset += 65535) {
+        uint32_t n = (uint32_t)(raw_size - offset < 65535 ? raw_size - offset : 65535);
+        *z++ = offset + n == raw_size ? 1 : 0;
+        *z++ = (uint8_t)n;
+        *z++ = (uint8_t)(n >> 8);
+        *z++ = (uint8_t)~n;
+        *z++ = (uint8_t)(~n >> 8);
+        memcpy(z, raw + offset, n);
+        z += n;
+    }
+    png_be32(z, b << 16 | a);
+    z += 4;
+
+    static const uint8_t signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    uint8_t ihdr[13];
+    png_be32(ihdr, width);
+    png_be32(ihdr + 4, height);
+    ihdr[8] = 8;   // bit depth
+    ihdr[9] = 6;   // RGBA
+    ihdr[10] = ihdr[11] = ihdr[12] = 0;
+    // Built per image rather than shared, so tools may write from several threads
+    uint32_t crc_table[256];
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t c = i;
+        for (int k = 0; k < 8; k++) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+        crc_table[i] = c;
+    }
+    fwrite(signature, 1, 8, f);
+    png_chunk(f, crc_table, "IHDR", ihdr, 13);
+    png_chunk(f, crc_table, "IDAT", zlib, (uint32_t)(z - zlib));
+    png_chunk(f, crc_table, "IEND", NULL, 0);
+    int ok = ferror(f) == 0;
+    ok = fclose(f) == 0 && ok;
+    free(raw);
+    free(zlib);
+    return ok;
+}
@@ -0,0 +1,17 @@
+#ifndef PNG_WRITE_H
+#define PNG_WRITE_H
+
+#include <stdint.h>
+
+// Minimal PNG writer for the headless bake tools.
+//
+//   if (!png_write_rgba("Shape_Star.png", pixels, 256, 256)) ...
+//
+// The image is stored, not compressed: zlib stored blocks inside one IDAT chunk, filter none on every row. Unity
+// re-encodes PNGs on import, so only the pixels matter.
+
+// RGBA8888 rows, top-down and tightly packed, as an 8-bit RGBA PNG. Nonzero on success, 0 if the file can't be
+// written or memory runs out.
+int png_write_rgba(const char* path, const uint8_t* rgba, uint32_t width, uint32_t height);
+
+#endif
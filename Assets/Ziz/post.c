@@ -0,0 +1,363 @@
+#include "post.h"
+#include "texel.h"
+#include "ztime.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define POST_SSE2 1
+#include <emmintrin.h>
+#endif
+
+// Bilinear weights are 7-bit: a horizontal blend fits an int16 and a vertical one an int32, in SSE2 and scalar alike
+#define POST_WEIGHT_BITS 7
+#define POST_WEIGHT_ONE (1 << POST_WEIGHT_BITS)
+
+struct post_context {
+    uint32_t width, height;
+    post_stats stats;
+
+    // Target-sized image, grown on demand
+    uint32_t* target;
+    size_t target_capacity;
+
+    // Per-frame haze tables for the target size: sin(v * 40 + t) per row, cos(u * 40 - t) per column, and the noise
+    // lattice values over the cells the screen covers
+    float* row_sin;
+    size_t row_capacity;
+    float* column_cos;
+    size_t column_capacity;
+    float* lattice;
+    size_t lattice_capacity;
+
+    // Upscale: source column and weight per output column, and two source rows blended horizontally
+    int32_t* upscale_x;
+    uint8_t* upscale_w;
+    uint16_t* rows;              // 2 * width * 4 channels
+    int32_t row_of[2];           // target row held by each half of rows, -1 for none
+
+    // Color reduction per Bayer cell from texel_reduce_tables, built for color_bits and dither
+    uint8_t reduce[16][256];
+    uint32_t reduce_bits;
+    int reduce_dither;
+};
+
+void post_settings_defaults(post_settings* settings)
+{
+    memset(settings, 0, sizeof(*settings));
+    settings->filter = POST_FILTER_POINT;
+    settings->color_bits = 8;
+    settings->dither = POST_DITHER_ORDERED;
+    settings->haze_distance = 0.6f;
+    settings->haze_falloff = 1.0f;
+    settings->haze_speed = 1.0f;
+    settings->haze_frequency = 3.0f;
+}
+
+void post_resolution_size(post_resolution resolution, uint32_t* width, uint32_t* height)
+{
+    static const uint32_t sizes[][2] = { { 0, 0 }, { 256, 240 }, { 320, 240 }, { 640, 240 }, { 320, 480 }, { 640, 480 }, { 480, 272 } };
+    int i = resolution >= POST_RES_NONE && resolution <= POST_RES_480X272 ? (int)resolution : 0;
+    *width = sizes[i][0];
+    *height = sizes[i][1];
+}
+
+const char* post_pass_name(int pass)
+{
+    switch (pass) {
+    case POST_PASS_RESAMPLE: return "resample";
+    case POST_PASS_UPSCALE: return "upscale";
+    default: return "?";
+    }
+}
+
+post_context* post_create(uint32_t width, uint32_t height)
+{
+    if (width == 0 || height == 0 || width > 16384 || height > 16384) return NULL;
+    post_context* p = (post_context*)calloc(1, sizeof(post_context));
+    if (!p) return NULL;
+    p->width = width;
+    p->height = height;
+    p->upscale_x = (int32_t*)malloc((size_t)width * 2 * sizeof(int32_t));
+    p->upscale_w = (uint8_t*)malloc(width);
+    p->rows = (uint16_t*)malloc((size_t)width * 8 * sizeof(uint16_t));
+    if (!p->upscale_x || !p->upscale_w || !p->rows) {
+        post_destroy(p);
+        return NULL;
+    }
+    return p;
+}
+
+void post_destroy(post_context* p)
+{
+    if (!p) return;
+    free(p->target);
+    free(p->row_sin);
+    free(p->column_cos);
+    free(p->lattice);
+    free(p->upscale_x);
+    free(p->upscale_w);
+    free(p->rows);
+    free(p);
+}
+
+void post_get_stats(const post_context* p, post_stats* stats) { *stats = p->stats; }
+
+static int post_reserve(void** data, size_t* capacity, size_t count, size_t size)
+{
+    if (*capacity >= count) return POST_OK;
+    void* grown = realloc(*data, count * size);
+    if (!grown) return POST_ERR_MEMORY;
+    *data = grown;
+    *capacity = count;
+    return POST_OK;
+}
+
+static void post_build_reduce(post_context* p, uint32_t bits, int dither)
+{
+    if (p->reduce_bits == bits && p->reduce_dither == dither) return;
+    texel_reduce_tables(bits, dither == POST_DITHER_ORDERED ? TEXEL_DITHER_ORDERED : TEXEL_DITHER_NONE, p->reduce);
+    p->reduce_bits = bits;
+    p->reduce_dither = dither;
+}
+
+// fract(sin(dot(n, (12.9898, 78.233))) * 43758.5453), in double so the lattice doesn't drift as time grows
+static float post_rand(double x, double y)
+{
+    double v = sin(x * 12.9898 + y * 78.233) * 43758.5453;
+    return (float)(v - floor(v));
+}
+
+static float post_smoothstep(float e0, float e1, float x)
+{
+    if (e1 <= e0) return x >= e1 ? 1.0f : 0.0f;
+    float t = (x - e0) / (e1 - e0);
+    t = t < 0.0f ? 0.0f : (t > 1.0f ? 1.0f : t);
+    return t * t * (3.0f - 2.0f * t);
+}
+
+// floorf without the libm call, for values well inside int range
+static int post_floor(float v)
+{
+    int i = (int)v;
+    return i - (v < (float)i);
+}
+
+static int post_clamp(int v, int n) { return v < 0 ? 0 : (v >= n ? n - 1 : v); }
+
+// The source at (fx, fy) in pixels (0 at the left or top edge), clamped at the borders. Bilinear weights are
+// 7-bit, as in the upscale.
+static uint32_t post_fetch(const uint32_t* source, uint32_t width, uint32_t height, float fx, float fy, post_filter filter)
+{
+    // Far enough outside to clamp to the edge either way, and never near int overflow
+    float limit_x = (float)width * 2.0f, limit_y = (float)height * 2.0f;
+    fx = fx < -limit_x ? -limit_x : (fx > limit_x ? limit_x : fx);
+    fy = fy < -limit_y ? -limit_y : (fy > limit_y ? limit_y : fy);
+    if (filter == POST_FILTER_POINT)
+        return source[(size_t)post_clamp(post_floor(fy), (int)height) * width + (size_t)post_clamp(post_floor(fx), (int)width)];
+
+    int sx = post_floor((fx - 0.5f) * POST_WEIGHT_ONE + 0.5f), sy = post_floor((fy - 0.5f) * POST_WEIGHT_ONE + 0.5f);
+    int x0 = sx >> POST_WEIGHT_BITS, y0 = sy >> POST_WEIGHT_BITS;
+    uint32_t ax = (uint32_t)sx & (POST_WEIGHT_ONE - 1), ay = (uint32_t)sy & (POST_WEIGHT_ONE - 1);
+    int x1 = post_clamp(x0 + 1, (int)width), y1 = post_clamp(y0 + 1, (int)height);
+    x0 = post_clamp(x0, (int)width);
+    y0 = post_clamp(y0, (int)height);
+    const uint32_t *top = source + (size_t)y0 * width, *bottom = source + (size_t)y1 * width;
+    uint32_t c00 = top[x0], c10 = top[x1], c01 = bottom[x0], c11 = bottom[x1], out = 0;
+    for (int k = 0; k < 32; k += 8) {
+        uint32_t t = ((c00 >> k) & 255) * (POST_WEIGHT_ONE - ax) + ((c10 >> k) & 255) * ax;
+        uint32_t b = ((c01 >> k) & 255) * (POST_WEIGHT_ONE - ax) + ((c11 >> k) & 255) * ax;
+        out |= ((t * (POST_WEIGHT_ONE - ay) + b * ay + (1u << (2 * POST_WEIGHT_BITS - 1))) >> (2 * POST_WEIGHT_BITS)) << k;
+    }
+    return out;
+}
+
+// Haze, snap and color reduction, one target pixel at a time
+static int post_resample(post_context* p, const post_settings* s, const uint32_t* source, const float* depth, uint32_t* out,
+                         uint32_t tw, uint32_t th)
+{
+    int haze = s->haze_strength != 0.0f;
+    float t = s->time * s->haze_speed, freq = s->haze_frequency > 0.0f ? s->haze_frequency : 0.0f;
+    double base = floor((double)t);
+    uint32_t cells = 0;
+    if (haze) {
+        // Noise is sampled at uv * freq + t, uv in 0..1: lattice corners base .. floor(freq + t) + 1 on both axes
+        cells = (uint32_t)(floor((double)freq + (double)t) - base) + 2u;
+        if (post_reserve((void**)&p->row_sin, &p->row_capacity, th, sizeof(float)) != POST_OK ||
+            post_reserve((void**)&p->column_cos, &p->column_capacity, tw, sizeof(float)) != POST_OK ||
+            post_reserve((void**)&p->lattice, &p->lattice_capacity, (size_t)cells * cells, sizeof(float)) != POST_OK)
+            return POST_ERR_MEMORY;
+        for (uint32_t y = 0; y < th; y++) p->row_sin[y] = sinf(((float)y + 0.5f) / (float)th * 40.0f + t);
+        for (uint32_t x = 0; x < tw; x++) p->column_cos[x] = cosf(((float)x + 0.5f) / (float)tw * 40.0f - t);
+        for (uint32_t j = 0; j < cells; j++)
+            for (uint32_t i = 0; i < cells; i++) p->lattice[j * cells + i] = post_rand(base + i, base + j);
+    }
+    int reduce = s->color_bits >= 1 && s->color_bits < 8;
+    if (reduce) post_build_reduce(p, s->color_bits, s->dither);
+
+    uint32_t w = p->width, h = p->height;
+    float scale_x = (float)w / (float)tw, scale_y = (float)h / (float)th;
+    for (uint32_t y = 0; y < th; y++) {
+        float v = ((float)y + 0.5f) / (float)th;
+        const uint8_t(*reduce_row)[256] = (const uint8_t(*)[256])(p->reduce + (y & 3) * 4);
+        uint32_t* row = out + (size_t)y * tw;
+        for (uint32_t x = 0; x < tw; x++) {
+            float u = ((float)x + 0.5f) / (float)tw, fx = ((float)x + 0.5f) * scale_x, fy = ((float)y + 0.5f) * scale_y;
+            if (haze) {
+                float mask = 1.0f;
+                if (depth) {
+                    uint32_t dx = (uint32_t)fx < w ? (uint32_t)fx : w - 1, dy = (uint32_t)fy < h ? (uint32_t)fy : h - 1;
+                    mask = post_smoothstep(s->haze_distance, 1.0f, depth[(size_t)dy * w + dx]);
+                    if (mask > 0.0f && s->haze_falloff != 1.0f) mask = powf(mask, s->haze_falloff);
+                }
+                if (mask > 0.0f) {
+                    float nx = u * freq + t, ny = v * freq + t;
+                    float cx = (float)post_floor(nx), cy = (float)post_floor(ny), ax = nx - cx, ay = ny - cy;
+                    uint32_t i = (uint32_t)((double)cx - base), j = (uint32_t)((double)cy - base);
+                    if (i > cells - 2) i = cells - 2;
+                    if (j > cells - 2) j = cells - 2;
+                    const float* l = p->lattice + j * cells + i;
+                    float a = l[0], b = l[1], c = l[cells], d = l[cells + 1];
+                    ax = ax * ax * (3.0f - 2.0f * ax);
+                    ay = ay * ay * (3.0f - 2.0f * ay);
+                    float n = a + (b - a) * ax + (c - a) * ay * (1.0f - ax) + (d - b) * ax * ay;
+                    float k = n * s->haze_strength * mask;
+                    fx += p->row_sin[y] * k * (float)w;
+                    fy += p->column_cos[x] * k * (float)h;
+                }
+            }
+            uint32_t c = post_fetch(source, w, h, fx, fy, s->filter);
+            if (reduce) {
+                const uint8_t* r = reduce_row[x & 3];
+                c = (c & 0xFF000000u) | (uint32_t)r[c & 255] | (uint32_t)r[(c >> 8) & 255] << 8 | (uint32_t)r[(c >> 16) & 255] << 16;
+            }
+            row[x] = c;
+        }
+    }
+    return POST_OK;
+}
+
+// One target row blended horizontally into 16-bit channels, weights summing to POST_WEIGHT_ONE
+static void post_expand_row(const post_context* p, const uint32_t* row, uint16_t* out)
+{
+    for (uint32_t x = 0; x < p->width; x++) {
+        uint32_t a = row[p->upscale_x[x * 2]], b = row[p->upscale_x[x * 2 + 1]], wb = p->upscale_w[x], wa = POST_WEIGHT_ONE - wb;
+        for (int k = 0; k < 4; k++) out[x * 4 + k] = (uint16_t)(((a >> (8 * k)) & 255) * wa + ((b >> (8 * k)) & 255) * wb);
+    }
+}
+
+// Source index pair and weight of b for output coordinate i of n, sampling m source texels at pixel centres
+static void post_bilinear_tap(uint32_t i, uint32_t n, uint32_t m, int32_t* a, int32_t* b, uint32_t* weight)
+{
+    float s = ((float)i + 0.5f) * (float)m / (float)n - 0.5f;
+    float f = floorf(s);
+    int32_t i0 = (int32_t)f, i1 = i0 + 1;
+    uint32_t wgt = (uint32_t)((s - f) * POST_WEIGHT_ONE + 0.5f);
+    if (i0 < 0) {
+        i0 = 0;
+        wgt = 0;
+    }
+    if (i1 > (int32_t)m - 1) i1 = (int32_t)m - 1;
+    if (i0 > (int32_t)m - 1) i0 = (int32_t)m - 1;
+    *a = i0;
+    *b = i1;
+    *weight = wgt;
+}
+
+static void post_upscale(post_context* p, post_filter filter, const uint32_t* target, uint32_t tw, uint32_t th, uint32_t* out)
+{
+    uint32_t w = p->width, h = p->height;
+    if (filter == POST_FILTER_POINT) {
+        // The texel under each output pixel centre; rows that repeat a target row are copies of the row above
+        for (uint32_t x = 0; x < w; x++) p->upscale_x[x] = (int32_t)(((uint64_t)x * 2 + 1) * tw / (2 * (uint64_t)w));
+        int64_t previous = -1;
+        for (uint32_t y = 0; y < h; y++) {
+            int64_t ty = (int64_t)(((uint64_t)y * 2 + 1) * th / (2 * (uint64_t)h));
+            uint32_t* row = out + (size_t)y * w;
+            if (ty == previous) {
+                memcpy(row, row - w, w * sizeof(uint32_t));
+                continue;
+            }
+            const uint32_t* in = target + (size_t)ty * tw;
+            for (uint32_t x = 0; x < w; x++) row[x] = in[p->upscale_x[x]];
+            previous = ty;
+        }
+        return;
+    }
+
+    for (uint32_t x = 0; x < w; x++) {
+        uint32_t weight;
+        post_bilinear_tap(x, w, tw, &p->upscale_x[x * 2], &p->upscale_x[x * 2 + 1], &weight);
+        p->upscale_w[x] = (uint8_t)weight;
+    }
+    uint16_t* rows[2] = { p->rows, p->rows + (size_t)w * 4 };
+    p->row_of[0] = p->row_of[1] = -1;
+    for (uint32_t y = 0; y < h; y++) {
+        int32_t y0, y1;
+        uint32_t wy;
+        post_bilinear_tap(y, h, th, &y0, &y1, &wy);
+        // Rows advance monotonically, so the second row of one output row is usually the first of a later one
+        if (p->row_of[0] != y0) {
+            if (p->row_of[1] == y0) {
+                uint16_t* swap = rows[0];
+                rows[0] = rows[1];
+                rows[1] = swap;
+                p->row_of[1] = p->row_of[0];
+            } else {
+                post_expand_row(p, target + (size_t)y0 * tw, rows[0]);
+            }
+            p->row_of[0] = y0;
+        }
+        if (p->row_of[1] != y1) {
+            post_expand_row(p, target + (size_t)y1 * tw, rows[1]);
+            p->row_of[1] = y1;
+        }
+
+        // out = (top * (1 - wy) + bottom * wy) with both weights 7-bit, rounded
+        const uint16_t *top = rows[0], *bottom = rows[1];
+        uint8_t* row = (uint8_t*)(out + (size_t)y * w);
+        int32_t wa = POST_WEIGHT_ONE - (int32_t)wy, wb = (int32_t)wy;
+        size_t i = 0, n = (size_t)w * 4;
+#if POST_SSE2
+        __m128i weights = _mm_set_epi16((short)wb, (short)wa, (short)wb, (short)wa, (short)wb, (short)wa, (short)wb, (short)wa);
+        __m128i round = _mm_set1_epi32(1 << (2 * POST_WEIGHT_BITS - 1));
+        for (; i + 8 <= n; i += 8) {
+            __m128i a = _mm_loadu_si128((const __m128i*)(top + i)), b = _mm_loadu_si128((const __m128i*)(bottom + i));
+            __m128i lo = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(a, b), weights), round), 2 * POST_WEIGHT_BITS);
+            __m128i hi = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(a, b), weights), round), 2 * POST_WEIGHT_BITS);
+            _mm_storel_epi64((__m128i*)(row + i), _mm_packus_epi16(_mm_packs_epi32(lo, hi), _mm_setzero_si128()));
+        }
+#endif
+        for (; i < n; i++)
+            row[i] = (uint8_t)(((int32_t)top[i] * wa + (int32_t)bottom[i] * wb + (1 << (2 * POST_WEIGHT_BITS - 1))) >> (2 * POST_WEIGHT_BITS));
+    }
+}
+
+int post_run(post_context* p, const post_settings* s, const uint32_t* source, const float* depth, uint32_t* out)
+{
+    memset(&p->stats, 0, sizeof(p->stats));
+    uint32_t tw = s->target_width, th = s->target_height;
+    int emulate = tw > 0 && th > 0 && (tw != p->width || th != p->height);
+    if (!emulate) {
+        tw = p->width;
+        th = p->height;
+    } else if (post_reserve((void**)&p->target, &p->target_capacity, (size_t)tw * th, sizeof(uint32_t)) != POST_OK) {
+        return POST_ERR_MEMORY;
+    }
+
+    double start = ztime_now_us();
+    int status = post_resample(p, s, source, depth, emulate ? p->target : out, tw, th);
+    if (status != POST_OK) return status;
+    double resampled = ztime_now_us();
+    p->stats.us[POST_PASS_RESAMPLE] = resampled - start;
+    p->stats.width[POST_PASS_RESAMPLE] = tw;
+    p->stats.height[POST_PASS_RESAMPLE] = th;
+    if (!emulate) return POST_OK;
+
+    post_upscale(p, s->filter, p->target, tw, th, out);
+    p->stats.us[POST_PASS_UPSCALE] = ztime_now_us() - resampled;
+    p->stats.width[POST_PASS_UPSCALE] = p->width;
+    p->stats.height[POST_PASS_UPSCALE] = p->height;
+    return POST_OK;
+}
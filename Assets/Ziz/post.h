@@ -0,0 +1,113 @@
+#ifndef POST_H
+#define POST_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// CPU post-processing for finished frames: the URP ResolutionEmulator and CameraPostProcess passes and the
+// HeatHazeSS screen shader, so output from srast can be checked and budgeted without a GPU.
+//
+//   post_context* post = post_create(640, 480);
+//   post_settings settings;
+//   post_settings_defaults(&settings);
+//   post_resolution_size(POST_RES_320X240, &settings.target_width, &settings.target_height);
+//   settings.color_bits = 5;                  // 15-bit color, ordered dither
+//   every frame:
+//     settings.time = seconds;
+//     post_run(post, &settings, srast_color(r), srast_depth(r), out);    // out is 640 x 480 again
+//     post_get_stats(post, &stats);           // microseconds per pass
+//
+// The effects are applied in the order the engine applies them: heat haze (screen space), then the resolution
+// emulator's snap to the target's pixel centres, then color reduction, then the upscale back to the screen. The
+// per-pixel steps are fused into two passes, so every image is read once and written once:
+//   resample  for each target pixel, displaces its centre by the haze, fetches the source there, reduces the color
+//             and writes the target-sized image (straight into out when there is no emulated resolution)
+//   upscale   stretches the target-sized image to out, nearest or bilinear
+// Haze only moves where the source is fetched, so folding it into the snap approximates running it at full size
+// first. The displacement is evaluated at the target pixel's centre, not at the centre of the source pixel the snap
+// would pick, which is up to half a source pixel away. Where the depth mask is constant, the fetch point therefore
+// differs from the full-size chain's by at most half a source pixel plus, per axis in uv,
+//   haze_strength * (40 + 1.5 * haze_frequency) * (0.5 / width + 0.5 / height)
+// (the sines contribute 40, the value noise 1.5 * frequency). Across a depth edge the mask can switch between the two
+// points and the difference reaches haze_strength. With bilinear filtering, one displaced tap also stands in for the
+// blend of four separately hazed texels. The noise lattice and the per-row and per-column sines are evaluated once
+// per frame, not per pixel.
+//
+// Images are RGBA8888, r in the low byte, row 0 at the top, rows tightly packed. Alpha passes through.
+
+// ResolutionEmulatorFeature.EmulatedResolution
+typedef enum post_resolution {
+    POST_RES_NONE = 0,
+    POST_RES_256X240,
+    POST_RES_320X240,
+    POST_RES_640X240,
+    POST_RES_320X480,
+    POST_RES_640X480,
+    POST_RES_480X272
+} post_resolution;
+
+// ResolutionEmulatorFeature.Settings.filterMode: Point or Bilinear
+typedef enum post_filter {
+    POST_FILTER_POINT = 0,
+    POST_FILTER_BILINEAR
+} post_filter;
+
+enum {
+    POST_DITHER_NONE,
+    POST_DITHER_ORDERED          // 4x4 Bayer, as texel_encode
+};
+
+// Passes, in the order they run
+enum {
+    POST_PASS_RESAMPLE,
+    POST_PASS_UPSCALE,
+    POST_PASS_COUNT
+};
+
+enum {
+    POST_OK = 0,
+    POST_ERR_MEMORY = -1
+};
+
+typedef struct post_settings {
+    uint32_t target_width;       // emulated resolution; 0 keeps the source's, and the upscale pass is skipped
+    uint32_t target_height;
+    post_filter filter;          // for fetching the source and for the upscale
+    uint32_t color_bits;         // per channel, 1..8; 8 leaves colors alone
+    int dither;                  // POST_DITHER_*, when color_bits < 8
+
+    // HeatHazeSS.gdshader uniforms; haze_strength 0 turns the haze off
+    float haze_strength;
+    float haze_distance;         // depth where the haze starts
+    float haze_falloff;
+    float haze_speed;
+    float haze_frequency;
+    float time;                  // seconds, the shader's TIME
+} post_settings;
+
+typedef struct post_stats {
+    double us[POST_PASS_COUNT];  // 0 for a pass that didn't run
+    uint32_t width[POST_PASS_COUNT], height[POST_PASS_COUNT];    // what each pass wrote
+} post_stats;
+
+typedef struct post_context post_context;
+
+// The shader's defaults, no emulated resolution, point filtering, full color, haze off
+void post_settings_defaults(post_settings* settings);
+
+// Target size of a ResolutionEmulator preset; 0 x 0 for POST_RES_NONE
+void post_resolution_size(post_resolution resolution, uint32_t* width, uint32_t* height);
+
+const char* post_pass_name(int pass);
+
+// width x height is the screen: the source and the output. NULL if out of memory or a size is 0 or over 16384.
+post_context* post_create(uint32_t width, uint32_t height);
+void post_destroy(post_context* context);
+
+// Runs the chain over source into out (both width x height, not overlapping). depth (width x height, 0 near to 1 far,
+// as srast_depth) masks the haze; NULL hazes everywhere. POST_ERR_MEMORY leaves out unchanged.
+int post_run(post_context* context, const post_settings* settings, const uint32_t* source, const float* depth, uint32_t* out);
+
+void post_get_stats(const post_context* context, post_stats* stats);
+
+#endif
@@ -0,0 +1,589 @@
+#include "psim.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define PSIM_SSE 1
+#include <xmmintrin.h>
+#endif
+
+#define PSIM_PI 3.14159265358979f
+#define PSIM_FBM_NORM (1.0f / 0.75f)
+
+// Per-particle float arrays, all compacted together
+enum {
+    PSIM_X, PSIM_Y, PSIM_Z,              // simulated position
+    PSIM_VX, PSIM_VY, PSIM_VZ,
+    PSIM_AGE, PSIM_LIFE,
+    PSIM_SPIN, PSIM_ROT,                 // radians per second, radians
+    PSIM_PHASE_X, PSIM_PHASE_Y, PSIM_PHASE_Z,    // Brownian noise time offsets
+    PSIM_OUT_X, PSIM_OUT_Y, PSIM_OUT_Z,  // rendered position: simulated plus Brownian displacement
+    PSIM_SIZE,
+    PSIM_FLOATS
+};
+
+struct psim_emitter {
+    psim_desc desc;
+    uint32_t capacity;
+    uint32_t live;
+    uint32_t rng;
+    uint32_t next_id;
+    uint32_t burst;
+    float emit;                  // fractional particles carried to the next step
+    float time;
+    float* f[PSIM_FLOATS];
+    uint32_t* color;
+    uint32_t* id;
+    float* zero;                 // rot_x and rot_y
+    void* storage;
+};
+
+// Ken Perlin's permutation, with the wrap-around entry, as Klak.Math.Perlin uses it
+static const uint8_t psim_perm[257] = {
+    151,160,137,91,90,15,131,13,201,95,96,53,194,233,7,225,140,36,103,30,69,142,8,99,37,240,21,10,23,190,6,148,247,
+    120,234,75,0,26,197,62,94,252,219,203,117,35,11,32,57,177,33,88,237,149,56,87,174,20,125,136,171,168,68,175,74,
+    165,71,134,139,48,27,166,77,146,158,231,83,111,229,122,60,211,133,230,220,105,92,41,55,46,245,40,244,102,143,54,
+    65,25,63,161,1,216,80,73,209,76,132,187,208,89,18,169,200,196,135,130,116,188,159,86,164,100,109,198,173,186,3,
+    64,52,217,226,250,124,123,5,202,38,147,118,126,255,82,85,212,207,206,59,227,47,16,58,17,182,189,28,42,223,183,
+    170,213,119,248,152,2,44,154,163,70,221,153,101,155,167,43,172,9,129,22,39,253,19,98,108,110,79,113,224,232,178,
+    185,112,104,218,246,97,228,251,34,242,193,238,210,144,12,191,179,162,241,81,51,145,235,249,14,239,107,49,192,214,
+    31,181,199,106,157,184,84,204,176,115,121,50,45,127,4,150,254,138,236,205,93,222,114,67,29,24,72,243,141,128,195,
+    78,66,215,61,156,180,151
+};
+
+// The passes are written once over psim_v: four particles per value with SSE, one without. Both evaluate the same
+// operations in the same order, so they give the same bits.
+#if PSIM_SSE
+#define PSIM_LANES 4
+typedef __m128 psim_v;
+#define PSIM_SET(s) _mm_set1_ps(s)
+#define PSIM_LOAD(p) _mm_loadu_ps(p)
+// Lanes just written one at a time: a 16-byte load of them would wait on four separate stores
+#define PSIM_LANES_OF(a) _mm_setr_ps((a)[0], (a)[1], (a)[2], (a)[3])
+#define PSIM_STORE(p, v) _mm_storeu_ps(p, v)
+#define PSIM_ADD(a, b) _mm_add_ps(a, b)
+#define PSIM_SUB(a, b) _mm_sub_ps(a, b)
+#define PSIM_MUL(a, b) _mm_mul_ps(a, b)
+#define PSIM_DIV(a, b) _mm_div_ps(a, b)
+#define PSIM_MIN(a, b) _mm_min_ps(a, b)
+#define PSIM_MAX(a, b) _mm_max_ps(a, b)
+#define PSIM_ALIVE(age, life) ((uint32_t)_mm_movemask_ps(_mm_cmplt_ps(age, life)))
+#else
+#define PSIM_LANES 1
+typedef float psim_v;
+#define PSIM_SET(s) (s)
+#define PSIM_LOAD(p) (*(p))
+#define PSIM_LANES_OF(a) ((a)[0])
+#define PSIM_STORE(p, v) (*(p) = (v))
+#define PSIM_ADD(a, b) ((a) + (b))
+#define PSIM_SUB(a, b) ((a) - (b))
+#define PSIM_MUL(a, b) ((a) * (b))
+#define PSIM_DIV(a, b) ((a) / (b))
+// Same semantics as _mm_min_ps/_mm_max_ps: the second operand on ties and NaN
+#define PSIM_MIN(a, b) ((a) < (b) ? (a) : (b))
+#define PSIM_MAX(a, b) ((a) > (b) ? (a) : (b))
+#define PSIM_ALIVE(age, life) ((uint32_t)((age) < (life)))
+#endif
+
+// floorf without the libm call or a branch; inputs stay far inside int range
+static int psim_floor(float x)
+{
+    int i = (int)x;
+    return i - ((float)i > x);
+}
+
+// Perlin's gradients as vectors, so grad(hash, x, y, z) is a dot product
+static const float psim_grad[16][3] = {
+    { 1, 1, 0 }, { -1, 1, 0 }, { 1, -1, 0 }, { -1, -1, 0 }, { 1, 0, 1 }, { -1, 0, 1 }, { 1, 0, -1 }, { -1, 0, -1 },
+    { 0, 1, 1 }, { 0, -1, 1 }, { 0, 1, -1 }, { 0, -1, -1 }, { 1, 1, 0 }, { 0, -1, 1 }, { -1, 1, 0 }, { 0, -1, -1 }
+};
+
+static float psim_dot(int hash, float x, float y, float z)
+{
+    const float* g = psim_grad[hash & 15];
+    return g[0] * x + g[1] * y + g[2] * z;
+}
+
+static psim_v psim_fade(psim_v t)
+{
+    psim_v inner = PSIM_ADD(PSIM_MUL(t, PSIM_SUB(PSIM_MUL(t, PSIM_SET(6.0f)), PSIM_SET(15.0f))), PSIM_SET(10.0f));
+    return PSIM_MUL(PSIM_MUL(PSIM_MUL(t, t), t), inner);
+}
+
+static psim_v psim_lerp(psim_v t, psim_v a, psim_v b) { return PSIM_ADD(a, PSIM_MUL(t, PSIM_SUB(b, a))); }
+
+// Klak.Math.Perlin.Noise(x) for a block of lanes: hashing per lane, interpolation on whole vectors
+static psim_v psim_noise1(const float* x)
+{
+    float frac[PSIM_LANES], sign0[PSIM_LANES], sign1[PSIM_LANES];
+    for (int l = 0; l < PSIM_LANES; l++) {
+        int i = psim_floor(x[l]);
+        frac[l] = x[l] - (float)i;
+        // Random signs, so arithmetic rather than branches
+        sign0[l] = (float)(1 - 2 * (psim_perm[i & 0xff] & 1));
+        sign1[l] = (float)(1 - 2 * (psim_perm[(i & 0xff) + 1] & 1));
+    }
+    psim_v f = PSIM_LANES_OF(frac);
+    psim_v a = PSIM_MUL(PSIM_LANES_OF(sign0), f);
+    psim_v b = PSIM_MUL(PSIM_LANES_OF(sign1), PSIM_SUB(f, PSIM_SET(1.0f)));
+    return PSIM_MUL(psim_lerp(psim_fade(f), a, b), PSIM_SET(2.0f));
+}
+
+// Klak.Math.Perlin.Noise at (x, y, z) + (13, 17, 19) * k, TurbulentMotion's sample for axis k, for the axes with a
+// nonzero amplitude. The offsets are whole lattice steps, so the three samples share the fractional position and
+// fade and differ only in hashing: per lane, while the trilinear blend runs on vectors.
+static void psim_turbulence(const float* x, const float* y, const float* z, const float amplitude[3], psim_v noise[3])
+{
+    float frac[3][PSIM_LANES], dot[3][8][PSIM_LANES];
+    for (int l = 0; l < PSIM_LANES; l++) {
+        int ix = psim_floor(x[l]), iy = psim_floor(y[l]), iz = psim_floor(z[l]);
+        float fx = x[l] - (float)ix, fy = y[l] - (float)iy, fz = z[l] - (float)iz;
+        frac[0][l] = fx;
+        frac[1][l] = fy;
+        frac[2][l] = fz;
+        for (int k = 0; k < 3; k++) {
+            if (amplitude[k] == 0.0f) continue;
+            int X = (ix + 13 * k) & 0xff, Y = (iy + 17 * k) & 0xff, Z = (iz + 19 * k) & 0xff;
+            int A = (psim_perm[X] + Y) & 0xff, B = (psim_perm[X + 1] + Y) & 0xff;
+            int AA = (psim_perm[A] + Z) & 0xff, BA = (psim_perm[B] + Z) & 0xff;
+            int AB = (psim_perm[A + 1] + Z) & 0xff, BB = (psim_perm[B + 1] + Z) & 0xff;
+            // Corner c is at (c & 1, c >> 1 & 1, c >> 2 & 1)
+            float(*d)[PSIM_LANES] = dot[k];
+            d[0][l] = psim_dot(psim_perm[AA], fx, fy, fz);
+            d[1][l] = psim_dot(psim_perm[BA], fx - 1, fy, fz);
+            d[2][l] = psim_dot(psim_perm[AB], fx, fy - 1, fz);
+            d[3][l] = psim_dot(psim_perm[BB], fx - 1, fy - 1, fz);
+            d[4][l] = psim_dot(psim_perm[AA + 1], fx, fy, fz - 1);
+            d[5][l] = psim_dot(psim_perm[BA + 1], fx - 1, fy, fz - 1);
+            d[6][l] = psim_dot(psim_perm[AB + 1], fx, fy - 1, fz - 1);
+            d[7][l] = psim_dot(psim_perm[BB + 1], fx - 1, fy - 1, fz - 1);
+        }
+    }
+
+    psim_v u[3];
+    for (int k = 0; k < 3; k++) u[k] = psim_fade(PSIM_LANES_OF(frac[k]));
+    for (int k = 0; k < 3; k++) {
+        noise[k] = PSIM_SET(0.0f);
+        if (amplitude[k] == 0.0f) continue;
+        psim_v d[8];
+        for (int c = 0; c < 8; c++) d[c] = PSIM_LANES_OF(dot[k][c]);
+        noise[k] = psim_lerp(u[2], psim_lerp(u[1], psim_lerp(u[0], d[0], d[1]), psim_lerp(u[0], d[2], d[3])),
+                             psim_lerp(u[1], psim_lerp(u[0], d[4], d[5]), psim_lerp(u[0], d[6], d[7])));
+    }
+}
+
+// Klak.Math.Perlin.Fbm(x, octaves)
+static psim_v psim_fbm1(const float* x, uint32_t octaves)
+{
+    float at[PSIM_LANES];
+    for (int l = 0; l < PSIM_LANES; l++) at[l] = x[l];
+    psim_v sum = PSIM_SET(0.0f);
+    float w = 0.5f;
+    for (uint32_t i = 0; i < octaves; i++) {
+        sum = PSIM_ADD(sum, PSIM_MUL(PSIM_SET(w), psim_noise1(at)));
+        for (int l = 0; l < PSIM_LANES; l++) at[l] *= 2.0f;
+        w *= 0.5f;
+    }
+    return sum;
+}
+
+// xorshift32, uniform in [0, 1)
+static float psim_random(psim_emitter* e)
+{
+    uint32_t x = e->rng;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    e->rng = x;
+    return (float)(x >> 8) * (1.0f / 16777216.0f);
+}
+
+static void psim_random_ball(psim_emitter* e, float radius, float out[3])
+{
+    float x, y, z;
+    do {
+        x = psim_random(e) * 2.0f - 1.0f;
+        y = psim_random(e) * 2.0f - 1.0f;
+        z = psim_random(e) * 2.0f - 1.0f;
+    } while (x * x + y * y + z * z > 1.0f);
+    out[0] = x * radius;
+    out[1] = y * radius;
+    out[2] = z * radius;
+}
+
+void psim_desc_defaults(psim_desc* desc)
+{
+    memset(desc, 0, sizeof(*desc));
+    desc->capacity = 1000;
+    desc->seed = 1;
+    desc->rate = 10.0f;
+    desc->lifetime = 2.0f;
+    desc->size_start = desc->size_end = 1.0f;
+    for (int i = 0; i < 4; i++) desc->color_start[i] = desc->color_end[i] = 1.0f;
+    desc->brownian_frequency = 0.2f;
+    desc->brownian_amplitude = 0.5f;
+    desc->brownian_scale[0] = desc->brownian_scale[1] = desc->brownian_scale[2] = 1.0f;
+    desc->noise_density = 0.1f;
+}
+
+psim_emitter* psim_create(const psim_desc* desc)
+{
+    if (desc->capacity == 0 || desc->capacity > (1u << 24)) return NULL;
+    psim_emitter* e = (psim_emitter*)calloc(1, sizeof(psim_emitter));
+    if (!e) return NULL;
+
+    // Whole SIMD blocks, so passes never need a scalar tail
+    size_t stride = ((size_t)desc->capacity + 3) & ~(size_t)3;
+    e->storage = calloc(stride * (PSIM_FLOATS + 3), 4);
+    if (!e->storage) {
+        free(e);
+        return NULL;
+    }
+    float* floats = (float*)e->storage;
+    for (int i = 0; i < PSIM_FLOATS; i++) e->f[i] = floats + stride * i;
+    e->zero = floats + stride * PSIM_FLOATS;
+    e->color = (uint32_t*)(e->zero + stride);
+    e->id = e->color + stride;
+
+    e->desc = *desc;
+    e->capacity = desc->capacity;
+    e->rng = desc->seed ? desc->seed : 1;
+    psim_reset(e);
+    return e;
+}
+
+void psim_destroy(psim_emitter* emitter)
+{
+    if (!emitter) return;
+    free(emitter->storage);
+    free(emitter);
+}
+
+psim_desc* psim_get_desc(psim_emitter* emitter) { return &emitter->desc; }
+void psim_burst(psim_emitter* emitter, uint32_t count) { emitter->burst += count; }
+uint32_t psim_live(const psim_emitter* emitter) { return emitter->live; }
+const uint32_t* psim_ids(const psim_emitter* emitter) { return emitter->id; }
+
+void psim_reset(psim_emitter* emitter)
+{
+    emitter->live = 0;
+    emitter->burst = 0;
+    emitter->emit = 0.0f;
+    emitter->time = 0.0f;
+}
+
+static void psim_spawn(psim_emitter* e, uint32_t count)
+{
+    const psim_desc* d = &e->desc;
+    float** f = e->f;
+    for (uint32_t n = 0; n < count; n++) {
+        uint32_t i = e->live++;
+        float offset[3], jitter[3];
+        psim_random_ball(e, d->spawn_radius, offset);
+        psim_random_ball(e, d->velocity_random, jitter);
+        for (int k = 0; k < 3; k++) {
+            f[PSIM_X + k][i] = d->origin[k] + offset[k];
+            f[PSIM_VX + k][i] = d->velocity[k] + jitter[k];
+            // The permutation repeats every 256, so any phase in [0, 256) is as good as Klak's [-10000, 0)
+            f[PSIM_PHASE_X + k][i] = psim_random(e) * 256.0f;
+        }
+        f[PSIM_AGE][i] = 0.0f;
+        float life = d->lifetime * (1.0f - d->lifetime_random * psim_random(e));
+        f[PSIM_LIFE][i] = life > 1e-6f ? life : 1e-6f;
+        float spin = d->spin * (PSIM_PI / 180.0f) * (1.0f - d->spin_random * psim_random(e));
+        f[PSIM_SPIN][i] = psim_random(e) < 0.5f ? -spin : spin;
+        f[PSIM_ROT][i] = psim_random(e) * 2.0f * PSIM_PI;
+        if (++e->next_id == 0) e->next_id = 1;
+        e->id[i] = e->next_id;
+    }
+}
+
+// v = v * damping + (gravity + noise) * dt; p += (v + constant motion) * dt
+static void psim_integrate(psim_emitter* e, float dt)
+{
+    const psim_desc* d = &e->desc;
+    float** f = e->f;
+    int turbulent = d->noise_amplitude[0] != 0.0f || d->noise_amplitude[1] != 0.0f || d->noise_amplitude[2] != 0.0f;
+    psim_v density = PSIM_SET(d->noise_density);
+    psim_v damping = PSIM_SET(expf(-d->drag * dt));
+    psim_v step = PSIM_SET(dt);
+    float flow[3];
+    for (int k = 0; k < 3; k++) flow[k] = d->noise_flow[k] * e->time;
+
+    for (uint32_t base = 0; base < e->live; base += PSIM_LANES) {
+        psim_v noise[3];
+        if (turbulent) {
+            float at[3][PSIM_LANES];
+            for (int j = 0; j < 3; j++)
+                PSIM_STORE(at[j], PSIM_ADD(PSIM_MUL(PSIM_LOAD(f[PSIM_X + j] + base), density), PSIM_SET(flow[j])));
+            psim_turbulence(at[0], at[1], at[2], d->noise_amplitude, noise);
+        }
+        for (int k = 0; k < 3; k++) {
+            psim_v accel = PSIM_SET(d->gravity[k]);
+            if (turbulent) accel = PSIM_ADD(accel, PSIM_MUL(PSIM_SET(d->noise_amplitude[k]), noise[k]));
+            float* p = f[PSIM_X + k] + base;
+            float* v = f[PSIM_VX + k] + base;
+            psim_v vel = PSIM_ADD(PSIM_MUL(PSIM_LOAD(v), damping), PSIM_MUL(accel, step));
+            PSIM_STORE(v, vel);
+            PSIM_STORE(p, PSIM_ADD(PSIM_LOAD(p), PSIM_MUL(PSIM_ADD(vel, PSIM_SET(d->constant_motion[k])), step)));
+        }
+    }
+}
+
+// Ages particles and derives what is drawn: size, color and spin over life, and the Brownian displacement
+static void psim_age(psim_emitter* e, float dt)
+{
+    const psim_desc* d = &e->desc;
+    float** f = e->f;
+    psim_v step = PSIM_SET(dt), zero = PSIM_SET(0.0f), one = PSIM_SET(1.0f);
+    psim_v size0 = PSIM_SET(d->size_start), size_delta = PSIM_SET(d->size_end - d->size_start);
+    psim_v color0[4], color_delta[4];
+    for (int c = 0; c < 4; c++) {
+        color0[c] = PSIM_SET(d->color_start[c] * 255.0f);
+        color_delta[c] = PSIM_SET((d->color_end[c] - d->color_start[c]) * 255.0f);
+    }
+    psim_v c255 = PSIM_SET(255.0f), half = PSIM_SET(0.5f);
+    psim_v frequency = PSIM_SET(d->brownian_frequency);
+    float amplitude[3];
+    for (int k = 0; k < 3; k++) amplitude[k] = d->brownian_scale[k] * d->brownian_amplitude * PSIM_FBM_NORM;
+
+    for (uint32_t base = 0; base < e->live; base += PSIM_LANES) {
+        psim_v age = PSIM_ADD(PSIM_LOAD(f[PSIM_AGE] + base), step);
+        PSIM_STORE(f[PSIM_AGE] + base, age);
+        psim_v t = PSIM_MIN(PSIM_DIV(age, PSIM_LOAD(f[PSIM_LIFE] + base)), one);
+
+        PSIM_STORE(f[PSIM_SIZE] + base, PSIM_ADD(size0, PSIM_MUL(size_delta, t)));
+        PSIM_STORE(f[PSIM_ROT] + base, PSIM_ADD(PSIM_LOAD(f[PSIM_ROT] + base), PSIM_MUL(PSIM_LOAD(f[PSIM_SPIN] + base), step)));
+
+        // Color channels in 0..255 plus a half, truncated to bytes below
+        float channel[4][PSIM_LANES];
+        for (int c = 0; c < 4; c++) {
+            psim_v value = PSIM_ADD(color0[c], PSIM_MUL(color_delta[c], t));
+            PSIM_STORE(channel[c], PSIM_ADD(PSIM_MIN(PSIM_MAX(value, zero), c255), half));
+        }
+
+        for (int l = 0; l < PSIM_LANES; l++)
+            e->color[base + l] = (uint32_t)channel[0][l] | (uint32_t)channel[1][l] << 8 | (uint32_t)channel[2][l] << 16 |
+                                 (uint32_t)channel[3][l] << 24;
+
+        psim_v phase = PSIM_MUL(age, frequency);
+        for (int k = 0; k < 3; k++) {
+            psim_v p = PSIM_LOAD(f[PSIM_X + k] + base);
+            if (d->brownian_octaves) {
+                float at[PSIM_LANES];
+                PSIM_STORE(at, PSIM_ADD(PSIM_LOAD(f[PSIM_PHASE_X + k] + base), phase));
+                p = PSIM_ADD(p, PSIM_MUL(psim_fbm1(at, d->brownian_octaves), PSIM_SET(amplitude[k])));
+            }
+            PSIM_STORE(f[PSIM_OUT_X + k] + base, p);
+        }
+    }
+}
+
+// Drops particles past their lifetime, keeping the rest in spawn order. Blocks with no dead particle before them
+// are skipped four at a time.
+static void psim_compact(psim_emitter* e)
+{
+    float** f = e->f;
+    uint32_t write = 0;
+    for (uint32_t base = 0; base < e->live; base += PSIM_LANES) {
+        uint32_t lanes = e->live - base < PSIM_LANES ? e->live - base : PSIM_LANES;
+        uint32_t alive = PSIM_ALIVE(PSIM_LOAD(f[PSIM_AGE] + base), PSIM_LOAD(f[PSIM_LIFE] + base)) & ((1u << lanes) - 1);
+        if (alive == (1u << PSIM_LANES) - 1 && write == base) {
+            write += PSIM_LANES;
+            continue;
+        }
+        for (uint32_t l = 0; l < lanes; l++) {
+            if (!(alive & (1u << l))) continue;
+            uint32_t from = base + l;
+            if (from != write) {
+                for (int a = 0; a < PSIM_FLOATS; a++) f[a][write] = f[a][from];
+                e->color[write] = e->color[from];
+                e->id[write] = e->id[from];
+            }
+            write++;
+        }
+    }
+    e->live = write;
+}
+
+void psim_step(psim_emitter* emitter, float dt)
+{
+    psim_emitter* e = emitter;
+    if (!(dt > 0.0f)) dt = 0.0f;
+    e->time += dt;
+
+    e->emit += e->desc.rate > 0.0f ? e->desc.rate * dt : 0.0f;
+    uint32_t count = (uint32_t)e->emit;
+    e->emit -= (float)count;
+    count += e->burst;
+    e->burst = 0;
+    if (count > e->capacity - e->live) count = e->capacity - e->live;
+    psim_spawn(e, count);
+
+    psim_integrate(e, dt);
+    psim_age(e, dt);
+    psim_compact(e);
+}
+
+void psim_instances(const psim_emitter* emitter, ptc0_instances* instances)
+{
+    instances->count = emitter->live;
+    instances->x = emitter->f[PSIM_OUT_X];
+    instances->y = emitter->f[PSIM_OUT_Y];
+    instances->z = emitter->f[PSIM_OUT_Z];
+    instances->size = emitter->f[PSIM_SIZE];
+    instances->rot_x = emitter->zero;
+    instances->rot_y = emitter->zero;
+    instances->rot_z = emitter->f[PSIM_ROT];
+    instances->color = emitter->color;
+}
+
+struct psim_pool {
+#if defined(_WIN32)
+    HANDLE* threads;
+    CRITICAL_SECTION lock;
+    CONDITION_VARIABLE wake;
+    CONDITION_VARIABLE done;
+#else
+    pthread_t* threads;
+    int* started;
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    pthread_cond_t done;
+#endif
+    uint32_t thread_count;
+    int quit;
+    // The batch being stepped; generation changes with every psim_step_all
+    uint32_t generation;
+    psim_emitter* const* emitters;
+    uint32_t count;
+    uint32_t next;
+    uint32_t busy;
+    float dt;
+};
+
+#if defined(_WIN32)
+static void psim_lock(psim_pool* p) { EnterCriticalSection(&p->lock); }
+static void psim_unlock(psim_pool* p) { LeaveCriticalSection(&p->lock); }
+static void psim_wait(psim_pool* p, CONDITION_VARIABLE* c) { SleepConditionVariableCS(c, &p->lock, INFINITE); }
+static void psim_wake_all(CONDITION_VARIABLE* c) { WakeAllConditionVariable(c); }
+#else
+static void psim_lock(psim_pool* p) { pthread_mutex_lock(&p->lock); }
+static void psim_unlock(psim_pool* p) { pthread_mutex_unlock(&p->lock); }
+static void psim_wait(psim_pool* p, pthread_cond_t* c) { pthread_cond_wait(c, &p->lock); }
+static void psim_wake_all(pthread_cond_t* c) { pthread_cond_broadcast(c); }
+#endif
+
+// Takes emitters from the current batch until none are left. Called and returns with the lock held.
+static void psim_drain(psim_pool* pool)
+{
+    while (pool->next < pool->count) {
+        psim_emitter* e = pool->emitters[pool->next++];
+        float dt = pool->dt;
+        psim_unlock(pool);
+        psim_step(e, dt);
+        psim_lock(pool);
+    }
+}
+
+static void psim_worker(psim_pool* pool)
+{
+    psim_lock(pool);
+    uint32_t seen = pool->generation;
+    for (;;) {
+        while (!pool->quit && pool->generation == seen) psim_wait(pool, &pool->wake);
+        if (pool->quit) break;
+        // A worker that wakes late may find a newer batch, or none left; either is fine
+        seen = pool->generation;
+        pool->busy++;
+        psim_drain(pool);
+        if (--pool->busy == 0) psim_wake_all(&pool->done);
+    }
+    psim_unlock(pool);
+}
+
+#if defined(_WIN32)
+static DWORD WINAPI psim_thread(LPVOID arg) { psim_worker((psim_pool*)arg); return 0; }
+#else
+static void* psim_thread(void* arg) { psim_worker((psim_pool*)arg); return NULL; }
+#endif
+
+psim_pool* psim_pool_create(uint32_t threads)
+{
+    psim_pool* pool = (psim_pool*)calloc(1, sizeof(psim_pool));
+    if (!pool) return NULL;
+    pool->thread_count = threads > 1 ? threads : 1;
+
+#if defined(_WIN32)
+    InitializeCriticalSection(&pool->lock);
+    InitializeConditionVariable(&pool->wake);
+    InitializeConditionVariable(&pool->done);
+    pool->threads = (HANDLE*)calloc(pool->thread_count, sizeof(HANDLE));
+    if (!pool->threads) pool->thread_count = 1;
+    for (uint32_t t = 1; t < pool->thread_count; t++) pool->threads[t] = CreateThread(NULL, 0, psim_thread, pool, 0, NULL);
+#else
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->wake, NULL);
+    pthread_cond_init(&pool->done, NULL);
+    pool->threads = (pthread_t*)calloc(pool->thread_count, sizeof(pthread_t));
+    pool->started = (int*)calloc(pool->thread_count, sizeof(int));
+    if (!pool->threads || !pool->started) pool->thread_count = 1;
+    for (uint32_t t = 1; t < pool->thread_count; t++)
+        pool->started[t] = pthread_create(&pool->threads[t], NULL, psim_thread, pool) == 0;
+#endif
+    return pool;
+}
+
+void psim_pool_destroy(psim_pool* pool)
+{
+    if (!pool) return;
+    psim_lock(pool);
+    pool->quit = 1;
+    psim_wake_all(&pool->wake);
+    psim_unlock(pool);
+
+    for (uint32_t t = 1; t < pool->thread_count; t++) {
+#if defined(_WIN32)
+        if (pool->threads[t]) {
+            WaitForSingleObject(pool->threads[t], INFINITE);
+            CloseHandle(pool->threads[t]);
+        }
+#else
+        if (pool->started[t]) pthread_join(pool->threads[t], NULL);
+#endif
+    }
+
+#if defined(_WIN32)
+    DeleteCriticalSection(&pool->lock);
+#else
+    pthread_cond_destroy(&pool->done);
+    pthread_cond_destroy(&pool->wake);
+    pthread_mutex_destroy(&pool->lock);
+    free(pool->started);
+#endif
+    free(pool->threads);
+    free(pool);
+}
+
+void psim_step_all(psim_pool* pool, psim_emitter* const* emitters, uint32_t count, float dt)
+{
+    psim_lock(pool);
+    pool->emitters = emitters;
+    pool->count = count;
+    pool->next = 0;
+    pool->dt = dt;
+    pool->generation++;
+    if (pool->thread_count > 1 && count > 1) psim_wake_all(&pool->wake);
+
+    // The caller works too, then waits for whoever is still finishing an emitter
+    psim_drain(pool);
+    while (pool->busy > 0) psim_wait(pool, &pool->done);
+    psim_unlock(pool);
+}
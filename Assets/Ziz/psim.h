@@ -0,0 +1,104 @@
+#ifndef PSIM_H
+#define PSIM_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "ptc0.h"
+
+// Particle emitters simulated at runtime, for effects that don't need a ParticleSystem recording.
+//
+//   psim_desc desc;
+//   psim_desc_defaults(&desc);
+//   desc.rate = 400.0f;
+//   desc.noise_amplitude[1] = 2.0f;
+//   psim_emitter* sparks = psim_create(&desc);
+//   psim_pool* pool = psim_pool_create(4);
+//   every frame:
+//     psim_step_all(pool, emitters, count, dt);           // or psim_step(sparks, dt) on one thread
+//     psim_instances(sparks, &instances);
+//     ptc0_expand_instances(&instances, eye, xyz, rgba);  // the same quads as a recorded PTC0 stream
+//
+// Particles live in SoA arrays in spawn order. A step emits, integrates (gravity, drag, the noise field, constant
+// motion), ages (size, color and spin over life, Brownian displacement) and compacts the dead out, each pass over
+// four particles per SSE step where available, with scalar code giving the same bits otherwise. The forces mirror the
+// motion components the effects are built from in Unity: Reaktion/Klak ConstantMotion, Klak BrownianMotion and
+// Reaktion TurbulentMotion, with Ken Perlin's noise as in Klak.Math.Perlin.
+//
+// The desc may be changed between steps (gears modulating rate or size, say); capacity and seed are read once.
+// Coordinates are in whatever space the caller works in; exported space (Z mirrored) to match recorded streams.
+
+typedef struct psim_desc {
+    uint32_t capacity;           // most particles alive at once; emission stalls while full
+    uint32_t seed;
+
+    // Emission
+    float rate;                  // particles per second
+    float lifetime;              // seconds
+    float lifetime_random;       // 0..1: each particle lives lifetime * (1 - lifetime_random * u)
+    float origin[3];
+    float spawn_radius;          // uniform in a ball around origin
+    float velocity[3];
+    float velocity_random;       // plus a random vector uniform in a ball of this radius
+
+    // Over life, linearly from start to end
+    float size_start, size_end;
+    float color_start[4], color_end[4];    // RGBA 0..1
+    float spin;                  // degrees per second about the view axis
+    float spin_random;           // 0..1, like lifetime_random; spin direction is random
+
+    // Forces
+    float gravity[3];
+    float drag;                  // per second: velocity decays by exp(-drag * dt)
+
+    // ConstantMotion: every particle drifts by this many units per second, on top of its velocity
+    float constant_motion[3];
+
+    // BrownianMotion: fBm displacement along each axis, offset from the simulated position, each particle on its own
+    // noise phase (Klak's positionFrequency, positionAmplitude, positionScale and positionFractalLevel)
+    float brownian_frequency;
+    float brownian_amplitude;
+    float brownian_scale[3];
+    uint32_t brownian_octaves;   // 0 disables
+
+    // TurbulentMotion: acceleration from 3D noise at position * noise_density + noise_flow * time, one noise sample
+    // per axis at TurbulentMotion's offsets
+    float noise_density;
+    float noise_flow[3];
+    float noise_amplitude[3];    // all 0 disables
+} psim_desc;
+
+typedef struct psim_emitter psim_emitter;
+typedef struct psim_pool psim_pool;
+
+// Klak-like defaults: 10 particles per second living 2 seconds, unit size, white, no forces
+void psim_desc_defaults(psim_desc* desc);
+
+// NULL if out of memory or capacity is 0
+psim_emitter* psim_create(const psim_desc* desc);
+void psim_destroy(psim_emitter* emitter);
+
+// The emitter's desc; changes take effect on the next step
+psim_desc* psim_get_desc(psim_emitter* emitter);
+
+// Emits count particles at the start of the next step, on top of the rate (ParticleSystemGear's burst)
+void psim_burst(psim_emitter* emitter, uint32_t count);
+
+// Kills every particle and restarts time and emission
+void psim_reset(psim_emitter* emitter);
+
+void psim_step(psim_emitter* emitter, float dt);
+
+// Live particles, in spawn order, valid until the next step. rot_x and rot_y are zero, rot_z is the spin angle.
+void psim_instances(const psim_emitter* emitter, ptc0_instances* instances);
+
+// Stable IDs of the live particles, parallel to psim_instances, numbered from 1 in spawn order
+const uint32_t* psim_ids(const psim_emitter* emitter);
+uint32_t psim_live(const psim_emitter* emitter);
+
+// Steps emitters on up to threads threads, the caller's included. Workers stay parked between calls, so stepping
+// every frame costs no thread creation. NULL if out of memory; a pool whose threads can't start runs on the caller.
+psim_pool* psim_pool_create(uint32_t threads);
+void psim_pool_destroy(psim_pool* pool);
+void psim_step_all(psim_pool* pool, psim_emitter* const* emitters, uint32_t count, float dt);
+
+#endif
@@ -0,0 +1,93 @@
+// Steps a set of psim emitters with every force enabled and times psim_step_all plus quad expansion per frame.
+//
+//   cc -O2 -I. psim_bench.c psim.c ptc0.c ztime.c -lm -lpthread -o psim_bench
+//   ./psim_bench [emitters] [particles per emitter] [threads] [frames]
+
+#include "psim.h"
+#include "ztime.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+int main(int argc, char** argv)
+{
+    int emitter_count = argc > 1 ? atoi(argv[1]) : 4;
+    int particles = argc > 2 ? atoi(argv[2]) : 2000;
+    int threads = argc > 3 ? atoi(argv[3]) : 4;
+    int frames = argc > 4 ? atoi(argv[4]) : 600;
+    if (emitter_count < 1 || particles < 1 || threads < 1 || frames < 1) {
+        fprintf(stderr, "usage: %s [emitters] [particles per emitter] [threads] [frames]\n", argv[0]);
+        return 1;
+    }
+
+    const float dt = 1.0f / 60.0f;
+    psim_emitter** emitters = (psim_emitter**)calloc((size_t)emitter_count, sizeof(psim_emitter*));
+    float* xyz = (float*)malloc((size_t)particles * 12 * sizeof(float));
+    uint32_t* rgba = (uint32_t*)malloc((size_t)particles * 4 * sizeof(uint32_t));
+    psim_pool* pool = psim_pool_create((uint32_t)threads);
+    if (!emitters || !xyz || !rgba || !pool) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+
+    for (int i = 0; i < emitter_count; i++) {
+        psim_desc desc;
+        psim_desc_defaults(&desc);
+        desc.capacity = (uint32_t)particles;
+        desc.seed = (uint32_t)i + 1;
+        desc.lifetime = 3.0f;
+        desc.lifetime_random = 0.3f;
+        desc.rate = (float)particles / desc.lifetime;
+        desc.origin[0] = (float)i * 4.0f;
+        desc.spawn_radius = 0.5f;
+        desc.velocity[1] = 2.0f;
+        desc.velocity_random = 1.0f;
+        desc.size_start = 0.2f;
+        desc.size_end = 0.0f;
+        desc.color_end[3] = 0.0f;
+        desc.spin = 90.0f;
+        desc.gravity[1] = -1.0f;
+        desc.drag = 0.5f;
+        desc.constant_motion[2] = 0.3f;
+        desc.brownian_octaves = 2;
+        desc.noise_flow[1] = 0.5f;
+        desc.noise_amplitude[0] = desc.noise_amplitude[1] = desc.noise_amplitude[2] = 3.0f;
+        emitters[i] = psim_create(&desc);
+        if (!emitters[i]) {
+            fprintf(stderr, "out of memory\n");
+            return 1;
+        }
+    }
+
+    // Fill the emitters before timing
+    for (int f = 0; f < 240; f++) psim_step_all(pool, emitters, (uint32_t)emitter_count, dt);
+
+    const float eye[3] = { 0.0f, 1.0f, -10.0f };
+    double step_us = 0.0, expand_us = 0.0, worst_us = 0.0;
+    uint64_t live = 0;
+    for (int f = 0; f < frames; f++) {
+        double start = ztime_now_us();
+        psim_step_all(pool, emitters, (uint32_t)emitter_count, dt);
+        double stepped = ztime_now_us();
+        for (int i = 0; i < emitter_count; i++) {
+            ptc0_instances instances;
+            psim_instances(emitters[i], &instances);
+            ptc0_expand_instances(&instances, eye, xyz, rgba);
+            live += instances.count;
+        }
+        double end = ztime_now_us();
+        step_us += stepped - start;
+        expand_us += end - stepped;
+        if (end - start > worst_us) worst_us = end - start;
+    }
+
+    printf("%d emitters x %d particles on %d threads, %d frames\n", emitter_count, particles, threads, frames);
+    printf("live/frame: %.1f\n", (double)live / frames);
+    printf("step: %.2f us/frame, expand: %.2f us/frame, worst frame %.2f us\n", step_us / frames, expand_us / frames, worst_us);
+
+    for (int i = 0; i < emitter_count; i++) psim_destroy(emitters[i]);
+    psim_pool_destroy(pool);
+    free(emitters);
+    free(xyz);
+    free(rgba);
+    return 0;
+}
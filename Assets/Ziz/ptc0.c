@@ -0,0 +1,478 @@
+#include "ptc0.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define PTC0_SSE 1
+#include <xmmintrin.h>
+#endif
+
+#define PTC0_HEADER_SIZE 60
+#define PTC0_FRAME_KEY 1u
+#define PTC0_FRAME_CAMERA 2u
+#define PTC0_PI 3.14159265358979f
+
+// Quantized channels, in the order each frame stores them
+enum {
+    PTC0_X, PTC0_Y, PTC0_Z,
+    PTC0_SIZE,
+    PTC0_ROT_X, PTC0_ROT_Y, PTC0_ROT_Z,
+    PTC0_R, PTC0_G, PTC0_B, PTC0_A,
+    PTC0_CHANNELS
+};
+
+// Lives at the start of stream->storage
+typedef struct ptc0_state {
+    const uint8_t* data;
+    size_t size;
+    const uint8_t* offsets;          // frame_count + 1 file offsets
+    uint16_t* last[PTC0_CHANNELS];   // per live particle: value in the current frame
+    uint16_t* before[PTC0_CHANNELS]; // and in the one before (equal to last on a particle's first frame)
+    uint32_t* keep;                  // scratch: previous-frame indices of the survivors
+    float* out[7];                   // x, y, z, size, rot_x, rot_y, rot_z
+    uint32_t* color;
+} ptc0_state;
+
+static uint32_t ptc0_read_u32(const uint8_t* p) { return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24; }
+static float ptc0_read_f32(const uint8_t* p) { uint32_t u = ptc0_read_u32(p); float f; memcpy(&f, &u, 4); return f; }
+
+// LEB128; fails past end or beyond 32 bits
+static int ptc0_read_varint(const uint8_t** p, const uint8_t* end, uint32_t* value)
+{
+    uint32_t v = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        if (*p >= end) return 0;
+        uint8_t b = *(*p)++;
+        v |= (uint32_t)(b & 0x7F) << shift;
+        if (!(b & 0x80)) {
+            *value = v;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int ptc0_bind(ptc0_stream* stream, const void* data, size_t size)
+{
+    const uint8_t* p = (const uint8_t*)data;
+    memset(stream, 0, sizeof(*stream));
+    stream->frame = PTC0_NO_FRAME;
+
+    if (size < PTC0_HEADER_SIZE || ptc0_read_u32(p) != PTC0_MAGIC) return PTC0_ERR_HEADER;
+    stream->version = ptc0_read_u32(p + 4);
+    if (stream->version != 1) return PTC0_ERR_HEADER;
+    stream->frame_count = ptc0_read_u32(p + 8);
+    stream->fps = ptc0_read_f32(p + 12);
+    stream->flags = ptc0_read_u32(p + 16);
+    stream->max_live = ptc0_read_u32(p + 20);
+    stream->key_interval = ptc0_read_u32(p + 24);
+    for (int i = 0; i < 3; i++) {
+        stream->bounds_min[i] = ptc0_read_f32(p + 28 + i * 4);
+        stream->bounds_max[i] = ptc0_read_f32(p + 40 + i * 4);
+    }
+    stream->size_max = ptc0_read_f32(p + 52);
+    uint32_t texture_length = ptc0_read_u32(p + 56);
+    if (stream->key_interval == 0 || stream->max_live > (1u << 24) || texture_length >= sizeof(stream->texture)) return PTC0_ERR_HEADER;
+
+    // Frame offsets follow the texture name; each frame ends where the next begins
+    size_t table = PTC0_HEADER_SIZE + (size_t)texture_length;
+    if (table > size || ((uint64_t)stream->frame_count + 1) * 4 > size - table) return PTC0_ERR_HEADER;
+    const uint8_t* offsets = p + table;
+    uint64_t previous = table + ((uint64_t)stream->frame_count + 1) * 4;
+    for (uint32_t f = 0; f <= stream->frame_count; f++) {
+        uint32_t offset = ptc0_read_u32(offsets + (size_t)f * 4);
+        if (offset < previous || offset > size) return PTC0_ERR_HEADER;
+        previous = offset;
+    }
+    memcpy(stream->texture, p + PTC0_HEADER_SIZE, texture_length);
+    stream->texture[texture_length] = '\0';
+
+    // State header, seven float arrays, colors and survivor scratch, then the 16-bit channel history, then the bytes
+    size_t stride = ((size_t)stream->max_live + 3) & ~(size_t)3;
+    if (stride == 0) stride = 4;
+    size_t head = (sizeof(ptc0_state) + 63) & ~(size_t)63;
+    size_t total = head + stride * 4 * 9 + stride * 2 * PTC0_CHANNELS * 2 + size;
+    uint8_t* storage = (uint8_t*)calloc(1, total);
+    if (!storage) return PTC0_ERR_MEMORY;
+
+    ptc0_state* state = (ptc0_state*)storage;
+    float* floats = (float*)(storage + head);
+    for (int i = 0; i < 7; i++) state->out[i] = floats + stride * i;
+    state->color = (uint32_t*)(floats + stride * 7);
+    state->keep = state->color + stride;
+    uint16_t* history = (uint16_t*)(state->keep + stride);
+    for (int c = 0; c < PTC0_CHANNELS; c++) {
+        state->last[c] = history + stride * c;
+        state->before[c] = history + stride * (PTC0_CHANNELS + c);
+    }
+    uint8_t* copy = (uint8_t*)(history + stride * PTC0_CHANNELS * 2);
+    memcpy(copy, data, size);
+    state->data = copy;
+    state->size = size;
+    state->offsets = copy + table;
+
+    stream->storage = storage;
+    stream->x = state->out[0];
+    stream->y = state->out[1];
+    stream->z = state->out[2];
+    stream->size = state->out[3];
+    stream->rot_x = state->out[4];
+    stream->rot_y = state->out[5];
+    stream->rot_z = state->out[6];
+    stream->color = state->color;
+    return PTC0_OK;
+}
+
+int ptc0_load(ptc0_stream* stream, const char* path)
+{
+    memset(stream, 0, sizeof(*stream));
+    stream->frame = PTC0_NO_FRAME;
+#if defined(_WIN32)
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) return PTC0_ERR_IO;
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size)) { CloseHandle(file); return PTC0_ERR_IO; }
+    HANDLE section = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(file);
+    if (!section) return PTC0_ERR_IO;
+    void* data = MapViewOfFile(section, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(section);
+    if (!data) return PTC0_ERR_IO;
+    int result = ptc0_bind(stream, data, (size_t)size.QuadPart);
+    UnmapViewOfFile(data);
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return PTC0_ERR_IO;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) { close(fd); return PTC0_ERR_IO; }
+    void* data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) return PTC0_ERR_IO;
+    int result = ptc0_bind(stream, data, (size_t)st.st_size);
+    munmap(data, (size_t)st.st_size);
+#endif
+    return result;
+}
+
+void ptc0_free(ptc0_stream* stream)
+{
+    free(stream->storage);
+    memset(stream, 0, sizeof(*stream));
+    stream->frame = PTC0_NO_FRAME;
+}
+
+// Advances the channel history by one frame. live is the particle count before the frame on entry, after it on exit.
+static int ptc0_decode_frame(ptc0_stream* stream, ptc0_state* state, uint32_t frame, uint32_t* live)
+{
+    const uint8_t* p = state->data + ptc0_read_u32(state->offsets + (size_t)frame * 4);
+    const uint8_t* end = state->data + ptc0_read_u32(state->offsets + (size_t)frame * 4 + 4);
+    if (p >= end) return PTC0_ERR_DATA;
+
+    uint8_t flags = *p++;
+    stream->has_camera = (flags & PTC0_FRAME_CAMERA) != 0;
+    if (stream->has_camera) {
+        if (end - p < 12) return PTC0_ERR_DATA;
+        for (int i = 0; i < 3; i++) stream->camera[i] = ptc0_read_f32(p + i * 4);
+        p += 12;
+    }
+
+    // Kills are ascending indices into the previous frame, gap coded; a key frame drops everything
+    uint32_t previous = (flags & PTC0_FRAME_KEY) ? 0 : *live;
+    uint32_t kills = 0, kept = 0, next = 0;
+    if (!(flags & PTC0_FRAME_KEY) && !ptc0_read_varint(&p, end, &kills)) return PTC0_ERR_DATA;
+    if (kills > previous) return PTC0_ERR_DATA;
+    for (uint32_t k = 0; k < kills; k++) {
+        uint32_t gap;
+        if (!ptc0_read_varint(&p, end, &gap)) return PTC0_ERR_DATA;
+        uint64_t index = (uint64_t)next + gap;
+        if (index >= previous) return PTC0_ERR_DATA;
+        while (next < index) state->keep[kept++] = next++;
+        next++;
+    }
+    while (next < previous) state->keep[kept++] = next++;
+
+    uint32_t spawns;
+    if (!ptc0_read_varint(&p, end, &spawns) || spawns > stream->max_live - kept) return PTC0_ERR_DATA;
+    uint32_t count = kept + spawns;
+
+    // Survivors close ranks; keep[j] >= j, so in place front to back is safe
+    if (kills > 0) {
+        for (int c = 0; c < PTC0_CHANNELS; c++) {
+            uint16_t* last = state->last[c];
+            uint16_t* before = state->before[c];
+            for (uint32_t j = 0; j < kept; j++) {
+                last[j] = last[state->keep[j]];
+                before[j] = before[state->keep[j]];
+            }
+        }
+    }
+
+    // Residuals against last + (last - before) for survivors, against 0 for new particles; all modulo 2^16
+    for (int c = 0; c < PTC0_CHANNELS; c++) {
+        uint16_t* last = state->last[c];
+        uint16_t* before = state->before[c];
+        for (uint32_t j = 0; j < count; j++) {
+            uint32_t zigzag;
+            if (!ptc0_read_varint(&p, end, &zigzag)) return PTC0_ERR_DATA;
+            int32_t residual = (int32_t)(zigzag >> 1) ^ -(int32_t)(zigzag & 1);
+            if (j < kept) {
+                int32_t predicted = 2 * (int32_t)last[j] - (int32_t)before[j];
+                before[j] = last[j];
+                last[j] = (uint16_t)(predicted + residual);
+            } else {
+                last[j] = before[j] = (uint16_t)residual;
+            }
+        }
+    }
+
+    *live = count;
+    return PTC0_OK;
+}
+
+// value = raw * scale + offset, four particles per step
+static void ptc0_dequantize(const uint16_t* raw, uint32_t count, float scale, float offset, float* out)
+{
+    for (uint32_t base = 0; base < count; base += 4) {
+        float q[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+        uint32_t lanes = count - base < 4 ? count - base : 4;
+        for (uint32_t l = 0; l < lanes; l++) q[l] = (float)raw[base + l];
+#if PTC0_SSE
+        _mm_storeu_ps(out + base, _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(q), _mm_set1_ps(scale)), _mm_set1_ps(offset)));
+#else
+        for (int l = 0; l < 4; l++) out[base + l] = q[l] * scale + offset;
+#endif
+    }
+}
+
+int ptc0_seek(ptc0_stream* stream, uint32_t frame)
+{
+    ptc0_state* state = (ptc0_state*)stream->storage;
+    if (!state || stream->frame_count == 0) return PTC0_ERR_DATA;
+    if (frame >= stream->frame_count) frame = stream->frame_count - 1;
+    if (frame == stream->frame) return PTC0_OK;
+
+    // Step forward from the decoded frame when no key frame lies between, otherwise restart at the key frame
+    uint32_t key = frame - frame % stream->key_interval;
+    uint32_t start = stream->frame != PTC0_NO_FRAME && stream->frame < frame && stream->frame >= key ? stream->frame + 1 : key;
+    uint32_t live = start == key ? 0 : stream->live;
+    stream->frame = PTC0_NO_FRAME;
+    stream->live = 0;
+    for (uint32_t f = start; f <= frame; f++) {
+        if (f == key) {
+            // Empty frames have no flag byte; decode rejects them, but the byte must not be read first
+            uint32_t offset = ptc0_read_u32(state->offsets + (size_t)f * 4);
+            if (offset >= ptc0_read_u32(state->offsets + (size_t)f * 4 + 4) || !(state->data[offset] & PTC0_FRAME_KEY))
+                return PTC0_ERR_DATA;
+        }
+        int result = ptc0_decode_frame(stream, state, f, &live);
+        if (result != PTC0_OK) return result;
+    }
+
+    float pos_scale[3];
+    for (int i = 0; i < 3; i++) {
+        // min >= max means every particle sat on the plane; the formula then gives min
+        pos_scale[i] = stream->bounds_max[i] > stream->bounds_min[i] ? (stream->bounds_max[i] - stream->bounds_min[i]) / 65535.0f : 0.0f;
+        ptc0_dequantize(state->last[PTC0_X + i], live, pos_scale[i], stream->bounds_min[i], state->out[i]);
+    }
+    ptc0_dequantize(state->last[PTC0_SIZE], live, stream->size_max / 65535.0f, 0.0f, state->out[3]);
+    for (int i = 0; i < 3; i++) ptc0_dequantize(state->last[PTC0_ROT_X + i], live, 2.0f * PTC0_PI / 65536.0f, 0.0f, state->out[4 + i]);
+
+    const uint16_t *r = state->last[PTC0_R], *g = state->last[PTC0_G], *b = state->last[PTC0_B], *a = state->last[PTC0_A];
+    for (uint32_t j = 0; j < live; j++)
+        state->color[j] = (uint32_t)(r[j] & 255) | (uint32_t)(g[j] & 255) << 8 | (uint32_t)(b[j] & 255) << 16 | (uint32_t)(a[j] & 255) << 24;
+
+    // Padding lanes stay finite for the SIMD expansion
+    size_t padded = ((size_t)live + 3) & ~(size_t)3;
+    for (int i = 0; i < 7; i++) memset(state->out[i] + live, 0, (padded - live) * sizeof(float));
+
+    stream->frame = frame;
+    stream->live = live;
+    return PTC0_OK;
+}
+
+int ptc0_seek_time(ptc0_stream* stream, double seconds)
+{
+    double frame = seconds * (double)stream->fps;
+    // Clamp (NaN lands on the first frame)
+    return ptc0_seek(stream, frame >= (double)stream->frame_count ? stream->frame_count : frame > 0.0 ? (uint32_t)frame : 0);
+}
+
+// The expansion is written once over ptc0_v: four particles per value with SSE, one without. Both evaluate the same
+// operations in the same order, so they give the same bits.
+#if PTC0_SSE
+#define PTC0_LANES 4
+typedef __m128 ptc0_v;
+#define PTC0_SET(s) _mm_set1_ps(s)
+#define PTC0_LOAD(p) _mm_loadu_ps(p)
+#define PTC0_STORE(p, v) _mm_storeu_ps(p, v)
+#define PTC0_ADD(a, b) _mm_add_ps(a, b)
+#define PTC0_SUB(a, b) _mm_sub_ps(a, b)
+#define PTC0_MUL(a, b) _mm_mul_ps(a, b)
+#define PTC0_DIV(a, b) _mm_div_ps(a, b)
+#define PTC0_SQRT(a) _mm_sqrt_ps(a)
+#define PTC0_NEG(a) _mm_sub_ps(_mm_setzero_ps(), a)
+#define PTC0_LT(a, b) _mm_cmplt_ps(a, b)
+#define PTC0_SELECT(m, a, b) _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b))
+typedef __m128 ptc0_mask;
+#else
+#define PTC0_LANES 1
+typedef float ptc0_v;
+#define PTC0_SET(s) (s)
+#define PTC0_LOAD(p) (*(p))
+#define PTC0_STORE(p, v) (*(p) = (v))
+#define PTC0_ADD(a, b) ((a) + (b))
+#define PTC0_SUB(a, b) ((a) - (b))
+#define PTC0_MUL(a, b) ((a) * (b))
+#define PTC0_DIV(a, b) ((a) / (b))
+#define PTC0_SQRT(a) sqrtf(a)
+#define PTC0_NEG(a) (0.0f - (a))
+#define PTC0_LT(a, b) ((a) < (b))
+#define PTC0_SELECT(m, a, b) ((m) ? (a) : (b))
+typedef int ptc0_mask;
+#endif
+
+// Corners for PTC0_LANES particles from index base: corner[k * 3 + axis], k in bottom-left, bottom-right, top-left,
+// top-right order. Works in Unity space (z = -exported z), like the RAT export did: the billboard is
+// Quaternion.LookRotation(particle - eye, up), the particle's Euler rotation applies after it, and the quad is the unit
+// quad scaled by size.
+static void ptc0_expand_lanes(const ptc0_instances* in, uint32_t base, const float* eye, float corner[12][PTC0_LANES])
+{
+    float sin_x[PTC0_LANES], cos_x[PTC0_LANES], sin_y[PTC0_LANES], cos_y[PTC0_LANES], sin_z[PTC0_LANES], cos_z[PTC0_LANES];
+    for (int l = 0; l < PTC0_LANES; l++) {
+        sin_x[l] = sinf(in->rot_x[base + l]);
+        cos_x[l] = cosf(in->rot_x[base + l]);
+        sin_y[l] = sinf(in->rot_y[base + l]);
+        cos_y[l] = cosf(in->rot_y[base + l]);
+        sin_z[l] = sinf(in->rot_z[base + l]);
+        cos_z[l] = cosf(in->rot_z[base + l]);
+    }
+    ptc0_v sx = PTC0_LOAD(sin_x), cx = PTC0_LOAD(cos_x), sy = PTC0_LOAD(sin_y), cy = PTC0_LOAD(cos_y);
+    ptc0_v sz = PTC0_LOAD(sin_z), cz = PTC0_LOAD(cos_z);
+
+    // First two columns of Ry * Rx * Rz (Unity's Euler order); the quad has no depth, so the third never matters
+    ptc0_v sxsz = PTC0_MUL(sx, sz), sxcz = PTC0_MUL(sx, cz);
+    ptc0_v r0[3] = {
+        PTC0_ADD(PTC0_MUL(cy, cz), PTC0_MUL(sy, sxsz)),
+        PTC0_MUL(cx, sz),
+        PTC0_SUB(PTC0_MUL(cy, sxsz), PTC0_MUL(sy, cz)),
+    };
+    ptc0_v r1[3] = {
+        PTC0_SUB(PTC0_MUL(sy, sxcz), PTC0_MUL(cy, sz)),
+        PTC0_MUL(cx, cz),
+        PTC0_ADD(PTC0_MUL(sy, sz), PTC0_MUL(cy, sxcz)),
+    };
+
+    ptc0_v px = PTC0_LOAD(in->x + base), py = PTC0_LOAD(in->y + base);
+    ptc0_v pz = PTC0_NEG(PTC0_LOAD(in->z + base));
+    ptc0_v m0[3], m1[3];
+    if (eye) {
+        ptc0_v one = PTC0_SET(1.0f), zero = PTC0_SET(0.0f);
+        ptc0_v dx = PTC0_SUB(px, PTC0_SET(eye[0]));
+        ptc0_v dy = PTC0_SUB(py, PTC0_SET(eye[1]));
+        ptc0_v dz = PTC0_SUB(pz, PTC0_SET(-eye[2]));
+        ptc0_v d2 = PTC0_ADD(PTC0_ADD(PTC0_MUL(dx, dx), PTC0_MUL(dy, dy)), PTC0_MUL(dz, dz));
+
+        // A particle on the eye looks down +z, as the RAT export did
+        ptc0_mask close = PTC0_LT(d2, PTC0_SET(0.0001f));
+        dx = PTC0_SELECT(close, zero, dx);
+        dy = PTC0_SELECT(close, zero, dy);
+        dz = PTC0_SELECT(close, one, dz);
+        d2 = PTC0_SELECT(close, one, d2);
+        ptc0_v inv = PTC0_DIV(one, PTC0_SQRT(d2));
+        ptc0_v f[3] = { PTC0_MUL(dx, inv), PTC0_MUL(dy, inv), PTC0_MUL(dz, inv) };
+
+        // Right = normalize(cross(up, forward)); straight up or down it falls back to +x
+        ptc0_v h2 = PTC0_ADD(PTC0_MUL(f[2], f[2]), PTC0_MUL(f[0], f[0]));
+        ptc0_mask vertical = PTC0_LT(h2, PTC0_SET(1e-12f));
+        ptc0_v hinv = PTC0_DIV(one, PTC0_SQRT(PTC0_SELECT(vertical, one, h2)));
+        ptc0_v right_x = PTC0_SELECT(vertical, one, PTC0_MUL(f[2], hinv));
+        ptc0_v right_z = PTC0_SELECT(vertical, zero, PTC0_NEG(PTC0_MUL(f[0], hinv)));
+
+        // Up = cross(forward, right), right.y being 0
+        ptc0_v up[3] = {
+            PTC0_MUL(f[1], right_z),
+            PTC0_SUB(PTC0_MUL(f[2], right_x), PTC0_MUL(f[0], right_z)),
+            PTC0_NEG(PTC0_MUL(f[1], right_x)),
+        };
+        ptc0_v right[3] = { right_x, zero, right_z };
+        for (int i = 0; i < 3; i++) {
+            m0[i] = PTC0_ADD(PTC0_ADD(PTC0_MUL(right[i], r0[0]), PTC0_MUL(up[i], r0[1])), PTC0_MUL(f[i], r0[2]));
+            m1[i] = PTC0_ADD(PTC0_ADD(PTC0_MUL(right[i], r1[0]), PTC0_MUL(up[i], r1[1])), PTC0_MUL(f[i], r1[2]));
+        }
+    } else {
+        for (int i = 0; i < 3; i++) {
+            m0[i] = r0[i];
+            m1[i] = r1[i];
+        }
+    }
+
+    // Half extents along the quad's two axes, back in exported space
+    ptc0_v half = PTC0_MUL(PTC0_LOAD(in->size + base), PTC0_SET(0.5f));
+    ptc0_v u[3] = { PTC0_MUL(m0[0], half), PTC0_MUL(m0[1], half), PTC0_NEG(PTC0_MUL(m0[2], half)) };
+    ptc0_v v[3] = { PTC0_MUL(m1[0], half), PTC0_MUL(m1[1], half), PTC0_NEG(PTC0_MUL(m1[2], half)) };
+    ptc0_v p[3] = { px, py, PTC0_NEG(pz) };
+    for (int i = 0; i < 3; i++) {
+        ptc0_v left = PTC0_SUB(p[i], u[i]), right = PTC0_ADD(p[i], u[i]);
+        PTC0_STORE(corner[0 * 3 + i], PTC0_SUB(left, v[i]));
+        PTC0_STORE(corner[1 * 3 + i], PTC0_SUB(right, v[i]));
+        PTC0_STORE(corner[2 * 3 + i], PTC0_ADD(left, v[i]));
+        PTC0_STORE(corner[3 * 3 + i], PTC0_ADD(right, v[i]));
+    }
+}
+
+void ptc0_expand_instances(const ptc0_instances* instances, const float eye[3], float* xyz, uint32_t* rgba)
+{
+    for (uint32_t base = 0; base < instances->count; base += PTC0_LANES) {
+        float corner[12][PTC0_LANES];
+        ptc0_expand_lanes(instances, base, eye, corner);
+
+        // Transpose to one xyz per vertex
+        uint32_t lanes = instances->count - base < PTC0_LANES ? instances->count - base : PTC0_LANES;
+        for (uint32_t l = 0; l < lanes; l++) {
+            float* out = xyz + (size_t)(base + l) * 12;
+            for (int k = 0; k < 12; k++) out[k] = corner[k][l];
+        }
+    }
+
+    if (rgba) {
+        for (uint32_t i = 0; i < instances->count; i++) {
+            uint32_t c = instances->color[i];
+            rgba[i * 4 + 0] = rgba[i * 4 + 1] = rgba[i * 4 + 2] = rgba[i * 4 + 3] = c;
+        }
+    }
+}
+
+void ptc0_expand(const ptc0_stream* stream, const float eye[3], float* xyz, uint32_t* rgba)
+{
+    if (!(stream->flags & PTC0_FLAG_BILLBOARD)) eye = NULL;
+    else if (!eye && stream->has_camera) eye = stream->camera;
+
+    ptc0_instances instances = {
+        stream->live, stream->x, stream->y, stream->z, stream->size, stream->rot_x, stream->rot_y, stream->rot_z, stream->color
+    };
+    ptc0_expand_instances(&instances, eye, xyz, rgba);
+}
+
+void ptc0_quad_indices(uint16_t* indices, uint32_t quads)
+{
+    for (uint32_t q = 0; q < quads; q++) {
+        uint16_t v = (uint16_t)(q * 4);
+        uint16_t* out = indices + (size_t)q * 6;
+        out[0] = v;
+        out[1] = (uint16_t)(v + 1);
+        out[2] = (uint16_t)(v + 2);
+        out[3] = (uint16_t)(v + 2);
+        out[4] = (uint16_t)(v + 1);
+        out[5] = (uint16_t)(v + 3);
+    }
+}
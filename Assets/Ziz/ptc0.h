@@ -0,0 +1,93 @@
+#ifndef PTC0_H
+#define PTC0_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Reader for PTC0 particle instance streams written by SDFParticleRecorder (ParticleStream.Write).
+//
+//   ptc0_stream stream;
+//   ptc0_load(&stream, "sparks.ptc");
+//   ptc0_seek_time(&stream, seconds);
+//   ptc0_expand(&stream, eye, xyz, rgba);          // stream.live quads, 4 vertices each
+//   draw stream.live * 2 triangles with indices from ptc0_quad_indices and stream.texture
+//
+// A frame holds only the particles alive in it, in a stable order: survivors keep their place, new particles are
+// appended. Each of the eleven quantized channels (position, size, Euler rotation, color) is stored as the residual
+// from a linear prediction along the particle's own history, so steady motion and fades cost a byte per channel.
+// Every key_interval-th frame restarts the prediction, and seeking decodes forward from the nearest one; stepping to
+// the next frame decodes just that frame. Either way the cost is in live particles, not in the system's capacity.
+//
+// Positions and the recorded camera are in exported space (Z mirrored, like CAM0 and EMU levels). Quads are built at
+// expansion time, four at a time with SSE where available, facing whatever eye the caller passes.
+
+#define PTC0_MAGIC 0x50544330u
+
+#define PTC0_FLAG_BILLBOARD 1u     // quads face the eye; otherwise they are only rotated
+
+#define PTC0_NO_FRAME 0xFFFFFFFFu
+
+// Particles to expand into quads: SoA arrays readable in whole blocks of four past count (zeros are fine)
+typedef struct ptc0_instances {
+    uint32_t count;
+    const float *x, *y, *z;      // exported space
+    const float* size;
+    const float *rot_x, *rot_y, *rot_z;    // radians, Unity Euler order (Z, then X, then Y)
+    const uint32_t* color;       // RGBA8888, r in the low byte
+} ptc0_instances;
+
+typedef struct ptc0_stream {
+    uint32_t version;
+    uint32_t flags;
+    uint32_t frame_count;
+    uint32_t max_live;           // most particles alive in any frame
+    uint32_t key_interval;
+    float fps;
+    float bounds_min[3], bounds_max[3];
+    float size_max;
+    char texture[256];           // file name, next to the stream
+
+    // The decoded frame; PTC0_NO_FRAME until the first seek
+    uint32_t frame;
+    uint32_t live;
+    int has_camera;
+    float camera[3];
+    const float *x, *y, *z;      // SoA over the live particles, padded to whole SIMD blocks
+    const float* size;
+    const float *rot_x, *rot_y, *rot_z;    // radians, Unity Euler order (Z, then X, then Y)
+    const uint32_t* color;       // RGBA8888, r in the low byte
+
+    void* storage;               // one allocation behind everything above and the stream bytes
+} ptc0_stream;
+
+enum {
+    PTC0_OK = 0,
+    PTC0_ERR_IO = -1,
+    PTC0_ERR_HEADER = -2,
+    PTC0_ERR_MEMORY = -3,
+    PTC0_ERR_DATA = -4           // a frame runs past its end or names particles that don't exist
+};
+
+// Validates a PTC0 image in memory and keeps a copy of it; data is not referenced afterwards.
+int ptc0_bind(ptc0_stream* stream, const void* data, size_t size);
+
+// Maps path read-only and binds it.
+int ptc0_load(ptc0_stream* stream, const char* path);
+void ptc0_free(ptc0_stream* stream);
+
+// Decodes frame (clamped to the stream). On error no frame is decoded and live is 0.
+int ptc0_seek(ptc0_stream* stream, uint32_t frame);
+int ptc0_seek_time(ptc0_stream* stream, double seconds);
+
+// Four corners per live particle, bottom-left, bottom-right, top-left, top-right, as xyz floats (12 per particle);
+// rgba, if not NULL, gets the particle's color once per corner. With PTC0_FLAG_BILLBOARD quads face eye, or the
+// frame's recorded camera if eye is NULL; without either they keep the orientation of their rotation alone.
+void ptc0_expand(const ptc0_stream* stream, const float eye[3], float* xyz, uint32_t* rgba);
+
+// The same for any particle source (psim emitters, for one): quads face eye, or keep their rotation alone if NULL
+void ptc0_expand_instances(const ptc0_instances* instances, const float eye[3], float* xyz, uint32_t* rgba);
+
+// Two triangles per quad, (0, 1, 2) and (2, 1, 3), counter-clockwise for the corner order above
+void ptc0_quad_indices(uint16_t* indices, uint32_t quads);
+
+#endif
@@ -0,0 +1,231 @@
+#include "scne.h"
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static int scne_table_ok(size_t size, uint32_t offset, uint64_t bytes)
+{
+    return offset % 4 == 0 && (uint64_t)offset + bytes <= size;
+}
+
+int scne_bind(scne_scene* scene, const void* data, size_t size)
+{
+    const uint8_t* base = (const uint8_t*)data;
+    const scne_header* h = (const scne_header*)data;
+
+    memset(scene, 0, sizeof(*scene));
+
+    if (size < sizeof(scne_header) || ((uintptr_t)data & 3) != 0) return SCNE_ERR_HEADER;
+    if (h->magic != SCNE_MAGIC || h->version != SCNE_VERSION) return SCNE_ERR_HEADER;
+    if (h->mask_words != (uint32_t)(((uint64_t)h->num_components + 31) / 32)) return SCNE_ERR_HEADER;
+
+    uint32_t stride = 1 + h->mask_words;
+    if (h->keyframes_offset < sizeof(scne_header) + (uint64_t)h->num_components * SCNE_COMPONENT_SIZE) return SCNE_ERR_HEADER;
+    if (!scne_table_ok(size, h->keyframes_offset, (uint64_t)h->num_keyframes * sizeof(scne_keyframe))) return SCNE_ERR_HEADER;
+    if (!scne_table_ok(size, h->events_offset, (uint64_t)h->num_events * 4)) return SCNE_ERR_HEADER;
+    if (!scne_table_ok(size, h->snapshots_offset, (uint64_t)h->num_snapshots * stride * 4)) return SCNE_ERR_HEADER;
+
+    const scne_keyframe* keyframes = (const scne_keyframe*)(base + h->keyframes_offset);
+    const uint32_t* events = (const uint32_t*)(base + h->events_offset);
+    const uint32_t* snapshots = (const uint32_t*)(base + h->snapshots_offset);
+
+    // Queries trust these: ascending keyframes and snapshots, events that stay inside the mask
+    for (uint32_t k = 0; k < h->num_keyframes; k++) {
+        if (keyframes[k].first_event > h->num_events) return SCNE_ERR_DATA;
+        if (k > 0 && !(keyframes[k].timestamp >= keyframes[k - 1].timestamp)) return SCNE_ERR_DATA;
+        if (k > 0 && keyframes[k].first_event < keyframes[k - 1].first_event) return SCNE_ERR_DATA;
+    }
+    for (uint32_t e = 0; e < h->num_events; e++)
+        if ((events[e] & SCNE_EVENT_INDEX) >= h->num_components) return SCNE_ERR_DATA;
+    if (h->num_keyframes > 0 && (h->num_snapshots == 0 || snapshots[0] != 0)) return SCNE_ERR_DATA;
+    for (uint32_t s = 0; s < h->num_snapshots; s++) {
+        uint32_t keyframe = snapshots[(size_t)s * stride];
+        if (keyframe >= h->num_keyframes) return SCNE_ERR_DATA;
+        if (s > 0 && keyframe <= snapshots[(size_t)(s - 1) * stride]) return SCNE_ERR_DATA;
+    }
+
+    scene->header = h;
+    scene->components = base + sizeof(scne_header);
+    scene->keyframes = keyframes;
+    scene->events = events;
+    scene->snapshots = snapshots;
+    scene->snapshot_stride = stride;
+    return SCNE_OK;
+}
+
+int scne_map(scne_scene* scene, const char* path)
+{
+    memset(scene, 0, sizeof(*scene));
+#if defined(_WIN32)
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) return SCNE_ERR_IO;
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size)) { CloseHandle(file); return SCNE_ERR_IO; }
+    HANDLE section = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(file);
+    if (!section) return SCNE_ERR_IO;
+    void* data = MapViewOfFile(section, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(section);
+    if (!data) return SCNE_ERR_IO;
+    size_t length = (size_t)size.QuadPart;
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return SCNE_ERR_IO;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) { close(fd); return SCNE_ERR_IO; }
+    void* data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) return SCNE_ERR_IO;
+    size_t length = (size_t)st.st_size;
+#endif
+
+    int result = scne_bind(scene, data, length);
+    scene->mapping = data;
+    scene->mapping_size = length;
+    if (result != SCNE_OK) scne_unmap(scene);
+    return result;
+}
+
+void scne_unmap(scne_scene* scene)
+{
+    if (scene->mapping) {
+#if defined(_WIN32)
+        UnmapViewOfFile(scene->mapping);
+#else
+        munmap(scene->mapping, scene->mapping_size);
+#endif
+    }
+    memset(scene, 0, sizeof(*scene));
+}
+
+void scne_get_component(const scne_scene* scene, uint32_t index, scne_component* component)
+{
+    const uint8_t* entry = scene->components + (size_t)index * SCNE_COMPONENT_SIZE;
+    component->type = entry[0];
+    component->id = (uint16_t)(entry[1] | entry[2] << 8);
+    memcpy(component->name, entry + 3, 64);
+    component->name[64] = '\0';
+    memcpy(component->path, entry + 67, 256);
+    component->path[256] = '\0';
+}
+
+int32_t scne_keyframe_at(const scne_scene* scene, float t)
+{
+    // Upper bound: first keyframe with timestamp > t
+    uint32_t lo = 0, hi = scene->header->num_keyframes;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (scene->keyframes[mid].timestamp <= t) lo = mid + 1;
+        else hi = mid;
+    }
+    return (int32_t)lo - 1;
+}
+
+// Index one past the last event of keyframe k (0 for k = -1)
+static uint32_t scne_event_end(const scne_scene* scene, int32_t k)
+{
+    if (k < 0) return 0;
+    uint32_t next = (uint32_t)k + 1;
+    return next < scene->header->num_keyframes ? scene->keyframes[next].first_event : scene->header->num_events;
+}
+
+// Last snapshot taken at or before keyframe k (k >= 0; snapshot 0 is keyframe 0)
+static const uint32_t* scne_snapshot_for(const scne_scene* scene, int32_t k)
+{
+    uint32_t lo = 0, hi = scene->header->num_snapshots;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (scene->snapshots[(size_t)mid * scene->snapshot_stride] <= (uint32_t)k) lo = mid + 1;
+        else hi = mid;
+    }
+    return scene->snapshots + (size_t)(lo - 1) * scene->snapshot_stride;
+}
+
+static void scne_apply(const uint32_t* events, uint32_t from, uint32_t to, uint32_t* mask)
+{
+    for (uint32_t e = from; e < to; e++) {
+        uint32_t index = events[e] & SCNE_EVENT_INDEX;
+        uint32_t bit = 1u << (index & 31);
+        if (events[e] & SCNE_EVENT_ACTIVATE) mask[index >> 5] |= bit;
+        else mask[index >> 5] &= ~bit;
+    }
+}
+
+// Inverse of scne_apply: every event flipped its bit, so walking back flips it again
+static void scne_undo(const uint32_t* events, uint32_t from, uint32_t to, uint32_t* mask)
+{
+    for (uint32_t e = to; e > from; e--) {
+        uint32_t index = events[e - 1] & SCNE_EVENT_INDEX;
+        uint32_t bit = 1u << (index & 31);
+        if (events[e - 1] & SCNE_EVENT_ACTIVATE) mask[index >> 5] &= ~bit;
+        else mask[index >> 5] |= bit;
+    }
+}
+
+// Resets mask to the state at keyframe k from scratch. Returns the first event still to apply.
+static uint32_t scne_restart(const scne_scene* scene, int32_t k, uint32_t* mask)
+{
+    uint32_t words = scene->header->mask_words;
+    if (k < 0) {
+        memset(mask, 0, (size_t)words * 4);
+        return 0;
+    }
+    const uint32_t* snapshot = scne_snapshot_for(scene, k);
+    memcpy(mask, snapshot + 1, (size_t)words * 4);
+    return scne_event_end(scene, (int32_t)snapshot[0]);
+}
+
+void scne_active_at(const scne_scene* scene, float t, uint32_t* mask)
+{
+    int32_t k = scne_keyframe_at(scene, t);
+    uint32_t from = scne_restart(scene, k, mask);
+    scne_apply(scene->events, from, scne_event_end(scene, k), mask);
+}
+
+int scne_cursor_init(scne_cursor* cursor, const scne_scene* scene)
+{
+    cursor->scene = scene;
+    cursor->keyframe = -1;
+    cursor->mask = (uint32_t*)calloc(scene->header->mask_words ? scene->header->mask_words : 1, 4);
+    return cursor->mask ? SCNE_OK : SCNE_ERR_MEMORY;
+}
+
+void scne_cursor_free(scne_cursor* cursor)
+{
+    free(cursor->mask);
+    memset(cursor, 0, sizeof(*cursor));
+}
+
+uint32_t scne_cursor_seek(scne_cursor* cursor, float t)
+{
+    const scne_scene* scene = cursor->scene;
+    int32_t target = scne_keyframe_at(scene, t);
+    if (target == cursor->keyframe) return 0;
+
+    uint32_t here = scne_event_end(scene, cursor->keyframe);
+    uint32_t there = scne_event_end(scene, target);
+    uint32_t step = here <= there ? there - here : here - there;
+
+    // Restarting costs a bitset copy plus the replay from the snapshot
+    uint32_t from = 0;
+    if (target >= 0) from = scne_event_end(scene, (int32_t)scne_snapshot_for(scene, target)[0]);
+    uint32_t restart = scene->header->mask_words + (there - from);
+
+    cursor->keyframe = target;
+    if (step <= restart) {
+        if (here <= there) scne_apply(scene->events, here, there, cursor->mask);
+        else scne_undo(scene->events, there, here, cursor->mask);
+        return step;
+    }
+    from = scne_restart(scene, target, cursor->mask);
+    scne_apply(scene->events, from, there, cursor->mask);
+    return there - from;
+}
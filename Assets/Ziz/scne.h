@@ -0,0 +1,123 @@
+#ifndef SCNE_H
+#define SCNE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// SCNE v2 scene timelines written by SceneController: which components (cameras, actors, levels, shapes) are active
+// at each point in time.
+//
+// [scne_header][component entries, 323 bytes each][pad to 4][keyframes][events][snapshots]
+//
+// A keyframe lists only the components that changed since the previous keyframe (events). Every so many events the
+// writer also stores the full bitset (a snapshot), so the state at any time t is a binary search for the keyframe, a
+// binary search for the snapshot at or before it, and a replay of the events in between -- bounded by the writer's
+// snapshot_interval, whatever the component count.
+//
+//   scne_scene scene;
+//   scne_map(&scene, "scene.scn");
+//   uint32_t* mask = calloc(scene.header->mask_words, 4);
+//   scne_active_at(&scene, t, mask);                 // random access
+//
+//   scne_cursor cursor;                              // playback: only the changes since the last call
+//   scne_cursor_init(&cursor, &scene);
+//   scne_cursor_seek(&cursor, t);                    // cursor.mask is the active set at t
+
+#define SCNE_MAGIC   0x454E4353u
+#define SCNE_VERSION 2u
+
+#define SCNE_COMPONENT_SIZE 323    // uint8 type, uint16 id, char name[64], char path[256]; packed
+#define SCNE_EVENT_ACTIVATE 0x80000000u
+#define SCNE_EVENT_INDEX    0x7FFFFFFFu
+
+enum {
+    SCNE_COMPONENT_CAMERA = 0,
+    SCNE_COMPONENT_ACTOR = 1,
+    SCNE_COMPONENT_LEVEL = 2,
+    SCNE_COMPONENT_SHAPE = 3
+};
+
+typedef struct scne_header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t num_components;
+    uint32_t num_keyframes;
+    float framerate;
+    uint32_t keyframes_offset;
+    uint32_t mask_words;          // (num_components + 31) / 32; component i is bit i % 32 of word i / 32
+    uint32_t num_events;
+    uint32_t num_snapshots;
+    uint32_t snapshot_interval;   // writer setting, informational
+    uint32_t events_offset;
+    uint32_t snapshots_offset;
+    float duration;
+    uint8_t reserved[12];
+} scne_header;
+
+typedef struct scne_keyframe {
+    float timestamp;              // ascending
+    uint32_t first_event;         // events run to the next keyframe's first_event, num_events for the last
+} scne_keyframe;
+
+typedef struct scne_component {
+    uint8_t type;
+    uint16_t id;
+    char name[65];
+    char path[257];
+} scne_component;
+
+typedef struct scne_scene {
+    const scne_header* header;
+    const uint8_t* components;
+    const scne_keyframe* keyframes;
+    const uint32_t* events;       // component index | SCNE_EVENT_ACTIVATE when it turned on
+    const uint32_t* snapshots;    // snapshot_stride words each: keyframe index, then mask_words words
+    uint32_t snapshot_stride;
+
+    void* mapping;                // set by scne_map, NULL for scne_bind
+    size_t mapping_size;
+} scne_scene;
+
+typedef struct scne_cursor {
+    const scne_scene* scene;
+    int32_t keyframe;             // last keyframe applied, -1 before the first
+    uint32_t* mask;               // mask_words words
+} scne_cursor;
+
+enum {
+    SCNE_OK = 0,
+    SCNE_ERR_IO = -1,
+    SCNE_ERR_HEADER = -2,
+    SCNE_ERR_DATA = -3,
+    SCNE_ERR_MEMORY = -4
+};
+
+// Points scene at a v2 image already in memory (4-byte aligned) that the caller keeps alive. Validates the tables
+// (offsets, event indices, snapshot order) once so queries can trust them.
+int scne_bind(scne_scene* scene, const void* data, size_t size);
+
+int scne_map(scne_scene* scene, const char* path);
+void scne_unmap(scne_scene* scene);
+
+// Copies component i's entry out of the packed table, with NUL-terminated strings.
+void scne_get_component(const scne_scene* scene, uint32_t index, scne_component* component);
+
+// Last keyframe with timestamp <= t, or -1 when t is before the first keyframe (nothing is active then).
+int32_t scne_keyframe_at(const scne_scene* scene, float t);
+
+// Fills mask (mask_words words) with the active set at time t.
+void scne_active_at(const scne_scene* scene, float t, uint32_t* mask);
+
+int scne_cursor_init(scne_cursor* cursor, const scne_scene* scene);
+void scne_cursor_free(scne_cursor* cursor);
+
+// Moves the cursor to time t, forwards or backwards. Nearby moves replay (or undo) only the events in between; far
+// moves restart from the nearest snapshot, whichever touches fewer words. Returns the number of events applied.
+uint32_t scne_cursor_seek(scne_cursor* cursor, float t);
+
+static inline int scne_is_active(const uint32_t* mask, uint32_t component)
+{
+    return (mask[component >> 5] >> (component & 31)) & 1u;
+}
+
+#endif
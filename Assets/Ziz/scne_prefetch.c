@@ -0,0 +1,428 @@
+#include "scne_prefetch.h"
+#include <float.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+#define SCNE_ACT_MAGIC 0x52544341u  // "ACTR"
+#define SCNE_ACT_HEADER_SIZE 56
+#define SCNE_PTC_MAGIC 0x50544330u  // "PTC0"
+#define SCNE_PTC_HEADER_SIZE 60
+
+enum {
+    SCNE_ASSET_NONE,      // no path (yet)
+    SCNE_ASSET_IDLE,
+    SCNE_ASSET_QUEUED,
+    SCNE_ASSET_LOADING,
+    SCNE_ASSET_READY,
+    SCNE_ASSET_FAILED
+};
+
+struct scne_asset {
+    char path[SCNE_PREFETCH_MAX_PATH];
+    int state;
+    uint8_t* data;
+    size_t size;          // known once the file was opened, even if the read was deferred
+    float need;
+};
+
+struct scne_prefetch_sync {
+#if defined(_WIN32)
+    HANDLE thread;
+    CRITICAL_SECTION lock;
+    CONDITION_VARIABLE wake;
+#else
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+#endif
+    int quit;
+};
+
+#if defined(_WIN32)
+static void scne_lock(scne_prefetch_sync* s) { EnterCriticalSection(&s->lock); }
+static void scne_unlock(scne_prefetch_sync* s) { LeaveCriticalSection(&s->lock); }
+static void scne_wait(scne_prefetch_sync* s) { SleepConditionVariableCS(&s->wake, &s->lock, INFINITE); }
+static void scne_signal(scne_prefetch_sync* s) { WakeConditionVariable(&s->wake); }
+#else
+static void scne_lock(scne_prefetch_sync* s) { pthread_mutex_lock(&s->lock); }
+static void scne_unlock(scne_prefetch_sync* s) { pthread_mutex_unlock(&s->lock); }
+static void scne_wait(scne_prefetch_sync* s) { pthread_cond_wait(&s->wake, &s->lock); }
+static void scne_signal(scne_prefetch_sync* s) { pthread_cond_signal(&s->wake); }
+#endif
+
+static uint32_t scne_read_u32(const uint8_t* p) { return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24; }
+
+// dir + "/" + name, truncated to the path buffer; dir may be empty
+static void scne_join(char out[SCNE_PREFETCH_MAX_PATH], const char* dir, size_t dir_length, const char* name, size_t name_length)
+{
+    size_t n = 0;
+    if (dir_length > 0) {
+        n = dir_length < SCNE_PREFETCH_MAX_PATH - 1 ? dir_length : SCNE_PREFETCH_MAX_PATH - 1;
+        memcpy(out, dir, n);
+        if (n < SCNE_PREFETCH_MAX_PATH - 1 && out[n - 1] != '/' && out[n - 1] != '\\') out[n++] = '/';
+    }
+    size_t room = SCNE_PREFETCH_MAX_PATH - 1 - n;
+    if (name_length > room) name_length = room;
+    memcpy(out + n, name, name_length);
+    out[n + name_length] = '\0';
+}
+
+static size_t scne_dir_length(const char* path)
+{
+    size_t length = 0;
+    for (size_t i = 0; path[i]; i++)
+        if (path[i] == '/' || path[i] == '\\') length = i;
+    return length;
+}
+
+// An ACT names its first RAT chunk and its texture, a PTC0 particle stream just its texture; all live next to it
+static void scne_discover_act_assets(scne_asset* act, scne_asset* rat, scne_asset* texture)
+{
+    const uint8_t* p = act->data;
+    size_t dir = scne_dir_length(act->path);
+
+    if (act->size >= SCNE_PTC_HEADER_SIZE && scne_read_u32(p) == SCNE_PTC_MAGIC) {
+        uint32_t length = scne_read_u32(p + 56);
+        if (length > 0 && texture->state == SCNE_ASSET_NONE && (uint64_t)SCNE_PTC_HEADER_SIZE + length <= act->size) {
+            scne_join(texture->path, act->path, dir, (const char*)p + SCNE_PTC_HEADER_SIZE, length);
+            texture->state = SCNE_ASSET_IDLE;
+        }
+        return;
+    }
+    if (act->size < SCNE_ACT_HEADER_SIZE || scne_read_u32(p) != SCNE_ACT_MAGIC) return;
+
+    uint32_t rat_count = scne_read_u32(p + 8), names_length = scne_read_u32(p + 12);
+    if (rat_count > 0 && rat->state == SCNE_ASSET_NONE && (uint64_t)SCNE_ACT_HEADER_SIZE + names_length <= act->size) {
+        const char* name = (const char*)p + SCNE_ACT_HEADER_SIZE;
+        size_t length = 0;
+        while (length < names_length && name[length]) length++;
+        if (length > 0) {
+            scne_join(rat->path, act->path, dir, name, length);
+            rat->state = SCNE_ASSET_IDLE;
+        }
+    }
+
+    uint32_t texture_offset = scne_read_u32(p + 40), texture_length = scne_read_u32(p + 44);
+    if (texture_length > 0 && texture->state == SCNE_ASSET_NONE && (uint64_t)texture_offset + texture_length <= act->size) {
+        scne_join(texture->path, act->path, dir, (const char*)p + texture_offset, texture_length);
+        texture->state = SCNE_ASSET_IDLE;
+    }
+}
+
+static FILE* scne_open(const char* path, size_t* size)
+{
+    FILE* file = fopen(path, "rb");
+    if (!file) return NULL;
+    long length = -1;
+    if (fseek(file, 0, SEEK_END) == 0) length = ftell(file);
+    if (length < 0 || fseek(file, 0, SEEK_SET) != 0) { fclose(file); return NULL; }
+    *size = (size_t)length;
+    return file;
+}
+
+static void scne_prefetch_worker(scne_prefetch* pf)
+{
+    scne_prefetch_sync* sync = pf->sync;
+    uint32_t asset_count = pf->scene->header->num_components * SCNE_ASSET_KINDS;
+    char path[SCNE_PREFETCH_MAX_PATH];
+
+    scne_lock(sync);
+    while (!sync->quit) {
+        // Most urgent queued asset first
+        scne_asset* next = NULL;
+        for (uint32_t i = 0; i < asset_count; i++) {
+            scne_asset* a = &pf->assets[i];
+            if (a->state == SCNE_ASSET_QUEUED && (!next || a->need < next->need)) next = a;
+        }
+        if (!next) {
+            scne_wait(sync);
+            continue;
+        }
+        next->state = SCNE_ASSET_LOADING;
+        memcpy(path, next->path, sizeof(path));
+        scne_unlock(sync);
+
+        size_t size = 0;
+        FILE* file = scne_open(path, &size);
+
+        scne_lock(sync);
+        if (!file) {
+            next->state = SCNE_ASSET_FAILED;
+            pf->stats.failures++;
+            continue;
+        }
+        if (pf->stats.resident_bytes + size > pf->budget) {
+            // The main thread evicts and requeues once the size fits
+            next->size = size;
+            next->state = SCNE_ASSET_IDLE;
+            pf->stats.deferred++;
+            scne_unlock(sync);
+            fclose(file);
+            scne_lock(sync);
+            continue;
+        }
+        pf->stats.resident_bytes += size;
+        if (pf->stats.resident_bytes > pf->stats.peak_bytes) pf->stats.peak_bytes = pf->stats.resident_bytes;
+        scne_unlock(sync);
+
+        uint8_t* data = (uint8_t*)malloc(size ? size : 1);
+        int ok = data && fread(data, 1, size, file) == size;
+        fclose(file);
+
+        scne_lock(sync);
+        if (!ok) {
+            free(data);
+            pf->stats.resident_bytes -= size;
+            next->state = SCNE_ASSET_FAILED;
+            pf->stats.failures++;
+            continue;
+        }
+        next->data = data;
+        next->size = size;
+        next->state = SCNE_ASSET_READY;
+        pf->stats.loads++;
+        pf->stats.bytes_read += size;
+
+        uint32_t index = (uint32_t)(next - pf->assets);
+        if (index % SCNE_ASSET_KINDS == SCNE_ASSET_PRIMARY) {
+            scne_asset* owner = &pf->assets[index];
+            scne_discover_act_assets(owner, owner + SCNE_ASSET_FIRST_RAT, owner + SCNE_ASSET_TEXTURE);
+            // Children inherit the owner's urgency and are picked up on this pass, not the next update
+            for (int k = SCNE_ASSET_FIRST_RAT; k < SCNE_ASSET_KINDS; k++)
+                if (owner[k].state == SCNE_ASSET_IDLE && owner->need <= pf->lookahead) {
+                    owner[k].need = owner->need;
+                    owner[k].state = SCNE_ASSET_QUEUED;
+                }
+        }
+    }
+    scne_unlock(sync);
+}
+
+#if defined(_WIN32)
+static DWORD WINAPI scne_prefetch_thread(LPVOID arg) { scne_prefetch_worker((scne_prefetch*)arg); return 0; }
+#else
+static void* scne_prefetch_thread(void* arg) { scne_prefetch_worker((scne_prefetch*)arg); return NULL; }
+#endif
+
+int scne_prefetch_init(scne_prefetch* pf, const scne_scene* scene, const char* base_dir, size_t budget_bytes,
+                       float lookahead_seconds)
+{
+    const scne_header* h = scene->header;
+    uint32_t components = h->num_components;
+
+    memset(pf, 0, sizeof(*pf));
+    pf->scene = scene;
+    pf->budget = budget_bytes;
+    pf->lookahead = lookahead_seconds > 0.0f ? lookahead_seconds : 0.0f;
+    scne_join(pf->base_dir, "", 0, base_dir ? base_dir : "", base_dir ? strlen(base_dir) : 0);
+
+    pf->assets = (scne_asset*)calloc((size_t)components * SCNE_ASSET_KINDS + 1, sizeof(scne_asset));
+    pf->activation_start = (uint32_t*)calloc((size_t)components + 1, sizeof(uint32_t));
+    pf->need = (float*)calloc((size_t)components + 1, sizeof(float));
+    pf->was_active = (uint32_t*)calloc((size_t)h->mask_words + 1, sizeof(uint32_t));
+    pf->sync = (scne_prefetch_sync*)calloc(1, sizeof(scne_prefetch_sync));
+    if (!pf->assets || !pf->activation_start || !pf->need || !pf->was_active || !pf->sync ||
+        scne_cursor_init(&pf->cursor, scene) != SCNE_OK) {
+        scne_prefetch_free(pf);
+        return SCNE_ERR_MEMORY;
+    }
+
+    // Activation times per component (counting sort over the events), for "when is this needed next"
+    uint32_t activations = 0;
+    for (uint32_t e = 0; e < h->num_events; e++)
+        if (scene->events[e] & SCNE_EVENT_ACTIVATE) {
+            pf->activation_start[(scene->events[e] & SCNE_EVENT_INDEX) + 1]++;
+            activations++;
+        }
+    for (uint32_t c = 0; c < components; c++) pf->activation_start[c + 1] += pf->activation_start[c];
+    pf->activation_times = (float*)malloc(sizeof(float) * (activations ? activations : 1));
+    uint32_t* fill = (uint32_t*)malloc(sizeof(uint32_t) * (components ? components : 1));
+    if (!pf->activation_times || !fill) {
+        free(fill);
+        scne_prefetch_free(pf);
+        return SCNE_ERR_MEMORY;
+    }
+    memcpy(fill, pf->activation_start, sizeof(uint32_t) * components);
+    for (uint32_t k = 0; k < h->num_keyframes; k++) {
+        uint32_t end = k + 1 < h->num_keyframes ? scene->keyframes[k + 1].first_event : h->num_events;
+        for (uint32_t e = scene->keyframes[k].first_event; e < end; e++)
+            if (scene->events[e] & SCNE_EVENT_ACTIVATE)
+                pf->activation_times[fill[scene->events[e] & SCNE_EVENT_INDEX]++] = scene->keyframes[k].timestamp;
+    }
+    free(fill);
+
+    for (uint32_t c = 0; c < components; c++) {
+        scne_component component;
+        scne_get_component(scene, c, &component);
+        scne_asset* a = &pf->assets[(size_t)c * SCNE_ASSET_KINDS + SCNE_ASSET_PRIMARY];
+        size_t length = strlen(component.path);
+        if (length == 0) continue;
+        scne_join(a->path, pf->base_dir, strlen(pf->base_dir), component.path, length);
+        a->state = SCNE_ASSET_IDLE;
+    }
+
+    scne_prefetch_sync* sync = pf->sync;
+#if defined(_WIN32)
+    InitializeCriticalSection(&sync->lock);
+    InitializeConditionVariable(&sync->wake);
+    sync->thread = CreateThread(NULL, 0, scne_prefetch_thread, pf, 0, NULL);
+    int started = sync->thread != NULL;
+    if (!started) DeleteCriticalSection(&sync->lock);
+#else
+    pthread_mutex_init(&sync->lock, NULL);
+    pthread_cond_init(&sync->wake, NULL);
+    int started = pthread_create(&sync->thread, NULL, scne_prefetch_thread, pf) == 0;
+    if (!started) {
+        pthread_cond_destroy(&sync->wake);
+        pthread_mutex_destroy(&sync->lock);
+    }
+#endif
+    if (!started) {
+        free(pf->sync);
+        pf->sync = NULL;
+        scne_prefetch_free(pf);
+        return SCNE_ERR_IO;
+    }
+    return SCNE_OK;
+}
+
+void scne_prefetch_free(scne_prefetch* pf)
+{
+    scne_prefetch_sync* sync = pf->sync;
+    if (sync) {
+        scne_lock(sync);
+        sync->quit = 1;
+        scne_signal(sync);
+        scne_unlock(sync);
+#if defined(_WIN32)
+        WaitForSingleObject(sync->thread, INFINITE);
+        CloseHandle(sync->thread);
+        DeleteCriticalSection(&sync->lock);
+#else
+        pthread_join(sync->thread, NULL);
+        pthread_cond_destroy(&sync->wake);
+        pthread_mutex_destroy(&sync->lock);
+#endif
+        free(sync);
+    }
+    if (pf->assets && pf->scene) {
+        uint32_t asset_count = pf->scene->header->num_components * SCNE_ASSET_KINDS;
+        for (uint32_t i = 0; i < asset_count; i++) free(pf->assets[i].data);
+    }
+    if (pf->cursor.mask) scne_cursor_free(&pf->cursor);
+    free(pf->assets);
+    free(pf->activation_start);
+    free(pf->activation_times);
+    free(pf->need);
+    free(pf->was_active);
+    memset(pf, 0, sizeof(*pf));
+}
+
+static void scne_evict(scne_prefetch* pf, scne_asset* a)
+{
+    free(a->data);
+    a->data = NULL;
+    pf->stats.resident_bytes -= a->size;
+    pf->stats.evictions++;
+    a->state = SCNE_ASSET_IDLE;
+}
+
+// Frees ready assets that are not needed within the lookahead, furthest need first, until bytes more fit.
+// Evicts nothing if that would not be enough.
+static int scne_make_room(scne_prefetch* pf, size_t bytes, uint32_t asset_count)
+{
+    size_t evictable = 0;
+    for (uint32_t i = 0; i < asset_count; i++)
+        if (pf->assets[i].state == SCNE_ASSET_READY && pf->assets[i].need > pf->lookahead) evictable += pf->assets[i].size;
+    if (pf->stats.resident_bytes - evictable + bytes > pf->budget) return 0;
+
+    while (pf->stats.resident_bytes + bytes > pf->budget) {
+        scne_asset* victim = NULL;
+        for (uint32_t i = 0; i < asset_count; i++) {
+            scne_asset* a = &pf->assets[i];
+            if (a->state == SCNE_ASSET_READY && a->need > pf->lookahead && (!victim || a->need > victim->need)) victim = a;
+        }
+        if (!victim) return 0;
+        scne_evict(pf, victim);
+    }
+    return 1;
+}
+
+void scne_prefetch_update(scne_prefetch* pf, float t)
+{
+    const scne_scene* scene = pf->scene;
+    uint32_t components = scene->header->num_components;
+    uint32_t asset_count = components * SCNE_ASSET_KINDS;
+
+    scne_cursor_seek(&pf->cursor, t);
+
+    // Seconds until each component is needed: binary search for its next activation after t
+    for (uint32_t c = 0; c < components; c++) {
+        if (scne_is_active(pf->cursor.mask, c)) {
+            pf->need[c] = 0.0f;
+            continue;
+        }
+        uint32_t lo = pf->activation_start[c], hi = pf->activation_start[c + 1];
+        while (lo < hi) {
+            uint32_t mid = lo + (hi - lo) / 2;
+            if (pf->activation_times[mid] <= t) lo = mid + 1;
+            else hi = mid;
+        }
+        pf->need[c] = lo < pf->activation_start[c + 1] ? pf->activation_times[lo] - t : FLT_MAX;
+    }
+
+    scne_lock(pf->sync);
+    for (uint32_t c = 0; c < components; c++) {
+        if (!scne_is_active(pf->cursor.mask, c) || scne_is_active(pf->was_active, c)) continue;
+        int state = pf->assets[(size_t)c * SCNE_ASSET_KINDS + SCNE_ASSET_PRIMARY].state;
+        if (state == SCNE_ASSET_IDLE || state == SCNE_ASSET_QUEUED || state == SCNE_ASSET_LOADING) pf->stats.late_activations++;
+    }
+    memcpy(pf->was_active, pf->cursor.mask, (size_t)scene->header->mask_words * 4);
+
+    // Drop what will never be needed again and unqueue what slipped out of the window
+    for (uint32_t i = 0; i < asset_count; i++) {
+        scne_asset* a = &pf->assets[i];
+        a->need = pf->need[i / SCNE_ASSET_KINDS];
+        if (a->state == SCNE_ASSET_READY && a->need == FLT_MAX) scne_evict(pf, a);
+        else if (a->state == SCNE_ASSET_QUEUED && a->need > pf->lookahead) a->state = SCNE_ASSET_IDLE;
+    }
+
+    // Queue upcoming assets. Sizes are only known for reads the worker deferred; those wait until room is made.
+    int queued = 0;
+    for (uint32_t i = 0; i < asset_count; i++) {
+        scne_asset* a = &pf->assets[i];
+        if (a->state != SCNE_ASSET_IDLE || a->need > pf->lookahead) continue;
+        if (a->size > pf->budget) {
+            a->state = SCNE_ASSET_FAILED;
+            pf->stats.failures++;
+            continue;
+        }
+        if (a->size > 0 && !scne_make_room(pf, a->size, asset_count)) continue;
+        a->state = SCNE_ASSET_QUEUED;
+        queued = 1;
+    }
+    if (queued) scne_signal(pf->sync);
+    scne_unlock(pf->sync);
+}
+
+const uint8_t* scne_prefetch_get(scne_prefetch* pf, uint32_t component, int kind, size_t* size)
+{
+    const uint8_t* data = NULL;
+    *size = 0;
+    if (component >= pf->scene->header->num_components || kind < 0 || kind >= SCNE_ASSET_KINDS) return NULL;
+    scne_lock(pf->sync);
+    scne_asset* a = &pf->assets[(size_t)component * SCNE_ASSET_KINDS + kind];
+    if (a->state == SCNE_ASSET_READY) {
+        data = a->data;
+        *size = a->size;
+    }
+    scne_unlock(pf->sync);
+    return data;
+}
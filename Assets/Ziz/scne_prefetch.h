@@ -0,0 +1,76 @@
+#ifndef SCNE_PREFETCH_H
+#define SCNE_PREFETCH_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "scne.h"
+
+// Reads a scene's assets ahead of the playhead on a background I/O thread, so a component turning on finds its files
+// already in memory.
+//
+//   scne_prefetch pf;
+//   scne_prefetch_init(&pf, &scene, "GeneratedData", 64 << 20, 2.0f);
+//   every frame:
+//     scne_prefetch_update(&pf, t);
+//     data = scne_prefetch_get(&pf, component, SCNE_ASSET_PRIMARY, &size);   // NULL until loaded, never blocks
+//
+// Each component has up to three assets: its own file (.act, .ptc, .cam or level), and for ACT files the first RAT
+// chunk and the texture named in the ACT header (for PTC0 particle streams just the texture), discovered once the
+// file is read. Assets are requested once their component is active or activates within the lookahead window, most
+// urgent first. Resident bytes stay within the budget: assets whose component never activates again are dropped at
+// once, and when space runs short the asset needed furthest in the future goes first. Active and imminent assets are
+// never evicted; if they alone exceed the budget, later requests wait.
+//
+// Pointers from scne_prefetch_get stay valid while the component is active or within the lookahead window.
+
+#define SCNE_PREFETCH_MAX_PATH 512
+
+enum {
+    SCNE_ASSET_PRIMARY,       // the component's file_path
+    SCNE_ASSET_FIRST_RAT,     // ACT only: first RAT file listed
+    SCNE_ASSET_TEXTURE,       // ACT and PTC0 only: texture file, next to the owner
+    SCNE_ASSET_KINDS
+};
+
+typedef struct scne_prefetch_stats {
+    uint64_t bytes_read;
+    uint32_t loads;
+    uint32_t failures;             // missing, unreadable or larger than the whole budget; not retried
+    uint32_t evictions;
+    uint32_t deferred;             // reads postponed because the budget was full
+    uint32_t late_activations;     // components that turned on before their primary asset was ready
+    size_t resident_bytes;         // loaded plus in flight
+    size_t peak_bytes;
+} scne_prefetch_stats;
+
+typedef struct scne_asset scne_asset;
+typedef struct scne_prefetch_sync scne_prefetch_sync;
+
+typedef struct scne_prefetch {
+    const scne_scene* scene;
+    char base_dir[SCNE_PREFETCH_MAX_PATH];
+    size_t budget;
+    float lookahead;
+    scne_asset* assets;            // num_components * SCNE_ASSET_KINDS
+    uint32_t* activation_start;    // num_components + 1, ranges into activation_times
+    float* activation_times;       // ascending per component
+    float* need;                   // seconds until each component is needed: 0 when active, FLT_MAX never again
+    scne_cursor cursor;
+    uint32_t* was_active;          // mask_words
+    scne_prefetch_stats stats;     // updated under the lock; read after scne_prefetch_update
+    scne_prefetch_sync* sync;
+} scne_prefetch;
+
+// base_dir is prepended to every component path ("" for paths relative to the working directory).
+// Returns SCNE_OK, SCNE_ERR_MEMORY, or SCNE_ERR_IO if the I/O thread could not start.
+int scne_prefetch_init(scne_prefetch* pf, const scne_scene* scene, const char* base_dir, size_t budget_bytes,
+                       float lookahead_seconds);
+void scne_prefetch_free(scne_prefetch* pf);
+
+// Main thread, once per frame: advances to time t, drops unneeded assets and queues upcoming ones. O(components).
+void scne_prefetch_update(scne_prefetch* pf, float t);
+
+// Loaded bytes of one asset, or NULL if it is not in memory (yet). Never waits for I/O.
+const uint8_t* scne_prefetch_get(scne_prefetch* pf, uint32_t component, int kind, size_t* size);
+
+#endif
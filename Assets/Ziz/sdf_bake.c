@@ -0,0 +1,348 @@
+#include "sdf_bake.h"
+#include "band_pool.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SDF_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#define SDF_TILE 8
+#define SDF_PI 3.14159265f
+
+// Same semantics as _mm_min_ps/_mm_max_ps (second operand on ties and NaN), so both paths agree bit for bit
+static float sdf_min(float a, float b) { return a < b ? a : b; }
+static float sdf_max(float a, float b) { return a > b ? a : b; }
+static float sdf_clamp01(float x) { return sdf_min(sdf_max(x, 0.0f), 1.0f); }
+static float sdf_sign(float x) { return (float)((x > 0.0f) - (x < 0.0f)); }
+static float sdf_length(float x, float y) { return sqrtf(x * x + y * y); }
+
+void sdf_shape_defaults(sdf_shape* shape, sdf_shape_type type)
+{
+    memset(shape, 0, sizeof(*shape));
+    shape->type = type;
+    shape->radius = 0.4f;
+    shape->roundness = 0.0f;
+    shape->smooth = 0.01f;
+    shape->thickness = 0.1f;
+    shape->head_size = 0.25f;
+    shape->shaft_thickness = 0.08f;
+    shape->star_inner = 0.3f;
+    shape->star_outer = 0.5f;
+    shape->star_points = 5.0f;
+    shape->alpha = 1.0f;
+}
+
+static float sdf_capsule(float px, float py, float ax, float ay, float bx, float by, float r)
+{
+    float pax = px - ax, pay = py - ay, bax = bx - ax, bay = by - ay;
+    float h = sdf_clamp01((pax * bax + pay * bay) / (bax * bax + bay * bay));
+    return sdf_length(pax - bax * h, pay - bay * h) - r;
+}
+
+// Distance to the triangle edge a -> b, as SDF_Arrow's sdTriangle measures it
+static float sdf_edge(float px, float py, float ax, float ay, float bx, float by)
+{
+    float bax = bx - ax, bay = by - ay, pax = px - ax, pay = py - ay;
+    float nl = sdf_length(bay, -bax);
+    float h = pax * (bay / nl) + pay * (-bax / nl);
+    float t = (pax * bax + pay * bay) / (bax * bax + bay * bay);
+    return t < 0.0f ? sdf_length(pax, pay) : t > 1.0f ? sdf_length(px - bx, py - by) : fabsf(h);
+}
+
+float sdf_distance(const sdf_shape* shape, float u, float v)
+{
+    float px = u - 0.5f, py = v - 0.5f;
+    switch (shape->type) {
+    case SDF_CIRCLE:
+        return sdf_length(px, py) - shape->radius;
+    case SDF_BOX: {
+        float r = shape->roundness, b = 0.5f - r;
+        float dx = fabsf(px) - b + r, dy = fabsf(py) - b + r;
+        return sdf_length(sdf_max(dx, 0.0f), sdf_max(dy, 0.0f)) + sdf_min(sdf_max(dx, dy), 0.0f) - r;
+    }
+    case SDF_TRIANGLE: {
+        const float k = 1.7320508f;
+        float x = fabsf(u * 2.0f - 1.0f) - 0.5f, y = (v * 2.0f - 1.0f) + 0.288675f;
+        if (x + k * y > 0.0f) {
+            float nx = (x - k * y) / 2.0f, ny = (-k * x - y) / 2.0f;
+            x = nx;
+            y = ny;
+        }
+        x -= x < -1.0f ? -1.0f : (x > 0.0f ? 0.0f : x);
+        return -sdf_length(x, y) * sdf_sign(y);
+    }
+    case SDF_CAPSULE:
+        return sdf_capsule(u, v, 0.2f, 0.5f, 0.8f, 0.5f, shape->radius);
+    case SDF_STAR: {
+        float n = shape->star_points, k = SDF_PI / n;
+        float m = fmodf(atan2f(py, px), 2.0f * k) - k;
+        float r = shape->star_outer + fabsf(cosf(n * m)) * (shape->star_inner - shape->star_outer);
+        return sdf_length(px, py) - r;
+    }
+    case SDF_CIRCLE_RING:
+        return fabsf(sdf_length(px, py) - shape->radius) - shape->thickness * 0.5f;
+    case SDF_CROSS:
+        return sdf_min(fabsf(px), fabsf(py)) - shape->thickness * 0.5f;
+    case SDF_PLUS:
+        return sdf_min(fabsf(fabsf(px) - fabsf(py)), shape->thickness * 0.5f) - shape->thickness * 0.5f;
+    case SDF_ARROW: {
+        // Outline of the head triangle; the shaft in the shader is computed but unused
+        float tip_x = 0.8f, tip_y = 0.5f, h = shape->head_size;
+        float dir_x = tip_x - 0.2f, dir_y = tip_y - 0.5f, dl = sdf_length(dir_x, dir_y);
+        dir_x /= dl;
+        dir_y /= dl;
+        float left_x = tip_x - dir_x * h - dir_y * h * 0.5f, left_y = tip_y - dir_y * h + dir_x * h * 0.5f;
+        float right_x = tip_x - dir_x * h + dir_y * h * 0.5f, right_y = tip_y - dir_y * h - dir_x * h * 0.5f;
+        float d = sdf_min(sdf_min(sdf_edge(u, v, tip_x, tip_y, left_x, left_y), sdf_edge(u, v, left_x, left_y, right_x, right_y)),
+                          sdf_edge(u, v, right_x, right_y, tip_x, tip_y));
+        float s = sdf_sign((left_x - tip_x) * (tip_y - right_y) - (left_y - tip_y) * (tip_x - right_x));
+        return fabsf(d * s) - shape->shaft_thickness;
+    }
+    default:
+        return 0.0f;
+    }
+}
+
+// How far the distance can change per unit of UV, for skipping tiles; 0 where the shader's function isn't a bounded
+// distance (star)
+static float sdf_lipschitz(sdf_shape_type type)
+{
+    switch (type) {
+    case SDF_TRIANGLE: return 2.0f;       // measured in [-1, 1] space
+    case SDF_PLUS: return 1.4142136f;     // |dx - dy|
+    case SDF_STAR: return 0.0f;
+    default: return 1.0f;
+    }
+}
+
+typedef struct sdf_edge_ramp {
+    float smooth;       // after antialiasing
+    float inside;       // distances at or below this are fully covered
+    float outside;      // at or above this, not covered
+} sdf_edge_ramp;
+
+// Every shader but the arrow's ramps alpha over [-smooth, 0] (smoothstep(smooth, 0, -d), or the circle's equivalent
+// smoothstep(r, r - smooth, length)); the arrow ramps over [-smooth, smooth] and switches to a step below 0.0001.
+static sdf_edge_ramp sdf_ramp(const sdf_bake_job* job)
+{
+    sdf_edge_ramp ramp;
+    float s = job->shape.smooth;
+    float texel = 1.0f / (float)(job->width < job->height ? job->width : job->height);
+    if (job->shape.type == SDF_ARROW) {
+        if (job->antialias && s < texel * 0.5f) s = texel * 0.5f;
+        if (s <= 0.0001f) s = 0.0f;
+        ramp.inside = -s;
+        ramp.outside = s;
+    } else {
+        if (job->antialias && s < texel) s = texel;
+        if (s < 0.0f) s = 0.0f;
+        ramp.inside = -s;
+        ramp.outside = 0.0f;
+    }
+    ramp.smooth = s;
+    return ramp;
+}
+
+static float sdf_coverage(const sdf_shape* shape, const sdf_edge_ramp* ramp, float d)
+{
+    float t;
+    if (shape->type == SDF_ARROW) {
+        if (ramp->smooth == 0.0f) return d <= 0.0f ? 1.0f : 0.0f;
+        t = sdf_clamp01((ramp->smooth - d) / (2.0f * ramp->smooth));
+    } else {
+        if (ramp->smooth == 0.0f) return d < 0.0f ? 1.0f : 0.0f;
+        t = sdf_clamp01(-d / ramp->smooth);
+    }
+    return t * t * (3.0f - 2.0f * t);
+}
+
+// The GPU bake blended the shader output over transparent black with SrcAlpha/OneMinusSrcAlpha, which stores alpha
+// squared, and SaveRenderTextureToPNG then whitened every texel above 0.01 and cleared the rest
+static uint32_t sdf_texel(float alpha, float coverage)
+{
+    float a = alpha * coverage;
+    uint32_t byte = (uint32_t)(a * a * 255.0f + 0.5f);
+    return byte >= 3 ? 0x00FFFFFFu | byte << 24 : 0u;
+}
+
+static void sdf_store(uint8_t* out, uint32_t texel)
+{
+    out[0] = (uint8_t)texel;
+    out[1] = (uint8_t)(texel >> 8);
+    out[2] = (uint8_t)(texel >> 16);
+    out[3] = (uint8_t)(texel >> 24);
+}
+
+static float sdf_u(const sdf_bake_job* job, uint32_t x) { return ((float)x + 0.5f) / (float)job->width; }
+static float sdf_v(const sdf_bake_job* job, uint32_t y) { return ((float)(job->height - y) - 0.5f) / (float)job->height; }
+
+#if SDF_SSE2
+static __m128 sdf_abs4(__m128 x) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), x); }
+static __m128 sdf_length4(__m128 x, __m128 y) { return _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y))); }
+
+static int sdf_has_sse_path(sdf_shape_type type)
+{
+    return type == SDF_CIRCLE || type == SDF_BOX || type == SDF_CAPSULE || type == SDF_CIRCLE_RING || type == SDF_CROSS ||
+           type == SDF_PLUS;
+}
+
+// sdf_distance for four texels of one row, same operations in the same order
+static __m128 sdf_distance4(const sdf_shape* shape, __m128 u, float v)
+{
+    const __m128 zero = _mm_setzero_ps(), half = _mm_set1_ps(0.5f);
+    __m128 px = _mm_sub_ps(u, half), py = _mm_set1_ps(v - 0.5f);
+    switch (shape->type) {
+    case SDF_CIRCLE:
+        return _mm_sub_ps(sdf_length4(px, py), _mm_set1_ps(shape->radius));
+    case SDF_BOX: {
+        __m128 r = _mm_set1_ps(shape->roundness), b = _mm_set1_ps(0.5f - shape->roundness);
+        __m128 dx = _mm_add_ps(_mm_sub_ps(sdf_abs4(px), b), r), dy = _mm_add_ps(_mm_sub_ps(sdf_abs4(py), b), r);
+        __m128 outside = sdf_length4(_mm_max_ps(dx, zero), _mm_max_ps(dy, zero));
+        return _mm_sub_ps(_mm_add_ps(outside, _mm_min_ps(_mm_max_ps(dx, dy), zero)), r);
+    }
+    case SDF_CAPSULE: {
+        // a = (0.2, 0.5), b = (0.8, 0.5)
+        const float bax = 0.8f - 0.2f, bay = 0.5f - 0.5f;
+        __m128 pax = _mm_sub_ps(u, _mm_set1_ps(0.2f)), pay = _mm_set1_ps(v - 0.5f);
+        __m128 dot = _mm_add_ps(_mm_mul_ps(pax, _mm_set1_ps(bax)), _mm_mul_ps(pay, _mm_set1_ps(bay)));
+        __m128 h = _mm_min_ps(_mm_max_ps(_mm_div_ps(dot, _mm_set1_ps(bax * bax + bay * bay)), zero), _mm_set1_ps(1.0f));
+        __m128 dx = _mm_sub_ps(pax, _mm_mul_ps(_mm_set1_ps(bax), h)), dy = _mm_sub_ps(pay, _mm_mul_ps(_mm_set1_ps(bay), h));
+        return _mm_sub_ps(sdf_length4(dx, dy), _mm_set1_ps(shape->radius));
+    }
+    case SDF_CIRCLE_RING:
+        return _mm_sub_ps(sdf_abs4(_mm_sub_ps(sdf_length4(px, py), _mm_set1_ps(shape->radius))), _mm_set1_ps(shape->thickness * 0.5f));
+    case SDF_CROSS:
+        return _mm_sub_ps(_mm_min_ps(sdf_abs4(px), sdf_abs4(py)), _mm_set1_ps(shape->thickness * 0.5f));
+    default: { // SDF_PLUS
+        __m128 t = _mm_set1_ps(shape->thickness * 0.5f);
+        return _mm_sub_ps(_mm_min_ps(sdf_abs4(_mm_sub_ps(sdf_abs4(px), sdf_abs4(py))), t), t);
+    }
+    }
+}
+
+// sdf_texel(alpha, sdf_coverage(d)) for four texels; never called for the arrow
+static __m128i sdf_texel4(const sdf_edge_ramp* ramp, float alpha, __m128 d)
+{
+    const __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps(1.0f);
+    __m128 c;
+    if (ramp->smooth == 0.0f) {
+        c = _mm_and_ps(_mm_cmplt_ps(d, zero), one);
+    } else {
+        __m128 t = _mm_min_ps(_mm_max_ps(_mm_div_ps(_mm_xor_ps(d, _mm_set1_ps(-0.0f)), _mm_set1_ps(ramp->smooth)), zero), one);
+        c = _mm_mul_ps(_mm_mul_ps(t, t), _mm_sub_ps(_mm_set1_ps(3.0f), _mm_mul_ps(_mm_set1_ps(2.0f), t)));
+    }
+    __m128 a = _mm_mul_ps(_mm_set1_ps(alpha), c);
+    __m128i byte = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(_mm_mul_ps(a, a), _mm_set1_ps(255.0f)), _mm_set1_ps(0.5f)));
+    __m128i texel = _mm_or_si128(_mm_set1_epi32(0x00FFFFFF), _mm_slli_epi32(byte, 24));
+    return _mm_and_si128(texel, _mm_cmpgt_epi32(byte, _mm_set1_epi32(2)));
+}
+#endif
+
+// Texels x0..x1 of row y
+static void sdf_eval_span(const sdf_bake_job* job, const sdf_edge_ramp* ramp, float alpha, uint32_t y, uint32_t x0, uint32_t x1,
+                          uint8_t* row)
+{
+    float v = sdf_v(job, y);
+    uint32_t x = x0;
+#if SDF_SSE2
+    if (sdf_has_sse_path(job->shape.type)) {
+        __m128 w = _mm_set1_ps((float)job->width);
+        for (; x + 4 <= x1; x += 4) {
+            __m128 fx = _mm_cvtepi32_ps(_mm_add_epi32(_mm_set1_epi32((int)x), _mm_setr_epi32(0, 1, 2, 3)));
+            __m128 u = _mm_div_ps(_mm_add_ps(fx, _mm_set1_ps(0.5f)), w);
+            _mm_storeu_si128((__m128i*)(row + (size_t)x * 4), sdf_texel4(ramp, alpha, sdf_distance4(&job->shape, u, v)));
+        }
+    }
+#endif
+    for (; x < x1; x++)
+        sdf_store(row + (size_t)x * 4, sdf_texel(alpha, sdf_coverage(&job->shape, ramp, sdf_distance(&job->shape, sdf_u(job, x), v))));
+}
+
+// Rows y0..y1 of a job into rgba (tightly packed RGBA8888, row y0 first)
+static void sdf_bake_rows(const sdf_bake_job* job, uint32_t y0, uint32_t y1, uint8_t* rgba)
+{
+    sdf_edge_ramp ramp = sdf_ramp(job);
+    float alpha = sdf_clamp01(job->shape.alpha);
+    float lipschitz = sdf_lipschitz(job->shape.type);
+    uint32_t inside = sdf_texel(alpha, 1.0f);
+    size_t stride = (size_t)job->width * 4;
+
+    for (uint32_t ty = y0; ty < y1; ty += SDF_TILE) {
+        uint32_t ty1 = ty + SDF_TILE < y1 ? ty + SDF_TILE : y1;
+        for (uint32_t tx = 0; tx < job->width; tx += SDF_TILE) {
+            uint32_t tx1 = tx + SDF_TILE < job->width ? tx + SDF_TILE : job->width;
+            int fill = -1;
+
+            if (lipschitz > 0.0f) {
+                // Distance at the middle of the tile's texel centres bounds it over the whole tile
+                float cu = (float)(tx + tx1) * 0.5f / (float)job->width;
+                float cv = ((float)job->height - (float)(ty + ty1) * 0.5f) / (float)job->height;
+                float hu = (float)(tx1 - tx - 1) * 0.5f / (float)job->width, hv = (float)(ty1 - ty - 1) * 0.5f / (float)job->height;
+                float reach = lipschitz * sdf_length(hu, hv) + 1e-5f;
+                float d = sdf_distance(&job->shape, cu, cv);
+                if (d - reach >= ramp.outside) fill = 0;
+                else if (d + reach <= ramp.inside) fill = 1;
+            }
+
+            for (uint32_t y = ty; y < ty1; y++) {
+                uint8_t* row = rgba + (size_t)(y - y0) * stride;
+                if (fill == 0) {
+                    memset(row + (size_t)tx * 4, 0, (size_t)(tx1 - tx) * 4);
+                } else if (fill == 1) {
+                    for (uint32_t x = tx; x < tx1; x++) sdf_store(row + (size_t)x * 4, inside);
+                } else {
+                    sdf_eval_span(job, &ramp, alpha, y, tx, tx1, row);
+                }
+            }
+        }
+    }
+}
+
+// Bands are one tile row and start on multiples of SDF_TILE, so ordered dithering in texel_encode keeps its phase
+static uint32_t sdf_bands(void* user, uint32_t j)
+{
+    const sdf_bake_job* job = &((const sdf_bake_job*)user)[j];
+    return job->width ? (job->height + SDF_TILE - 1) / SDF_TILE : 0;
+}
+
+static int sdf_band(band_pool* pool, void* user, void* scratch, uint32_t j, uint32_t band)
+{
+    const sdf_bake_job* job = &((const sdf_bake_job*)user)[j];
+    uint32_t y0 = band * SDF_TILE;
+    uint32_t y1 = y0 + SDF_TILE < job->height ? y0 + SDF_TILE : job->height;
+    uint8_t* out = (uint8_t*)job->out + (size_t)y0 * texel_row_bytes(job->format, job->width);
+    (void)pool;
+
+    if (job->format == TEXEL_RGBA8888) {
+        sdf_bake_rows(job, y0, y1, out);
+    } else {
+        sdf_bake_rows(job, y0, y1, (uint8_t*)scratch);
+        texel_encode(job->format, (const uint8_t*)scratch, job->width, y1 - y0, job->dither, out);
+    }
+    return SDF_OK;
+}
+
+int sdf_bake_batch(const sdf_bake_job* jobs, uint32_t count, uint32_t threads)
+{
+    uint32_t max_width = 0;
+    for (uint32_t j = 0; j < count; j++) {
+        const sdf_bake_job* job = &jobs[j];
+        if ((unsigned)job->shape.type >= SDF_SHAPE_COUNT || texel_bits(job->format) == 0 || job->format == TEXEL_CI8 ||
+            job->format == TEXEL_CI4)
+            return SDF_ERR_FORMAT;
+        if (job->width > max_width) max_width = job->width;
+    }
+
+    band_pool_work work;
+    memset(&work, 0, sizeof(work));
+    work.count = count;
+    work.bands = sdf_bands;
+    work.run = sdf_band;
+    work.user = (void*)jobs;
+    work.scratch_bytes = (size_t)max_width * 4 * SDF_TILE;
+    work.memory_error = SDF_ERR_MEMORY;
+    return band_pool_run(&work, threads);
+}
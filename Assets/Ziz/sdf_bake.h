@@ -0,0 +1,79 @@
+#ifndef SDF_BAKE_H
+#define SDF_BAKE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "texel.h"
+
+// CPU baker for SDFShape textures: the distance functions of the SDF_*.shader materials, evaluated without a GPU.
+//
+//   sdf_bake_job job = { 0 };
+//   sdf_shape_defaults(&job.shape, SDF_STAR);
+//   job.width = job.height = 256;
+//   job.format = TEXEL_RGBA8888;
+//   job.out = pixels;                          // texel_image_size(format, width, height) bytes
+//   sdf_bake_batch(&job, 1, 8);
+//
+// Output matches what SDFShape.SaveRenderTextureToPNG read back: the shader alpha blended over transparent black
+// (so stored alpha is coverage squared), texels with alpha below 3/255 cleared, white everywhere else. Rows are
+// top-down like the PNG, row 0 at v = 1. Texels are sampled at their centres, as Graphics.Blit does.
+//
+// Work is split into 8x8 tiles. A tile whose centre is further from the edge than the distance function can change
+// across it is filled without evaluating its texels, so most of a bake is memset; the rest runs four texels per SSE2
+// step for the shapes with closed-form distances (circle, box, capsule, ring, cross, plus) and in scalar code for
+// the others. Both paths give the same bits.
+
+typedef enum sdf_shape_type {
+    SDF_CIRCLE,                  // same order as SDFShapeType
+    SDF_BOX,
+    SDF_TRIANGLE,
+    SDF_CAPSULE,
+    SDF_STAR,
+    SDF_CIRCLE_RING,
+    SDF_CROSS,
+    SDF_PLUS,
+    SDF_ARROW,
+    SDF_SHAPE_COUNT
+} sdf_shape_type;
+
+typedef struct sdf_shape {
+    sdf_shape_type type;
+    float radius;                // circle, capsule, ring
+    float roundness;             // box
+    float smooth;                // edge ramp width in UV units; <= 0 gives a hard edge
+    float thickness;             // ring, cross, plus
+    float head_size;             // arrow
+    float shaft_thickness;       // arrow
+    float star_inner;
+    float star_outer;
+    float star_points;
+    float alpha;                 // SDFShape.color.a
+} sdf_shape;
+
+enum {
+    SDF_OK = 0,
+    SDF_ERR_FORMAT = -1,         // a CI format, or an unknown shape or format
+    SDF_ERR_MEMORY = -2
+};
+
+typedef struct sdf_bake_job {
+    sdf_shape shape;
+    uint32_t width;
+    uint32_t height;
+    texel_format format;
+    int dither;                  // TEXEL_DITHER_*, for formats narrower than RGBA8888
+    int antialias;               // widen edge ramps narrower than a texel to one texel
+    void* out;                   // texel_image_size(format, width, height) bytes
+} sdf_bake_job;
+
+// The SDFShape field defaults for a shape type
+void sdf_shape_defaults(sdf_shape* shape, sdf_shape_type type);
+
+// Signed distance at (u, v) in the shape's own units, negative inside, exactly as its shader computes it
+float sdf_distance(const sdf_shape* shape, float u, float v);
+
+// Bakes count jobs on up to threads threads, the caller's included; if a thread can't be started the others take its
+// share. Jobs may differ in size, shape and format.
+int sdf_bake_batch(const sdf_bake_job* jobs, uint32_t count, uint32_t threads);
+
+#endif
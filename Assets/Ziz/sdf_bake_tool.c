@@ -0,0 +1,152 @@
+// Bakes SDFShape textures without a GPU, from a manifest written by Tools/SDF Shapes/Write CPU Bake Manifest.
+//
+//   cc -O2 -I. sdf_bake_tool.c sdf_bake.c band_pool.c texel.c png_write.c -lm -lpthread -o sdf_bake_tool
+//   ./sdf_bake_tool GeneratedData/sdf_bake_manifest.txt GeneratedData [threads]
+//
+// One shape per line: type, width, height, key=value parameters (sdf_shape field names), then the PNG file name.
+// Lines starting with # are skipped. PNGs are written uncompressed (stored deflate blocks); Unity re-encodes them on
+// import anyway.
+
+#include "png_write.h"
+#include "sdf_bake.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TOOL_MAX_LINE 2048
+
+typedef struct tool_entry {
+    sdf_bake_job job;
+    char file[512];
+} tool_entry;
+
+static const char* tool_shape_names[SDF_SHAPE_COUNT] = {
+    "Circle", "Box", "Triangle", "Capsule", "Star", "CircleRing", "Cross", "Plus", "Arrow"
+};
+
+static int tool_set(sdf_shape* shape, const char* key, float value)
+{
+    static const struct { const char* name; size_t offset; } fields[] = {
+        { "radius", offsetof(sdf_shape, radius) },
+        { "roundness", offsetof(sdf_shape, roundness) },
+        { "smooth", offsetof(sdf_shape, smooth) },
+        { "thickness", offsetof(sdf_shape, thickness) },
+        { "head_size", offsetof(sdf_shape, head_size) },
+        { "shaft_thickness", offsetof(sdf_shape, shaft_thickness) },
+        { "star_inner", offsetof(sdf_shape, star_inner) },
+        { "star_outer", offsetof(sdf_shape, star_outer) },
+        { "star_points", offsetof(sdf_shape, star_points) },
+        { "alpha", offsetof(sdf_shape, alpha) },
+    };
+    for (size_t i = 0; i < sizeof(fields) / sizeof(fields[0]); i++) {
+        if (strcmp(key, fields[i].name) == 0) {
+            memcpy((uint8_t*)shape + fields[i].offset, &value, sizeof(float));
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static int tool_parse(char* line, tool_entry* entry)
+{
+    char* token = strtok(line, " \t\r\n");
+    if (!token || token[0] == '#') return 0;
+
+    int type = -1;
+    for (int t = 0; t < SDF_SHAPE_COUNT; t++)
+        if (strcmp(token, tool_shape_names[t]) == 0) type = t;
+    if (type < 0) return -1;
+
+    memset(entry, 0, sizeof(*entry));
+    sdf_shape_defaults(&entry->job.shape, (sdf_shape_type)type);
+    entry->job.format = TEXEL_RGBA8888;
+
+    char* width = strtok(NULL, " \t\r\n");
+    char* height = strtok(NULL, " \t\r\n");
+    if (!width || !height) return -1;
+    entry->job.width = (uint32_t)strtoul(width, NULL, 10);
+    entry->job.height = (uint32_t)strtoul(height, NULL, 10);
+    if (entry->job.width == 0 || entry->job.height == 0 || entry->job.width > 8192 || entry->job.height > 8192) return -1;
+
+    while ((token = strtok(NULL, " \t\r\n")) != NULL) {
+        char* eq = strchr(token, '=');
+        if (!eq) {
+            if (strlen(token) >= sizeof(entry->file)) return -1;
+            strcpy(entry->file, token);
+            continue;
+        }
+        *eq = '\0';
+        if (strcmp(token, "antialias") == 0) entry->job.antialias = atoi(eq + 1);
+        else if (!tool_set(&entry->job.shape, token, (float)atof(eq + 1))) return -1;
+    }
+    return entry->file[0] ? 1 : -1;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 3) {
+        fprintf(stderr, "usage: %s manifest.txt out_dir [threads]\n", argv[0]);
+        return 1;
+    }
+    uint32_t threads = argc > 3 ? (uint32_t)atoi(argv[3]) : 8;
+
+    FILE* manifest = fopen(argv[1], "r");
+    if (!manifest) {
+        fprintf(stderr, "cannot open %s\n", argv[1]);
+        return 1;
+    }
+
+    tool_entry* entries = NULL;
+    uint32_t count = 0, capacity = 0, line_number = 0;
+    char line[TOOL_MAX_LINE];
+    while (fgets(line, sizeof(line), manifest)) {
+        line_number++;
+        if (count == capacity) {
+            capacity = capacity ? capacity * 2 : 64;
+            tool_entry* grown = (tool_entry*)realloc(entries, capacity * sizeof(tool_entry));
+            if (!grown) {
+                fprintf(stderr, "out of memory\n");
+                return 1;
+            }
+            entries = grown;
+        }
+        int parsed = tool_parse(line, &entries[count]);
+        if (parsed < 0) fprintf(stderr, "%s:%u: skipped, not a shape line\n", argv[1], line_number);
+        if (parsed > 0) count++;
+    }
+    fclose(manifest);
+
+    // Every texture in one batch, so small shapes fill the threads while big ones finish
+    sdf_bake_job* jobs = (sdf_bake_job*)malloc((count ? count : 1) * sizeof(sdf_bake_job));
+    if (!jobs) return 1;
+    for (uint32_t i = 0; i < count; i++) {
+        jobs[i] = entries[i].job;
+        jobs[i].out = malloc((size_t)jobs[i].width * jobs[i].height * 4);
+        if (!jobs[i].out) {
+            fprintf(stderr, "out of memory\n");
+            return 1;
+        }
+    }
+
+    int result = sdf_bake_batch(jobs, count, threads);
+    if (result != SDF_OK) {
+        fprintf(stderr, "bake failed (%d)\n", result);
+        return 1;
+    }
+
+    int failures = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        char path[1024];
+        snprintf(path, sizeof(path), "%s/%s", argv[2], entries[i].file);
+        if (!png_write_rgba(path, (const uint8_t*)jobs[i].out, jobs[i].width, jobs[i].height)) {
+            fprintf(stderr, "cannot write %s\n", path);
+            failures++;
+        }
+        free(jobs[i].out);
+    }
+    printf("baked %u shape textures\n", count - failures);
+
+    free(jobs);
+    free(entries);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,907 @@
+#include "srast.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define SRAST_SSE 1
+#include <xmmintrin.h>
+#endif
+
+#define SRAST_SUBPIXEL 16            // snapping grid, per pixel
+#define SRAST_GUARD 16.0f            // guard band: clip-space |x|, |y| <= SRAST_GUARD * w, sixteen viewports
+#define SRAST_TILE_BLOCKS (SRAST_TILE / SRAST_BLOCK)
+
+// Screen-linear quantities interpolated across a triangle: depth, q = 1/w, and every attribute times q
+enum {
+    SRAST_P_DEPTH, SRAST_P_Q,
+    SRAST_P_U, SRAST_P_V,
+    SRAST_P_R, SRAST_P_G, SRAST_P_B, SRAST_P_A,
+    SRAST_PLANES
+};
+
+// Clip-space outcodes; the first six are the frustum, the rest what forces clipping
+#define SRAST_OUT_FRUSTUM 63u
+#define SRAST_OUT_NEAR 16u
+#define SRAST_OUT_GUARD 64u
+#define SRAST_MAX_CLIPPED 16     // polygon vertices after clipping a triangle against five planes
+
+typedef struct srast_vertex {
+    float x, y, z, w;            // clip space
+    float u, v, c[4];
+} srast_vertex;
+
+#define SRAST_NO_VERTEX 0xFFFFFFFFu
+
+// A projected triangle corner
+typedef struct srast_corner {
+    int64_t x, y;                // snapped, 1/16 pixels
+    float value[SRAST_PLANES];   // depth and q always; the attributes once fetched
+    uint32_t vertex;             // draw vertex whose attributes are still to be fetched, or SRAST_NO_VERTEX
+} srast_corner;
+
+typedef struct srast_tri {
+    // Edge i covers pixel (x, y) when step_x[i] * x + step_y[i] * y + base[i] >= 0, evaluated at the pixel centre in
+    // 1/16 pixel units; base carries the top-left bias
+    int64_t step_x[3], step_y[3], base[3];
+    // Value at pixel (x, y) = p[0] + p[1] * (x - min_x) + p[2] * (y - min_y), at the pixel centre
+    float plane[SRAST_PLANES][3];
+    int32_t min_x, min_y, max_x, max_y;    // inclusive, inside the framebuffer
+    float min_depth;
+    uint32_t draw;
+} srast_tri;
+
+typedef struct srast_bin {
+    uint32_t* items;             // triangle indices, submission order
+    uint32_t count;
+    uint32_t capacity;
+} srast_bin;
+
+struct srast_context {
+    uint32_t width, height;
+    uint32_t tiles_x, tiles_y, tile_count;
+    uint32_t blocks_x, blocks_y;
+    uint32_t* color;
+    float* depth;
+    float* block_far;            // farthest depth per 8x8 block, blocks_x * blocks_y
+    float* tile_far;             // farthest depth per tile
+    srast_bin* bins;
+    srast_tri* tris;
+    uint32_t tri_count, tri_capacity;
+    srast_draw* draws;
+    uint32_t draw_count, draw_capacity;
+    // Per vertex of the draw being submitted, vertex_capacity entries per array, one allocation
+    float* clip;                 // x[], y[], z[], w[]
+    int32_t* snapped;            // x[], y[] in 1/16 pixels; only for vertices that need no clipping
+    float* projected;            // depth[], q[]; likewise
+    uint8_t* outcode;
+    uint32_t vertex_capacity;
+    srast_stats stats;
+
+#if defined(_WIN32)
+    HANDLE* threads;
+    CRITICAL_SECTION lock;
+    CONDITION_VARIABLE wake;
+    CONDITION_VARIABLE done;
+#else
+    pthread_t* threads;
+    int* started;
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    pthread_cond_t done;
+#endif
+    uint32_t thread_count;
+    int quit;
+    // The frame being rasterized; generation changes with every srast_end
+    uint32_t generation;
+    uint32_t next_tile;
+    uint32_t busy;
+};
+
+// Transform and interpolation are written once over srast_v: four values per step with SSE, one without. Both
+// evaluate the same operations in the same order, so they give the same bits.
+#if SRAST_SSE
+#define SRAST_LANES 4
+typedef __m128 srast_v;
+#define SRAST_SET(s) _mm_set1_ps(s)
+#define SRAST_RAMP(s) _mm_setr_ps(s, (s) + 1.0f, (s) + 2.0f, (s) + 3.0f)
+#define SRAST_LOAD(p) _mm_loadu_ps(p)
+#define SRAST_STORE(p, v) _mm_storeu_ps(p, v)
+#define SRAST_ADD(a, b) _mm_add_ps(a, b)
+#define SRAST_MUL(a, b) _mm_mul_ps(a, b)
+#define SRAST_DIV(a, b) _mm_div_ps(a, b)
+#else
+#define SRAST_LANES 1
+typedef float srast_v;
+#define SRAST_SET(s) (s)
+#define SRAST_RAMP(s) (s)
+#define SRAST_LOAD(p) (*(p))
+#define SRAST_STORE(p, v) (*(p) = (v))
+#define SRAST_ADD(a, b) ((a) + (b))
+#define SRAST_MUL(a, b) ((a) * (b))
+#define SRAST_DIV(a, b) ((a) / (b))
+#endif
+
+#if defined(_WIN32)
+static void srast_lock(srast_context* r) { EnterCriticalSection(&r->lock); }
+static void srast_unlock(srast_context* r) { LeaveCriticalSection(&r->lock); }
+static void srast_wait(srast_context* r, CONDITION_VARIABLE* c) { SleepConditionVariableCS(c, &r->lock, INFINITE); }
+static void srast_wake_all(CONDITION_VARIABLE* c) { WakeAllConditionVariable(c); }
+#else
+static void srast_lock(srast_context* r) { pthread_mutex_lock(&r->lock); }
+static void srast_unlock(srast_context* r) { pthread_mutex_unlock(&r->lock); }
+static void srast_wait(srast_context* r, pthread_cond_t* c) { pthread_cond_wait(c, &r->lock); }
+static void srast_wake_all(pthread_cond_t* c) { pthread_cond_broadcast(c); }
+#endif
+
+static uint32_t srast_pack(const float c[4])
+{
+    uint32_t out = 0;
+    for (int k = 0; k < 4; k++) {
+        float v = c[k] * 255.0f;
+        v = (v > 0.0f ? (v < 255.0f ? v : 255.0f) : 0.0f) + 0.5f;
+        out |= (uint32_t)v << (8 * k);
+    }
+    return out;
+}
+
+static int64_t srast_floor16(int64_t v) { return v >= 0 ? v / 16 : -((-v + 15) / 16); }
+
+void srast_draw_defaults(srast_draw* draw)
+{
+    memset(draw, 0, sizeof(*draw));
+    draw->index_size = 2;
+    draw->mvp[0] = draw->mvp[5] = draw->mvp[10] = draw->mvp[15] = 1.0f;
+    draw->cull = SRAST_CULL_BACK;
+}
+
+// --- Submission: transform, clip, set up, bin ---
+
+static uint32_t srast_outcode(float x, float y, float z, float w)
+{
+    float g = SRAST_GUARD * w;
+    return (uint32_t)(x < -w) | (uint32_t)(x > w) << 1 | (uint32_t)(y < -w) << 2 | (uint32_t)(y > w) << 3 |
+           (uint32_t)(z < -w) << 4 | (uint32_t)(z > w) << 5 | (uint32_t)(!(w > 0.0f) || x < -g || x > g || y < -g || y > g) << 6;
+}
+
+// Signed distance to clipping plane p: 0 near, 1..4 the guard band; inside is >= 0
+static float srast_plane_distance(const srast_vertex* v, int p)
+{
+    float g = SRAST_GUARD * v->w;
+    switch (p) {
+    case 0: return v->z + v->w;
+    case 1: return g - v->x;
+    case 2: return g + v->x;
+    case 3: return g - v->y;
+    default: return g + v->y;
+    }
+}
+
+// Sutherland-Hodgman against the near plane and the guard band. Returns the polygon's vertex count (0 if nothing is
+// left); poly holds the triangle on entry.
+static int srast_clip(srast_vertex* poly, int count)
+{
+    srast_vertex scratch[SRAST_MAX_CLIPPED];
+    for (int p = 0; p < 5 && count > 0; p++) {
+        int n = 0;
+        for (int i = 0; i < count; i++) {
+            const srast_vertex* a = &poly[i];
+            const srast_vertex* b = &poly[(i + 1) % count];
+            float da = srast_plane_distance(a, p), db = srast_plane_distance(b, p);
+            if (da >= 0.0f) scratch[n++] = *a;
+            if ((da >= 0.0f) != (db >= 0.0f)) {
+                float t = da / (da - db);
+                const float* fa = &a->x;
+                const float* fb = &b->x;
+                float* out = &scratch[n++].x;
+                for (int k = 0; k < 10; k++) out[k] = fa[k] + (fb[k] - fa[k]) * t;
+            }
+        }
+        memcpy(poly, scratch, (size_t)n * sizeof(srast_vertex));
+        count = n;
+    }
+    return count;
+}
+
+static int srast_bin_push(srast_bin* bin, uint32_t tri)
+{
+    if (bin->count == bin->capacity) {
+        uint32_t capacity = bin->capacity ? bin->capacity * 2 : 64;
+        uint32_t* items = (uint32_t*)realloc(bin->items, capacity * sizeof(uint32_t));
+        if (!items) return SRAST_ERR_MEMORY;
+        bin->items = items;
+        bin->capacity = capacity;
+    }
+    bin->items[bin->count++] = tri;
+    return SRAST_OK;
+}
+
+static void srast_fetch(const srast_draw* d, uint32_t i, float* u, float* v, float c[4])
+{
+    *u = d->uv ? d->uv[i * 2] : 0.0f;
+    *v = d->uv ? d->uv[i * 2 + 1] : 0.0f;
+    uint32_t color = d->color ? d->color[i] : 0xFFFFFFFFu;
+    for (int k = 0; k < 4; k++) c[k] = (float)((color >> (8 * k)) & 255) * (1.0f / 255.0f);
+}
+
+// Viewport mapping, snapping and the screen-linear values of one clip-space point
+static void srast_project(const srast_context* r, float x, float y, float z, float w, srast_corner* out)
+{
+    float q = 1.0f / w;
+    out->x = (int64_t)lrintf((x * q * 0.5f + 0.5f) * (float)r->width * SRAST_SUBPIXEL);
+    out->y = (int64_t)lrintf((0.5f - y * q * 0.5f) * (float)r->height * SRAST_SUBPIXEL);
+    out->value[SRAST_P_DEPTH] = z * q * 0.5f + 0.5f;
+    out->value[SRAST_P_Q] = q;
+}
+
+// Culls and snaps one triangle, then bins it into every tile its edges reach. Corners still naming a draw vertex get
+// their attributes only once the triangle is known to cover a pixel centre.
+static int srast_setup(srast_context* r, const srast_draw* d, uint32_t draw, srast_corner* c0, srast_corner* c1,
+                       srast_corner* c2)
+{
+    // Counter-clockwise in clip space is clockwise once y points down, which makes this area negative
+    int64_t area = (c1->x - c0->x) * (c2->y - c0->y) - (c2->x - c0->x) * (c1->y - c0->y);
+    int front = area < 0;
+    if (area == 0 || (d->cull == SRAST_CULL_BACK && !front) || (d->cull == SRAST_CULL_FRONT && front)) {
+        r->stats.culled++;
+        return SRAST_OK;
+    }
+    srast_corner* c[3] = { c0, c1, c2 };
+    if (area < 0) {
+        c[1] = c2;
+        c[2] = c1;
+    }
+
+    int64_t min_x = c0->x, max_x = c0->x, min_y = c0->y, max_y = c0->y;
+    for (int i = 1; i < 3; i++) {
+        if (c[i]->x < min_x) min_x = c[i]->x;
+        if (c[i]->x > max_x) max_x = c[i]->x;
+        if (c[i]->y < min_y) min_y = c[i]->y;
+        if (c[i]->y > max_y) max_y = c[i]->y;
+    }
+    // Pixels whose centre (x * 16 + 8) lies in the box
+    min_x = -srast_floor16(-(min_x - 8));
+    min_y = -srast_floor16(-(min_y - 8));
+    max_x = srast_floor16(max_x - 8);
+    max_y = srast_floor16(max_y - 8);
+    if (min_x < 0) min_x = 0;
+    if (min_y < 0) min_y = 0;
+    if (max_x > (int64_t)r->width - 1) max_x = (int64_t)r->width - 1;
+    if (max_y > (int64_t)r->height - 1) max_y = (int64_t)r->height - 1;
+    if (min_x > max_x || min_y > max_y) {
+        r->stats.culled++;
+        return SRAST_OK;
+    }
+
+    if (r->tri_count == r->tri_capacity) {
+        uint32_t capacity = r->tri_capacity ? r->tri_capacity * 2 : 1024;
+        srast_tri* tris = (srast_tri*)realloc(r->tris, capacity * sizeof(srast_tri));
+        if (!tris) return SRAST_ERR_MEMORY;
+        r->tris = tris;
+        r->tri_capacity = capacity;
+    }
+    srast_tri* t = &r->tris[r->tri_count];
+    t->min_x = (int32_t)min_x;
+    t->min_y = (int32_t)min_y;
+    t->max_x = (int32_t)max_x;
+    t->max_y = (int32_t)max_y;
+    t->draw = draw;
+
+    // Edge from corner i to the next, positive inside now that the area is positive. Edges that are neither top nor
+    // left exclude pixel centres lying exactly on them.
+    for (int i = 0; i < 3; i++) {
+        const srast_corner* j = c[i];
+        const srast_corner* k = c[(i + 1) % 3];
+        int64_t a = j->y - k->y, b = k->x - j->x;
+        int top_left = a > 0 || (a == 0 && b > 0);
+        t->step_x[i] = a * SRAST_SUBPIXEL;
+        t->step_y[i] = b * SRAST_SUBPIXEL;
+        t->base[i] = -(a * j->x + b * j->y) + a * (SRAST_SUBPIXEL / 2) + b * (SRAST_SUBPIXEL / 2) - (top_left ? 0 : 1);
+    }
+
+    float fx[3], fy[3];
+    for (int i = 0; i < 3; i++) {
+        srast_corner* corner = c[i];
+        if (corner->vertex != SRAST_NO_VERTEX) {
+            float u, v, color[4], q = corner->value[SRAST_P_Q];
+            srast_fetch(d, corner->vertex, &u, &v, color);
+            corner->value[SRAST_P_U] = u * q;
+            corner->value[SRAST_P_V] = v * q;
+            for (int k = 0; k < 4; k++) corner->value[SRAST_P_R + k] = color[k] * q;
+            corner->vertex = SRAST_NO_VERTEX;
+        }
+        fx[i] = (float)corner->x * (1.0f / SRAST_SUBPIXEL);
+        fy[i] = (float)corner->y * (1.0f / SRAST_SUBPIXEL);
+    }
+
+    // Planes from the snapped positions, so interpolation agrees with coverage
+    float dx1 = fx[1] - fx[0], dy1 = fy[1] - fy[0], dx2 = fx[2] - fx[0], dy2 = fy[2] - fy[0];
+    float inverse = 1.0f / (dx1 * dy2 - dx2 * dy1);
+    float ox = (float)min_x + 0.5f - fx[0], oy = (float)min_y + 0.5f - fy[0];
+    for (int p = 0; p < SRAST_PLANES; p++) {
+        float d0 = c[0]->value[p], d1 = c[1]->value[p] - d0, d2 = c[2]->value[p] - d0;
+        float ddx = (d1 * dy2 - d2 * dy1) * inverse;
+        float ddy = (d2 * dx1 - d1 * dx2) * inverse;
+        t->plane[p][0] = d0 + ddx * ox + ddy * oy;
+        t->plane[p][1] = ddx;
+        t->plane[p][2] = ddy;
+    }
+    float min_depth = c0->value[SRAST_P_DEPTH];
+    if (c1->value[SRAST_P_DEPTH] < min_depth) min_depth = c1->value[SRAST_P_DEPTH];
+    if (c2->value[SRAST_P_DEPTH] < min_depth) min_depth = c2->value[SRAST_P_DEPTH];
+    t->min_depth = min_depth;
+
+    // Tiles in the box; for triangles over more than a couple of tiles, skip tiles wholly outside an edge
+    uint32_t tri = r->tri_count++;
+    uint32_t tx0 = (uint32_t)min_x / SRAST_TILE, tx1 = (uint32_t)max_x / SRAST_TILE;
+    uint32_t ty0 = (uint32_t)min_y / SRAST_TILE, ty1 = (uint32_t)max_y / SRAST_TILE;
+    int test = (tx1 - tx0 + 1) * (ty1 - ty0 + 1) > 4;
+    for (uint32_t ty = ty0; ty <= ty1; ty++)
+        for (uint32_t tx = tx0; tx <= tx1; tx++) {
+            if (test) {
+                int64_t x0 = tx * SRAST_TILE, y0 = ty * SRAST_TILE, x1 = x0 + SRAST_TILE - 1, y1 = y0 + SRAST_TILE - 1;
+                int outside = 0;
+                for (int i = 0; i < 3 && !outside; i++)
+                    outside = t->step_x[i] * (t->step_x[i] > 0 ? x1 : x0) + t->step_y[i] * (t->step_y[i] > 0 ? y1 : y0) +
+                              t->base[i] < 0;
+                if (outside) continue;
+            }
+            if (srast_bin_push(&r->bins[ty * r->tiles_x + tx], tri) != SRAST_OK) return SRAST_ERR_MEMORY;
+            r->stats.binned++;
+        }
+    return SRAST_OK;
+}
+
+// Indices may sit at any alignment, as ACT tables do
+static uint32_t srast_index(const srast_draw* d, uint32_t i)
+{
+    if (d->index_size == 4) {
+        uint32_t index;
+        memcpy(&index, (const uint8_t*)d->indices + (size_t)i * 4, sizeof(index));
+        return index;
+    }
+    uint16_t index;
+    memcpy(&index, (const uint8_t*)d->indices + (size_t)i * 2, sizeof(index));
+    return index;
+}
+
+static int srast_triangle(srast_context* r, const srast_draw* d, uint32_t draw, uint32_t face)
+{
+    uint32_t stride = r->vertex_capacity;
+    uint32_t index[3] = { srast_index(d, face * 3), srast_index(d, face * 3 + 1), srast_index(d, face * 3 + 2) };
+    r->stats.triangles++;
+    if (index[0] >= d->vertex_count || index[1] >= d->vertex_count || index[2] >= d->vertex_count) {
+        r->stats.culled++;
+        return SRAST_OK;
+    }
+    uint32_t o0 = r->outcode[index[0]], o1 = r->outcode[index[1]], o2 = r->outcode[index[2]];
+    if (o0 & o1 & o2 & SRAST_OUT_FRUSTUM) {
+        r->stats.culled++;
+        return SRAST_OK;
+    }
+
+    // Most triangles use the vertices as projected by srast_transform
+    if (!((o0 | o1 | o2) & (SRAST_OUT_NEAR | SRAST_OUT_GUARD))) {
+        srast_corner c[3];
+        for (int i = 0; i < 3; i++) {
+            c[i].x = r->snapped[index[i]];
+            c[i].y = r->snapped[stride + index[i]];
+            c[i].value[SRAST_P_DEPTH] = r->projected[index[i]];
+            c[i].value[SRAST_P_Q] = r->projected[stride + index[i]];
+            c[i].vertex = index[i];
+        }
+        return srast_setup(r, d, draw, &c[0], &c[1], &c[2]);
+    }
+
+    r->stats.clipped++;
+    srast_vertex poly[SRAST_MAX_CLIPPED];
+    for (int i = 0; i < 3; i++) {
+        poly[i].x = r->clip[index[i]];
+        poly[i].y = r->clip[stride + index[i]];
+        poly[i].z = r->clip[stride * 2 + index[i]];
+        poly[i].w = r->clip[stride * 3 + index[i]];
+        srast_fetch(d, index[i], &poly[i].u, &poly[i].v, poly[i].c);
+    }
+    int count = srast_clip(poly, 3);
+    if (count < 3) {
+        r->stats.culled++;
+        return SRAST_OK;
+    }
+    srast_corner c[SRAST_MAX_CLIPPED];
+    for (int i = 0; i < count; i++) {
+        const srast_vertex* v = &poly[i];
+        srast_project(r, v->x, v->y, v->z, v->w, &c[i]);
+        float q = c[i].value[SRAST_P_Q];
+        c[i].value[SRAST_P_U] = v->u * q;
+        c[i].value[SRAST_P_V] = v->v * q;
+        for (int k = 0; k < 4; k++) c[i].value[SRAST_P_R + k] = v->c[k] * q;
+        c[i].vertex = SRAST_NO_VERTEX;
+    }
+    // The fan's triangles count on their own from here
+    r->stats.triangles += (uint32_t)count - 3;
+    for (int i = 1; i + 1 < count; i++) {
+        int status = srast_setup(r, d, draw, &c[0], &c[i], &c[i + 1]);
+        if (status != SRAST_OK) return status;
+    }
+    return SRAST_OK;
+}
+
+// Clip-space positions for every vertex, then outcodes, and the projection of each vertex that needs no clipping
+static void srast_transform(srast_context* r, const srast_draw* d)
+{
+    const float* m = d->mvp;
+    uint32_t n = d->vertex_count, stride = r->vertex_capacity, v = 0;
+    float* out[4] = { r->clip, r->clip + stride, r->clip + stride * 2, r->clip + stride * 3 };
+    srast_v column[4][4];
+    for (int c = 0; c < 4; c++)
+        for (int row = 0; row < 4; row++) column[c][row] = SRAST_SET(m[c * 4 + row]);
+    for (; v + SRAST_LANES <= n; v += SRAST_LANES) {
+        srast_v x = SRAST_LOAD(d->x + v), y = SRAST_LOAD(d->y + v), z = SRAST_LOAD(d->z + v);
+        for (int row = 0; row < 4; row++)
+            SRAST_STORE(out[row] + v, SRAST_ADD(SRAST_ADD(SRAST_ADD(SRAST_MUL(column[0][row], x), SRAST_MUL(column[1][row], y)),
+                                                           SRAST_MUL(column[2][row], z)), column[3][row]));
+    }
+    for (; v < n; v++)
+        for (int row = 0; row < 4; row++)
+            out[row][v] = m[row] * d->x[v] + m[4 + row] * d->y[v] + m[8 + row] * d->z[v] + m[12 + row];
+
+    for (v = 0; v < n; v++) {
+        uint32_t code = srast_outcode(out[0][v], out[1][v], out[2][v], out[3][v]);
+        r->outcode[v] = (uint8_t)code;
+        if (code & (SRAST_OUT_NEAR | SRAST_OUT_GUARD)) continue;
+        srast_corner c;
+        srast_project(r, out[0][v], out[1][v], out[2][v], out[3][v], &c);
+        r->snapped[v] = (int32_t)c.x;
+        r->snapped[stride + v] = (int32_t)c.y;
+        r->projected[v] = c.value[SRAST_P_DEPTH];
+        r->projected[stride + v] = c.value[SRAST_P_Q];
+    }
+}
+
+int srast_submit(srast_context* r, const srast_draw* draw)
+{
+    if (r->vertex_capacity < draw->vertex_count) {
+        uint32_t capacity = (draw->vertex_count + 3) & ~3u;
+        // clip x, y, z, w, snapped x, y, depth, q, then the outcodes
+        float* storage = (float*)malloc((size_t)capacity * (8 * sizeof(float) + 1));
+        if (!storage) return SRAST_ERR_MEMORY;
+        free(r->clip);
+        r->clip = storage;
+        r->snapped = (int32_t*)(storage + (size_t)capacity * 4);
+        r->projected = storage + (size_t)capacity * 6;
+        r->outcode = (uint8_t*)(storage + (size_t)capacity * 8);
+        r->vertex_capacity = capacity;
+    }
+    if (r->draw_count == r->draw_capacity) {
+        uint32_t capacity = r->draw_capacity ? r->draw_capacity * 2 : 16;
+        srast_draw* draws = (srast_draw*)realloc(r->draws, capacity * sizeof(srast_draw));
+        if (!draws) return SRAST_ERR_MEMORY;
+        r->draws = draws;
+        r->draw_capacity = capacity;
+    }
+    uint32_t index = r->draw_count++;
+    srast_draw* d = &r->draws[index];
+    *d = *draw;
+    if (!d->shader) d->shader = srast_shade_modulate;
+
+    srast_transform(r, d);
+    uint32_t face_count = d->index_count / 3, range_count = d->ranges ? d->range_count : 1;
+    for (uint32_t k = 0; k < range_count; k++) {
+        uint32_t first = d->ranges ? d->ranges[k * 2] : 0;
+        uint32_t count = d->ranges ? d->ranges[k * 2 + 1] : face_count;
+        for (uint32_t f = first; f < face_count && f - first < count; f++) {
+            int status = srast_triangle(r, d, index, f);
+            if (status != SRAST_OK) return status;
+        }
+    }
+    return SRAST_OK;
+}
+
+// --- Rasterization, one tile at a time ---
+
+// Per-thread span storage, padded for whole SIMD steps
+typedef struct srast_scratch {
+    float depth[SRAST_TILE + 4];
+    float attribute[6][SRAST_TILE + 4];    // u, v, r, g, b, a
+    uint32_t out[SRAST_TILE];
+} srast_scratch;
+
+// Farthest depth of a block, after pixels in it were written
+static float srast_block_far(const srast_context* r, uint32_t bx, uint32_t by)
+{
+    uint32_t x0 = bx * SRAST_BLOCK, y0 = by * SRAST_BLOCK;
+    uint32_t x1 = x0 + SRAST_BLOCK < r->width ? x0 + SRAST_BLOCK : r->width;
+    uint32_t y1 = y0 + SRAST_BLOCK < r->height ? y0 + SRAST_BLOCK : r->height;
+    float far_depth = 0.0f;
+    for (uint32_t y = y0; y < y1; y++)
+        for (uint32_t x = x0; x < x1; x++) {
+            float d = r->depth[(size_t)y * r->width + x];
+            if (d > far_depth) far_depth = d;
+        }
+    return far_depth;
+}
+
+// Interpolates one span: depth for the test over [first, first + count), attributes only once the mask is known
+static void srast_interpolate_depth(const srast_tri* t, int y, int first, uint32_t count, float* depth)
+{
+    const float* p = t->plane[SRAST_P_DEPTH];
+    float row = p[0] + p[2] * (float)(y - t->min_y);
+    srast_v base = SRAST_SET(row), step = SRAST_SET(p[1]);
+    for (uint32_t i = 0; i < count; i += SRAST_LANES)
+        SRAST_STORE(depth + i, SRAST_ADD(base, SRAST_MUL(step, SRAST_RAMP((float)(first + (int)i - t->min_x)))));
+}
+
+static void srast_interpolate_attributes(const srast_tri* t, int y, int first, uint32_t count, srast_scratch* s)
+{
+    float dy = (float)(y - t->min_y);
+    const float* q = t->plane[SRAST_P_Q];
+    srast_v q_row = SRAST_SET(q[0] + q[2] * dy), q_step = SRAST_SET(q[1]), one = SRAST_SET(1.0f);
+    srast_v rows[6], steps[6];
+    for (int a = 0; a < 6; a++) {
+        const float* p = t->plane[SRAST_P_U + a];
+        rows[a] = SRAST_SET(p[0] + p[2] * dy);
+        steps[a] = SRAST_SET(p[1]);
+    }
+    for (uint32_t i = 0; i < count; i += SRAST_LANES) {
+        srast_v dx = SRAST_RAMP((float)(first + (int)i - t->min_x));
+        srast_v w = SRAST_DIV(one, SRAST_ADD(q_row, SRAST_MUL(q_step, dx)));
+        for (int a = 0; a < 6; a++) SRAST_STORE(s->attribute[a] + i, SRAST_MUL(SRAST_ADD(rows[a], SRAST_MUL(steps[a], dx)), w));
+    }
+}
+
+static void srast_tile(srast_context* r, uint32_t tile, srast_stats* stats, srast_scratch* s)
+{
+    const srast_bin* bin = &r->bins[tile];
+    int tx0 = (int)(tile % r->tiles_x) * SRAST_TILE, ty0 = (int)(tile / r->tiles_x) * SRAST_TILE;
+    int tx1 = tx0 + SRAST_TILE < (int)r->width ? tx0 + SRAST_TILE - 1 : (int)r->width - 1;
+    int ty1 = ty0 + SRAST_TILE < (int)r->height ? ty0 + SRAST_TILE - 1 : (int)r->height - 1;
+    uint32_t bx0 = (uint32_t)tx0 / SRAST_BLOCK, by0 = (uint32_t)ty0 / SRAST_BLOCK;
+
+    for (uint32_t n = 0; n < bin->count; n++) {
+        const srast_tri* t = &r->tris[bin->items[n]];
+        if (t->min_depth >= r->tile_far[tile]) {
+            stats->tiles_rejected++;
+            continue;
+        }
+        int x0 = t->min_x > tx0 ? t->min_x : tx0, x1 = t->max_x < tx1 ? t->max_x : tx1;
+        int y0 = t->min_y > ty0 ? t->min_y : ty0, y1 = t->max_y < ty1 ? t->max_y : ty1;
+
+        // Blocks: 0 skipped (behind, or outside an edge), 1 partly covered, 2 wholly inside every edge
+        uint8_t state[SRAST_TILE_BLOCKS][SRAST_TILE_BLOCKS];
+        for (int by = y0 / SRAST_BLOCK; by <= y1 / SRAST_BLOCK; by++)
+            for (int bx = x0 / SRAST_BLOCK; bx <= x1 / SRAST_BLOCK; bx++) {
+                uint8_t* st = &state[by - (int)by0][bx - (int)bx0];
+                if (t->min_depth >= r->block_far[(size_t)by * r->blocks_x + bx]) {
+                    stats->blocks_rejected++;
+                    *st = 0;
+                    continue;
+                }
+                int64_t px0 = bx * SRAST_BLOCK > x0 ? bx * SRAST_BLOCK : x0, py0 = by * SRAST_BLOCK > y0 ? by * SRAST_BLOCK : y0;
+                int64_t px1 = bx * SRAST_BLOCK + SRAST_BLOCK - 1 < x1 ? bx * SRAST_BLOCK + SRAST_BLOCK - 1 : x1;
+                int64_t py1 = by * SRAST_BLOCK + SRAST_BLOCK - 1 < y1 ? by * SRAST_BLOCK + SRAST_BLOCK - 1 : y1;
+                *st = 2;
+                for (int i = 0; i < 3; i++) {
+                    int64_t sx = t->step_x[i], sy = t->step_y[i];
+                    int64_t best = sx * (sx > 0 ? px1 : px0) + sy * (sy > 0 ? py1 : py0) + t->base[i];
+                    int64_t worst = sx * (sx > 0 ? px0 : px1) + sy * (sy > 0 ? py0 : py1) + t->base[i];
+                    if (best < 0) {
+                        *st = 0;
+                        break;
+                    }
+                    if (worst < 0) *st = 1;
+                }
+            }
+
+        const srast_draw* draw = &r->draws[t->draw];
+        uint32_t written = 0;    // blocks of this tile with pixels written, one bit each
+        for (int y = y0; y <= y1; y++) {
+            // Coverage over the tile's columns, bit 0 at tx0
+            uint32_t mask = 0;
+            int64_t row[3];
+            for (int i = 0; i < 3; i++) row[i] = t->step_x[i] * x0 + t->step_y[i] * y + t->base[i];
+            const uint8_t* states = state[y / SRAST_BLOCK - (int)by0];
+            for (int x = x0; x <= x1; x++) {
+                uint8_t st = states[x / SRAST_BLOCK - (int)bx0];
+                int64_t dx = x - x0;
+                if (st == 2 || (st == 1 && (row[0] + t->step_x[0] * dx) >= 0 && (row[1] + t->step_x[1] * dx) >= 0 &&
+                                (row[2] + t->step_x[2] * dx) >= 0))
+                    mask |= 1u << (x - tx0);
+            }
+            if (!mask) continue;
+
+            // Early depth test over the covered run
+            int first = tx0, last = tx0 + SRAST_TILE - 1;
+            while (!(mask & (1u << (first - tx0)))) first++;
+            while (!(mask & (1u << (last - tx0)))) last--;
+            uint32_t count = (uint32_t)(last - first + 1);
+            mask >>= first - tx0;
+            srast_interpolate_depth(t, y, first, count, s->depth);
+            float* zbuffer = r->depth + (size_t)y * r->width + first;
+            for (uint32_t i = 0; i < count; i++)
+                if (!(s->depth[i] < zbuffer[i])) mask &= ~(1u << i);
+            if (!mask) continue;
+
+            srast_interpolate_attributes(t, y, first, count, s);
+            srast_span span;
+            span.x = first;
+            span.y = y;
+            span.count = count;
+            span.mask = mask;
+            span.u = s->attribute[0];
+            span.v = s->attribute[1];
+            span.r = s->attribute[2];
+            span.g = s->attribute[3];
+            span.b = s->attribute[4];
+            span.a = s->attribute[5];
+            span.depth = s->depth;
+            span.out = s->out;
+            span.draw = draw;
+            draw->shader(&span);
+            stats->spans++;
+
+            uint32_t* pixels = r->color + (size_t)y * r->width + first;
+            for (uint32_t i = 0; i < count; i++)
+                if (span.mask & (1u << i)) {
+                    pixels[i] = s->out[i];
+                    zbuffer[i] = s->depth[i];
+                    stats->pixels++;
+                    written |= 1u << ((y / SRAST_BLOCK - (int)by0) * SRAST_TILE_BLOCKS + (first + (int)i) / SRAST_BLOCK - (int)bx0);
+                }
+        }
+
+        if (written) {
+            for (uint32_t b = 0; b < SRAST_TILE_BLOCKS * SRAST_TILE_BLOCKS; b++)
+                if (written & (1u << b)) {
+                    uint32_t bx = bx0 + b % SRAST_TILE_BLOCKS, by = by0 + b / SRAST_TILE_BLOCKS;
+                    r->block_far[(size_t)by * r->blocks_x + bx] = srast_block_far(r, bx, by);
+                }
+            float tile_far = 0.0f;
+            for (uint32_t by = by0; by <= (uint32_t)ty1 / SRAST_BLOCK; by++)
+                for (uint32_t bx = bx0; bx <= (uint32_t)tx1 / SRAST_BLOCK; bx++)
+                    if (r->block_far[(size_t)by * r->blocks_x + bx] > tile_far) tile_far = r->block_far[(size_t)by * r->blocks_x + bx];
+            r->tile_far[tile] = tile_far;
+        }
+    }
+}
+
+// Takes tiles from the current frame until none are left. Called and returns with the lock held.
+static void srast_drain(srast_context* r)
+{
+    srast_stats stats;
+    memset(&stats, 0, sizeof(stats));
+    srast_scratch scratch;
+    while (r->next_tile < r->tile_count) {
+        uint32_t tile = r->next_tile++;
+        if (r->bins[tile].count == 0) continue;
+        srast_unlock(r);
+        srast_tile(r, tile, &stats, &scratch);
+        srast_lock(r);
+    }
+    r->stats.tiles_rejected += stats.tiles_rejected;
+    r->stats.blocks_rejected += stats.blocks_rejected;
+    r->stats.spans += stats.spans;
+    r->stats.pixels += stats.pixels;
+}
+
+static void srast_worker(srast_context* r)
+{
+    srast_lock(r);
+    uint32_t seen = r->generation;
+    for (;;) {
+        while (!r->quit && r->generation == seen) srast_wait(r, &r->wake);
+        if (r->quit) break;
+        // A worker that wakes late may find a newer frame, or no tiles left; either is fine
+        seen = r->generation;
+        r->busy++;
+        srast_drain(r);
+        if (--r->busy == 0) srast_wake_all(&r->done);
+    }
+    srast_unlock(r);
+}
+
+#if defined(_WIN32)
+static DWORD WINAPI srast_thread(LPVOID arg) { srast_worker((srast_context*)arg); return 0; }
+#else
+static void* srast_thread(void* arg) { srast_worker((srast_context*)arg); return NULL; }
+#endif
+
+void srast_end(srast_context* r)
+{
+    srast_lock(r);
+    r->next_tile = 0;
+    r->generation++;
+    if (r->thread_count > 1 && r->tri_count > 0) srast_wake_all(&r->wake);
+
+    // The caller works too, then waits for whoever is still finishing a tile
+    srast_drain(r);
+    while (r->busy > 0) srast_wait(r, &r->done);
+    srast_unlock(r);
+}
+
+// --- Context ---
+
+srast_context* srast_create(uint32_t width, uint32_t height, uint32_t threads)
+{
+    if (width == 0 || height == 0 || width > 16384 || height > 16384) return NULL;
+    srast_context* r = (srast_context*)calloc(1, sizeof(srast_context));
+    if (!r) return NULL;
+    r->width = width;
+    r->height = height;
+    r->tiles_x = (width + SRAST_TILE - 1) / SRAST_TILE;
+    r->tiles_y = (height + SRAST_TILE - 1) / SRAST_TILE;
+    r->tile_count = r->tiles_x * r->tiles_y;
+    r->blocks_x = r->tiles_x * SRAST_TILE_BLOCKS;
+    r->blocks_y = r->tiles_y * SRAST_TILE_BLOCKS;
+    r->color = (uint32_t*)malloc((size_t)width * height * sizeof(uint32_t));
+    r->depth = (float*)malloc((size_t)width * height * sizeof(float));
+    r->block_far = (float*)malloc((size_t)r->blocks_x * r->blocks_y * sizeof(float));
+    r->tile_far = (float*)malloc(r->tile_count * sizeof(float));
+    r->bins = (srast_bin*)calloc(r->tile_count, sizeof(srast_bin));
+    if (!r->color || !r->depth || !r->block_far || !r->tile_far || !r->bins) {
+        free(r->color);
+        free(r->depth);
+        free(r->block_far);
+        free(r->tile_far);
+        free(r->bins);
+        free(r);
+        return NULL;
+    }
+
+    r->thread_count = threads > 1 ? threads : 1;
+#if defined(_WIN32)
+    InitializeCriticalSection(&r->lock);
+    InitializeConditionVariable(&r->wake);
+    InitializeConditionVariable(&r->done);
+    r->threads = (HANDLE*)calloc(r->thread_count, sizeof(HANDLE));
+    if (!r->threads) r->thread_count = 1;
+    for (uint32_t t = 1; t < r->thread_count; t++) r->threads[t] = CreateThread(NULL, 0, srast_thread, r, 0, NULL);
+#else
+    pthread_mutex_init(&r->lock, NULL);
+    pthread_cond_init(&r->wake, NULL);
+    pthread_cond_init(&r->done, NULL);
+    r->threads = (pthread_t*)calloc(r->thread_count, sizeof(pthread_t));
+    r->started = (int*)calloc(r->thread_count, sizeof(int));
+    if (!r->threads || !r->started) r->thread_count = 1;
+    for (uint32_t t = 1; t < r->thread_count; t++) r->started[t] = pthread_create(&r->threads[t], NULL, srast_thread, r) == 0;
+#endif
+    srast_begin(r, 0xFF000000u, 1.0f);
+    return r;
+}
+
+void srast_destroy(srast_context* r)
+{
+    if (!r) return;
+    srast_lock(r);
+    r->quit = 1;
+    srast_wake_all(&r->wake);
+    srast_unlock(r);
+
+    for (uint32_t t = 1; t < r->thread_count; t++) {
+#if defined(_WIN32)
+        if (r->threads[t]) {
+            WaitForSingleObject(r->threads[t], INFINITE);
+            CloseHandle(r->threads[t]);
+        }
+#else
+        if (r->started[t]) pthread_join(r->threads[t], NULL);
+#endif
+    }
+
+#if defined(_WIN32)
+    DeleteCriticalSection(&r->lock);
+#else
+    pthread_cond_destroy(&r->done);
+    pthread_cond_destroy(&r->wake);
+    pthread_mutex_destroy(&r->lock);
+    free(r->started);
+#endif
+    free(r->threads);
+    for (uint32_t i = 0; i < r->tile_count; i++) free(r->bins[i].items);
+    free(r->bins);
+    free(r->tris);
+    free(r->draws);
+    free(r->clip);
+    free(r->color);
+    free(r->depth);
+    free(r->block_far);
+    free(r->tile_far);
+    free(r);
+}
+
+void srast_begin(srast_context* r, uint32_t clear_color, float clear_depth)
+{
+    size_t pixels = (size_t)r->width * r->height;
+    for (size_t i = 0; i < pixels; i++) {
+        r->color[i] = clear_color;
+        r->depth[i] = clear_depth;
+    }
+    for (size_t i = 0; i < (size_t)r->blocks_x * r->blocks_y; i++) r->block_far[i] = clear_depth;
+    for (uint32_t i = 0; i < r->tile_count; i++) {
+        r->tile_far[i] = clear_depth;
+        r->bins[i].count = 0;
+    }
+    r->tri_count = 0;
+    r->draw_count = 0;
+    memset(&r->stats, 0, sizeof(r->stats));
+}
+
+const uint32_t* srast_color(const srast_context* r) { return r->color; }
+const float* srast_depth(const srast_context* r) { return r->depth; }
+void srast_get_stats(const srast_context* r, srast_stats* stats) { *stats = r->stats; }
+
+// --- Shading ---
+
+// Wraps a texel coordinate into 0..size-1; one division, none for power-of-two sizes
+static uint32_t srast_wrap(int i, uint32_t size)
+{
+    if ((size & (size - 1)) == 0) return (uint32_t)i & (size - 1);
+    int m = i % (int)size;
+    return (uint32_t)(m < 0 ? m + (int)size : m);
+}
+
+uint32_t srast_sample(const srast_texture* t, float u, float v)
+{
+    u -= floorf(u);
+    v -= floorf(v);
+    float fx = u * (float)t->width, fy = v * (float)t->height;
+    if (!t->bilinear) return t->texels[(size_t)srast_wrap((int)fy, t->height) * t->width + srast_wrap((int)fx, t->width)];
+
+    fx -= 0.5f;
+    fy -= 0.5f;
+    float x0 = floorf(fx), y0 = floorf(fy);
+    float ax = fx - x0, ay = fy - y0;
+    uint32_t ix0 = srast_wrap((int)x0, t->width), iy0 = srast_wrap((int)y0, t->height);
+    uint32_t ix1 = ix0 + 1 < t->width ? ix0 + 1 : 0, iy1 = iy0 + 1 < t->height ? iy0 + 1 : 0;
+    const uint32_t* row0 = t->texels + (size_t)iy0 * t->width;
+    const uint32_t* row1 = t->texels + (size_t)iy1 * t->width;
+    uint32_t c00 = row0[ix0], c10 = row0[ix1], c01 = row1[ix0], c11 = row1[ix1];
+    uint32_t out = 0;
+    for (int k = 0; k < 32; k += 8) {
+        float top = (float)((c00 >> k) & 255) + ((float)((c10 >> k) & 255) - (float)((c00 >> k) & 255)) * ax;
+        float bottom = (float)((c01 >> k) & 255) + ((float)((c11 >> k) & 255) - (float)((c01 >> k) & 255)) * ax;
+        out |= (uint32_t)(top + (bottom - top) * ay + 0.5f) << k;
+    }
+    return out;
+}
+
+void srast_shade_modulate(srast_span* s)
+{
+    const srast_draw* d = s->draw;
+    const srast_texture* texture = d->texture;
+    for (uint32_t i = 0; i < s->count; i++) {
+        if (!(s->mask & (1u << i))) continue;
+        float c[4] = { s->r[i], s->g[i], s->b[i], s->a[i] };
+        if (texture) {
+            uint32_t texel = srast_sample(texture, s->u[i], d->v_up ? 1.0f - s->v[i] : s->v[i]);
+            for (int k = 0; k < 4; k++) c[k] *= (float)((texel >> (8 * k)) & 255) * (1.0f / 255.0f);
+        }
+        s->out[i] = srast_pack(c);
+    }
+}
+
+void srast_shade_pixels(srast_span* s, void (*pixel)(const srast_fragment* in, float rgba[4]))
+{
+    srast_fragment f;
+    f.y = s->y;
+    f.draw = s->draw;
+    for (uint32_t i = 0; i < s->count; i++) {
+        if (!(s->mask & (1u << i))) continue;
+        f.x = s->x + (int)i;
+        f.u = s->u[i];
+        f.v = s->draw->v_up ? 1.0f - s->v[i] : s->v[i];
+        f.color[0] = s->r[i];
+        f.color[1] = s->g[i];
+        f.color[2] = s->b[i];
+        f.color[3] = s->a[i];
+        f.depth = s->depth[i];
+        float rgba[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+        pixel(&f, rgba);
+        s->out[i] = srast_pack(rgba);
+    }
+}
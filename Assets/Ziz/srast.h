@@ -0,0 +1,148 @@
+#ifndef SRAST_H
+#define SRAST_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Software rasterizer: the reference renderer for exported scenes on machines without a GPU.
+//
+//   srast_context* r = srast_create(640, 360, 4);
+//   every frame:
+//     srast_begin(r, 0xFF000000u, 1.0f);
+//     srast_draw draw;
+//     srast_draw_defaults(&draw);
+//     draw.x = level.pos_x; ...; cam0_view_proj(&pose, aspect, near, far, draw.mvp);
+//     srast_submit(r, &draw);                   // transforms, clips and bins now; the arrays may change afterwards
+//     srast_end(r);                             // rasterizes and shades every tile
+//     srast_color(r)                            // width * height RGBA8888, row 0 at the top
+//
+// Submitting transforms vertices four at a time with SSE where available, clips against the near plane (and a wide
+// guard band, so nothing else needs clipping), culls, snaps to 1/16 pixel and bins each triangle into the 32x32 tiles
+// its edges reach. srast_end hands tiles to the pool, one thread per tile at a time, so tiles need no locks and every
+// tile draws its triangles in submission order. Within a tile, coverage uses integer edge functions with the top-left
+// rule (shared edges are drawn exactly once), and a two-level hierarchical Z (farthest depth per tile and per 8x8 block)
+// drops triangles and blocks that lie behind what is already drawn before any pixel is tested.
+//
+// Surviving pixels reach the shader as spans: a run of one tile row with a mask of the pixels that passed coverage and
+// the depth test, and per-pixel attributes interpolated perspective-correct (u, v and vertex color) plus depth. Depth
+// is tested before shading and written after it, for the pixels still in the mask; shaders may clear bits to discard.
+// srast_shade_modulate covers the Actor modes (texture times vertex color, with vlit supplying the lit color or the
+// MatCap uv); srast_shade_pixels adapts a per-pixel function such as a wrapper around a generated ShaderMain.
+//
+// Clip space follows OpenGL (cam0_view_proj): front faces are counter-clockwise in exported space, as EMU levels and
+// ACT/RAT meshes are written.
+
+#define SRAST_TILE 32                // tile edge, pixels
+#define SRAST_BLOCK 8                // hierarchical Z block edge, pixels
+
+typedef struct srast_texture {
+    uint32_t width, height;
+    const uint32_t* texels;      // RGBA8888, r in the low byte, rows top-down
+    int bilinear;                // otherwise nearest (EMU5_FLAG_NEAREST_FILTER levels)
+} srast_texture;
+
+typedef enum srast_cull {
+    SRAST_CULL_BACK = 0,
+    SRAST_CULL_NONE,
+    SRAST_CULL_FRONT
+} srast_cull;
+
+typedef struct srast_draw srast_draw;
+
+typedef struct srast_span {
+    int x, y;                    // first pixel
+    uint32_t count;              // pixels, at most SRAST_TILE
+    uint32_t mask;               // bit i: pixel x + i passed coverage and depth; clear bits to discard
+    const float *u, *v;          // per pixel, perspective-correct
+    const float *r, *g, *b, *a;  // vertex color 0..1, perspective-correct
+    const float* depth;          // 0 at the near plane, 1 at the far plane
+    uint32_t* out;               // RGBA8888 results; only masked pixels reach the framebuffer
+    const srast_draw* draw;      // texture, v_up and user of the draw being shaded
+} srast_span;
+
+typedef void (*srast_shader)(srast_span* span);
+
+struct srast_draw {
+    uint32_t vertex_count;
+    const float *x, *y, *z;      // positions, transformed by mvp
+    const float* uv;             // u, v pairs; NULL for none
+    const uint32_t* color;       // RGBA8888 per vertex; NULL for white
+    const void* indices;         // three per triangle, native byte order, any alignment
+    uint32_t index_count;
+    uint32_t index_size;         // 2 (ACT) or 4 (EMU)
+    const uint32_t* ranges;      // first face, face count pairs (emu_cull's ranges); NULL draws every triangle
+    uint32_t range_count;
+    float mvp[16];               // column-major, clip = mvp * position
+    srast_cull cull;
+    int v_up;                    // v runs bottom to top (Unity, ACT, vlit's MatCap uv); EMU stores it flipped
+    const srast_texture* texture;    // NULL for untextured; must live until srast_end
+    srast_shader shader;         // NULL for srast_shade_modulate
+    void* user;
+};
+
+typedef struct srast_stats {
+    uint32_t triangles;          // submitted
+    uint32_t culled;             // outside the frustum, back-facing, or too small to cover a sample
+    uint32_t clipped;            // crossed the near plane or the guard band
+    uint32_t binned;             // triangle-tile pairs
+    uint32_t tiles_rejected;     // triangle-tile pairs dropped by the tile's farthest depth
+    uint32_t blocks_rejected;    // triangle-block pairs dropped by the block's farthest depth
+    uint32_t spans;
+    uint64_t pixels;             // shaded and written
+} srast_stats;
+
+enum {
+    SRAST_OK = 0,
+    SRAST_ERR_MEMORY = -1
+};
+
+typedef struct srast_context srast_context;
+
+// NULL if out of memory or a size is 0. Up to threads threads rasterize, the caller's included.
+srast_context* srast_create(uint32_t width, uint32_t height, uint32_t threads);
+void srast_destroy(srast_context* context);
+
+void srast_draw_defaults(srast_draw* draw);
+
+// Starts a frame: clears color and depth and forgets the previous frame's triangles
+void srast_begin(srast_context* context, uint32_t clear_color, float clear_depth);
+
+// Transforms, clips, culls and bins a draw. SRAST_ERR_MEMORY drops the draw's remaining triangles.
+int srast_submit(srast_context* context, const srast_draw* draw);
+
+// Rasterizes and shades everything submitted since srast_begin
+void srast_end(srast_context* context);
+
+const uint32_t* srast_color(const srast_context* context);
+const float* srast_depth(const srast_context* context);
+void srast_get_stats(const srast_context* context, srast_stats* stats);
+
+// Texture times vertex color; the vertex color alone without a texture
+void srast_shade_modulate(srast_span* span);
+
+// RGBA8888 at (u, v), wrapping, v top-down; nearest or bilinear as the texture says
+uint32_t srast_sample(const srast_texture* texture, float u, float v);
+
+// One pixel's inputs for srast_shade_pixels
+typedef struct srast_fragment {
+    int x, y;
+    float u, v;                  // v top-down, whatever the draw's v_up
+    float color[4];
+    float depth;
+    const srast_draw* draw;
+} srast_fragment;
+
+// Runs pixel for every masked pixel of the span and packs its RGBA 0..1 result. ShaderGraphToCTranslator emits
+// void ShaderMain(float4* output) with no inputs (its UV and color nodes read NULL), so the adapter ignores the
+// fragment and every pixel of the draw gets the same color until the generator passes inputs through:
+//   static void shader_main_pixel(const srast_fragment* in, float rgba[4])
+//   {
+//       float4 out;
+//       (void)in;
+//       ShaderMain(&out);
+//       rgba[0] = out.x; rgba[1] = out.y; rgba[2] = out.z; rgba[3] = out.w;
+//   }
+//   static void shade(srast_span* s) { srast_shade_pixels(s, shader_main_pixel); }
+void srast_shade_pixels(srast_span* span, void (*pixel)(const srast_fragment* in, float rgba[4]));
+
+#endif
@@ -0,0 +1,589 @@
+// Renders exported scenes with srast and reports frames per second: an EMU v5 level (culled with emu_cull, flown
+// along a .cam track or orbited), an actor (.act plus the first .rat it names, decoded, lit with vlit and played back),
+// or with neither a built-in field of textured spheres over a floor. Textures are a checkerboard placeholder; the
+// exported PNGs are not decoded here. Any of -r, -l, -d or -z runs each frame through post as well: -r an emulated
+// resolution (e.g. 320x240), -l 1 bilinear filtering, -d color bits per channel with ordered dither, -z haze strength.
+//
+//   cc -O2 -I. srast_bench.c srast.c post.c texel.c vlit.c emu_cull.c emu5.c emu_pvs.c cam0.c ztime.c -lm -lpthread -o srast_bench
+//   ./srast_bench [-w width] [-h height] [-t threads] [-f frames] [-o last.ppm] [-r WxH] [-l filter] [-d bits]
+//                 [-z haze] [level.emu | actor.act] [path.cam]
+
+#include "cam0.h"
+#include "emu_cull.h"
+#include "post.h"
+#include "srast.h"
+#include "vlit.h"
+#include "ztime.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BENCH_PI 3.14159265f
+
+static uint32_t bench_u32(const uint8_t* p)
+{
+    return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+static float bench_f32(const uint8_t* p)
+{
+    uint32_t bits = bench_u32(p);
+    float f;
+    memcpy(&f, &bits, sizeof(f));
+    return f;
+}
+
+static uint8_t* bench_read_file(const char* path, size_t* size)
+{
+    FILE* f = fopen(path, "rb");
+    if (!f) return NULL;
+    fseek(f, 0, SEEK_END);
+    long length = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    uint8_t* data = length > 0 ? (uint8_t*)malloc((size_t)length) : NULL;
+    if (data && fread(data, 1, (size_t)length, f) != (size_t)length) {
+        free(data);
+        data = NULL;
+    }
+    fclose(f);
+    *size = data ? (size_t)length : 0;
+    return data;
+}
+
+static int bench_has_suffix(const char* s, const char* suffix)
+{
+    size_t n = strlen(s), m = strlen(suffix);
+    return n >= m && strcmp(s + n - m, suffix) == 0;
+}
+
+// out = a * b, column-major
+static void bench_mul(const float a[16], const float b[16], float out[16])
+{
+    for (int c = 0; c < 4; c++)
+        for (int r = 0; r < 4; r++)
+            out[c * 4 + r] = a[r] * b[c * 4] + a[4 + r] * b[c * 4 + 1] + a[8 + r] * b[c * 4 + 2] + a[12 + r] * b[c * 4 + 3];
+}
+
+// Looks at center from distance, turned yaw about y and tilted pitch downwards
+static void bench_orbit(cam0_pose* pose, const float center[3], float distance, float yaw, float pitch)
+{
+    float sy = sinf(yaw * 0.5f), cy = cosf(yaw * 0.5f), sx = sinf(-pitch * 0.5f), cx = cosf(-pitch * 0.5f);
+    pose->rot[0] = cy * sx;
+    pose->rot[1] = cx * sy;
+    pose->rot[2] = -sy * sx;
+    pose->rot[3] = cy * cx;
+    pose->pos[0] = center[0] + distance * cosf(pitch) * sinf(yaw);
+    pose->pos[1] = center[1] + distance * sinf(pitch);
+    pose->pos[2] = center[2] + distance * cosf(pitch) * cosf(yaw);
+    pose->fov = 60.0f;
+}
+
+static void bench_bounds(const float* x, const float* y, const float* z, uint32_t count, float center[3], float* radius)
+{
+    float lo[3] = { 1e30f, 1e30f, 1e30f }, hi[3] = { -1e30f, -1e30f, -1e30f };
+    const float* axis[3] = { x, y, z };
+    for (int a = 0; a < 3; a++)
+        for (uint32_t v = 0; v < count; v++) {
+            if (axis[a][v] < lo[a]) lo[a] = axis[a][v];
+            if (axis[a][v] > hi[a]) hi[a] = axis[a][v];
+        }
+    *radius = 0.0f;
+    for (int a = 0; a < 3; a++) {
+        center[a] = count ? (lo[a] + hi[a]) * 0.5f : 0.0f;
+        if (count && (hi[a] - lo[a]) * 0.5f > *radius) *radius = (hi[a] - lo[a]) * 0.5f;
+    }
+    if (*radius <= 0.0f) *radius = 1.0f;
+}
+
+// --- RAT playback: the delta stream decoded frame after frame, as Rat.Core.DecompressToFrame does ---
+
+typedef struct bench_rat {
+    uint8_t* file;
+    size_t size;
+    uint32_t vertex_count, frame_count, frame;
+    const uint8_t* widths;       // x[V], y[V], z[V]
+    const uint8_t* first;        // quantized first frame, x y z per vertex
+    const uint8_t* words;        // uint32 little-endian, read most significant bit first
+    uint32_t word_count;
+    uint64_t bit;
+    float bounds[6];             // RAT3: min xyz, max xyz
+    uint32_t cluster_count;
+    const uint8_t* cluster_bounds;    // RAT4: 6 floats per cluster
+    const uint8_t* cluster_ids;
+    uint8_t* q;                  // current frame, x y z per vertex
+} bench_rat;
+
+static int bench_rat_load(bench_rat* r, const char* path)
+{
+    memset(r, 0, sizeof(*r));
+    r->file = bench_read_file(path, &r->size);
+    if (!r->file || r->size < 64) return 0;
+    const uint8_t* h = r->file;
+    uint32_t magic = bench_u32(h);
+    if (magic != 0x33544152u && magic != 0x34544152u) return 0;
+    r->vertex_count = bench_u32(h + 4);
+    r->frame_count = bench_u32(h + 8);
+    uint32_t delta_offset = bench_u32(h + 16), widths_offset = bench_u32(h + 20);
+    for (int i = 0; i < 6; i++) r->bounds[i] = bench_f32(h + 32 + i * 4);
+    if (r->frame_count == 0 || delta_offset > r->size || widths_offset > r->size ||
+        (uint64_t)r->vertex_count * 6 > r->size - widths_offset)
+        return 0;
+    if (magic == 0x34544152u) {
+        if (r->size < 80) return 0;
+        r->cluster_count = bench_u32(h + 64);
+        uint32_t bounds_offset = bench_u32(h + 68), ids_offset = bench_u32(h + 72);
+        if (bounds_offset > r->size || (uint64_t)r->cluster_count * 24 > r->size - bounds_offset || ids_offset > r->size ||
+            r->vertex_count > r->size - ids_offset)
+            return 0;
+        r->cluster_bounds = h + bounds_offset;
+        r->cluster_ids = h + ids_offset;
+        for (uint32_t v = 0; v < r->vertex_count; v++)
+            if (r->cluster_ids[v] >= r->cluster_count) return 0;
+    }
+    r->widths = h + widths_offset;
+    r->first = h + widths_offset + r->vertex_count * 3;
+    r->words = h + delta_offset;
+    r->word_count = (uint32_t)((r->size - delta_offset) / 4);
+    r->q = (uint8_t*)malloc((size_t)r->vertex_count * 3 + 1);
+    if (!r->q) return 0;
+    memcpy(r->q, r->first, (size_t)r->vertex_count * 3);
+    return 1;
+}
+
+static void bench_rat_free(bench_rat* r)
+{
+    free(r->q);
+    free(r->file);
+}
+
+static uint32_t bench_rat_bits(bench_rat* r, uint32_t bits)
+{
+    uint32_t out = 0;
+    while (bits > 0) {
+        uint32_t used = (uint32_t)(r->bit & 31), take = 32 - used < bits ? 32 - used : bits;
+        uint64_t index = r->bit >> 5;
+        uint32_t word = index < r->word_count ? bench_u32(r->words + index * 4) : 0;
+        uint32_t part = (word << used) >> (32 - take);
+        out = take == 32 ? part : (out << take) | part;
+        r->bit += take;
+        bits -= take;
+    }
+    return out;
+}
+
+// Steps to the next frame, wrapping to the first after the last
+static void bench_rat_next(bench_rat* r)
+{
+    if (++r->frame >= r->frame_count) {
+        r->frame = 0;
+        r->bit = 0;
+        memcpy(r->q, r->first, (size_t)r->vertex_count * 3);
+        return;
+    }
+    uint32_t n = r->vertex_count;
+    for (uint32_t v = 0; v < n; v++)
+        for (int a = 0; a < 3; a++) {
+            uint32_t bits = r->widths[a * n + v];
+            if (bits == 0) continue;
+            uint32_t value = bench_rat_bits(r, bits);
+            if (value & (1u << (bits - 1))) value |= ~0u << bits;
+            r->q[v * 3 + a] = (uint8_t)(r->q[v * 3 + a] + value);
+        }
+}
+
+static void bench_rat_positions(const bench_rat* r, float* x, float* y, float* z)
+{
+    float* out[3] = { x, y, z };
+    for (uint32_t v = 0; v < r->vertex_count; v++) {
+        float box[6];
+        if (r->cluster_ids)
+            for (int i = 0; i < 6; i++) box[i] = bench_f32(r->cluster_bounds + (r->cluster_ids[v] * 6 + i) * 4);
+        else
+            memcpy(box, r->bounds, sizeof(box));
+        for (int a = 0; a < 3; a++) out[a][v] = box[a] + (float)r->q[v * 3 + a] / 255.0f * (box[3 + a] - box[a]);
+    }
+}
+
+// --- Scenes ---
+
+// UV sphere, rings x (2 * rings) quads, counter-clockwise seen from outside. Returns the index count.
+static uint32_t bench_sphere(uint32_t rings, float* x, float* y, float* z, float* uv, uint32_t* color, uint32_t* indices)
+{
+    uint32_t segments = rings * 2, n = 0;
+    for (uint32_t r = 0; r <= rings; r++)
+        for (uint32_t s = 0; s <= segments; s++) {
+            uint32_t v = r * (segments + 1) + s;
+            float theta = BENCH_PI * (float)r / (float)rings, phi = 2.0f * BENCH_PI * (float)s / (float)segments;
+            x[v] = sinf(theta) * cosf(phi);
+            y[v] = cosf(theta);
+            z[v] = sinf(theta) * sinf(phi);
+            uv[v * 2] = 4.0f * (float)s / (float)segments;
+            uv[v * 2 + 1] = 2.0f * (float)r / (float)rings;
+            color[v] = 0xFF000000u | (uint32_t)(128 + 127 * x[v]) | 204u << 8 | (uint32_t)(128 + 127 * z[v]) << 16;
+        }
+    for (uint32_t r = 0; r < rings; r++)
+        for (uint32_t s = 0; s < segments; s++) {
+            uint32_t a = r * (segments + 1) + s, b = a + segments + 1;
+            indices[n++] = a; indices[n++] = a + 1; indices[n++] = b;
+            indices[n++] = a + 1; indices[n++] = b + 1; indices[n++] = b;
+        }
+    return n;
+}
+
+static void bench_write_ppm(const char* path, const uint32_t* pixels, uint32_t width, uint32_t height)
+{
+    FILE* f = fopen(path, "wb");
+    if (!f) {
+        fprintf(stderr, "%s: cannot write\n", path);
+        return;
+    }
+    fprintf(f, "P6\n%u %u\n255\n", width, height);
+    for (size_t i = 0; i < (size_t)width * height; i++) {
+        uint8_t rgb[3] = { (uint8_t)pixels[i], (uint8_t)(pixels[i] >> 8), (uint8_t)(pixels[i] >> 16) };
+        fwrite(rgb, 1, 3, f);
+    }
+    fclose(f);
+}
+
+static void bench_usage(const char* name)
+{
+    fprintf(stderr,
+            "usage: %s [-w width] [-h height] [-t threads] [-f frames] [-o last.ppm] [-r WxH] [-l filter] [-d bits] [-z haze]"
+            " [level.emu | actor.act] [path.cam]\n",
+            name);
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t width = 640, height = 360, threads = 4;
+    int frames = 300;
+    const char *output = NULL, *scene_path = NULL, *cam_path = NULL;
+    post_settings effects;
+    post_settings_defaults(&effects);
+    int use_post = 0;
+    for (int i = 1; i < argc; i++) {
+        if (argv[i][0] == '-' && argv[i][1] && !argv[i][2] && i + 1 < argc) {
+            const char* value = argv[++i];
+            switch (argv[i - 1][1]) {
+            case 'w': width = (uint32_t)atoi(value); break;
+            case 'h': height = (uint32_t)atoi(value); break;
+            case 't': threads = (uint32_t)atoi(value); break;
+            case 'f': frames = atoi(value); break;
+            case 'o': output = value; break;
+            case 'r':
+                if (sscanf(value, "%ux%u", &effects.target_width, &effects.target_height) != 2) {
+                    bench_usage(argv[0]);
+                    return 1;
+                }
+                use_post = 1;
+                break;
+            case 'l': effects.filter = atoi(value) ? POST_FILTER_BILINEAR : POST_FILTER_POINT; use_post = 1; break;
+            case 'd': effects.color_bits = (uint32_t)atoi(value); use_post = 1; break;
+            case 'z': effects.haze_strength = (float)atof(value); use_post = 1; break;
+            default: bench_usage(argv[0]); return 1;
+            }
+        } else if (bench_has_suffix(argv[i], ".cam")) {
+            cam_path = argv[i];
+        } else if (bench_has_suffix(argv[i], ".emu") || bench_has_suffix(argv[i], ".act")) {
+            scene_path = argv[i];
+        } else {
+            bench_usage(argv[0]);
+            return 1;
+        }
+    }
+    if (frames < 1 || threads < 1 || effects.color_bits < 1 || effects.color_bits > 8) {
+        bench_usage(argv[0]);
+        return 1;
+    }
+
+    srast_context* raster = srast_create(width, height, threads);
+    if (!raster) {
+        fprintf(stderr, "cannot create a %ux%u rasterizer\n", width, height);
+        return 1;
+    }
+    post_context* post = use_post ? post_create(width, height) : NULL;
+    uint32_t* post_color = use_post ? (uint32_t*)malloc((size_t)width * height * sizeof(uint32_t)) : NULL;
+    if (use_post && (!post || !post_color)) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+
+    // Checkerboard stand-in for every texture
+    uint32_t checker[64 * 64];
+    for (uint32_t i = 0; i < 64 * 64; i++) checker[i] = ((i % 64) / 8 + (i / 64) / 8) % 2 ? 0xFFFFFFFFu : 0xFF606060u;
+    srast_texture texture = { 64, 64, checker, 1 };
+
+    cam0_track track;
+    int have_track = 0;
+    if (cam_path) {
+        int result = cam0_load(&track, cam_path);
+        if (result != CAM0_OK) {
+            fprintf(stderr, "%s: not a CAM0 track (error %d)\n", cam_path, result);
+            return 1;
+        }
+        have_track = track.keyframe_count > 0;
+    }
+
+    // Scene state; only the part for the scene kind in use is filled
+    emu5_level level;
+    emu_cull_context cull;
+    int is_emu = scene_path && bench_has_suffix(scene_path, ".emu");
+    int is_act = scene_path && !is_emu;
+    uint8_t* act = NULL;
+    bench_rat rat;
+    memset(&rat, 0, sizeof(rat));
+    vlit_actor* lit = NULL;
+    vlit_mesh mesh;
+    vlit_light light;
+    vlit_light_defaults(&light);
+    float *positions = NULL, *uv = NULL;
+    uint32_t* colors = NULL;
+    uint32_t* indices = NULL;
+    srast_draw base;
+    srast_draw_defaults(&base);
+    float center[3], radius;
+
+    if (is_emu) {
+        int result = emu5_map(&level, scene_path);
+        if (result != EMU5_OK) {
+            fprintf(stderr, "%s: not an EMU v5 level (error %d)\n", scene_path, result);
+            return 1;
+        }
+        if (emu_cull_init(&cull, &level) != 0) {
+            fprintf(stderr, "out of memory\n");
+            return 1;
+        }
+        uint32_t n = level.header->vertex_count;
+        uv = (float*)malloc((size_t)n * 2 * sizeof(float) + 1);
+        colors = (uint32_t*)malloc((size_t)n * sizeof(uint32_t) + 1);
+        if (!uv || !colors) {
+            fprintf(stderr, "out of memory\n");
+            return 1;
+        }
+        // Byte uv and rgb widened once; V is stored flipped, so it already runs top-down
+        for (uint32_t v = 0; v < n; v++) {
+            uv[v * 2] = (float)level.u[v] / 255.0f;
+            uv[v * 2 + 1] = (float)level.v[v] / 255.0f;
+            colors[v] = 0xFF000000u | level.color_r[v] | (uint32_t)level.color_g[v] << 8 | (uint32_t)level.color_b[v] << 16;
+        }
+        base.vertex_count = n;
+        base.x = level.pos_x;
+        base.y = level.pos_y;
+        base.z = level.pos_z;
+        base.uv = uv;
+        base.color = colors;
+        base.indices = level.faces;
+        base.index_count = level.header->face_count * 3;
+        base.index_size = 4;
+        base.texture = &texture;
+        texture.bilinear = !(level.header->flags & EMU5_FLAG_NEAREST_FILTER);
+        bench_bounds(level.pos_x, level.pos_y, level.pos_z, n, center, &radius);
+        printf("level: %u vertices, %u faces, texture %s\n", n, level.header->face_count, level.texture_name);
+    } else if (is_act) {
+        size_t size;
+        act = bench_read_file(scene_path, &size);
+        int result = act ? vlit_mesh_from_act(&mesh, act, size) : VLIT_ERR_RANGE;
+        if (result != VLIT_OK) {
+            fprintf(stderr, "%s: not an ACT (error %d)\n", scene_path, result);
+            return 1;
+        }
+        // The first RAT named in the header, next to the .act
+        uint32_t names_length = bench_u32(act + 12);
+        const char* name = (const char*)act + 56;
+        char rat_path[1024];
+        const char* slash = strrchr(scene_path, '/');
+        int dir = slash ? (int)(slash - scene_path) + 1 : 0;
+        if (names_length == 0 || 56 + (size_t)names_length > size || !memchr(name, 0, names_length) ||
+            snprintf(rat_path, sizeof(rat_path), "%.*s%s", dir, scene_path, name) >= (int)sizeof(rat_path) ||
+            !bench_rat_load(&rat, rat_path)) {
+            fprintf(stderr, "%s: cannot load its RAT %s\n", scene_path, names_length ? name : "(none)");
+            return 1;
+        }
+        if (rat.vertex_count != mesh.vertex_count) {
+            fprintf(stderr, "%s: %u vertices, the ACT has %u\n", rat_path, rat.vertex_count, mesh.vertex_count);
+            return 1;
+        }
+
+        uint32_t n = mesh.vertex_count, uv_offset = bench_u32(act + 28);
+        positions = (float*)malloc((size_t)n * 3 * sizeof(float) + 1);
+        uv = (float*)malloc((size_t)n * 2 * sizeof(float) + 1);
+        lit = vlit_create(&mesh, mesh.mode);
+        if (!positions || !uv || !lit || uv_offset > size || (uint64_t)n * 8 > size - uv_offset) {
+            fprintf(stderr, "%s: out of memory or bad UV table\n", scene_path);
+            return 1;
+        }
+        for (uint32_t i = 0; i < n * 2; i++) uv[i] = bench_f32(act + uv_offset + i * 4);
+        base.vertex_count = n;
+        base.x = positions;
+        base.y = positions + n;
+        base.z = positions + n * 2;
+        base.uv = mesh.mode == VLIT_MAT_CAP ? vlit_uvs(lit) : uv;
+        base.color = vlit_colors(lit);
+        base.indices = mesh.indices;
+        base.index_count = mesh.index_count;
+        base.index_size = 2;
+        base.v_up = 1;
+        base.texture = mesh.mode >= VLIT_TEXTURE_ONLY ? &texture : NULL;
+        bench_rat_positions(&rat, positions, positions + n, positions + n * 2);
+        bench_bounds(base.x, base.y, base.z, n, center, &radius);
+        printf("actor: %u vertices, %u triangles, mode %d, %u frames\n", n, mesh.index_count / 3, (int)mesh.mode,
+               rat.frame_count);
+    } else {
+        // Spheres of 32 rings on a 6 x 6 grid over a floor reaching past the near plane
+        uint32_t rings = 32, n = (rings + 1) * (rings * 2 + 1);
+        positions = (float*)malloc((size_t)(n + 4) * 3 * sizeof(float));
+        uv = (float*)malloc((size_t)(n + 4) * 2 * sizeof(float));
+        colors = (uint32_t*)malloc((size_t)(n + 4) * sizeof(uint32_t));
+        indices = (uint32_t*)malloc(((size_t)rings * rings * 12 + 6) * sizeof(uint32_t));
+        if (!positions || !uv || !colors || !indices) {
+            fprintf(stderr, "out of memory\n");
+            return 1;
+        }
+        float *x = positions, *y = positions + n + 4, *z = positions + (n + 4) * 2;
+        uint32_t index_count = bench_sphere(rings, x, y, z, uv, colors, indices);
+        static const float corners[4][2] = { { -40, -40 }, { 40, -40 }, { 40, 40 }, { -40, 40 } };
+        for (uint32_t c = 0; c < 4; c++) {
+            x[n + c] = corners[c][0];
+            y[n + c] = -1.0f;
+            z[n + c] = corners[c][1];
+            uv[(n + c) * 2] = corners[c][0];
+            uv[(n + c) * 2 + 1] = corners[c][1];
+            colors[n + c] = 0xFFB0C0D0u;
+        }
+        // Counter-clockwise seen from above
+        uint32_t floor[6] = { n, n + 3, n + 2, n, n + 2, n + 1 };
+        memcpy(indices + index_count, floor, sizeof(floor));
+        base.vertex_count = n + 4;
+        base.x = x;
+        base.y = y;
+        base.z = z;
+        base.uv = uv;
+        base.color = colors;
+        base.indices = indices;
+        base.index_count = index_count;
+        base.index_size = 4;
+        base.texture = &texture;
+        center[0] = center[1] = center[2] = 0.0f;
+        radius = 12.0f;
+        printf("synthetic: 36 spheres of %u triangles and a floor\n", index_count / 3);
+    }
+
+    float aspect = (float)width / (float)height, near_z = radius * 0.01f, far_z = radius * 20.0f;
+    double prepare_us = 0.0, submit_us = 0.0, raster_us = 0.0, post_us[POST_PASS_COUNT] = { 0 }, post_total_us = 0.0, worst_us = 0.0;
+    post_stats effect_stats;
+    memset(&effect_stats, 0, sizeof(effect_stats));
+    uint64_t triangles = 0, culled = 0, clipped = 0, binned = 0, tiles_rejected = 0, blocks_rejected = 0, pixels = 0;
+    for (int f = 0; f < frames; f++) {
+        double start = ztime_now_us();
+        cam0_pose pose;
+        if (have_track)
+            cam0_sample_frame(&track, (double)(f % track.keyframe_count), &pose);
+        else
+            bench_orbit(&pose, center, radius * 2.2f, 2.0f * BENCH_PI * (float)f / (float)frames, 0.35f);
+        float view_proj[16];
+        cam0_view_proj(&pose, aspect, near_z, far_z, view_proj);
+
+        srast_draw draw = base;
+        memcpy(draw.mvp, view_proj, sizeof(view_proj));
+        if (is_emu) {
+            emu_frustum frustum;
+            emu_frustum_from_matrix(&frustum, view_proj);
+            draw.range_count = emu_cull(&cull, pose.pos, &frustum);
+            draw.ranges = (const uint32_t*)cull.ranges;
+        } else if (is_act) {
+            uint32_t n = mesh.vertex_count;
+            bench_rat_next(&rat);
+            bench_rat_positions(&rat, positions, positions + n, positions + n * 2);
+            vlit_update(lit, draw.x, draw.y, draw.z, &light);
+        }
+        double prepared = ztime_now_us();
+
+        srast_begin(raster, 0xFF302010u, 1.0f);
+        int result = SRAST_OK;
+        if (is_act || is_emu) {
+            result = srast_submit(raster, &draw);
+        } else {
+            float model[16] = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 };
+            for (int s = 0; s < 36 && result == SRAST_OK; s++) {
+                model[12] = (float)(s % 6) * 3.0f - 7.5f;
+                model[14] = (float)(s / 6) * 3.0f - 7.5f;
+                bench_mul(view_proj, model, draw.mvp);
+                result = srast_submit(raster, &draw);
+            }
+            draw.indices = indices + base.index_count;
+            draw.index_count = 6;
+            memcpy(draw.mvp, view_proj, sizeof(view_proj));
+            if (result == SRAST_OK) result = srast_submit(raster, &draw);
+        }
+        if (result != SRAST_OK) {
+            fprintf(stderr, "out of memory\n");
+            return 1;
+        }
+        double submitted = ztime_now_us();
+        srast_end(raster);
+        double rasterized = ztime_now_us();
+        if (post) {
+            effects.time = (float)f / 60.0f;
+            if (post_run(post, &effects, srast_color(raster), srast_depth(raster), post_color) != POST_OK) {
+                fprintf(stderr, "out of memory\n");
+                return 1;
+            }
+            post_get_stats(post, &effect_stats);
+            for (int p = 0; p < POST_PASS_COUNT; p++) post_us[p] += effect_stats.us[p];
+        }
+        double end = ztime_now_us();
+
+        prepare_us += prepared - start;
+        submit_us += submitted - prepared;
+        raster_us += rasterized - submitted;
+        post_total_us += end - rasterized;
+        if (end - start > worst_us) worst_us = end - start;
+        srast_stats stats;
+        srast_get_stats(raster, &stats);
+        triangles += stats.triangles;
+        culled += stats.culled;
+        clipped += stats.clipped;
+        binned += stats.binned;
+        tiles_rejected += stats.tiles_rejected;
+        blocks_rejected += stats.blocks_rejected;
+        pixels += stats.pixels;
+    }
+
+    double n = (double)frames, total = (prepare_us + submit_us + raster_us + post_total_us) / n;
+    printf("%ux%u, %u threads, %d frames\n", width, height, threads, frames);
+    printf("triangles/frame: %.0f submitted, %.0f culled, %.0f clipped, %.1f tiles each\n", (double)triangles / n,
+           (double)culled / n, (double)clipped / n, triangles > culled ? (double)binned / (double)(triangles - culled) : 0.0);
+    printf("hierarchical Z/frame: %.0f tile and %.0f block rejections; %.0f pixels shaded (%.2fx overdraw)\n",
+           (double)tiles_rejected / n, (double)blocks_rejected / n, (double)pixels / n,
+           (double)pixels / n / ((double)width * height));
+    printf("time/frame: %.2f ms prepare, %.2f ms submit, %.2f ms raster; %.2f ms worst\n", prepare_us / n / 1000.0,
+           submit_us / n / 1000.0, raster_us / n / 1000.0, worst_us / 1000.0);
+    if (post) {
+        printf("post/frame: %.2f ms", post_total_us / n / 1000.0);
+        for (int p = 0; p < POST_PASS_COUNT; p++)
+            if (effect_stats.width[p])
+                printf(", %s %ux%u %.2f ms", post_pass_name(p), effect_stats.width[p], effect_stats.height[p],
+                       post_us[p] / n / 1000.0);
+        printf("\n");
+    }
+    printf("%.1f fps\n", 1e6 / total);
+    if (output) bench_write_ppm(output, post ? post_color : srast_color(raster), width, height);
+
+    if (is_emu) {
+        emu_cull_free(&cull);
+        emu5_unmap(&level);
+    }
+    if (have_track || cam_path) cam0_free(&track);
+    vlit_destroy(lit);
+    bench_rat_free(&rat);
+    free(act);
+    free(positions);
+    free(uv);
+    free(colors);
+    free(indices);
+    post_destroy(post);
+    free(post_color);
+    srast_destroy(raster);
+    return 0;
+}
@@ -0,0 +1,381 @@
+#include "texel.h"
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TEXEL_SSE2 1
+#include <emmintrin.h>
+#endif
+
+// 4x4 Bayer matrix. A channel is reduced to L levels as floor(v * L / 255 + t / 32), t = 2 * bayer + 1 when dithering
+// and 16 (plain rounding) otherwise. v * L * 32 + t * 255 is always odd, so the quotient never lands on an integer and
+// the float path can't round across a level.
+static const uint8_t texel_bayer[4][4] = {
+    { 0, 8, 2, 10 },
+    { 12, 4, 14, 6 },
+    { 3, 11, 1, 9 },
+    { 15, 7, 13, 5 }
+};
+
+#define TEXEL_ROUND 16u
+
+static uint32_t texel_threshold(int dither, uint32_t x, uint32_t y)
+{
+    return dither == TEXEL_DITHER_ORDERED ? 2u * texel_bayer[y & 3][x & 3] + 1u : TEXEL_ROUND;
+}
+
+static uint32_t texel_reduce(uint32_t v, uint32_t levels, uint32_t t)
+{
+    return (v * levels * 32u + t * 255u) / 8160u;
+}
+
+static uint32_t texel_intensity(uint32_t r, uint32_t g, uint32_t b)
+{
+    return (77u * r + 150u * g + 29u * b + 128u) >> 8;
+}
+
+static uint32_t texel_expand5(uint32_t q) { return q << 3 | q >> 2; }
+static uint32_t texel_expand6(uint32_t q) { return q << 2 | q >> 4; }
+static uint32_t texel_expand3(uint32_t q) { return q << 5 | q << 2 | q >> 1; }
+
+static uint32_t texel_rgba(uint32_t r, uint32_t g, uint32_t b, uint32_t a)
+{
+    return r | g << 8 | b << 16 | a << 24;
+}
+
+int texel_bits(texel_format format)
+{
+    switch (format) {
+    case TEXEL_RGBA8888: return 32;
+    case TEXEL_RGBA5551: case TEXEL_RGB565: return 16;
+    case TEXEL_IA8: case TEXEL_I8: case TEXEL_CI8: return 8;
+    case TEXEL_IA4: case TEXEL_I4: case TEXEL_CI4: return 4;
+    default: return 0;
+    }
+}
+
+size_t texel_row_bytes(texel_format format, uint32_t width)
+{
+    return ((size_t)width * (size_t)texel_bits(format) + 7) / 8;
+}
+
+size_t texel_image_size(texel_format format, uint32_t width, uint32_t height)
+{
+    return texel_row_bytes(format, width) * height;
+}
+
+// Packed code of one texel, t from texel_threshold
+static uint32_t texel_code(texel_format format, const uint8_t* p, uint32_t t)
+{
+    uint32_t i;
+    switch (format) {
+    case TEXEL_RGBA5551:
+        return texel_reduce(p[0], 31, t) << 11 | texel_reduce(p[1], 31, t) << 6 | texel_reduce(p[2], 31, t) << 1 |
+               texel_reduce(p[3], 1, TEXEL_ROUND);
+    case TEXEL_RGB565:
+        return texel_reduce(p[0], 31, t) << 11 | texel_reduce(p[1], 63, t) << 5 | texel_reduce(p[2], 31, t);
+    case TEXEL_IA8:
+        i = texel_intensity(p[0], p[1], p[2]);
+        return texel_reduce(i, 15, t) << 4 | texel_reduce(p[3], 15, TEXEL_ROUND);
+    case TEXEL_IA4:
+        i = texel_intensity(p[0], p[1], p[2]);
+        return texel_reduce(i, 7, t) << 1 | texel_reduce(p[3], 1, TEXEL_ROUND);
+    case TEXEL_I8:
+        return texel_intensity(p[0], p[1], p[2]);
+    case TEXEL_I4:
+        return texel_reduce(texel_intensity(p[0], p[1], p[2]), 15, t);
+    default:
+        return 0;
+    }
+}
+
+#if TEXEL_SSE2
+static __m128i texel_reduce4(__m128 v, float levels, __m128 t255)
+{
+    __m128 n = _mm_add_ps(_mm_mul_ps(v, _mm_set1_ps(levels * 32.0f)), t255);
+    return _mm_cvttps_epi32(_mm_mul_ps(n, _mm_set1_ps(1.0f / 8160.0f)));
+}
+
+// Codes of four texels in 32-bit lanes, same values as texel_code
+static __m128i texel_code4(texel_format format, const uint8_t* p, __m128 t255)
+{
+    const __m128i byte = _mm_set1_epi32(0xFF);
+    const __m128 round255 = _mm_set1_ps(TEXEL_ROUND * 255.0f);
+    __m128i px = _mm_loadu_si128((const __m128i*)p);
+    __m128 r = _mm_cvtepi32_ps(_mm_and_si128(px, byte));
+    __m128 g = _mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(px, 8), byte));
+    __m128 b = _mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(px, 16), byte));
+    __m128 a = _mm_cvtepi32_ps(_mm_srli_epi32(px, 24));
+    __m128 i = r;
+
+    if (format >= TEXEL_IA8) {
+        // 77 r + 150 g + 29 b + 128 is exact in a float, and / 256 is a power of two
+        __m128 sum = _mm_add_ps(_mm_add_ps(_mm_mul_ps(r, _mm_set1_ps(77.0f)), _mm_mul_ps(g, _mm_set1_ps(150.0f))),
+                                _mm_add_ps(_mm_mul_ps(b, _mm_set1_ps(29.0f)), _mm_set1_ps(128.0f)));
+        i = _mm_cvtepi32_ps(_mm_cvttps_epi32(_mm_mul_ps(sum, _mm_set1_ps(1.0f / 256.0f))));
+    }
+
+    switch (format) {
+    case TEXEL_RGBA5551:
+        return _mm_or_si128(_mm_or_si128(_mm_slli_epi32(texel_reduce4(r, 31, t255), 11), _mm_slli_epi32(texel_reduce4(g, 31, t255), 6)),
+                            _mm_or_si128(_mm_slli_epi32(texel_reduce4(b, 31, t255), 1), texel_reduce4(a, 1, round255)));
+    case TEXEL_RGB565:
+        return _mm_or_si128(_mm_or_si128(_mm_slli_epi32(texel_reduce4(r, 31, t255), 11), _mm_slli_epi32(texel_reduce4(g, 63, t255), 5)),
+                            texel_reduce4(b, 31, t255));
+    case TEXEL_IA8:
+        return _mm_or_si128(_mm_slli_epi32(texel_reduce4(i, 15, t255), 4), texel_reduce4(a, 15, round255));
+    case TEXEL_IA4:
+        return _mm_or_si128(_mm_slli_epi32(texel_reduce4(i, 7, t255), 1), texel_reduce4(a, 1, round255));
+    case TEXEL_I8:
+        return _mm_cvttps_epi32(i);
+    default:
+        return texel_reduce4(i, 15, t255);
+    }
+}
+#endif
+
+static void texel_encode_row(texel_format format, const uint8_t* rgba, uint32_t width, uint32_t y, int dither, uint8_t* out)
+{
+    int bits = texel_bits(format);
+    uint32_t x = 0;
+
+#if TEXEL_SSE2
+    __m128 t255 = _mm_set1_ps(TEXEL_ROUND * 255.0f);
+    if (dither == TEXEL_DITHER_ORDERED) {
+        const uint8_t* row = texel_bayer[y & 3];
+        t255 = _mm_setr_ps((float)(2 * row[0] + 1) * 255.0f, (float)(2 * row[1] + 1) * 255.0f, (float)(2 * row[2] + 1) * 255.0f,
+                           (float)(2 * row[3] + 1) * 255.0f);
+    }
+    for (; x + 4 <= width; x += 4) {
+        __m128i code = texel_code4(format, rgba + (size_t)x * 4, t255);
+        if (bits == 16) {
+            // Sign-extend the low halves so the saturating pack keeps every bit
+            __m128i packed = _mm_packs_epi32(_mm_srai_epi32(_mm_slli_epi32(code, 16), 16), _mm_setzero_si128());
+            _mm_storel_epi64((__m128i*)(out + (size_t)x * 2), packed);
+        } else {
+            uint32_t bytes = (uint32_t)_mm_cvtsi128_si32(_mm_packus_epi16(_mm_packs_epi32(code, code), _mm_setzero_si128()));
+            if (bits == 8) {
+                memcpy(out + x, &bytes, 4);
+            } else {
+                uint8_t c[4];
+                memcpy(c, &bytes, 4);
+                out[x / 2] = (uint8_t)(c[0] << 4 | c[1]);
+                out[x / 2 + 1] = (uint8_t)(c[2] << 4 | c[3]);
+            }
+        }
+    }
+#endif
+
+    for (; x < width; x++) {
+        uint32_t code = texel_code(format, rgba + (size_t)x * 4, texel_threshold(dither, x, y));
+        if (bits == 16) {
+            uint16_t c = (uint16_t)code;
+            memcpy(out + (size_t)x * 2, &c, 2);
+        } else if (bits == 8) {
+            out[x] = (uint8_t)code;
+        } else if (x & 1) {
+            out[x / 2] = (uint8_t)(out[x / 2] | code);
+        } else {
+            out[x / 2] = (uint8_t)(code << 4);
+        }
+    }
+}
+
+int texel_encode(texel_format format, const uint8_t* rgba, uint32_t width, uint32_t height, int dither, void* out)
+{
+    size_t stride = texel_row_bytes(format, width);
+    if (format == TEXEL_RGBA8888) {
+        memcpy(out, rgba, stride * height);
+        return TEXEL_OK;
+    }
+    if (texel_bits(format) == 0 || format == TEXEL_CI8 || format == TEXEL_CI4) return TEXEL_ERR_FORMAT;
+
+    for (uint32_t y = 0; y < height; y++)
+        texel_encode_row(format, rgba + (size_t)y * width * 4, width, y, dither, (uint8_t*)out + y * stride);
+    return TEXEL_OK;
+}
+
+void texel_reduce_tables(uint32_t bits, int dither, uint8_t tables[16][256])
+{
+    uint32_t levels = (1u << bits) - 1u;
+    for (uint32_t cell = 0; cell < 16; cell++) {
+        uint32_t t = texel_threshold(dither, cell & 3, cell >> 2);
+        for (uint32_t v = 0; v < 256; v++) {
+            uint32_t wide = texel_reduce(v, levels, t) << (8 - bits);
+            for (uint32_t s = bits; s < 8; s *= 2) wide |= wide >> s;
+            tables[cell][v] = (uint8_t)wide;
+        }
+    }
+}
+
+int texel_encode_indices(texel_format format, const uint8_t* indices, uint32_t width, uint32_t height, void* out)
+{
+    size_t stride = texel_row_bytes(format, width);
+    if (format == TEXEL_CI8) {
+        memcpy(out, indices, stride * height);
+        return TEXEL_OK;
+    }
+    if (format != TEXEL_CI4) return TEXEL_ERR_FORMAT;
+
+    for (uint32_t y = 0; y < height; y++) {
+        const uint8_t* src = indices + (size_t)y * width;
+        uint8_t* dst = (uint8_t*)out + y * stride;
+        for (uint32_t x = 0; x + 1 < width; x += 2) dst[x / 2] = (uint8_t)((src[x] & 15) << 4 | (src[x + 1] & 15));
+        if (width & 1) dst[width / 2] = (uint8_t)((src[width - 1] & 15) << 4);
+    }
+    return TEXEL_OK;
+}
+
+static uint32_t texel_palette(const texel_image* image, uint32_t index)
+{
+    return index < image->palette_size ? image->palette[index] : 0;
+}
+
+static uint32_t texel_widen(texel_format format, uint32_t c, const texel_image* image)
+{
+    uint32_t i;
+    switch (format) {
+    case TEXEL_RGBA5551:
+        return texel_rgba(texel_expand5(c >> 11), texel_expand5(c >> 6 & 31), texel_expand5(c >> 1 & 31), (c & 1) * 255);
+    case TEXEL_RGB565:
+        return texel_rgba(texel_expand5(c >> 11), texel_expand6(c >> 5 & 63), texel_expand5(c & 31), 255);
+    case TEXEL_IA8:
+        i = (c >> 4) * 17;
+        return texel_rgba(i, i, i, (c & 15) * 17);
+    case TEXEL_IA4:
+        i = texel_expand3(c >> 1);
+        return texel_rgba(i, i, i, (c & 1) * 255);
+    case TEXEL_I8:
+        return c * 0x01010101u;
+    case TEXEL_I4:
+        return c * 0x11111111u;
+    case TEXEL_CI8: case TEXEL_CI4:
+        return texel_palette(image, c);
+    default:
+        return c;
+    }
+}
+
+uint32_t texel_fetch(const texel_image* image, uint32_t x, uint32_t y)
+{
+    const uint8_t* row = (const uint8_t*)image->data + (size_t)y * image->stride;
+    uint32_t c;
+    switch (texel_bits(image->format)) {
+    case 32: {
+        const uint8_t* p = row + (size_t)x * 4;
+        return texel_rgba(p[0], p[1], p[2], p[3]);
+    }
+    case 16: {
+        uint16_t h;
+        memcpy(&h, row + (size_t)x * 2, 2);
+        c = h;
+        break;
+    }
+    case 8:
+        c = row[x];
+        break;
+    case 4:
+        c = (x & 1) ? row[x / 2] & 15u : (uint32_t)row[x / 2] >> 4;
+        break;
+    default:
+        return 0;
+    }
+    return texel_widen(image->format, c, image);
+}
+
+#if TEXEL_SSE2
+// Four 16- or 8-bit codes in 32-bit lanes widened to RGBA8888, same values as texel_widen
+static __m128i texel_widen4(texel_format format, __m128i c)
+{
+    const __m128i m5 = _mm_set1_epi32(31), m6 = _mm_set1_epi32(63), m4 = _mm_set1_epi32(15), m1 = _mm_set1_epi32(1);
+    __m128i r, g, b, a, i;
+    switch (format) {
+    case TEXEL_RGBA5551:
+        r = _mm_srli_epi32(c, 11);
+        g = _mm_and_si128(_mm_srli_epi32(c, 6), m5);
+        b = _mm_and_si128(_mm_srli_epi32(c, 1), m5);
+        r = _mm_or_si128(_mm_slli_epi32(r, 3), _mm_srli_epi32(r, 2));
+        g = _mm_or_si128(_mm_slli_epi32(g, 3), _mm_srli_epi32(g, 2));
+        b = _mm_or_si128(_mm_slli_epi32(b, 3), _mm_srli_epi32(b, 2));
+        a = _mm_sub_epi32(_mm_setzero_si128(), _mm_and_si128(c, m1));   // 0 or all ones
+        break;
+    case TEXEL_RGB565:
+        r = _mm_srli_epi32(c, 11);
+        g = _mm_and_si128(_mm_srli_epi32(c, 5), m6);
+        b = _mm_and_si128(c, m5);
+        r = _mm_or_si128(_mm_slli_epi32(r, 3), _mm_srli_epi32(r, 2));
+        g = _mm_or_si128(_mm_slli_epi32(g, 2), _mm_srli_epi32(g, 4));
+        b = _mm_or_si128(_mm_slli_epi32(b, 3), _mm_srli_epi32(b, 2));
+        a = _mm_set1_epi32(-1);
+        break;
+    case TEXEL_IA8:
+        i = _mm_srli_epi32(c, 4);
+        i = _mm_or_si128(_mm_slli_epi32(i, 4), i);
+        a = _mm_and_si128(c, m4);
+        a = _mm_or_si128(_mm_slli_epi32(a, 4), a);
+        r = g = b = i;
+        break;
+    default: // TEXEL_I8
+        r = g = b = a = c;
+        break;
+    }
+    return _mm_or_si128(_mm_or_si128(r, _mm_slli_epi32(g, 8)), _mm_or_si128(_mm_slli_epi32(b, 16), _mm_slli_epi32(a, 24)));
+}
+#endif
+
+void texel_decode(const texel_image* image, uint8_t* rgba)
+{
+    int bits = texel_bits(image->format);
+    for (uint32_t y = 0; y < image->height; y++) {
+        const uint8_t* row = (const uint8_t*)image->data + (size_t)y * image->stride;
+        uint8_t* out = rgba + (size_t)y * image->width * 4;
+        uint32_t x = 0;
+
+        if (bits == 32) {
+            memcpy(out, row, (size_t)image->width * 4);
+            continue;
+        }
+
+#if TEXEL_SSE2
+        if (bits == 16 || (bits == 8 && image->format != TEXEL_CI8)) {
+            for (; x + 4 <= image->width; x += 4) {
+                __m128i c;
+                if (bits == 16) {
+                    c = _mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i*)(row + (size_t)x * 2)), _mm_setzero_si128());
+                } else {
+                    uint32_t bytes;
+                    memcpy(&bytes, row + x, 4);
+                    c = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128((int)bytes), _mm_setzero_si128()), _mm_setzero_si128());
+                }
+                _mm_storeu_si128((__m128i*)(out + (size_t)x * 4), texel_widen4(image->format, c));
+            }
+        }
+#endif
+
+        for (; x < image->width; x++) {
+            uint32_t c = texel_fetch(image, x, y);
+            out[x * 4 + 0] = (uint8_t)c;
+            out[x * 4 + 1] = (uint8_t)(c >> 8);
+            out[x * 4 + 2] = (uint8_t)(c >> 16);
+            out[x * 4 + 3] = (uint8_t)(c >> 24);
+        }
+    }
+}
+
+void texel_sample(const texel_image* image, float u, float v, float rgba[4])
+{
+    if (!image || !image->data || image->width == 0 || image->height == 0) {
+        rgba[0] = rgba[1] = rgba[2] = 0.0f;
+        rgba[3] = 1.0f;
+        return;
+    }
+
+    u = u < 0.0f ? 0.0f : (u > 1.0f ? 1.0f : u);
+    v = v < 0.0f ? 0.0f : (v > 1.0f ? 1.0f : v);
+    uint32_t c = texel_fetch(image, (uint32_t)(u * (float)(image->width - 1)), (uint32_t)(v * (float)(image->height - 1)));
+
+    const float scale = 1.0f / 255.0f;
+    rgba[0] = (float)(c & 255) * scale;
+    rgba[1] = (float)(c >> 8 & 255) * scale;
+    rgba[2] = (float)(c >> 16 & 255) * scale;
+    rgba[3] = (float)(c >> 24) * scale;
+}
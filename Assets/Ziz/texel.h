@@ -0,0 +1,87 @@
+#ifndef TEXEL_H
+#define TEXEL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Packed texel formats, shared by the exporter and the runtime sampler, so textures can stay 16, 8 or 4 bits per
+// texel in memory instead of being widened to RGBA8888 on load.
+//
+//   size_t size = texel_image_size(TEXEL_RGBA5551, w, h);
+//   texel_encode(TEXEL_RGBA5551, rgba, w, h, TEXEL_DITHER_ORDERED, packed);
+//   texel_image image = { TEXEL_RGBA5551, w, h, texel_row_bytes(TEXEL_RGBA5551, w), packed, NULL, 0 };
+//   float color[4];
+//   texel_sample(&image, u, v, color);
+//
+// Layouts follow the N64 formats, with 16-bit texels in host byte order:
+//   RGBA5551  r:5 g:5 b:5 a:1, red in the top bits
+//   RGB565    r:5 g:6 b:5, opaque
+//   IA8       i:4 a:4, intensity in the high nibble
+//   IA4       i:3 a:1 per nibble
+//   I8, I4    intensity only, also used as alpha
+//   CI8, CI4  palette indices into an RGBA8888 palette
+// 4-bit formats put the left texel in the high nibble; every row starts on a byte boundary.
+//
+// RGBA8888 texels are r, g, b, a bytes (a uint32_t holds r in its low byte on little-endian hosts). Intensity is
+// (77 r + 150 g + 29 b) / 256. Reduced channels are rounded to the nearest level, or with TEXEL_DITHER_ORDERED pushed
+// up or down by a 4x4 Bayer threshold; alpha is never dithered. Widening replicates the top bits, so 31 becomes 255.
+// The SSE2 and scalar paths give identical bits.
+
+typedef enum texel_format {
+    TEXEL_RGBA8888,
+    TEXEL_RGBA5551,
+    TEXEL_RGB565,
+    TEXEL_IA8,
+    TEXEL_IA4,
+    TEXEL_I8,
+    TEXEL_I4,
+    TEXEL_CI8,
+    TEXEL_CI4,
+    TEXEL_FORMAT_COUNT
+} texel_format;
+
+enum {
+    TEXEL_DITHER_NONE,
+    TEXEL_DITHER_ORDERED
+};
+
+enum {
+    TEXEL_OK = 0,
+    TEXEL_ERR_FORMAT = -1     // unknown format, or a CI format passed to texel_encode (use texel_encode_indices)
+};
+
+typedef struct texel_image {
+    texel_format format;
+    uint32_t width;
+    uint32_t height;
+    uint32_t stride;             // bytes per row, at least texel_row_bytes(format, width)
+    const void* data;
+    const uint32_t* palette;     // CI formats: RGBA8888 entries
+    uint32_t palette_size;       // indices past the end decode as transparent black
+} texel_image;
+
+int texel_bits(texel_format format);
+size_t texel_row_bytes(texel_format format, uint32_t width);
+size_t texel_image_size(texel_format format, uint32_t width, uint32_t height);
+
+// Packs width x height RGBA8888 texels (rows tightly packed) into out, rows texel_row_bytes apart.
+int texel_encode(texel_format format, const uint8_t* rgba, uint32_t width, uint32_t height, int dither, void* out);
+
+// Packs palette indices (one byte each, rows tightly packed) into CI8 or CI4. CI4 keeps the low nibble.
+int texel_encode_indices(texel_format format, const uint8_t* indices, uint32_t width, uint32_t height, void* out);
+
+// Reduce-and-widen lookups for color channels at bits (1..8) per channel, one per cell of the 4x4 dither matrix
+// (cell (y & 3) * 4 + (x & 3)): tables[cell][v] is v reduced as texel_encode reduces r, g, b and i, then widened back
+// by replicating the top bits. With TEXEL_DITHER_NONE every cell just rounds. For dithering images kept as RGBA8888.
+void texel_reduce_tables(uint32_t bits, int dither, uint8_t tables[16][256]);
+
+// Widens the whole image to RGBA8888, rows tightly packed.
+void texel_decode(const texel_image* image, uint8_t* rgba);
+
+// One texel as RGBA8888 (r in the low byte). x and y must be inside the image.
+uint32_t texel_fetch(const texel_image* image, uint32_t x, uint32_t y);
+
+// Nearest-neighbour lookup with clamped UVs, the same addressing as SAMPLE_TEXTURE2D. Colors are 0..1.
+void texel_sample(const texel_image* image, float u, float v, float rgba[4]);
+
+#endif
@@ -0,0 +1,481 @@
+#include "vlit.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define VLIT_SSE 1
+#include <xmmintrin.h>
+#endif
+
+#define VLIT_ACT_MAGIC 0x52544341u  // "ACTR"
+#define VLIT_ACT_HEADER_SIZE 56
+
+// Per-vertex flags while normals are rebuilt
+#define VLIT_MOVED 1u
+#define VLIT_TOUCHED 2u
+
+struct vlit_actor {
+    vlit_mode mode;
+    uint32_t vertex_count;
+    uint32_t face_count;
+    uint32_t block_count;
+    int have_frame;              // prev and sum describe the previous frame
+    int have_light;              // light is what the colors were last computed with
+    vlit_light light;
+    uint32_t renormalized;
+    uint32_t* faces;             // three vertex indices per face
+    uint32_t* first_face;        // vertex_count + 1 offsets into vertex_faces
+    uint32_t* vertex_faces;      // the faces around each vertex, ascending
+    float* color[4];             // SoA 0..1, for the modes that light the vertex color
+    float* prev[3];              // positions of the previous frame
+    float* face_normal;          // x, y, z per face: the cross product of two edges, twice the area
+    float* sum[3];               // per vertex, the face normals around it
+    uint8_t* flags;              // VLIT_MOVED, VLIT_TOUCHED
+    uint8_t* dirty;              // per block: sum changed since the last lighting
+    uint32_t* rgba;
+    float* uv;                   // u, v pairs
+    void* storage;
+};
+
+// The kernels are written once over vlit_v: four vertices per value with SSE, one without. Both evaluate the same
+// operations in the same order, so they give the same bits.
+#if VLIT_SSE
+#define VLIT_LANES 4
+typedef __m128 vlit_v;
+#define VLIT_SET(s) _mm_set1_ps(s)
+#define VLIT_LOAD(p) _mm_loadu_ps(p)
+#define VLIT_STORE(p, v) _mm_storeu_ps(p, v)
+#define VLIT_ADD(a, b) _mm_add_ps(a, b)
+#define VLIT_MUL(a, b) _mm_mul_ps(a, b)
+#define VLIT_DIV(a, b) _mm_div_ps(a, b)
+#define VLIT_SQRT(a) _mm_sqrt_ps(a)
+#define VLIT_MIN(a, b) _mm_min_ps(a, b)
+#define VLIT_MAX(a, b) _mm_max_ps(a, b)
+#else
+#define VLIT_LANES 1
+typedef float vlit_v;
+#define VLIT_SET(s) (s)
+#define VLIT_LOAD(p) (*(p))
+#define VLIT_STORE(p, v) (*(p) = (v))
+#define VLIT_ADD(a, b) ((a) + (b))
+#define VLIT_MUL(a, b) ((a) * (b))
+#define VLIT_DIV(a, b) ((a) / (b))
+#define VLIT_SQRT(a) sqrtf(a)
+// Same semantics as _mm_min_ps/_mm_max_ps: the second operand on ties and NaN
+#define VLIT_MIN(a, b) ((a) < (b) ? (a) : (b))
+#define VLIT_MAX(a, b) ((a) > (b) ? (a) : (b))
+#endif
+
+static uint32_t vlit_read_u32(const uint8_t* p) { return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24; }
+
+static float vlit_read_f32(const uint8_t* p)
+{
+    uint32_t bits = vlit_read_u32(p);
+    float f;
+    memcpy(&f, &bits, 4);
+    return f;
+}
+
+static uint32_t vlit_bits(float f)
+{
+    uint32_t bits;
+    memcpy(&bits, &f, 4);
+    return bits;
+}
+
+void vlit_light_defaults(vlit_light* light)
+{
+    memset(light, 0, sizeof(*light));
+    light->direction[0] = light->direction[1] = light->direction[2] = 0.577f;
+    light->color[0] = light->color[1] = light->color[2] = 1.0f;
+    light->ambient = 0.3f;
+    light->view[0] = light->view[4] = light->view[8] = 1.0f;
+}
+
+int vlit_mesh_from_act(vlit_mesh* mesh, const void* data, size_t size)
+{
+    const uint8_t* p = (const uint8_t*)data;
+    memset(mesh, 0, sizeof(*mesh));
+    if (size < VLIT_ACT_HEADER_SIZE || vlit_read_u32(p) != VLIT_ACT_MAGIC) return VLIT_ERR_MAGIC;
+
+    uint32_t vertex_count = vlit_read_u32(p + 20), index_count = vlit_read_u32(p + 24);
+    uint32_t colors_offset = vlit_read_u32(p + 32), indices_offset = vlit_read_u32(p + 36);
+    uint8_t mode = p[48];
+    if (mode >= VLIT_MODE_COUNT || (uint64_t)indices_offset + (uint64_t)index_count * 2 > size) return VLIT_ERR_RANGE;
+
+    mesh->vertex_count = vertex_count;
+    mesh->index_count = index_count;
+    mesh->indices = p + indices_offset;
+    // Meshes without colors are written with an empty color table
+    if (colors_offset <= indices_offset && (uint64_t)indices_offset - colors_offset >= (uint64_t)vertex_count * 16)
+        mesh->colors = p + colors_offset;
+    mesh->mode = (vlit_mode)mode;
+    return VLIT_OK;
+}
+
+int vlit_mode_uses_normals(vlit_mode mode)
+{
+    return mode == VLIT_VERTEX_COLOURS_WITH_DIRECTIONAL_LIGHT || mode == VLIT_VERTEX_COLOURS_WITH_VERTEX_LIGHTING ||
+           mode == VLIT_TEXTURE_WITH_DIRECTIONAL_LIGHT || mode == VLIT_TEXTURE_AND_VERTEX_COLOURS_AND_DIRECTIONAL_LIGHT ||
+           mode == VLIT_MAT_CAP;
+}
+
+// Whether the mode's kernel reads the vertex color per frame rather than passing it through once
+static int vlit_mode_lights_color(vlit_mode mode)
+{
+    return mode == VLIT_VERTEX_COLOURS_WITH_DIRECTIONAL_LIGHT || mode == VLIT_VERTEX_COLOURS_WITH_VERTEX_LIGHTING ||
+           mode == VLIT_TEXTURE_AND_VERTEX_COLOURS_AND_DIRECTIONAL_LIGHT;
+}
+
+// Channels in 0..1, saturated like a fixed4 and rounded to bytes
+static uint32_t vlit_pack(float r, float g, float b, float a)
+{
+    float c[4] = { r, g, b, a };
+    uint32_t out = 0;
+    for (int k = 0; k < 4; k++) {
+        float v = c[k] * 255.0f;
+        v = (v > 0.0f ? (v < 255.0f ? v : 255.0f) : 0.0f) + 0.5f;
+        out |= (uint32_t)v << (8 * k);
+    }
+    return out;
+}
+
+// The vertex's color as the ACT stores it, white when there is none
+static void vlit_mesh_color(const vlit_mesh* mesh, uint32_t v, float rgba[4])
+{
+    for (int k = 0; k < 4; k++) rgba[k] = mesh->colors ? vlit_read_f32((const uint8_t*)mesh->colors + (size_t)v * 16 + 4 * k) : 1.0f;
+}
+
+vlit_actor* vlit_create(const vlit_mesh* mesh, vlit_mode mode)
+{
+    if (mode >= VLIT_MODE_COUNT) return NULL;
+    uint32_t vertex_count = mesh->vertex_count, face_count = mesh->index_count / 3;
+    const uint8_t* indices = (const uint8_t*)mesh->indices;
+    for (uint32_t i = 0; i < face_count * 3; i++)
+        if (((uint32_t)indices[i * 2] | (uint32_t)indices[i * 2 + 1] << 8) >= vertex_count) return NULL;
+
+    vlit_actor* a = (vlit_actor*)calloc(1, sizeof(vlit_actor));
+    if (!a) return NULL;
+
+    // Whole SIMD blocks, so kernels never need a scalar tail. Everything is 4 bytes wide but the flags, which go last.
+    size_t stride = ((size_t)vertex_count + 3) & ~(size_t)3;
+    int normals = vlit_mode_uses_normals(mode), colors = vlit_mode_lights_color(mode), uvs = mode == VLIT_MAT_CAP;
+    size_t words = stride;                                             // rgba
+    if (colors) words += stride * 4;
+    if (uvs) words += stride * 2;
+    if (normals) words += (size_t)face_count * 9 + stride + 1 + (size_t)vertex_count * 3 + stride * 3;
+    size_t flag_bytes = normals ? stride * 2 : 0;
+    a->storage = calloc(1, words * 4 + flag_bytes);
+    if (!a->storage) {
+        free(a);
+        return NULL;
+    }
+
+    uint32_t* w = (uint32_t*)a->storage;
+    a->rgba = w;
+    w += stride;
+    if (colors) {
+        for (int k = 0; k < 4; k++) a->color[k] = (float*)w + stride * k;
+        w += stride * 4;
+    }
+    if (uvs) {
+        a->uv = (float*)w;
+        w += stride * 2;
+    }
+    if (normals) {
+        for (int k = 0; k < 3; k++) a->sum[k] = (float*)w + stride * k;
+        w += stride * 3;
+        a->faces = w;
+        w += (size_t)face_count * 3;
+        a->vertex_faces = w;
+        w += (size_t)face_count * 3;
+        a->face_normal = (float*)w;
+        w += (size_t)face_count * 3;
+        for (int k = 0; k < 3; k++) a->prev[k] = (float*)w + (size_t)vertex_count * k;
+        w += (size_t)vertex_count * 3;
+        a->first_face = w;
+        w += stride + 1;
+        a->flags = (uint8_t*)w;
+        a->dirty = a->flags + stride;
+    }
+
+    a->mode = mode;
+    a->vertex_count = vertex_count;
+    a->face_count = face_count;
+    a->block_count = (uint32_t)(stride / VLIT_LANES);
+
+    // Colors the mode passes through never change; the ones it lights are kept as SoA for the kernel
+    for (uint32_t v = 0; v < vertex_count; v++) {
+        float rgba[4];
+        vlit_mesh_color(mesh, v, rgba);
+        if (colors) {
+            for (int k = 0; k < 4; k++) a->color[k][v] = rgba[k];
+        } else if (mode == VLIT_TEXTURE_ONLY || mode == VLIT_TEXTURE_WITH_DIRECTIONAL_LIGHT) {
+            a->rgba[v] = 0xFFFFFFFFu;
+        } else {
+            a->rgba[v] = vlit_pack(rgba[0], rgba[1], rgba[2], rgba[3]);
+        }
+    }
+
+    if (normals) {
+        // Vertex-to-face table: count, prefix sum, then fill in face order using first_face as the cursor
+        for (uint32_t i = 0; i < face_count * 3; i++) {
+            a->faces[i] = (uint32_t)indices[i * 2] | (uint32_t)indices[i * 2 + 1] << 8;
+            a->first_face[a->faces[i] + 1]++;
+        }
+        for (uint32_t v = 0; v < vertex_count; v++) a->first_face[v + 1] += a->first_face[v];
+        for (uint32_t i = 0; i < face_count * 3; i++) a->vertex_faces[a->first_face[a->faces[i]]++] = i / 3;
+        for (uint32_t v = vertex_count; v > 0; v--) a->first_face[v] = a->first_face[v - 1];
+        a->first_face[0] = 0;
+    }
+    return a;
+}
+
+void vlit_destroy(vlit_actor* actor)
+{
+    if (!actor) return;
+    free(actor->storage);
+    free(actor);
+}
+
+void vlit_invalidate(vlit_actor* actor)
+{
+    actor->have_frame = 0;
+    actor->have_light = 0;
+}
+
+const uint32_t* vlit_colors(const vlit_actor* actor) { return actor->rgba; }
+const float* vlit_uvs(const vlit_actor* actor) { return actor->uv; }
+uint32_t vlit_last_renormalized(const vlit_actor* actor) { return actor->renormalized; }
+
+// Flags the vertices whose position differs, bit for bit, from the previous frame (all of them on the first) and
+// remembers the new positions. Returns how many moved.
+static uint32_t vlit_find_moved(vlit_actor* a, const float* x, const float* y, const float* z)
+{
+    // Locals throughout: the flag stores are char stores, which would otherwise reload every pointer in a
+    float *px = a->prev[0], *py = a->prev[1], *pz = a->prev[2];
+    uint8_t* flags = a->flags;
+    uint32_t count = a->vertex_count, moved = 0;
+    int all = !a->have_frame;
+    for (uint32_t v = 0; v < count; v++) {
+        if (!all && vlit_bits(x[v]) == vlit_bits(px[v]) && vlit_bits(y[v]) == vlit_bits(py[v]) &&
+            vlit_bits(z[v]) == vlit_bits(pz[v]))
+            continue;
+        px[v] = x[v];
+        py[v] = y[v];
+        pz[v] = z[v];
+        flags[v] = VLIT_MOVED;
+        moved++;
+    }
+    a->have_frame = 1;
+    return moved;
+}
+
+// Recomputes the faces around moved vertices, then re-sums every vertex of those faces in vertex_faces order, so a
+// vertex's sum doesn't depend on which of its neighbours moved
+static void vlit_resum(vlit_actor* a)
+{
+    const float *px = a->prev[0], *py = a->prev[1], *pz = a->prev[2];
+    const uint32_t* faces = a->faces;
+    float* face_normal = a->face_normal;
+    uint8_t* flags = a->flags;
+    uint32_t face_count = a->face_count;
+    for (uint32_t f = 0; f < face_count; f++) {
+        uint32_t i0 = faces[f * 3], i1 = faces[f * 3 + 1], i2 = faces[f * 3 + 2];
+        if (!((flags[i0] | flags[i1] | flags[i2]) & VLIT_MOVED)) continue;
+        float e1x = px[i1] - px[i0], e1y = py[i1] - py[i0], e1z = pz[i1] - pz[i0];
+        float e2x = px[i2] - px[i0], e2y = py[i2] - py[i0], e2z = pz[i2] - pz[i0];
+        face_normal[f * 3] = e1y * e2z - e1z * e2y;
+        face_normal[f * 3 + 1] = e1z * e2x - e1x * e2z;
+        face_normal[f * 3 + 2] = e1x * e2y - e1y * e2x;
+        flags[i0] |= VLIT_TOUCHED;
+        flags[i1] |= VLIT_TOUCHED;
+        flags[i2] |= VLIT_TOUCHED;
+    }
+
+    const uint32_t *first_face = a->first_face, *vertex_faces = a->vertex_faces;
+    float *sx = a->sum[0], *sy = a->sum[1], *sz = a->sum[2];
+    uint8_t* dirty = a->dirty;
+    uint32_t vertex_count = a->vertex_count, count = 0;
+    for (uint32_t v = 0; v < vertex_count; v++) {
+        uint8_t flag = flags[v];
+        flags[v] = 0;
+        if (!(flag & VLIT_TOUCHED)) continue;
+        float x = 0.0f, y = 0.0f, z = 0.0f;
+        for (uint32_t j = first_face[v]; j < first_face[v + 1]; j++) {
+            const float* n = face_normal + vertex_faces[j] * 3;
+            x += n[0];
+            y += n[1];
+            z += n[2];
+        }
+        sx[v] = x;
+        sy[v] = y;
+        sz[v] = z;
+        dirty[v / VLIT_LANES] = 1;
+        count++;
+    }
+    a->renormalized = count;
+}
+
+// The per-mode kernels. Each walks the blocks with a changed normal, or all of them when the light changed, and
+// normalizes the sums on the fly; unreferenced vertices have a zero sum and come out as a zero normal.
+typedef void (*vlit_kernel)(vlit_actor* a, const vlit_light* light, int all);
+
+static void vlit_unit(const float in[3], float out[3])
+{
+    float length = sqrtf(in[0] * in[0] + in[1] * in[1] + in[2] * in[2]);
+    for (int k = 0; k < 3; k++) out[k] = length > 0.0f ? in[k] / length : 0.0f;
+}
+
+static void vlit_normal(const vlit_actor* a, uint32_t base, vlit_v n[3])
+{
+    vlit_v s[3];
+    for (int k = 0; k < 3; k++) s[k] = VLIT_LOAD(a->sum[k] + base);
+    vlit_v length2 = VLIT_ADD(VLIT_ADD(VLIT_MUL(s[0], s[0]), VLIT_MUL(s[1], s[1])), VLIT_MUL(s[2], s[2]));
+    vlit_v inverse = VLIT_DIV(VLIT_SET(1.0f), VLIT_SQRT(VLIT_MAX(length2, VLIT_SET(1e-30f))));
+    for (int k = 0; k < 3; k++) n[k] = VLIT_MUL(s[k], inverse);
+}
+
+static vlit_v vlit_ndotl(const vlit_v n[3], const float l[3])
+{
+    return VLIT_ADD(VLIT_ADD(VLIT_MUL(n[0], VLIT_SET(l[0])), VLIT_MUL(n[1], VLIT_SET(l[1]))), VLIT_MUL(n[2], VLIT_SET(l[2])));
+}
+
+static void vlit_store_rgba(vlit_actor* a, uint32_t base, const vlit_v c[4])
+{
+    float channel[4][VLIT_LANES];
+    vlit_v c255 = VLIT_SET(255.0f), zero = VLIT_SET(0.0f), half = VLIT_SET(0.5f);
+    for (int k = 0; k < 4; k++) VLIT_STORE(channel[k], VLIT_ADD(VLIT_MIN(VLIT_MAX(VLIT_MUL(c[k], c255), zero), c255), half));
+    for (int l = 0; l < VLIT_LANES; l++)
+        a->rgba[base + l] = (uint32_t)channel[0][l] | (uint32_t)channel[1][l] << 8 | (uint32_t)channel[2][l] << 16 |
+                            (uint32_t)channel[3][l] << 24;
+}
+
+// VertexColoursWithDirectionalLight, and TextureAndVertexColoursAndDirectionalLight, whose texture multiplies the
+// same thing: color * max(ambient, N.L)
+static void vlit_kernel_colour_directional(vlit_actor* a, const vlit_light* light, int all)
+{
+    float l[3];
+    vlit_unit(light->direction, l);
+    vlit_v ambient = VLIT_SET(light->ambient);
+    for (uint32_t b = 0; b < a->block_count; b++) {
+        if (!all && !a->dirty[b]) continue;
+        a->dirty[b] = 0;
+        uint32_t base = b * VLIT_LANES;
+        vlit_v n[3], c[4];
+        vlit_normal(a, base, n);
+        vlit_v diffuse = VLIT_MAX(ambient, vlit_ndotl(n, l));
+        for (int k = 0; k < 3; k++) c[k] = VLIT_MUL(VLIT_LOAD(a->color[k] + base), diffuse);
+        c[3] = VLIT_LOAD(a->color[3] + base);
+        vlit_store_rgba(a, base, c);
+    }
+}
+
+// VertexColoursWithVertexLighting: color * (ambient + light color * max(0, N.L))
+static void vlit_kernel_colour_vertex(vlit_actor* a, const vlit_light* light, int all)
+{
+    float l[3];
+    vlit_unit(light->direction, l);
+    vlit_v ambient = VLIT_SET(light->ambient), zero = VLIT_SET(0.0f);
+    for (uint32_t b = 0; b < a->block_count; b++) {
+        if (!all && !a->dirty[b]) continue;
+        a->dirty[b] = 0;
+        uint32_t base = b * VLIT_LANES;
+        vlit_v n[3], c[4];
+        vlit_normal(a, base, n);
+        vlit_v diffuse = VLIT_MAX(zero, vlit_ndotl(n, l));
+        for (int k = 0; k < 3; k++)
+            c[k] = VLIT_MUL(VLIT_LOAD(a->color[k] + base), VLIT_ADD(ambient, VLIT_MUL(VLIT_SET(light->color[k]), diffuse)));
+        c[3] = VLIT_LOAD(a->color[3] + base);
+        vlit_store_rgba(a, base, c);
+    }
+}
+
+// TextureWithDirectionalLight: the texture times max(ambient, N.L), vertex colors unused
+static void vlit_kernel_directional(vlit_actor* a, const vlit_light* light, int all)
+{
+    float l[3];
+    vlit_unit(light->direction, l);
+    vlit_v ambient = VLIT_SET(light->ambient), one = VLIT_SET(1.0f);
+    for (uint32_t b = 0; b < a->block_count; b++) {
+        if (!all && !a->dirty[b]) continue;
+        a->dirty[b] = 0;
+        uint32_t base = b * VLIT_LANES;
+        vlit_v n[3];
+        vlit_normal(a, base, n);
+        vlit_v diffuse = VLIT_MAX(ambient, vlit_ndotl(n, l));
+        vlit_v c[4] = { diffuse, diffuse, diffuse, one };
+        vlit_store_rgba(a, base, c);
+    }
+}
+
+// MatCap: the view-space normal, normalized, as uv = n.xy * 0.47 + 0.5; the vertex color was set once
+static void vlit_kernel_mat_cap(vlit_actor* a, const vlit_light* light, int all)
+{
+    const float* m = light->view;
+    vlit_v scale = VLIT_SET(0.47f), half = VLIT_SET(0.5f);
+    for (uint32_t b = 0; b < a->block_count; b++) {
+        if (!all && !a->dirty[b]) continue;
+        a->dirty[b] = 0;
+        uint32_t base = b * VLIT_LANES;
+        vlit_v n[3], v[3];
+        vlit_normal(a, base, n);
+        for (int r = 0; r < 3; r++) v[r] = vlit_ndotl(n, m + r * 3);
+        vlit_v length2 = VLIT_ADD(VLIT_ADD(VLIT_MUL(v[0], v[0]), VLIT_MUL(v[1], v[1])), VLIT_MUL(v[2], v[2]));
+        vlit_v inverse = VLIT_DIV(VLIT_SET(1.0f), VLIT_SQRT(VLIT_MAX(length2, VLIT_SET(1e-30f))));
+        float u[VLIT_LANES], t[VLIT_LANES];
+        VLIT_STORE(u, VLIT_ADD(VLIT_MUL(VLIT_MUL(v[0], inverse), scale), half));
+        VLIT_STORE(t, VLIT_ADD(VLIT_MUL(VLIT_MUL(v[1], inverse), scale), half));
+        for (int l = 0; l < VLIT_LANES; l++) {
+            a->uv[(base + l) * 2] = u[l];
+            a->uv[(base + l) * 2 + 1] = t[l];
+        }
+    }
+}
+
+static const vlit_kernel vlit_kernels[VLIT_MODE_COUNT] = {
+    NULL,                                // VertexColoursOnly
+    vlit_kernel_colour_directional,      // VertexColoursWithDirectionalLight
+    vlit_kernel_colour_vertex,           // VertexColoursWithVertexLighting
+    NULL,                                // TextureOnly
+    NULL,                                // TextureAndVertexColours
+    vlit_kernel_directional,             // TextureWithDirectionalLight
+    vlit_kernel_colour_directional,      // TextureAndVertexColoursAndDirectionalLight
+    vlit_kernel_mat_cap                  // MatCap
+};
+
+static void vlit_relight(vlit_actor* a, const vlit_light* light)
+{
+    int all = !a->have_light || memcmp(&a->light, light, sizeof(vlit_light)) != 0;
+    vlit_kernels[a->mode](a, light, all);
+    a->light = *light;
+    a->have_light = 1;
+}
+
+void vlit_update(vlit_actor* actor, const float* x, const float* y, const float* z, const vlit_light* light)
+{
+    if (!vlit_kernels[actor->mode]) return;
+    actor->renormalized = 0;
+    if (vlit_find_moved(actor, x, y, z)) vlit_resum(actor);
+    vlit_relight(actor, light);
+}
+
+void vlit_update_normals(vlit_actor* actor, const float* nx, const float* ny, const float* nz, const vlit_light* light)
+{
+    if (!vlit_kernels[actor->mode]) return;
+    const float* n[3] = { nx, ny, nz };
+    uint32_t count = 0;
+    for (uint32_t v = 0; v < actor->vertex_count; v++) {
+        int differs = 0;
+        for (int k = 0; k < 3; k++) differs |= vlit_bits(n[k][v]) != vlit_bits(actor->sum[k][v]);
+        if (!differs) continue;
+        for (int k = 0; k < 3; k++) actor->sum[k][v] = n[k][v];
+        actor->dirty[v / VLIT_LANES] = 1;
+        count++;
+    }
+    // The sums no longer come from prev, so the next vlit_update starts over
+    actor->have_frame = 0;
+    actor->renormalized = count;
+    vlit_relight(actor, light);
+}
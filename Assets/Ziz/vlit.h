@@ -0,0 +1,100 @@
+#ifndef VLIT_H
+#define VLIT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Per-vertex lighting for actors, one kernel per Actor rendering mode, so RAT playback can light on the CPU what the
+// Actor/* shaders light on the GPU.
+//
+//   vlit_mesh mesh;
+//   vlit_mesh_from_act(&mesh, act_bytes, act_size);   // indices, vertex colors and the rendering mode
+//   vlit_actor* lit = vlit_create(&mesh, mesh.mode);
+//   vlit_light light;
+//   vlit_light_defaults(&light);
+//   every frame:
+//     decode the RAT frame into x, y, z                // exported space, one float array per axis
+//     vlit_update(lit, x, y, z, &light);
+//     draw with vlit_colors(lit) (and vlit_uvs(lit) for VLIT_MAT_CAP)
+//
+// Normals are rebuilt from the face list, each vertex the area-weighted sum of the faces around it. A frame only
+// recomputes the faces touching vertices that moved since the previous one, then re-sums just the vertices of those
+// faces, gathering through a vertex-to-face table in a fixed order so the result has the same bits as a full rebuild.
+// Lighting then runs over four vertices per SSE step where available (scalar code gives the same bits) and again only
+// over blocks whose normals changed, unless the light or view did. Modes without lighting are resolved once in
+// vlit_create and cost nothing per frame; modes that light do no work for vertices held still.
+//
+// The shaders light per pixel from the interpolated normal; here the same formulas are evaluated at the vertices
+// (Gouraud), which is what a fixed-function target gets anyway.
+
+// Rat.ActorRenderingMode, as stored in the ACT header
+typedef enum vlit_mode {
+    VLIT_VERTEX_COLOURS_ONLY = 0,
+    VLIT_VERTEX_COLOURS_WITH_DIRECTIONAL_LIGHT,
+    VLIT_VERTEX_COLOURS_WITH_VERTEX_LIGHTING,
+    VLIT_TEXTURE_ONLY,
+    VLIT_TEXTURE_AND_VERTEX_COLOURS,
+    VLIT_TEXTURE_WITH_DIRECTIONAL_LIGHT,
+    VLIT_TEXTURE_AND_VERTEX_COLOURS_AND_DIRECTIONAL_LIGHT,
+    VLIT_MAT_CAP,
+    VLIT_MODE_COUNT
+} vlit_mode;
+
+enum {
+    VLIT_OK = 0,
+    VLIT_ERR_MAGIC = -1,         // not an ACT
+    VLIT_ERR_RANGE = -2          // a table past the end of the file, or an index past the vertices
+};
+
+// The static part of an actor, laid out as the ACT stores it (little-endian, any alignment). vlit_create copies what
+// it needs, so the bytes may go once it returns.
+typedef struct vlit_mesh {
+    uint32_t vertex_count;
+    uint32_t index_count;        // three per triangle, counter-clockwise in exported space
+    const void* indices;         // uint16 per index
+    const void* colors;          // float RGBA 0..1 per vertex; NULL means white
+    vlit_mode mode;
+} vlit_mesh;
+
+typedef struct vlit_light {
+    float direction[3];          // towards the light (_WorldSpaceLightPos0.xyz), exported space; normalized on use
+    float color[3];              // _LightColor0, only VertexColoursWithVertexLighting uses it
+    float ambient;               // the shaders' 0.3: a floor under N.L, or added to it with vertex lighting
+    float view[9];               // row-major rotation from exported space to view space, for the MatCap lookup
+} vlit_light;
+
+typedef struct vlit_actor vlit_actor;
+
+// The Actor shaders' constants: ambient 0.3, a white light from (0.577, 0.577, 0.577), identity view
+void vlit_light_defaults(vlit_light* light);
+
+// Reads an ACT (version 6) in place. VLIT_ERR_RANGE also covers a rendering mode the enum doesn't know.
+int vlit_mesh_from_act(vlit_mesh* mesh, const void* data, size_t size);
+
+// Whether the mode's shader reads the normal; the others never look at positions
+int vlit_mode_uses_normals(vlit_mode mode);
+
+// NULL if out of memory or an index is past vertex_count. Only modes that light allocate normals.
+vlit_actor* vlit_create(const vlit_mesh* mesh, vlit_mode mode);
+void vlit_destroy(vlit_actor* actor);
+
+// Lights one frame. x, y, z hold vertex_count floats each; the first call after vlit_create or vlit_invalidate
+// rebuilds every normal, later ones only what moved. Modes that don't light return at once.
+void vlit_update(vlit_actor* actor, const float* x, const float* y, const float* z, const vlit_light* light);
+
+// As vlit_update, with normals the caller already has (unit length, SoA) instead of rebuilding them
+void vlit_update_normals(vlit_actor* actor, const float* nx, const float* ny, const float* nz, const vlit_light* light);
+
+// Forgets the previous frame, so the next update rebuilds and relights everything (after a seek, say)
+void vlit_invalidate(vlit_actor* actor);
+
+// RGBA8888 per vertex, r in the low byte: what the shader multiplies the texture by, or the color it outputs
+const uint32_t* vlit_colors(const vlit_actor* actor);
+
+// u, v pairs per vertex for VLIT_MAT_CAP (v up, as Unity samples), NULL for the other modes
+const float* vlit_uvs(const vlit_actor* actor);
+
+// Vertices whose normal was recomputed by the last update, for profiling
+uint32_t vlit_last_renormalized(const vlit_actor* actor);
+
+#endif
@@ -0,0 +1,128 @@
+// Lights a synthetic animated actor (a UV sphere whose upper half sways while the rest holds still) in every lit mode
+// and times vlit_update per frame, incremental against a full rebuild each frame. Also checks that both give the same
+// colors and UVs.
+//
+//   cc -O2 -I. vlit_bench.c vlit.c ztime.c -lm -o vlit_bench
+//   ./vlit_bench [rings] [frames]
+
+#include "vlit.h"
+#include "ztime.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char* bench_mode_names[VLIT_MODE_COUNT] = {
+    "VertexColoursOnly", "VertexColoursWithDirectionalLight", "VertexColoursWithVertexLighting", "TextureOnly",
+    "TextureAndVertexColours", "TextureWithDirectionalLight", "TextureAndVertexColoursAndDirectionalLight", "MatCap"
+};
+
+// Rest pose, then frame f: vertices above y = 0.3 rotate about z by an angle that grows with height
+static void bench_pose(const float* rest[3], float* out[3], uint32_t count, int frame)
+{
+    for (uint32_t v = 0; v < count; v++) {
+        float x = rest[0][v], y = rest[1][v];
+        if (y > 0.3f) {
+            float angle = 0.4f * sinf((float)frame * 0.1f) * (y - 0.3f);
+            float c = cosf(angle), s = sinf(angle);
+            out[0][v] = x * c - y * s;
+            out[1][v] = x * s + y * c;
+        } else {
+            out[0][v] = x;
+            out[1][v] = y;
+        }
+        out[2][v] = rest[2][v];
+    }
+}
+
+int main(int argc, char** argv)
+{
+    int rings = argc > 1 ? atoi(argv[1]) : 64;
+    int frames = argc > 2 ? atoi(argv[2]) : 300;
+    if (rings < 3 || rings > 180 || frames < 1) {
+        fprintf(stderr, "usage: %s [rings 3..180] [frames]\n", argv[0]);
+        return 1;
+    }
+
+    // UV sphere, rings x (2 * rings) quads, counter-clockwise seen from outside
+    uint32_t segments = (uint32_t)rings * 2, vertex_count = ((uint32_t)rings + 1) * (segments + 1);
+    uint32_t index_count = (uint32_t)rings * segments * 6;
+    uint16_t* indices = (uint16_t*)malloc(index_count * sizeof(uint16_t));
+    float* colors = (float*)malloc((size_t)vertex_count * 4 * sizeof(float));
+    float* storage = (float*)malloc((size_t)vertex_count * 6 * sizeof(float));
+    if (!indices || !colors || !storage) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+    float* rest[3] = { storage, storage + vertex_count, storage + vertex_count * 2 };
+    float* pose[3] = { storage + vertex_count * 3, storage + vertex_count * 4, storage + vertex_count * 5 };
+    for (uint32_t r = 0; r <= (uint32_t)rings; r++)
+        for (uint32_t s = 0; s <= segments; s++) {
+            uint32_t v = r * (segments + 1) + s;
+            float theta = 3.14159265f * (float)r / (float)rings, phi = 6.2831853f * (float)s / (float)segments;
+            rest[0][v] = sinf(theta) * cosf(phi);
+            rest[1][v] = cosf(theta);
+            rest[2][v] = sinf(theta) * sinf(phi);
+            colors[v * 4 + 0] = 0.5f + 0.5f * rest[0][v];
+            colors[v * 4 + 1] = 0.8f;
+            colors[v * 4 + 2] = 0.5f + 0.5f * rest[2][v];
+            colors[v * 4 + 3] = 1.0f;
+        }
+    uint32_t n = 0;
+    for (uint32_t r = 0; r < (uint32_t)rings; r++)
+        for (uint32_t s = 0; s < segments; s++) {
+            uint16_t a = (uint16_t)(r * (segments + 1) + s), b = (uint16_t)(a + segments + 1);
+            indices[n++] = a; indices[n++] = (uint16_t)(a + 1); indices[n++] = b;
+            indices[n++] = (uint16_t)(a + 1); indices[n++] = (uint16_t)(b + 1); indices[n++] = b;
+        }
+    if (vertex_count > 65536) {
+        fprintf(stderr, "too many vertices for 16-bit indices\n");
+        return 1;
+    }
+
+    vlit_mesh mesh = { vertex_count, index_count, indices, colors, VLIT_VERTEX_COLOURS_ONLY };
+    vlit_light light;
+    vlit_light_defaults(&light);
+    printf("%u vertices, %u triangles, %d frames\n", vertex_count, index_count / 3, frames);
+
+    int mismatches = 0;
+    for (int m = 0; m < VLIT_MODE_COUNT; m++) {
+        if (!vlit_mode_uses_normals((vlit_mode)m)) continue;
+        vlit_actor* incremental = vlit_create(&mesh, (vlit_mode)m);
+        vlit_actor* full = vlit_create(&mesh, (vlit_mode)m);
+        if (!incremental || !full) {
+            fprintf(stderr, "out of memory\n");
+            return 1;
+        }
+
+        double incremental_us = 0.0, full_us = 0.0;
+        uint64_t renormalized = 0;
+        for (int f = 0; f < frames; f++) {
+            bench_pose((const float**)rest, pose, vertex_count, f);
+            double start = ztime_now_us();
+            vlit_update(incremental, pose[0], pose[1], pose[2], &light);
+            double middle = ztime_now_us();
+            vlit_invalidate(full);
+            vlit_update(full, pose[0], pose[1], pose[2], &light);
+            double end = ztime_now_us();
+            incremental_us += middle - start;
+            full_us += end - middle;
+            renormalized += vlit_last_renormalized(incremental);
+
+            int same = memcmp(vlit_colors(incremental), vlit_colors(full), vertex_count * sizeof(uint32_t)) == 0;
+            if (vlit_uvs(full)) same &= memcmp(vlit_uvs(incremental), vlit_uvs(full), vertex_count * 2 * sizeof(float)) == 0;
+            mismatches += !same;
+        }
+
+        printf("%-43s incremental %8.2f us/frame (%.0f normals), full %8.2f us/frame\n", bench_mode_names[m],
+               incremental_us / frames, (double)renormalized / frames, full_us / frames);
+        vlit_destroy(incremental);
+        vlit_destroy(full);
+    }
+    printf(mismatches ? "MISMATCH in %d frames\n" : "incremental matches full rebuild\n", mismatches);
+
+    free(indices);
+    free(colors);
+    free(storage);
+    return mismatches ? 1 : 0;
+}
@@ -0,0 +1,26 @@
+// clock_gettime and CLOCK_MONOTONIC under -std=c99; must precede every system header
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 199309L
+#endif
+#include "ztime.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+
+double ztime_now_us(void)
+{
+    LARGE_INTEGER t, f;
+    QueryPerformanceCounter(&t);
+    QueryPerformanceFrequency(&f);
+    return (double)t.QuadPart * 1e6 / (double)f.QuadPart;
+}
+#else
+#include <time.h>
+
+double ztime_now_us(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double)t.tv_sec * 1e6 + (double)t.tv_nsec * 1e-3;
+}
+#endif
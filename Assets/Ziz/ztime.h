@@ -0,0 +1,15 @@
+#ifndef ZTIME_H
+#define ZTIME_H
+
+// Monotonic wall clock for the benches and the per-pass timings in post: QueryPerformanceCounter on Windows,
+// clock_gettime(CLOCK_MONOTONIC) elsewhere. Builds under plain -std=c99; the feature-test macro it needs is set in
+// ztime.c alone.
+//
+//   double start = ztime_now_us();
+//   ...
+//   printf("%.2f ms\n", (ztime_now_us() - start) / 1000.0);
+
+// Microseconds from an arbitrary fixed point
+double ztime_now_us(void);
+
+#endif